@@ -0,0 +1,185 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <openssl/aes.h>
+
+#include "aes_internal.h"
+#include "crypto_arch.h"
+
+/*
+ * The key schedules used here are those produced by aesni_set_encrypt_key()
+ * and aesni_set_decrypt_key().
+ */
+void aesni_encrypt(const unsigned char *in, unsigned char *out,
+    const AES_KEY *key);
+void aesni_decrypt(const unsigned char *in, unsigned char *out,
+    const AES_KEY *key);
+void aesni_cbc_encrypt(const unsigned char *in, unsigned char *out,
+    size_t length, const AES_KEY *key, unsigned char *ivec, int enc);
+
+void aes_cbc_decrypt_blocks_vaes_avx512(const uint8_t *in, uint8_t *out,
+    size_t blocks, const AES_KEY *key, uint8_t ivec[16]);
+void aes_xts_encrypt_blocks_vaes_avx512(const uint8_t *in, uint8_t *out,
+    size_t blocks, const AES_KEY *key1, uint8_t tweak[16]);
+void aes_xts_decrypt_blocks_vaes_avx512(const uint8_t *in, uint8_t *out,
+    size_t blocks, const AES_KEY *key1, uint8_t tweak[16]);
+
+int
+aes_vaes_capable(void)
+{
+	return (crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_VAES_AVX512) != 0;
+}
+
+void
+aes_cbc_decrypt_vaes(const unsigned char *in, unsigned char *out,
+    size_t len, const AES_KEY *key, unsigned char *ivec)
+{
+	size_t blocks;
+
+	blocks = len / AES_BLOCK_SIZE;
+	aes_cbc_decrypt_blocks_vaes_avx512(in, out, blocks, key, ivec);
+
+	in += blocks * AES_BLOCK_SIZE;
+	out += blocks * AES_BLOCK_SIZE;
+	len -= blocks * AES_BLOCK_SIZE;
+
+	if (len > 0)
+		aesni_cbc_encrypt(in, out, len, key, ivec, 0);
+}
+
+/*
+ * Multiply the tweak by alpha (x) in GF(2^128), as per IEEE 1619.
+ */
+static void
+aes_xts_mul_alpha(uint8_t tweak[AES_BLOCK_SIZE])
+{
+	uint64_t t[2], carry;
+
+	memcpy(t, tweak, sizeof(t));
+
+	carry = t[1] >> 63;
+	t[1] = t[1] << 1 | t[0] >> 63;
+	t[0] = t[0] << 1 ^ (0x87 & (0 - carry));
+
+	memcpy(tweak, t, sizeof(t));
+}
+
+void
+aes_xts_encrypt_vaes(const unsigned char *in, unsigned char *out,
+    size_t len, const AES_KEY *key1, const AES_KEY *key2,
+    const unsigned char iv[16])
+{
+	uint8_t tweak[AES_BLOCK_SIZE], buf[AES_BLOCK_SIZE];
+	size_t blocks, i;
+
+	if (len < AES_BLOCK_SIZE)
+		return;
+
+	aesni_encrypt(iv, tweak, key2);
+
+	blocks = len / AES_BLOCK_SIZE;
+	aes_xts_encrypt_blocks_vaes_avx512(in, out, blocks, key1, tweak);
+
+	in += blocks * AES_BLOCK_SIZE;
+	out += blocks * AES_BLOCK_SIZE;
+	len -= blocks * AES_BLOCK_SIZE;
+
+	/*
+	 * Ciphertext stealing - the final partial block is padded with the
+	 * tail of the last ciphertext block, which in turn is truncated to
+	 * become the final partial ciphertext block.
+	 */
+	if (len > 0) {
+		for (i = 0; i < len; i++) {
+			buf[i] = in[i] ^ tweak[i];
+			out[i] = out[i - AES_BLOCK_SIZE];
+		}
+		for (; i < AES_BLOCK_SIZE; i++)
+			buf[i] = out[i - AES_BLOCK_SIZE] ^ tweak[i];
+
+		aesni_encrypt(buf, buf, key1);
+
+		for (i = 0; i < AES_BLOCK_SIZE; i++)
+			out[i - AES_BLOCK_SIZE] = buf[i] ^ tweak[i];
+	}
+
+	explicit_bzero(tweak, sizeof(tweak));
+	explicit_bzero(buf, sizeof(buf));
+}
+
+void
+aes_xts_decrypt_vaes(const unsigned char *in, unsigned char *out,
+    size_t len, const AES_KEY *key1, const AES_KEY *key2,
+    const unsigned char iv[16])
+{
+	uint8_t tweak[AES_BLOCK_SIZE], tweak1[AES_BLOCK_SIZE];
+	uint8_t buf[AES_BLOCK_SIZE], c;
+	size_t blocks, i;
+
+	if (len < AES_BLOCK_SIZE)
+		return;
+
+	aesni_encrypt(iv, tweak, key2);
+
+	/* The last whole block is handled separately when stealing. */
+	blocks = len / AES_BLOCK_SIZE;
+	if (len % AES_BLOCK_SIZE != 0)
+		blocks--;
+	aes_xts_decrypt_blocks_vaes_avx512(in, out, blocks, key1, tweak);
+
+	in += blocks * AES_BLOCK_SIZE;
+	out += blocks * AES_BLOCK_SIZE;
+	len -= blocks * AES_BLOCK_SIZE;
+
+	/*
+	 * Ciphertext stealing - the last whole ciphertext block is decrypted
+	 * with the following tweak, then its tail is combined with the final
+	 * partial block and decrypted with the current tweak.
+	 */
+	if (len > 0) {
+		len -= AES_BLOCK_SIZE;
+
+		memcpy(tweak1, tweak, sizeof(tweak1));
+		aes_xts_mul_alpha(tweak1);
+
+		for (i = 0; i < AES_BLOCK_SIZE; i++)
+			buf[i] = in[i] ^ tweak1[i];
+		aesni_decrypt(buf, buf, key1);
+		for (i = 0; i < AES_BLOCK_SIZE; i++)
+			buf[i] ^= tweak1[i];
+
+		for (i = 0; i < len; i++) {
+			c = in[AES_BLOCK_SIZE + i];
+			out[AES_BLOCK_SIZE + i] = buf[i];
+			buf[i] = c;
+		}
+
+		for (i = 0; i < AES_BLOCK_SIZE; i++)
+			buf[i] ^= tweak[i];
+		aesni_decrypt(buf, buf, key1);
+		for (i = 0; i < AES_BLOCK_SIZE; i++)
+			out[i] = buf[i] ^ tweak[i];
+
+		explicit_bzero(tweak1, sizeof(tweak1));
+	}
+
+	explicit_bzero(tweak, sizeof(tweak));
+	explicit_bzero(buf, sizeof(buf));
+}
@@ -28,6 +28,11 @@ extern uint64_t crypto_cpu_caps_amd64;
 #endif
 
 #define CRYPTO_CPU_CAPS_AMD64_SHA	(1ULL << 0)
+#define CRYPTO_CPU_CAPS_AMD64_AVX2	(1ULL << 1)
+#define CRYPTO_CPU_CAPS_AMD64_AVX512	(1ULL << 2)
+#define CRYPTO_CPU_CAPS_AMD64_AESNI_AVX	(1ULL << 3)
+#define CRYPTO_CPU_CAPS_AMD64_VAES	(1ULL << 4)
+#define CRYPTO_CPU_CAPS_AMD64_VAES_AVX512	(1ULL << 5)
 
 #ifndef OPENSSL_NO_ASM
 
@@ -37,9 +42,26 @@ extern uint64_t crypto_cpu_caps_amd64;
 #define HAVE_AES_ENCRYPT_INTERNAL
 #define HAVE_AES_DECRYPT_INTERNAL
 
+#define HAVE_AES_VAES
+
+#define HAVE_CAMELLIA_ENCRYPT_BLOCKS
+
 #define HAVE_RC4_INTERNAL
 #define HAVE_RC4_SET_KEY_INTERNAL
 
+#define HAVE_SHA1_BLOCK_MULTI
+#define HAVE_SHA256_BLOCK_MULTI
+#define HAVE_SHA512_BLOCK_MULTI
+
+#define HAVE_SHA3_KECCAKF_X4
+
+#define HAVE_SM4_ENCRYPT_BLOCKS
+
+#define HAVE_ARGON2_FILL_BLOCK
+#define HAVE_SCRYPT_ROMIX
+
+#define HAVE_MLKEM_NTT
+
 #endif
 
 #endif
@@ -72,6 +72,7 @@ void
 crypto_cpu_caps_init(void)
 {
 	uint32_t eax, ebx, ecx, edx, max_cpuid;
+	uint32_t xcr0 = 0;
 	uint64_t caps = 0;
 
 	cpuid(0, &eax, &ebx, &ecx, &edx);
@@ -107,17 +108,50 @@ crypto_cpu_caps_init(void)
 
 	/* AVX requires OSXSAVE and XMM/YMM state to be enabled. */
 	if ((ecx & IA32CAP_MASK1_OSXSAVE) != 0) {
-		xgetbv(0, &eax, NULL);
-		if (((eax >> 1) & 3) == 3 && (ecx & IA32CAP_MASK1_AVX) != 0)
+		xgetbv(0, &xcr0, NULL);
+		if (((xcr0 >> 1) & 3) == 3 && (ecx & IA32CAP_MASK1_AVX) != 0)
 			caps |= CPUCAP_MASK_AVX;
 	}
 
+	/* AES-NI with VEX encoded instructions. */
+	if ((caps & CPUCAP_MASK_AESNI) != 0 && (caps & CPUCAP_MASK_AVX) != 0)
+		crypto_cpu_caps_amd64 |= CRYPTO_CPU_CAPS_AMD64_AESNI_AVX;
+
 	if (max_cpuid >= 7) {
-		cpuid(7, NULL, &ebx, NULL, NULL);
+		cpuid(7, NULL, &ebx, &ecx, NULL);
 
 		/* Intel SHA extensions feature bit - ebx[29]. */
 		if (((ebx >> 29) & 1) != 0)
 			crypto_cpu_caps_amd64 |= CRYPTO_CPU_CAPS_AMD64_SHA;
+
+		/* AVX2 feature bit - ebx[5], which also requires AVX. */
+		if (((ebx >> 5) & 1) != 0 && (caps & CPUCAP_MASK_AVX) != 0)
+			crypto_cpu_caps_amd64 |= CRYPTO_CPU_CAPS_AMD64_AVX2;
+
+		/*
+		 * AVX-512F feature bit - ebx[16], which also requires AVX2 and
+		 * opmask/ZMM state to be enabled.
+		 */
+		if (((ebx >> 16) & 1) != 0 && ((xcr0 >> 5) & 7) == 7 &&
+		    (crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0)
+			crypto_cpu_caps_amd64 |= CRYPTO_CPU_CAPS_AMD64_AVX512;
+
+		/* VAES feature bit - ecx[9], also requiring AVX2 and AES-NI. */
+		if (((ecx >> 9) & 1) != 0 &&
+		    (crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0 &&
+		    (crypto_cpu_caps_amd64 &
+		    CRYPTO_CPU_CAPS_AMD64_AESNI_AVX) != 0)
+			crypto_cpu_caps_amd64 |= CRYPTO_CPU_CAPS_AMD64_VAES;
+
+		/*
+		 * VAES with 512 bit registers - requires AVX-512F, AVX-512BW
+		 * (ebx[30]), AVX-512VL (ebx[31]) and VPCLMULQDQ (ecx[10]).
+		 */
+		if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_VAES) != 0 &&
+		    (crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX512) != 0 &&
+		    ((ebx >> 30) & 3) == 3 && ((ecx >> 10) & 1) != 0)
+			crypto_cpu_caps_amd64 |=
+			    CRYPTO_CPU_CAPS_AMD64_VAES_AVX512;
 	}
 
 	/* Set machine independent CPU capabilities. */
@@ -380,14 +380,17 @@ ASN1_item_sign_ctx(const ASN1_ITEM *it, X509_ALGOR *algor1, X509_ALGOR *algor2,
 }
 LCRYPTO_ALIAS(ASN1_item_sign_ctx);
 
+/*
+ * Verify a signature over an existing DER encoding of asn. This allows callers
+ * that keep the received encoding to avoid re-encoding the signed data.
+ */
 int
-ASN1_item_verify(const ASN1_ITEM *it, X509_ALGOR *a,
-    ASN1_BIT_STRING *signature, void *asn, EVP_PKEY *pkey)
+asn1_item_verify_encoded(const ASN1_ITEM *it, X509_ALGOR *a,
+    ASN1_BIT_STRING *signature, void *asn, const unsigned char *in,
+    size_t in_len, EVP_PKEY *pkey)
 {
 	EVP_MD_CTX *md_ctx = NULL;
-	unsigned char *in = NULL;
 	int mdnid, pknid;
-	int in_len = 0;
 	int ret = -1;
 
 	if (pkey == NULL) {
@@ -444,12 +447,6 @@ ASN1_item_verify(const ASN1_ITEM *it, X509_ALGOR *a,
 
 	}
 
-	if ((in_len = ASN1_item_i2d(asn, &in, it)) <= 0) {
-		ASN1error(ERR_R_MALLOC_FAILURE);
-		in_len = 0;
-		goto err;
-	}
-
 	if (EVP_DigestVerify(md_ctx, signature->data, signature->length,
 	    in, in_len) <= 0) {
 		ASN1error(ERR_R_EVP_LIB);
@@ -461,6 +458,32 @@ ASN1_item_verify(const ASN1_ITEM *it, X509_ALGOR *a,
 
  err:
 	EVP_MD_CTX_free(md_ctx);
+
+	return ret;
+}
+
+int
+ASN1_item_verify(const ASN1_ITEM *it, X509_ALGOR *a,
+    ASN1_BIT_STRING *signature, void *asn, EVP_PKEY *pkey)
+{
+	unsigned char *in = NULL;
+	int in_len = 0;
+	int ret = -1;
+
+	if (pkey == NULL) {
+		ASN1error(ERR_R_PASSED_NULL_PARAMETER);
+		goto err;
+	}
+
+	if ((in_len = ASN1_item_i2d(asn, &in, it)) <= 0) {
+		ASN1error(ERR_R_MALLOC_FAILURE);
+		in_len = 0;
+		goto err;
+	}
+
+	ret = asn1_item_verify_encoded(it, a, signature, asn, in, in_len, pkey);
+
+ err:
 	freezero(in, in_len);
 
 	return ret;
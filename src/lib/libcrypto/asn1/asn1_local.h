@@ -167,6 +167,9 @@ int asn1_time_time_t_to_tm(const time_t *time, struct tm *out_tm);
 int asn1_time_tm_to_time_t(const struct tm *tm, time_t *out);
 
 int ASN1_item_ndef_i2d(ASN1_VALUE *val, unsigned char **out, const ASN1_ITEM *it);
+int asn1_item_verify_encoded(const ASN1_ITEM *it, X509_ALGOR *a,
+    ASN1_BIT_STRING *signature, void *asn, const unsigned char *in,
+    size_t in_len, EVP_PKEY *pkey);
 
 const BIO_METHOD *BIO_f_asn1(void);
 
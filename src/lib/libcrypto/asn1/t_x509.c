@@ -251,7 +251,7 @@ X509_print_ex(BIO *bp, X509 *x, unsigned long nmflags, unsigned long cflag)
 
 	if (!(cflag & X509_FLAG_NO_EXTENSIONS))
 		X509V3_extensions_print(bp, "X509v3 extensions",
-		    ci->extensions, cflag, 8);
+		    X509_get0_extensions(x), cflag, 8);
 
 	if (!(cflag & X509_FLAG_NO_SIGDUMP)) {
 		if (X509_signature_print(bp, x->sig_alg, x->signature) <= 0)
@@ -182,6 +182,26 @@ const ASN1_ITEM X509_CRL_INFO_it = {
 };
 LCRYPTO_ALIAS(X509_CRL_INFO_it);
 
+/* Cache the reason code of a CRL entry. Returns 0 if it is invalid. */
+int
+x509_revoked_set_reason(X509_REVOKED *rev)
+{
+	ASN1_ENUMERATED *reason;
+	int crit;
+
+	reason = X509_REVOKED_get_ext_d2i(rev, NID_crl_reason, &crit, NULL);
+	if (reason == NULL && crit != -1)
+		return 0;
+
+	if (reason != NULL) {
+		rev->reason = ASN1_ENUMERATED_get(reason);
+		ASN1_ENUMERATED_free(reason);
+	} else
+		rev->reason = CRL_REASON_NONE;
+
+	return 1;
+}
+
 /* Set CRL entry issuer according to CRL certificate issuer extension.
  * Check for unhandled critical CRL entry extensions.
  */
@@ -199,7 +219,6 @@ crl_set_issuers(X509_CRL *crl)
 	for (i = 0; i < sk_X509_REVOKED_num(revoked); i++) {
 		X509_REVOKED *rev = sk_X509_REVOKED_value(revoked, i);
 		STACK_OF(X509_EXTENSION) *exts;
-		ASN1_ENUMERATED *reason;
 		X509_EXTENSION *ext;
 		gtmp = X509_REVOKED_get_ext_d2i(rev, NID_certificate_issuer,
 		    &j, NULL);
@@ -220,19 +239,11 @@ crl_set_issuers(X509_CRL *crl)
 		}
 		rev->issuer = gens;
 
-		reason = X509_REVOKED_get_ext_d2i(rev, NID_crl_reason,
-		    &j, NULL);
-		if (!reason && (j != -1)) {
+		if (!x509_revoked_set_reason(rev)) {
 			crl->flags |= EXFLAG_INVALID;
 			return 1;
 		}
 
-		if (reason) {
-			rev->reason = ASN1_ENUMERATED_get(reason);
-			ASN1_ENUMERATED_free(reason);
-		} else
-			rev->reason = CRL_REASON_NONE;
-
 		/* Check for critical CRL entry extensions */
 
 		exts = rev->extensions;
@@ -274,6 +285,7 @@ crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it, void *exarg)
 		crl->issuers = NULL;
 		crl->crl_number = NULL;
 		crl->base_crl_number = NULL;
+		crl->index = NULL;
 		break;
 
 	case ASN1_OP_D2I_POST:
@@ -326,6 +338,11 @@ crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it, void *exarg)
 			return 0;
 		break;
 
+	case ASN1_OP_I2D_PRE:
+		if (crl->index != NULL && !x509_crl_index_restore_tbs(crl))
+			return 0;
+		break;
+
 	case ASN1_OP_FREE_POST:
 		if (crl->akid)
 			AUTHORITY_KEYID_free(crl->akid);
@@ -334,6 +351,7 @@ crl_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it, void *exarg)
 		ASN1_INTEGER_free(crl->crl_number);
 		ASN1_INTEGER_free(crl->base_crl_number);
 		sk_GENERAL_NAMES_pop_free(crl->issuers, GENERAL_NAMES_free);
+		x509_crl_index_free(crl->index);
 		break;
 	}
 	return rc;
@@ -493,6 +511,8 @@ LCRYPTO_ALIAS(d2i_X509_CRL);
 int
 i2d_X509_CRL(X509_CRL *a, unsigned char **out)
 {
+	if (a != NULL && a->index != NULL && !a->crl->enc.modified)
+		return x509_crl_index_i2d(a, out);
 	return ASN1_item_i2d((ASN1_VALUE *)a, out, &X509_CRL_it);
 }
 LCRYPTO_ALIAS(i2d_X509_CRL);
@@ -514,6 +534,8 @@ LCRYPTO_ALIAS(X509_CRL_free);
 X509_CRL *
 X509_CRL_dup(X509_CRL *x)
 {
+	if (x->index != NULL && !x->crl->enc.modified)
+		return x509_crl_index_dup(x);
 	return ASN1_item_dup(&X509_CRL_it, x);
 }
 LCRYPTO_ALIAS(X509_CRL_dup);
@@ -524,11 +546,28 @@ X509_REVOKED_cmp(const X509_REVOKED * const *a, const X509_REVOKED * const *b)
 	return(ASN1_INTEGER_cmp((*a)->serialNumber, (*b)->serialNumber));
 }
 
+/*
+ * Decode all revoked entries of an indexed CRL into its revoked stack. This
+ * needs to be done before the CRL is modified, since a modified CRL is
+ * encoded from its decoded fields.
+ */
+int
+x509_crl_materialize(X509_CRL *crl)
+{
+	if (crl->index == NULL)
+		return 1;
+
+	return x509_crl_index_materialize(crl);
+}
+
 int
 X509_CRL_add0_revoked(X509_CRL *crl, X509_REVOKED *rev)
 {
 	X509_CRL_INFO *inf;
 
+	if (!x509_crl_materialize(crl))
+		return 0;
+
 	inf = crl->crl;
 	if (!inf->revoked)
 		inf->revoked = sk_X509_REVOKED_new(X509_REVOKED_cmp);
@@ -544,6 +583,8 @@ LCRYPTO_ALIAS(X509_CRL_add0_revoked);
 int
 X509_CRL_verify(X509_CRL *crl, EVP_PKEY *pkey)
 {
+	if (crl->index != NULL && !crl->crl->enc.modified)
+		return x509_crl_index_verify(crl, pkey);
 	return ASN1_item_verify(&X509_CRL_INFO_it, crl->sig_alg, crl->signature,
 	    crl->crl, pkey);
 }
@@ -583,6 +624,12 @@ crl_lookup(X509_CRL *crl, X509_REVOKED **ret, ASN1_INTEGER *serial,
 	X509_REVOKED rtmp, *rev;
 	int idx;
 
+	if (crl->index != NULL && x509_crl_index_lookup(crl, serial, &rev)) {
+		if (rev != NULL && crl_revoked_issuer_match(crl, issuer, rev))
+			goto found;
+		return 0;
+	}
+
 	rtmp.serialNumber = serial;
 	if (!sk_X509_REVOKED_is_sorted(crl->crl->revoked)) {
 		CRYPTO_w_lock(CRYPTO_LOCK_X509_CRL);
@@ -597,15 +644,17 @@ crl_lookup(X509_CRL *crl, X509_REVOKED **ret, ASN1_INTEGER *serial,
 		rev = sk_X509_REVOKED_value(crl->crl->revoked, idx);
 		if (ASN1_INTEGER_cmp(rev->serialNumber, serial))
 			return 0;
-		if (crl_revoked_issuer_match(crl, issuer, rev)) {
-			if (ret)
-				*ret = rev;
-			if (rev->reason == CRL_REASON_REMOVE_FROM_CRL)
-				return 2;
-			return 1;
-		}
+		if (crl_revoked_issuer_match(crl, issuer, rev))
+			goto found;
 	}
 	return 0;
+
+ found:
+	if (ret)
+		*ret = rev;
+	if (rev->reason == CRL_REASON_REMOVE_FROM_CRL)
+		return 2;
+	return 1;
 }
 
 int
@@ -683,6 +732,9 @@ LCRYPTO_ALIAS(X509_CRL_get_issuer);
 STACK_OF(X509_REVOKED) *
 X509_CRL_get_REVOKED(X509_CRL *crl)
 {
+	/* The caller may modify the stack. */
+	if (!x509_crl_materialize(crl))
+		return NULL;
 	return crl->crl->revoked;
 }
 LCRYPTO_ALIAS(X509_CRL_get_REVOKED);
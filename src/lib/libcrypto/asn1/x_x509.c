@@ -67,8 +67,35 @@
 
 #include "x509_local.h"
 
+static int
+x509_cinf_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it,
+    void *exarg)
+{
+	X509_CINF *ci = (X509_CINF *)*pval;
+
+	switch (operation) {
+
+	case ASN1_OP_I2D_PRE:
+		/*
+		 * Without a valid cached encoding the TBS is encoded from its
+		 * fields, so any extensions still in DER form are needed now.
+		 */
+		if (!x509_cinf_decode_extensions(ci))
+			return 0;
+		break;
+
+	case ASN1_OP_FREE_POST:
+		ASN1_STRING_free(ci->lazy_extensions);
+		ci->lazy_extensions = NULL;
+		break;
+	}
+
+	return 1;
+}
+
 static const ASN1_AUX X509_CINF_aux = {
 	.flags = ASN1_AFLG_ENCODING,
+	.asn1_cb = x509_cinf_cb,
 	.enc_offset = offsetof(X509_CINF, enc),
 };
 static const ASN1_TEMPLATE X509_CINF_seq_tt[] = {
@@ -172,6 +199,134 @@ X509_CINF_free(X509_CINF *a)
 	ASN1_item_free((ASN1_VALUE *)a, &X509_CINF_it);
 }
 LCRYPTO_ALIAS(X509_CINF_free);
+
+/*
+ * Lazily parsed X509_CINF, see d2i_X509_lazy(). This is identical to
+ * X509_CINF, except that the extensions are kept as the DER encoded
+ * SEQUENCE until they are first accessed. It is only ever used for decoding,
+ * the resulting structure is otherwise handled via X509_CINF_it.
+ */
+static const ASN1_AUX X509_CINF_lazy_aux = {
+	.flags = ASN1_AFLG_ENCODING,
+	.enc_offset = offsetof(X509_CINF, enc),
+};
+static const ASN1_TEMPLATE X509_CINF_lazy_seq_tt[] = {
+	{
+		.flags = ASN1_TFLG_EXPLICIT | ASN1_TFLG_OPTIONAL,
+		.offset = offsetof(X509_CINF, version),
+		.field_name = "version",
+		.item = &ASN1_INTEGER_it,
+	},
+	{
+		.offset = offsetof(X509_CINF, serialNumber),
+		.field_name = "serialNumber",
+		.item = &ASN1_INTEGER_it,
+	},
+	{
+		.offset = offsetof(X509_CINF, signature),
+		.field_name = "signature",
+		.item = &X509_ALGOR_it,
+	},
+	{
+		.offset = offsetof(X509_CINF, issuer),
+		.field_name = "issuer",
+		.item = &X509_NAME_it,
+	},
+	{
+		.offset = offsetof(X509_CINF, validity),
+		.field_name = "validity",
+		.item = &X509_VAL_it,
+	},
+	{
+		.offset = offsetof(X509_CINF, subject),
+		.field_name = "subject",
+		.item = &X509_NAME_it,
+	},
+	{
+		.offset = offsetof(X509_CINF, key),
+		.field_name = "key",
+		.item = &X509_PUBKEY_it,
+	},
+	{
+		.flags = ASN1_TFLG_IMPLICIT | ASN1_TFLG_OPTIONAL,
+		.tag = 1,
+		.offset = offsetof(X509_CINF, issuerUID),
+		.field_name = "issuerUID",
+		.item = &ASN1_BIT_STRING_it,
+	},
+	{
+		.flags = ASN1_TFLG_IMPLICIT | ASN1_TFLG_OPTIONAL,
+		.tag = 2,
+		.offset = offsetof(X509_CINF, subjectUID),
+		.field_name = "subjectUID",
+		.item = &ASN1_BIT_STRING_it,
+	},
+	{
+		.flags = ASN1_TFLG_EXPLICIT | ASN1_TFLG_OPTIONAL,
+		.tag = 3,
+		.offset = offsetof(X509_CINF, lazy_extensions),
+		.field_name = "extensions",
+		.item = &ASN1_SEQUENCE_it,
+	},
+};
+
+static const ASN1_ITEM X509_CINF_lazy_it = {
+	.itype = ASN1_ITYPE_SEQUENCE,
+	.utype = V_ASN1_SEQUENCE,
+	.templates = X509_CINF_lazy_seq_tt,
+	.tcount = sizeof(X509_CINF_lazy_seq_tt) / sizeof(ASN1_TEMPLATE),
+	.funcs = &X509_CINF_lazy_aux,
+	.size = sizeof(X509_CINF),
+	.sname = "X509_CINF",
+};
+
+/*
+ * Decode extensions that were left in DER form by d2i_X509_lazy(). Malformed
+ * extensions are only detected here - this is remembered so that the lock is
+ * not taken again, since this may be reached with CRYPTO_LOCK_X509 held from
+ * x509v3_cache_extensions().
+ */
+int
+x509_cinf_decode_extensions(X509_CINF *ci)
+{
+	STACK_OF(X509_EXTENSION) *exts;
+	const unsigned char *p;
+	int ret = 0;
+
+	if (ci->lazy_extensions == NULL)
+		return 1;
+	if (ci->lazy_invalid)
+		return 0;
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509);
+
+	if (ci->lazy_extensions == NULL) {
+		ret = 1;
+		goto done;
+	}
+	if (ci->lazy_invalid)
+		goto done;
+
+	p = ci->lazy_extensions->data;
+	exts = d2i_X509_EXTENSIONS(NULL, &p, ci->lazy_extensions->length);
+	if (exts == NULL || p != ci->lazy_extensions->data +
+	    ci->lazy_extensions->length) {
+		sk_X509_EXTENSION_pop_free(exts, X509_EXTENSION_free);
+		ci->lazy_invalid = 1;
+		goto done;
+	}
+
+	ci->extensions = exts;
+	ASN1_STRING_free(ci->lazy_extensions);
+	ci->lazy_extensions = NULL;
+
+	ret = 1;
+
+ done:
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509);
+
+	return ret;
+}
 /* X509 top level structure needs a bit of customisation */
 
 static int
@@ -190,6 +345,7 @@ x509_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it, void *exarg)
 		ret->akid = NULL;
 		ret->aux = NULL;
 		ret->crldp = NULL;
+		ret->nc_compiled = NULL;
 #ifndef OPENSSL_NO_RFC3779
 		ret->rfc3779_addr = NULL;
 		ret->rfc3779_asid = NULL;
@@ -210,6 +366,7 @@ x509_cb(int operation, ASN1_VALUE **pval, const ASN1_ITEM *it, void *exarg)
 		CRL_DIST_POINTS_free(ret->crldp);
 		GENERAL_NAMES_free(ret->altname);
 		NAME_CONSTRAINTS_free(ret->nc);
+		x509_constraints_compiled_free(ret->nc_compiled);
 #ifndef OPENSSL_NO_RFC3779
 		sk_IPAddressFamily_pop_free(ret->rfc3779_addr, IPAddressFamily_free);
 		ASIdentifiers_free(ret->rfc3779_asid);
@@ -259,6 +416,34 @@ const ASN1_ITEM X509_it = {
 };
 LCRYPTO_ALIAS(X509_it);
 
+static const ASN1_TEMPLATE X509_lazy_seq_tt[] = {
+	{
+		.offset = offsetof(X509, cert_info),
+		.field_name = "cert_info",
+		.item = &X509_CINF_lazy_it,
+	},
+	{
+		.offset = offsetof(X509, sig_alg),
+		.field_name = "sig_alg",
+		.item = &X509_ALGOR_it,
+	},
+	{
+		.offset = offsetof(X509, signature),
+		.field_name = "signature",
+		.item = &ASN1_BIT_STRING_it,
+	},
+};
+
+static const ASN1_ITEM X509_lazy_it = {
+	.itype = ASN1_ITYPE_SEQUENCE,
+	.utype = V_ASN1_SEQUENCE,
+	.templates = X509_lazy_seq_tt,
+	.tcount = sizeof(X509_lazy_seq_tt) / sizeof(ASN1_TEMPLATE),
+	.funcs = &X509_aux,
+	.size = sizeof(X509),
+	.sname = "X509",
+};
+
 
 X509 *
 d2i_X509(X509 **a, const unsigned char **in, long len)
@@ -268,6 +453,23 @@ d2i_X509(X509 **a, const unsigned char **in, long len)
 }
 LCRYPTO_ALIAS(d2i_X509);
 
+X509 *
+d2i_X509_lazy(X509 **a, const unsigned char **in, long len)
+{
+	X509 *ret;
+
+	/* Never reuse *a, its extensions may already have been decoded. */
+	if ((ret = (X509 *)ASN1_item_d2i(NULL, in, len, &X509_lazy_it)) == NULL)
+		return NULL;
+	if (a != NULL) {
+		X509_free(*a);
+		*a = ret;
+	}
+
+	return ret;
+}
+LCRYPTO_ALIAS(d2i_X509_lazy);
+
 int
 i2d_X509(X509 *a, unsigned char **out)
 {
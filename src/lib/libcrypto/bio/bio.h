@@ -98,6 +98,7 @@ extern "C" {
 #define BIO_TYPE_DGRAM		(21|0x0400|0x0100)
 #define BIO_TYPE_ASN1 		(22|0x0200)		/* filter */
 #define BIO_TYPE_COMP 		(23|0x0200)		/* filter */
+#define BIO_TYPE_AEAD_STREAM	(24|0x0200)		/* filter */
 
 #define BIO_TYPE_DESCRIPTOR	0x0100	/* socket, fd, connect or accept */
 #define BIO_TYPE_FILTER		0x0200
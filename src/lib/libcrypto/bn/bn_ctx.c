@@ -15,6 +15,7 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <pthread.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -25,6 +26,14 @@
 
 #define BN_CTX_INITIAL_LEN	8
 
+/*
+ * Number of BIGNUMs and the limb size that a per-thread BN_CTX is warmed up
+ * with. This covers the temporaries needed by RSA-4096 private key
+ * operations, as well as DH and EC, without further allocation.
+ */
+#define BN_CTX_THREAD_LEN	32
+#define BN_CTX_THREAD_WORDS	(2 * 4096 / BN_BITS2)
+
 struct bignum_ctx {
 	BIGNUM **bignums;
 	uint8_t *groups;
@@ -32,9 +41,18 @@ struct bignum_ctx {
 	size_t index;
 	size_t len;
 
+	/* Per-thread contexts are reference counted rather than freed. */
+	int thread;
+	size_t thread_refs;
+	size_t high_water;
+
 	int error;
 };
 
+static pthread_once_t bn_ctx_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t bn_ctx_thread_key;
+static int bn_ctx_thread_key_ok;
+
 static int
 bn_ctx_grow(BN_CTX *bctx)
 {
@@ -72,14 +90,11 @@ BN_CTX_new(void)
 }
 LCRYPTO_ALIAS(BN_CTX_new);
 
-void
-BN_CTX_free(BN_CTX *bctx)
+static void
+bn_ctx_free_internal(BN_CTX *bctx)
 {
 	size_t i;
 
-	if (bctx == NULL)
-		return;
-
 	for (i = 0; i < bctx->len; i++) {
 		BN_free(bctx->bignums[i]);
 		bctx->bignums[i] = NULL;
@@ -90,6 +105,22 @@ BN_CTX_free(BN_CTX *bctx)
 
 	freezero(bctx, sizeof(*bctx));
 }
+
+static void bn_ctx_put_thread(BN_CTX *bctx);
+
+void
+BN_CTX_free(BN_CTX *bctx)
+{
+	if (bctx == NULL)
+		return;
+
+	if (bctx->thread) {
+		bn_ctx_put_thread(bctx);
+		return;
+	}
+
+	bn_ctx_free_internal(bctx);
+}
 LCRYPTO_ALIAS(BN_CTX_free);
 
 void
@@ -137,6 +168,8 @@ BN_CTX_get(BN_CTX *bctx)
 	}
 	bctx->groups[bctx->index] = bctx->group;
 	bctx->index++;
+	if (bctx->index > bctx->high_water)
+		bctx->high_water = bctx->index;
 
 	BN_zero(bn);
 
@@ -159,3 +192,112 @@ BN_CTX_end(BN_CTX *bctx)
 	bctx->group--;
 }
 LCRYPTO_ALIAS(BN_CTX_end);
+
+static void
+bn_ctx_thread_destroy(void *arg)
+{
+	BN_CTX *bctx = arg;
+
+	if (bctx != NULL)
+		bn_ctx_free_internal(bctx);
+}
+
+static void
+bn_ctx_thread_init(void)
+{
+	if (pthread_key_create(&bn_ctx_thread_key, bn_ctx_thread_destroy) == 0)
+		bn_ctx_thread_key_ok = 1;
+}
+
+static BN_CTX *
+bn_ctx_thread_new(void)
+{
+	BN_CTX *bctx;
+	BIGNUM *bn;
+
+	if ((bctx = BN_CTX_new()) == NULL)
+		return NULL;
+
+	while (bctx->len < BN_CTX_THREAD_LEN) {
+		if (!bn_ctx_grow(bctx))
+			goto err;
+	}
+	for (; bctx->index < BN_CTX_THREAD_LEN; bctx->index++) {
+		if ((bn = BN_new()) == NULL)
+			goto err;
+		bctx->bignums[bctx->index] = bn;
+		if (!bn_wexpand(bn, BN_CTX_THREAD_WORDS))
+			goto err;
+	}
+	bctx->index = 0;
+	bctx->thread = 1;
+
+	return bctx;
+
+ err:
+	bn_ctx_free_internal(bctx);
+
+	return NULL;
+}
+
+/*
+ * Return the calling thread's BN_CTX, creating and warming it up on first
+ * use. The context must be released with BN_CTX_free(), which only drops a
+ * reference - the BIGNUMs and their limbs are retained for the next caller.
+ * Callers may nest, since each one works within its own BN_CTX_start() and
+ * BN_CTX_end() frame. If thread-specific storage is unavailable, a regular
+ * BN_CTX is returned instead.
+ */
+BN_CTX *
+bn_ctx_get_thread(void)
+{
+	BN_CTX *bctx;
+
+	if (pthread_once(&bn_ctx_thread_once, bn_ctx_thread_init) != 0)
+		return BN_CTX_new();
+	if (!bn_ctx_thread_key_ok)
+		return BN_CTX_new();
+
+	if ((bctx = pthread_getspecific(bn_ctx_thread_key)) == NULL) {
+		if ((bctx = bn_ctx_thread_new()) == NULL)
+			return BN_CTX_new();
+		if (pthread_setspecific(bn_ctx_thread_key, bctx) != 0) {
+			bn_ctx_free_internal(bctx);
+			return BN_CTX_new();
+		}
+	}
+
+	bctx->thread_refs++;
+
+	return bctx;
+}
+
+static void
+bn_ctx_put_thread(BN_CTX *bctx)
+{
+	BIGNUM *bn;
+	size_t i;
+
+	if (bctx->thread_refs > 0)
+		bctx->thread_refs--;
+	if (bctx->thread_refs > 0)
+		return;
+
+	/*
+	 * The outermost user is done. Scrub the limbs of any BIGNUM that was
+	 * handed out, so that no secrets linger in the cached context, but
+	 * keep the allocations. Recover from errors and unbalanced frames.
+	 */
+	for (i = 0; i < bctx->high_water; i++) {
+		if ((bn = bctx->bignums[i]) == NULL)
+			continue;
+		explicit_bzero(bn->d, bn->dmax * sizeof(bn->d[0]));
+		BN_zero(bn);
+		bn->flags &= ~BN_FLG_CONSTTIME;
+		bctx->groups[i] = 0;
+	}
+	bctx->high_water = 0;
+	bctx->index = 0;
+	bctx->group = 0;
+	bctx->error = 0;
+}
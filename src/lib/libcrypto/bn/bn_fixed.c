@@ -0,0 +1,283 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <string.h>
+
+#include <openssl/bn.h>
+
+#include "bn_fixed.h"
+#include "bn_internal.h"
+#include "bn_local.h"
+
+/* Window size used for exponentiation, with a table of 2^w entries. */
+#define BN_FIXED_EXP_WINDOW	4
+#define BN_FIXED_EXP_TABLE	(1 << BN_FIXED_EXP_WINDOW)
+
+/* Temporary space needed by bn_montgomery_multiply_words(). */
+#define BN_FIXED_MUL_TMP	(BN_FIXED_MAX_WORDS * 2 + 2)
+
+/*
+ * bn_fixed_mont_supported() returns one if the modulus of the given
+ * Montgomery context can be handled by the fixed width code and a is a
+ * non-negative value that is fully reduced, otherwise zero.
+ */
+int
+bn_fixed_mont_supported(const BN_MONT_CTX *mctx, const BIGNUM *a)
+{
+	if (mctx == NULL)
+		return 0;
+	if (mctx->N.top < 2 || mctx->N.top > BN_FIXED_MAX_WORDS)
+		return 0;
+	if (a != NULL && (BN_is_negative(a) || BN_ucmp(a, &mctx->N) >= 0))
+		return 0;
+
+	return 1;
+}
+
+int
+bn_fixed_mont_init(struct bn_fixed_mont *fm, const BN_MONT_CTX *mctx)
+{
+	memset(fm, 0, sizeof(*fm));
+
+	if (!bn_fixed_mont_supported(mctx, NULL))
+		return 0;
+
+	fm->words = mctx->N.top;
+	fm->n0[0] = mctx->n0[0];
+	fm->n0[1] = mctx->n0[1];
+
+	if (!bn_fixed_from_bn(fm->n, fm->words, &mctx->N))
+		return 0;
+	if (!bn_fixed_from_bn(fm->rr, fm->words, &mctx->RR))
+		return 0;
+
+	return 1;
+}
+
+void
+bn_fixed_mont_cleanup(struct bn_fixed_mont *fm)
+{
+	explicit_bzero(fm, sizeof(*fm));
+}
+
+/*
+ * bn_fixed_from_bn() copies the absolute value of a into the r_len word
+ * array r, padding with zeroes. It fails if a does not fit.
+ */
+int
+bn_fixed_from_bn(BN_ULONG *r, size_t r_len, const BIGNUM *a)
+{
+	size_t i;
+
+	if (a->top < 0 || (size_t)a->top > r_len)
+		return 0;
+
+	for (i = 0; i < (size_t)a->top; i++)
+		r[i] = a->d[i];
+	for (; i < r_len; i++)
+		r[i] = 0;
+
+	return 1;
+}
+
+int
+bn_fixed_to_bn(BIGNUM *r, const BN_ULONG *a, size_t a_len)
+{
+	size_t i;
+
+	if (a_len > BN_FIXED_MAX_WORDS)
+		return 0;
+	if (!bn_wexpand(r, a_len))
+		return 0;
+
+	for (i = 0; i < a_len; i++)
+		r->d[i] = a[i];
+
+	r->top = a_len;
+	r->neg = 0;
+	bn_correct_top(r);
+
+	return 1;
+}
+
+/*
+ * bn_fixed_select() sets r to a if mask is all ones and to b if mask is zero,
+ * without branching on the mask.
+ */
+void
+bn_fixed_select(BN_ULONG *r, BN_ULONG mask, const BN_ULONG *a,
+    const BN_ULONG *b, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		r[i] = (a[i] & mask) | (b[i] & ~mask);
+}
+
+static void
+bn_fixed_mont_mul_tmp(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *b,
+    const struct bn_fixed_mont *fm, BN_ULONG *tp)
+{
+#ifdef OPENSSL_BN_ASM_MONT
+	/* Legacy bn_mul_mont() can indicate that we should fall back. */
+	if (bn_mul_mont(r, a, b, fm->n, fm->n0, fm->words))
+		return;
+#endif
+	bn_montgomery_multiply_words(r, a, b, fm->n, tp, fm->n0[0], fm->words);
+}
+
+/*
+ * bn_fixed_mont_mul() computes r = a * b * R^-1 mod n. The output may alias
+ * either input.
+ */
+void
+bn_fixed_mont_mul(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *b,
+    const struct bn_fixed_mont *fm)
+{
+	BN_ULONG t[BN_FIXED_MUL_TMP];
+
+	bn_fixed_mont_mul_tmp(r, a, b, fm, t);
+
+	explicit_bzero(t, sizeof(t));
+}
+
+void
+bn_fixed_mont_sqr(BN_ULONG *r, const BN_ULONG *a,
+    const struct bn_fixed_mont *fm)
+{
+	bn_fixed_mont_mul(r, a, a, fm);
+}
+
+/*
+ * bn_fixed_mont_to() converts a into Montgomery form, computing r = a * R mod n.
+ */
+void
+bn_fixed_mont_to(BN_ULONG *r, const BN_ULONG *a,
+    const struct bn_fixed_mont *fm)
+{
+	bn_fixed_mont_mul(r, a, fm->rr, fm);
+}
+
+/*
+ * bn_fixed_mont_from() converts a out of Montgomery form, computing
+ * r = a * R^-1 mod n.
+ */
+void
+bn_fixed_mont_from(BN_ULONG *r, const BN_ULONG *a,
+    const struct bn_fixed_mont *fm)
+{
+	BN_ULONG one[BN_FIXED_MAX_WORDS] = { 1 };
+
+	bn_fixed_mont_mul(r, a, one, fm);
+}
+
+/*
+ * bn_fixed_mont_exp() computes r = a^p mod n, where a and r are in Montgomery
+ * form and p is a p_len word exponent. A fixed window is used and every table
+ * entry is touched for each lookup, so that the memory access pattern and the
+ * running time only depend on p_len and the size of the modulus.
+ */
+void
+bn_fixed_mont_exp(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *p,
+    size_t p_len, const struct bn_fixed_mont *fm)
+{
+	BN_ULONG table[BN_FIXED_EXP_TABLE][BN_FIXED_MAX_WORDS];
+	BN_ULONG acc[BN_FIXED_MAX_WORDS], t[BN_FIXED_MAX_WORDS];
+	BN_ULONG one[BN_FIXED_MAX_WORDS] = { 1 };
+	BN_ULONG tp[BN_FIXED_MUL_TMP];
+	BN_ULONG mask, window;
+	size_t bit, i, j, k;
+	size_t n = fm->words;
+
+	/* table[0] = R mod n (one in Montgomery form), table[i] = a^i. */
+	bn_fixed_mont_mul_tmp(table[0], one, fm->rr, fm, tp);
+	for (i = 1; i < BN_FIXED_EXP_TABLE; i++)
+		bn_fixed_mont_mul_tmp(table[i], table[i - 1], a, fm, tp);
+
+	memcpy(acc, table[0], n * sizeof(acc[0]));
+
+	bit = p_len * BN_BITS2;
+	while (bit > 0) {
+		bit -= BN_FIXED_EXP_WINDOW;
+
+		for (i = 0; i < BN_FIXED_EXP_WINDOW; i++)
+			bn_fixed_mont_mul_tmp(acc, acc, acc, fm, tp);
+
+		window = (p[bit / BN_BITS2] >> (bit % BN_BITS2)) &
+		    (BN_FIXED_EXP_TABLE - 1);
+
+		memset(t, 0, n * sizeof(t[0]));
+		for (j = 0; j < BN_FIXED_EXP_TABLE; j++) {
+			mask = bn_ct_eq_zero_mask(j ^ window);
+			for (k = 0; k < n; k++)
+				t[k] |= table[j][k] & mask;
+		}
+
+		bn_fixed_mont_mul_tmp(acc, acc, t, fm, tp);
+	}
+
+	memcpy(r, acc, n * sizeof(r[0]));
+
+	explicit_bzero(table, sizeof(table));
+	explicit_bzero(acc, sizeof(acc));
+	explicit_bzero(t, sizeof(t));
+	explicit_bzero(tp, sizeof(tp));
+}
+
+/*
+ * bn_fixed_mod_exp_mont() computes r = a^p mod N for the modulus of the given
+ * Montgomery context. The caller must ensure that bn_fixed_mont_supported()
+ * holds for mctx and a. Only the number of words in p is revealed.
+ */
+int
+bn_fixed_mod_exp_mont(BIGNUM *r, const BIGNUM *a, const BIGNUM *p,
+    const BN_MONT_CTX *mctx)
+{
+	struct bn_fixed_mont fm;
+	BN_ULONG x[BN_FIXED_MAX_WORDS], e[BN_FIXED_MAX_WORDS];
+	size_t p_len;
+	int ret = 0;
+
+	if (!bn_fixed_mont_supported(mctx, a))
+		goto err;
+	if (BN_is_negative(p))
+		goto err;
+	if (!bn_fixed_mont_init(&fm, mctx))
+		goto err;
+
+	p_len = p->top;
+	if (!bn_fixed_from_bn(e, BN_FIXED_MAX_WORDS, p))
+		goto err;
+	if (!bn_fixed_from_bn(x, fm.words, a))
+		goto err;
+
+	bn_fixed_mont_to(x, x, &fm);
+	bn_fixed_mont_exp(x, x, e, p_len, &fm);
+	bn_fixed_mont_from(x, x, &fm);
+
+	if (!bn_fixed_to_bn(r, x, fm.words))
+		goto err;
+
+	ret = 1;
+
+ err:
+	bn_fixed_mont_cleanup(&fm);
+	explicit_bzero(x, sizeof(x));
+	explicit_bzero(e, sizeof(e));
+
+	return ret;
+}
@@ -0,0 +1,71 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef HEADER_BN_FIXED_H
+#define HEADER_BN_FIXED_H
+
+#include <stddef.h>
+
+#include <openssl/bn.h>
+
+__BEGIN_HIDDEN_DECLS
+
+/*
+ * Fixed width modular arithmetic. Values are little endian word arrays that
+ * are exactly as long as the modulus, so that no normalisation takes place
+ * and the running time depends only on the size of the modulus. None of
+ * these functions allocate memory or require a BN_CTX.
+ */
+
+#define BN_FIXED_WORDS(bits)	(((bits) + BN_BITS2 - 1) / BN_BITS2)
+#define BN_FIXED_MAX_BITS	4096
+#define BN_FIXED_MAX_WORDS	BN_FIXED_WORDS(BN_FIXED_MAX_BITS)
+
+struct bn_fixed_mont {
+	BN_ULONG n[BN_FIXED_MAX_WORDS];		/* Modulus. */
+	BN_ULONG rr[BN_FIXED_MAX_WORDS];	/* R^2 mod n. */
+	BN_ULONG n0[2];
+	size_t words;
+};
+
+int bn_fixed_mont_supported(const BN_MONT_CTX *mctx, const BIGNUM *a);
+int bn_fixed_mont_init(struct bn_fixed_mont *fm, const BN_MONT_CTX *mctx);
+void bn_fixed_mont_cleanup(struct bn_fixed_mont *fm);
+
+int bn_fixed_from_bn(BN_ULONG *r, size_t r_len, const BIGNUM *a);
+int bn_fixed_to_bn(BIGNUM *r, const BN_ULONG *a, size_t a_len);
+
+void bn_fixed_select(BN_ULONG *r, BN_ULONG mask, const BN_ULONG *a,
+    const BN_ULONG *b, size_t n);
+
+void bn_fixed_mont_mul(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *b,
+    const struct bn_fixed_mont *fm);
+void bn_fixed_mont_sqr(BN_ULONG *r, const BN_ULONG *a,
+    const struct bn_fixed_mont *fm);
+void bn_fixed_mont_to(BN_ULONG *r, const BN_ULONG *a,
+    const struct bn_fixed_mont *fm);
+void bn_fixed_mont_from(BN_ULONG *r, const BN_ULONG *a,
+    const struct bn_fixed_mont *fm);
+void bn_fixed_mont_exp(BN_ULONG *r, const BN_ULONG *a, const BN_ULONG *p,
+    size_t p_len, const struct bn_fixed_mont *fm);
+
+int bn_fixed_mod_exp_mont(BIGNUM *r, const BIGNUM *a, const BIGNUM *p,
+    const BN_MONT_CTX *mctx);
+
+__END_HIDDEN_DECLS
+
+#endif /* HEADER_BN_FIXED_H */
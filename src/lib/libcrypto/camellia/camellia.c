@@ -90,6 +90,10 @@
 #include <openssl/camellia.h>
 #include <openssl/modes.h>
 
+#include "camellia_internal.h"
+#include "crypto_arch.h"
+#include "crypto_internal.h"
+
 typedef unsigned int  u32;
 typedef unsigned char u8;
 
@@ -580,6 +584,163 @@ Camellia_DecryptBlock(int keyBitLength, const u8 plaintext[],
 	    plaintext, keyTable, ciphertext);
 }
 
+void
+camellia_encrypt_blocks_generic(const uint8_t *in, uint8_t *out,
+    size_t blocks, const uint32_t *rk, int grand_rounds)
+{
+	while (blocks-- > 0) {
+		Camellia_EncryptBlock_Rounds(grand_rounds, in, rk, out);
+		in += CAMELLIA_BLOCK_SIZE;
+		out += CAMELLIA_BLOCK_SIZE;
+	}
+}
+
+#ifndef HAVE_CAMELLIA_ENCRYPT_BLOCKS
+void
+camellia_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const uint32_t *rk, int grand_rounds)
+{
+	camellia_encrypt_blocks_generic(in, out, blocks, rk, grand_rounds);
+}
+#endif
+
+/*
+ * Build a key schedule that performs decryption when used for encryption.
+ * The whitening keys are swapped, the Feistel round keys are reversed and
+ * the FL and FL^-1 keys are exchanged, which allows the multi-block
+ * encryption to be used for decryption.
+ */
+static void
+camellia_decrypt_key(const CAMELLIA_KEY *key, uint32_t *dk)
+{
+	const uint32_t *k = key->u.rd_key;
+	int grand_rounds = key->grand_rounds;
+	int g, i, j;
+
+	for (i = 0; i < 4; i++) {
+		dk[i] = k[grand_rounds * 16 + i];
+		dk[grand_rounds * 16 + i] = k[i];
+	}
+
+	for (g = 0; g < grand_rounds; g++) {
+		j = grand_rounds - 1 - g;
+		for (i = 0; i < 6; i++) {
+			dk[4 + g * 16 + i * 2] = k[4 + j * 16 + (5 - i) * 2];
+			dk[5 + g * 16 + i * 2] = k[5 + j * 16 + (5 - i) * 2];
+		}
+		if (g == grand_rounds - 1)
+			break;
+		j = grand_rounds - 2 - g;
+		dk[16 + g * 16 + 0] = k[16 + j * 16 + 2];
+		dk[16 + g * 16 + 1] = k[16 + j * 16 + 3];
+		dk[16 + g * 16 + 2] = k[16 + j * 16 + 0];
+		dk[16 + g * 16 + 3] = k[16 + j * 16 + 1];
+	}
+}
+
+void
+camellia_ecb_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const CAMELLIA_KEY *key, int enc)
+{
+	uint32_t dk[CAMELLIA_TABLE_WORD_LEN];
+
+	if (enc) {
+		camellia_encrypt_blocks(in, out, blocks, key->u.rd_key,
+		    key->grand_rounds);
+		return;
+	}
+
+	camellia_decrypt_key(key, dk);
+	camellia_encrypt_blocks(in, out, blocks, dk, key->grand_rounds);
+	explicit_bzero(dk, sizeof(dk));
+}
+
+#define CAMELLIA_PARALLEL_BLOCKS	16
+
+void
+camellia_cbc_decrypt(const uint8_t *in, uint8_t *out, size_t len,
+    const CAMELLIA_KEY *key, uint8_t *ivec)
+{
+	uint8_t buf[CAMELLIA_PARALLEL_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint8_t iv[CAMELLIA_BLOCK_SIZE];
+	uint32_t dk[CAMELLIA_TABLE_WORD_LEN];
+	size_t blocks, i;
+
+	camellia_decrypt_key(key, dk);
+
+	while (len >= CAMELLIA_BLOCK_SIZE) {
+		blocks = len / CAMELLIA_BLOCK_SIZE;
+		if (blocks > CAMELLIA_PARALLEL_BLOCKS)
+			blocks = CAMELLIA_PARALLEL_BLOCKS;
+
+		/*
+		 * Save the last ciphertext block as the next IV and decrypt
+		 * into a separate buffer, so that in and out may overlap.
+		 */
+		memcpy(iv, &in[(blocks - 1) * CAMELLIA_BLOCK_SIZE], sizeof(iv));
+		camellia_encrypt_blocks(in, buf, blocks, dk,
+		    key->grand_rounds);
+
+		for (i = 0; i < CAMELLIA_BLOCK_SIZE; i++)
+			buf[i] ^= ivec[i];
+		for (i = CAMELLIA_BLOCK_SIZE; i < blocks * CAMELLIA_BLOCK_SIZE;
+		    i++)
+			buf[i] ^= in[i - CAMELLIA_BLOCK_SIZE];
+		memcpy(out, buf, blocks * CAMELLIA_BLOCK_SIZE);
+		memcpy(ivec, iv, sizeof(iv));
+
+		in += blocks * CAMELLIA_BLOCK_SIZE;
+		out += blocks * CAMELLIA_BLOCK_SIZE;
+		len -= blocks * CAMELLIA_BLOCK_SIZE;
+	}
+
+	if (len > 0)
+		CRYPTO_cbc128_decrypt(in, out, len, key, ivec,
+		    (block128_f)Camellia_decrypt);
+
+	explicit_bzero(buf, sizeof(buf));
+	explicit_bzero(dk, sizeof(dk));
+}
+
+/*
+ * Encrypt blocks in counter mode with a 32 bit big endian counter, as
+ * required for ctr128_f.
+ */
+void
+camellia_ctr32_encrypt_blocks(const unsigned char *in, unsigned char *out,
+    size_t blocks, const void *key, const unsigned char ivec[16])
+{
+	const CAMELLIA_KEY *ckey = key;
+	uint8_t buf[CAMELLIA_PARALLEL_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint32_t ctr;
+	size_t i, n;
+
+	ctr = crypto_load_be32toh(&ivec[12]);
+
+	while (blocks > 0) {
+		n = blocks;
+		if (n > CAMELLIA_PARALLEL_BLOCKS)
+			n = CAMELLIA_PARALLEL_BLOCKS;
+
+		for (i = 0; i < n; i++) {
+			memcpy(&buf[i * CAMELLIA_BLOCK_SIZE], ivec, 12);
+			crypto_store_htobe32(&buf[i * CAMELLIA_BLOCK_SIZE + 12],
+			    ctr++);
+		}
+		camellia_encrypt_blocks(buf, buf, n, ckey->u.rd_key,
+		    ckey->grand_rounds);
+
+		for (i = 0; i < n * CAMELLIA_BLOCK_SIZE; i++)
+			out[i] = in[i] ^ buf[i];
+
+		in += n * CAMELLIA_BLOCK_SIZE;
+		out += n * CAMELLIA_BLOCK_SIZE;
+		blocks -= n;
+	}
+
+	explicit_bzero(buf, sizeof(buf));
+}
+
 int
 Camellia_set_key(const unsigned char *userKey, const int bits,
     CAMELLIA_KEY *key)
@@ -617,8 +778,7 @@ Camellia_cbc_encrypt(const unsigned char *in, unsigned char *out, size_t len,
 		CRYPTO_cbc128_encrypt(in, out, len, key, ivec,
 		    (block128_f)Camellia_encrypt);
 	else
-		CRYPTO_cbc128_decrypt(in, out, len, key, ivec,
-		   (block128_f)Camellia_decrypt);
+		camellia_cbc_decrypt(in, out, len, key, ivec);
 }
 LCRYPTO_ALIAS(Camellia_cbc_encrypt);
 
@@ -665,8 +825,8 @@ Camellia_ctr128_encrypt(const unsigned char *in, unsigned char *out,
     unsigned char ivec[CAMELLIA_BLOCK_SIZE],
     unsigned char ecount_buf[CAMELLIA_BLOCK_SIZE], unsigned int *num)
 {
-	CRYPTO_ctr128_encrypt(in, out, length, key, ivec, ecount_buf, num,
-	    (block128_f)Camellia_encrypt);
+	CRYPTO_ctr128_encrypt_ctr32(in, out, length, key, ivec, ecount_buf,
+	    num, camellia_ctr32_encrypt_blocks);
 }
 LCRYPTO_ALIAS(Camellia_ctr128_encrypt);
 
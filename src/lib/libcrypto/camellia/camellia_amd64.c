@@ -0,0 +1,61 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <openssl/camellia.h>
+
+#include "camellia_internal.h"
+#include "crypto_arch.h"
+
+void camellia_encrypt_blocks16_aesni(const uint8_t *in, uint8_t *out,
+    const uint32_t *rk, int grand_rounds);
+
+/*
+ * Below this number of blocks the table based implementation is faster than
+ * padding to a full sixteen blocks.
+ */
+#define CAMELLIA_AESNI_MIN_BLOCKS	4
+
+void
+camellia_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const uint32_t *rk, int grand_rounds)
+{
+	uint8_t buf[16 * CAMELLIA_BLOCK_SIZE];
+
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AESNI_AVX) != 0) {
+		while (blocks >= 16) {
+			camellia_encrypt_blocks16_aesni(in, out, rk,
+			    grand_rounds);
+			in += 16 * CAMELLIA_BLOCK_SIZE;
+			out += 16 * CAMELLIA_BLOCK_SIZE;
+			blocks -= 16;
+		}
+		if (blocks >= CAMELLIA_AESNI_MIN_BLOCKS) {
+			memset(buf, 0, sizeof(buf));
+			memcpy(buf, in, blocks * CAMELLIA_BLOCK_SIZE);
+			camellia_encrypt_blocks16_aesni(buf, buf, rk,
+			    grand_rounds);
+			memcpy(out, buf, blocks * CAMELLIA_BLOCK_SIZE);
+			explicit_bzero(buf, sizeof(buf));
+			return;
+		}
+	}
+
+	camellia_encrypt_blocks_generic(in, out, blocks, rk, grand_rounds);
+}
@@ -256,6 +256,37 @@ crypto_store_htole32(uint8_t *dst, uint32_t v)
 }
 #endif
 
+/*
+ * crypto_load_le64toh() loads a 64 bit unsigned little endian value as a 64 bit
+ * unsigned host endian value, from the specified address in memory. The memory
+ * address may have any alignment.
+ */
+#ifndef HAVE_CRYPTO_LOAD_LE64TOH
+static inline uint64_t
+crypto_load_le64toh(const uint8_t *src)
+{
+	uint64_t v;
+
+	memcpy(&v, src, sizeof(v));
+
+	return le64toh(v);
+}
+#endif
+
+/*
+ * crypto_store_htole64() stores a 64 bit unsigned host endian value as a 64 bit
+ * unsigned little endian value, at the specified address in memory. The memory
+ * address may have any alignment.
+ */
+#ifndef HAVE_CRYPTO_STORE_HTOLE64
+static inline void
+crypto_store_htole64(uint8_t *dst, uint64_t v)
+{
+	v = htole64(v);
+	memcpy(dst, &v, sizeof(v));
+}
+#endif
+
 #ifndef HAVE_CRYPTO_ROL_U32
 static inline uint32_t
 crypto_rol_u32(uint32_t v, size_t shift)
@@ -292,4 +323,19 @@ void crypto_cpu_caps_init(void);
 
 uint64_t crypto_cpu_caps_ia32(void);
 
+/*
+ * Pool of worker threads that process numbered items, with the calling
+ * thread as worker 0. A function that returns 0 stops further items from
+ * being handed out. A NULL pool processes all items in the calling thread.
+ */
+struct crypto_workers;
+
+typedef int (*crypto_workers_fn)(void *arg, size_t worker, size_t item);
+
+struct crypto_workers *crypto_workers_new(int num_threads);
+void crypto_workers_free(struct crypto_workers *workers);
+size_t crypto_workers_count(const struct crypto_workers *workers);
+int crypto_workers_run(struct crypto_workers *workers, size_t num_items,
+    crypto_workers_fn fn, void *arg);
+
 #endif
@@ -0,0 +1,243 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <openssl/err.h>
+
+#include "crypto_internal.h"
+
+#define CRYPTO_WORKERS_MAX_THREADS	256
+
+/*
+ * The threads are started once and then wait for runs, so that callers that
+ * process many small batches, such as a BIO or the slices of an Argon2 pass,
+ * don't pay for thread creation every time. Only one run may be in progress
+ * on a pool at any time.
+ */
+struct crypto_workers {
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond;
+	pthread_cond_t done_cond;
+	pthread_t threads[CRYPTO_WORKERS_MAX_THREADS - 1];
+	size_t num_threads;
+	uint64_t generation;
+	int shutdown;
+
+	crypto_workers_fn fn;
+	void *arg;
+	size_t num_items;
+	size_t next_item;
+	size_t active;
+	int failed;
+};
+
+struct crypto_workers_thread {
+	struct crypto_workers *workers;
+	size_t worker;
+};
+
+/*
+ * Process items of the current run until none are left, with the mutex held
+ * on entry and on return.
+ */
+static void
+crypto_workers_work(struct crypto_workers *workers, size_t worker)
+{
+	crypto_workers_fn fn;
+	void *arg;
+	size_t item;
+	int ok;
+
+	while (workers->next_item < workers->num_items) {
+		fn = workers->fn;
+		arg = workers->arg;
+		item = workers->next_item++;
+		workers->active++;
+
+		(void) pthread_mutex_unlock(&workers->mutex);
+		ok = fn(arg, worker, item);
+		(void) pthread_mutex_lock(&workers->mutex);
+
+		if (!ok) {
+			/* Stop handing out further items. */
+			workers->failed = 1;
+			workers->next_item = workers->num_items;
+		}
+		if (--workers->active == 0 &&
+		    workers->next_item >= workers->num_items)
+			(void) pthread_cond_signal(&workers->done_cond);
+	}
+}
+
+static void *
+crypto_workers_thread(void *arg)
+{
+	struct crypto_workers_thread *thread = arg;
+	struct crypto_workers *workers = thread->workers;
+	size_t worker = thread->worker;
+	uint64_t generation = 0;
+
+	free(thread);
+
+	(void) pthread_mutex_lock(&workers->mutex);
+	for (;;) {
+		while (!workers->shutdown && workers->generation == generation)
+			(void) pthread_cond_wait(&workers->work_cond,
+			    &workers->mutex);
+		if (workers->shutdown)
+			break;
+		generation = workers->generation;
+		crypto_workers_work(workers, worker);
+	}
+	(void) pthread_mutex_unlock(&workers->mutex);
+
+	/* Nobody will look at errors queued by this thread. */
+	ERR_remove_thread_state(NULL);
+
+	return NULL;
+}
+
+struct crypto_workers *
+crypto_workers_new(int num_threads)
+{
+	struct crypto_workers *workers;
+	struct crypto_workers_thread *thread;
+	int i;
+
+	if ((workers = calloc(1, sizeof(*workers))) == NULL)
+		return NULL;
+	if (pthread_mutex_init(&workers->mutex, NULL) != 0)
+		goto err_free;
+	if (pthread_cond_init(&workers->work_cond, NULL) != 0)
+		goto err_mutex;
+	if (pthread_cond_init(&workers->done_cond, NULL) != 0)
+		goto err_work_cond;
+
+	if (num_threads > CRYPTO_WORKERS_MAX_THREADS)
+		num_threads = CRYPTO_WORKERS_MAX_THREADS;
+
+	/*
+	 * The calling thread is one of the workers. If additional threads
+	 * can't be started, the remaining workers simply process more items.
+	 */
+	for (i = 0; i < num_threads - 1; i++) {
+		if ((thread = malloc(sizeof(*thread))) == NULL)
+			break;
+		thread->workers = workers;
+		thread->worker = workers->num_threads + 1;
+		if (pthread_create(&workers->threads[workers->num_threads],
+		    NULL, crypto_workers_thread, thread) != 0) {
+			free(thread);
+			break;
+		}
+		workers->num_threads++;
+	}
+
+	return workers;
+
+ err_work_cond:
+	(void) pthread_cond_destroy(&workers->work_cond);
+ err_mutex:
+	(void) pthread_mutex_destroy(&workers->mutex);
+ err_free:
+	free(workers);
+
+	return NULL;
+}
+
+void
+crypto_workers_free(struct crypto_workers *workers)
+{
+	size_t i;
+
+	if (workers == NULL)
+		return;
+
+	(void) pthread_mutex_lock(&workers->mutex);
+	workers->shutdown = 1;
+	(void) pthread_cond_broadcast(&workers->work_cond);
+	(void) pthread_mutex_unlock(&workers->mutex);
+
+	for (i = 0; i < workers->num_threads; i++)
+		(void) pthread_join(workers->threads[i], NULL);
+
+	(void) pthread_cond_destroy(&workers->done_cond);
+	(void) pthread_cond_destroy(&workers->work_cond);
+	(void) pthread_mutex_destroy(&workers->mutex);
+
+	free(workers);
+}
+
+/*
+ * Return the number of workers, including the calling thread, which bounds
+ * the worker numbers passed to the function.
+ */
+size_t
+crypto_workers_count(const struct crypto_workers *workers)
+{
+	if (workers == NULL)
+		return 1;
+
+	return workers->num_threads + 1;
+}
+
+/*
+ * Call fn for each item from 0 to num_items - 1, returning once all calls
+ * have completed. Returns 1 if all items were processed successfully.
+ */
+int
+crypto_workers_run(struct crypto_workers *workers, size_t num_items,
+    crypto_workers_fn fn, void *arg)
+{
+	size_t item;
+	int failed;
+
+	if (workers == NULL || workers->num_threads == 0 || num_items <= 1) {
+		for (item = 0; item < num_items; item++) {
+			if (!fn(arg, 0, item))
+				return 0;
+		}
+		return 1;
+	}
+
+	(void) pthread_mutex_lock(&workers->mutex);
+
+	workers->fn = fn;
+	workers->arg = arg;
+	workers->num_items = num_items;
+	workers->next_item = 0;
+	workers->failed = 0;
+	workers->generation++;
+	(void) pthread_cond_broadcast(&workers->work_cond);
+
+	crypto_workers_work(workers, 0);
+	while (workers->active > 0)
+		(void) pthread_cond_wait(&workers->done_cond, &workers->mutex);
+
+	failed = workers->failed;
+	workers->fn = NULL;
+	workers->arg = NULL;
+	workers->num_items = 0;
+	workers->next_item = 0;
+
+	(void) pthread_mutex_unlock(&workers->mutex);
+
+	return !failed;
+}
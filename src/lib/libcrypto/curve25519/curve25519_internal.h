@@ -18,6 +18,7 @@
 #ifndef HEADER_CURVE25519_INTERNAL_H
 #define HEADER_CURVE25519_INTERNAL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 __BEGIN_HIDDEN_DECLS
@@ -97,6 +98,21 @@ void x25519_scalar_mult_generic(uint8_t out[32], const uint8_t scalar[32],
 void ED25519_public_from_private(uint8_t out_public_key[32],
     const uint8_t private_key[32]);
 
+/*
+ * An expanded Ed25519 private key is the SHA-512 hash of the 32 byte seed,
+ * with the first half clamped for use as the secret scalar. Holding on to it
+ * avoids hashing the seed again for every signature.
+ */
+#define ED25519_EXPANDED_KEY_LENGTH 64
+
+void ed25519_expand_private_key(uint8_t out[ED25519_EXPANDED_KEY_LENGTH],
+    const uint8_t private_key[32]);
+void ed25519_public_from_expanded(uint8_t out_public_key[32],
+    const uint8_t expanded_key[ED25519_EXPANDED_KEY_LENGTH]);
+int ed25519_sign_expanded(uint8_t *out_sig, const uint8_t *message,
+    size_t message_len, const uint8_t public_key[32],
+    const uint8_t expanded_key[ED25519_EXPANDED_KEY_LENGTH]);
+
 void X25519_public_from_private(uint8_t out_public_key[32],
     const uint8_t private_key[32]);
 
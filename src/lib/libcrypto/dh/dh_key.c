@@ -79,7 +79,7 @@ generate_key(DH *dh)
 		return 0;
 	}
 
-	ctx = BN_CTX_new();
+	ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -146,7 +146,7 @@ compute_key(unsigned char *key, const BIGNUM *pub_key, DH *dh)
 		goto err;
 	}
 
-	ctx = BN_CTX_new();
+	ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 	BN_CTX_start(ctx);
@@ -98,7 +98,7 @@ dsa_do_sign(const unsigned char *dgst, int dlen, DSA *dsa)
 	if ((s = BN_new()) == NULL)
 		goto err;
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -217,7 +217,7 @@ dsa_sign_setup(DSA *dsa, BN_CTX *ctx_in, BIGNUM **kinvp, BIGNUM **rp)
 		goto err;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -311,7 +311,7 @@ dsa_do_verify(const unsigned char *dgst, int dgst_len, DSA_SIG *sig, DSA *dsa)
 	if (!dsa_check_key(dsa))
 		goto err;
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
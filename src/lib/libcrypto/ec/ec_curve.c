@@ -2358,6 +2358,9 @@ static const struct ec_curve {
 
 #define EC_CURVE_LIST_LENGTH (sizeof(ec_curve_list) / sizeof(ec_curve_list[0]))
 
+/* Generator tables for the built-in curves, computed on first use. */
+static struct ec_generator_table *ec_generator_tables[EC_CURVE_LIST_LENGTH];
+
 static EC_GROUP *
 ec_group_new_from_data(const struct ec_curve *curve)
 {
@@ -2455,6 +2458,8 @@ ec_group_new_from_data(const struct ec_curve *curve)
 		}
 	}
 
+	group->generator_table = &ec_generator_tables[curve - ec_curve_list];
+
 	ret = group;
 	group = NULL;
 
@@ -295,7 +295,7 @@ EC_KEY_check_key(const EC_KEY *eckey)
 		goto err;
 	}
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	if ((point = EC_POINT_new(eckey->group)) == NULL)
@@ -365,7 +365,7 @@ EC_KEY_set_public_key_affine_coordinates(EC_KEY *key, BIGNUM *x, BIGNUM *y)
 		goto err;
 	}
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -176,7 +176,12 @@ EC_GROUP_copy(EC_GROUP *dest, const EC_GROUP *src)
 	if (!EC_GROUP_set_seed(dest, src->seed, src->seed_len))
 		return 0;
 
-	return dest->meth->group_copy(dest, src);
+	if (!dest->meth->group_copy(dest, src))
+		return 0;
+
+	dest->generator_table = src->generator_table;
+
+	return 1;
 }
 LCRYPTO_ALIAS(EC_GROUP_copy);
 
@@ -249,7 +254,7 @@ ec_set_cofactor(EC_GROUP *group, const BIGNUM *in_cofactor)
 
 	BN_zero(&group->cofactor);
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -341,6 +346,8 @@ EC_GROUP_set_generator(EC_GROUP *group, const EC_POINT *generator,
 		return 0;
 	}
 
+	group->generator_table = NULL;
+
 	if (group->generator == NULL)
 		group->generator = EC_POINT_new(group);
 	if (group->generator == NULL)
@@ -489,7 +496,7 @@ EC_GROUP_set_curve(EC_GROUP *group, const BIGNUM *p, const BIGNUM *a,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -497,6 +504,7 @@ EC_GROUP_set_curve(EC_GROUP *group, const BIGNUM *p, const BIGNUM *a,
 		ECerror(ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
 		goto err;
 	}
+	group->generator_table = NULL;
 	ret = group->meth->group_set_curve(group, p, a, b, ctx);
 
  err:
@@ -515,7 +523,7 @@ EC_GROUP_get_curve(const EC_GROUP *group, BIGNUM *p, BIGNUM *a, BIGNUM *b,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -588,7 +596,7 @@ EC_GROUP_check_discriminant(const EC_GROUP *group, BN_CTX *ctx_in)
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -615,7 +623,7 @@ EC_GROUP_check(const EC_GROUP *group, BN_CTX *ctx_in)
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -675,7 +683,7 @@ EC_GROUP_cmp(const EC_GROUP *group1, const EC_GROUP *group2, BN_CTX *ctx_in)
 	int ret = -1;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -898,7 +906,7 @@ EC_POINT_set_Jprojective_coordinates(const EC_GROUP *group, EC_POINT *point,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -936,7 +944,7 @@ EC_POINT_get_Jprojective_coordinates(const EC_GROUP *group,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -982,7 +990,7 @@ EC_POINT_set_affine_coordinates(const EC_GROUP *group, EC_POINT *point,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1033,7 +1041,7 @@ EC_POINT_get_affine_coordinates(const EC_GROUP *group, const EC_POINT *point,
 	}
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1071,7 +1079,7 @@ EC_POINT_set_compressed_coordinates(const EC_GROUP *group, EC_POINT *point,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1110,7 +1118,7 @@ EC_POINT_add(const EC_GROUP *group, EC_POINT *r, const EC_POINT *a,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1141,7 +1149,7 @@ EC_POINT_dbl(const EC_GROUP *group, EC_POINT *r, const EC_POINT *a,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1170,7 +1178,7 @@ EC_POINT_invert(const EC_GROUP *group, EC_POINT *a, BN_CTX *ctx_in)
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1212,7 +1220,7 @@ EC_POINT_is_on_curve(const EC_GROUP *group, const EC_POINT *point,
 	int ret = -1;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1242,7 +1250,7 @@ EC_POINT_cmp(const EC_GROUP *group, const EC_POINT *a, const EC_POINT *b,
 	int ret = -1;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1271,7 +1279,7 @@ EC_POINT_make_affine(const EC_GROUP *group, EC_POINT *point, BN_CTX *ctx_in)
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1302,7 +1310,7 @@ EC_POINTs_make_affine(const EC_GROUP *group, size_t num, EC_POINT *points[],
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1335,7 +1343,7 @@ EC_POINTs_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -1376,7 +1384,7 @@ EC_POINT_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *g_scalar,
 	int ret = 0;
 
 	if ((ctx = ctx_in) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL)
 		goto err;
 
@@ -198,6 +198,13 @@ struct ec_group_st {
 	/* Montgomery context and values used by EC_GFp_mont_method. */
 	BN_MONT_CTX *mont_ctx;
 	BIGNUM *mont_one;
+
+	/*
+	 * Slot for a process-wide table of precomputed odd multiples of the
+	 * generator, shared by all groups created from the same built-in
+	 * curve. Cleared if the curve or generator is changed.
+	 */
+	struct ec_generator_table **generator_table;
 } /* EC_GROUP */;
 
 struct ec_key_st {
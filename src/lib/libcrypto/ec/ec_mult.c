@@ -71,6 +71,22 @@
 
 #include "ec_local.h"
 
+/*
+ * Window size used for the generator's wNAF when the table of its odd
+ * multiples is precomputed, i.e. 64 points per curve.
+ */
+#define EC_GENERATOR_TABLE_WBITS	7
+
+struct ec_generator_table {
+	EC_POINT **row;
+	size_t row_len;
+	int wbits;
+};
+
+/*
+ * The odd multiples are made affine in one batch, so additions with them are
+ * cheap and larger windows pay off earlier than they would otherwise.
+ */
 static int
 ec_window_bits(const BIGNUM *bn)
 {
@@ -78,12 +94,10 @@ ec_window_bits(const BIGNUM *bn)
 
 	if (bits >= 2000)
 		return 6;
-	if (bits >= 800)
+	if (bits >= 200)
 		return 5;
-	if (bits >= 300)
-		return 4;
 	if (bits >= 70)
-		return 3;
+		return 4;
 	if (bits >= 20)
 		return 2;
 
@@ -96,12 +110,12 @@ ec_window_bits(const BIGNUM *bn)
  */
 
 static int
-ec_compute_wNAF(const BIGNUM *bn, signed char **out_wNAF, size_t *out_wNAF_len,
-    size_t *out_len)
+ec_compute_wNAF(const BIGNUM *bn, int wbits, signed char **out_wNAF,
+    size_t *out_wNAF_len, size_t *out_len)
 {
 	signed char *wNAF = NULL;
 	size_t i, wNAF_len, len;
-	int digit, bit, next, sign, wbits, window;
+	int digit, bit, next, sign, window;
 	int ret = 0;
 
 	wNAF_len = BN_num_bits(bn) + 1;
@@ -110,7 +124,6 @@ ec_compute_wNAF(const BIGNUM *bn, signed char **out_wNAF, size_t *out_wNAF_len,
 		goto err;
 	}
 
-	wbits = ec_window_bits(bn);
 	len = 1 << (wbits - 1);
 
 	sign = BN_is_negative(bn) ? -1 : 1;
@@ -225,7 +238,7 @@ ec_compute_row(const EC_GROUP *group, const BIGNUM *m, const EC_POINT *point,
     signed char **wNAF, size_t *wNAF_len, EC_POINT ***out_row, size_t *out_row_len,
     BN_CTX *ctx)
 {
-	if (!ec_compute_wNAF(m, wNAF, wNAF_len, out_row_len))
+	if (!ec_compute_wNAF(m, ec_window_bits(m), wNAF, wNAF_len, out_row_len))
 		return 0;
 	if (!ec_compute_odd_multiples(group, point, out_row, *out_row_len, ctx))
 		return 0;
@@ -262,66 +275,101 @@ ec_normalize_rows(const EC_GROUP *group, EC_POINT **row0, size_t len0,
 	return ret;
 }
 
-/*
- * Compute r = generator * m + point * n in non-constant time.
- */
+static void
+ec_generator_table_free(struct ec_generator_table *table)
+{
+	if (table == NULL)
+		return;
 
-int
-ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *m,
-    const EC_POINT *point, const BIGNUM *n, BN_CTX *ctx)
+	free_row(table->row, table->row_len);
+	free(table);
+}
+
+static struct ec_generator_table *
+ec_generator_table_new(const EC_GROUP *group, BN_CTX *ctx)
 {
+	struct ec_generator_table *table = NULL;
 	const EC_POINT *generator;
-	signed char *wNAF[2] = { 0 };
-	size_t wNAF_len[2] = { 0 };
-	EC_POINT **row[2] = { 0 };
-	size_t row_len[2] = { 0 };
-	size_t i;
-	int k;
-	int r_is_inverted = 0;
-	size_t max_len = 0;
-	int ret = 0;
 
-	if (m == NULL || n == NULL) {
-		ECerror(ERR_R_PASSED_NULL_PARAMETER);
+	if ((generator = EC_GROUP_get0_generator(group)) == NULL)
 		goto err;
-	}
-	if (group->meth != r->meth || group->meth != point->meth) {
-		ECerror(EC_R_INCOMPATIBLE_OBJECTS);
-		goto err;
-	}
 
-	if ((generator = EC_GROUP_get0_generator(group)) == NULL) {
-		ECerror(EC_R_UNDEFINED_GENERATOR);
+	if ((table = calloc(1, sizeof(*table))) == NULL)
 		goto err;
-	}
+	table->wbits = EC_GENERATOR_TABLE_WBITS;
+	table->row_len = 1 << (table->wbits - 1);
 
-	if (!ec_compute_row(group, m, generator, &wNAF[0], &wNAF_len[0],
-	    &row[0], &row_len[0], ctx))
+	if (!ec_compute_odd_multiples(group, generator, &table->row,
+	    table->row_len, ctx))
 		goto err;
-	if (!ec_compute_row(group, n, point, &wNAF[1], &wNAF_len[1],
-	    &row[1], &row_len[1], ctx))
-		goto err;
-	if (!ec_normalize_rows(group, row[0], row_len[0], row[1], row_len[1], ctx))
+	if (!EC_POINTs_make_affine(group, table->row_len, table->row, ctx))
 		goto err;
 
+	return table;
+
+ err:
+	ec_generator_table_free(table);
+
+	return NULL;
+}
+
+/*
+ * Return the shared table of odd multiples of the generator for groups that
+ * were created from a built-in curve, computing it on first use. The table is
+ * built without holding a lock and published with a compare-and-swap. If
+ * several threads race to build it, all but one discard their copy. Once
+ * published, a table is never modified or freed.
+ */
+static const struct ec_generator_table *
+ec_generator_table(const EC_GROUP *group, BN_CTX *ctx)
+{
+	struct ec_generator_table *table, *expected = NULL;
+
+	if (group->generator_table == NULL)
+		return NULL;
+
+	if ((table = __atomic_load_n(group->generator_table,
+	    __ATOMIC_ACQUIRE)) != NULL)
+		return table;
+
+	if ((table = ec_generator_table_new(group, ctx)) == NULL)
+		return NULL;
+	if (!__atomic_compare_exchange_n(group->generator_table, &expected,
+	    table, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		ec_generator_table_free(table);
+		table = expected;
+	}
+
+	return table;
+}
+
+/*
+ * Scan through the wNAF representations of m and n, starting at the most
+ * significant digit. Double r and for each wNAF digit of m add the digit times
+ * the generator, and for each wNAF digit of n add the digit times the point,
+ * adjusting the signs as appropriate. The rows contain the odd multiples.
+ */
+
+static int
+ec_wNAF_mul_rows(const EC_GROUP *group, EC_POINT *r, signed char *wNAF[2],
+    const size_t wNAF_len[2], EC_POINT **row[2], BN_CTX *ctx)
+{
+	size_t i;
+	int k;
+	int r_is_inverted = 0;
+	size_t max_len = 0;
+
 	max_len = wNAF_len[0];
 	if (wNAF_len[1] > max_len)
 		max_len = wNAF_len[1];
 
-	/*
-	 * Set r to the neutral element. Scan through the wNAF representations
-	 * of m and n, starting at the most significant digit. Double r and for
-	 * each wNAF digit of m add the digit times the generator, and for each
-	 * wNAF digit of n add the digit times the point, adjusting the signs
-	 * as appropriate.
-	 */
-
+	/* Set r to the neutral element. */
 	if (!EC_POINT_set_to_infinity(group, r))
-		goto err;
+		return 0;
 
 	for (k = max_len - 1; k >= 0; k--) {
 		if (!EC_POINT_dbl(group, r, r, ctx))
-			goto err;
+			return 0;
 
 		for (i = 0; i < 2; i++) {
 			int digit;
@@ -340,19 +388,87 @@ ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *m,
 
 			if (is_neg != r_is_inverted) {
 				if (!EC_POINT_invert(group, r, ctx))
-					goto err;
+					return 0;
 				r_is_inverted = !r_is_inverted;
 			}
 
 			if (!EC_POINT_add(group, r, r, row[i][digit >> 1], ctx))
-				goto err;
+				return 0;
 		}
 	}
 
 	if (r_is_inverted) {
 		if (!EC_POINT_invert(group, r, ctx))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Compute r = generator * m + point * n in non-constant time. This is
+ * Straus's interleaved double scalar multiplication, using a wider window and
+ * a precomputed table for the generator if one is available. Otherwise the
+ * odd multiples of the generator are computed along with those of the point.
+ */
+
+int
+ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *m,
+    const EC_POINT *point, const BIGNUM *n, BN_CTX *ctx)
+{
+	const struct ec_generator_table *table;
+	const EC_POINT *generator;
+	signed char *wNAF[2] = { 0 };
+	size_t wNAF_len[2] = { 0 };
+	EC_POINT **row[2] = { 0 };
+	size_t row_len[2] = { 0 };
+	EC_POINT **mul_row[2];
+	int ret = 0;
+
+	if (m == NULL || n == NULL) {
+		ECerror(ERR_R_PASSED_NULL_PARAMETER);
+		goto err;
+	}
+	if (group->meth != r->meth || group->meth != point->meth) {
+		ECerror(EC_R_INCOMPATIBLE_OBJECTS);
+		goto err;
+	}
+
+	if ((generator = EC_GROUP_get0_generator(group)) == NULL) {
+		ECerror(EC_R_UNDEFINED_GENERATOR);
+		goto err;
+	}
+
+	if ((table = ec_generator_table(group, ctx)) != NULL) {
+		if (!ec_compute_wNAF(m, table->wbits, &wNAF[0], &wNAF_len[0],
+		    &row_len[0]))
 			goto err;
+		if (!ec_compute_row(group, n, point, &wNAF[1], &wNAF_len[1],
+		    &row[1], &row_len[1], ctx))
+			goto err;
+		if (!EC_POINTs_make_affine(group, row_len[1], row[1], ctx))
+			goto err;
+
+		/* The table is shared and owned by the built-in curve. */
+		mul_row[0] = table->row;
+		row_len[0] = 0;
+	} else {
+		if (!ec_compute_row(group, m, generator, &wNAF[0], &wNAF_len[0],
+		    &row[0], &row_len[0], ctx))
+			goto err;
+		if (!ec_compute_row(group, n, point, &wNAF[1], &wNAF_len[1],
+		    &row[1], &row_len[1], ctx))
+			goto err;
+		if (!ec_normalize_rows(group, row[0], row_len[0], row[1],
+		    row_len[1], ctx))
+			goto err;
+
+		mul_row[0] = row[0];
 	}
+	mul_row[1] = row[1];
+
+	if (!ec_wNAF_mul_rows(group, r, wNAF, wNAF_len, mul_row, ctx))
+		goto err;
 
 	ret = 1;
 
@@ -85,6 +85,10 @@ ecx_key_clear(struct ecx_key_st *ecx_key)
 	freezero(ecx_key->pub_key, ecx_key->pub_key_len);
 	ecx_key->pub_key = NULL;
 	ecx_key->pub_key_len = 0;
+
+	freezero(ecx_key->expanded_key, ecx_key->expanded_key_len);
+	ecx_key->expanded_key = NULL;
+	ecx_key->expanded_key_len = 0;
 }
 
 static void
@@ -101,7 +105,7 @@ ecx_key_free(struct ecx_key_st *ecx_key)
 static int
 ecx_key_generate(struct ecx_key_st *ecx_key)
 {
-	uint8_t *pub_key = NULL, *priv_key = NULL;
+	uint8_t *pub_key = NULL, *priv_key = NULL, *expanded_key = NULL;
 	int ret = 0;
 
 	ecx_key_clear(ecx_key);
@@ -113,7 +117,12 @@ ecx_key_generate(struct ecx_key_st *ecx_key)
 
 	switch (ecx_key->nid) {
 	case NID_ED25519:
-		ED25519_keypair(pub_key, priv_key);
+		if ((expanded_key = calloc(1,
+		    ED25519_EXPANDED_KEY_LENGTH)) == NULL)
+			goto err;
+		arc4random_buf(priv_key, ecx_key->key_len);
+		ed25519_expand_private_key(expanded_key, priv_key);
+		ed25519_public_from_expanded(pub_key, expanded_key);
 		break;
 	case NID_X25519:
 		X25519_keypair(pub_key, priv_key);
@@ -130,11 +139,18 @@ ecx_key_generate(struct ecx_key_st *ecx_key)
 	ecx_key->pub_key_len = ecx_key->key_len;
 	pub_key = NULL;
 
+	if (expanded_key != NULL) {
+		ecx_key->expanded_key = expanded_key;
+		ecx_key->expanded_key_len = ED25519_EXPANDED_KEY_LENGTH;
+		expanded_key = NULL;
+	}
+
 	ret = 1;
 
  err:
 	freezero(pub_key, ecx_key->key_len);
 	freezero(priv_key, ecx_key->key_len);
+	freezero(expanded_key, ED25519_EXPANDED_KEY_LENGTH);
 
 	return ret;
 }
@@ -143,7 +159,7 @@ static int
 ecx_key_set_priv(struct ecx_key_st *ecx_key, const uint8_t *priv_key,
     size_t priv_key_len)
 {
-	uint8_t *pub_key = NULL;
+	uint8_t *pub_key = NULL, *expanded_key = NULL;
 	CBS cbs;
 
 	ecx_key_clear(ecx_key);
@@ -156,7 +172,11 @@ ecx_key_set_priv(struct ecx_key_st *ecx_key, const uint8_t *priv_key,
 
 	switch (ecx_key->nid) {
 	case NID_ED25519:
-		ED25519_public_from_private(pub_key, priv_key);
+		if ((expanded_key = calloc(1,
+		    ED25519_EXPANDED_KEY_LENGTH)) == NULL)
+			goto err;
+		ed25519_expand_private_key(expanded_key, priv_key);
+		ed25519_public_from_expanded(pub_key, expanded_key);
 		break;
 	case NID_X25519:
 		X25519_public_from_private(pub_key, priv_key);
@@ -173,8 +193,15 @@ ecx_key_set_priv(struct ecx_key_st *ecx_key, const uint8_t *priv_key,
 	ecx_key->pub_key_len = ecx_key->key_len;
 	pub_key = NULL;
 
+	if (expanded_key != NULL) {
+		ecx_key->expanded_key = expanded_key;
+		ecx_key->expanded_key_len = ED25519_EXPANDED_KEY_LENGTH;
+		expanded_key = NULL;
+	}
+
  err:
 	freezero(pub_key, ecx_key->key_len);
+	freezero(expanded_key, ED25519_EXPANDED_KEY_LENGTH);
 
 	return 1;
 }
@@ -841,9 +868,16 @@ pkey_ecx_digestsign(EVP_MD_CTX *md_ctx, unsigned char *out_sig,
 	if (ecx_key->priv_key == NULL || ecx_key->pub_key == NULL)
 		return 0;
 
-	if (!ED25519_sign(out_sig, message, message_len, ecx_key->pub_key,
-	    ecx_key->priv_key))
-		return 0;
+	/* Use the expanded key if it is available, to avoid rehashing the seed. */
+	if (ecx_key->expanded_key != NULL) {
+		if (!ed25519_sign_expanded(out_sig, message, message_len,
+		    ecx_key->pub_key, ecx_key->expanded_key))
+			return 0;
+	} else {
+		if (!ED25519_sign(out_sig, message, message_len,
+		    ecx_key->pub_key, ecx_key->priv_key))
+			return 0;
+	}
 
 	*out_sig_len = ecx_sig_size(pkey_ctx->pkey);
 
@@ -158,7 +158,7 @@ ecdh_compute_key(unsigned char **out, size_t *out_len, const EC_POINT *pub_key,
 	*out = NULL;
 	*out_len = 0;
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -298,7 +298,7 @@ ecdsa_sign_setup(EC_KEY *key, BN_CTX *in_ctx, BIGNUM **out_kinv, BIGNUM **out_r)
 		goto err;
 
 	if ((ctx = in_ctx) == NULL)
-		ctx = BN_CTX_new();
+		ctx = bn_ctx_get_thread();
 	if (ctx == NULL) {
 		ECerror(ERR_R_MALLOC_FAILURE);
 		goto err;
@@ -531,7 +531,7 @@ ecdsa_sign_sig(const unsigned char *digest, int digest_len,
 		goto err;
 	}
 
-	if ((ctx = BN_CTX_new()) == NULL) {
+	if ((ctx = bn_ctx_get_thread()) == NULL) {
 		ECerror(ERR_R_MALLOC_FAILURE);
 		goto err;
 	}
@@ -673,7 +673,7 @@ ecdsa_verify_sig(const unsigned char *digest, int digest_len,
 		goto err;
 	}
 
-	if ((ctx = BN_CTX_new()) == NULL) {
+	if ((ctx = bn_ctx_get_thread()) == NULL) {
 		ECerror(ERR_R_MALLOC_FAILURE);
 		goto err;
 	}
@@ -0,0 +1,496 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Filter BIO that seals or opens data with an EVP_AEAD_STREAM. Input is
+ * collected into batches of one segment per thread. A full batch is only
+ * processed once more input follows it, since the final segment can not be
+ * identified until the end of the input has been seen: when writing this
+ * happens on BIO_flush(), when reading once the next BIO reaches EOF. The
+ * worker threads are started once and kept until the BIO is freed.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+
+#include "bio_local.h"
+#include "crypto_internal.h"
+#include "evp_local.h"
+
+#define BIO_AEAD_STREAM_MAX_THREADS	256
+
+static int aead_stream_write(BIO *h, const char *buf, int num);
+static int aead_stream_read(BIO *h, char *buf, int size);
+static long aead_stream_ctrl(BIO *h, int cmd, long arg1, void *arg2);
+static int aead_stream_new(BIO *h);
+static int aead_stream_free(BIO *data);
+static long aead_stream_callback_ctrl(BIO *h, int cmd, BIO_info_cb *fps);
+
+typedef struct aead_stream_struct {
+	const EVP_AEAD_STREAM *stream;
+	int encrypt;
+	int num_threads;
+	struct crypto_workers *workers;
+	uint64_t segment;	/* number of the next segment */
+	int eof;		/* next BIO has no more data */
+	int finished;		/* final segment has been processed */
+	int ok;			/* no segment has failed */
+	size_t batch_len;	/* input consumed per batch */
+	unsigned char *ibuf;
+	size_t ibuf_size;
+	size_t ibuf_len;
+	unsigned char *obuf;
+	size_t obuf_size;
+	size_t obuf_len;
+	size_t obuf_off;
+} BIO_AEAD_STREAM_CTX;
+
+static const BIO_METHOD methods_aead_stream = {
+	.type = BIO_TYPE_AEAD_STREAM,
+	.name = "aead stream",
+	.bwrite = aead_stream_write,
+	.bread = aead_stream_read,
+	.ctrl = aead_stream_ctrl,
+	.create = aead_stream_new,
+	.destroy = aead_stream_free,
+	.callback_ctrl = aead_stream_callback_ctrl
+};
+
+const BIO_METHOD *
+BIO_f_aead_stream(void)
+{
+	return &methods_aead_stream;
+}
+LCRYPTO_ALIAS(BIO_f_aead_stream);
+
+static void
+bio_aead_stream_ctx_reset(BIO_AEAD_STREAM_CTX *ctx)
+{
+	ctx->segment = 0;
+	ctx->eof = 0;
+	ctx->finished = 0;
+	ctx->ok = 1;
+	ctx->ibuf_len = 0;
+	ctx->obuf_len = 0;
+	ctx->obuf_off = 0;
+}
+
+static void
+bio_aead_stream_ctx_free(BIO_AEAD_STREAM_CTX *ctx)
+{
+	if (ctx == NULL)
+		return;
+
+	crypto_workers_free(ctx->workers);
+	freezero(ctx->ibuf, ctx->ibuf_size);
+	freezero(ctx->obuf, ctx->obuf_size);
+	freezero(ctx, sizeof(*ctx));
+}
+
+static int
+aead_stream_new(BIO *bio)
+{
+	BIO_AEAD_STREAM_CTX *ctx;
+
+	if ((ctx = calloc(1, sizeof(*ctx))) == NULL)
+		return 0;
+
+	bio_aead_stream_ctx_reset(ctx);
+
+	bio->ptr = ctx;
+
+	return 1;
+}
+
+static int
+aead_stream_free(BIO *bio)
+{
+	if (bio == NULL)
+		return 0;
+
+	bio_aead_stream_ctx_free(bio->ptr);
+	explicit_bzero(bio, sizeof(*bio));
+
+	return 1;
+}
+
+/*
+ * Seal or open the first in_len bytes of the input buffer, leaving the
+ * result in the output buffer.
+ */
+static int
+aead_stream_process(BIO_AEAD_STREAM_CTX *ctx, size_t in_len, int last)
+{
+	size_t unit;
+	int ret;
+
+	if (ctx->segment > UINT32_MAX) {
+		EVPerror(EVP_R_TOO_LARGE);
+		goto err;
+	}
+
+	unit = EVP_AEAD_STREAM_segment_length(ctx->stream);
+	if (ctx->encrypt) {
+		ret = evp_aead_stream_seal_segments_workers(ctx->stream,
+		    ctx->obuf, &ctx->obuf_len, ctx->obuf_size, ctx->segment,
+		    last, ctx->ibuf, in_len, ctx->workers);
+	} else {
+		unit += EVP_AEAD_STREAM_overhead(ctx->stream);
+		ret = evp_aead_stream_open_segments_workers(ctx->stream,
+		    ctx->obuf, &ctx->obuf_len, ctx->obuf_size, ctx->segment,
+		    last, ctx->ibuf, in_len, ctx->workers);
+	}
+	if (!ret)
+		goto err;
+
+	ctx->obuf_off = 0;
+	ctx->segment += in_len / unit;
+	memmove(ctx->ibuf, ctx->ibuf + in_len, ctx->ibuf_len - in_len);
+	ctx->ibuf_len -= in_len;
+	if (last)
+		ctx->finished = 1;
+
+	return 1;
+
+ err:
+	ctx->obuf_len = 0;
+	ctx->obuf_off = 0;
+	ctx->ok = 0;
+
+	return 0;
+}
+
+static int
+aead_stream_write_pending(BIO *bio, BIO_AEAD_STREAM_CTX *ctx)
+{
+	size_t n;
+	int i;
+
+	while (ctx->obuf_off < ctx->obuf_len) {
+		n = ctx->obuf_len - ctx->obuf_off;
+		if (n > INT_MAX)
+			n = INT_MAX;
+		i = BIO_write(bio->next_bio, ctx->obuf + ctx->obuf_off, n);
+		if (i <= 0) {
+			BIO_copy_next_retry(bio);
+			return i;
+		}
+		ctx->obuf_off += i;
+	}
+	ctx->obuf_len = 0;
+	ctx->obuf_off = 0;
+
+	return 1;
+}
+
+/*
+ * Read from the next BIO until a full batch and at least one byte after it
+ * are buffered, or until EOF.
+ */
+static int
+aead_stream_fill(BIO *bio, BIO_AEAD_STREAM_CTX *ctx)
+{
+	size_t n;
+	int i;
+
+	while (!ctx->eof && ctx->ibuf_len < ctx->ibuf_size) {
+		n = ctx->ibuf_size - ctx->ibuf_len;
+		if (n > INT_MAX)
+			n = INT_MAX;
+		i = BIO_read(bio->next_bio, ctx->ibuf + ctx->ibuf_len, n);
+		if (i <= 0) {
+			if (BIO_should_retry(bio->next_bio)) {
+				BIO_copy_next_retry(bio);
+				return i;
+			}
+			ctx->eof = 1;
+			break;
+		}
+		ctx->ibuf_len += i;
+	}
+
+	return 1;
+}
+
+static int
+aead_stream_read(BIO *bio, char *out, int outl)
+{
+	BIO_AEAD_STREAM_CTX *ctx;
+	size_t n;
+	int ret = 0, i;
+
+	if (out == NULL || outl <= 0)
+		return 0;
+	ctx = bio->ptr;
+
+	if (ctx == NULL || ctx->stream == NULL || bio->next_bio == NULL)
+		return 0;
+
+	BIO_clear_retry_flags(bio);
+
+	while (outl > 0) {
+		if (ctx->obuf_off < ctx->obuf_len) {
+			n = ctx->obuf_len - ctx->obuf_off;
+			if (n > (size_t)outl)
+				n = outl;
+			memcpy(out, ctx->obuf + ctx->obuf_off, n);
+			ctx->obuf_off += n;
+			out += n;
+			outl -= n;
+			ret += n;
+			continue;
+		}
+
+		if (ctx->finished || !ctx->ok)
+			break;
+
+		if ((i = aead_stream_fill(bio, ctx)) <= 0)
+			return ret == 0 ? i : ret;
+
+		if (ctx->eof)
+			aead_stream_process(ctx, ctx->ibuf_len, 1);
+		else
+			aead_stream_process(ctx, ctx->batch_len, 0);
+	}
+
+	if (ret == 0 && !ctx->ok)
+		return -1;
+
+	return ret;
+}
+
+static int
+aead_stream_write(BIO *bio, const char *in, int inl)
+{
+	BIO_AEAD_STREAM_CTX *ctx;
+	size_t n;
+	int ret = 0, i;
+
+	ctx = bio->ptr;
+
+	if (ctx == NULL || ctx->stream == NULL || bio->next_bio == NULL)
+		return 0;
+
+	BIO_clear_retry_flags(bio);
+
+	if ((i = aead_stream_write_pending(bio, ctx)) <= 0)
+		return i;
+
+	if (in == NULL || inl <= 0)
+		return 0;
+
+	if (ctx->finished || !ctx->ok)
+		return -1;
+
+	while (inl > 0) {
+		if (ctx->ibuf_len == ctx->batch_len) {
+			if (!aead_stream_process(ctx, ctx->batch_len, 0))
+				return ret == 0 ? -1 : ret;
+			if ((i = aead_stream_write_pending(bio, ctx)) <= 0)
+				return ret == 0 ? i : ret;
+		}
+
+		n = ctx->batch_len - ctx->ibuf_len;
+		if (n > (size_t)inl)
+			n = inl;
+		memcpy(ctx->ibuf + ctx->ibuf_len, in, n);
+		ctx->ibuf_len += n;
+		in += n;
+		inl -= n;
+		ret += n;
+	}
+
+	return ret;
+}
+
+static long
+aead_stream_ctrl(BIO *bio, int cmd, long num, void *ptr)
+{
+	BIO_AEAD_STREAM_CTX *ctx;
+	BIO *dbio;
+	long ret = 1;
+	int i;
+
+	ctx = bio->ptr;
+
+	switch (cmd) {
+	case BIO_CTRL_RESET:
+		bio_aead_stream_ctx_reset(ctx);
+		ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		break;
+	case BIO_CTRL_EOF:	/* More to read */
+		if (ctx->finished || !ctx->ok)
+			ret = ctx->obuf_off == ctx->obuf_len;
+		else
+			ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		break;
+	case BIO_CTRL_WPENDING:
+		ret = ctx->obuf_len - ctx->obuf_off + ctx->ibuf_len;
+		if (ret <= 0)
+			ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		break;
+	case BIO_CTRL_PENDING: /* More to read in buffer */
+		ret = ctx->obuf_len - ctx->obuf_off;
+		if (ret <= 0)
+			ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		break;
+	case BIO_CTRL_FLUSH:
+		BIO_clear_retry_flags(bio);
+		if (ctx->stream != NULL) {
+			/* Write out any earlier batch, then the final one. */
+			if ((i = aead_stream_write_pending(bio, ctx)) <= 0)
+				return i;
+			if (!ctx->finished) {
+				if (!ctx->ok ||
+				    !aead_stream_process(ctx, ctx->ibuf_len, 1))
+					return 0;
+				if ((i = aead_stream_write_pending(bio,
+				    ctx)) <= 0)
+					return i;
+			}
+		}
+
+		/* Finally flush the underlying BIO */
+		ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		break;
+	case BIO_C_GET_CIPHER_STATUS:
+		ret = (long)ctx->ok;
+		break;
+	case BIO_C_DO_STATE_MACHINE:
+		BIO_clear_retry_flags(bio);
+		ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		BIO_copy_next_retry(bio);
+		break;
+	case BIO_CTRL_DUP:
+		dbio = ptr;
+		ret = 1;
+		if (ctx->stream != NULL)
+			ret = BIO_set_aead_stream(dbio, ctx->stream,
+			    ctx->encrypt, ctx->num_threads);
+		break;
+	default:
+		ret = BIO_ctrl(bio->next_bio, cmd, num, ptr);
+		break;
+	}
+
+	return ret;
+}
+
+static long
+aead_stream_callback_ctrl(BIO *bio, int cmd, BIO_info_cb *fp)
+{
+	long ret = 1;
+
+	if (bio->next_bio == NULL)
+		return 0;
+
+	switch (cmd) {
+	default:
+		ret = BIO_callback_ctrl(bio->next_bio, cmd, fp);
+		break;
+	}
+
+	return ret;
+}
+
+int
+BIO_set_aead_stream(BIO *bio, const EVP_AEAD_STREAM *stream, int enc,
+    int num_threads)
+{
+	BIO_AEAD_STREAM_CTX *ctx;
+	struct crypto_workers *workers = NULL;
+	unsigned char *ibuf = NULL, *obuf = NULL;
+	size_t ibuf_size, obuf_size, batch, unit, ct_len;
+	long (*cb)(BIO *, int, const char *, int, long, long);
+
+	if (bio == NULL || stream == NULL)
+		return 0;
+
+	if ((ctx = BIO_get_data(bio)) == NULL)
+		return 0;
+
+	if ((cb = BIO_get_callback(bio)) != NULL) {
+		if (cb(bio, BIO_CB_CTRL, (const char *)stream, BIO_CTRL_SET,
+		    enc, 0L) <= 0)
+			return 0;
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > BIO_AEAD_STREAM_MAX_THREADS)
+		num_threads = BIO_AEAD_STREAM_MAX_THREADS;
+	batch = num_threads;
+
+	/*
+	 * The input buffer holds a batch and the byte after it. Opening all
+	 * of that at EOF, or sealing it, produces at most one more segment
+	 * than a batch.
+	 */
+	ct_len = EVP_AEAD_STREAM_segment_length(stream) +
+	    EVP_AEAD_STREAM_overhead(stream);
+	unit = enc ? EVP_AEAD_STREAM_segment_length(stream) : ct_len;
+	if (ct_len > (SIZE_MAX - 1) / (batch + 1)) {
+		EVPerror(EVP_R_TOO_LARGE);
+		return 0;
+	}
+	ibuf_size = batch * unit + 1;
+	obuf_size = (batch + 1) * ct_len;
+
+	if ((ibuf = malloc(ibuf_size)) == NULL)
+		goto err;
+	if ((obuf = malloc(obuf_size)) == NULL)
+		goto err;
+	if (num_threads > 1 &&
+	    (workers = crypto_workers_new(num_threads)) == NULL)
+		goto err;
+
+	crypto_workers_free(ctx->workers);
+	freezero(ctx->ibuf, ctx->ibuf_size);
+	freezero(ctx->obuf, ctx->obuf_size);
+
+	ctx->stream = stream;
+	ctx->encrypt = enc != 0;
+	ctx->num_threads = num_threads;
+	ctx->workers = workers;
+	ctx->batch_len = batch * unit;
+	ctx->ibuf = ibuf;
+	ctx->ibuf_size = ibuf_size;
+	ctx->obuf = obuf;
+	ctx->obuf_size = obuf_size;
+	bio_aead_stream_ctx_reset(ctx);
+
+	BIO_set_init(bio, 1);
+
+	if (cb != NULL)
+		return cb(bio, BIO_CB_CTRL, (const char *)stream, BIO_CTRL_SET,
+		    enc, 1L);
+
+	return 1;
+
+ err:
+	EVPerror(ERR_R_MALLOC_FAILURE);
+	free(ibuf);
+	free(obuf);
+
+	return 0;
+}
+LCRYPTO_ALIAS(BIO_set_aead_stream);
@@ -62,6 +62,7 @@
 #include <openssl/err.h>
 #include <openssl/evp.h>
 
+#include "aes_internal.h"
 #include "evp_local.h"
 #include "modes_local.h"
 
@@ -239,6 +240,13 @@ static int
 aesni_cbc_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
     const unsigned char *in, size_t len)
 {
+#ifdef HAVE_AES_VAES
+	if (!ctx->encrypt && aes_vaes_capable()) {
+		aes_cbc_decrypt_vaes(in, out, len, ctx->cipher_data, ctx->iv);
+		return 1;
+	}
+#endif
+
 	aesni_cbc_encrypt(in, out, len, ctx->cipher_data, ctx->iv,
 	    ctx->encrypt);
 
@@ -321,6 +329,12 @@ aesni_xts_init_key(EVP_CIPHER_CTX *ctx, const unsigned char *key,
 		    ctx->key_len * 4, &xctx->ks2);
 		xctx->xts.block2 = (block128_f)aesni_encrypt;
 
+#ifdef HAVE_AES_VAES
+		if (aes_vaes_capable())
+			xctx->stream = enc ? aes_xts_encrypt_vaes :
+			    aes_xts_decrypt_vaes;
+#endif
+
 		xctx->xts.key1 = &xctx->ks1;
 	}
 
@@ -2463,6 +2477,561 @@ EVP_aead_aes_256_gcm(void)
 }
 LCRYPTO_ALIAS(EVP_aead_aes_256_gcm);
 
+#define EVP_AEAD_AES_GCM_SIV_NONCE_LEN	12
+#define EVP_AEAD_AES_GCM_SIV_TAG_LEN	16
+
+/* Maximum plaintext and additional data length, as per RFC 8452. */
+#define EVP_AEAD_AES_GCM_SIV_MAX_LEN	(1ULL << 36)
+
+/* Number of counter blocks to encrypt per call to the ECB function. */
+#define EVP_AEAD_AES_GCM_SIV_CTR_BLOCKS	16
+
+struct aead_aes_gcm_siv_ctx {
+	union {
+		double align;
+		AES_KEY ks;
+	} ks;			/* key generating key */
+	int (*set_key)(const unsigned char *key, int bits, AES_KEY *aes_key);
+	block128_f block;
+	void (*ecb)(const unsigned char *in, unsigned char *out, size_t len,
+	    const AES_KEY *key, int enc);
+	int key_bits;
+};
+
+static int
+aead_aes_gcm_siv_init(EVP_AEAD_CTX *ctx, const unsigned char *key,
+    size_t key_len, size_t tag_len)
+{
+	struct aead_aes_gcm_siv_ctx *gcm_siv_ctx;
+	const size_t key_bits = key_len * 8;
+
+	/* EVP_AEAD_CTX_init should catch this. */
+	if (key_bits != 128 && key_bits != 256) {
+		EVPerror(EVP_R_BAD_KEY_LENGTH);
+		return 0;
+	}
+
+	if (tag_len == EVP_AEAD_DEFAULT_TAG_LENGTH)
+		tag_len = EVP_AEAD_AES_GCM_SIV_TAG_LEN;
+
+	if (tag_len > EVP_AEAD_AES_GCM_SIV_TAG_LEN) {
+		EVPerror(EVP_R_TAG_TOO_LARGE);
+		return 0;
+	}
+	if (tag_len != EVP_AEAD_AES_GCM_SIV_TAG_LEN) {
+		EVPerror(EVP_R_INVALID_OPERATION);
+		return 0;
+	}
+
+	if ((gcm_siv_ctx = calloc(1, sizeof(*gcm_siv_ctx))) == NULL)
+		return 0;
+
+#ifdef AESNI_CAPABLE
+	if (AESNI_CAPABLE) {
+		gcm_siv_ctx->set_key = aesni_set_encrypt_key;
+		gcm_siv_ctx->block = (block128_f)aesni_encrypt;
+		gcm_siv_ctx->ecb = aesni_ecb_encrypt;
+	} else
+#endif
+	{
+		gcm_siv_ctx->set_key = AES_set_encrypt_key;
+		gcm_siv_ctx->block = (block128_f)AES_encrypt;
+		gcm_siv_ctx->ecb = NULL;
+	}
+	gcm_siv_ctx->key_bits = key_bits;
+	gcm_siv_ctx->set_key(key, key_bits, &gcm_siv_ctx->ks.ks);
+
+	ctx->aead_state = gcm_siv_ctx;
+
+	return 1;
+}
+
+static void
+aead_aes_gcm_siv_cleanup(EVP_AEAD_CTX *ctx)
+{
+	struct aead_aes_gcm_siv_ctx *gcm_siv_ctx = ctx->aead_state;
+
+	freezero(gcm_siv_ctx, sizeof(*gcm_siv_ctx));
+}
+
+/*
+ * Derive the per-message authentication and encryption keys from the key
+ * generating key and the nonce.
+ */
+static void
+aead_aes_gcm_siv_derive_keys(const struct aead_aes_gcm_siv_ctx *gcm_siv_ctx,
+    const unsigned char *nonce, unsigned char auth_key[16], AES_KEY *enc_key)
+{
+	unsigned char in[16], out[16], key[32];
+	uint32_t i;
+
+	memset(in, 0, sizeof(in));
+	memcpy(&in[4], nonce, EVP_AEAD_AES_GCM_SIV_NONCE_LEN);
+
+	for (i = 0; i < 2 + gcm_siv_ctx->key_bits / 64; i++) {
+		crypto_store_htole32(in, i);
+		gcm_siv_ctx->block(in, out, &gcm_siv_ctx->ks.ks);
+		if (i < 2)
+			memcpy(&auth_key[i * 8], out, 8);
+		else
+			memcpy(&key[(i - 2) * 8], out, 8);
+	}
+	gcm_siv_ctx->set_key(key, gcm_siv_ctx->key_bits, enc_key);
+
+	explicit_bzero(out, sizeof(out));
+	explicit_bzero(key, sizeof(key));
+}
+
+static void
+aead_aes_gcm_siv_tag(const struct aead_aes_gcm_siv_ctx *gcm_siv_ctx,
+    const unsigned char auth_key[16], const AES_KEY *enc_key,
+    const unsigned char *nonce, const unsigned char *in, size_t in_len,
+    const unsigned char *ad, size_t ad_len, unsigned char tag[16])
+{
+	GCM128_CONTEXT polyval;
+	unsigned char lengths[16];
+	size_t i;
+
+	crypto_store_htole64(&lengths[0], (uint64_t)ad_len * 8);
+	crypto_store_htole64(&lengths[8], (uint64_t)in_len * 8);
+
+	gcm128_polyval_init(&polyval, auth_key);
+	gcm128_polyval_update(&polyval, ad, ad_len);
+	gcm128_polyval_update(&polyval, in, in_len);
+	gcm128_polyval_update(&polyval, lengths, sizeof(lengths));
+	gcm128_polyval_final(&polyval, tag);
+
+	for (i = 0; i < EVP_AEAD_AES_GCM_SIV_NONCE_LEN; i++)
+		tag[i] ^= nonce[i];
+	tag[15] &= 0x7f;
+
+	gcm_siv_ctx->block(tag, tag, enc_key);
+
+	explicit_bzero(&polyval, sizeof(polyval));
+}
+
+/*
+ * Encrypt or decrypt using CTR mode with the tag as the initial counter
+ * block - the top bit is set and the first four bytes are incremented as a
+ * little endian counter.
+ */
+static void
+aead_aes_gcm_siv_ctr(const struct aead_aes_gcm_siv_ctx *gcm_siv_ctx,
+    const AES_KEY *enc_key, const unsigned char tag[16],
+    const unsigned char *in, unsigned char *out, size_t len)
+{
+	unsigned char counters[EVP_AEAD_AES_GCM_SIV_CTR_BLOCKS * 16];
+	unsigned char keystream[EVP_AEAD_AES_GCM_SIV_CTR_BLOCKS * 16];
+	size_t blocks, i, n;
+	uint64_t k, v;
+	uint32_t ctr;
+
+	for (i = 0; i < EVP_AEAD_AES_GCM_SIV_CTR_BLOCKS; i++) {
+		memcpy(&counters[i * 16], tag, 16);
+		counters[i * 16 + 15] |= 0x80;
+	}
+	ctr = crypto_load_le32toh(tag);
+
+	while (len > 0) {
+		n = len < sizeof(keystream) ? len : sizeof(keystream);
+		blocks = (n + 15) / 16;
+
+		for (i = 0; i < blocks; i++)
+			crypto_store_htole32(&counters[i * 16], ctr++);
+
+		if (gcm_siv_ctx->ecb != NULL) {
+			gcm_siv_ctx->ecb(counters, keystream, blocks * 16,
+			    enc_key, 1);
+		} else {
+			for (i = 0; i < blocks; i++)
+				gcm_siv_ctx->block(&counters[i * 16],
+				    &keystream[i * 16], enc_key);
+		}
+
+		for (i = 0; i + 8 <= n; i += 8) {
+			memcpy(&v, &in[i], sizeof(v));
+			memcpy(&k, &keystream[i], sizeof(k));
+			v ^= k;
+			memcpy(&out[i], &v, sizeof(v));
+		}
+		for (; i < n; i++)
+			out[i] = in[i] ^ keystream[i];
+
+		in += n;
+		out += n;
+		len -= n;
+	}
+
+	explicit_bzero(keystream, sizeof(keystream));
+}
+
+static int
+aead_aes_gcm_siv_seal(const EVP_AEAD_CTX *ctx, unsigned char *out,
+    size_t *out_len, size_t max_out_len, const unsigned char *nonce,
+    size_t nonce_len, const unsigned char *in, size_t in_len,
+    const unsigned char *ad, size_t ad_len)
+{
+	const struct aead_aes_gcm_siv_ctx *gcm_siv_ctx = ctx->aead_state;
+	unsigned char auth_key[16], tag[EVP_AEAD_AES_GCM_SIV_TAG_LEN];
+	AES_KEY enc_key;
+
+	if (max_out_len < in_len + EVP_AEAD_AES_GCM_SIV_TAG_LEN) {
+		EVPerror(EVP_R_BUFFER_TOO_SMALL);
+		return 0;
+	}
+	if (nonce_len != EVP_AEAD_AES_GCM_SIV_NONCE_LEN) {
+		EVPerror(EVP_R_INVALID_IV_LENGTH);
+		return 0;
+	}
+	if (in_len > EVP_AEAD_AES_GCM_SIV_MAX_LEN ||
+	    ad_len > EVP_AEAD_AES_GCM_SIV_MAX_LEN) {
+		EVPerror(EVP_R_TOO_LARGE);
+		return 0;
+	}
+
+	aead_aes_gcm_siv_derive_keys(gcm_siv_ctx, nonce, auth_key, &enc_key);
+	aead_aes_gcm_siv_tag(gcm_siv_ctx, auth_key, &enc_key, nonce, in,
+	    in_len, ad, ad_len, tag);
+	aead_aes_gcm_siv_ctr(gcm_siv_ctx, &enc_key, tag, in, out, in_len);
+
+	memcpy(out + in_len, tag, sizeof(tag));
+	*out_len = in_len + sizeof(tag);
+
+	explicit_bzero(auth_key, sizeof(auth_key));
+	explicit_bzero(&enc_key, sizeof(enc_key));
+
+	return 1;
+}
+
+static int
+aead_aes_gcm_siv_open(const EVP_AEAD_CTX *ctx, unsigned char *out,
+    size_t *out_len, size_t max_out_len, const unsigned char *nonce,
+    size_t nonce_len, const unsigned char *in, size_t in_len,
+    const unsigned char *ad, size_t ad_len)
+{
+	const struct aead_aes_gcm_siv_ctx *gcm_siv_ctx = ctx->aead_state;
+	unsigned char auth_key[16], tag[EVP_AEAD_AES_GCM_SIV_TAG_LEN];
+	unsigned char expected_tag[EVP_AEAD_AES_GCM_SIV_TAG_LEN];
+	AES_KEY enc_key;
+	size_t plaintext_len;
+	int ret = 0;
+
+	if (in_len < EVP_AEAD_AES_GCM_SIV_TAG_LEN) {
+		EVPerror(EVP_R_BAD_DECRYPT);
+		return 0;
+	}
+
+	plaintext_len = in_len - EVP_AEAD_AES_GCM_SIV_TAG_LEN;
+
+	if (max_out_len < plaintext_len) {
+		EVPerror(EVP_R_BUFFER_TOO_SMALL);
+		return 0;
+	}
+	if (nonce_len != EVP_AEAD_AES_GCM_SIV_NONCE_LEN) {
+		EVPerror(EVP_R_INVALID_IV_LENGTH);
+		return 0;
+	}
+	if (plaintext_len > EVP_AEAD_AES_GCM_SIV_MAX_LEN ||
+	    ad_len > EVP_AEAD_AES_GCM_SIV_MAX_LEN) {
+		EVPerror(EVP_R_TOO_LARGE);
+		return 0;
+	}
+
+	memcpy(expected_tag, in + plaintext_len, sizeof(expected_tag));
+
+	aead_aes_gcm_siv_derive_keys(gcm_siv_ctx, nonce, auth_key, &enc_key);
+	aead_aes_gcm_siv_ctr(gcm_siv_ctx, &enc_key, expected_tag, in, out,
+	    plaintext_len);
+	aead_aes_gcm_siv_tag(gcm_siv_ctx, auth_key, &enc_key, nonce, out,
+	    plaintext_len, ad, ad_len, tag);
+
+	if (timingsafe_memcmp(tag, expected_tag, sizeof(tag)) != 0) {
+		explicit_bzero(out, plaintext_len);
+		EVPerror(EVP_R_BAD_DECRYPT);
+		goto err;
+	}
+
+	*out_len = plaintext_len;
+
+	ret = 1;
+
+ err:
+	explicit_bzero(auth_key, sizeof(auth_key));
+	explicit_bzero(&enc_key, sizeof(enc_key));
+
+	return ret;
+}
+
+static const EVP_AEAD aead_aes_128_gcm_siv = {
+	.key_len = 16,
+	.nonce_len = EVP_AEAD_AES_GCM_SIV_NONCE_LEN,
+	.overhead = EVP_AEAD_AES_GCM_SIV_TAG_LEN,
+	.max_tag_len = EVP_AEAD_AES_GCM_SIV_TAG_LEN,
+
+	.init = aead_aes_gcm_siv_init,
+	.cleanup = aead_aes_gcm_siv_cleanup,
+	.seal = aead_aes_gcm_siv_seal,
+	.open = aead_aes_gcm_siv_open,
+};
+
+static const EVP_AEAD aead_aes_256_gcm_siv = {
+	.key_len = 32,
+	.nonce_len = EVP_AEAD_AES_GCM_SIV_NONCE_LEN,
+	.overhead = EVP_AEAD_AES_GCM_SIV_TAG_LEN,
+	.max_tag_len = EVP_AEAD_AES_GCM_SIV_TAG_LEN,
+
+	.init = aead_aes_gcm_siv_init,
+	.cleanup = aead_aes_gcm_siv_cleanup,
+	.seal = aead_aes_gcm_siv_seal,
+	.open = aead_aes_gcm_siv_open,
+};
+
+const EVP_AEAD *
+EVP_aead_aes_128_gcm_siv(void)
+{
+	return &aead_aes_128_gcm_siv;
+}
+LCRYPTO_ALIAS(EVP_aead_aes_128_gcm_siv);
+
+const EVP_AEAD *
+EVP_aead_aes_256_gcm_siv(void)
+{
+	return &aead_aes_256_gcm_siv;
+}
+LCRYPTO_ALIAS(EVP_aead_aes_256_gcm_siv);
+
+#define EVP_AEAD_AES_CCM_NONCE_LEN	12
+#define EVP_AEAD_AES_CCM_TAG_LEN	16
+
+/* The length field size in bytes (L), given the 12 byte nonce. */
+#define EVP_AEAD_AES_CCM_L		(15 - EVP_AEAD_AES_CCM_NONCE_LEN)
+#define EVP_AEAD_AES_CCM_MAX_LEN	(1ULL << (EVP_AEAD_AES_CCM_L * 8))
+
+struct aead_aes_ccm_ctx {
+	union {
+		double align;
+		AES_KEY ks;
+	} ks;
+	CCM128_CONTEXT ccm;
+	ccm128_f encrypt_blocks;
+	ccm128_f decrypt_blocks;
+	unsigned char tag_len;
+};
+
+static int
+aead_aes_ccm_init(EVP_AEAD_CTX *ctx, const unsigned char *key, size_t key_len,
+    size_t tag_len)
+{
+	struct aead_aes_ccm_ctx *ccm_ctx;
+	const size_t key_bits = key_len * 8;
+
+	/* EVP_AEAD_CTX_init should catch this. */
+	if (key_bits != 128 && key_bits != 256) {
+		EVPerror(EVP_R_BAD_KEY_LENGTH);
+		return 0;
+	}
+
+	if (tag_len == EVP_AEAD_DEFAULT_TAG_LENGTH)
+		tag_len = EVP_AEAD_AES_CCM_TAG_LEN;
+
+	if (tag_len > EVP_AEAD_AES_CCM_TAG_LEN) {
+		EVPerror(EVP_R_TAG_TOO_LARGE);
+		return 0;
+	}
+
+	/* CCM tags must be an even number of bytes, from 4 to 16. */
+	if (tag_len < 4 || (tag_len & 1) != 0) {
+		EVPerror(EVP_R_INVALID_OPERATION);
+		return 0;
+	}
+
+	if ((ccm_ctx = calloc(1, sizeof(*ccm_ctx))) == NULL)
+		return 0;
+
+#ifdef AESNI_CAPABLE
+	if (AESNI_CAPABLE) {
+		/* CTR and CBC-MAC are interleaved within the AES-NI code. */
+		aesni_set_encrypt_key(key, key_bits, &ccm_ctx->ks.ks);
+		CRYPTO_ccm128_init(&ccm_ctx->ccm, tag_len, EVP_AEAD_AES_CCM_L,
+		    &ccm_ctx->ks.ks, (block128_f)aesni_encrypt);
+		ccm_ctx->encrypt_blocks = (ccm128_f)aesni_ccm64_encrypt_blocks;
+		ccm_ctx->decrypt_blocks = (ccm128_f)aesni_ccm64_decrypt_blocks;
+	} else
+#endif
+	{
+		AES_set_encrypt_key(key, key_bits, &ccm_ctx->ks.ks);
+		CRYPTO_ccm128_init(&ccm_ctx->ccm, tag_len, EVP_AEAD_AES_CCM_L,
+		    &ccm_ctx->ks.ks, (block128_f)AES_encrypt);
+	}
+	ccm_ctx->tag_len = tag_len;
+	ctx->aead_state = ccm_ctx;
+
+	return 1;
+}
+
+static void
+aead_aes_ccm_cleanup(EVP_AEAD_CTX *ctx)
+{
+	struct aead_aes_ccm_ctx *ccm_ctx = ctx->aead_state;
+
+	freezero(ccm_ctx, sizeof(*ccm_ctx));
+}
+
+static int
+aead_aes_ccm_seal(const EVP_AEAD_CTX *ctx, unsigned char *out,
+    size_t *out_len, size_t max_out_len, const unsigned char *nonce,
+    size_t nonce_len, const unsigned char *in, size_t in_len,
+    const unsigned char *ad, size_t ad_len)
+{
+	const struct aead_aes_ccm_ctx *ccm_ctx = ctx->aead_state;
+	CCM128_CONTEXT ccm;
+	int ret = 0;
+
+	if (max_out_len < in_len + ccm_ctx->tag_len) {
+		EVPerror(EVP_R_BUFFER_TOO_SMALL);
+		return 0;
+	}
+	if (nonce_len != EVP_AEAD_AES_CCM_NONCE_LEN) {
+		EVPerror(EVP_R_INVALID_IV_LENGTH);
+		return 0;
+	}
+	if (in_len >= EVP_AEAD_AES_CCM_MAX_LEN) {
+		EVPerror(EVP_R_TOO_LARGE);
+		return 0;
+	}
+
+	memcpy(&ccm, &ccm_ctx->ccm, sizeof(ccm));
+
+	if (CRYPTO_ccm128_setiv(&ccm, nonce, nonce_len, in_len) != 0)
+		goto err;
+	CRYPTO_ccm128_aad(&ccm, ad, ad_len);
+
+	if (ccm_ctx->encrypt_blocks != NULL) {
+		if (CRYPTO_ccm128_encrypt_ccm64(&ccm, in, out, in_len,
+		    ccm_ctx->encrypt_blocks) != 0)
+			goto err;
+	} else {
+		if (CRYPTO_ccm128_encrypt(&ccm, in, out, in_len) != 0)
+			goto err;
+	}
+
+	if (CRYPTO_ccm128_tag(&ccm, out + in_len, ccm_ctx->tag_len) !=
+	    ccm_ctx->tag_len)
+		goto err;
+	*out_len = in_len + ccm_ctx->tag_len;
+
+	ret = 1;
+
+ err:
+	explicit_bzero(&ccm, sizeof(ccm));
+
+	return ret;
+}
+
+static int
+aead_aes_ccm_open(const EVP_AEAD_CTX *ctx, unsigned char *out,
+    size_t *out_len, size_t max_out_len, const unsigned char *nonce,
+    size_t nonce_len, const unsigned char *in, size_t in_len,
+    const unsigned char *ad, size_t ad_len)
+{
+	const struct aead_aes_ccm_ctx *ccm_ctx = ctx->aead_state;
+	unsigned char tag[EVP_AEAD_AES_CCM_TAG_LEN];
+	CCM128_CONTEXT ccm;
+	size_t plaintext_len;
+	int ret = 0;
+
+	if (in_len < ccm_ctx->tag_len) {
+		EVPerror(EVP_R_BAD_DECRYPT);
+		return 0;
+	}
+
+	plaintext_len = in_len - ccm_ctx->tag_len;
+
+	if (max_out_len < plaintext_len) {
+		EVPerror(EVP_R_BUFFER_TOO_SMALL);
+		return 0;
+	}
+	if (nonce_len != EVP_AEAD_AES_CCM_NONCE_LEN) {
+		EVPerror(EVP_R_INVALID_IV_LENGTH);
+		return 0;
+	}
+	if (plaintext_len >= EVP_AEAD_AES_CCM_MAX_LEN) {
+		EVPerror(EVP_R_TOO_LARGE);
+		return 0;
+	}
+
+	memcpy(&ccm, &ccm_ctx->ccm, sizeof(ccm));
+
+	if (CRYPTO_ccm128_setiv(&ccm, nonce, nonce_len, plaintext_len) != 0)
+		goto err;
+	CRYPTO_ccm128_aad(&ccm, ad, ad_len);
+
+	if (ccm_ctx->decrypt_blocks != NULL) {
+		if (CRYPTO_ccm128_decrypt_ccm64(&ccm, in, out, plaintext_len,
+		    ccm_ctx->decrypt_blocks) != 0)
+			goto err;
+	} else {
+		if (CRYPTO_ccm128_decrypt(&ccm, in, out, plaintext_len) != 0)
+			goto err;
+	}
+
+	if (CRYPTO_ccm128_tag(&ccm, tag, ccm_ctx->tag_len) !=
+	    ccm_ctx->tag_len)
+		goto err;
+	if (timingsafe_memcmp(tag, in + plaintext_len, ccm_ctx->tag_len) != 0) {
+		explicit_bzero(out, plaintext_len);
+		EVPerror(EVP_R_BAD_DECRYPT);
+		goto err;
+	}
+
+	*out_len = plaintext_len;
+
+	ret = 1;
+
+ err:
+	explicit_bzero(&ccm, sizeof(ccm));
+
+	return ret;
+}
+
+static const EVP_AEAD aead_aes_128_ccm = {
+	.key_len = 16,
+	.nonce_len = EVP_AEAD_AES_CCM_NONCE_LEN,
+	.overhead = EVP_AEAD_AES_CCM_TAG_LEN,
+	.max_tag_len = EVP_AEAD_AES_CCM_TAG_LEN,
+
+	.init = aead_aes_ccm_init,
+	.cleanup = aead_aes_ccm_cleanup,
+	.seal = aead_aes_ccm_seal,
+	.open = aead_aes_ccm_open,
+};
+
+static const EVP_AEAD aead_aes_256_ccm = {
+	.key_len = 32,
+	.nonce_len = EVP_AEAD_AES_CCM_NONCE_LEN,
+	.overhead = EVP_AEAD_AES_CCM_TAG_LEN,
+	.max_tag_len = EVP_AEAD_AES_CCM_TAG_LEN,
+
+	.init = aead_aes_ccm_init,
+	.cleanup = aead_aes_ccm_cleanup,
+	.seal = aead_aes_ccm_seal,
+	.open = aead_aes_ccm_open,
+};
+
+const EVP_AEAD *
+EVP_aead_aes_128_ccm(void)
+{
+	return &aead_aes_128_ccm;
+}
+LCRYPTO_ALIAS(EVP_aead_aes_128_ccm);
+
+const EVP_AEAD *
+EVP_aead_aes_256_ccm(void)
+{
+	return &aead_aes_256_ccm;
+}
+LCRYPTO_ALIAS(EVP_aead_aes_256_ccm);
+
 typedef struct {
 	union {
 		double align;
@@ -62,6 +62,7 @@
 #include <openssl/err.h>
 #include <openssl/camellia.h>
 
+#include "camellia_internal.h"
 #include "evp_local.h"
 
 /* Camellia subkey Structure */
@@ -127,17 +128,8 @@ camellia_128_cfb128_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsign
 static int
 camellia_128_ecb_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsigned char *in, size_t inl)
 {
-	size_t i, bl;
-
-	bl = ctx->cipher->block_size;
-
-	if (inl < bl)
-		return 1;
-
-	inl -= bl;
-
-	for (i = 0; i <= inl; i += bl)
-		Camellia_ecb_encrypt(in + i, out + i, &((EVP_CAMELLIA_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
+	camellia_ecb_encrypt_blocks(in, out, inl / CAMELLIA_BLOCK_SIZE,
+	    &((EVP_CAMELLIA_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
 
 	return 1;
 }
@@ -285,17 +277,8 @@ camellia_192_cfb128_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsign
 static int
 camellia_192_ecb_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsigned char *in, size_t inl)
 {
-	size_t i, bl;
-
-	bl = ctx->cipher->block_size;
-
-	if (inl < bl)
-		return 1;
-
-	inl -= bl;
-
-	for (i = 0; i <= inl; i += bl)
-		Camellia_ecb_encrypt(in + i, out + i, &((EVP_CAMELLIA_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
+	camellia_ecb_encrypt_blocks(in, out, inl / CAMELLIA_BLOCK_SIZE,
+	    &((EVP_CAMELLIA_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
 
 	return 1;
 }
@@ -443,17 +426,8 @@ camellia_256_cfb128_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsign
 static int
 camellia_256_ecb_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsigned char *in, size_t inl)
 {
-	size_t i, bl;
-
-	bl = ctx->cipher->block_size;
-
-	if (inl < bl)
-		return 1;
-
-	inl -= bl;
-
-	for (i = 0; i <= inl; i += bl)
-		Camellia_ecb_encrypt(in + i, out + i, &((EVP_CAMELLIA_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
+	camellia_ecb_encrypt_blocks(in, out, inl / CAMELLIA_BLOCK_SIZE,
+	    &((EVP_CAMELLIA_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
 
 	return 1;
 }
@@ -23,6 +23,7 @@
 #include <openssl/sm4.h>
 
 #include "evp_local.h"
+#include "sm4_internal.h"
 
 typedef struct {
 	SM4_KEY ks;
@@ -44,8 +45,7 @@ sm4_cbc_encrypt(const unsigned char *in, unsigned char *out, size_t len,
 		CRYPTO_cbc128_encrypt(in, out, len, key, ivec,
 		    (block128_f)SM4_encrypt);
 	else
-		CRYPTO_cbc128_decrypt(in, out, len, key, ivec,
-		    (block128_f)SM4_decrypt);
+		sm4_cbc_decrypt(in, out, len, key, ivec);
 }
 
 static void
@@ -56,16 +56,6 @@ sm4_cfb128_encrypt(const unsigned char *in, unsigned char *out, size_t length,
 	    (block128_f)SM4_encrypt);
 }
 
-static void
-sm4_ecb_encrypt(const unsigned char *in, unsigned char *out, const SM4_KEY *key,
-    const int enc)
-{
-	if (enc)
-		SM4_encrypt(in, out, key);
-	else
-		SM4_decrypt(in, out, key);
-}
-
 static void
 sm4_ofb128_encrypt(const unsigned char *in, unsigned char *out, size_t length,
     const SM4_KEY *key, unsigned char *ivec, int *num)
@@ -113,17 +103,8 @@ sm4_cfb128_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsigned char *
 static int
 sm4_ecb_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsigned char *in, size_t inl)
 {
-	size_t i, bl;
-
-	bl = ctx->cipher->block_size;
-
-	if (inl < bl)
-		return 1;
-
-	inl -= bl;
-
-	for (i = 0; i <= inl; i += bl)
-		sm4_ecb_encrypt(in + i, out + i, &((EVP_SM4_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
+	sm4_ecb_encrypt_blocks(in, out, inl / SM4_BLOCK_SIZE,
+	    &((EVP_SM4_KEY *)ctx->cipher_data)->ks, ctx->encrypt);
 
 	return 1;
 }
@@ -237,9 +218,11 @@ sm4_ctr_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out, const unsigned char *in,
     size_t len)
 {
 	EVP_SM4_KEY *key = ((EVP_SM4_KEY *)(ctx)->cipher_data);
+	unsigned int num = ctx->num;
 
-	CRYPTO_ctr128_encrypt(in, out, len, &key->ks, ctx->iv, ctx->buf,
-	    &ctx->num, (block128_f)SM4_encrypt);
+	CRYPTO_ctr128_encrypt_ctr32(in, out, len, &key->ks, ctx->iv, ctx->buf,
+	    &num, sm4_ctr32_encrypt_blocks);
+	ctx->num = num;
 	return 1;
 }
 
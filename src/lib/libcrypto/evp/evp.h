@@ -114,6 +114,8 @@
 #define EVP_PKEY_CMAC		NID_cmac
 #define EVP_PKEY_HKDF		NID_hkdf
 #define EVP_PKEY_TLS1_PRF	NID_tls1_prf
+#define EVP_PKEY_SCRYPT		NID_scrypt
+#define EVP_PKEY_ARGON2ID	NID_argon2id
 #define EVP_PKEY_GOSTR12_256	NID_id_tc26_gost3410_2012_256
 #define EVP_PKEY_GOSTR12_512	NID_id_tc26_gost3410_2012_512
 #define EVP_PKEY_ED25519	NID_ED25519
@@ -841,6 +843,13 @@ int PKCS5_PBKDF2_HMAC_SHA1(const char *pass, int passlen,
 int PKCS5_PBKDF2_HMAC(const char *pass, int passlen, const unsigned char *salt,
     int saltlen, int iter, const EVP_MD *digest, int keylen,
     unsigned char *out);
+int PKCS5_PBKDF2_HMAC_multi(const char *const pass[], const int passlen[],
+    const unsigned char *const salt[], const int saltlen[], int iter,
+    const EVP_MD *digest, int keylen, unsigned char *const out[], size_t n);
+
+int EVP_PBE_scrypt(const char *pass, size_t passlen, const unsigned char *salt,
+    size_t saltlen, uint64_t N, uint64_t r, uint64_t p, uint64_t maxmem,
+    unsigned char *key, size_t keylen);
 
 #define ASN1_PKEY_ALIAS		0x1
 #define ASN1_PKEY_DYNAMIC	0x2
@@ -936,6 +945,8 @@ void EVP_PKEY_CTX_free(EVP_PKEY_CTX *ctx);
 
 int EVP_PKEY_CTX_ctrl(EVP_PKEY_CTX *ctx, int keytype, int optype, int cmd,
     int p1, void *p2);
+int EVP_PKEY_CTX_ctrl_uint64(EVP_PKEY_CTX *ctx, int keytype, int optype,
+    int cmd, uint64_t value);
 int EVP_PKEY_CTX_ctrl_str(EVP_PKEY_CTX *ctx, const char *type,
     const char *value);
 
@@ -1002,6 +1013,14 @@ typedef struct evp_aead_st EVP_AEAD;
 const EVP_AEAD *EVP_aead_aes_128_gcm(void);
 /* EVP_aes_256_gcm is AES-256 in Galois Counter Mode. */
 const EVP_AEAD *EVP_aead_aes_256_gcm(void);
+/* EVP_aead_aes_128_gcm_siv is AES-128 in GCM-SIV mode (RFC 8452). */
+const EVP_AEAD *EVP_aead_aes_128_gcm_siv(void);
+/* EVP_aead_aes_256_gcm_siv is AES-256 in GCM-SIV mode (RFC 8452). */
+const EVP_AEAD *EVP_aead_aes_256_gcm_siv(void);
+/* EVP_aead_aes_128_ccm is AES-128 in CCM mode with a 12 byte nonce. */
+const EVP_AEAD *EVP_aead_aes_128_ccm(void);
+/* EVP_aead_aes_256_ccm is AES-256 in CCM mode with a 12 byte nonce. */
+const EVP_AEAD *EVP_aead_aes_256_ccm(void);
 #endif
 
 #if !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305)
@@ -1104,6 +1123,87 @@ int EVP_AEAD_CTX_open(const EVP_AEAD_CTX *ctx, unsigned char *out,
     size_t nonce_len, const unsigned char *in, size_t in_len,
     const unsigned char *ad, size_t ad_len);
 
+/* An EVP_AEAD_STREAM seals and opens a stream of data as a sequence of
+ * fixed length segments, using the STREAM construction. Each segment is
+ * sealed with an AEAD nonce made up of a per-stream prefix, the big endian
+ * 32 bit segment number and a byte that is set for the final segment only.
+ * Only the final segment may be shorter than the segment length, and it may
+ * be empty. */
+typedef struct evp_aead_stream_st EVP_AEAD_STREAM;
+
+/* EVP_AEAD_STREAM_MAX_SEGMENT_LENGTH is the largest supported segment
+ * length. */
+#define EVP_AEAD_STREAM_MAX_SEGMENT_LENGTH (1 << 24)
+
+/* EVP_AEAD_STREAM_nonce_prefix_length returns the length of the nonce prefix
+ * used with the given AEAD, or zero if the AEAD can not be used for
+ * streams. */
+size_t EVP_AEAD_STREAM_nonce_prefix_length(const EVP_AEAD *aead);
+
+/* EVP_AEAD_STREAM_new returns a stream that seals segments of segment_len
+ * bytes with the given AEAD and key. The nonce prefix must never be used
+ * with the same key for more than one stream. */
+EVP_AEAD_STREAM *EVP_AEAD_STREAM_new(const EVP_AEAD *aead,
+    const unsigned char *key, size_t key_len,
+    const unsigned char *nonce_prefix, size_t nonce_prefix_len,
+    size_t segment_len);
+
+/* EVP_AEAD_STREAM_free releases all memory owned by the stream. */
+void EVP_AEAD_STREAM_free(EVP_AEAD_STREAM *stream);
+
+/* EVP_AEAD_STREAM_segment_length returns the plaintext length of all but the
+ * final segment. */
+size_t EVP_AEAD_STREAM_segment_length(const EVP_AEAD_STREAM *stream);
+
+/* EVP_AEAD_STREAM_overhead returns the number of bytes added to each
+ * segment. */
+size_t EVP_AEAD_STREAM_overhead(const EVP_AEAD_STREAM *stream);
+
+/* EVP_AEAD_STREAM_seal_segment seals a single segment with the given segment
+ * number. If last is zero, in_len must be equal to the segment length,
+ * otherwise it may be anything up to the segment length. One is returned on
+ * success, otherwise zero.
+ *
+ * This function and EVP_AEAD_STREAM_open_segment may be called (with the
+ * same EVP_AEAD_STREAM) concurrently. */
+int EVP_AEAD_STREAM_seal_segment(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len, uint32_t segment,
+    int last, const unsigned char *in, size_t in_len);
+
+/* EVP_AEAD_STREAM_open_segment authenticates and decrypts a single segment
+ * with the given segment number. One is returned on success, otherwise
+ * zero. */
+int EVP_AEAD_STREAM_open_segment(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len, uint32_t segment,
+    int last, const unsigned char *in, size_t in_len);
+
+/* EVP_AEAD_STREAM_seal_segments seals consecutive segments, starting with
+ * segment number first_segment, using up to num_threads threads. If last is
+ * zero, in_len must be a multiple of the segment length, otherwise the final
+ * segment is the remainder of the input. The input and output must not
+ * overlap. One is returned on success, otherwise zero. */
+int EVP_AEAD_STREAM_seal_segments(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    int num_threads);
+
+/* EVP_AEAD_STREAM_open_segments authenticates and decrypts consecutive
+ * segments, starting with segment number first_segment, using up to
+ * num_threads threads. If last is non-zero the input must end with the
+ * final segment. No output is produced unless all segments open. */
+int EVP_AEAD_STREAM_open_segments(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    int num_threads);
+
+#ifndef OPENSSL_NO_BIO
+/* BIO_f_aead_stream returns a filter BIO that seals data written to it, or
+ * opens data read through it, using an EVP_AEAD_STREAM. */
+const BIO_METHOD *BIO_f_aead_stream(void);
+int BIO_set_aead_stream(BIO *b, const EVP_AEAD_STREAM *stream, int enc,
+    int num_threads);
+#endif
+
 void ERR_load_EVP_strings(void);
 
 /* Error codes for the EVP functions. */
@@ -0,0 +1,456 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Segmented AEAD encryption using the STREAM construction of Hoang,
+ * Reyhanitabar, Rogaway and Vizar. The plaintext is split into segments of
+ * a fixed length, the last of which may be shorter, and each segment is
+ * sealed on its own. The nonce for a segment consists of a per-stream
+ * prefix, the 32 bit big endian segment number and a byte that is one for
+ * the final segment and zero for all others, so that reordered, dropped or
+ * truncated segments fail to open.
+ *
+ * Segments are independent of each other, so runs of segments are sealed
+ * and opened by a pool of threads, with the calling thread acting as one of
+ * the workers.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+
+#include "crypto_internal.h"
+#include "evp_local.h"
+
+#define EVP_AEAD_STREAM_SUFFIX_LEN	5
+#define EVP_AEAD_STREAM_MAX_NONCE_LEN	24
+#define EVP_AEAD_STREAM_MAX_THREADS	256
+
+struct evp_aead_stream_st {
+	EVP_AEAD_CTX aead_ctx;
+	unsigned char nonce_prefix[EVP_AEAD_STREAM_MAX_NONCE_LEN];
+	size_t nonce_len;
+	size_t segment_len;
+	size_t overhead;
+};
+
+struct evp_aead_stream_batch {
+	const EVP_AEAD_STREAM *stream;
+	unsigned char *out;
+	const unsigned char *in;
+	size_t in_len;
+	uint32_t first_segment;
+	size_t num_segments;
+	int open;
+	int last;
+};
+
+size_t
+EVP_AEAD_STREAM_nonce_prefix_length(const EVP_AEAD *aead)
+{
+	if (aead->nonce_len <= EVP_AEAD_STREAM_SUFFIX_LEN ||
+	    aead->nonce_len > EVP_AEAD_STREAM_MAX_NONCE_LEN)
+		return 0;
+
+	return aead->nonce_len - EVP_AEAD_STREAM_SUFFIX_LEN;
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_nonce_prefix_length);
+
+EVP_AEAD_STREAM *
+EVP_AEAD_STREAM_new(const EVP_AEAD *aead, const unsigned char *key,
+    size_t key_len, const unsigned char *nonce_prefix,
+    size_t nonce_prefix_len, size_t segment_len)
+{
+	EVP_AEAD_STREAM *stream;
+	size_t prefix_len;
+
+	if ((prefix_len = EVP_AEAD_STREAM_nonce_prefix_length(aead)) == 0) {
+		EVPerror(EVP_R_UNSUPPORTED_ALGORITHM);
+		return NULL;
+	}
+	if (nonce_prefix_len != prefix_len) {
+		EVPerror(EVP_R_INVALID_IV_LENGTH);
+		return NULL;
+	}
+	if (segment_len == 0 ||
+	    segment_len > EVP_AEAD_STREAM_MAX_SEGMENT_LENGTH) {
+		EVPerror(EVP_R_BAD_BLOCK_LENGTH);
+		return NULL;
+	}
+
+	if ((stream = calloc(1, sizeof(*stream))) == NULL) {
+		EVPerror(ERR_R_MALLOC_FAILURE);
+		return NULL;
+	}
+	if (!EVP_AEAD_CTX_init(&stream->aead_ctx, aead, key, key_len,
+	    EVP_AEAD_DEFAULT_TAG_LENGTH, NULL)) {
+		freezero(stream, sizeof(*stream));
+		return NULL;
+	}
+
+	memcpy(stream->nonce_prefix, nonce_prefix, prefix_len);
+	stream->nonce_len = aead->nonce_len;
+	stream->segment_len = segment_len;
+	stream->overhead = aead->overhead;
+
+	return stream;
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_new);
+
+void
+EVP_AEAD_STREAM_free(EVP_AEAD_STREAM *stream)
+{
+	if (stream == NULL)
+		return;
+
+	EVP_AEAD_CTX_cleanup(&stream->aead_ctx);
+	freezero(stream, sizeof(*stream));
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_free);
+
+size_t
+EVP_AEAD_STREAM_segment_length(const EVP_AEAD_STREAM *stream)
+{
+	return stream->segment_len;
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_segment_length);
+
+size_t
+EVP_AEAD_STREAM_overhead(const EVP_AEAD_STREAM *stream)
+{
+	return stream->overhead;
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_overhead);
+
+static void
+evp_aead_stream_nonce(const EVP_AEAD_STREAM *stream, unsigned char *nonce,
+    uint32_t segment, int last)
+{
+	size_t prefix_len = stream->nonce_len - EVP_AEAD_STREAM_SUFFIX_LEN;
+
+	memcpy(nonce, stream->nonce_prefix, prefix_len);
+	crypto_store_htobe32(&nonce[prefix_len], segment);
+	nonce[prefix_len + 4] = last ? 1 : 0;
+}
+
+int
+EVP_AEAD_STREAM_seal_segment(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len, uint32_t segment,
+    int last, const unsigned char *in, size_t in_len)
+{
+	unsigned char nonce[EVP_AEAD_STREAM_MAX_NONCE_LEN];
+
+	*out_len = 0;
+
+	if (in_len > stream->segment_len ||
+	    (!last && in_len != stream->segment_len)) {
+		EVPerror(EVP_R_DATA_NOT_MULTIPLE_OF_BLOCK_LENGTH);
+		return 0;
+	}
+
+	evp_aead_stream_nonce(stream, nonce, segment, last);
+
+	return EVP_AEAD_CTX_seal(&stream->aead_ctx, out, out_len, max_out_len,
+	    nonce, stream->nonce_len, in, in_len, NULL, 0);
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_seal_segment);
+
+int
+EVP_AEAD_STREAM_open_segment(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len, uint32_t segment,
+    int last, const unsigned char *in, size_t in_len)
+{
+	unsigned char nonce[EVP_AEAD_STREAM_MAX_NONCE_LEN];
+	size_t ct_len = stream->segment_len + stream->overhead;
+
+	*out_len = 0;
+
+	if (in_len < stream->overhead || in_len > ct_len ||
+	    (!last && in_len != ct_len)) {
+		EVPerror(EVP_R_BAD_DECRYPT);
+		return 0;
+	}
+
+	evp_aead_stream_nonce(stream, nonce, segment, last);
+
+	return EVP_AEAD_CTX_open(&stream->aead_ctx, out, out_len, max_out_len,
+	    nonce, stream->nonce_len, in, in_len, NULL, 0);
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_open_segment);
+
+static int
+evp_aead_stream_batch_segment(void *arg, size_t worker, size_t index)
+{
+	struct evp_aead_stream_batch *batch = arg;
+	const EVP_AEAD_STREAM *stream = batch->stream;
+	size_t ct_len = stream->segment_len + stream->overhead;
+	size_t in_off, in_len, out_off, out_len, max_out_len;
+	uint32_t segment = batch->first_segment + index;
+	int last = batch->last && index == batch->num_segments - 1;
+
+	if (batch->open) {
+		in_off = index * ct_len;
+		out_off = index * stream->segment_len;
+		in_len = batch->in_len - in_off;
+		if (in_len > ct_len)
+			in_len = ct_len;
+		max_out_len = in_len - stream->overhead;
+		return EVP_AEAD_STREAM_open_segment(stream,
+		    batch->out + out_off, &out_len, max_out_len, segment, last,
+		    batch->in + in_off, in_len);
+	}
+
+	in_off = index * stream->segment_len;
+	out_off = index * ct_len;
+	in_len = batch->in_len - in_off;
+	if (in_len > stream->segment_len)
+		in_len = stream->segment_len;
+	max_out_len = in_len + stream->overhead;
+
+	return EVP_AEAD_STREAM_seal_segment(stream, batch->out + out_off,
+	    &out_len, max_out_len, segment, last, batch->in + in_off, in_len);
+}
+
+/*
+ * Process the segments of a batch using the given workers, or otherwise a
+ * pool of up to num_threads workers that only lives for this batch.
+ */
+static int
+evp_aead_stream_batch_run(struct evp_aead_stream_batch *batch,
+    struct crypto_workers *workers, int num_threads)
+{
+	struct crypto_workers *batch_workers = NULL;
+	int ret;
+
+	if (workers == NULL && num_threads > 1) {
+		if (num_threads > EVP_AEAD_STREAM_MAX_THREADS)
+			num_threads = EVP_AEAD_STREAM_MAX_THREADS;
+		if ((size_t)num_threads > batch->num_segments)
+			num_threads = batch->num_segments;
+		workers = batch_workers = crypto_workers_new(num_threads);
+	}
+
+	ret = crypto_workers_run(workers, batch->num_segments,
+	    evp_aead_stream_batch_segment, batch);
+
+	crypto_workers_free(batch_workers);
+
+	return ret;
+}
+
+static int
+evp_aead_stream_overlaps(const unsigned char *in, size_t in_len,
+    const unsigned char *out, size_t out_len)
+{
+	if (in_len == 0 || out_len == 0)
+		return 0;
+	if (out + out_len <= in || in + in_len <= out)
+		return 0;
+	return 1;
+}
+
+static int
+evp_aead_stream_seal(const EVP_AEAD_STREAM *stream, unsigned char *out,
+    size_t *out_len, size_t max_out_len, uint32_t first_segment, int last,
+    const unsigned char *in, size_t in_len, struct crypto_workers *workers,
+    int num_threads)
+{
+	struct evp_aead_stream_batch batch = {
+		.stream = stream,
+		.out = out,
+		.in = in,
+		.in_len = in_len,
+		.first_segment = first_segment,
+		.last = last,
+	};
+	size_t num_segments, total_len;
+	int ret = 0;
+
+	*out_len = 0;
+
+	if (last) {
+		num_segments = in_len / stream->segment_len;
+		if (num_segments == 0 || in_len % stream->segment_len != 0)
+			num_segments++;
+	} else {
+		if (in_len % stream->segment_len != 0) {
+			EVPerror(EVP_R_DATA_NOT_MULTIPLE_OF_BLOCK_LENGTH);
+			goto err;
+		}
+		num_segments = in_len / stream->segment_len;
+		if (num_segments == 0)
+			return 1;
+	}
+
+	if (num_segments - 1 > UINT32_MAX - first_segment ||
+	    (stream->overhead > 0 &&
+	    num_segments > (SIZE_MAX - in_len) / stream->overhead)) {
+		EVPerror(EVP_R_TOO_LARGE);
+		goto err;
+	}
+	total_len = in_len + num_segments * stream->overhead;
+	if (max_out_len < total_len) {
+		EVPerror(EVP_R_BUFFER_TOO_SMALL);
+		goto err;
+	}
+	if (evp_aead_stream_overlaps(in, in_len, out, total_len)) {
+		EVPerror(EVP_R_OUTPUT_ALIASES_INPUT);
+		goto err;
+	}
+
+	batch.num_segments = num_segments;
+	if (!evp_aead_stream_batch_run(&batch, workers, num_threads))
+		goto err;
+
+	*out_len = total_len;
+	ret = 1;
+
+ err:
+	/*
+	 * In the event of an error, clear the output buffer so that a caller
+	 * that doesn't check the return value doesn't send raw data.
+	 */
+	if (!ret && out != NULL)
+		memset(out, 0, max_out_len);
+
+	return ret;
+}
+
+int
+EVP_AEAD_STREAM_seal_segments(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    int num_threads)
+{
+	return evp_aead_stream_seal(stream, out, out_len, max_out_len,
+	    first_segment, last, in, in_len, NULL, num_threads);
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_seal_segments);
+
+int
+evp_aead_stream_seal_segments_workers(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    struct crypto_workers *workers)
+{
+	return evp_aead_stream_seal(stream, out, out_len, max_out_len,
+	    first_segment, last, in, in_len, workers, 1);
+}
+
+static int
+evp_aead_stream_open(const EVP_AEAD_STREAM *stream, unsigned char *out,
+    size_t *out_len, size_t max_out_len, uint32_t first_segment, int last,
+    const unsigned char *in, size_t in_len, struct crypto_workers *workers,
+    int num_threads)
+{
+	struct evp_aead_stream_batch batch = {
+		.stream = stream,
+		.out = out,
+		.in = in,
+		.in_len = in_len,
+		.first_segment = first_segment,
+		.last = last,
+		.open = 1,
+	};
+	size_t ct_len = stream->segment_len + stream->overhead;
+	size_t num_segments, total_len;
+	int ret = 0;
+
+	*out_len = 0;
+
+	num_segments = in_len / ct_len;
+	if (last) {
+		/* The final segment may be shorter, but is never missing. */
+		if (in_len % ct_len != 0) {
+			if (in_len % ct_len < stream->overhead) {
+				EVPerror(EVP_R_BAD_DECRYPT);
+				goto err;
+			}
+			num_segments++;
+		}
+		if (num_segments == 0) {
+			EVPerror(EVP_R_BAD_DECRYPT);
+			goto err;
+		}
+	} else {
+		if (in_len % ct_len != 0) {
+			EVPerror(EVP_R_BAD_DECRYPT);
+			goto err;
+		}
+		if (num_segments == 0)
+			return 1;
+	}
+
+	if (num_segments - 1 > UINT32_MAX - first_segment) {
+		EVPerror(EVP_R_TOO_LARGE);
+		goto err;
+	}
+	total_len = in_len - num_segments * stream->overhead;
+	if (max_out_len < total_len) {
+		EVPerror(EVP_R_BUFFER_TOO_SMALL);
+		goto err;
+	}
+	if (evp_aead_stream_overlaps(in, in_len, out, total_len)) {
+		EVPerror(EVP_R_OUTPUT_ALIASES_INPUT);
+		goto err;
+	}
+
+	batch.num_segments = num_segments;
+	if (!evp_aead_stream_batch_run(&batch, workers, num_threads)) {
+		EVPerror(EVP_R_BAD_DECRYPT);
+		goto err;
+	}
+
+	*out_len = total_len;
+	ret = 1;
+
+ err:
+	/*
+	 * In the event of an error, clear the output buffer so that a caller
+	 * that doesn't check the return value doesn't try and process
+	 * segments that were successfully opened before the failure.
+	 */
+	if (!ret && out != NULL)
+		memset(out, 0, max_out_len);
+
+	return ret;
+}
+
+int
+EVP_AEAD_STREAM_open_segments(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    int num_threads)
+{
+	return evp_aead_stream_open(stream, out, out_len, max_out_len,
+	    first_segment, last, in, in_len, NULL, num_threads);
+}
+LCRYPTO_ALIAS(EVP_AEAD_STREAM_open_segments);
+
+int
+evp_aead_stream_open_segments_workers(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    struct crypto_workers *workers)
+{
+	return evp_aead_stream_open(stream, out, out_len, max_out_len,
+	    first_segment, last, in, in_len, workers, 1);
+}
@@ -87,6 +87,8 @@ struct ecx_key_st {
 	size_t priv_key_len;
 	uint8_t *pub_key;
 	size_t pub_key_len;
+	uint8_t *expanded_key;
+	size_t expanded_key_len;
 };
 
 struct evp_pkey_asn1_method_st {
@@ -368,6 +370,17 @@ int EVP_PKEY_CTX_md(EVP_PKEY_CTX *ctx, int optype, int cmd, const char *md_name)
 void EVP_CIPHER_CTX_legacy_clear(EVP_CIPHER_CTX *ctx);
 void EVP_MD_CTX_legacy_clear(EVP_MD_CTX *ctx);
 
+struct crypto_workers;
+
+int evp_aead_stream_seal_segments_workers(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    struct crypto_workers *workers);
+int evp_aead_stream_open_segments_workers(const EVP_AEAD_STREAM *stream,
+    unsigned char *out, size_t *out_len, size_t max_out_len,
+    uint32_t first_segment, int last, const unsigned char *in, size_t in_len,
+    struct crypto_workers *workers);
+
 __END_HIDDEN_DECLS
 
 #endif /* !HEADER_EVP_LOCAL_H */
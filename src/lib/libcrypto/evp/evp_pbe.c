@@ -65,11 +65,14 @@
 #include <openssl/hmac.h>
 #include <openssl/objects.h>
 #include <openssl/pkcs12.h>
+#include <openssl/sha.h>
 #include <openssl/x509.h>
 
+#include "crypto_internal.h"
 #include "evp_local.h"
 #include "hmac_local.h"
 #include "pkcs12_local.h"
+#include "sha_internal.h"
 #include "x509_local.h"
 
 /* Password based encryption (PBE) functions */
@@ -326,6 +329,231 @@ PKCS5_PBE_keyivgen(EVP_CIPHER_CTX *cctx, const char *pass, int passlen,
  * PKCS#5 v2.0 password based encryption key derivation function PBKDF2.
  */
 
+#define PBKDF2_MULTI_LANES	16
+
+/*
+ * Run iterations 2 to iter of PBKDF2 for n output blocks in parallel. Each
+ * u[] holds U_1 padded as a single SHA-1 block, while t[] accumulates the
+ * output block. The inner and outer HMAC compressions start from the
+ * precomputed ipad and opad states of the HMAC template for each lane.
+ */
+static void
+pkcs5_pbkdf2_hmac_sha1_multi(HMAC_CTX *hctx_tpl[], int iter,
+    unsigned char u[][SHA512_CBLOCK], unsigned char t[][SHA512_DIGEST_LENGTH],
+    int n)
+{
+	SHA_CTX ctx[PBKDF2_MULTI_LANES], *ctxp[PBKDF2_MULTI_LANES];
+	const void *in[PBKDF2_MULTI_LANES];
+	int j, k, l;
+
+	for (l = 0; l < n; l++) {
+		ctxp[l] = &ctx[l];
+		in[l] = u[l];
+	}
+
+	for (j = 1; j < iter; j++) {
+		for (l = 0; l < n; l++)
+			ctx[l] = *(const SHA_CTX *)hctx_tpl[l]->i_ctx.md_data;
+		sha1_block_multi(ctxp, in, n, 1);
+		for (l = 0; l < n; l++) {
+			crypto_store_htobe32(&u[l][0 * 4], ctx[l].h0);
+			crypto_store_htobe32(&u[l][1 * 4], ctx[l].h1);
+			crypto_store_htobe32(&u[l][2 * 4], ctx[l].h2);
+			crypto_store_htobe32(&u[l][3 * 4], ctx[l].h3);
+			crypto_store_htobe32(&u[l][4 * 4], ctx[l].h4);
+		}
+
+		for (l = 0; l < n; l++)
+			ctx[l] = *(const SHA_CTX *)hctx_tpl[l]->o_ctx.md_data;
+		sha1_block_multi(ctxp, in, n, 1);
+		for (l = 0; l < n; l++) {
+			crypto_store_htobe32(&u[l][0 * 4], ctx[l].h0);
+			crypto_store_htobe32(&u[l][1 * 4], ctx[l].h1);
+			crypto_store_htobe32(&u[l][2 * 4], ctx[l].h2);
+			crypto_store_htobe32(&u[l][3 * 4], ctx[l].h3);
+			crypto_store_htobe32(&u[l][4 * 4], ctx[l].h4);
+			for (k = 0; k < SHA_DIGEST_LENGTH; k++)
+				t[l][k] ^= u[l][k];
+		}
+	}
+
+	explicit_bzero(ctx, sizeof(ctx));
+}
+
+static void
+pkcs5_pbkdf2_hmac_sha256_multi(HMAC_CTX *hctx_tpl[], int iter,
+    unsigned char u[][SHA512_CBLOCK], unsigned char t[][SHA512_DIGEST_LENGTH],
+    int n)
+{
+	SHA256_CTX ctx[PBKDF2_MULTI_LANES], *ctxp[PBKDF2_MULTI_LANES];
+	const void *in[PBKDF2_MULTI_LANES];
+	int j, k, l;
+
+	for (l = 0; l < n; l++) {
+		ctxp[l] = &ctx[l];
+		in[l] = u[l];
+	}
+
+	for (j = 1; j < iter; j++) {
+		for (l = 0; l < n; l++)
+			ctx[l] = *(const SHA256_CTX *)hctx_tpl[l]->i_ctx.md_data;
+		sha256_block_multi(ctxp, in, n, 1);
+		for (l = 0; l < n; l++) {
+			for (k = 0; k < SHA256_DIGEST_LENGTH / 4; k++)
+				crypto_store_htobe32(&u[l][k * 4], ctx[l].h[k]);
+		}
+
+		for (l = 0; l < n; l++)
+			ctx[l] = *(const SHA256_CTX *)hctx_tpl[l]->o_ctx.md_data;
+		sha256_block_multi(ctxp, in, n, 1);
+		for (l = 0; l < n; l++) {
+			for (k = 0; k < SHA256_DIGEST_LENGTH / 4; k++)
+				crypto_store_htobe32(&u[l][k * 4], ctx[l].h[k]);
+			for (k = 0; k < SHA256_DIGEST_LENGTH; k++)
+				t[l][k] ^= u[l][k];
+		}
+	}
+
+	explicit_bzero(ctx, sizeof(ctx));
+}
+
+/*
+ * As above for SHA-384 and SHA-512, which only differ in their initial
+ * state and in how much of the final state forms the digest.
+ */
+static void
+pkcs5_pbkdf2_hmac_sha512_multi(HMAC_CTX *hctx_tpl[], int iter,
+    unsigned char u[][SHA512_CBLOCK], unsigned char t[][SHA512_DIGEST_LENGTH],
+    int mdlen, int n)
+{
+	SHA512_CTX ctx[PBKDF2_MULTI_LANES], *ctxp[PBKDF2_MULTI_LANES];
+	const void *in[PBKDF2_MULTI_LANES];
+	int j, k, l;
+
+	for (l = 0; l < n; l++) {
+		ctxp[l] = &ctx[l];
+		in[l] = u[l];
+	}
+
+	for (j = 1; j < iter; j++) {
+		for (l = 0; l < n; l++)
+			ctx[l] = *(const SHA512_CTX *)hctx_tpl[l]->i_ctx.md_data;
+		sha512_block_multi(ctxp, in, n, 1);
+		for (l = 0; l < n; l++) {
+			for (k = 0; k < mdlen / 8; k++)
+				crypto_store_htobe64(&u[l][k * 8], ctx[l].h[k]);
+		}
+
+		for (l = 0; l < n; l++)
+			ctx[l] = *(const SHA512_CTX *)hctx_tpl[l]->o_ctx.md_data;
+		sha512_block_multi(ctxp, in, n, 1);
+		for (l = 0; l < n; l++) {
+			for (k = 0; k < mdlen / 8; k++)
+				crypto_store_htobe64(&u[l][k * 8], ctx[l].h[k]);
+			for (k = 0; k < mdlen; k++)
+				t[l][k] ^= u[l][k];
+		}
+	}
+
+	explicit_bzero(ctx, sizeof(ctx));
+}
+
+static int
+pkcs5_pbkdf2_hmac_multi_digest(const EVP_MD *digest)
+{
+	return digest == EVP_sha1() || digest == EVP_sha256() ||
+	    digest == EVP_sha384() || digest == EVP_sha512();
+}
+
+/*
+ * PBKDF2 with HMAC-SHA1, HMAC-SHA256, HMAC-SHA384 or HMAC-SHA512 for n
+ * passwords, each with its own HMAC template and salt. The output blocks of
+ * all passwords are spread over PBKDF2_MULTI_LANES lanes, whose iterations
+ * are computed together using the multi-buffer block functions. Since U_i
+ * is always a single digest, each iteration is exactly one inner and one
+ * outer compression, avoiding the HMAC_CTX copies of the generic code path.
+ */
+static int
+pkcs5_pbkdf2_hmac_multi(HMAC_CTX *hctx_tpl[],
+    const unsigned char *const salt[], const int saltlen[], int iter,
+    const EVP_MD *digest, int keylen, unsigned char *const out[], size_t n)
+{
+	unsigned char u[PBKDF2_MULTI_LANES][SHA512_CBLOCK];
+	unsigned char t[PBKDF2_MULTI_LANES][SHA512_DIGEST_LENGTH];
+	HMAC_CTX *lane_hctx[PBKDF2_MULTI_LANES];
+	unsigned char *lane_out[PBKDF2_MULTI_LANES];
+	int lane_len[PBKDF2_MULTI_LANES];
+	unsigned char itmp[4];
+	HMAC_CTX hctx;
+	size_t p = 0;
+	uint32_t i = 1;
+	int blocklen, l, n_lanes, mdlen, off = 0;
+	int ret = 0;
+
+	if (keylen <= 0)
+		return 1;
+
+	mdlen = EVP_MD_size(digest);
+	blocklen = EVP_MD_block_size(digest);
+
+	while (p < n) {
+		for (l = 0; l < PBKDF2_MULTI_LANES && p < n; l++) {
+			crypto_store_htobe32(itmp, i);
+			if (!HMAC_CTX_copy(&hctx, hctx_tpl[p]))
+				goto err;
+			if (!HMAC_Update(&hctx, salt[p], saltlen[p]) ||
+			    !HMAC_Update(&hctx, itmp, 4) ||
+			    !HMAC_Final(&hctx, u[l], NULL)) {
+				HMAC_CTX_cleanup(&hctx);
+				goto err;
+			}
+			HMAC_CTX_cleanup(&hctx);
+			memcpy(t[l], u[l], mdlen);
+
+			/* Pad U_1 as the only block following the HMAC pad. */
+			memset(&u[l][mdlen], 0, blocklen - mdlen);
+			u[l][mdlen] = 0x80;
+			crypto_store_htobe64(&u[l][blocklen - 8],
+			    (uint64_t)(blocklen + mdlen) * 8);
+
+			lane_hctx[l] = hctx_tpl[p];
+			lane_out[l] = out[p] + off;
+			if ((lane_len[l] = keylen - off) > mdlen)
+				lane_len[l] = mdlen;
+
+			/* Move on to the next block or the next password. */
+			i++;
+			if ((off += lane_len[l]) == keylen) {
+				off = 0;
+				i = 1;
+				p++;
+			}
+		}
+		n_lanes = l;
+
+		if (digest == EVP_sha1())
+			pkcs5_pbkdf2_hmac_sha1_multi(lane_hctx, iter, u, t,
+			    n_lanes);
+		else if (digest == EVP_sha256())
+			pkcs5_pbkdf2_hmac_sha256_multi(lane_hctx, iter, u, t,
+			    n_lanes);
+		else
+			pkcs5_pbkdf2_hmac_sha512_multi(lane_hctx, iter, u, t,
+			    mdlen, n_lanes);
+
+		for (l = 0; l < n_lanes; l++)
+			memcpy(lane_out[l], t[l], lane_len[l]);
+	}
+
+	ret = 1;
+
+ err:
+	explicit_bzero(u, sizeof(u));
+	explicit_bzero(t, sizeof(t));
+
+	return ret;
+}
+
 int
 PKCS5_PBKDF2_HMAC(const char *pass, int passlen, const unsigned char *salt,
     int saltlen, int iter, const EVP_MD *digest, int keylen, unsigned char *out)
@@ -334,6 +562,7 @@ PKCS5_PBKDF2_HMAC(const char *pass, int passlen, const unsigned char *salt,
 	int cplen, j, k, tkeylen, mdlen;
 	unsigned long i = 1;
 	HMAC_CTX hctx_tpl, hctx;
+	int ret;
 
 	mdlen = EVP_MD_size(digest);
 	if (mdlen < 0)
@@ -350,6 +579,14 @@ PKCS5_PBKDF2_HMAC(const char *pass, int passlen, const unsigned char *salt,
 		HMAC_CTX_cleanup(&hctx_tpl);
 		return 0;
 	}
+	if (iter > 1 && pkcs5_pbkdf2_hmac_multi_digest(digest)) {
+		HMAC_CTX *hctxp = &hctx_tpl;
+
+		ret = pkcs5_pbkdf2_hmac_multi(&hctxp, &salt, &saltlen, iter,
+		    digest, keylen, &out, 1);
+		HMAC_CTX_cleanup(&hctx_tpl);
+		return ret;
+	}
 	while (tkeylen) {
 		if (tkeylen > mdlen)
 			cplen = mdlen;
@@ -400,6 +637,63 @@ PKCS5_PBKDF2_HMAC(const char *pass, int passlen, const unsigned char *salt,
 }
 LCRYPTO_ALIAS(PKCS5_PBKDF2_HMAC);
 
+/*
+ * Derive keys from n passwords, computing the iterations of several
+ * passwords together where the digest allows.
+ */
+int
+PKCS5_PBKDF2_HMAC_multi(const char *const pass[], const int passlen[],
+    const unsigned char *const salt[], const int saltlen[], int iter,
+    const EVP_MD *digest, int keylen, unsigned char *const out[], size_t n)
+{
+	HMAC_CTX hctx[PBKDF2_MULTI_LANES];
+	HMAC_CTX *hctxp[PBKDF2_MULTI_LANES];
+	size_t i, j, nctx;
+	int plen;
+
+	if (iter <= 1 || !pkcs5_pbkdf2_hmac_multi_digest(digest)) {
+		for (i = 0; i < n; i++) {
+			if (!PKCS5_PBKDF2_HMAC(pass[i], passlen[i], salt[i],
+			    saltlen[i], iter, digest, keylen, out[i]))
+				return 0;
+		}
+		return 1;
+	}
+
+	for (i = 0; i < n; i += nctx) {
+		for (nctx = 0; nctx < PBKDF2_MULTI_LANES && i + nctx < n;
+		    nctx++) {
+			j = i + nctx;
+			HMAC_CTX_init(&hctx[nctx]);
+			hctxp[nctx] = &hctx[nctx];
+			plen = passlen[j];
+			if (pass[j] == NULL)
+				plen = 0;
+			else if (plen == -1)
+				plen = strlen(pass[j]);
+			if (!HMAC_Init_ex(&hctx[nctx], pass[j], plen, digest,
+			    NULL)) {
+				nctx++;
+				goto err;
+			}
+		}
+		if (!pkcs5_pbkdf2_hmac_multi(hctxp, &salt[i], &saltlen[i],
+		    iter, digest, keylen, &out[i], nctx))
+			goto err;
+		for (j = 0; j < nctx; j++)
+			HMAC_CTX_cleanup(&hctx[j]);
+	}
+
+	return 1;
+
+ err:
+	for (j = 0; j < nctx; j++)
+		HMAC_CTX_cleanup(&hctx[j]);
+
+	return 0;
+}
+LCRYPTO_ALIAS(PKCS5_PBKDF2_HMAC_multi);
+
 int
 PKCS5_PBKDF2_HMAC_SHA1(const char *pass, int passlen, const unsigned char *salt,
     int saltlen, int iter, int keylen, unsigned char *out)
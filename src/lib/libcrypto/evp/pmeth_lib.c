@@ -71,6 +71,7 @@
 #include "asn1_local.h"
 #include "evp_local.h"
 
+extern const EVP_PKEY_METHOD argon2id_pkey_meth;
 extern const EVP_PKEY_METHOD cmac_pkey_meth;
 extern const EVP_PKEY_METHOD dh_pkey_meth;
 extern const EVP_PKEY_METHOD dsa_pkey_meth;
@@ -80,10 +81,12 @@ extern const EVP_PKEY_METHOD hkdf_pkey_meth;
 extern const EVP_PKEY_METHOD hmac_pkey_meth;
 extern const EVP_PKEY_METHOD rsa_pkey_meth;
 extern const EVP_PKEY_METHOD rsa_pss_pkey_meth;
+extern const EVP_PKEY_METHOD scrypt_pkey_meth;
 extern const EVP_PKEY_METHOD tls1_prf_pkey_meth;
 extern const EVP_PKEY_METHOD x25519_pkey_meth;
 
 static const EVP_PKEY_METHOD *pkey_methods[] = {
+	&argon2id_pkey_meth,
 	&cmac_pkey_meth,
 	&dh_pkey_meth,
 	&dsa_pkey_meth,
@@ -93,6 +96,7 @@ static const EVP_PKEY_METHOD *pkey_methods[] = {
 	&hmac_pkey_meth,
 	&rsa_pkey_meth,
 	&rsa_pss_pkey_meth,
+	&scrypt_pkey_meth,
 	&tls1_prf_pkey_meth,
 	&x25519_pkey_meth,
 };
@@ -244,6 +248,14 @@ EVP_PKEY_CTX_ctrl(EVP_PKEY_CTX *ctx, int keytype, int optype, int cmd,
 }
 LCRYPTO_ALIAS(EVP_PKEY_CTX_ctrl);
 
+int
+EVP_PKEY_CTX_ctrl_uint64(EVP_PKEY_CTX *ctx, int keytype, int optype, int cmd,
+    uint64_t value)
+{
+	return EVP_PKEY_CTX_ctrl(ctx, keytype, optype, cmd, 0, &value);
+}
+LCRYPTO_ALIAS(EVP_PKEY_CTX_ctrl_uint64);
+
 int
 EVP_PKEY_CTX_ctrl_str(EVP_PKEY_CTX *ctx, const char *name, const char *value)
 {
@@ -313,6 +313,8 @@ LCRYPTO_USED(EVP_PKEY_get_default_digest_nid);
 LCRYPTO_USED(EVP_CIPHER_type);
 LCRYPTO_USED(PKCS5_PBKDF2_HMAC_SHA1);
 LCRYPTO_USED(PKCS5_PBKDF2_HMAC);
+LCRYPTO_USED(PKCS5_PBKDF2_HMAC_multi);
+LCRYPTO_USED(EVP_PBE_scrypt);
 LCRYPTO_USED(EVP_PKEY_asn1_get_count);
 LCRYPTO_USED(EVP_PKEY_asn1_get0);
 LCRYPTO_USED(EVP_PKEY_asn1_find);
@@ -324,6 +326,7 @@ LCRYPTO_USED(EVP_PKEY_CTX_new_id);
 LCRYPTO_USED(EVP_PKEY_CTX_dup);
 LCRYPTO_USED(EVP_PKEY_CTX_free);
 LCRYPTO_USED(EVP_PKEY_CTX_ctrl);
+LCRYPTO_USED(EVP_PKEY_CTX_ctrl_uint64);
 LCRYPTO_USED(EVP_PKEY_CTX_ctrl_str);
 LCRYPTO_USED(EVP_PKEY_CTX_get_operation);
 LCRYPTO_USED(EVP_PKEY_CTX_set0_keygen_info);
@@ -357,6 +360,10 @@ LCRYPTO_USED(EVP_PKEY_CTX_get_cb);
 LCRYPTO_USED(EVP_PKEY_CTX_get_keygen_info);
 LCRYPTO_USED(EVP_aead_aes_128_gcm);
 LCRYPTO_USED(EVP_aead_aes_256_gcm);
+LCRYPTO_USED(EVP_aead_aes_128_gcm_siv);
+LCRYPTO_USED(EVP_aead_aes_256_gcm_siv);
+LCRYPTO_USED(EVP_aead_aes_128_ccm);
+LCRYPTO_USED(EVP_aead_aes_256_ccm);
 LCRYPTO_USED(EVP_aead_chacha20_poly1305);
 LCRYPTO_USED(EVP_aead_xchacha20_poly1305);
 LCRYPTO_USED(EVP_AEAD_key_length);
@@ -369,6 +376,17 @@ LCRYPTO_USED(EVP_AEAD_CTX_init);
 LCRYPTO_USED(EVP_AEAD_CTX_cleanup);
 LCRYPTO_USED(EVP_AEAD_CTX_seal);
 LCRYPTO_USED(EVP_AEAD_CTX_open);
+LCRYPTO_USED(EVP_AEAD_STREAM_nonce_prefix_length);
+LCRYPTO_USED(EVP_AEAD_STREAM_new);
+LCRYPTO_USED(EVP_AEAD_STREAM_free);
+LCRYPTO_USED(EVP_AEAD_STREAM_segment_length);
+LCRYPTO_USED(EVP_AEAD_STREAM_overhead);
+LCRYPTO_USED(EVP_AEAD_STREAM_seal_segment);
+LCRYPTO_USED(EVP_AEAD_STREAM_open_segment);
+LCRYPTO_USED(EVP_AEAD_STREAM_seal_segments);
+LCRYPTO_USED(EVP_AEAD_STREAM_open_segments);
+LCRYPTO_USED(BIO_f_aead_stream);
+LCRYPTO_USED(BIO_set_aead_stream);
 LCRYPTO_USED(ERR_load_EVP_strings);
 LCRYPTO_UNUSED(EVP_MD_CTX_init);
 LCRYPTO_UNUSED(EVP_EncryptFinal);
@@ -35,5 +35,10 @@ LCRYPTO_USED(HMAC);
 LCRYPTO_USED(HMAC_CTX_copy);
 LCRYPTO_USED(HMAC_CTX_set_flags);
 LCRYPTO_USED(HMAC_CTX_get_md);
+LCRYPTO_USED(HMAC_KEY_new);
+LCRYPTO_USED(HMAC_KEY_free);
+LCRYPTO_USED(HMAC_KEY_get_md);
+LCRYPTO_USED(HMAC_with_key);
+LCRYPTO_USED(HMAC_verify_with_key);
 
 #endif /* _LIBCRYPTO_HMAC_H_ */
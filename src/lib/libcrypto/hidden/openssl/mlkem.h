@@ -0,0 +1,33 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef _LIBCRYPTO_MLKEM_H
+#define _LIBCRYPTO_MLKEM_H
+
+#ifndef _MSC_VER
+#include_next <openssl/mlkem.h>
+#else
+#include "../include/openssl/mlkem.h"
+#endif
+#include "crypto_namespace.h"
+
+LCRYPTO_USED(MLKEM768_generate_key);
+LCRYPTO_USED(MLKEM768_check_public_key);
+LCRYPTO_USED(MLKEM768_encap);
+LCRYPTO_USED(MLKEM768_decap);
+
+#endif /* _LIBCRYPTO_MLKEM_H */
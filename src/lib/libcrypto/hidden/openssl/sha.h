@@ -30,6 +30,7 @@ LCRYPTO_USED(SHA1_Update);
 LCRYPTO_USED(SHA1_Final);
 LCRYPTO_USED(SHA1);
 LCRYPTO_USED(SHA1_Transform);
+LCRYPTO_USED(SHA1_multi_hash);
 LCRYPTO_USED(SHA224_Init);
 LCRYPTO_USED(SHA224_Update);
 LCRYPTO_USED(SHA224_Final);
@@ -39,6 +40,7 @@ LCRYPTO_USED(SHA256_Update);
 LCRYPTO_USED(SHA256_Final);
 LCRYPTO_USED(SHA256);
 LCRYPTO_USED(SHA256_Transform);
+LCRYPTO_USED(SHA256_multi_hash);
 LCRYPTO_USED(SHA384_Init);
 LCRYPTO_USED(SHA384_Update);
 LCRYPTO_USED(SHA384_Final);
@@ -255,6 +255,7 @@ LCRYPTO_USED(X509_find_by_issuer_and_serial);
 LCRYPTO_USED(X509_find_by_subject);
 LCRYPTO_USED(X509_up_ref);
 LCRYPTO_USED(X509_chain_up_ref);
+LCRYPTO_USED(X509_intern);
 LCRYPTO_USED(ERR_load_X509_strings);
 LCRYPTO_USED(X509_CRL_get_signature_nid);
 LCRYPTO_USED(X509_CRL_get0_extensions);
@@ -367,6 +368,7 @@ LCRYPTO_USED(i2d_X509_CINF);
 LCRYPTO_USED(X509_new);
 LCRYPTO_USED(X509_free);
 LCRYPTO_USED(d2i_X509);
+LCRYPTO_USED(d2i_X509_lazy);
 LCRYPTO_USED(i2d_X509);
 LCRYPTO_USED(X509_get_ex_new_index);
 LCRYPTO_USED(X509_set_ex_data);
@@ -401,6 +403,8 @@ LCRYPTO_USED(i2d_X509_CRL);
 LCRYPTO_USED(X509_CRL_add0_revoked);
 LCRYPTO_USED(X509_CRL_get0_by_serial);
 LCRYPTO_USED(X509_CRL_get0_by_cert);
+LCRYPTO_USED(X509_CRL_new_indexed);
+LCRYPTO_USED(X509_CRL_load_indexed);
 LCRYPTO_USED(X509_PKEY_new);
 LCRYPTO_USED(X509_PKEY_free);
 LCRYPTO_USED(NETSCAPE_SPKI_new);
@@ -48,6 +48,12 @@ LCRYPTO_USED(X509_STORE_set_purpose);
 LCRYPTO_USED(X509_STORE_set_trust);
 LCRYPTO_USED(X509_STORE_set1_param);
 LCRYPTO_USED(X509_STORE_get0_param);
+LCRYPTO_USED(X509_STORE_set_verify_cache);
+LCRYPTO_USED(X509_VERIFY_JOB_new);
+LCRYPTO_USED(X509_VERIFY_JOB_free);
+LCRYPTO_USED(X509_VERIFY_JOB_get_result);
+LCRYPTO_USED(X509_VERIFY_JOB_get_error);
+LCRYPTO_USED(X509_STORE_verify_batch);
 LCRYPTO_USED(X509_STORE_get_verify_cb);
 LCRYPTO_USED(X509_STORE_set_verify_cb);
 LCRYPTO_USED(X509_STORE_get_check_issued);
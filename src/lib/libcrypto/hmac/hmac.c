@@ -274,3 +274,136 @@ err:
 	return NULL;
 }
 LCRYPTO_ALIAS(HMAC);
+
+HMAC_KEY *
+HMAC_KEY_new(const EVP_MD *md, const void *key, int key_len)
+{
+	HMAC_KEY *hkey = NULL;
+	HMAC_CTX c;
+
+	HMAC_CTX_init(&c);
+
+	if (md == NULL || key == NULL)
+		goto err;
+
+	/*
+	 * The precomputed states are copied in and out of md_data, which
+	 * requires that the digest does not need its own copy or cleanup.
+	 */
+	if (md->ctx_size <= 0 || md->ctx_size > HMAC_KEY_MAX_STATE_SIZE ||
+	    md->copy != NULL || md->cleanup != NULL) {
+		EVPerror(EVP_R_UNSUPPORTED_ALGORITHM);
+		goto err;
+	}
+
+	if (!HMAC_Init_ex(&c, key, key_len, md, NULL))
+		goto err;
+
+	if ((hkey = calloc(1, sizeof(*hkey))) == NULL)
+		goto err;
+
+	hkey->md = md;
+	memcpy(hkey->i_state, c.i_ctx.md_data, md->ctx_size);
+	memcpy(hkey->o_state, c.o_ctx.md_data, md->ctx_size);
+
+	HMAC_CTX_cleanup(&c);
+
+	return hkey;
+
+ err:
+	HMAC_CTX_cleanup(&c);
+
+	return NULL;
+}
+LCRYPTO_ALIAS(HMAC_KEY_new);
+
+void
+HMAC_KEY_free(HMAC_KEY *hkey)
+{
+	freezero(hkey, sizeof(*hkey));
+}
+LCRYPTO_ALIAS(HMAC_KEY_free);
+
+const EVP_MD *
+HMAC_KEY_get_md(const HMAC_KEY *hkey)
+{
+	return hkey->md;
+}
+LCRYPTO_ALIAS(HMAC_KEY_get_md);
+
+/*
+ * Compute the HMAC using a digest context on the stack, which has its md_data
+ * pointed at a copy of the precomputed inner and then outer state. This avoids
+ * the allocations and context copies of HMAC_Init_ex() and HMAC_Final().
+ */
+static int
+hmac_key_digest(const HMAC_KEY *hkey, const unsigned char *d, size_t n,
+    unsigned char *md)
+{
+	const EVP_MD *evp_md = hkey->md;
+	uint64_t state[HMAC_KEY_MAX_STATE_SIZE / sizeof(uint64_t)];
+	unsigned char buf[EVP_MAX_MD_SIZE];
+	EVP_MD_CTX ctx;
+	int ret = 0;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.digest = evp_md;
+	ctx.md_data = state;
+	ctx.update = evp_md->update;
+
+	memcpy(state, hkey->i_state, evp_md->ctx_size);
+	if (!evp_md->update(&ctx, d, n))
+		goto err;
+	if (!evp_md->final(&ctx, buf))
+		goto err;
+
+	memcpy(state, hkey->o_state, evp_md->ctx_size);
+	if (!evp_md->update(&ctx, buf, evp_md->md_size))
+		goto err;
+	if (!evp_md->final(&ctx, md))
+		goto err;
+
+	ret = 1;
+
+ err:
+	explicit_bzero(state, evp_md->ctx_size);
+	explicit_bzero(buf, evp_md->md_size);
+
+	return ret;
+}
+
+unsigned char *
+HMAC_with_key(const HMAC_KEY *hkey, const unsigned char *d, size_t n,
+    unsigned char *md, unsigned int *md_len)
+{
+	if (!hmac_key_digest(hkey, d, n, md))
+		return NULL;
+
+	if (md_len != NULL)
+		*md_len = hkey->md->md_size;
+
+	return md;
+}
+LCRYPTO_ALIAS(HMAC_with_key);
+
+int
+HMAC_verify_with_key(const HMAC_KEY *hkey, const unsigned char *d, size_t n,
+    const unsigned char *mac, size_t mac_len)
+{
+	unsigned char md[EVP_MAX_MD_SIZE];
+	int ret = 0;
+
+	if (mac_len != (size_t)hkey->md->md_size)
+		goto err;
+
+	if (!hmac_key_digest(hkey, d, n, md))
+		goto err;
+
+	ret = timingsafe_memcmp(md, mac, mac_len) == 0;
+
+ err:
+	explicit_bzero(md, sizeof(md));
+
+	return ret;
+}
+LCRYPTO_ALIAS(HMAC_verify_with_key);
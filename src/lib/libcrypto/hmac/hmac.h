@@ -98,6 +98,19 @@ int HMAC_CTX_copy(HMAC_CTX *dctx, HMAC_CTX *sctx);
 void HMAC_CTX_set_flags(HMAC_CTX *ctx, unsigned long flags);
 const EVP_MD *HMAC_CTX_get_md(const HMAC_CTX *ctx);
 
+HMAC_KEY *HMAC_KEY_new(const EVP_MD *md, const void *key, int key_len)
+    __attribute__ ((__bounded__(__buffer__, 2, 3)));
+void HMAC_KEY_free(HMAC_KEY *hkey);
+const EVP_MD *HMAC_KEY_get_md(const HMAC_KEY *hkey);
+unsigned char *HMAC_with_key(const HMAC_KEY *hkey, const unsigned char *d,
+    size_t n, unsigned char *md, unsigned int *md_len)
+    __attribute__ ((__bounded__(__buffer__, 2, 3)))
+    __attribute__((__nonnull__ (4)));
+int HMAC_verify_with_key(const HMAC_KEY *hkey, const unsigned char *d,
+    size_t n, const unsigned char *mac, size_t mac_len)
+    __attribute__ ((__bounded__(__buffer__, 2, 3)))
+    __attribute__ ((__bounded__(__buffer__, 4, 5)));
+
 #ifdef  __cplusplus
 }
 #endif
@@ -75,6 +75,15 @@ struct hmac_ctx_st {
 	unsigned char key[HMAC_MAX_MD_CBLOCK];
 } /* HMAC_CTX */;
 
+/* Large enough for the md_data of any of the built-in digests. */
+#define HMAC_KEY_MAX_STATE_SIZE	256
+
+struct hmac_key_st {
+	const EVP_MD *md;
+	uint64_t i_state[HMAC_KEY_MAX_STATE_SIZE / sizeof(uint64_t)];
+	uint64_t o_state[HMAC_KEY_MAX_STATE_SIZE / sizeof(uint64_t)];
+} /* HMAC_KEY */;
+
 void HMAC_CTX_init(HMAC_CTX *ctx);
 void HMAC_CTX_cleanup(HMAC_CTX *ctx);
 
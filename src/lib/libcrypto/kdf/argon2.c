@@ -0,0 +1,877 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Argon2id memory-hard password hashing function (RFC 9106).
+ *
+ * The lanes of each slice are independent of each other, so they are filled
+ * in parallel by a small pool of threads that is started for the duration of
+ * a derivation. All threads synchronise at the end of every slice.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+#include "crypto_internal.h"
+#include "evp_local.h"
+#include "kdf_internal.h"
+
+#define ARGON2_VERSION		0x13
+#define ARGON2_TYPE_ID		2
+
+#define ARGON2_SYNC_POINTS	4
+#define ARGON2_MIN_SALT_LEN	8
+#define ARGON2_MIN_OUT_LEN	4
+#define ARGON2_DEFAULT_OUT_LEN	32
+#define ARGON2_MAX_LANES	0xffffff
+#define ARGON2_MAX_THREADS	256
+
+#define ARGON2_PREHASH_LEN	64
+#define ARGON2_PREHASH_SEED_LEN	(ARGON2_PREHASH_LEN + 8)
+
+#define BLAKE2B_BLOCK_SIZE	128
+#define BLAKE2B_OUT_MAX		64
+
+struct blake2b_ctx {
+	uint64_t h[8];
+	uint64_t t[2];
+	uint8_t buf[BLAKE2B_BLOCK_SIZE];
+	size_t buf_len;
+	size_t out_len;
+};
+
+static const uint64_t blake2b_iv[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+	0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+	0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+static const uint8_t blake2b_sigma[10][16] = {
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+	{ 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+	{ 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+	{ 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+	{ 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+	{ 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+	{ 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+	{ 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+	{ 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+};
+
+struct argon2_ctx {
+	unsigned char *pass;
+	size_t pass_len;
+	unsigned char *salt;
+	size_t salt_len;
+	unsigned char *secret;
+	size_t secret_len;
+	unsigned char *ad;
+	size_t ad_len;
+	uint32_t iter;
+	uint32_t memcost;
+	uint32_t lanes;
+	uint32_t threads;
+	struct kdf_arena arena;
+};
+
+struct argon2_instance {
+	uint64_t *memory;
+	uint32_t passes;
+	uint32_t lanes;
+	uint32_t lane_length;
+	uint32_t segment_length;
+	uint32_t memory_blocks;
+};
+
+struct argon2_slice {
+	const struct argon2_instance *inst;
+	uint32_t pass;
+	uint32_t slice;
+};
+
+static inline uint64_t
+blake2b_load_le64(const uint8_t *src)
+{
+	uint64_t v;
+
+	memcpy(&v, src, sizeof(v));
+
+	return le64toh(v);
+}
+
+static inline void
+blake2b_store_le64(uint8_t *dst, uint64_t v)
+{
+	v = htole64(v);
+	memcpy(dst, &v, sizeof(v));
+}
+
+static inline void
+blake2b_g(uint64_t v[16], int a, int b, int c, int d, uint64_t x, uint64_t y)
+{
+	v[a] = v[a] + v[b] + x;
+	v[d] = crypto_ror_u64(v[d] ^ v[a], 32);
+	v[c] = v[c] + v[d];
+	v[b] = crypto_ror_u64(v[b] ^ v[c], 24);
+	v[a] = v[a] + v[b] + y;
+	v[d] = crypto_ror_u64(v[d] ^ v[a], 16);
+	v[c] = v[c] + v[d];
+	v[b] = crypto_ror_u64(v[b] ^ v[c], 63);
+}
+
+static void
+blake2b_compress(struct blake2b_ctx *ctx, const uint8_t *block, int last)
+{
+	const uint8_t *s;
+	uint64_t m[16], v[16];
+	int i;
+
+	for (i = 0; i < 16; i++)
+		m[i] = blake2b_load_le64(&block[i * 8]);
+	for (i = 0; i < 8; i++) {
+		v[i] = ctx->h[i];
+		v[i + 8] = blake2b_iv[i];
+	}
+	v[12] ^= ctx->t[0];
+	v[13] ^= ctx->t[1];
+	if (last)
+		v[14] = ~v[14];
+
+	for (i = 0; i < 12; i++) {
+		s = blake2b_sigma[i % 10];
+		blake2b_g(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+		blake2b_g(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+		blake2b_g(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+		blake2b_g(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+		blake2b_g(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+		blake2b_g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+		blake2b_g(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+		blake2b_g(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+	}
+
+	for (i = 0; i < 8; i++)
+		ctx->h[i] ^= v[i] ^ v[i + 8];
+
+	explicit_bzero(m, sizeof(m));
+	explicit_bzero(v, sizeof(v));
+}
+
+static void
+blake2b_init(struct blake2b_ctx *ctx, size_t out_len)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	memcpy(ctx->h, blake2b_iv, sizeof(ctx->h));
+	ctx->h[0] ^= 0x01010000 ^ out_len;
+	ctx->out_len = out_len;
+}
+
+static void
+blake2b_update(struct blake2b_ctx *ctx, const void *in, size_t in_len)
+{
+	const uint8_t *data = in;
+	size_t n;
+
+	while (in_len > 0) {
+		/* The final block is only compressed by blake2b_final(). */
+		if (ctx->buf_len == BLAKE2B_BLOCK_SIZE) {
+			ctx->t[0] += BLAKE2B_BLOCK_SIZE;
+			if (ctx->t[0] < BLAKE2B_BLOCK_SIZE)
+				ctx->t[1]++;
+			blake2b_compress(ctx, ctx->buf, 0);
+			ctx->buf_len = 0;
+		}
+		if ((n = BLAKE2B_BLOCK_SIZE - ctx->buf_len) > in_len)
+			n = in_len;
+		memcpy(&ctx->buf[ctx->buf_len], data, n);
+		ctx->buf_len += n;
+		data += n;
+		in_len -= n;
+	}
+}
+
+static void
+blake2b_update_le32(struct blake2b_ctx *ctx, uint32_t v)
+{
+	uint8_t buf[4];
+
+	crypto_store_htole32(buf, v);
+	blake2b_update(ctx, buf, sizeof(buf));
+}
+
+static void
+blake2b_final(struct blake2b_ctx *ctx, uint8_t *out)
+{
+	uint8_t h[BLAKE2B_OUT_MAX];
+	int i;
+
+	ctx->t[0] += ctx->buf_len;
+	if (ctx->t[0] < ctx->buf_len)
+		ctx->t[1]++;
+	memset(&ctx->buf[ctx->buf_len], 0, BLAKE2B_BLOCK_SIZE - ctx->buf_len);
+	blake2b_compress(ctx, ctx->buf, 1);
+
+	for (i = 0; i < 8; i++)
+		blake2b_store_le64(&h[i * 8], ctx->h[i]);
+	memcpy(out, h, ctx->out_len);
+
+	explicit_bzero(h, sizeof(h));
+	explicit_bzero(ctx, sizeof(*ctx));
+}
+
+static void
+blake2b(uint8_t *out, size_t out_len, const void *in, size_t in_len)
+{
+	struct blake2b_ctx ctx;
+
+	blake2b_init(&ctx, out_len);
+	blake2b_update(&ctx, in, in_len);
+	blake2b_final(&ctx, out);
+}
+
+/*
+ * Variable length hash function H' (RFC 9106, section 3.3).
+ */
+static void
+argon2_hash(uint8_t *out, uint32_t out_len, const uint8_t *in, size_t in_len)
+{
+	struct blake2b_ctx ctx;
+	uint8_t v[BLAKE2B_OUT_MAX];
+
+	if (out_len <= BLAKE2B_OUT_MAX) {
+		blake2b_init(&ctx, out_len);
+		blake2b_update_le32(&ctx, out_len);
+		blake2b_update(&ctx, in, in_len);
+		blake2b_final(&ctx, out);
+		return;
+	}
+
+	blake2b_init(&ctx, BLAKE2B_OUT_MAX);
+	blake2b_update_le32(&ctx, out_len);
+	blake2b_update(&ctx, in, in_len);
+	blake2b_final(&ctx, v);
+	memcpy(out, v, BLAKE2B_OUT_MAX / 2);
+	out += BLAKE2B_OUT_MAX / 2;
+	out_len -= BLAKE2B_OUT_MAX / 2;
+
+	while (out_len > BLAKE2B_OUT_MAX) {
+		blake2b(v, BLAKE2B_OUT_MAX, v, BLAKE2B_OUT_MAX);
+		memcpy(out, v, BLAKE2B_OUT_MAX / 2);
+		out += BLAKE2B_OUT_MAX / 2;
+		out_len -= BLAKE2B_OUT_MAX / 2;
+	}
+	blake2b(out, out_len, v, BLAKE2B_OUT_MAX);
+
+	explicit_bzero(v, sizeof(v));
+}
+
+static inline uint64_t
+argon2_blamka(uint64_t x, uint64_t y)
+{
+	return x + y + 2 * (uint64_t)(uint32_t)x * (uint32_t)y;
+}
+
+static inline void
+argon2_gb(uint64_t v[16], int a, int b, int c, int d)
+{
+	v[a] = argon2_blamka(v[a], v[b]);
+	v[d] = crypto_ror_u64(v[d] ^ v[a], 32);
+	v[c] = argon2_blamka(v[c], v[d]);
+	v[b] = crypto_ror_u64(v[b] ^ v[c], 24);
+	v[a] = argon2_blamka(v[a], v[b]);
+	v[d] = crypto_ror_u64(v[d] ^ v[a], 16);
+	v[c] = argon2_blamka(v[c], v[d]);
+	v[b] = crypto_ror_u64(v[b] ^ v[c], 63);
+}
+
+/*
+ * Permutation P - a BLAKE2b round with multiplications added (section 3.6).
+ */
+static void
+argon2_permute(uint64_t v[16])
+{
+	argon2_gb(v, 0, 4, 8, 12);
+	argon2_gb(v, 1, 5, 9, 13);
+	argon2_gb(v, 2, 6, 10, 14);
+	argon2_gb(v, 3, 7, 11, 15);
+	argon2_gb(v, 0, 5, 10, 15);
+	argon2_gb(v, 1, 6, 11, 12);
+	argon2_gb(v, 2, 7, 8, 13);
+	argon2_gb(v, 3, 4, 9, 14);
+}
+
+void
+argon2_fill_block_generic(const uint64_t *prev, const uint64_t *ref,
+    uint64_t *next, int with_xor)
+{
+	uint64_t r[ARGON2_BLOCK_WORDS], q[ARGON2_BLOCK_WORDS], v[16];
+	int i, j;
+
+	for (i = 0; i < ARGON2_BLOCK_WORDS; i++)
+		r[i] = q[i] = prev[i] ^ ref[i];
+
+	/* Apply P to the rows, then to the columns of 16 byte registers. */
+	for (i = 0; i < 8; i++)
+		argon2_permute(&q[i * 16]);
+	for (j = 0; j < 8; j++) {
+		for (i = 0; i < 8; i++) {
+			v[i * 2] = q[i * 16 + j * 2];
+			v[i * 2 + 1] = q[i * 16 + j * 2 + 1];
+		}
+		argon2_permute(v);
+		for (i = 0; i < 8; i++) {
+			q[i * 16 + j * 2] = v[i * 2];
+			q[i * 16 + j * 2 + 1] = v[i * 2 + 1];
+		}
+	}
+
+	if (with_xor) {
+		for (i = 0; i < ARGON2_BLOCK_WORDS; i++)
+			next[i] ^= q[i] ^ r[i];
+	} else {
+		for (i = 0; i < ARGON2_BLOCK_WORDS; i++)
+			next[i] = q[i] ^ r[i];
+	}
+}
+
+#ifndef HAVE_ARGON2_FILL_BLOCK
+void
+argon2_fill_block(const uint64_t *prev, const uint64_t *ref, uint64_t *next,
+    int with_xor)
+{
+	argon2_fill_block_generic(prev, ref, next, with_xor);
+}
+#endif
+
+/*
+ * Generate the next block of reference addresses for data-independent
+ * addressing (section 3.4.1.2).
+ */
+static void
+argon2_next_addresses(uint64_t *address_block, uint64_t *input_block,
+    const uint64_t *zero_block)
+{
+	input_block[6]++;
+	argon2_fill_block(zero_block, input_block, address_block, 0);
+	argon2_fill_block(zero_block, address_block, address_block, 0);
+}
+
+/*
+ * Map J1 to a block index within the reference area of the lane (section
+ * 3.4.2).
+ */
+static uint32_t
+argon2_index_alpha(const struct argon2_instance *inst, uint32_t pass,
+    uint32_t slice, uint32_t index, uint32_t j1, int same_lane)
+{
+	uint32_t area_size, start = 0;
+	uint64_t pos;
+
+	if (pass == 0) {
+		if (slice == 0)
+			area_size = index - 1;
+		else if (same_lane)
+			area_size = slice * inst->segment_length + index - 1;
+		else
+			area_size = slice * inst->segment_length -
+			    (index == 0 ? 1 : 0);
+	} else {
+		if (same_lane)
+			area_size = inst->lane_length - inst->segment_length +
+			    index - 1;
+		else
+			area_size = inst->lane_length - inst->segment_length -
+			    (index == 0 ? 1 : 0);
+		if (slice != ARGON2_SYNC_POINTS - 1)
+			start = (slice + 1) * inst->segment_length;
+	}
+
+	pos = (uint64_t)j1 * j1 >> 32;
+	pos = area_size - 1 - ((uint64_t)area_size * pos >> 32);
+
+	return (start + pos) % inst->lane_length;
+}
+
+static void
+argon2_fill_segment(const struct argon2_instance *inst, uint32_t pass,
+    uint32_t lane, uint32_t slice)
+{
+	uint64_t address_block[ARGON2_BLOCK_WORDS];
+	uint64_t input_block[ARGON2_BLOCK_WORDS];
+	uint64_t zero_block[ARGON2_BLOCK_WORDS];
+	uint64_t cur_offset, prev_offset, pseudo_rand, ref_lane, ref_index;
+	uint64_t *memory = inst->memory;
+	uint32_t index, start = 0;
+	int data_independent;
+
+	/* Argon2id uses data-independent addressing for the first half pass. */
+	data_independent = pass == 0 && slice < ARGON2_SYNC_POINTS / 2;
+
+	if (data_independent) {
+		memset(zero_block, 0, sizeof(zero_block));
+		memset(input_block, 0, sizeof(input_block));
+		input_block[0] = pass;
+		input_block[1] = lane;
+		input_block[2] = slice;
+		input_block[3] = inst->memory_blocks;
+		input_block[4] = inst->passes;
+		input_block[5] = ARGON2_TYPE_ID;
+	}
+
+	/* The first two blocks of each lane are computed from H0. */
+	if (pass == 0 && slice == 0) {
+		start = 2;
+		if (data_independent)
+			argon2_next_addresses(address_block, input_block,
+			    zero_block);
+	}
+
+	cur_offset = (uint64_t)lane * inst->lane_length +
+	    slice * inst->segment_length + start;
+	if (cur_offset % inst->lane_length == 0)
+		prev_offset = cur_offset + inst->lane_length - 1;
+	else
+		prev_offset = cur_offset - 1;
+
+	for (index = start; index < inst->segment_length;
+	    index++, cur_offset++, prev_offset++) {
+		if (cur_offset % inst->lane_length == 1)
+			prev_offset = cur_offset - 1;
+
+		if (data_independent) {
+			if (index % ARGON2_BLOCK_WORDS == 0)
+				argon2_next_addresses(address_block,
+				    input_block, zero_block);
+			pseudo_rand = address_block[index % ARGON2_BLOCK_WORDS];
+		} else
+			pseudo_rand = memory[prev_offset * ARGON2_BLOCK_WORDS];
+
+		ref_lane = (pseudo_rand >> 32) % inst->lanes;
+		if (pass == 0 && slice == 0)
+			ref_lane = lane;
+		ref_index = argon2_index_alpha(inst, pass, slice, index,
+		    pseudo_rand & 0xffffffff, ref_lane == lane);
+
+		argon2_fill_block(&memory[prev_offset * ARGON2_BLOCK_WORDS],
+		    &memory[(ref_lane * inst->lane_length + ref_index) *
+		    ARGON2_BLOCK_WORDS],
+		    &memory[cur_offset * ARGON2_BLOCK_WORDS], pass != 0);
+	}
+}
+
+static int
+argon2_fill_lane(void *arg, size_t worker, size_t lane)
+{
+	const struct argon2_slice *as = arg;
+
+	argon2_fill_segment(as->inst, as->pass, lane, as->slice);
+
+	return 1;
+}
+
+/*
+ * The segments of all lanes within a slice are independent of each other,
+ * so each slice is filled by a run of the worker pool, which is kept for
+ * all passes.
+ */
+static void
+argon2_fill_memory(const struct argon2_instance *inst, uint32_t num_threads)
+{
+	struct crypto_workers *workers = NULL;
+	struct argon2_slice as = {
+		.inst = inst,
+	};
+
+	if (num_threads > inst->lanes)
+		num_threads = inst->lanes;
+
+	/* Without a pool, all lanes are filled by the calling thread. */
+	if (num_threads > 1)
+		workers = crypto_workers_new(num_threads);
+
+	for (as.pass = 0; as.pass < inst->passes; as.pass++) {
+		for (as.slice = 0; as.slice < ARGON2_SYNC_POINTS; as.slice++)
+			(void)crypto_workers_run(workers, inst->lanes,
+			    argon2_fill_lane, &as);
+	}
+
+	crypto_workers_free(workers);
+}
+
+static void
+argon2_prehash_update(struct blake2b_ctx *ctx, const unsigned char *buf,
+    size_t buf_len)
+{
+	blake2b_update_le32(ctx, buf_len);
+	if (buf_len > 0)
+		blake2b_update(ctx, buf, buf_len);
+}
+
+static int
+argon2_check_params(const struct argon2_ctx *kctx)
+{
+	if (kctx->salt_len < ARGON2_MIN_SALT_LEN)
+		return 0;
+	if (kctx->pass_len > UINT32_MAX || kctx->salt_len > UINT32_MAX ||
+	    kctx->secret_len > UINT32_MAX || kctx->ad_len > UINT32_MAX)
+		return 0;
+	if (kctx->memcost < 2 * ARGON2_SYNC_POINTS * kctx->lanes)
+		return 0;
+
+	return 1;
+}
+
+static int
+argon2id_derive(struct argon2_ctx *kctx, unsigned char *out, size_t out_len)
+{
+	struct argon2_instance inst;
+	struct blake2b_ctx ctx;
+	uint8_t seed[ARGON2_PREHASH_SEED_LEN];
+	uint8_t block[ARGON2_BLOCK_SIZE];
+	uint64_t final_block[ARGON2_BLOCK_WORDS];
+	uint64_t *b;
+	uint32_t lane, i, j;
+
+	if (out == NULL || out_len < ARGON2_MIN_OUT_LEN ||
+	    out_len > UINT32_MAX || !argon2_check_params(kctx)) {
+		KDFerror(KDF_R_VALUE_ERROR);
+		return 0;
+	}
+
+	memset(&inst, 0, sizeof(inst));
+	inst.passes = kctx->iter;
+	inst.lanes = kctx->lanes;
+	inst.segment_length = kctx->memcost /
+	    (kctx->lanes * ARGON2_SYNC_POINTS);
+	inst.lane_length = inst.segment_length * ARGON2_SYNC_POINTS;
+	inst.memory_blocks = inst.lane_length * inst.lanes;
+
+	if (inst.memory_blocks > SIZE_MAX / ARGON2_BLOCK_SIZE) {
+		KDFerror(KDF_R_MEMORY_LIMIT_EXCEEDED);
+		return 0;
+	}
+	if ((inst.memory = kdf_arena_get(&kctx->arena,
+	    (size_t)inst.memory_blocks * ARGON2_BLOCK_SIZE)) == NULL) {
+		KDFerror(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+
+	/* H0 (section 3.2, step 1). */
+	blake2b_init(&ctx, ARGON2_PREHASH_LEN);
+	blake2b_update_le32(&ctx, kctx->lanes);
+	blake2b_update_le32(&ctx, out_len);
+	blake2b_update_le32(&ctx, kctx->memcost);
+	blake2b_update_le32(&ctx, kctx->iter);
+	blake2b_update_le32(&ctx, ARGON2_VERSION);
+	blake2b_update_le32(&ctx, ARGON2_TYPE_ID);
+	argon2_prehash_update(&ctx, kctx->pass, kctx->pass_len);
+	argon2_prehash_update(&ctx, kctx->salt, kctx->salt_len);
+	argon2_prehash_update(&ctx, kctx->secret, kctx->secret_len);
+	argon2_prehash_update(&ctx, kctx->ad, kctx->ad_len);
+	blake2b_final(&ctx, seed);
+
+	/* The first two blocks of each lane (steps 3 and 4). */
+	for (lane = 0; lane < inst.lanes; lane++) {
+		for (i = 0; i < 2; i++) {
+			crypto_store_htole32(&seed[ARGON2_PREHASH_LEN], i);
+			crypto_store_htole32(&seed[ARGON2_PREHASH_LEN + 4],
+			    lane);
+			argon2_hash(block, sizeof(block), seed, sizeof(seed));
+
+			b = &inst.memory[((uint64_t)lane * inst.lane_length +
+			    i) * ARGON2_BLOCK_WORDS];
+			for (j = 0; j < ARGON2_BLOCK_WORDS; j++)
+				b[j] = blake2b_load_le64(&block[j * 8]);
+		}
+	}
+
+	argon2_fill_memory(&inst, kctx->threads);
+
+	/* XOR the last block of every lane and hash the result (step 7). */
+	memset(final_block, 0, sizeof(final_block));
+	for (lane = 0; lane < inst.lanes; lane++) {
+		b = &inst.memory[((uint64_t)lane * inst.lane_length +
+		    inst.lane_length - 1) * ARGON2_BLOCK_WORDS];
+		for (j = 0; j < ARGON2_BLOCK_WORDS; j++)
+			final_block[j] ^= b[j];
+	}
+	for (j = 0; j < ARGON2_BLOCK_WORDS; j++)
+		blake2b_store_le64(&block[j * 8], final_block[j]);
+	argon2_hash(out, out_len, block, sizeof(block));
+
+	explicit_bzero(seed, sizeof(seed));
+	explicit_bzero(block, sizeof(block));
+	explicit_bzero(final_block, sizeof(final_block));
+
+	return 1;
+}
+
+static int
+pkey_argon2_init(EVP_PKEY_CTX *ctx)
+{
+	struct argon2_ctx *kctx;
+
+	if ((kctx = calloc(1, sizeof(*kctx))) == NULL) {
+		KDFerror(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+	kctx->iter = 3;
+	kctx->memcost = 64 * 1024;
+	kctx->lanes = 4;
+	kctx->threads = 1;
+
+	ctx->data = kctx;
+
+	return 1;
+}
+
+/*
+ * The memory arena is not copied, the new context allocates its own on its
+ * first derivation.
+ */
+static int
+pkey_argon2_copy(EVP_PKEY_CTX *dst, EVP_PKEY_CTX *src)
+{
+	struct argon2_ctx *sctx, *dctx;
+
+	if (!pkey_argon2_init(dst))
+		return 0;
+	sctx = src->data;
+	dctx = dst->data;
+
+	if (sctx->pass != NULL && !kdf_set_membuf(&dctx->pass,
+	    &dctx->pass_len, sctx->pass, sctx->pass_len))
+		return 0;
+	if (sctx->salt != NULL && !kdf_set_membuf(&dctx->salt,
+	    &dctx->salt_len, sctx->salt, sctx->salt_len))
+		return 0;
+	if (sctx->secret != NULL && !kdf_set_membuf(&dctx->secret,
+	    &dctx->secret_len, sctx->secret, sctx->secret_len))
+		return 0;
+	if (sctx->ad != NULL && !kdf_set_membuf(&dctx->ad, &dctx->ad_len,
+	    sctx->ad, sctx->ad_len))
+		return 0;
+	dctx->iter = sctx->iter;
+	dctx->memcost = sctx->memcost;
+	dctx->lanes = sctx->lanes;
+	dctx->threads = sctx->threads;
+
+	return 1;
+}
+
+static void
+pkey_argon2_cleanup(EVP_PKEY_CTX *ctx)
+{
+	struct argon2_ctx *kctx = ctx->data;
+
+	freezero(kctx->pass, kctx->pass_len);
+	freezero(kctx->salt, kctx->salt_len);
+	freezero(kctx->secret, kctx->secret_len);
+	freezero(kctx->ad, kctx->ad_len);
+	kdf_arena_release(&kctx->arena);
+	freezero(kctx, sizeof(*kctx));
+}
+
+static int
+pkey_argon2_ctrl(EVP_PKEY_CTX *ctx, int type, int p1, void *p2)
+{
+	struct argon2_ctx *kctx = ctx->data;
+	uint64_t u64 = 0;
+
+	switch (type) {
+	case EVP_PKEY_CTRL_ARGON2_ITER:
+	case EVP_PKEY_CTRL_ARGON2_MEMCOST:
+	case EVP_PKEY_CTRL_ARGON2_LANES:
+	case EVP_PKEY_CTRL_ARGON2_THREADS:
+		if (p2 == NULL)
+			return 0;
+		u64 = *(uint64_t *)p2;
+		if (u64 < 1 || u64 > UINT32_MAX)
+			return 0;
+		break;
+	}
+
+	switch (type) {
+	case EVP_PKEY_CTRL_PASS:
+		return kdf_set_membuf(&kctx->pass, &kctx->pass_len, p2, p1);
+
+	case EVP_PKEY_CTRL_ARGON2_SALT:
+		return kdf_set_membuf(&kctx->salt, &kctx->salt_len, p2, p1);
+
+	case EVP_PKEY_CTRL_ARGON2_SECRET:
+		return kdf_set_membuf(&kctx->secret, &kctx->secret_len, p2, p1);
+
+	case EVP_PKEY_CTRL_ARGON2_AD:
+		return kdf_set_membuf(&kctx->ad, &kctx->ad_len, p2, p1);
+
+	case EVP_PKEY_CTRL_ARGON2_ITER:
+		kctx->iter = u64;
+		return 1;
+
+	case EVP_PKEY_CTRL_ARGON2_MEMCOST:
+		kctx->memcost = u64;
+		return 1;
+
+	case EVP_PKEY_CTRL_ARGON2_LANES:
+		if (u64 > ARGON2_MAX_LANES)
+			return 0;
+		kctx->lanes = u64;
+		return 1;
+
+	case EVP_PKEY_CTRL_ARGON2_THREADS:
+		if (u64 > ARGON2_MAX_THREADS)
+			u64 = ARGON2_MAX_THREADS;
+		kctx->threads = u64;
+		return 1;
+
+	default:
+		return -2;
+	}
+}
+
+static int
+pkey_argon2_ctrl_uint64(EVP_PKEY_CTX *ctx, int type, const char *value)
+{
+	const char *errstr;
+	uint64_t u64;
+
+	u64 = strtonum(value, 0, UINT32_MAX, &errstr);
+	if (errstr != NULL) {
+		KDFerror(KDF_R_VALUE_ERROR);
+		return 0;
+	}
+
+	return pkey_argon2_ctrl(ctx, type, 0, &u64);
+}
+
+static int
+pkey_argon2_ctrl_str(EVP_PKEY_CTX *ctx, const char *type, const char *value)
+{
+	if (value == NULL) {
+		KDFerror(KDF_R_VALUE_MISSING);
+		return 0;
+	}
+
+	if (strcmp(type, "pass") == 0)
+		return EVP_PKEY_CTX_str2ctrl(ctx, EVP_PKEY_CTRL_PASS, value);
+	if (strcmp(type, "hexpass") == 0)
+		return EVP_PKEY_CTX_hex2ctrl(ctx, EVP_PKEY_CTRL_PASS, value);
+	if (strcmp(type, "salt") == 0)
+		return EVP_PKEY_CTX_str2ctrl(ctx, EVP_PKEY_CTRL_ARGON2_SALT,
+		    value);
+	if (strcmp(type, "hexsalt") == 0)
+		return EVP_PKEY_CTX_hex2ctrl(ctx, EVP_PKEY_CTRL_ARGON2_SALT,
+		    value);
+	if (strcmp(type, "secret") == 0)
+		return EVP_PKEY_CTX_str2ctrl(ctx, EVP_PKEY_CTRL_ARGON2_SECRET,
+		    value);
+	if (strcmp(type, "hexsecret") == 0)
+		return EVP_PKEY_CTX_hex2ctrl(ctx, EVP_PKEY_CTRL_ARGON2_SECRET,
+		    value);
+	if (strcmp(type, "ad") == 0)
+		return EVP_PKEY_CTX_str2ctrl(ctx, EVP_PKEY_CTRL_ARGON2_AD,
+		    value);
+	if (strcmp(type, "hexad") == 0)
+		return EVP_PKEY_CTX_hex2ctrl(ctx, EVP_PKEY_CTRL_ARGON2_AD,
+		    value);
+	if (strcmp(type, "iter") == 0)
+		return pkey_argon2_ctrl_uint64(ctx, EVP_PKEY_CTRL_ARGON2_ITER,
+		    value);
+	if (strcmp(type, "memcost") == 0)
+		return pkey_argon2_ctrl_uint64(ctx,
+		    EVP_PKEY_CTRL_ARGON2_MEMCOST, value);
+	if (strcmp(type, "lanes") == 0)
+		return pkey_argon2_ctrl_uint64(ctx, EVP_PKEY_CTRL_ARGON2_LANES,
+		    value);
+	if (strcmp(type, "threads") == 0)
+		return pkey_argon2_ctrl_uint64(ctx,
+		    EVP_PKEY_CTRL_ARGON2_THREADS, value);
+
+	KDFerror(KDF_R_UNKNOWN_PARAMETER_TYPE);
+	return -2;
+}
+
+static int
+pkey_argon2_derive(EVP_PKEY_CTX *ctx, unsigned char *key, size_t *key_len)
+{
+	struct argon2_ctx *kctx = ctx->data;
+
+	if (kctx->pass == NULL) {
+		KDFerror(KDF_R_MISSING_PASS);
+		return 0;
+	}
+	if (kctx->salt == NULL) {
+		KDFerror(KDF_R_MISSING_SALT);
+		return 0;
+	}
+
+	/*
+	 * Any length from ARGON2_MIN_OUT_LEN up can be derived, so report
+	 * the tag length recommended by RFC 9106.
+	 */
+	if (key == NULL) {
+		if (!argon2_check_params(kctx)) {
+			KDFerror(KDF_R_VALUE_ERROR);
+			return 0;
+		}
+		*key_len = ARGON2_DEFAULT_OUT_LEN;
+		return 1;
+	}
+
+	return argon2id_derive(kctx, key, *key_len);
+}
+
+const EVP_PKEY_METHOD argon2id_pkey_meth = {
+	.pkey_id = EVP_PKEY_ARGON2ID,
+	.flags = 0,
+
+	.init = pkey_argon2_init,
+	.copy = pkey_argon2_copy,
+	.cleanup = pkey_argon2_cleanup,
+
+	.paramgen = NULL,
+
+	.keygen = NULL,
+
+	.sign_init = NULL,
+	.sign = NULL,
+
+	.verify_init = NULL,
+	.verify = NULL,
+
+	.verify_recover = NULL,
+
+	.signctx_init = NULL,
+	.signctx = NULL,
+
+	.encrypt = NULL,
+
+	.decrypt = NULL,
+
+	.derive_init = NULL,
+	.derive = pkey_argon2_derive,
+
+	.ctrl = pkey_argon2_ctrl,
+	.ctrl_str = pkey_argon2_ctrl_str,
+};
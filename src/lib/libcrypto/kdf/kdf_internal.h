@@ -0,0 +1,62 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef HEADER_KDF_INTERNAL_H
+#define HEADER_KDF_INTERNAL_H
+
+/*
+ * Working memory for the memory-hard KDFs is kept in an arena that is owned
+ * by the EVP_PKEY_CTX. Repeated derivations with the same parameters reuse
+ * the same pages, rather than allocating and faulting in tens of megabytes
+ * every time. The arena is cleared whenever it is replaced or released.
+ */
+struct kdf_arena {
+	void *mem;
+	size_t len;
+};
+
+void *kdf_arena_get(struct kdf_arena *arena, size_t len);
+void kdf_arena_release(struct kdf_arena *arena);
+
+int kdf_set_membuf(unsigned char **buf, size_t *buf_len, const void *new_buf,
+    int new_buf_len);
+
+/*
+ * scrypt ROMix (RFC 7914, section 5) on the 128 * r byte block b, with v
+ * providing 128 * r * n bytes and xy 256 * r bytes of working memory.
+ */
+void scrypt_romix(uint8_t *b, size_t r, uint64_t n, uint32_t *v,
+    uint32_t *xy);
+void scrypt_romix_generic(uint8_t *b, size_t r, uint64_t n, uint32_t *v,
+    uint32_t *xy);
+
+#define ARGON2_BLOCK_SIZE	1024
+#define ARGON2_BLOCK_WORDS	(ARGON2_BLOCK_SIZE / 8)
+
+/*
+ * Argon2 compression function G (RFC 9106, section 3.5), computing
+ * next = G(prev, ref), or next ^= G(prev, ref) if with_xor is non-zero.
+ */
+void argon2_fill_block(const uint64_t *prev, const uint64_t *ref,
+    uint64_t *next, int with_xor);
+void argon2_fill_block_generic(const uint64_t *prev, const uint64_t *ref,
+    uint64_t *next, int with_xor);
+
+#endif
@@ -0,0 +1,73 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/kdf.h>
+
+#include "kdf_internal.h"
+
+void *
+kdf_arena_get(struct kdf_arena *arena, size_t len)
+{
+	if (arena->mem != NULL && arena->len >= len)
+		return arena->mem;
+
+	kdf_arena_release(arena);
+
+	if ((arena->mem = malloc(len)) == NULL)
+		return NULL;
+	arena->len = len;
+
+	return arena->mem;
+}
+
+void
+kdf_arena_release(struct kdf_arena *arena)
+{
+	freezero(arena->mem, arena->len);
+	arena->mem = NULL;
+	arena->len = 0;
+}
+
+/*
+ * Replace the contents of buf with a copy of new_buf. An empty value still
+ * results in an allocation, so that it can be distinguished from an unset one.
+ */
+int
+kdf_set_membuf(unsigned char **buf, size_t *buf_len, const void *new_buf,
+    int new_buf_len)
+{
+	if (new_buf_len < 0 || (new_buf == NULL && new_buf_len != 0))
+		return 0;
+
+	freezero(*buf, *buf_len);
+	*buf = NULL;
+	*buf_len = 0;
+
+	if ((*buf = calloc(1, (size_t)new_buf_len + 1)) == NULL) {
+		KDFerror(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+	if (new_buf_len > 0)
+		memcpy(*buf, new_buf, new_buf_len);
+	*buf_len = new_buf_len;
+
+	return 1;
+}
@@ -0,0 +1,511 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * scrypt password-based key derivation function (RFC 7914).
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+#include "crypto_internal.h"
+#include "evp_local.h"
+#include "kdf_internal.h"
+
+/* p * r must be less than 2^30. */
+#define SCRYPT_PR_MAX		((1 << 30) - 1)
+
+/* Memory limit used when none is specified. */
+#define SCRYPT_MAX_MEM		(1024 * 1024 * 32)
+
+struct scrypt_ctx {
+	unsigned char *pass;
+	size_t pass_len;
+	unsigned char *salt;
+	size_t salt_len;
+	uint64_t N;
+	uint64_t r;
+	uint64_t p;
+	uint64_t maxmem_bytes;
+	struct kdf_arena arena;
+};
+
+static void
+scrypt_salsa20_8(uint32_t b[16])
+{
+	uint32_t x[16];
+	int i;
+
+	memcpy(x, b, sizeof(x));
+
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on columns. */
+		x[4] ^= crypto_rol_u32(x[0] + x[12], 7);
+		x[8] ^= crypto_rol_u32(x[4] + x[0], 9);
+		x[12] ^= crypto_rol_u32(x[8] + x[4], 13);
+		x[0] ^= crypto_rol_u32(x[12] + x[8], 18);
+
+		x[9] ^= crypto_rol_u32(x[5] + x[1], 7);
+		x[13] ^= crypto_rol_u32(x[9] + x[5], 9);
+		x[1] ^= crypto_rol_u32(x[13] + x[9], 13);
+		x[5] ^= crypto_rol_u32(x[1] + x[13], 18);
+
+		x[14] ^= crypto_rol_u32(x[10] + x[6], 7);
+		x[2] ^= crypto_rol_u32(x[14] + x[10], 9);
+		x[6] ^= crypto_rol_u32(x[2] + x[14], 13);
+		x[10] ^= crypto_rol_u32(x[6] + x[2], 18);
+
+		x[3] ^= crypto_rol_u32(x[15] + x[11], 7);
+		x[7] ^= crypto_rol_u32(x[3] + x[15], 9);
+		x[11] ^= crypto_rol_u32(x[7] + x[3], 13);
+		x[15] ^= crypto_rol_u32(x[11] + x[7], 18);
+
+		/* Operate on rows. */
+		x[1] ^= crypto_rol_u32(x[0] + x[3], 7);
+		x[2] ^= crypto_rol_u32(x[1] + x[0], 9);
+		x[3] ^= crypto_rol_u32(x[2] + x[1], 13);
+		x[0] ^= crypto_rol_u32(x[3] + x[2], 18);
+
+		x[6] ^= crypto_rol_u32(x[5] + x[4], 7);
+		x[7] ^= crypto_rol_u32(x[6] + x[5], 9);
+		x[4] ^= crypto_rol_u32(x[7] + x[6], 13);
+		x[5] ^= crypto_rol_u32(x[4] + x[7], 18);
+
+		x[11] ^= crypto_rol_u32(x[10] + x[9], 7);
+		x[8] ^= crypto_rol_u32(x[11] + x[10], 9);
+		x[9] ^= crypto_rol_u32(x[8] + x[11], 13);
+		x[10] ^= crypto_rol_u32(x[9] + x[8], 18);
+
+		x[12] ^= crypto_rol_u32(x[15] + x[14], 7);
+		x[13] ^= crypto_rol_u32(x[12] + x[15], 9);
+		x[14] ^= crypto_rol_u32(x[13] + x[12], 13);
+		x[15] ^= crypto_rol_u32(x[14] + x[13], 18);
+	}
+
+	for (i = 0; i < 16; i++)
+		b[i] += x[i];
+}
+
+/*
+ * BlockMix with Salsa20/8 (RFC 7914, section 4), from the 2 * r 64 byte
+ * blocks of bin to bout.
+ */
+static void
+scrypt_blockmix_salsa8(const uint32_t *bin, uint32_t *bout, size_t r)
+{
+	uint32_t x[16];
+	size_t i, j;
+
+	memcpy(x, &bin[(2 * r - 1) * 16], sizeof(x));
+
+	for (i = 0; i < 2 * r; i++) {
+		for (j = 0; j < 16; j++)
+			x[j] ^= bin[i * 16 + j];
+		scrypt_salsa20_8(x);
+		memcpy(&bout[(i / 2 + (i & 1) * r) * 16], x, sizeof(x));
+	}
+}
+
+static uint64_t
+scrypt_integerify(const uint32_t *b, size_t r)
+{
+	const uint32_t *x = &b[(2 * r - 1) * 16];
+
+	return (uint64_t)x[1] << 32 | x[0];
+}
+
+void
+scrypt_romix_generic(uint8_t *b, size_t r, uint64_t n, uint32_t *v,
+    uint32_t *xy)
+{
+	uint32_t *x = xy, *y = &xy[32 * r];
+	uint64_t i, j;
+	size_t k;
+
+	for (k = 0; k < 32 * r; k++)
+		x[k] = crypto_load_le32toh(&b[k * 4]);
+
+	/* n is a power of two, so both loops can be unrolled once. */
+	for (i = 0; i < n; i += 2) {
+		memcpy(&v[i * 32 * r], x, 128 * r);
+		scrypt_blockmix_salsa8(x, y, r);
+		memcpy(&v[(i + 1) * 32 * r], y, 128 * r);
+		scrypt_blockmix_salsa8(y, x, r);
+	}
+	for (i = 0; i < n; i += 2) {
+		j = scrypt_integerify(x, r) & (n - 1);
+		for (k = 0; k < 32 * r; k++)
+			x[k] ^= v[j * 32 * r + k];
+		scrypt_blockmix_salsa8(x, y, r);
+
+		j = scrypt_integerify(y, r) & (n - 1);
+		for (k = 0; k < 32 * r; k++)
+			y[k] ^= v[j * 32 * r + k];
+		scrypt_blockmix_salsa8(y, x, r);
+	}
+
+	for (k = 0; k < 32 * r; k++)
+		crypto_store_htole32(&b[k * 4], x[k]);
+}
+
+#ifndef HAVE_SCRYPT_ROMIX
+void
+scrypt_romix(uint8_t *b, size_t r, uint64_t n, uint32_t *v, uint32_t *xy)
+{
+	scrypt_romix_generic(b, r, n, v, xy);
+}
+#endif
+
+/*
+ * Check the scrypt parameters and compute the length of B and of the memory
+ * needed for V and XY, which together must not exceed maxmem bytes.
+ */
+static int
+scrypt_check_params(uint64_t N, uint64_t r, uint64_t p, uint64_t maxmem,
+    size_t *out_b_len, size_t *out_v_len)
+{
+	uint64_t b_len, v_len;
+
+	if (N < 2 || (N & (N - 1)) != 0 || r == 0 || p == 0) {
+		KDFerror(KDF_R_VALUE_ERROR);
+		return 0;
+	}
+	if (p > SCRYPT_PR_MAX / r) {
+		KDFerror(KDF_R_MEMORY_LIMIT_EXCEEDED);
+		return 0;
+	}
+	/* N must be less than 2^(128 * r / 8). */
+	if (r < 4 && N >= (uint64_t)1 << (16 * r)) {
+		KDFerror(KDF_R_VALUE_ERROR);
+		return 0;
+	}
+
+	/* B is passed to PKCS5_PBKDF2_HMAC(), which takes an int length. */
+	b_len = p * 128 * r;
+	if (b_len > INT_MAX) {
+		KDFerror(KDF_R_MEMORY_LIMIT_EXCEEDED);
+		return 0;
+	}
+
+	if (N + 2 > UINT64_MAX / 128 / r) {
+		KDFerror(KDF_R_MEMORY_LIMIT_EXCEEDED);
+		return 0;
+	}
+	v_len = 128 * r * (N + 2);
+
+	if (maxmem == 0)
+		maxmem = SCRYPT_MAX_MEM;
+	if (maxmem > SIZE_MAX)
+		maxmem = SIZE_MAX;
+	if (v_len > maxmem || b_len > maxmem - v_len) {
+		KDFerror(KDF_R_MEMORY_LIMIT_EXCEEDED);
+		return 0;
+	}
+
+	*out_b_len = b_len;
+	*out_v_len = v_len;
+
+	return 1;
+}
+
+static int
+scrypt_derive(const char *pass, size_t pass_len, const unsigned char *salt,
+    size_t salt_len, uint64_t N, uint64_t r, uint64_t p, uint64_t maxmem,
+    unsigned char *key, size_t key_len, struct kdf_arena *arena)
+{
+	uint8_t *b;
+	uint32_t *v;
+	size_t b_len, v_len;
+	uint64_t i;
+
+	if (!scrypt_check_params(N, r, p, maxmem, &b_len, &v_len))
+		return 0;
+
+	/* Without an output buffer, only check the parameters. */
+	if (key == NULL)
+		return 1;
+
+	if (pass_len > INT_MAX || salt_len > INT_MAX || key_len > INT_MAX) {
+		KDFerror(KDF_R_VALUE_ERROR);
+		return 0;
+	}
+
+	if ((b = kdf_arena_get(arena, b_len + v_len)) == NULL) {
+		KDFerror(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+	v = (uint32_t *)&b[b_len];
+
+	if (!PKCS5_PBKDF2_HMAC(pass, pass_len, salt, salt_len, 1, EVP_sha256(),
+	    b_len, b))
+		return 0;
+	for (i = 0; i < p; i++)
+		scrypt_romix(&b[128 * r * i], r, N, v, &v[32 * r * N]);
+	if (!PKCS5_PBKDF2_HMAC(pass, pass_len, b, b_len, 1, EVP_sha256(),
+	    key_len, key))
+		return 0;
+
+	return 1;
+}
+
+int
+EVP_PBE_scrypt(const char *pass, size_t passlen, const unsigned char *salt,
+    size_t saltlen, uint64_t N, uint64_t r, uint64_t p, uint64_t maxmem,
+    unsigned char *key, size_t keylen)
+{
+	struct kdf_arena arena;
+	int ret;
+
+	memset(&arena, 0, sizeof(arena));
+
+	if (pass == NULL) {
+		pass = "";
+		passlen = 0;
+	}
+	if (salt == NULL) {
+		salt = (const unsigned char *)"";
+		saltlen = 0;
+	}
+
+	ret = scrypt_derive(pass, passlen, salt, saltlen, N, r, p, maxmem,
+	    key, keylen, &arena);
+
+	kdf_arena_release(&arena);
+
+	return ret;
+}
+LCRYPTO_ALIAS(EVP_PBE_scrypt);
+
+static int
+pkey_scrypt_init(EVP_PKEY_CTX *ctx)
+{
+	struct scrypt_ctx *kctx;
+
+	if ((kctx = calloc(1, sizeof(*kctx))) == NULL) {
+		KDFerror(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+	kctx->N = 1 << 20;
+	kctx->r = 8;
+	kctx->p = 1;
+	kctx->maxmem_bytes = 1025 * 1024 * 1024;
+
+	ctx->data = kctx;
+
+	return 1;
+}
+
+/*
+ * The memory arena is not copied, the new context allocates its own on its
+ * first derivation.
+ */
+static int
+pkey_scrypt_copy(EVP_PKEY_CTX *dst, EVP_PKEY_CTX *src)
+{
+	struct scrypt_ctx *sctx, *dctx;
+
+	if (!pkey_scrypt_init(dst))
+		return 0;
+	sctx = src->data;
+	dctx = dst->data;
+
+	if (sctx->pass != NULL && !kdf_set_membuf(&dctx->pass,
+	    &dctx->pass_len, sctx->pass, sctx->pass_len))
+		return 0;
+	if (sctx->salt != NULL && !kdf_set_membuf(&dctx->salt,
+	    &dctx->salt_len, sctx->salt, sctx->salt_len))
+		return 0;
+	dctx->N = sctx->N;
+	dctx->r = sctx->r;
+	dctx->p = sctx->p;
+	dctx->maxmem_bytes = sctx->maxmem_bytes;
+
+	return 1;
+}
+
+static void
+pkey_scrypt_cleanup(EVP_PKEY_CTX *ctx)
+{
+	struct scrypt_ctx *kctx = ctx->data;
+
+	freezero(kctx->pass, kctx->pass_len);
+	freezero(kctx->salt, kctx->salt_len);
+	kdf_arena_release(&kctx->arena);
+	freezero(kctx, sizeof(*kctx));
+}
+
+static int
+pkey_scrypt_ctrl(EVP_PKEY_CTX *ctx, int type, int p1, void *p2)
+{
+	struct scrypt_ctx *kctx = ctx->data;
+	uint64_t u64 = 0;
+
+	switch (type) {
+	case EVP_PKEY_CTRL_SCRYPT_N:
+	case EVP_PKEY_CTRL_SCRYPT_R:
+	case EVP_PKEY_CTRL_SCRYPT_P:
+	case EVP_PKEY_CTRL_SCRYPT_MAXMEM_BYTES:
+		if (p2 == NULL)
+			return 0;
+		u64 = *(uint64_t *)p2;
+		break;
+	}
+
+	switch (type) {
+	case EVP_PKEY_CTRL_PASS:
+		return kdf_set_membuf(&kctx->pass, &kctx->pass_len, p2, p1);
+
+	case EVP_PKEY_CTRL_SCRYPT_SALT:
+		return kdf_set_membuf(&kctx->salt, &kctx->salt_len, p2, p1);
+
+	case EVP_PKEY_CTRL_SCRYPT_N:
+		if (u64 < 2 || (u64 & (u64 - 1)) != 0)
+			return 0;
+		kctx->N = u64;
+		return 1;
+
+	case EVP_PKEY_CTRL_SCRYPT_R:
+		if (u64 < 1)
+			return 0;
+		kctx->r = u64;
+		return 1;
+
+	case EVP_PKEY_CTRL_SCRYPT_P:
+		if (u64 < 1)
+			return 0;
+		kctx->p = u64;
+		return 1;
+
+	case EVP_PKEY_CTRL_SCRYPT_MAXMEM_BYTES:
+		if (u64 < 1)
+			return 0;
+		kctx->maxmem_bytes = u64;
+		return 1;
+
+	default:
+		return -2;
+	}
+}
+
+static int
+pkey_scrypt_ctrl_uint64(EVP_PKEY_CTX *ctx, int type, const char *value)
+{
+	const char *errstr;
+	uint64_t u64;
+
+	u64 = strtonum(value, 0, LLONG_MAX, &errstr);
+	if (errstr != NULL) {
+		KDFerror(KDF_R_VALUE_ERROR);
+		return 0;
+	}
+
+	return pkey_scrypt_ctrl(ctx, type, 0, &u64);
+}
+
+static int
+pkey_scrypt_ctrl_str(EVP_PKEY_CTX *ctx, const char *type, const char *value)
+{
+	if (value == NULL) {
+		KDFerror(KDF_R_VALUE_MISSING);
+		return 0;
+	}
+
+	if (strcmp(type, "pass") == 0)
+		return EVP_PKEY_CTX_str2ctrl(ctx, EVP_PKEY_CTRL_PASS, value);
+	if (strcmp(type, "hexpass") == 0)
+		return EVP_PKEY_CTX_hex2ctrl(ctx, EVP_PKEY_CTRL_PASS, value);
+	if (strcmp(type, "salt") == 0)
+		return EVP_PKEY_CTX_str2ctrl(ctx, EVP_PKEY_CTRL_SCRYPT_SALT,
+		    value);
+	if (strcmp(type, "hexsalt") == 0)
+		return EVP_PKEY_CTX_hex2ctrl(ctx, EVP_PKEY_CTRL_SCRYPT_SALT,
+		    value);
+	if (strcmp(type, "N") == 0)
+		return pkey_scrypt_ctrl_uint64(ctx, EVP_PKEY_CTRL_SCRYPT_N,
+		    value);
+	if (strcmp(type, "r") == 0)
+		return pkey_scrypt_ctrl_uint64(ctx, EVP_PKEY_CTRL_SCRYPT_R,
+		    value);
+	if (strcmp(type, "p") == 0)
+		return pkey_scrypt_ctrl_uint64(ctx, EVP_PKEY_CTRL_SCRYPT_P,
+		    value);
+	if (strcmp(type, "maxmem_bytes") == 0)
+		return pkey_scrypt_ctrl_uint64(ctx,
+		    EVP_PKEY_CTRL_SCRYPT_MAXMEM_BYTES, value);
+
+	KDFerror(KDF_R_UNKNOWN_PARAMETER_TYPE);
+	return -2;
+}
+
+static int
+pkey_scrypt_derive(EVP_PKEY_CTX *ctx, unsigned char *key, size_t *key_len)
+{
+	struct scrypt_ctx *kctx = ctx->data;
+
+	if (kctx->pass == NULL) {
+		KDFerror(KDF_R_MISSING_PASS);
+		return 0;
+	}
+	if (kctx->salt == NULL) {
+		KDFerror(KDF_R_MISSING_SALT);
+		return 0;
+	}
+
+	return scrypt_derive((const char *)kctx->pass, kctx->pass_len,
+	    kctx->salt, kctx->salt_len, kctx->N, kctx->r, kctx->p,
+	    kctx->maxmem_bytes, key, *key_len, &kctx->arena);
+}
+
+const EVP_PKEY_METHOD scrypt_pkey_meth = {
+	.pkey_id = EVP_PKEY_SCRYPT,
+	.flags = 0,
+
+	.init = pkey_scrypt_init,
+	.copy = pkey_scrypt_copy,
+	.cleanup = pkey_scrypt_cleanup,
+
+	.paramgen = NULL,
+
+	.keygen = NULL,
+
+	.sign_init = NULL,
+	.sign = NULL,
+
+	.verify_init = NULL,
+	.verify = NULL,
+
+	.verify_recover = NULL,
+
+	.signctx_init = NULL,
+	.signctx = NULL,
+
+	.encrypt = NULL,
+
+	.decrypt = NULL,
+
+	.derive_init = NULL,
+	.derive = pkey_scrypt_derive,
+
+	.ctrl = pkey_scrypt_ctrl,
+	.ctrl_str = pkey_scrypt_ctrl_str,
+};
@@ -0,0 +1,73 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "crypto_internal.h"
+#include "kdf_internal.h"
+
+void scrypt_blockmix_salsa8_sse2(const uint32_t *bin, uint32_t *bout,
+    size_t r);
+void scrypt_blockmix_salsa8_xor_sse2(const uint32_t *bin1,
+    const uint32_t *bin2, uint32_t *bout, size_t r);
+
+/*
+ * The SSE2 BlockMix operates on blocks with their words permuted, so convert
+ * on the way in and out of ROMix. The value used by Integerify is word 0 and
+ * word 1 of the last block, which are at positions 0 and 13.
+ */
+static uint64_t
+scrypt_integerify_sse2(const uint32_t *b, size_t r)
+{
+	const uint32_t *x = &b[(2 * r - 1) * 16];
+
+	return (uint64_t)x[13] << 32 | x[0];
+}
+
+void
+scrypt_romix(uint8_t *b, size_t r, uint64_t n, uint32_t *v, uint32_t *xy)
+{
+	uint32_t *x = xy, *y = &xy[32 * r];
+	uint64_t i, j;
+	size_t k, l;
+
+	for (k = 0; k < 2 * r; k++) {
+		for (l = 0; l < 16; l++)
+			x[k * 16 + l] =
+			    crypto_load_le32toh(&b[(k * 16 + l * 5 % 16) * 4]);
+	}
+
+	for (i = 0; i < n; i += 2) {
+		memcpy(&v[i * 32 * r], x, 128 * r);
+		scrypt_blockmix_salsa8_sse2(x, y, r);
+		memcpy(&v[(i + 1) * 32 * r], y, 128 * r);
+		scrypt_blockmix_salsa8_sse2(y, x, r);
+	}
+	for (i = 0; i < n; i += 2) {
+		j = scrypt_integerify_sse2(x, r) & (n - 1);
+		scrypt_blockmix_salsa8_xor_sse2(x, &v[j * 32 * r], y, r);
+		j = scrypt_integerify_sse2(y, r) & (n - 1);
+		scrypt_blockmix_salsa8_xor_sse2(y, &v[j * 32 * r], x, r);
+	}
+
+	for (k = 0; k < 2 * r; k++) {
+		for (l = 0; l < 16; l++)
+			crypto_store_htole32(&b[(k * 16 + l * 5 % 16) * 4],
+			    x[k * 16 + l]);
+	}
+}
@@ -0,0 +1,86 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef HEADER_MLKEM_H
+#define HEADER_MLKEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <openssl/opensslconf.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * ML-KEM-768.
+ *
+ * ML-KEM is the module-lattice-based key-encapsulation mechanism
+ * standardised in FIPS 203. ML-KEM-768 is the parameter set with module
+ * rank three, targeting NIST security category 3.
+ */
+
+#define MLKEM768_PUBLIC_KEY_BYTES	1184
+#define MLKEM768_PRIVATE_KEY_BYTES	2400
+#define MLKEM768_CIPHERTEXT_BYTES	1088
+#define MLKEM_SHARED_SECRET_BYTES	32
+#define MLKEM_SEED_BYTES		64
+
+/*
+ * MLKEM768_generate_key sets |out_public_key| and |out_private_key| to a
+ * freshly generated encapsulation and decapsulation key pair. The private key
+ * is in the FIPS 203 decapsulation key encoding. It returns one on success and
+ * zero on error.
+ */
+int MLKEM768_generate_key(
+    uint8_t out_public_key[MLKEM768_PUBLIC_KEY_BYTES],
+    uint8_t out_private_key[MLKEM768_PRIVATE_KEY_BYTES]);
+
+/*
+ * MLKEM768_check_public_key performs the FIPS 203 encapsulation key check on
+ * |public_key|. It returns one if every coefficient is reduced modulo q and
+ * zero otherwise.
+ */
+int MLKEM768_check_public_key(
+    const uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES]);
+
+/*
+ * MLKEM768_encap encapsulates a fresh shared secret to |public_key|, writing
+ * the ciphertext to |out_ciphertext| and the secret to |out_shared_secret|.
+ * It returns zero if |public_key| is not a valid encapsulation key.
+ */
+int MLKEM768_encap(uint8_t out_ciphertext[MLKEM768_CIPHERTEXT_BYTES],
+    uint8_t out_shared_secret[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES]);
+
+/*
+ * MLKEM768_decap recovers the shared secret from |ciphertext| using
+ * |private_key|. A ciphertext that fails the re-encryption check results in
+ * a pseudorandom secret derived from the private key (implicit rejection),
+ * so success does not imply that the peer holds the same secret. It returns
+ * zero only if |ciphertext_len| is not MLKEM768_CIPHERTEXT_BYTES.
+ */
+int MLKEM768_decap(uint8_t out_shared_secret[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t *ciphertext, size_t ciphertext_len,
+    const uint8_t private_key[MLKEM768_PRIVATE_KEY_BYTES]);
+
+#if defined(__cplusplus)
+}  /* extern C */
+#endif
+
+#endif  /* HEADER_MLKEM_H */
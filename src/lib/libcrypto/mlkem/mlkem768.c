@@ -0,0 +1,874 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * ML-KEM-768 (FIPS 203).
+ *
+ * Polynomials are kept as 256 signed 16-bit coefficients and reduced lazily
+ * using Montgomery and Barrett reduction. The NTT and the pointwise
+ * arithmetic are written as fixed length loops over int16_t arrays with no
+ * data dependent branches, so that they run in constant time and so that
+ * the compiler is able to vectorise the inner loops. Architectures may
+ * provide their own NTT, as amd64 does with AVX2. The only variable time code
+ * is rejection sampling of the public matrix, which only processes public
+ * data.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <openssl/mlkem.h>
+
+#include "crypto_internal.h"
+#include "mlkem_internal.h"
+#include "sha3_internal.h"
+
+#define MLKEM_Q			3329
+#define MLKEM_QINV		-3327	/* q^-1 mod 2^16 */
+#define MLKEM_MONT_R2		1353	/* 2^32 mod q */
+#define MLKEM_INVNTT_F		1441	/* 2^32 / 128 mod q */
+#define MLKEM_BARRETT_V		20159	/* round(2^26 / q) */
+
+#define MLKEM768_RANK		3
+#define MLKEM768_DU		10
+#define MLKEM768_DV		4
+#define MLKEM_ETA		2
+
+#define MLKEM_SYMBYTES		32
+#define MLKEM_SHAKE128_RATE	168
+#define MLKEM_POLY_BYTES	384
+#define MLKEM768_POLYVEC_BYTES	(MLKEM768_RANK * MLKEM_POLY_BYTES)
+#define MLKEM768_U_BYTES	(MLKEM768_RANK * MLKEM_N * MLKEM768_DU / 8)
+#define MLKEM768_V_BYTES	(MLKEM_N * MLKEM768_DV / 8)
+
+/* Offsets into the FIPS 203 decapsulation key encoding. */
+#define MLKEM768_DK_PKE_OFFSET	0
+#define MLKEM768_DK_EK_OFFSET	MLKEM768_POLYVEC_BYTES
+#define MLKEM768_DK_H_OFFSET	(MLKEM768_DK_EK_OFFSET + MLKEM768_PUBLIC_KEY_BYTES)
+#define MLKEM768_DK_Z_OFFSET	(MLKEM768_DK_H_OFFSET + MLKEM_SYMBYTES)
+
+CTASSERT(MLKEM768_POLYVEC_BYTES + MLKEM_SYMBYTES == MLKEM768_PUBLIC_KEY_BYTES);
+CTASSERT(MLKEM768_U_BYTES + MLKEM768_V_BYTES == MLKEM768_CIPHERTEXT_BYTES);
+CTASSERT(MLKEM768_DK_Z_OFFSET + MLKEM_SYMBYTES == MLKEM768_PRIVATE_KEY_BYTES);
+
+typedef struct {
+	int16_t c[MLKEM_N];
+} mlkem_poly;
+
+typedef struct {
+	mlkem_poly p[MLKEM768_RANK];
+} mlkem_polyvec;
+
+/*
+ * Powers of the 256th root of unity 17, in bit reversed order and in
+ * Montgomery form, centred around zero.
+ */
+static const int16_t mlkem_zetas[128] = {
+	-1044, -758, -359, -1517, 1493, 1422, 287, 202,
+	-171, 622, 1577, 182, 962, -1202, -1474, 1468,
+	573, -1325, 264, 383, -829, 1458, -1602, -130,
+	-681, 1017, 732, 608, -1542, 411, -205, -1571,
+	1223, 652, -552, 1015, -1293, 1491, -282, -1544,
+	516, -8, -320, -666, -1618, -1162, 126, 1469,
+	-853, -90, -271, 830, 107, -1421, -247, -951,
+	-398, 961, -1508, -725, 448, -1065, 677, -1275,
+	-1103, 430, 555, 843, -1251, 871, 1550, 105,
+	422, 587, 177, -235, -291, -460, 1574, 1653,
+	-246, 778, 1159, -147, -777, 1483, -602, 1119,
+	-1590, 644, -872, 349, 418, 329, -156, -75,
+	817, 1097, 603, 610, 1322, -1285, -1465, 384,
+	-1215, -136, 1218, -1335, -874, 220, -1187, -1659,
+	-1185, -1530, -1278, 794, -1510, -854, -870, 478,
+	-108, -308, 996, 991, 958, -1460, 1522, 1628,
+};
+
+/*
+ * Given -2^15 q <= a < 2^15 q, compute a * 2^-16 mod q in the range
+ * -q < r < q.
+ */
+static inline int16_t
+mlkem_montgomery_reduce(int32_t a)
+{
+	int16_t t;
+
+	t = (int16_t)a * MLKEM_QINV;
+
+	return (a - (int32_t)t * MLKEM_Q) >> 16;
+}
+
+/* Compute the centred representative of a mod q. */
+static inline int16_t
+mlkem_barrett_reduce(int16_t a)
+{
+	int16_t t;
+
+	t = ((int32_t)MLKEM_BARRETT_V * a + (1 << 25)) >> 26;
+
+	return a - t * MLKEM_Q;
+}
+
+static inline int16_t
+mlkem_fqmul(int16_t a, int16_t b)
+{
+	return mlkem_montgomery_reduce((int32_t)a * b);
+}
+
+/* Map a centred representative into the range 0 <= r < q. */
+static inline uint16_t
+mlkem_canonical(int16_t a)
+{
+	a += (a >> 15) & MLKEM_Q;
+
+	return a;
+}
+
+static void
+mlkem_poly_reduce(mlkem_poly *r)
+{
+	int i;
+
+	for (i = 0; i < MLKEM_N; i++)
+		r->c[i] = mlkem_barrett_reduce(r->c[i]);
+}
+
+static void
+mlkem_poly_add(mlkem_poly *r, const mlkem_poly *a, const mlkem_poly *b)
+{
+	int i;
+
+	for (i = 0; i < MLKEM_N; i++)
+		r->c[i] = a->c[i] + b->c[i];
+}
+
+static void
+mlkem_poly_sub(mlkem_poly *r, const mlkem_poly *a, const mlkem_poly *b)
+{
+	int i;
+
+	for (i = 0; i < MLKEM_N; i++)
+		r->c[i] = a->c[i] - b->c[i];
+}
+
+static void
+mlkem_poly_tomont(mlkem_poly *r)
+{
+	int i;
+
+	for (i = 0; i < MLKEM_N; i++)
+		r->c[i] = mlkem_fqmul(r->c[i], MLKEM_MONT_R2);
+}
+
+/*
+ * Forward NTT, from normal order to bit reversed order. Each layer is a run
+ * of Cooley-Tukey butterflies over contiguous blocks, with coefficients
+ * growing by at most q per layer.
+ */
+void
+mlkem_ntt_generic(int16_t r[MLKEM_N])
+{
+	int16_t t, zeta;
+	int len, start, j, k;
+
+	k = 1;
+	for (len = 128; len >= 2; len >>= 1) {
+		for (start = 0; start < MLKEM_N; start += 2 * len) {
+			zeta = mlkem_zetas[k++];
+			for (j = start; j < start + len; j++) {
+				t = mlkem_fqmul(zeta, r[j + len]);
+				r[j + len] = r[j] - t;
+				r[j] = r[j] + t;
+			}
+		}
+	}
+	for (j = 0; j < MLKEM_N; j++)
+		r[j] = mlkem_barrett_reduce(r[j]);
+}
+
+/*
+ * Inverse NTT using Gentleman-Sande butterflies, multiplying the result by
+ * the Montgomery factor 2^16.
+ */
+void
+mlkem_invntt_generic(int16_t r[MLKEM_N])
+{
+	int16_t t, zeta;
+	int len, start, j, k;
+
+	k = 127;
+	for (len = 2; len <= 128; len <<= 1) {
+		for (start = 0; start < MLKEM_N; start += 2 * len) {
+			zeta = mlkem_zetas[k--];
+			for (j = start; j < start + len; j++) {
+				t = r[j];
+				r[j] = mlkem_barrett_reduce(t + r[j + len]);
+				r[j + len] = mlkem_fqmul(zeta, r[j + len] - t);
+			}
+		}
+	}
+	for (j = 0; j < MLKEM_N; j++)
+		r[j] = mlkem_fqmul(r[j], MLKEM_INVNTT_F);
+}
+
+#ifndef HAVE_MLKEM_NTT
+void
+mlkem_ntt(int16_t r[MLKEM_N])
+{
+	mlkem_ntt_generic(r);
+}
+
+void
+mlkem_invntt(int16_t r[MLKEM_N])
+{
+	mlkem_invntt_generic(r);
+}
+#endif
+
+static void
+mlkem_poly_ntt(mlkem_poly *r)
+{
+	mlkem_ntt(r->c);
+}
+
+static void
+mlkem_poly_invntt_tomont(mlkem_poly *r)
+{
+	mlkem_invntt(r->c);
+}
+
+/*
+ * Multiply two polynomials in the NTT domain, which amounts to 128 products
+ * in Z_q[X]/(X^2 - zeta), accumulating into r. The result carries a factor
+ * of 2^-16.
+ */
+static void
+mlkem_poly_basemul_acc(mlkem_poly *r, const mlkem_poly *a,
+    const mlkem_poly *b)
+{
+	int16_t zeta;
+	int i, j;
+
+	for (i = 0; i < MLKEM_N / 2; i++) {
+		zeta = mlkem_zetas[64 + i / 2];
+		if ((i & 1) != 0)
+			zeta = -zeta;
+		j = 2 * i;
+		r->c[j] += mlkem_fqmul(mlkem_fqmul(a->c[j + 1], b->c[j + 1]),
+		    zeta) + mlkem_fqmul(a->c[j], b->c[j]);
+		r->c[j + 1] += mlkem_fqmul(a->c[j], b->c[j + 1]) +
+		    mlkem_fqmul(a->c[j + 1], b->c[j]);
+	}
+}
+
+static void
+mlkem_polyvec_inner_product(mlkem_poly *r, const mlkem_polyvec *a,
+    const mlkem_polyvec *b)
+{
+	int i;
+
+	memset(r, 0, sizeof(*r));
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		mlkem_poly_basemul_acc(r, &a->p[i], &b->p[i]);
+		mlkem_poly_reduce(r);
+	}
+}
+
+static void
+mlkem_poly_to_bytes(uint8_t out[MLKEM_POLY_BYTES], const mlkem_poly *a)
+{
+	uint16_t t0, t1;
+	int i;
+
+	for (i = 0; i < MLKEM_N / 2; i++) {
+		t0 = mlkem_canonical(a->c[2 * i]);
+		t1 = mlkem_canonical(a->c[2 * i + 1]);
+		out[3 * i] = t0;
+		out[3 * i + 1] = (t0 >> 8) | (t1 << 4);
+		out[3 * i + 2] = t1 >> 4;
+	}
+}
+
+/*
+ * Decode twelve bit coefficients. Returns zero if any coefficient is not
+ * reduced, which is the FIPS 203 modulus check on encapsulation keys.
+ */
+static int
+mlkem_poly_from_bytes(mlkem_poly *r, const uint8_t in[MLKEM_POLY_BYTES])
+{
+	uint16_t t0, t1, invalid = 0;
+	int i;
+
+	for (i = 0; i < MLKEM_N / 2; i++) {
+		t0 = (in[3 * i] | ((uint16_t)in[3 * i + 1] << 8)) & 0xfff;
+		t1 = ((in[3 * i + 1] >> 4) | ((uint16_t)in[3 * i + 2] << 4));
+		invalid |= (uint16_t)(MLKEM_Q - 1 - t0) >> 15;
+		invalid |= (uint16_t)(MLKEM_Q - 1 - t1) >> 15;
+		r->c[2 * i] = t0;
+		r->c[2 * i + 1] = t1;
+	}
+
+	return invalid == 0;
+}
+
+static void
+mlkem_poly_from_msg(mlkem_poly *r, const uint8_t msg[MLKEM_SYMBYTES])
+{
+	int16_t mask;
+	int i, j;
+
+	for (i = 0; i < MLKEM_N / 8; i++) {
+		for (j = 0; j < 8; j++) {
+			mask = -(int16_t)((msg[i] >> j) & 1);
+			r->c[8 * i + j] = mask & ((MLKEM_Q + 1) / 2);
+		}
+	}
+}
+
+static void
+mlkem_poly_to_msg(uint8_t msg[MLKEM_SYMBYTES], const mlkem_poly *a)
+{
+	uint32_t t;
+	int i, j;
+
+	for (i = 0; i < MLKEM_N / 8; i++) {
+		msg[i] = 0;
+		for (j = 0; j < 8; j++) {
+			/* Compress_1(t) = round(2t / q) mod 2. */
+			t = mlkem_canonical(a->c[8 * i + j]);
+			t = (((t << 1) + 1665) * 80635) >> 28;
+			msg[i] |= (t & 1) << j;
+		}
+	}
+}
+
+/*
+ * Compress_10 and Compress_4, computing round(2^d t / q) with a
+ * multiplication by a scaled reciprocal of q rather than a division.
+ */
+static void
+mlkem_poly_compress_du(uint8_t out[MLKEM768_U_BYTES / MLKEM768_RANK],
+    const mlkem_poly *a)
+{
+	uint64_t d;
+	uint16_t t[4];
+	int i, j;
+
+	for (i = 0; i < MLKEM_N / 4; i++) {
+		for (j = 0; j < 4; j++) {
+			d = mlkem_canonical(a->c[4 * i + j]);
+			d = (((d << 10) + 1665) * 1290167) >> 32;
+			t[j] = d & 0x3ff;
+		}
+		out[5 * i] = t[0];
+		out[5 * i + 1] = (t[0] >> 8) | (t[1] << 2);
+		out[5 * i + 2] = (t[1] >> 6) | (t[2] << 4);
+		out[5 * i + 3] = (t[2] >> 4) | (t[3] << 6);
+		out[5 * i + 4] = t[3] >> 2;
+	}
+}
+
+static void
+mlkem_poly_decompress_du(mlkem_poly *r,
+    const uint8_t in[MLKEM768_U_BYTES / MLKEM768_RANK])
+{
+	uint16_t t[4];
+	int i, j;
+
+	for (i = 0; i < MLKEM_N / 4; i++) {
+		t[0] = in[5 * i] | ((uint16_t)in[5 * i + 1] << 8);
+		t[1] = (in[5 * i + 1] >> 2) | ((uint16_t)in[5 * i + 2] << 6);
+		t[2] = (in[5 * i + 2] >> 4) | ((uint16_t)in[5 * i + 3] << 4);
+		t[3] = (in[5 * i + 3] >> 6) | ((uint16_t)in[5 * i + 4] << 2);
+		for (j = 0; j < 4; j++)
+			r->c[4 * i + j] =
+			    ((uint32_t)(t[j] & 0x3ff) * MLKEM_Q + 512) >> 10;
+	}
+}
+
+static void
+mlkem_poly_compress_dv(uint8_t out[MLKEM768_V_BYTES], const mlkem_poly *a)
+{
+	uint32_t d;
+	uint8_t t[2];
+	int i, j;
+
+	for (i = 0; i < MLKEM_N / 2; i++) {
+		for (j = 0; j < 2; j++) {
+			d = mlkem_canonical(a->c[2 * i + j]);
+			d = (((d << 4) + 1665) * 80635) >> 28;
+			t[j] = d & 0xf;
+		}
+		out[i] = t[0] | (t[1] << 4);
+	}
+}
+
+static void
+mlkem_poly_decompress_dv(mlkem_poly *r, const uint8_t in[MLKEM768_V_BYTES])
+{
+	int i;
+
+	for (i = 0; i < MLKEM_N / 2; i++) {
+		r->c[2 * i] = ((uint32_t)(in[i] & 0xf) * MLKEM_Q + 8) >> 4;
+		r->c[2 * i + 1] = ((uint32_t)(in[i] >> 4) * MLKEM_Q + 8) >> 4;
+	}
+}
+
+/*
+ * Rejection sample twelve bit values from buf into r, starting at coefficient
+ * n. Returns the number of coefficients of r that have been filled.
+ */
+static int
+mlkem_poly_rej_uniform(mlkem_poly *r, int n, const uint8_t *buf, size_t len)
+{
+	uint16_t d1, d2;
+	size_t k;
+
+	for (k = 0; k + 3 <= len && n < MLKEM_N; k += 3) {
+		d1 = (buf[k] | ((uint16_t)buf[k + 1] << 8)) & 0xfff;
+		d2 = (buf[k + 1] >> 4) | ((uint16_t)buf[k + 2] << 4);
+		if (d1 < MLKEM_Q)
+			r->c[n++] = d1;
+		if (d2 < MLKEM_Q && n < MLKEM_N)
+			r->c[n++] = d2;
+	}
+
+	return n;
+}
+
+/*
+ * SampleNTT: sample a polynomial in the NTT domain by rejection sampling
+ * twelve bit values from SHAKE128(rho || j || i).
+ */
+static void
+mlkem_poly_sample_ntt(mlkem_poly *r, const uint8_t rho[MLKEM_SYMBYTES],
+    uint8_t j, uint8_t i)
+{
+	uint8_t buf[MLKEM_SHAKE128_RATE];
+	sha3_ctx ctx;
+	int n = 0;
+
+	shake128_init(&ctx);
+	shake_update(&ctx, rho, MLKEM_SYMBYTES);
+	shake_update(&ctx, &j, 1);
+	shake_update(&ctx, &i, 1);
+	shake_xof(&ctx);
+
+	while (n < MLKEM_N) {
+		shake_out(&ctx, buf, sizeof(buf));
+		n = mlkem_poly_rej_uniform(r, n, buf, sizeof(buf));
+	}
+
+	explicit_bzero(&ctx, sizeof(ctx));
+}
+
+/*
+ * SampleNTT for four polynomials at once, running the four SHAKE128
+ * instances in parallel until all of the polynomials have been filled.
+ */
+static void
+mlkem_poly_sample_ntt_x4(mlkem_poly *r[4], const uint8_t rho[MLKEM_SYMBYTES],
+    const uint8_t j[4], const uint8_t i[4])
+{
+	uint8_t buf[4][MLKEM_SHAKE128_RATE], *out[4];
+	sha3_ctx ctxs[4], *ctx[4];
+	int k, n[4] = { 0 };
+
+	for (k = 0; k < 4; k++) {
+		ctx[k] = &ctxs[k];
+		out[k] = buf[k];
+
+		shake128_init(ctx[k]);
+		shake_update(ctx[k], rho, MLKEM_SYMBYTES);
+		shake_update(ctx[k], &j[k], 1);
+		shake_update(ctx[k], &i[k], 1);
+	}
+	shake_xof_x4(ctx);
+
+	while (n[0] < MLKEM_N || n[1] < MLKEM_N || n[2] < MLKEM_N ||
+	    n[3] < MLKEM_N) {
+		shake_out_x4(ctx, out, MLKEM_SHAKE128_RATE);
+		for (k = 0; k < 4; k++)
+			n[k] = mlkem_poly_rej_uniform(r[k], n[k], buf[k],
+			    MLKEM_SHAKE128_RATE);
+	}
+
+	explicit_bzero(ctxs, sizeof(ctxs));
+}
+
+/*
+ * SamplePolyCBD_2: sample a polynomial from the centred binomial
+ * distribution with eta = 2, using SHAKE256(sigma || nonce) as PRF.
+ */
+static void
+mlkem_poly_sample_cbd(mlkem_poly *r, const uint8_t sigma[MLKEM_SYMBYTES],
+    uint8_t nonce)
+{
+	uint8_t buf[MLKEM_ETA * MLKEM_N / 4];
+	uint32_t t, d;
+	sha3_ctx ctx;
+	int i, j;
+
+	shake256_init(&ctx);
+	shake_update(&ctx, sigma, MLKEM_SYMBYTES);
+	shake_update(&ctx, &nonce, 1);
+	shake_xof(&ctx);
+	shake_out(&ctx, buf, sizeof(buf));
+
+	for (i = 0; i < MLKEM_N / 8; i++) {
+		t = (uint32_t)buf[4 * i] | (uint32_t)buf[4 * i + 1] << 8 |
+		    (uint32_t)buf[4 * i + 2] << 16 |
+		    (uint32_t)buf[4 * i + 3] << 24;
+		d = (t & 0x55555555) + ((t >> 1) & 0x55555555);
+		for (j = 0; j < 8; j++) {
+			r->c[8 * i + j] = (int16_t)((d >> (4 * j)) & 3) -
+			    (int16_t)((d >> (4 * j + 2)) & 3);
+		}
+	}
+
+	explicit_bzero(buf, sizeof(buf));
+	explicit_bzero(&ctx, sizeof(ctx));
+}
+
+/*
+ * Generate the public matrix A, or its transpose, from rho. The entry
+ * A[i][j] is sampled from rho || j || i. Entries are sampled four at a time,
+ * with any remaining entries being sampled individually.
+ */
+static void
+mlkem_matrix_expand(mlkem_polyvec a[MLKEM768_RANK],
+    const uint8_t rho[MLKEM_SYMBYTES], int transposed)
+{
+	uint8_t sj[4], si[4];
+	mlkem_poly *r[4];
+	int i, j, k, n = 0;
+
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		for (j = 0; j < MLKEM768_RANK; j++) {
+			r[n] = &a[i].p[j];
+			sj[n] = transposed ? i : j;
+			si[n] = transposed ? j : i;
+			if (++n == 4) {
+				mlkem_poly_sample_ntt_x4(r, rho, sj, si);
+				n = 0;
+			}
+		}
+	}
+	for (k = 0; k < n; k++)
+		mlkem_poly_sample_ntt(r[k], rho, sj[k], si[k]);
+}
+
+static void
+mlkem_hash_h(uint8_t out[MLKEM_SYMBYTES], const uint8_t *in, size_t in_len)
+{
+	sha3_ctx ctx;
+
+	sha3_init(&ctx, SHA3_256_DIGEST_LENGTH);
+	sha3_update(&ctx, in, in_len);
+	sha3_final(out, &ctx);
+}
+
+static void
+mlkem_hash_g(uint8_t out[2 * MLKEM_SYMBYTES], const uint8_t *in1,
+    size_t in1_len, const uint8_t *in2, size_t in2_len)
+{
+	sha3_ctx ctx;
+
+	sha3_init(&ctx, SHA3_512_DIGEST_LENGTH);
+	sha3_update(&ctx, in1, in1_len);
+	sha3_update(&ctx, in2, in2_len);
+	sha3_final(out, &ctx);
+
+	explicit_bzero(&ctx, sizeof(ctx));
+}
+
+/* J(z || c), the implicit rejection secret. */
+static void
+mlkem_hash_j(uint8_t out[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t z[MLKEM_SYMBYTES], const uint8_t *c, size_t c_len)
+{
+	sha3_ctx ctx;
+
+	shake256_init(&ctx);
+	shake_update(&ctx, z, MLKEM_SYMBYTES);
+	shake_update(&ctx, c, c_len);
+	shake_xof(&ctx);
+	shake_out(&ctx, out, MLKEM_SHARED_SECRET_BYTES);
+
+	explicit_bzero(&ctx, sizeof(ctx));
+}
+
+static int
+mlkem768_parse_public_key(mlkem_polyvec *t, const uint8_t *ek)
+{
+	int i, valid = 1;
+
+	for (i = 0; i < MLKEM768_RANK; i++)
+		valid &= mlkem_poly_from_bytes(&t->p[i],
+		    &ek[i * MLKEM_POLY_BYTES]);
+
+	return valid;
+}
+
+/* K-PKE.KeyGen */
+static void
+mlkem768_pke_keygen(uint8_t ek[MLKEM768_PUBLIC_KEY_BYTES],
+    uint8_t dk_pke[MLKEM768_POLYVEC_BYTES], const uint8_t d[MLKEM_SYMBYTES])
+{
+	mlkem_polyvec a[MLKEM768_RANK], s, e, t;
+	uint8_t rank = MLKEM768_RANK;
+	uint8_t seeds[2 * MLKEM_SYMBYTES];
+	const uint8_t *rho = seeds, *sigma = seeds + MLKEM_SYMBYTES;
+	uint8_t nonce = 0;
+	int i;
+
+	mlkem_hash_g(seeds, d, MLKEM_SYMBYTES, &rank, 1);
+	mlkem_matrix_expand(a, rho, 0);
+
+	for (i = 0; i < MLKEM768_RANK; i++)
+		mlkem_poly_sample_cbd(&s.p[i], sigma, nonce++);
+	for (i = 0; i < MLKEM768_RANK; i++)
+		mlkem_poly_sample_cbd(&e.p[i], sigma, nonce++);
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		mlkem_poly_ntt(&s.p[i]);
+		mlkem_poly_ntt(&e.p[i]);
+	}
+
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		mlkem_polyvec_inner_product(&t.p[i], &a[i], &s);
+		mlkem_poly_tomont(&t.p[i]);
+		mlkem_poly_add(&t.p[i], &t.p[i], &e.p[i]);
+		mlkem_poly_reduce(&t.p[i]);
+	}
+
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		mlkem_poly_to_bytes(&ek[i * MLKEM_POLY_BYTES], &t.p[i]);
+		mlkem_poly_to_bytes(&dk_pke[i * MLKEM_POLY_BYTES], &s.p[i]);
+	}
+	memcpy(&ek[MLKEM768_POLYVEC_BYTES], rho, MLKEM_SYMBYTES);
+
+	explicit_bzero(seeds, sizeof(seeds));
+	explicit_bzero(&s, sizeof(s));
+	explicit_bzero(&e, sizeof(e));
+}
+
+/* K-PKE.Encrypt, with t already decoded from ek. */
+static void
+mlkem768_pke_encrypt(uint8_t c[MLKEM768_CIPHERTEXT_BYTES],
+    const mlkem_polyvec *t, const uint8_t rho[MLKEM_SYMBYTES],
+    const uint8_t m[MLKEM_SYMBYTES], const uint8_t r[MLKEM_SYMBYTES])
+{
+	mlkem_polyvec at[MLKEM768_RANK], y, e1, u;
+	mlkem_poly e2, mu, v;
+	uint8_t nonce = 0;
+	int i;
+
+	mlkem_matrix_expand(at, rho, 1);
+
+	for (i = 0; i < MLKEM768_RANK; i++)
+		mlkem_poly_sample_cbd(&y.p[i], r, nonce++);
+	for (i = 0; i < MLKEM768_RANK; i++)
+		mlkem_poly_sample_cbd(&e1.p[i], r, nonce++);
+	mlkem_poly_sample_cbd(&e2, r, nonce++);
+
+	for (i = 0; i < MLKEM768_RANK; i++)
+		mlkem_poly_ntt(&y.p[i]);
+
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		mlkem_polyvec_inner_product(&u.p[i], &at[i], &y);
+		mlkem_poly_invntt_tomont(&u.p[i]);
+		mlkem_poly_add(&u.p[i], &u.p[i], &e1.p[i]);
+		mlkem_poly_reduce(&u.p[i]);
+	}
+
+	mlkem_poly_from_msg(&mu, m);
+	mlkem_polyvec_inner_product(&v, t, &y);
+	mlkem_poly_invntt_tomont(&v);
+	mlkem_poly_add(&v, &v, &e2);
+	mlkem_poly_add(&v, &v, &mu);
+	mlkem_poly_reduce(&v);
+
+	for (i = 0; i < MLKEM768_RANK; i++)
+		mlkem_poly_compress_du(
+		    &c[i * MLKEM768_U_BYTES / MLKEM768_RANK], &u.p[i]);
+	mlkem_poly_compress_dv(&c[MLKEM768_U_BYTES], &v);
+
+	explicit_bzero(&y, sizeof(y));
+	explicit_bzero(&e1, sizeof(e1));
+	explicit_bzero(&e2, sizeof(e2));
+	explicit_bzero(&mu, sizeof(mu));
+	explicit_bzero(&v, sizeof(v));
+}
+
+/* K-PKE.Decrypt */
+static void
+mlkem768_pke_decrypt(uint8_t m[MLKEM_SYMBYTES],
+    const uint8_t dk_pke[MLKEM768_POLYVEC_BYTES],
+    const uint8_t c[MLKEM768_CIPHERTEXT_BYTES])
+{
+	mlkem_polyvec s, u;
+	mlkem_poly v, w;
+	int i;
+
+	for (i = 0; i < MLKEM768_RANK; i++) {
+		mlkem_poly_decompress_du(&u.p[i],
+		    &c[i * MLKEM768_U_BYTES / MLKEM768_RANK]);
+		mlkem_poly_ntt(&u.p[i]);
+		/* Secret coefficients were encoded reduced by us. */
+		(void)mlkem_poly_from_bytes(&s.p[i],
+		    &dk_pke[i * MLKEM_POLY_BYTES]);
+	}
+	mlkem_poly_decompress_dv(&v, &c[MLKEM768_U_BYTES]);
+
+	mlkem_polyvec_inner_product(&w, &s, &u);
+	mlkem_poly_invntt_tomont(&w);
+	mlkem_poly_sub(&w, &v, &w);
+	mlkem_poly_reduce(&w);
+	mlkem_poly_to_msg(m, &w);
+
+	explicit_bzero(&s, sizeof(s));
+	explicit_bzero(&w, sizeof(w));
+}
+
+int
+mlkem768_generate_key_external_entropy(
+    uint8_t out_public_key[MLKEM768_PUBLIC_KEY_BYTES],
+    uint8_t out_private_key[MLKEM768_PRIVATE_KEY_BYTES],
+    const uint8_t seed[MLKEM_SEED_BYTES])
+{
+	uint8_t *dk = out_private_key;
+
+	mlkem768_pke_keygen(out_public_key, &dk[MLKEM768_DK_PKE_OFFSET], seed);
+	memcpy(&dk[MLKEM768_DK_EK_OFFSET], out_public_key,
+	    MLKEM768_PUBLIC_KEY_BYTES);
+	mlkem_hash_h(&dk[MLKEM768_DK_H_OFFSET], out_public_key,
+	    MLKEM768_PUBLIC_KEY_BYTES);
+	memcpy(&dk[MLKEM768_DK_Z_OFFSET], &seed[MLKEM_SYMBYTES],
+	    MLKEM_SYMBYTES);
+
+	return 1;
+}
+
+int
+MLKEM768_generate_key(uint8_t out_public_key[MLKEM768_PUBLIC_KEY_BYTES],
+    uint8_t out_private_key[MLKEM768_PRIVATE_KEY_BYTES])
+{
+	uint8_t seed[MLKEM_SEED_BYTES];
+	int ret;
+
+	arc4random_buf(seed, sizeof(seed));
+	ret = mlkem768_generate_key_external_entropy(out_public_key,
+	    out_private_key, seed);
+	explicit_bzero(seed, sizeof(seed));
+
+	return ret;
+}
+LCRYPTO_ALIAS(MLKEM768_generate_key);
+
+int
+MLKEM768_check_public_key(const uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES])
+{
+	mlkem_polyvec t;
+
+	return mlkem768_parse_public_key(&t, public_key);
+}
+LCRYPTO_ALIAS(MLKEM768_check_public_key);
+
+int
+mlkem768_encap_external_entropy(
+    uint8_t out_ciphertext[MLKEM768_CIPHERTEXT_BYTES],
+    uint8_t out_shared_secret[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES],
+    const uint8_t entropy[MLKEM_ENTROPY_BYTES])
+{
+	uint8_t h[MLKEM_SYMBYTES], kr[2 * MLKEM_SYMBYTES];
+	mlkem_polyvec t;
+
+	if (!mlkem768_parse_public_key(&t, public_key))
+		return 0;
+
+	mlkem_hash_h(h, public_key, MLKEM768_PUBLIC_KEY_BYTES);
+	mlkem_hash_g(kr, entropy, MLKEM_SYMBYTES, h, sizeof(h));
+	mlkem768_pke_encrypt(out_ciphertext, &t,
+	    &public_key[MLKEM768_POLYVEC_BYTES], entropy, &kr[MLKEM_SYMBYTES]);
+	memcpy(out_shared_secret, kr, MLKEM_SHARED_SECRET_BYTES);
+
+	explicit_bzero(kr, sizeof(kr));
+
+	return 1;
+}
+
+int
+MLKEM768_encap(uint8_t out_ciphertext[MLKEM768_CIPHERTEXT_BYTES],
+    uint8_t out_shared_secret[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES])
+{
+	uint8_t entropy[MLKEM_ENTROPY_BYTES];
+	int ret;
+
+	arc4random_buf(entropy, sizeof(entropy));
+	ret = mlkem768_encap_external_entropy(out_ciphertext,
+	    out_shared_secret, public_key, entropy);
+	explicit_bzero(entropy, sizeof(entropy));
+
+	return ret;
+}
+LCRYPTO_ALIAS(MLKEM768_encap);
+
+int
+MLKEM768_decap(uint8_t out_shared_secret[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t *ciphertext, size_t ciphertext_len,
+    const uint8_t private_key[MLKEM768_PRIVATE_KEY_BYTES])
+{
+	const uint8_t *ek = &private_key[MLKEM768_DK_EK_OFFSET];
+	uint8_t m[MLKEM_SYMBYTES], kr[2 * MLKEM_SYMBYTES];
+	uint8_t reject[MLKEM_SHARED_SECRET_BYTES];
+	uint8_t cmp[MLKEM768_CIPHERTEXT_BYTES];
+	uint8_t diff = 0, mask;
+	mlkem_polyvec t;
+	size_t i;
+
+	if (ciphertext_len != MLKEM768_CIPHERTEXT_BYTES) {
+		arc4random_buf(out_shared_secret, MLKEM_SHARED_SECRET_BYTES);
+		return 0;
+	}
+
+	mlkem768_pke_decrypt(m, &private_key[MLKEM768_DK_PKE_OFFSET],
+	    ciphertext);
+	mlkem_hash_g(kr, m, sizeof(m), &private_key[MLKEM768_DK_H_OFFSET],
+	    MLKEM_SYMBYTES);
+	mlkem_hash_j(reject, &private_key[MLKEM768_DK_Z_OFFSET], ciphertext,
+	    ciphertext_len);
+
+	/* Our own encapsulation key, so the modulus check cannot fail. */
+	(void)mlkem768_parse_public_key(&t, ek);
+	mlkem768_pke_encrypt(cmp, &t, &ek[MLKEM768_POLYVEC_BYTES], m,
+	    &kr[MLKEM_SYMBYTES]);
+
+	for (i = 0; i < sizeof(cmp); i++)
+		diff |= cmp[i] ^ ciphertext[i];
+	mask = crypto_ct_ne_zero_mask_u8(diff);
+
+	for (i = 0; i < MLKEM_SHARED_SECRET_BYTES; i++)
+		out_shared_secret[i] = kr[i] ^ (mask & (kr[i] ^ reject[i]));
+
+	explicit_bzero(m, sizeof(m));
+	explicit_bzero(kr, sizeof(kr));
+	explicit_bzero(reject, sizeof(reject));
+	explicit_bzero(cmp, sizeof(cmp));
+
+	return 1;
+}
+LCRYPTO_ALIAS(MLKEM768_decap);
@@ -0,0 +1,46 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "crypto_arch.h"
+#include "mlkem_internal.h"
+
+void mlkem_ntt_avx2(int16_t r[MLKEM_N]);
+void mlkem_invntt_avx2(int16_t r[MLKEM_N]);
+
+void
+mlkem_ntt(int16_t r[MLKEM_N])
+{
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0) {
+		mlkem_ntt_avx2(r);
+		return;
+	}
+
+	mlkem_ntt_generic(r);
+}
+
+void
+mlkem_invntt(int16_t r[MLKEM_N])
+{
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0) {
+		mlkem_invntt_avx2(r);
+		return;
+	}
+
+	mlkem_invntt_generic(r);
+}
@@ -0,0 +1,57 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef HEADER_MLKEM_INTERNAL_H
+#define HEADER_MLKEM_INTERNAL_H
+
+#include <stdint.h>
+
+#include <openssl/mlkem.h>
+
+__BEGIN_HIDDEN_DECLS
+
+#define MLKEM_N			256
+#define MLKEM_ENTROPY_BYTES	32
+
+/*
+ * Forward and inverse NTT of a polynomial with MLKEM_N coefficients. The
+ * forward transform leaves the coefficients Barrett reduced and the inverse
+ * transform multiplies them by the Montgomery factor 2^16.
+ */
+void mlkem_ntt(int16_t r[MLKEM_N]);
+void mlkem_ntt_generic(int16_t r[MLKEM_N]);
+void mlkem_invntt(int16_t r[MLKEM_N]);
+void mlkem_invntt_generic(int16_t r[MLKEM_N]);
+
+/*
+ * Deterministic variants of key generation and encapsulation, taking the
+ * randomness (d || z and m respectively) from the caller. These exist for
+ * known answer tests and must not be used with predictable input.
+ */
+int mlkem768_generate_key_external_entropy(
+    uint8_t out_public_key[MLKEM768_PUBLIC_KEY_BYTES],
+    uint8_t out_private_key[MLKEM768_PRIVATE_KEY_BYTES],
+    const uint8_t seed[MLKEM_SEED_BYTES]);
+int mlkem768_encap_external_entropy(
+    uint8_t out_ciphertext[MLKEM768_CIPHERTEXT_BYTES],
+    uint8_t out_shared_secret[MLKEM_SHARED_SECRET_BYTES],
+    const uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES],
+    const uint8_t entropy[MLKEM_ENTROPY_BYTES]);
+
+__END_HIDDEN_DECLS
+
+#endif /* HEADER_MLKEM_INTERNAL_H */
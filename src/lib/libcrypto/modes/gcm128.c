@@ -644,19 +644,13 @@ void gcm_ghash_neon(u64 Xi[2], const u128 Htable[16], const u8 *inp,
 # endif
 #endif
 
-void
-CRYPTO_gcm128_init(GCM128_CONTEXT *ctx, void *key, block128_f block)
+/*
+ * Initialise the multiplication table and functions for the hash key H,
+ * which is stored in host byte order.
+ */
+static void
+gcm128_init_htable(GCM128_CONTEXT *ctx)
 {
-	memset(ctx, 0, sizeof(*ctx));
-	ctx->block = block;
-	ctx->key = key;
-
-	(*block)(ctx->H.c, ctx->H.c, key);
-
-	/* H is stored in host byte order */
-	ctx->H.u[0] = be64toh(ctx->H.u[0]);
-	ctx->H.u[1] = be64toh(ctx->H.u[1]);
-
 #if	TABLE_BITS==8
 	gcm_init_8bit(ctx->Htable, ctx->H.u);
 #elif	TABLE_BITS==4
@@ -702,6 +696,22 @@ CRYPTO_gcm128_init(GCM128_CONTEXT *ctx, void *key, block128_f block)
 # endif
 #endif
 }
+
+void
+CRYPTO_gcm128_init(GCM128_CONTEXT *ctx, void *key, block128_f block)
+{
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->block = block;
+	ctx->key = key;
+
+	(*block)(ctx->H.c, ctx->H.c, key);
+
+	/* H is stored in host byte order */
+	ctx->H.u[0] = be64toh(ctx->H.u[0]);
+	ctx->H.u[1] = be64toh(ctx->H.u[1]);
+
+	gcm128_init_htable(ctx);
+}
 LCRYPTO_ALIAS(CRYPTO_gcm128_init);
 
 void
@@ -1356,3 +1366,96 @@ CRYPTO_gcm128_release(GCM128_CONTEXT *ctx)
 	freezero(ctx, sizeof(*ctx));
 }
 LCRYPTO_ALIAS(CRYPTO_gcm128_release);
+
+/*
+ * POLYVAL (RFC 8452) is computed using GHASH, by byte reversing each input
+ * block and the result, with the hash key being byte reversed and multiplied
+ * by x (see RFC 8452, appendix A).
+ */
+#define POLYVAL_CHUNK	(16 * 16)
+
+static void
+polyval_reverse(u8 *dst, const u8 *src)
+{
+	u64 hi, lo;
+
+	hi = crypto_load_le64toh(&src[8]);
+	lo = crypto_load_le64toh(&src[0]);
+	crypto_store_htobe64(&dst[0], hi);
+	crypto_store_htobe64(&dst[8], lo);
+}
+
+void
+gcm128_polyval_init(GCM128_CONTEXT *ctx, const unsigned char key[16])
+{
+	u64 hi, lo, carry;
+
+	memset(ctx, 0, sizeof(*ctx));
+
+	hi = crypto_load_le64toh(&key[8]);
+	lo = crypto_load_le64toh(&key[0]);
+
+	carry = lo & 1;
+	lo = lo >> 1 | hi << 63;
+	hi = hi >> 1 ^ (U64(0xe100000000000000) & (0 - carry));
+
+	/* H is stored in host byte order */
+	ctx->H.u[0] = hi;
+	ctx->H.u[1] = lo;
+
+	gcm128_init_htable(ctx);
+}
+
+/*
+ * Hash the input, with a final partial block being padded with zeros.
+ */
+void
+gcm128_polyval_update(GCM128_CONTEXT *ctx, const unsigned char *in,
+    size_t len)
+{
+	u8 buf[POLYVAL_CHUNK], block[16];
+	size_t i, n;
+#ifndef GHASH
+	size_t j, k;
+#endif
+#ifdef GCM_FUNCREF_4BIT
+# ifdef GHASH
+	void (*gcm_ghash_p)(u64 Xi[2], const u128 Htable[16],
+	    const u8 *inp, size_t len) = ctx->ghash;
+# else
+	void (*gcm_gmult_p)(u64 Xi[2], const u128 Htable[16]) = ctx->gmult;
+# endif
+#endif
+
+	while (len > 0) {
+		n = len < sizeof(buf) ? len : sizeof(buf);
+		for (i = 0; i + 16 <= n; i += 16)
+			polyval_reverse(&buf[i], &in[i]);
+		if (i < n) {
+			memset(block, 0, sizeof(block));
+			memcpy(block, &in[i], n - i);
+			polyval_reverse(&buf[i], block);
+			i += 16;
+		}
+#ifdef GHASH
+		GHASH(ctx, buf, i);
+#else
+		for (j = 0; j < i; j += 16) {
+			for (k = 0; k < 16; k++)
+				ctx->Xi.c[k] ^= buf[j + k];
+			GCM_MUL(ctx, Xi);
+		}
+#endif
+		in += n;
+		len -= n;
+	}
+
+	explicit_bzero(buf, sizeof(buf));
+	explicit_bzero(block, sizeof(block));
+}
+
+void
+gcm128_polyval_final(GCM128_CONTEXT *ctx, unsigned char out[16])
+{
+	polyval_reverse(out, ctx->Xi.c);
+}
@@ -118,4 +118,9 @@ struct ccm128_context {
 	void *key;
 };
 
+void gcm128_polyval_init(GCM128_CONTEXT *ctx, const unsigned char key[16]);
+void gcm128_polyval_update(GCM128_CONTEXT *ctx, const unsigned char *in,
+    size_t len);
+void gcm128_polyval_final(GCM128_CONTEXT *ctx, unsigned char out[16]);
+
 __END_HIDDEN_DECLS
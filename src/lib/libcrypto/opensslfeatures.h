@@ -105,7 +105,7 @@
 /* #define OPENSSL_NO_RFC3779 */
 /* #define OPENSSL_NO_RMD160 */
 /* #define OPENSSL_NO_RSA */
-#define OPENSSL_NO_SCRYPT
+/* #define OPENSSL_NO_SCRYPT */
 #define OPENSSL_NO_SCTP
 /* #define OPENSSL_NO_SECURE_MEMORY */
 #define OPENSSL_NO_SEED
@@ -108,6 +108,7 @@ typedef struct evp_pkey_ctx_st EVP_PKEY_CTX;
 typedef struct evp_Encode_Ctx_st EVP_ENCODE_CTX;
 
 typedef struct hmac_ctx_st HMAC_CTX;
+typedef struct hmac_key_st HMAC_KEY;
 
 typedef struct dh_st DH;
 typedef struct dh_method DH_METHOD;
@@ -118,6 +118,7 @@
 #include <openssl/err.h>
 #include <openssl/rsa.h>
 
+#include "bn_fixed.h"
 #include "bn_local.h"
 #include "rsa_local.h"
 
@@ -148,7 +149,7 @@ rsa_public_encrypt(int flen, const unsigned char *from, unsigned char *to,
 		}
 	}
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -318,7 +319,7 @@ rsa_private_encrypt(int flen, const unsigned char *from, unsigned char *to,
 	BIGNUM *unblind = NULL;
 	BN_BLINDING *blinding = NULL;
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -447,7 +448,7 @@ rsa_private_decrypt(int flen, const unsigned char *from, unsigned char *to,
 	BIGNUM *unblind = NULL;
 	BN_BLINDING *blinding = NULL;
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -582,7 +583,7 @@ rsa_public_decrypt(int flen, const unsigned char *from, unsigned char *to,
 		}
 	}
 
-	if ((ctx = BN_CTX_new()) == NULL)
+	if ((ctx = bn_ctx_get_thread()) == NULL)
 		goto err;
 
 	BN_CTX_start(ctx);
@@ -654,6 +655,25 @@ err:
 	return r;
 }
 
+/*
+ * Exponentiation modulo one of the primes. If the default exponentiation is
+ * in use, the cached Montgomery context allows the fixed width code to be
+ * used, which avoids BIGNUM normalisation and BN_CTX use in the hot path.
+ * Where the mont5 assembly is available BN_mod_exp_mont_ct() is faster.
+ */
+static int
+rsa_crt_mod_exp(RSA *rsa, BIGNUM *r, const BIGNUM *a, const BIGNUM *p,
+    const BIGNUM *m, BN_CTX *ctx, BN_MONT_CTX *m_ctx)
+{
+#ifndef OPENSSL_BN_ASM_MONT5
+	if (rsa->meth->bn_mod_exp == BN_mod_exp_mont_ct &&
+	    bn_fixed_mont_supported(m_ctx, a))
+		return bn_fixed_mod_exp_mont(r, a, p, m_ctx);
+#endif
+
+	return rsa->meth->bn_mod_exp(r, a, p, m, ctx, m_ctx);
+}
+
 static int
 rsa_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 {
@@ -709,7 +729,7 @@ rsa_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 	BN_init(&dmq1);
 	BN_with_flags(&dmq1, rsa->dmq1, BN_FLG_CONSTTIME);
 
-	if (!rsa->meth->bn_mod_exp(m1, r1, &dmq1, rsa->q, ctx,
+	if (!rsa_crt_mod_exp(rsa, m1, r1, &dmq1, rsa->q, ctx,
 	    rsa->_method_mod_q))
 		goto err;
 
@@ -724,7 +744,7 @@ rsa_mod_exp(BIGNUM *r0, const BIGNUM *I, RSA *rsa, BN_CTX *ctx)
 	BN_init(&dmp1);
 	BN_with_flags(&dmp1, rsa->dmp1, BN_FLG_CONSTTIME);
 
-	if (!rsa->meth->bn_mod_exp(r0, r1, &dmp1, rsa->p, ctx,
+	if (!rsa_crt_mod_exp(rsa, r0, r1, &dmp1, rsa->p, ctx,
 	    rsa->_method_mod_p))
 		goto err;
 
@@ -105,6 +105,8 @@ unsigned char *SHA1(const unsigned char *d, size_t n, unsigned char *md)
     __attribute__ ((__bounded__(__buffer__, 1, 2)))
     __attribute__ ((__nonnull__(3)));
 void SHA1_Transform(SHA_CTX *c, const unsigned char *data);
+void SHA1_multi_hash(const unsigned char *const in[], const size_t in_len[],
+    unsigned char *const md[], size_t n);
 #endif
 
 #define SHA256_CBLOCK	(SHA_LBLOCK*4)	/* SHA-256 treats input data as a
@@ -136,6 +138,8 @@ unsigned char *SHA256(const unsigned char *d, size_t n, unsigned char *md)
     __attribute__ ((__bounded__(__buffer__, 1, 2)))
     __attribute__ ((__nonnull__(3)));
 void SHA256_Transform(SHA256_CTX *c, const unsigned char *data);
+void SHA256_multi_hash(const unsigned char *const in[], const size_t in_len[],
+    unsigned char *const md[], size_t n);
 #endif
 
 #define SHA384_DIGEST_LENGTH	48
@@ -56,6 +56,7 @@
  * [including the GNU Public Licence.]
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -65,6 +66,7 @@
 #include <openssl/sha.h>
 
 #include "crypto_internal.h"
+#include "sha_internal.h"
 
 #if !defined(OPENSSL_NO_SHA1) && !defined(OPENSSL_NO_SHA)
 
@@ -382,6 +384,17 @@ sha1_block_data_order(SHA_CTX *ctx, const void *_in, size_t num)
 }
 #endif
 
+#ifndef HAVE_SHA1_BLOCK_MULTI
+void
+sha1_block_multi(SHA_CTX *ctx[], const void *in[], size_t n, size_t num)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		sha1_block_data_order(ctx[i], in[i], num);
+}
+#endif
+
 int
 SHA1_Init(SHA_CTX *c)
 {
@@ -508,4 +521,106 @@ SHA1(const unsigned char *d, size_t n, unsigned char *md)
 }
 LCRYPTO_ALIAS(SHA1);
 
+#define SHA1_MULTI_LANES	16
+
+static void
+sha1_multi_hash_lanes(const unsigned char *const in[],
+    const size_t in_len[], unsigned char *const md[], size_t n)
+{
+	SHA_CTX ctx[SHA1_MULTI_LANES], *lane_ctx[SHA1_MULTI_LANES];
+	uint8_t tail[SHA1_MULTI_LANES][2 * SHA_CBLOCK];
+	const void *lane_in[SHA1_MULTI_LANES];
+	const uint8_t *p[SHA1_MULTI_LANES];
+	size_t blocks[SHA1_MULTI_LANES], tail_blocks[SHA1_MULTI_LANES];
+	size_t i, lanes, num, rem;
+
+	/*
+	 * Hash the full blocks of each message directly from the input,
+	 * followed by one or two padded blocks built from the remainder.
+	 */
+	for (i = 0; i < n; i++) {
+		SHA1_Init(&ctx[i]);
+
+		p[i] = in[i];
+		blocks[i] = in_len[i] / SHA_CBLOCK;
+		rem = in_len[i] % SHA_CBLOCK;
+
+		memset(tail[i], 0, sizeof(tail[i]));
+		if (rem > 0)
+			memcpy(tail[i], &p[i][blocks[i] * SHA_CBLOCK], rem);
+		tail[i][rem] = 0x80;
+		tail_blocks[i] = 1;
+		if (rem > SHA_CBLOCK - 9)
+			tail_blocks[i] = 2;
+		crypto_store_htobe64(&tail[i][tail_blocks[i] * SHA_CBLOCK - 8],
+		    (uint64_t)in_len[i] << 3);
+	}
+
+	/*
+	 * Process all messages that still have blocks remaining in lockstep,
+	 * advancing by the smallest number of blocks left in any of them.
+	 */
+	for (;;) {
+		lanes = 0;
+		num = SIZE_MAX;
+
+		for (i = 0; i < n; i++) {
+			if (blocks[i] == 0 && tail_blocks[i] != 0) {
+				p[i] = tail[i];
+				blocks[i] = tail_blocks[i];
+				tail_blocks[i] = 0;
+			}
+			if (blocks[i] == 0)
+				continue;
+			if (blocks[i] < num)
+				num = blocks[i];
+			lane_ctx[lanes] = &ctx[i];
+			lane_in[lanes] = p[i];
+			lanes++;
+		}
+		if (lanes == 0)
+			break;
+
+		sha1_block_multi(lane_ctx, lane_in, lanes, num);
+
+		for (i = 0; i < n; i++) {
+			if (blocks[i] == 0)
+				continue;
+			p[i] += num * SHA_CBLOCK;
+			blocks[i] -= num;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		crypto_store_htobe32(&md[i][0 * 4], ctx[i].h0);
+		crypto_store_htobe32(&md[i][1 * 4], ctx[i].h1);
+		crypto_store_htobe32(&md[i][2 * 4], ctx[i].h2);
+		crypto_store_htobe32(&md[i][3 * 4], ctx[i].h3);
+		crypto_store_htobe32(&md[i][4 * 4], ctx[i].h4);
+	}
+
+	explicit_bzero(ctx, sizeof(ctx));
+	explicit_bzero(tail, sizeof(tail));
+}
+
+void
+SHA1_multi_hash(const unsigned char *const in[], const size_t in_len[],
+    unsigned char *const md[], size_t n)
+{
+	size_t lanes;
+
+	while (n > 0) {
+		if ((lanes = n) > SHA1_MULTI_LANES)
+			lanes = SHA1_MULTI_LANES;
+
+		sha1_multi_hash_lanes(in, in_len, md, lanes);
+
+		in += lanes;
+		in_len += lanes;
+		md += lanes;
+		n -= lanes;
+	}
+}
+LCRYPTO_ALIAS(SHA1_multi_hash);
+
 #endif
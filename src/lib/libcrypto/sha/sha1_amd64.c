@@ -15,14 +15,87 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <string.h>
+
 #include <openssl/sha.h>
 
 #include "crypto_arch.h"
+#include "sha_internal.h"
 
+void sha1_block_avx2(SHA_CTX *ctx, const void *in, size_t num);
 void sha1_block_generic(SHA_CTX *ctx, const void *in, size_t num);
+void sha1_block_multi_avx2(SHA_CTX *ctx[8], const void *in[8], size_t num);
+void sha1_block_multi_avx512(SHA_CTX *ctx[16], const void *in[16],
+    size_t num);
+void sha1_block_shani(SHA_CTX *ctx, const void *in, size_t num);
 
 void
 sha1_block_data_order(SHA_CTX *ctx, const void *in, size_t num)
 {
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_SHA) != 0) {
+		sha1_block_shani(ctx, in, num);
+		return;
+	}
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0) {
+		sha1_block_avx2(ctx, in, num);
+		return;
+	}
+
 	sha1_block_generic(ctx, in, num);
 }
+
+/*
+ * Process fewer than lanes inputs with a multi-lane block function, filling
+ * the unused lanes with a dummy context and the first input.
+ */
+static void
+sha1_block_multi_partial(void (*block_multi)(SHA_CTX *[], const void *[],
+    size_t), size_t lanes, SHA_CTX *ctx[], const void *in[], size_t n,
+    size_t num)
+{
+	SHA_CTX dummy, *lane_ctx[16];
+	const void *lane_in[16];
+	size_t i;
+
+	memset(&dummy, 0, sizeof(dummy));
+
+	for (i = 0; i < lanes; i++) {
+		lane_ctx[i] = &dummy;
+		lane_in[i] = in[0];
+		if (i < n) {
+			lane_ctx[i] = ctx[i];
+			lane_in[i] = in[i];
+		}
+	}
+
+	block_multi(lane_ctx, lane_in, num);
+}
+
+void
+sha1_block_multi(SHA_CTX *ctx[], const void *in[], size_t n, size_t num)
+{
+	size_t i;
+
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX512) != 0) {
+		for (; n >= 16; n -= 16, ctx += 16, in += 16)
+			sha1_block_multi_avx512(ctx, in, num);
+		if (n > 8) {
+			sha1_block_multi_partial(sha1_block_multi_avx512, 16,
+			    ctx, in, n, num);
+			return;
+		}
+	}
+
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0) {
+		for (; n >= 8; n -= 8, ctx += 8, in += 8)
+			sha1_block_multi_avx2(ctx, in, num);
+		if (n > 4) {
+			sha1_block_multi_partial(sha1_block_multi_avx2, 8,
+			    ctx, in, n, num);
+			return;
+		}
+	}
+
+	for (i = 0; i < n; i++)
+		sha1_block_data_order(ctx[i], in[i], num);
+}
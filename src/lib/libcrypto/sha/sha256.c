@@ -53,6 +53,7 @@
  */
 
 #include <endian.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -62,6 +63,7 @@
 #include <openssl/sha.h>
 
 #include "crypto_internal.h"
+#include "sha_internal.h"
 
 #if !defined(OPENSSL_NO_SHA) && !defined(OPENSSL_NO_SHA256)
 
@@ -279,6 +281,17 @@ sha256_block_data_order(SHA256_CTX *ctx, const void *_in, size_t num)
 }
 #endif /* SHA256_ASM */
 
+#ifndef HAVE_SHA256_BLOCK_MULTI
+void
+sha256_block_multi(SHA256_CTX *ctx[], const void *in[], size_t n, size_t num)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		sha256_block_data_order(ctx[i], in[i], num);
+}
+#endif
+
 int
 SHA224_Init(SHA256_CTX *c)
 {
@@ -486,4 +499,103 @@ SHA256(const unsigned char *d, size_t n, unsigned char *md)
 }
 LCRYPTO_ALIAS(SHA256);
 
+#define SHA256_MULTI_LANES	16
+
+static void
+sha256_multi_hash_lanes(const unsigned char *const in[],
+    const size_t in_len[], unsigned char *const md[], size_t n)
+{
+	SHA256_CTX ctx[SHA256_MULTI_LANES], *lane_ctx[SHA256_MULTI_LANES];
+	uint8_t tail[SHA256_MULTI_LANES][2 * SHA256_CBLOCK];
+	const void *lane_in[SHA256_MULTI_LANES];
+	const uint8_t *p[SHA256_MULTI_LANES];
+	size_t blocks[SHA256_MULTI_LANES], tail_blocks[SHA256_MULTI_LANES];
+	size_t i, j, lanes, num, rem;
+
+	/*
+	 * Hash the full blocks of each message directly from the input,
+	 * followed by one or two padded blocks built from the remainder.
+	 */
+	for (i = 0; i < n; i++) {
+		SHA256_Init(&ctx[i]);
+
+		p[i] = in[i];
+		blocks[i] = in_len[i] / SHA256_CBLOCK;
+		rem = in_len[i] % SHA256_CBLOCK;
+
+		memset(tail[i], 0, sizeof(tail[i]));
+		if (rem > 0)
+			memcpy(tail[i], &p[i][blocks[i] * SHA256_CBLOCK], rem);
+		tail[i][rem] = 0x80;
+		tail_blocks[i] = 1;
+		if (rem > SHA256_CBLOCK - 9)
+			tail_blocks[i] = 2;
+		crypto_store_htobe64(&tail[i][tail_blocks[i] * SHA256_CBLOCK - 8],
+		    (uint64_t)in_len[i] << 3);
+	}
+
+	/*
+	 * Process all messages that still have blocks remaining in lockstep,
+	 * advancing by the smallest number of blocks left in any of them.
+	 */
+	for (;;) {
+		lanes = 0;
+		num = SIZE_MAX;
+
+		for (i = 0; i < n; i++) {
+			if (blocks[i] == 0 && tail_blocks[i] != 0) {
+				p[i] = tail[i];
+				blocks[i] = tail_blocks[i];
+				tail_blocks[i] = 0;
+			}
+			if (blocks[i] == 0)
+				continue;
+			if (blocks[i] < num)
+				num = blocks[i];
+			lane_ctx[lanes] = &ctx[i];
+			lane_in[lanes] = p[i];
+			lanes++;
+		}
+		if (lanes == 0)
+			break;
+
+		sha256_block_multi(lane_ctx, lane_in, lanes, num);
+
+		for (i = 0; i < n; i++) {
+			if (blocks[i] == 0)
+				continue;
+			p[i] += num * SHA256_CBLOCK;
+			blocks[i] -= num;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < SHA256_DIGEST_LENGTH / 4; j++)
+			crypto_store_htobe32(&md[i][j * 4], ctx[i].h[j]);
+	}
+
+	explicit_bzero(ctx, sizeof(ctx));
+	explicit_bzero(tail, sizeof(tail));
+}
+
+void
+SHA256_multi_hash(const unsigned char *const in[], const size_t in_len[],
+    unsigned char *const md[], size_t n)
+{
+	size_t lanes;
+
+	while (n > 0) {
+		if ((lanes = n) > SHA256_MULTI_LANES)
+			lanes = SHA256_MULTI_LANES;
+
+		sha256_multi_hash_lanes(in, in_len, md, lanes);
+
+		in += lanes;
+		in_len += lanes;
+		md += lanes;
+		n -= lanes;
+	}
+}
+LCRYPTO_ALIAS(SHA256_multi_hash);
+
 #endif /* OPENSSL_NO_SHA256 */
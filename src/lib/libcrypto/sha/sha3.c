@@ -26,6 +26,7 @@
 #include <endian.h>
 #include <string.h>
 
+#include "crypto_arch.h"
 #include "sha3_internal.h"
 
 #define KECCAKF_ROUNDS 24
@@ -42,60 +43,169 @@ static const uint64_t sha3_keccakf_rndc[24] = {
 	0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
 	0x8000000000008080, 0x0000000080000001, 0x8000000080008008
 };
-static const int sha3_keccakf_rotc[24] = {
-	1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
-	27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44
-};
-static const int sha3_keccakf_piln[24] = {
-	10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
-	15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1
-};
+/*
+ * A single round of Keccak-f[1600], from state A to state E. This uses the
+ * lane complementing transform, where the be, bi, go, ki, mi and sa lanes
+ * are stored complemented, which reduces the number of NOT operations
+ * required for chi from 25 to 8 per round.
+ */
+#define KECCAKF_ROUND(A, E, rc) do {					\
+	Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa;			\
+	Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se;			\
+	Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si;			\
+	Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so;			\
+	Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su;			\
+									\
+	Da = Cu ^ ROTL64(Ce, 1);					\
+	De = Ca ^ ROTL64(Ci, 1);					\
+	Di = Ce ^ ROTL64(Co, 1);					\
+	Do = Ci ^ ROTL64(Cu, 1);					\
+	Du = Co ^ ROTL64(Ca, 1);					\
+									\
+	Ba = A##ba ^ Da;						\
+	Be = ROTL64(A##ge ^ De, 44);					\
+	Bi = ROTL64(A##ki ^ Di, 43);					\
+	Bo = ROTL64(A##mo ^ Do, 21);					\
+	Bu = ROTL64(A##su ^ Du, 14);					\
+	E##ba = Ba ^ (Be | Bi) ^ (rc);					\
+	E##be = Be ^ (~Bi | Bo);					\
+	E##bi = Bi ^ (Bo & Bu);						\
+	E##bo = Bo ^ (Bu | Ba);						\
+	E##bu = Bu ^ (Ba & Be);						\
+									\
+	Ba = ROTL64(A##bo ^ Do, 28);					\
+	Be = ROTL64(A##gu ^ Du, 20);					\
+	Bi = ROTL64(A##ka ^ Da, 3);					\
+	Bo = ROTL64(A##me ^ De, 45);					\
+	Bu = ROTL64(A##si ^ Di, 61);					\
+	E##ga = Ba ^ (Be | Bi);						\
+	E##ge = Be ^ (Bi & Bo);						\
+	E##gi = Bi ^ (Bo | ~Bu);					\
+	E##go = Bo ^ (Bu | Ba);						\
+	E##gu = Bu ^ (Ba & Be);						\
+									\
+	Ba = ROTL64(A##be ^ De, 1);					\
+	Be = ROTL64(A##gi ^ Di, 6);					\
+	Bi = ROTL64(A##ko ^ Do, 25);					\
+	Bo = ROTL64(A##mu ^ Du, 8);					\
+	Bu = ROTL64(A##sa ^ Da, 18);					\
+	E##ka = Ba ^ (Be | Bi);						\
+	E##ke = Be ^ (Bi & Bo);						\
+	E##ki = Bi ^ (~Bo & Bu);					\
+	E##ko = ~Bo ^ (Bu | Ba);					\
+	E##ku = Bu ^ (Ba & Be);						\
+									\
+	Ba = ROTL64(A##bu ^ Du, 27);					\
+	Be = ROTL64(A##ga ^ Da, 36);					\
+	Bi = ROTL64(A##ke ^ De, 10);					\
+	Bo = ROTL64(A##mi ^ Di, 15);					\
+	Bu = ROTL64(A##so ^ Do, 56);					\
+	E##ma = Ba ^ (Be & Bi);						\
+	E##me = Be ^ (Bi | Bo);						\
+	E##mi = Bi ^ (~Bo | Bu);					\
+	E##mo = ~Bo ^ (Bu & Ba);					\
+	E##mu = Bu ^ (Ba | Be);						\
+									\
+	Ba = ROTL64(A##bi ^ Di, 62);					\
+	Be = ROTL64(A##go ^ Do, 55);					\
+	Bi = ROTL64(A##ku ^ Du, 39);					\
+	Bo = ROTL64(A##ma ^ Da, 41);					\
+	Bu = ROTL64(A##se ^ De, 2);					\
+	E##sa = Ba ^ (~Be & Bi);					\
+	E##se = ~Be ^ (Bi | Bo);					\
+	E##si = Bi ^ (Bo & Bu);						\
+	E##so = Bo ^ (Bu | Ba);						\
+	E##su = Bu ^ (Ba & Be);						\
+} while (0)
 
-static void
-sha3_keccakf(uint64_t st[25])
+void
+sha3_keccakf_generic(uint64_t st[25])
 {
-	uint64_t t, bc[5];
-	int i, j, r;
+	uint64_t Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu;
+	uint64_t Aka, Ake, Aki, Ako, Aku, Ama, Ame, Ami, Amo, Amu;
+	uint64_t Asa, Ase, Asi, Aso, Asu;
+	uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu;
+	uint64_t Eka, Eke, Eki, Eko, Eku, Ema, Eme, Emi, Emo, Emu;
+	uint64_t Esa, Ese, Esi, Eso, Esu;
+	uint64_t Ba, Be, Bi, Bo, Bu, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du;
+	int r;
 
-	for (i = 0; i < 25; i++)
-		st[i] = le64toh(st[i]);
+	Aba = le64toh(st[0]);
+	Abe = ~le64toh(st[1]);
+	Abi = ~le64toh(st[2]);
+	Abo = le64toh(st[3]);
+	Abu = le64toh(st[4]);
+	Aga = le64toh(st[5]);
+	Age = le64toh(st[6]);
+	Agi = le64toh(st[7]);
+	Ago = ~le64toh(st[8]);
+	Agu = le64toh(st[9]);
+	Aka = le64toh(st[10]);
+	Ake = le64toh(st[11]);
+	Aki = ~le64toh(st[12]);
+	Ako = le64toh(st[13]);
+	Aku = le64toh(st[14]);
+	Ama = le64toh(st[15]);
+	Ame = le64toh(st[16]);
+	Ami = ~le64toh(st[17]);
+	Amo = le64toh(st[18]);
+	Amu = le64toh(st[19]);
+	Asa = ~le64toh(st[20]);
+	Ase = le64toh(st[21]);
+	Asi = le64toh(st[22]);
+	Aso = le64toh(st[23]);
+	Asu = le64toh(st[24]);
 
-	for (r = 0; r < KECCAKF_ROUNDS; r++) {
-
-		/* Theta */
-		for (i = 0; i < 5; i++)
-			bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
-
-		for (i = 0; i < 5; i++) {
-			t = bc[(i + 4) % 5] ^ ROTL64(bc[(i + 1) % 5], 1);
-			for (j = 0; j < 25; j += 5)
-				st[j + i] ^= t;
-		}
+	for (r = 0; r < KECCAKF_ROUNDS; r += 2) {
+		KECCAKF_ROUND(A, E, sha3_keccakf_rndc[r]);
+		KECCAKF_ROUND(E, A, sha3_keccakf_rndc[r + 1]);
+	}
 
-		/* Rho Pi */
-		t = st[1];
-		for (i = 0; i < 24; i++) {
-			j = sha3_keccakf_piln[i];
-			bc[0] = st[j];
-			st[j] = ROTL64(t, sha3_keccakf_rotc[i]);
-			t = bc[0];
-		}
+	st[0] = htole64(Aba);
+	st[1] = htole64(~Abe);
+	st[2] = htole64(~Abi);
+	st[3] = htole64(Abo);
+	st[4] = htole64(Abu);
+	st[5] = htole64(Aga);
+	st[6] = htole64(Age);
+	st[7] = htole64(Agi);
+	st[8] = htole64(~Ago);
+	st[9] = htole64(Agu);
+	st[10] = htole64(Aka);
+	st[11] = htole64(Ake);
+	st[12] = htole64(~Aki);
+	st[13] = htole64(Ako);
+	st[14] = htole64(Aku);
+	st[15] = htole64(Ama);
+	st[16] = htole64(Ame);
+	st[17] = htole64(~Ami);
+	st[18] = htole64(Amo);
+	st[19] = htole64(Amu);
+	st[20] = htole64(~Asa);
+	st[21] = htole64(Ase);
+	st[22] = htole64(Asi);
+	st[23] = htole64(Aso);
+	st[24] = htole64(Asu);
+}
 
-		/* Chi */
-		for (j = 0; j < 25; j += 5) {
-			for (i = 0; i < 5; i++)
-				bc[i] = st[j + i];
-			for (i = 0; i < 5; i++)
-				st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
-		}
+#ifndef HAVE_SHA3_KECCAKF
+void
+sha3_keccakf(uint64_t st[25])
+{
+	sha3_keccakf_generic(st);
+}
+#endif
 
-		/* Iota */
-		st[0] ^= sha3_keccakf_rndc[r];
-	}
+#ifndef HAVE_SHA3_KECCAKF_X4
+void
+sha3_keccakf_x4(uint64_t *st[4])
+{
+	int i;
 
-	for (i = 0; i < 25; i++)
-		st[i] = htole64(st[i]);
+	for (i = 0; i < 4; i++)
+		sha3_keccakf(st[i]);
 }
+#endif
 
 int
 sha3_init(sha3_ctx *c, int mdlen)
@@ -170,3 +280,59 @@ shake_out(sha3_ctx *c, void *out, size_t len)
 	}
 	c->pt = j;
 }
+
+/*
+ * Finish absorbing input into four SHAKE contexts, permuting them in parallel.
+ */
+void
+shake_xof_x4(sha3_ctx *c[4])
+{
+	uint64_t *st[4];
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		c[i]->state.b[c[i]->pt] ^= 0x1F;
+		c[i]->state.b[c[i]->rsize - 1] ^= 0x80;
+		c[i]->pt = 0;
+		st[i] = c[i]->state.q;
+	}
+	sha3_keccakf_x4(st);
+}
+
+/*
+ * Squeeze len bytes of output from each of four SHAKE contexts in parallel.
+ * All contexts must use the same rate and have produced the same amount of
+ * output so far.
+ */
+void
+shake_out_x4(sha3_ctx *c[4], uint8_t *out[4], size_t len)
+{
+	uint64_t *st[4];
+	uint8_t *outp[4];
+	size_t j, n;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		st[i] = c[i]->state.q;
+		outp[i] = out[i];
+	}
+
+	j = c[0]->pt;
+	while (len > 0) {
+		if (j >= c[0]->rsize) {
+			sha3_keccakf_x4(st);
+			j = 0;
+		}
+		if ((n = c[0]->rsize - j) > len)
+			n = len;
+		for (i = 0; i < 4; i++) {
+			memcpy(outp[i], &c[i]->state.b[j], n);
+			outp[i] += n;
+		}
+		j += n;
+		len -= n;
+	}
+
+	for (i = 0; i < 4; i++)
+		c[i]->pt = j;
+}
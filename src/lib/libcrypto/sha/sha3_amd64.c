@@ -0,0 +1,42 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdint.h>
+
+#include "crypto_arch.h"
+#include "sha3_internal.h"
+
+void sha3_keccakf_x4_avx2(uint64_t *st[4]);
+void sha3_keccakf_x4_avx512(uint64_t *st[4]);
+
+void
+sha3_keccakf_x4(uint64_t *st[4])
+{
+	int i;
+
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX512) != 0) {
+		sha3_keccakf_x4_avx512(st);
+		return;
+	}
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AVX2) != 0) {
+		sha3_keccakf_x4_avx2(st);
+		return;
+	}
+
+	for (i = 0; i < 4; i++)
+		sha3_keccakf(st[i]);
+}
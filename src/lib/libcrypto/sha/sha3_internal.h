@@ -66,6 +66,14 @@ typedef struct sha3_ctx_st {
 	size_t mdlen;
 } sha3_ctx;
 
+/*
+ * Keccak-f[1600] permutations of a single state and of four independent
+ * states, with the state lanes stored in little endian byte order.
+ */
+void sha3_keccakf(uint64_t st[25]);
+void sha3_keccakf_generic(uint64_t st[25]);
+void sha3_keccakf_x4(uint64_t *st[4]);
+
 int sha3_init(sha3_ctx *c, int mdlen);
 int sha3_update(sha3_ctx *c, const void *data, size_t len);
 int sha3_final(void *md, sha3_ctx *c);
@@ -77,5 +85,7 @@ int sha3_final(void *md, sha3_ctx *c);
 
 void shake_xof(sha3_ctx *c);
 void shake_out(sha3_ctx *c, void *out, size_t len);
+void shake_xof_x4(sha3_ctx *c[4]);
+void shake_out_x4(sha3_ctx *c[4], uint8_t *out[4], size_t len);
 
 #endif
@@ -307,6 +307,17 @@ sha512_block_data_order(SHA512_CTX *ctx, const void *_in, size_t num)
 
 #endif /* SHA512_ASM */
 
+#ifndef HAVE_SHA512_BLOCK_MULTI
+void
+sha512_block_multi(SHA512_CTX *ctx[], const void *in[], size_t n, size_t num)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+		sha512_block_data_order(ctx[i], in[i], num);
+}
+#endif
+
 int
 SHA384_Init(SHA512_CTX *c)
 {
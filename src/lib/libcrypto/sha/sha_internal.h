@@ -20,6 +20,17 @@
 #ifndef HEADER_SHA_INTERNAL_H
 #define HEADER_SHA_INTERNAL_H
 
+/*
+ * Process num blocks from each of the n inputs, updating the corresponding
+ * contexts. Architectures may process multiple inputs in parallel.
+ */
+void sha1_block_multi(SHA_CTX *ctx[], const void *in[], size_t n,
+    size_t num);
+void sha256_block_multi(SHA256_CTX *ctx[], const void *in[], size_t n,
+    size_t num);
+void sha512_block_multi(SHA512_CTX *ctx[], const void *in[], size_t n,
+    size_t num);
+
 #define SHA512_224_DIGEST_LENGTH	28
 #define SHA512_256_DIGEST_LENGTH	32
 
@@ -18,8 +18,15 @@
 #include <openssl/opensslconf.h>
 
 #ifndef OPENSSL_NO_SM4
+#include <string.h>
+
+#include <openssl/modes.h>
 #include <openssl/sm4.h>
 
+#include "crypto_arch.h"
+#include "crypto_internal.h"
+#include "sm4_internal.h"
+
 struct sm4_key {
         uint32_t rk[SM4_KEY_SCHEDULE];
 };
@@ -263,4 +270,137 @@ SM4_decrypt(const uint8_t *in, uint8_t *out, const SM4_KEY *k)
 }
 LCRYPTO_ALIAS(SM4_decrypt);
 
+void
+sm4_encrypt_blocks_generic(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key)
+{
+	while (blocks-- > 0) {
+		SM4_encrypt(in, out, key);
+		in += SM4_BLOCK_SIZE;
+		out += SM4_BLOCK_SIZE;
+	}
+}
+
+#ifndef HAVE_SM4_ENCRYPT_BLOCKS
+void
+sm4_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key)
+{
+	sm4_encrypt_blocks_generic(in, out, blocks, key);
+}
+#endif
+
+/*
+ * Decryption is encryption with the round keys in reverse order, which
+ * allows the multi-block encryption to be used for decryption.
+ */
+static void
+sm4_decrypt_key(const SM4_KEY *key, SM4_KEY *dkey)
+{
+	const struct sm4_key *ks = (const struct sm4_key *)key;
+	struct sm4_key *dks = (struct sm4_key *)dkey;
+	int i;
+
+	for (i = 0; i < SM4_KEY_SCHEDULE; i++)
+		dks->rk[i] = ks->rk[SM4_KEY_SCHEDULE - 1 - i];
+}
+
+void
+sm4_ecb_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key, int enc)
+{
+	SM4_KEY dkey;
+
+	if (enc) {
+		sm4_encrypt_blocks(in, out, blocks, key);
+		return;
+	}
+
+	sm4_decrypt_key(key, &dkey);
+	sm4_encrypt_blocks(in, out, blocks, &dkey);
+	explicit_bzero(&dkey, sizeof(dkey));
+}
+
+#define SM4_PARALLEL_BLOCKS	16
+
+void
+sm4_cbc_decrypt(const uint8_t *in, uint8_t *out, size_t len,
+    const SM4_KEY *key, uint8_t *ivec)
+{
+	uint8_t buf[SM4_PARALLEL_BLOCKS * SM4_BLOCK_SIZE];
+	uint8_t iv[SM4_BLOCK_SIZE];
+	SM4_KEY dkey;
+	size_t blocks, i;
+
+	sm4_decrypt_key(key, &dkey);
+
+	while (len >= SM4_BLOCK_SIZE) {
+		blocks = len / SM4_BLOCK_SIZE;
+		if (blocks > SM4_PARALLEL_BLOCKS)
+			blocks = SM4_PARALLEL_BLOCKS;
+
+		/*
+		 * Save the last ciphertext block as the next IV and decrypt
+		 * into a separate buffer, so that in and out may overlap.
+		 */
+		memcpy(iv, &in[(blocks - 1) * SM4_BLOCK_SIZE], sizeof(iv));
+		sm4_encrypt_blocks(in, buf, blocks, &dkey);
+
+		for (i = 0; i < SM4_BLOCK_SIZE; i++)
+			buf[i] ^= ivec[i];
+		for (i = SM4_BLOCK_SIZE; i < blocks * SM4_BLOCK_SIZE; i++)
+			buf[i] ^= in[i - SM4_BLOCK_SIZE];
+		memcpy(out, buf, blocks * SM4_BLOCK_SIZE);
+		memcpy(ivec, iv, sizeof(iv));
+
+		in += blocks * SM4_BLOCK_SIZE;
+		out += blocks * SM4_BLOCK_SIZE;
+		len -= blocks * SM4_BLOCK_SIZE;
+	}
+
+	if (len > 0)
+		CRYPTO_cbc128_decrypt(in, out, len, &dkey, ivec,
+		    (block128_f)SM4_encrypt);
+
+	explicit_bzero(buf, sizeof(buf));
+	explicit_bzero(&dkey, sizeof(dkey));
+}
+
+/*
+ * Encrypt blocks in counter mode with a 32 bit big endian counter, as
+ * required for ctr128_f.
+ */
+void
+sm4_ctr32_encrypt_blocks(const unsigned char *in, unsigned char *out,
+    size_t blocks, const void *key, const unsigned char ivec[16])
+{
+	uint8_t buf[SM4_PARALLEL_BLOCKS * SM4_BLOCK_SIZE];
+	uint32_t ctr;
+	size_t i, n;
+
+	ctr = crypto_load_be32toh(&ivec[12]);
+
+	while (blocks > 0) {
+		n = blocks;
+		if (n > SM4_PARALLEL_BLOCKS)
+			n = SM4_PARALLEL_BLOCKS;
+
+		for (i = 0; i < n; i++) {
+			memcpy(&buf[i * SM4_BLOCK_SIZE], ivec, 12);
+			crypto_store_htobe32(&buf[i * SM4_BLOCK_SIZE + 12],
+			    ctr++);
+		}
+		sm4_encrypt_blocks(buf, buf, n, key);
+
+		for (i = 0; i < n * SM4_BLOCK_SIZE; i++)
+			out[i] = in[i] ^ buf[i];
+
+		in += n * SM4_BLOCK_SIZE;
+		out += n * SM4_BLOCK_SIZE;
+		blocks -= n;
+	}
+
+	explicit_bzero(buf, sizeof(buf));
+}
+
 #endif /* OPENSSL_NO_SM4 */
@@ -0,0 +1,72 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <openssl/sm4.h>
+
+#include "crypto_arch.h"
+#include "sm4_internal.h"
+
+void sm4_encrypt_blocks8_aesni(const uint8_t *in, uint8_t *out,
+    const SM4_KEY *key);
+void sm4_encrypt_blocks16_vaes(const uint8_t *in, uint8_t *out,
+    const SM4_KEY *key);
+
+static void
+sm4_encrypt_blocks_aesni(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key)
+{
+	uint8_t buf[8 * SM4_BLOCK_SIZE];
+
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_VAES) != 0) {
+		while (blocks >= 16) {
+			sm4_encrypt_blocks16_vaes(in, out, key);
+			in += 16 * SM4_BLOCK_SIZE;
+			out += 16 * SM4_BLOCK_SIZE;
+			blocks -= 16;
+		}
+	}
+	while (blocks >= 8) {
+		sm4_encrypt_blocks8_aesni(in, out, key);
+		in += 8 * SM4_BLOCK_SIZE;
+		out += 8 * SM4_BLOCK_SIZE;
+		blocks -= 8;
+	}
+	if (blocks > 0) {
+		memset(buf, 0, sizeof(buf));
+		memcpy(buf, in, blocks * SM4_BLOCK_SIZE);
+		sm4_encrypt_blocks8_aesni(buf, buf, key);
+		memcpy(out, buf, blocks * SM4_BLOCK_SIZE);
+		explicit_bzero(buf, sizeof(buf));
+	}
+}
+
+void
+sm4_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key)
+{
+	/* A single block is faster with the table based implementation. */
+	if ((crypto_cpu_caps_amd64 & CRYPTO_CPU_CAPS_AMD64_AESNI_AVX) != 0 &&
+	    blocks > 1) {
+		sm4_encrypt_blocks_aesni(in, out, blocks, key);
+		return;
+	}
+
+	sm4_encrypt_blocks_generic(in, out, blocks, key);
+}
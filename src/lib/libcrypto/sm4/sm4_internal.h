@@ -0,0 +1,38 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <openssl/sm4.h>
+
+#ifndef HEADER_SM4_INTERNAL_H
+#define HEADER_SM4_INTERNAL_H
+
+void sm4_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key);
+void sm4_encrypt_blocks_generic(const uint8_t *in, uint8_t *out,
+    size_t blocks, const SM4_KEY *key);
+
+void sm4_ecb_encrypt_blocks(const uint8_t *in, uint8_t *out, size_t blocks,
+    const SM4_KEY *key, int enc);
+void sm4_cbc_decrypt(const uint8_t *in, uint8_t *out, size_t len,
+    const SM4_KEY *key, uint8_t *ivec);
+void sm4_ctr32_encrypt_blocks(const unsigned char *in, unsigned char *out,
+    size_t blocks, const void *key, const unsigned char ivec[16]);
+
+#endif
@@ -56,7 +56,11 @@
  * [including the GNU Public Licence.]
  */
 
+#include <sys/stat.h>
+
+#include <dirent.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -69,15 +73,37 @@
 
 #include "x509_local.h"
 
+/*
+ * A file in a directory, named after the hash of the subject name of the
+ * certificate, or of the issuer name of the CRL, that it contains.
+ */
 typedef struct lookup_dir_hashes_st {
 	unsigned long hash;
+	int type;
 	int suffix;
+	int loaded;
+	/* What the file looked like when it was last loaded. */
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
 } BY_DIR_HASH;
 
+/*
+ * The files of a directory are indexed when it is first used, and again
+ * whenever its modification time changes. A name hash without a file in
+ * the index is known to be absent, so that lookups for it do not need to
+ * touch the file system. Files that have been loaded are checked with
+ * stat(2) on every lookup for their hash, and loaded again if they have
+ * been rewritten or a symbolic link now points elsewhere, which does not
+ * change the modification time of the directory.
+ */
 typedef struct lookup_dir_entry_st {
 	char *dir;
 	int dir_type;
 	STACK_OF(BY_DIR_HASH) *hashes;
+	struct timespec mtime;
+	int scanned;
 } BY_DIR_ENTRY;
 
 typedef struct lookup_dir_st {
@@ -166,6 +192,12 @@ by_dir_hash_cmp(const BY_DIR_HASH * const *a,
 		return 1;
 	if ((*a)->hash < (*b)->hash)
 		return -1;
+	if ((*a)->type != (*b)->type)
+		return (*a)->type - (*b)->type;
+	if ((*a)->suffix > (*b)->suffix)
+		return 1;
+	if ((*a)->suffix < (*b)->suffix)
+		return -1;
 	return 0;
 }
 
@@ -231,6 +263,7 @@ add_cert_dir(BY_DIR *ctx, const char *dir, int type)
 				X509error(ERR_R_MALLOC_FAILURE);
 				return 0;
 			}
+			memset(ent, 0, sizeof(*ent));
 			ent->dir_type = type;
 			ent->hashes = sk_BY_DIR_HASH_new(by_dir_hash_cmp);
 			ent->dir = strndup(ss, (size_t)len);
@@ -249,41 +282,250 @@ add_cert_dir(BY_DIR *ctx, const char *dir, int type)
 	return 1;
 }
 
+/*
+ * Parse a file name of the form hash.N or hash.rN, as created by
+ * openssl certhash.
+ */
+static int
+by_dir_parse_name(const char *name, BY_DIR_HASH *hent)
+{
+	const char *p = name;
+	int i;
+
+	memset(hent, 0, sizeof(*hent));
+
+	for (i = 0; i < 8; i++, p++) {
+		hent->hash <<= 4;
+		if (*p >= '0' && *p <= '9')
+			hent->hash |= *p - '0';
+		else if (*p >= 'a' && *p <= 'f')
+			hent->hash |= *p - 'a' + 10;
+		else
+			return 0;
+	}
+	if (*p++ != '.')
+		return 0;
+
+	hent->type = X509_LU_X509;
+	if (*p == 'r') {
+		hent->type = X509_LU_CRL;
+		p++;
+	}
+
+	if (*p < '0' || *p > '9')
+		return 0;
+	for (; *p >= '0' && *p <= '9'; p++) {
+		if (hent->suffix > (INT_MAX - (*p - '0')) / 10)
+			return 0;
+		hent->suffix = hent->suffix * 10 + *p - '0';
+	}
+
+	return *p == '\0';
+}
+
+static STACK_OF(BY_DIR_HASH) *
+by_dir_scan(const char *dir)
+{
+	STACK_OF(BY_DIR_HASH) *hashes;
+	BY_DIR_HASH *hent = NULL;
+	struct dirent *dp;
+	DIR *dirp;
+
+	if ((hashes = sk_BY_DIR_HASH_new(by_dir_hash_cmp)) == NULL)
+		return NULL;
+
+	/* A missing or unreadable directory has no files. */
+	if ((dirp = opendir(dir)) == NULL)
+		return hashes;
+
+	while ((dp = readdir(dirp)) != NULL) {
+		if (hent == NULL && (hent = malloc(sizeof(*hent))) == NULL)
+			goto err;
+		if (!by_dir_parse_name(dp->d_name, hent))
+			continue;
+		if (!sk_BY_DIR_HASH_push(hashes, hent))
+			goto err;
+		hent = NULL;
+	}
+	closedir(dirp);
+	free(hent);
+
+	sk_BY_DIR_HASH_sort(hashes);
+
+	return hashes;
+
+ err:
+	closedir(dirp);
+	free(hent);
+	sk_BY_DIR_HASH_pop_free(hashes, by_dir_hash_free);
+
+	return NULL;
+}
+
+static int
+by_dir_changed(BY_DIR_ENTRY *ent, const struct stat *sb)
+{
+	if (!ent->scanned)
+		return 1;
+
+	return sb->st_mtim.tv_sec != ent->mtime.tv_sec ||
+	    sb->st_mtim.tv_nsec != ent->mtime.tv_nsec;
+}
+
+/*
+ * Rescan the directory if it has changed since it was last scanned.
+ */
+static int
+by_dir_refresh(BY_DIR_ENTRY *ent)
+{
+	STACK_OF(BY_DIR_HASH) *hashes;
+	struct stat sb;
+	int changed;
+
+	if (stat(ent->dir, &sb) == -1)
+		memset(&sb, 0, sizeof(sb));
+
+	CRYPTO_r_lock(CRYPTO_LOCK_X509_STORE);
+	changed = by_dir_changed(ent, &sb);
+	CRYPTO_r_unlock(CRYPTO_LOCK_X509_STORE);
+
+	if (!changed)
+		return 1;
+
+	if ((hashes = by_dir_scan(ent->dir)) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
+	if (by_dir_changed(ent, &sb)) {
+		sk_BY_DIR_HASH_pop_free(ent->hashes, by_dir_hash_free);
+		ent->hashes = hashes;
+		ent->mtime = sb.st_mtim;
+		ent->scanned = 1;
+		hashes = NULL;
+	}
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
+
+	sk_BY_DIR_HASH_pop_free(hashes, by_dir_hash_free);
+
+	return 1;
+}
+
+/*
+ * Find the files for the given hash. Suffixes are consecutive, starting at
+ * zero, so the files are the range of entries starting at hash.0. Returns
+ * the number of entries copied into the allocated array, or -1 on error.
+ */
+static int
+by_dir_files(BY_DIR_ENTRY *ent, int type, unsigned long h, BY_DIR_HASH **files)
+{
+	BY_DIR_HASH htmp, *hent;
+	int i, idx, end, n = 0;
+
+	*files = NULL;
+
+	memset(&htmp, 0, sizeof(htmp));
+	htmp.hash = h;
+	htmp.type = type;
+
+	CRYPTO_r_lock(CRYPTO_LOCK_X509_STORE);
+	if ((idx = sk_BY_DIR_HASH_find(ent->hashes, &htmp)) < 0)
+		goto done;
+	for (end = idx; end < sk_BY_DIR_HASH_num(ent->hashes); end++) {
+		hent = sk_BY_DIR_HASH_value(ent->hashes, end);
+		if (hent->hash != h || hent->type != type ||
+		    hent->suffix != end - idx)
+			break;
+	}
+	if ((*files = reallocarray(NULL, end - idx, sizeof(**files))) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		n = -1;
+		goto done;
+	}
+	for (i = idx; i < end; i++)
+		(*files)[n++] = *sk_BY_DIR_HASH_value(ent->hashes, i);
+
+ done:
+	CRYPTO_r_unlock(CRYPTO_LOCK_X509_STORE);
+
+	return n;
+}
+
+/*
+ * Check whether a file needs to be loaded, recording its current state in
+ * hent if so. The state is taken before the file is read, so that a change
+ * made while it is being loaded is picked up by the next lookup.
+ */
+static int
+by_dir_file_stale(BY_DIR_HASH *hent, const char *path)
+{
+	struct stat sb;
+
+	if (stat(path, &sb) == -1)
+		return 0;
+
+	if (hent->loaded && sb.st_dev == hent->dev &&
+	    sb.st_ino == hent->ino && sb.st_size == hent->size &&
+	    sb.st_mtim.tv_sec == hent->mtime.tv_sec &&
+	    sb.st_mtim.tv_nsec == hent->mtime.tv_nsec)
+		return 0;
+
+	hent->loaded = 1;
+	hent->dev = sb.st_dev;
+	hent->ino = sb.st_ino;
+	hent->size = sb.st_size;
+	hent->mtime = sb.st_mtim;
+
+	return 1;
+}
+
+/*
+ * Record the state of the files once their contents are in the store, so
+ * that a concurrent lookup does not miss objects that are still being
+ * loaded.
+ */
+static void
+by_dir_set_loaded(BY_DIR_ENTRY *ent, const BY_DIR_HASH *files, int n)
+{
+	BY_DIR_HASH *hent;
+	int i, idx;
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
+	for (i = 0; i < n; i++) {
+		if (!files[i].loaded)
+			continue;
+		if ((idx = sk_BY_DIR_HASH_find(ent->hashes, &files[i])) < 0)
+			continue;
+		hent = sk_BY_DIR_HASH_value(ent->hashes, idx);
+		hent->loaded = 1;
+		hent->dev = files[i].dev;
+		hent->ino = files[i].ino;
+		hent->size = files[i].size;
+		hent->mtime = files[i].mtime;
+	}
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
+}
+
 static int
 get_cert_by_subject(X509_LOOKUP *xl, int type, X509_NAME *name,
     X509_OBJECT *ret)
 {
 	BY_DIR *ctx;
-	union	{
-		struct	{
-			X509 st_x509;
-			X509_CINF st_x509_cinf;
-		} x509;
-		struct	{
-			X509_CRL st_crl;
-			X509_CRL_INFO st_crl_info;
-		} crl;
-	} data;
 	int ok = 0;
-	int i, j, k;
+	int i, j, k, n;
+	BY_DIR_HASH *files = NULL;
 	unsigned long h;
 	BUF_MEM *b = NULL;
-	X509_OBJECT stmp, *tmp;
+	X509_OBJECT *tmp;
 	const char *postfix="";
 
 	if (name == NULL)
 		return 0;
 
-	stmp.type = type;
 	if (type == X509_LU_X509) {
-		data.x509.st_x509.cert_info = &data.x509.st_x509_cinf;
-		data.x509.st_x509_cinf.subject = name;
-		stmp.data.x509 = &data.x509.st_x509;
 		postfix="";
 	} else if (type == X509_LU_CRL) {
-		data.crl.st_crl.crl = &data.crl.st_crl_info;
-		data.crl.st_crl_info.issuer = name;
-		stmp.data.crl = &data.crl.st_crl;
 		postfix="r";
 	} else {
 		X509error(X509_R_WRONG_LOOKUP_TYPE);
@@ -300,8 +542,6 @@ get_cert_by_subject(X509_LOOKUP *xl, int type, X509_NAME *name,
 	h = X509_NAME_hash(name);
 	for (i = 0; i < sk_BY_DIR_ENTRY_num(ctx->dirs); i++) {
 		BY_DIR_ENTRY *ent;
-		int idx;
-		BY_DIR_HASH htmp, *hent;
 
 		ent = sk_BY_DIR_ENTRY_value(ctx->dirs, i);
 		j = strlen(ent->dir) + 1 + 8 + 6 + 1 + 1;
@@ -309,91 +549,44 @@ get_cert_by_subject(X509_LOOKUP *xl, int type, X509_NAME *name,
 			X509error(ERR_R_MALLOC_FAILURE);
 			goto finish;
 		}
-		if (type == X509_LU_CRL) {
-			htmp.hash = h;
-			CRYPTO_r_lock(CRYPTO_LOCK_X509_STORE);
-			idx = sk_BY_DIR_HASH_find(ent->hashes, &htmp);
-			if (idx >= 0) {
-				hent = sk_BY_DIR_HASH_value(ent->hashes, idx);
-				k = hent->suffix;
-			} else {
-				hent = NULL;
-				k = 0;
-			}
-			CRYPTO_r_unlock(CRYPTO_LOCK_X509_STORE);
-		} else {
-			k = 0;
-			hent = NULL;
-		}
-		for (;;) {
+
+		if (!by_dir_refresh(ent))
+			goto finish;
+		if ((n = by_dir_files(ent, type, h, &files)) == -1)
+			goto finish;
+
+		for (k = 0; k < n; k++) {
 			(void) snprintf(b->data, b->max, "%s/%08lx.%s%d",
-			    ent->dir, h, postfix, k);
+			    ent->dir, h, postfix, files[k].suffix);
+			if (!by_dir_file_stale(&files[k], b->data))
+				continue;
 			/*
-			 * Found one. Attempt to load it. This could fail for
-			 * any number of reasons from the file can't be opened,
-			 * the file contains garbage, etc. Clear the error stack
-			 * to avoid exposing the lower level error. These all
-			 * boil down to "we could not find CA/CRL".
+			 * Attempt to load it. This could fail for any number
+			 * of reasons from the file can't be opened, the file
+			 * contains garbage, etc. Clear the error stack to
+			 * avoid exposing the lower level error. These all boil
+			 * down to "we could not find CA/CRL".
 			 */
 			if (type == X509_LU_X509) {
 				if ((X509_load_cert_file(xl, b->data,
-				    ent->dir_type)) == 0) {
+				    ent->dir_type)) == 0)
 					ERR_clear_error();
-					break;
-				}
 			} else if (type == X509_LU_CRL) {
 				if ((X509_load_crl_file(xl, b->data,
-				    ent->dir_type)) == 0) {
+				    ent->dir_type)) == 0)
 					ERR_clear_error();
-					break;
-				}
 			}
 			/* The lack of a CA or CRL will be caught higher up. */
-			k++;
 		}
+		by_dir_set_loaded(ent, files, n);
+		free(files);
+		files = NULL;
 
 		/* we have added it to the cache so now pull it out again */
 		CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
-		j = sk_X509_OBJECT_find(xl->store_ctx->objs, &stmp);
-		tmp = sk_X509_OBJECT_value(xl->store_ctx->objs, j);
+		tmp = x509_store_object_by_subject(xl->store_ctx, type, name, h);
 		CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
 
-		/* If a CRL, update the last file suffix added for this */
-		if (type == X509_LU_CRL) {
-			CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
-			/*
-			 * Look for entry again in case another thread added
-			 * an entry first.
-			 */
-			if (hent == NULL) {
-				htmp.hash = h;
-				idx = sk_BY_DIR_HASH_find(ent->hashes, &htmp);
-				hent = sk_BY_DIR_HASH_value(ent->hashes, idx);
-			}
-			if (hent == NULL) {
-				hent = malloc(sizeof(*hent));
-				if (hent == NULL) {
-					X509error(ERR_R_MALLOC_FAILURE);
-					CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
-					ok = 0;
-					goto finish;
-				}
-				hent->hash = h;
-				hent->suffix = k;
-				if (!sk_BY_DIR_HASH_push(ent->hashes, hent)) {
-					X509error(ERR_R_MALLOC_FAILURE);
-					CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
-					free(hent);
-					ok = 0;
-					goto finish;
-				}
-			} else if (hent->suffix < k)
-				hent->suffix = k;
-
-			CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
-
-		}
-
 		if (tmp != NULL) {
 			ok = 1;
 			ret->type = tmp->type;
@@ -402,6 +595,7 @@ get_cert_by_subject(X509_LOOKUP *xl, int type, X509_NAME *name,
 		}
 	}
 finish:
+	free(files);
 	BUF_MEM_free(b);
 	return ok;
 }
@@ -136,6 +136,8 @@ X509_load_cert_file(X509_LOOKUP *ctx, const char *file, int type)
 					goto err;
 				}
 			}
+			/* Share certificates loaded into many stores. */
+			x = X509_intern(x);
 			i = X509_STORE_add_cert(ctx->store_ctx, x);
 			if (!i)
 				goto err;
@@ -150,6 +152,7 @@ X509_load_cert_file(X509_LOOKUP *ctx, const char *file, int type)
 			X509error(ERR_R_ASN1_LIB);
 			goto err;
 		}
+		x = X509_intern(x);
 		i = X509_STORE_add_cert(ctx->store_ctx, x);
 		if (!i)
 			goto err;
@@ -172,6 +175,8 @@ X509_load_crl_file(X509_LOOKUP *ctx, const char *file, int type)
 	BIO *in = NULL;
 	int i, count = 0;
 	X509_CRL *x = NULL;
+	unsigned char *data;
+	long data_len;
 
 	in = BIO_new(BIO_s_file());
 
@@ -180,10 +185,14 @@ X509_load_crl_file(X509_LOOKUP *ctx, const char *file, int type)
 		goto err;
 	}
 
+	/*
+	 * CRLs are indexed, so that their revoked entries are only decoded
+	 * when a lookup needs them. See X509_CRL_new_indexed(3).
+	 */
 	if (type == X509_FILETYPE_PEM) {
 		for (;;) {
-			x = PEM_read_bio_X509_CRL(in, NULL, NULL, "");
-			if (x == NULL) {
+			if (!PEM_bytes_read_bio(&data, &data_len, NULL,
+			    PEM_STRING_X509_CRL, in, NULL, "")) {
 				if ((ERR_GET_REASON(ERR_peek_last_error()) ==
 				    PEM_R_NO_START_LINE) && (count > 0)) {
 					ERR_clear_error();
@@ -193,6 +202,10 @@ X509_load_crl_file(X509_LOOKUP *ctx, const char *file, int type)
 					goto err;
 				}
 			}
+			if ((x = x509_crl_new_indexed(data, data_len)) == NULL) {
+				X509error(ERR_R_ASN1_LIB);
+				goto err;
+			}
 			i = X509_STORE_add_crl(ctx->store_ctx, x);
 			if (!i)
 				goto err;
@@ -202,7 +215,7 @@ X509_load_crl_file(X509_LOOKUP *ctx, const char *file, int type)
 		}
 		ret = count;
 	} else if (type == X509_FILETYPE_ASN1) {
-		x = d2i_X509_CRL_bio(in, NULL);
+		x = X509_CRL_load_indexed(file);
 		if (x == NULL) {
 			X509error(ERR_R_ASN1_LIB);
 			goto err;
@@ -246,6 +259,7 @@ X509_load_cert_crl_file(X509_LOOKUP *ctx, const char *file, int type)
 	for (i = 0; i < sk_X509_INFO_num(inf); i++) {
 		itmp = sk_X509_INFO_value(inf, i);
 		if (itmp->x509) {
+			itmp->x509 = X509_intern(itmp->x509);
 			X509_STORE_add_cert(ctx->store_ctx, itmp->x509);
 			count++;
 		}
@@ -111,6 +111,8 @@ by_mem_ctrl(X509_LOOKUP *lu, int cmd, const char *buf,
 	for (i = 0; i < sk_X509_INFO_num(inf); i++) {
 		itmp = sk_X509_INFO_value(inf, i);
 		if (itmp->x509) {
+			/* Share certificates loaded into many stores. */
+			itmp->x509 = X509_intern(itmp->x509);
 			ok = X509_STORE_add_cert(lu->store_ctx, itmp->x509);
 			if (!ok)
 				goto done;
@@ -591,6 +591,7 @@ extern const ASN1_ITEM X509_CINF_it;
 X509 *X509_new(void);
 void X509_free(X509 *a);
 X509 *d2i_X509(X509 **a, const unsigned char **in, long len);
+X509 *d2i_X509_lazy(X509 **a, const unsigned char **in, long len);
 int i2d_X509(X509 *a, unsigned char **out);
 extern const ASN1_ITEM X509_it;
 
@@ -645,6 +646,8 @@ int X509_CRL_add0_revoked(X509_CRL *crl, X509_REVOKED *rev);
 int X509_CRL_get0_by_serial(X509_CRL *crl,
 		X509_REVOKED **ret, ASN1_INTEGER *serial);
 int X509_CRL_get0_by_cert(X509_CRL *crl, X509_REVOKED **ret, X509 *x);
+X509_CRL *X509_CRL_new_indexed(const unsigned char *der, size_t der_len);
+X509_CRL *X509_CRL_load_indexed(const char *filename);
 
 X509_PKEY *	X509_PKEY_new(void );
 void		X509_PKEY_free(X509_PKEY *a);
@@ -954,6 +957,7 @@ int X509_PUBKEY_get0_param(ASN1_OBJECT **ppkalg, const unsigned char **pk,
 
 int X509_up_ref(X509 *x);
 STACK_OF(X509) *X509_chain_up_ref(STACK_OF(X509) *chain);
+X509 *X509_intern(X509 *x);
 
 void ERR_load_X509_strings(void);
 
@@ -368,8 +368,11 @@ X509V3_EXT_add_nconf(CONF *conf, X509V3_CTX *ctx, const char *section,
 {
 	STACK_OF(X509_EXTENSION) **sk = NULL;
 
-	if (cert)
+	if (cert) {
+		if (!x509_cinf_decode_extensions(cert->cert_info))
+			return 0;
 		sk = &cert->cert_info->extensions;
+	}
 	return X509V3_EXT_add_nconf_sk(conf, ctx, section, sk);
 }
 LCRYPTO_ALIAS(X509V3_EXT_add_nconf);
@@ -1212,6 +1212,511 @@ x509_constraints_check(struct x509_constraints_names *names,
 	return 1;
 }
 
+/*
+ * Compiled name constraints.
+ *
+ * Checking every name against every constraint is quadratic, which hurts
+ * with intermediates carrying hundreds of constraints. The constraints of
+ * a certificate are therefore compiled once into structures that answer
+ * the same questions as x509_constraints_match() without walking the list:
+ * domain constraints go into a trie of the lowercased names, read from the
+ * end, and address constraints into tables of networks, one sorted table
+ * for each distinct mask. The compiled constraints are cached in the X509.
+ */
+
+#define X509_CONSTRAINTS_TRIE_SUFFIX	0x01	/* Matches any prefix */
+#define X509_CONSTRAINTS_TRIE_EXACT	0x02	/* Matches the name itself */
+
+struct x509_constraints_trie {
+	struct x509_constraints_trie *child;
+	struct x509_constraints_trie *sibling;
+	uint8_t c;
+	uint8_t flags;
+};
+
+struct x509_constraints_ip_table {
+	int af;
+	uint8_t mask[16];
+	uint8_t (*networks)[16];
+	size_t networks_count;
+};
+
+struct x509_constraints_set {
+	struct x509_constraints_names *names;
+	size_t type_count[GEN_RID + 1];
+	struct x509_constraints_trie *dns;
+	struct x509_constraints_trie *uri;
+	struct x509_constraints_trie *email;
+	struct x509_constraints_name **mailboxes;
+	size_t mailboxes_count;
+	struct x509_constraints_ip_table *ip;
+	size_t ip_count;
+	struct x509_constraints_name **dirnames;
+	size_t dirnames_count;
+};
+
+struct x509_constraints_compiled {
+	struct x509_constraints_set permitted;
+	struct x509_constraints_set excluded;
+	int error;
+};
+
+static void
+x509_constraints_trie_free(struct x509_constraints_trie *node)
+{
+	struct x509_constraints_trie *next;
+
+	while (node != NULL) {
+		next = node->sibling;
+		x509_constraints_trie_free(node->child);
+		free(node);
+		node = next;
+	}
+}
+
+static struct x509_constraints_trie *
+x509_constraints_trie_child(struct x509_constraints_trie *node, uint8_t c)
+{
+	for (node = node->child; node != NULL; node = node->sibling) {
+		if (node->c == c)
+			return node;
+	}
+	return NULL;
+}
+
+/*
+ * Insert a domain into the trie. Constraints starting with a '.', and all
+ * DNS constraints, match as a suffix. An empty constraint matches
+ * everything.
+ */
+static int
+x509_constraints_trie_add(struct x509_constraints_trie **root,
+    const char *domain, int suffix)
+{
+	struct x509_constraints_trie *node, *child;
+	size_t len;
+
+	if (*root == NULL) {
+		if ((*root = calloc(1, sizeof(**root))) == NULL)
+			return 0;
+	}
+
+	node = *root;
+	len = strlen(domain);
+	if (len == 0 || domain[0] == '.')
+		suffix = 1;
+
+	while (len > 0) {
+		uint8_t c = tolower((unsigned char)domain[--len]);
+
+		if ((child = x509_constraints_trie_child(node, c)) == NULL) {
+			if ((child = calloc(1, sizeof(*child))) == NULL)
+				return 0;
+			child->c = c;
+			child->sibling = node->child;
+			node->child = child;
+		}
+		node = child;
+	}
+	node->flags |= suffix ? X509_CONSTRAINTS_TRIE_SUFFIX :
+	    X509_CONSTRAINTS_TRIE_EXACT;
+
+	return 1;
+}
+
+static int
+x509_constraints_trie_match(const struct x509_constraints_trie *node,
+    const char *domain)
+{
+	size_t len;
+
+	if (node == NULL)
+		return 0;
+
+	len = strlen(domain);
+	for (;;) {
+		if ((node->flags & X509_CONSTRAINTS_TRIE_SUFFIX) != 0)
+			return 1;
+		if (len == 0)
+			return (node->flags & X509_CONSTRAINTS_TRIE_EXACT) != 0;
+		if ((node = x509_constraints_trie_child(
+		    (struct x509_constraints_trie *)node,
+		    tolower((unsigned char)domain[--len]))) == NULL)
+			return 0;
+	}
+}
+
+static int
+x509_constraints_mailbox_cmp(const void *a, const void *b)
+{
+	const struct x509_constraints_name *an = *(const void * const *)a;
+	const struct x509_constraints_name *bn = *(const void * const *)b;
+	int ret;
+
+	if ((ret = strcmp(an->local, bn->local)) != 0)
+		return ret;
+	return strcmp(an->name, bn->name);
+}
+
+static int
+x509_constraints_network_cmp(const void *a, const void *b)
+{
+	return memcmp(a, b, 16);
+}
+
+static int
+x509_constraints_ip_add(struct x509_constraints_set *set,
+    struct x509_constraints_name *constraint)
+{
+	struct x509_constraints_ip_table *table = NULL, *tables;
+	uint8_t (*networks)[16];
+	size_t alen, i;
+
+	alen = constraint->af == AF_INET ? 4 : 16;
+
+	for (i = 0; i < set->ip_count; i++) {
+		if (set->ip[i].af == constraint->af &&
+		    memcmp(set->ip[i].mask, &constraint->address[alen],
+		    alen) == 0) {
+			table = &set->ip[i];
+			break;
+		}
+	}
+	if (table == NULL) {
+		if ((tables = recallocarray(set->ip, set->ip_count,
+		    set->ip_count + 1, sizeof(*tables))) == NULL)
+			return 0;
+		set->ip = tables;
+		table = &set->ip[set->ip_count++];
+		table->af = constraint->af;
+		memcpy(table->mask, &constraint->address[alen], alen);
+	}
+
+	if ((networks = recallocarray(table->networks, table->networks_count,
+	    table->networks_count + 1, sizeof(*networks))) == NULL)
+		return 0;
+	table->networks = networks;
+	for (i = 0; i < alen; i++)
+		networks[table->networks_count][i] =
+		    constraint->address[i] & table->mask[i];
+	table->networks_count++;
+
+	return 1;
+}
+
+static int
+x509_constraints_ip_match(const struct x509_constraints_set *set,
+    const struct x509_constraints_name *name)
+{
+	const struct x509_constraints_ip_table *table;
+	uint8_t network[16];
+	size_t alen, i, j;
+
+	if (name->af != AF_INET && name->af != AF_INET6)
+		return 0;
+	alen = name->af == AF_INET ? 4 : 16;
+
+	for (i = 0; i < set->ip_count; i++) {
+		table = &set->ip[i];
+		if (table->af != name->af)
+			continue;
+		memset(network, 0, sizeof(network));
+		for (j = 0; j < alen; j++)
+			network[j] = name->address[j] & table->mask[j];
+		if (bsearch(network, table->networks, table->networks_count,
+		    sizeof(*table->networks),
+		    x509_constraints_network_cmp) != NULL)
+			return 1;
+	}
+
+	return 0;
+}
+
+static void
+x509_constraints_set_clear(struct x509_constraints_set *set)
+{
+	size_t i;
+
+	x509_constraints_names_free(set->names);
+	x509_constraints_trie_free(set->dns);
+	x509_constraints_trie_free(set->uri);
+	x509_constraints_trie_free(set->email);
+	free(set->mailboxes);
+	for (i = 0; i < set->ip_count; i++)
+		free(set->ip[i].networks);
+	free(set->ip);
+	free(set->dirnames);
+	memset(set, 0, sizeof(*set));
+}
+
+static int
+x509_constraints_set_init(struct x509_constraints_set *set,
+    struct x509_constraints_names *names)
+{
+	struct x509_constraints_name *constraint;
+	size_t i, count;
+
+	set->names = names;
+
+	if ((count = names->names_count) == 0)
+		return 1;
+	if ((set->mailboxes = calloc(count, sizeof(*set->mailboxes))) == NULL)
+		return 0;
+	if ((set->dirnames = calloc(count, sizeof(*set->dirnames))) == NULL)
+		return 0;
+
+	for (i = 0; i < count; i++) {
+		constraint = names->names[i];
+		if (constraint->type < 0 || constraint->type > GEN_RID)
+			continue;
+		set->type_count[constraint->type]++;
+
+		switch (constraint->type) {
+		case GEN_DNS:
+			if (!x509_constraints_trie_add(&set->dns,
+			    constraint->name, 1))
+				return 0;
+			break;
+		case GEN_URI:
+			if (!x509_constraints_trie_add(&set->uri,
+			    constraint->name, 0))
+				return 0;
+			break;
+		case GEN_EMAIL:
+			if (constraint->local != NULL) {
+				set->mailboxes[set->mailboxes_count++] =
+				    constraint;
+				break;
+			}
+			if (!x509_constraints_trie_add(&set->email,
+			    constraint->name, 0))
+				return 0;
+			break;
+		case GEN_IPADD:
+			if (constraint->af != AF_INET &&
+			    constraint->af != AF_INET6)
+				break;
+			if (!x509_constraints_ip_add(set, constraint))
+				return 0;
+			break;
+		case GEN_DIRNAME:
+			set->dirnames[set->dirnames_count++] = constraint;
+			break;
+		}
+	}
+
+	qsort(set->mailboxes, set->mailboxes_count, sizeof(*set->mailboxes),
+	    x509_constraints_mailbox_cmp);
+	for (i = 0; i < set->ip_count; i++)
+		qsort(set->ip[i].networks, set->ip[i].networks_count,
+		    sizeof(*set->ip[i].networks),
+		    x509_constraints_network_cmp);
+
+	return 1;
+}
+
+/*
+ * Match a validated name against a set of compiled constraints, with the
+ * same result as calling x509_constraints_match() for each of them.
+ */
+static int
+x509_constraints_set_match(const struct x509_constraints_set *set,
+    struct x509_constraints_name *name)
+{
+	size_t i;
+
+	if (name->type < 0 || name->type > GEN_RID)
+		return 0;
+	if (set->type_count[name->type] == 0)
+		return 0;
+
+	/*
+	 * A domain starting with a '.' is matched against the end of the
+	 * constraints, which the trie cannot do.
+	 */
+	if ((name->type == GEN_URI || name->type == GEN_EMAIL) &&
+	    name->name != NULL && name->name[0] == '.') {
+		for (i = 0; i < set->names->names_count; i++) {
+			if (x509_constraints_match(name, set->names->names[i]))
+				return 1;
+		}
+		return 0;
+	}
+
+	switch (name->type) {
+	case GEN_DNS:
+		return x509_constraints_trie_match(set->dns, name->name);
+	case GEN_URI:
+		return x509_constraints_trie_match(set->uri, name->name);
+	case GEN_EMAIL:
+		if (name->local != NULL && set->mailboxes_count > 0 &&
+		    bsearch(&name, set->mailboxes, set->mailboxes_count,
+		    sizeof(*set->mailboxes),
+		    x509_constraints_mailbox_cmp) != NULL)
+			return 1;
+		return x509_constraints_trie_match(set->email, name->name);
+	case GEN_IPADD:
+		return x509_constraints_ip_match(set, name);
+	case GEN_DIRNAME:
+		for (i = 0; i < set->dirnames_count; i++) {
+			if (x509_constraints_match(name, set->dirnames[i]))
+				return 1;
+		}
+		return 0;
+	}
+
+	return 0;
+}
+
+void
+x509_constraints_compiled_free(struct x509_constraints_compiled *cc)
+{
+	if (cc == NULL)
+		return;
+
+	x509_constraints_set_clear(&cc->permitted);
+	x509_constraints_set_clear(&cc->excluded);
+	free(cc);
+}
+
+/*
+ * Compile permitted and excluded constraints, taking ownership of both.
+ */
+struct x509_constraints_compiled *
+x509_constraints_compile(struct x509_constraints_names *permitted,
+    struct x509_constraints_names *excluded)
+{
+	struct x509_constraints_compiled *cc;
+
+	if ((cc = calloc(1, sizeof(*cc))) == NULL) {
+		x509_constraints_names_free(permitted);
+		x509_constraints_names_free(excluded);
+		return NULL;
+	}
+	if (!x509_constraints_set_init(&cc->permitted, permitted)) {
+		x509_constraints_names_free(excluded);
+		goto err;
+	}
+	if (!x509_constraints_set_init(&cc->excluded, excluded))
+		goto err;
+
+	return cc;
+
+ err:
+	x509_constraints_compiled_free(cc);
+
+	return NULL;
+}
+
+size_t
+x509_constraints_compiled_count(const struct x509_constraints_compiled *cc)
+{
+	return cc->permitted.names->names_count +
+	    cc->excluded.names->names_count;
+}
+
+/*
+ * Return the compiled name constraints of a certificate, compiling and
+ * caching them on first use. Constraints that fail to validate are cached
+ * as the error, which is returned again on every use.
+ */
+int
+x509_constraints_get_compiled(X509 *cert,
+    const struct x509_constraints_compiled **out_cc, int *error)
+{
+	struct x509_constraints_names *excluded = NULL;
+	struct x509_constraints_names *permitted = NULL;
+	struct x509_constraints_compiled *cc;
+	int err = X509_V_ERR_OUT_OF_MEM;
+
+	*out_cc = NULL;
+
+	CRYPTO_r_lock(CRYPTO_LOCK_X509);
+	cc = cert->nc_compiled;
+	CRYPTO_r_unlock(CRYPTO_LOCK_X509);
+
+	if (cc != NULL)
+		goto done;
+
+	if ((permitted = x509_constraints_names_new(
+	    X509_VERIFY_MAX_CHAIN_CONSTRAINTS)) == NULL)
+		goto err;
+	if ((excluded = x509_constraints_names_new(
+	    X509_VERIFY_MAX_CHAIN_CONSTRAINTS)) == NULL)
+		goto err;
+	if (!x509_constraints_extract_constraints(cert, permitted, excluded,
+	    &err)) {
+		/* Do not cache a failure to allocate memory. */
+		if (err == X509_V_ERR_OUT_OF_MEM)
+			goto err;
+		x509_constraints_names_clear(permitted);
+		x509_constraints_names_clear(excluded);
+	} else
+		err = 0;
+
+	cc = x509_constraints_compile(permitted, excluded);
+	permitted = NULL;
+	excluded = NULL;
+	if (cc == NULL) {
+		err = X509_V_ERR_OUT_OF_MEM;
+		goto err;
+	}
+	cc->error = err;
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509);
+	if (cert->nc_compiled == NULL) {
+		cert->nc_compiled = cc;
+		cc = NULL;
+	}
+	x509_constraints_compiled_free(cc);
+	cc = cert->nc_compiled;
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509);
+
+ done:
+	if (cc->error != 0) {
+		*error = cc->error;
+		return 0;
+	}
+	*out_cc = cc;
+
+	return 1;
+
+ err:
+	x509_constraints_names_free(permitted);
+	x509_constraints_names_free(excluded);
+	*error = err;
+
+	return 0;
+}
+
+/*
+ * The same as x509_constraints_check(), using compiled constraints.
+ */
+int
+x509_constraints_check_compiled(struct x509_constraints_names *names,
+    const struct x509_constraints_compiled *cc, int *error)
+{
+	struct x509_constraints_name *name;
+	size_t i;
+
+	for (i = 0; i < names->names_count; i++) {
+		name = names->names[i];
+
+		if (x509_constraints_set_match(&cc->excluded, name)) {
+			*error = X509_V_ERR_EXCLUDED_VIOLATION;
+			return 0;
+		}
+		if (name->type < 0 || name->type > GEN_RID)
+			continue;
+		if (cc->permitted.type_count[name->type] > 0 &&
+		    !x509_constraints_set_match(&cc->permitted, name)) {
+			*error = X509_V_ERR_PERMITTED_VIOLATION;
+			return 0;
+		}
+	}
+	return 1;
+}
+
 /*
  * Walk a validated chain of X509 certs, starting at the leaf, and
  * validate the name constraints in the chain. Intended for use with
@@ -1225,8 +1730,7 @@ x509_constraints_chain(STACK_OF(X509) *chain, int *error, int *depth)
 {
 	int chain_length, verify_err = X509_V_ERR_UNSPECIFIED, i = 0;
 	struct x509_constraints_names *names = NULL;
-	struct x509_constraints_names *excluded = NULL;
-	struct x509_constraints_names *permitted = NULL;
+	const struct x509_constraints_compiled *cc;
 	size_t constraints_count = 0;
 	X509 *cert;
 
@@ -1248,33 +1752,19 @@ x509_constraints_chain(STACK_OF(X509) *chain, int *error, int *depth)
 		if ((cert = sk_X509_value(chain, i)) == NULL)
 			goto err;
 		if (cert->nc != NULL) {
-			if ((permitted = x509_constraints_names_new(
-			    X509_VERIFY_MAX_CHAIN_CONSTRAINTS)) == NULL) {
-				verify_err = X509_V_ERR_OUT_OF_MEM;
-				goto err;
-			}
-			if ((excluded = x509_constraints_names_new(
-			    X509_VERIFY_MAX_CHAIN_CONSTRAINTS)) == NULL) {
-				verify_err = X509_V_ERR_OUT_OF_MEM;
-				goto err;
-			}
-			if (!x509_constraints_extract_constraints(cert,
-			    permitted, excluded, &verify_err))
+			if (!x509_constraints_get_compiled(cert, &cc,
+			    &verify_err))
 				goto err;
-			constraints_count += permitted->names_count;
-			constraints_count += excluded->names_count;
+			constraints_count +=
+			    x509_constraints_compiled_count(cc);
 			if (constraints_count >
 			    X509_VERIFY_MAX_CHAIN_CONSTRAINTS) {
 				verify_err = X509_V_ERR_OUT_OF_MEM;
 				goto err;
 			}
-			if (!x509_constraints_check(names, permitted, excluded,
+			if (!x509_constraints_check_compiled(names, cc,
 			    &verify_err))
 				goto err;
-			x509_constraints_names_free(excluded);
-			excluded = NULL;
-			x509_constraints_names_free(permitted);
-			permitted = NULL;
 		}
 		if (!x509_constraints_extract_names(names, cert, 0,
 		    &verify_err))
@@ -1287,8 +1777,6 @@ x509_constraints_chain(STACK_OF(X509) *chain, int *error, int *depth)
  err:
 	*error = verify_err;
 	*depth = i;
-	x509_constraints_names_free(excluded);
-	x509_constraints_names_free(permitted);
 	x509_constraints_names_free(names);
 	return 0;
 }
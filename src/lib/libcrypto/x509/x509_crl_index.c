@@ -0,0 +1,799 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Indexed CRLs.
+ *
+ * A CRL from a large CA can list millions of revoked certificates. Decoding
+ * all of them into X509_REVOKED structures costs far more memory and time
+ * than the DER encoding itself, while a verifier only ever needs the entries
+ * for the handful of serial numbers it is asked about.
+ *
+ * An indexed CRL keeps a copy of the DER encoding of the CRL and decodes the
+ * X509_CRL from it with the revokedCertificates field left out. A hash table
+ * with open addressing maps the serial numbers of the revoked entries to
+ * their offsets in the encoding, and an entry is only decoded into an
+ * X509_REVOKED when a lookup finds it.
+ *
+ * Indirect CRLs, where the issuer of an entry depends on the entries before
+ * it, are decoded in full. Before an indexed CRL is modified, all of its
+ * entries are decoded into the revoked stack, see x509_crl_materialize().
+ *
+ * The encoding and the hash table are not changed after the CRL has been
+ * created and are kept until it is freed, so they can be read without a
+ * lock. The decoded entries and the flags are protected by
+ * CRYPTO_LOCK_X509_CRL.
+ */
+
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <openssl/asn1.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "asn1_local.h"
+#include "bytestring.h"
+#include "x509_local.h"
+
+struct x509_crl_slot {
+	uint32_t hash;
+	uint32_t offset;		/* Offset of the entry, 0 if unused. */
+};
+
+struct x509_crl_index {
+	uint8_t *data;
+	size_t data_len;
+
+	/* The CertificateList, its TBSCertList and revoked entries. */
+	size_t crl_len;
+	size_t tbs_offset;
+	size_t tbs_len;
+	size_t revoked_offset;
+	size_t revoked_len;
+
+	struct x509_crl_slot *slots;
+	size_t nslots;			/* Power of two. */
+
+	/* Entries decoded by lookups, freed with the CRL. */
+	STACK_OF(X509_REVOKED) *decoded;
+
+	/* All entries have been decoded into the revoked stack. */
+	int materialized;
+	/* The cached TBSCertList encoding is the original one. */
+	int tbs_restored;
+};
+
+/* id-ce-cRLReasons and id-ce-certificateIssuer. */
+static const uint8_t crl_reason_oid[] = { 0x55, 0x1d, 0x15 };
+static const uint8_t certificate_issuer_oid[] = { 0x55, 0x1d, 0x1d };
+
+void
+x509_crl_index_free(struct x509_crl_index *index)
+{
+	if (index == NULL)
+		return;
+
+	free(index->data);
+	free(index->slots);
+	sk_X509_REVOKED_pop_free(index->decoded, X509_REVOKED_free);
+	free(index);
+}
+
+static uint32_t
+x509_crl_serial_hash(const CBS *serial)
+{
+	const uint8_t *p = CBS_data(serial);
+	uint32_t hash = 2166136261U;
+	size_t i;
+
+	/* FNV-1a. */
+	for (i = 0; i < CBS_len(serial); i++) {
+		hash ^= p[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/*
+ * Serial numbers are compared by their encoding, which needs to be minimal
+ * for this to match ASN1_INTEGER_cmp(). See X.690, section 8.3.2.
+ */
+static int
+x509_crl_serial_minimal(const CBS *serial)
+{
+	const uint8_t *p = CBS_data(serial);
+
+	if (CBS_len(serial) == 0)
+		return 0;
+	if (CBS_len(serial) == 1)
+		return 1;
+	if (p[0] == 0x00 && (p[1] & 0x80) == 0)
+		return 0;
+	if (p[0] == 0xff && (p[1] & 0x80) != 0)
+		return 0;
+
+	return 1;
+}
+
+/*
+ * Check the extensions of a revoked entry the same way that decoding the
+ * CRL in full would, accumulating the result in flags. Returns 0 if the
+ * CRL needs to be decoded in full.
+ */
+static int
+x509_crl_index_check_extensions(CBS *extensions, int *flags)
+{
+	CBS extension, oid, critical, value, reason;
+	int nreasons = 0;
+
+	while (CBS_len(extensions) > 0) {
+		if (!CBS_get_asn1(extensions, &extension, CBS_ASN1_SEQUENCE))
+			return 0;
+		if (!CBS_get_asn1(&extension, &oid, CBS_ASN1_OBJECT))
+			return 0;
+		CBS_init(&critical, NULL, 0);
+		if (CBS_peek_asn1_tag(&extension, CBS_ASN1_BOOLEAN)) {
+			if (!CBS_get_asn1(&extension, &critical,
+			    CBS_ASN1_BOOLEAN))
+				return 0;
+			if (CBS_len(&critical) != 1)
+				return 0;
+		}
+		if (!CBS_get_asn1(&extension, &value, CBS_ASN1_OCTETSTRING))
+			return 0;
+		if (CBS_len(&extension) != 0)
+			return 0;
+
+		if (CBS_mem_equal(&oid, certificate_issuer_oid,
+		    sizeof(certificate_issuer_oid)))
+			return 0;
+
+		if (CBS_len(&critical) == 1 && CBS_data(&critical)[0] != 0)
+			*flags |= EXFLAG_CRITICAL;
+
+		if (CBS_mem_equal(&oid, crl_reason_oid,
+		    sizeof(crl_reason_oid))) {
+			nreasons++;
+			if (!CBS_get_asn1(&value, &reason, CBS_ASN1_ENUMERATED) ||
+			    CBS_len(&reason) == 0 || CBS_len(&value) != 0)
+				*flags |= EXFLAG_INVALID;
+		}
+	}
+
+	if (nreasons > 1)
+		*flags |= EXFLAG_INVALID;
+
+	return 1;
+}
+
+/*
+ * Parse a single revoked entry, returning its serial number. Returns 0 if
+ * the CRL needs to be decoded in full.
+ */
+static int
+x509_crl_index_parse_entry(CBS *revoked, CBS *out_serial, int *flags)
+{
+	CBS entry, serial, extensions;
+
+	if (!CBS_get_asn1(revoked, &entry, CBS_ASN1_SEQUENCE))
+		return 0;
+	if (!CBS_get_asn1(&entry, &serial, CBS_ASN1_INTEGER))
+		return 0;
+	if (!x509_crl_serial_minimal(&serial))
+		return 0;
+	if (!CBS_get_any_asn1_element(&entry, NULL, NULL, NULL))
+		return 0;
+	if (CBS_len(&entry) > 0) {
+		if (!CBS_get_asn1(&entry, &extensions, CBS_ASN1_SEQUENCE))
+			return 0;
+		if (CBS_len(&entry) != 0)
+			return 0;
+		if (flags != NULL &&
+		    !x509_crl_index_check_extensions(&extensions, flags))
+			return 0;
+	}
+
+	*out_serial = serial;
+
+	return 1;
+}
+
+static int
+x509_crl_index_build(struct x509_crl_index *index, CBS *revoked, int *flags)
+{
+	CBS entries, serial;
+	const uint8_t *entry;
+	uint32_t hash;
+	size_t nentries = 0, nslots, i;
+
+	CBS_dup(revoked, &entries);
+	while (CBS_len(&entries) > 0) {
+		if (!x509_crl_index_parse_entry(&entries, &serial, flags))
+			return 0;
+		nentries++;
+	}
+
+	/* Keep the load factor at or below one half. */
+	for (nslots = 16; nslots < 2 * nentries; nslots <<= 1) {
+		if (nslots > SIZE_MAX / 4 / sizeof(*index->slots))
+			return 0;
+	}
+	if ((index->slots = calloc(nslots, sizeof(*index->slots))) == NULL)
+		return 0;
+	index->nslots = nslots;
+
+	CBS_dup(revoked, &entries);
+	while (CBS_len(&entries) > 0) {
+		entry = CBS_data(&entries);
+		if (!x509_crl_index_parse_entry(&entries, &serial, NULL))
+			return 0;
+		hash = x509_crl_serial_hash(&serial);
+		for (i = hash & (nslots - 1); index->slots[i].offset != 0;
+		    i = (i + 1) & (nslots - 1))
+			;
+		index->slots[i].hash = hash;
+		index->slots[i].offset = entry - index->data;
+	}
+
+	return 1;
+}
+
+/*
+ * Take ownership of data and create a CRL from it. If the revoked entries
+ * cannot be indexed, the CRL is decoded in full.
+ */
+X509_CRL *
+x509_crl_new_indexed(uint8_t *data, size_t data_len)
+{
+	struct x509_crl_index *index;
+	CBS cbs, cert_list_der, crl, tbs, tbs_content, revoked, signature;
+	CBB cbb, cert_list, tbs_list;
+	const uint8_t *tbs_start;
+	size_t prefix_len;
+	uint8_t *stripped = NULL;
+	size_t stripped_len = 0;
+	const unsigned char *p;
+	X509_CRL *x = NULL;
+	int flags = 0;
+
+	memset(&cbb, 0, sizeof(cbb));
+
+	if ((index = calloc(1, sizeof(*index))) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		free(data);
+		return NULL;
+	}
+	index->data = data;
+	index->data_len = data_len;
+
+	if (data_len > INT_MAX)
+		goto decode;
+
+	CBS_init(&cbs, data, data_len);
+	if (!CBS_get_asn1_element(&cbs, &cert_list_der, CBS_ASN1_SEQUENCE))
+		goto decode;
+	index->crl_len = CBS_len(&cert_list_der);
+	if (!CBS_get_asn1(&cert_list_der, &crl, CBS_ASN1_SEQUENCE))
+		goto decode;
+	if (!CBS_get_asn1_element(&crl, &tbs, CBS_ASN1_SEQUENCE))
+		goto decode;
+	index->tbs_offset = CBS_data(&tbs) - data;
+	index->tbs_len = CBS_len(&tbs);
+	CBS_dup(&crl, &signature);
+
+	/*
+	 * Skip the version, signature, issuer, thisUpdate and nextUpdate
+	 * fields to find the revokedCertificates.
+	 */
+	if (!CBS_get_asn1(&tbs, &tbs_content, CBS_ASN1_SEQUENCE))
+		goto decode;
+	tbs_start = CBS_data(&tbs_content);
+	if (CBS_peek_asn1_tag(&tbs_content, CBS_ASN1_INTEGER)) {
+		if (!CBS_get_any_asn1_element(&tbs_content, NULL, NULL, NULL))
+			goto decode;
+	}
+	if (!CBS_get_asn1(&tbs_content, NULL, CBS_ASN1_SEQUENCE))
+		goto decode;
+	if (!CBS_get_asn1(&tbs_content, NULL, CBS_ASN1_SEQUENCE))
+		goto decode;
+	if (!CBS_get_any_asn1_element(&tbs_content, NULL, NULL, NULL))
+		goto decode;
+	if (CBS_peek_asn1_tag(&tbs_content, V_ASN1_UTCTIME) ||
+	    CBS_peek_asn1_tag(&tbs_content, V_ASN1_GENERALIZEDTIME)) {
+		if (!CBS_get_any_asn1_element(&tbs_content, NULL, NULL, NULL))
+			goto decode;
+	}
+	prefix_len = CBS_data(&tbs_content) - tbs_start;
+	if (!CBS_peek_asn1_tag(&tbs_content, CBS_ASN1_SEQUENCE))
+		goto decode;
+	if (!CBS_get_asn1(&tbs_content, &revoked, CBS_ASN1_SEQUENCE))
+		goto decode;
+	index->revoked_offset = CBS_data(&revoked) - data;
+	index->revoked_len = CBS_len(&revoked);
+
+	if (!x509_crl_index_build(index, &revoked, &flags))
+		goto decode;
+
+	/* Decode the CRL without its revoked entries. */
+	if (!CBB_init(&cbb, 0))
+		goto err;
+	if (!CBB_add_asn1(&cbb, &cert_list, CBS_ASN1_SEQUENCE))
+		goto err;
+	if (!CBB_add_asn1(&cert_list, &tbs_list, CBS_ASN1_SEQUENCE))
+		goto err;
+	if (!CBB_add_bytes(&tbs_list, tbs_start, prefix_len))
+		goto err;
+	if (!CBB_add_bytes(&tbs_list, CBS_data(&tbs_content),
+	    CBS_len(&tbs_content)))
+		goto err;
+	if (!CBB_add_bytes(&cert_list, CBS_data(&signature),
+	    CBS_len(&signature)))
+		goto err;
+	if (!CBB_finish(&cbb, &stripped, &stripped_len))
+		goto err;
+	if (stripped_len > LONG_MAX)
+		goto err;
+
+	p = stripped;
+	if ((x = d2i_X509_CRL(NULL, &p, stripped_len)) == NULL)
+		goto err;
+	x->flags |= flags;
+
+	/* The hash identifies the CRL as received, see X509_CRL_match(). */
+	if (!EVP_Digest(index->data, index->crl_len, x->hash, NULL,
+	    X509_CRL_HASH_EVP, NULL))
+		goto err;
+
+	x->index = index;
+	index = NULL;
+
+	CBB_cleanup(&cbb);
+	free(stripped);
+
+	return x;
+
+ err:
+	CBB_cleanup(&cbb);
+	free(stripped);
+	X509_CRL_free(x);
+	x509_crl_index_free(index);
+
+	return NULL;
+
+ decode:
+	p = index->data;
+	x = d2i_X509_CRL(NULL, &p, index->data_len > LONG_MAX ?
+	    LONG_MAX : index->data_len);
+	x509_crl_index_free(index);
+
+	return x;
+}
+
+/*
+ * Look up serial in the index of crl and set *out_rev to the entry, or to NULL
+ * if there is none. Returns 0 if all entries have been decoded into the
+ * revoked stack, which then needs to be searched instead.
+ */
+int
+x509_crl_index_lookup(X509_CRL *crl, const ASN1_INTEGER *serial,
+    X509_REVOKED **out_rev)
+{
+	struct x509_crl_index *index = crl->index;
+	X509_REVOKED *decoded;
+	CBS cbs, entry_serial, query;
+	const unsigned char *p;
+	uint8_t *der = NULL, *q;
+	uint32_t hash;
+	size_t i;
+	int der_len, j, materialized;
+	int ret = 1;
+
+	*out_rev = NULL;
+
+	CRYPTO_r_lock(CRYPTO_LOCK_X509_CRL);
+	materialized = index->materialized;
+	CRYPTO_r_unlock(CRYPTO_LOCK_X509_CRL);
+	if (materialized)
+		return 0;
+
+	if ((der_len = i2c_ASN1_INTEGER((ASN1_INTEGER *)serial, NULL)) <= 0)
+		goto err;
+	if ((der = malloc(der_len)) == NULL)
+		goto err;
+	q = der;
+	if (i2c_ASN1_INTEGER((ASN1_INTEGER *)serial, &q) != der_len)
+		goto err;
+	CBS_init(&query, der, der_len);
+
+	hash = x509_crl_serial_hash(&query);
+	for (i = hash & (index->nslots - 1); index->slots[i].offset != 0;
+	    i = (i + 1) & (index->nslots - 1)) {
+		if (index->slots[i].hash != hash)
+			continue;
+		CBS_init(&cbs, index->data + index->slots[i].offset,
+		    index->data_len - index->slots[i].offset);
+		if (!x509_crl_index_parse_entry(&cbs, &entry_serial, NULL))
+			goto err;
+		if (CBS_mem_equal(&entry_serial, der, der_len))
+			break;
+	}
+	if (index->slots[i].offset == 0)
+		goto err;
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_CRL);
+	if (index->materialized) {
+		ret = 0;
+		goto done;
+	}
+	for (j = 0; j < sk_X509_REVOKED_num(index->decoded); j++) {
+		decoded = sk_X509_REVOKED_value(index->decoded, j);
+		if (ASN1_INTEGER_cmp(decoded->serialNumber, serial) == 0) {
+			*out_rev = decoded;
+			goto done;
+		}
+	}
+	if (index->decoded == NULL) {
+		if ((index->decoded = sk_X509_REVOKED_new_null()) == NULL)
+			goto done;
+	}
+	p = index->data + index->slots[i].offset;
+	if ((decoded = d2i_X509_REVOKED(NULL, &p,
+	    index->data_len - index->slots[i].offset)) == NULL)
+		goto done;
+	if (!x509_revoked_set_reason(decoded) ||
+	    sk_X509_REVOKED_push(index->decoded, decoded) <= 0) {
+		X509_REVOKED_free(decoded);
+		goto done;
+	}
+	*out_rev = decoded;
+
+ done:
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509_CRL);
+
+ err:
+	free(der);
+
+	return ret;
+}
+
+int
+x509_crl_index_verify(X509_CRL *crl, EVP_PKEY *pkey)
+{
+	struct x509_crl_index *index = crl->index;
+
+	if (pkey == NULL) {
+		ASN1error(ERR_R_PASSED_NULL_PARAMETER);
+		return -1;
+	}
+
+	return asn1_item_verify_encoded(&X509_CRL_INFO_it, crl->sig_alg,
+	    crl->signature, crl->crl, index->data + index->tbs_offset,
+	    index->tbs_len, pkey);
+}
+
+int
+x509_crl_index_i2d(X509_CRL *crl, unsigned char **out)
+{
+	struct x509_crl_index *index = crl->index;
+	unsigned char *der;
+
+	if (out == NULL)
+		return index->crl_len;
+
+	if (*out == NULL) {
+		if ((der = malloc(index->crl_len)) == NULL) {
+			ASN1error(ERR_R_MALLOC_FAILURE);
+			return -1;
+		}
+		memcpy(der, index->data, index->crl_len);
+		*out = der;
+		return index->crl_len;
+	}
+
+	memcpy(*out, index->data, index->crl_len);
+	*out += index->crl_len;
+
+	return index->crl_len;
+}
+
+int
+x509_crl_index_digest(const X509_CRL *crl, const EVP_MD *md,
+    unsigned char *out, unsigned int *out_len)
+{
+	struct x509_crl_index *index = crl->index;
+
+	return EVP_Digest(index->data, index->crl_len, out, out_len, md, NULL);
+}
+
+X509_CRL *
+x509_crl_index_dup(X509_CRL *crl)
+{
+	struct x509_crl_index *index = crl->index;
+	uint8_t *data;
+
+	if ((data = malloc(index->crl_len)) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		return NULL;
+	}
+	memcpy(data, index->data, index->crl_len);
+
+	return x509_crl_new_indexed(data, index->crl_len);
+}
+
+static int
+x509_crl_index_revoked_cmp(const X509_REVOKED * const *a,
+    const X509_REVOKED * const *b)
+{
+	return ASN1_INTEGER_cmp((*a)->serialNumber, (*b)->serialNumber);
+}
+
+/*
+ * The X509_CRL is decoded without the revoked entries, so the cached encoding
+ * of its TBSCertList lacks them. Replace it with the original encoding,
+ * unless the CRL has been modified. Called with CRYPTO_LOCK_X509_CRL held.
+ */
+static int
+x509_crl_index_restore_tbs_locked(X509_CRL *crl)
+{
+	struct x509_crl_index *index = crl->index;
+	unsigned char *tbs;
+
+	if (index->tbs_restored || crl->crl->enc.modified)
+		return 1;
+
+	if ((tbs = malloc(index->tbs_len)) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+	memcpy(tbs, index->data + index->tbs_offset, index->tbs_len);
+	free(crl->crl->enc.enc);
+	crl->crl->enc.enc = tbs;
+	crl->crl->enc.len = index->tbs_len;
+	index->tbs_restored = 1;
+
+	return 1;
+}
+
+/*
+ * Called before the CRL is encoded by the ASN.1 encoder, so that encoding it
+ * on its own or as part of another structure yields the original encoding.
+ */
+int
+x509_crl_index_restore_tbs(X509_CRL *crl)
+{
+	int ret;
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_CRL);
+	ret = x509_crl_index_restore_tbs_locked(crl);
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509_CRL);
+
+	return ret;
+}
+
+/*
+ * Decode all revoked entries into the revoked stack, in the order of the
+ * encoding. Entries that lookups have already returned are moved there, so
+ * that pointers from X509_CRL_get0_by_serial() stay valid. The index is kept,
+ * since other threads may still be using it, but lookups no longer use it.
+ */
+int
+x509_crl_index_materialize(X509_CRL *crl)
+{
+	struct x509_crl_index *index = crl->index;
+	STACK_OF(X509_REVOKED) *revoked = NULL;
+	X509_REVOKED *rev, *decoded;
+	CBS entries, serial;
+	const unsigned char *p;
+	int i, idx;
+	int ret = 0;
+
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_CRL);
+
+	if (index->materialized) {
+		ret = 1;
+		goto err;
+	}
+
+	if ((revoked = sk_X509_REVOKED_new(x509_crl_index_revoked_cmp)) ==
+	    NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		goto err;
+	}
+
+	if (index->decoded != NULL) {
+		(void)sk_X509_REVOKED_set_cmp_func(index->decoded,
+		    x509_crl_index_revoked_cmp);
+		sk_X509_REVOKED_sort(index->decoded);
+	}
+
+	CBS_init(&entries, index->data + index->revoked_offset,
+	    index->revoked_len);
+	while (CBS_len(&entries) > 0) {
+		p = CBS_data(&entries);
+		if (!x509_crl_index_parse_entry(&entries, &serial, NULL))
+			goto err;
+		if ((rev = d2i_X509_REVOKED(NULL, &p,
+		    CBS_data(&entries) - p)) == NULL)
+			goto err;
+		if (!x509_revoked_set_reason(rev)) {
+			X509_REVOKED_free(rev);
+			goto err;
+		}
+		if (sk_X509_REVOKED_push(revoked, rev) <= 0) {
+			X509error(ERR_R_MALLOC_FAILURE);
+			X509_REVOKED_free(rev);
+			goto err;
+		}
+	}
+
+	if (!x509_crl_index_restore_tbs_locked(crl))
+		goto err;
+
+	/* Nothing can fail from here on. */
+	for (i = 0; i < sk_X509_REVOKED_num(revoked); i++) {
+		rev = sk_X509_REVOKED_value(revoked, i);
+		if ((idx = sk_X509_REVOKED_find(index->decoded, rev)) < 0)
+			continue;
+		decoded = sk_X509_REVOKED_delete(index->decoded, idx);
+		(void)sk_X509_REVOKED_set(revoked, i, decoded);
+		X509_REVOKED_free(rev);
+	}
+
+	sk_X509_REVOKED_pop_free(crl->crl->revoked, X509_REVOKED_free);
+	crl->crl->revoked = revoked;
+	revoked = NULL;
+	index->materialized = 1;
+
+	ret = 1;
+
+ err:
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509_CRL);
+	sk_X509_REVOKED_pop_free(revoked, X509_REVOKED_free);
+
+	return ret;
+}
+
+X509_CRL *
+X509_CRL_new_indexed(const unsigned char *der, size_t der_len)
+{
+	uint8_t *data;
+
+	if (der == NULL || der_len == 0) {
+		X509error(ERR_R_PASSED_NULL_PARAMETER);
+		return NULL;
+	}
+	if ((data = malloc(der_len)) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		return NULL;
+	}
+	memcpy(data, der, der_len);
+
+	return x509_crl_new_indexed(data, der_len);
+}
+LCRYPTO_ALIAS(X509_CRL_new_indexed);
+
+static X509_CRL *
+x509_crl_load_pem_indexed(const uint8_t *pem, size_t pem_len)
+{
+	BIO *bio;
+	char *name = NULL, *header = NULL;
+	unsigned char *data = NULL;
+	long data_len;
+	X509_CRL *crl = NULL;
+
+	if (pem_len > INT_MAX) {
+		X509error(X509_R_NO_CERTIFICATE_OR_CRL_FOUND);
+		return NULL;
+	}
+	if ((bio = BIO_new_mem_buf(pem, pem_len)) == NULL)
+		return NULL;
+
+	while (PEM_read_bio(bio, &name, &header, &data, &data_len)) {
+		if (strcmp(name, PEM_STRING_X509_CRL) == 0) {
+			crl = x509_crl_new_indexed(data, data_len);
+			data = NULL;
+			break;
+		}
+		free(name);
+		free(header);
+		free(data);
+		name = header = NULL;
+		data = NULL;
+	}
+
+	free(name);
+	free(header);
+	free(data);
+	BIO_free(bio);
+
+	return crl;
+}
+
+X509_CRL *
+X509_CRL_load_indexed(const char *filename)
+{
+	struct stat sb;
+	uint8_t *data = NULL;
+	size_t data_len = 0;
+	ssize_t n;
+	X509_CRL *crl = NULL;
+	int fd;
+
+	if ((fd = open(filename, O_RDONLY)) == -1) {
+		SYSerror(errno);
+		return NULL;
+	}
+	if (fstat(fd, &sb) == -1) {
+		SYSerror(errno);
+		goto err;
+	}
+	if (sb.st_size <= 0 || (uintmax_t)sb.st_size > SIZE_MAX) {
+		X509error(X509_R_NO_CERTIFICATE_OR_CRL_FOUND);
+		goto err;
+	}
+
+	/*
+	 * The file is read rather than mapped, so that it can be replaced or
+	 * truncated while the CRL is in use.
+	 */
+	if ((data = malloc(sb.st_size)) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		goto err;
+	}
+	while (data_len < (size_t)sb.st_size) {
+		if ((n = read(fd, data + data_len,
+		    sb.st_size - data_len)) == -1) {
+			if (errno == EINTR)
+				continue;
+			SYSerror(errno);
+			goto err;
+		}
+		if (n == 0)
+			break;
+		data_len += n;
+	}
+	if (data_len == 0) {
+		X509error(X509_R_NO_CERTIFICATE_OR_CRL_FOUND);
+		goto err;
+	}
+
+	if (data[0] == CBS_ASN1_SEQUENCE) {
+		/* DER, the data is owned by the CRL from here on. */
+		crl = x509_crl_new_indexed(data, data_len);
+		data = NULL;
+	} else
+		crl = x509_crl_load_pem_indexed(data, data_len);
+
+ err:
+	free(data);
+	close(fd);
+
+	return crl;
+}
+LCRYPTO_ALIAS(X509_CRL_load_indexed);
@@ -101,6 +101,8 @@ LCRYPTO_ALIAS(X509_CRL_get_ext);
 X509_EXTENSION *
 X509_CRL_delete_ext(X509_CRL *x, int loc)
 {
+	if (!x509_crl_materialize(x))
+		return NULL;
 	return X509v3_delete_ext(x->crl->extensions, loc);
 }
 LCRYPTO_ALIAS(X509_CRL_delete_ext);
@@ -116,6 +118,8 @@ int
 X509_CRL_add1_ext_i2d(X509_CRL *x, int nid, void *value, int crit,
     unsigned long flags)
 {
+	if (!x509_crl_materialize(x))
+		return 0;
 	return X509V3_add1_i2d(&x->crl->extensions, nid, value, crit, flags);
 }
 LCRYPTO_ALIAS(X509_CRL_add1_ext_i2d);
@@ -123,6 +127,8 @@ LCRYPTO_ALIAS(X509_CRL_add1_ext_i2d);
 int
 X509_CRL_add_ext(X509_CRL *x, X509_EXTENSION *ex, int loc)
 {
+	if (!x509_crl_materialize(x))
+		return 0;
 	return X509v3_add_ext(&x->crl->extensions, ex, loc) != NULL;
 }
 LCRYPTO_ALIAS(X509_CRL_add_ext);
@@ -130,6 +136,7 @@ LCRYPTO_ALIAS(X509_CRL_add_ext);
 int
 X509_get_ext_count(const X509 *x)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return X509v3_get_ext_count(x->cert_info->extensions);
 }
 LCRYPTO_ALIAS(X509_get_ext_count);
@@ -137,6 +144,7 @@ LCRYPTO_ALIAS(X509_get_ext_count);
 int
 X509_get_ext_by_NID(const X509 *x, int nid, int lastpos)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return X509v3_get_ext_by_NID(x->cert_info->extensions, nid, lastpos);
 }
 LCRYPTO_ALIAS(X509_get_ext_by_NID);
@@ -144,6 +152,7 @@ LCRYPTO_ALIAS(X509_get_ext_by_NID);
 int
 X509_get_ext_by_OBJ(const X509 *x, const ASN1_OBJECT *obj, int lastpos)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return X509v3_get_ext_by_OBJ(x->cert_info->extensions, obj, lastpos);
 }
 LCRYPTO_ALIAS(X509_get_ext_by_OBJ);
@@ -151,6 +160,7 @@ LCRYPTO_ALIAS(X509_get_ext_by_OBJ);
 int
 X509_get_ext_by_critical(const X509 *x, int crit, int lastpos)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return X509v3_get_ext_by_critical(x->cert_info->extensions, crit,
 	    lastpos);
 }
@@ -159,6 +169,7 @@ LCRYPTO_ALIAS(X509_get_ext_by_critical);
 X509_EXTENSION *
 X509_get_ext(const X509 *x, int loc)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return X509v3_get_ext(x->cert_info->extensions, loc);
 }
 LCRYPTO_ALIAS(X509_get_ext);
@@ -166,6 +177,8 @@ LCRYPTO_ALIAS(X509_get_ext);
 X509_EXTENSION *
 X509_delete_ext(X509 *x, int loc)
 {
+	if (!x509_cinf_decode_extensions(x->cert_info))
+		return NULL;
 	return X509v3_delete_ext(x->cert_info->extensions, loc);
 }
 LCRYPTO_ALIAS(X509_delete_ext);
@@ -173,6 +186,8 @@ LCRYPTO_ALIAS(X509_delete_ext);
 int
 X509_add_ext(X509 *x, X509_EXTENSION *ex, int loc)
 {
+	if (!x509_cinf_decode_extensions(x->cert_info))
+		return 0;
 	return X509v3_add_ext(&x->cert_info->extensions, ex, loc) != NULL;
 }
 LCRYPTO_ALIAS(X509_add_ext);
@@ -180,6 +195,7 @@ LCRYPTO_ALIAS(X509_add_ext);
 void *
 X509_get_ext_d2i(const X509 *x, int nid, int *crit, int *idx)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return X509V3_get_d2i(x->cert_info->extensions, nid, crit, idx);
 }
 LCRYPTO_ALIAS(X509_get_ext_d2i);
@@ -187,6 +203,8 @@ LCRYPTO_ALIAS(X509_get_ext_d2i);
 int
 X509_add1_ext_i2d(X509 *x, int nid, void *value, int crit, unsigned long flags)
 {
+	if (!x509_cinf_decode_extensions(x->cert_info))
+		return 0;
 	return X509V3_add1_i2d(&x->cert_info->extensions, nid, value, crit,
 	    flags);
 }
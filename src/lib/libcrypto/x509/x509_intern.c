@@ -0,0 +1,316 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * The intern table maps the digest of a certificate's DER encoding to a
+ * single shared X509, so that identical certificates loaded into many
+ * stores and contexts are only kept in memory once. The table holds a
+ * reference to every interned certificate. Certificates that are no
+ * longer referenced by anything but the table are swept out when a
+ * shard grows, or when x509_intern_flush() is called.
+ *
+ * The table is split into X509_INTERN_SHARDS independently locked shards,
+ * each of which is a chained hash table indexed by a truncated digest.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/x509.h>
+
+#include "x509_local.h"
+
+#define X509_INTERN_SHARDS	16	/* Must be a power of two. */
+#define X509_INTERN_MIN_BUCKETS	16	/* Must be a power of two. */
+#define X509_INTERN_MIN_SWEEP	64
+
+struct x509_intern_entry {
+	struct x509_intern_entry *next;	/* Hash bucket chain. */
+	uint64_t tag;			/* Truncated digest. */
+	unsigned char md[X509_CERT_HASH_LEN];
+	X509 *x509;
+};
+
+struct x509_intern_shard {
+	pthread_mutex_t mutex;
+	struct x509_intern_entry **buckets;
+	size_t nbuckets;		/* Power of two. */
+	size_t count;
+	size_t sweep_count;		/* Sweep when count reaches this. */
+};
+
+#define X509_INTERN_SHARD_INITIALIZER {					\
+	.mutex = PTHREAD_MUTEX_INITIALIZER,				\
+	.sweep_count = X509_INTERN_MIN_SWEEP,				\
+}
+
+static struct x509_intern_shard x509_intern_shards[X509_INTERN_SHARDS] = {
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+	X509_INTERN_SHARD_INITIALIZER, X509_INTERN_SHARD_INITIALIZER,
+};
+
+static struct x509_intern_shard *
+x509_intern_shard(uint64_t tag)
+{
+	return &x509_intern_shards[tag & (X509_INTERN_SHARDS - 1)];
+}
+
+static size_t
+x509_intern_bucket(size_t nbuckets, uint64_t tag)
+{
+	return (tag / X509_INTERN_SHARDS) & (nbuckets - 1);
+}
+
+static void
+x509_intern_entries_free(struct x509_intern_entry *entry)
+{
+	struct x509_intern_entry *next;
+
+	for (; entry != NULL; entry = next) {
+		next = entry->next;
+		X509_free(entry->x509);
+		free(entry);
+	}
+}
+
+/*
+ * Look up an entry in a shard. Must be called with the shard
+ * mutex held.
+ */
+static struct x509_intern_entry *
+x509_intern_shard_find(struct x509_intern_shard *shard, uint64_t tag,
+    const unsigned char *md)
+{
+	struct x509_intern_entry *entry;
+
+	if (shard->buckets == NULL)
+		return NULL;
+
+	entry = shard->buckets[x509_intern_bucket(shard->nbuckets, tag)];
+	for (; entry != NULL; entry = entry->next) {
+		if (entry->tag != tag)
+			continue;
+		if (memcmp(entry->md, md, sizeof(entry->md)) != 0)
+			continue;
+		return entry;
+	}
+
+	return NULL;
+}
+
+/*
+ * Unlink all entries whose certificate is only referenced by the table.
+ * No new reference can be obtained without holding the shard mutex, so
+ * these may safely be freed once it is released. Returns the unlinked
+ * entries. Must be called with the shard mutex held.
+ */
+static struct x509_intern_entry *
+x509_intern_shard_sweep(struct x509_intern_shard *shard)
+{
+	struct x509_intern_entry *dead = NULL, *entry, **prev;
+	size_t i;
+
+	for (i = 0; i < shard->nbuckets; i++) {
+		prev = &shard->buckets[i];
+		while ((entry = *prev) != NULL) {
+			if (CRYPTO_add(&entry->x509->references, 0,
+			    CRYPTO_LOCK_X509) > 1) {
+				prev = &entry->next;
+				continue;
+			}
+			*prev = entry->next;
+			entry->next = dead;
+			dead = entry;
+			shard->count--;
+		}
+	}
+
+	return dead;
+}
+
+/*
+ * Ensure that a shard has room for one more entry without exceeding a
+ * load factor of one. Must be called with the shard mutex held.
+ */
+static int
+x509_intern_shard_grow(struct x509_intern_shard *shard)
+{
+	struct x509_intern_entry **buckets, *entry, *next;
+	size_t nbuckets, i;
+
+	if (shard->count < shard->nbuckets)
+		return 1;
+
+	if ((nbuckets = shard->nbuckets * 2) == 0)
+		nbuckets = X509_INTERN_MIN_BUCKETS;
+	if ((buckets = calloc(nbuckets, sizeof(*buckets))) == NULL)
+		return 0;
+
+	for (i = 0; i < shard->nbuckets; i++) {
+		for (entry = shard->buckets[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			entry->next =
+			    buckets[x509_intern_bucket(nbuckets, entry->tag)];
+			buckets[x509_intern_bucket(nbuckets, entry->tag)] =
+			    entry;
+		}
+	}
+
+	free(shard->buckets);
+	shard->buckets = buckets;
+	shard->nbuckets = nbuckets;
+
+	return 1;
+}
+
+/*
+ * Return the shared instance of a certificate. Ownership of the reference
+ * to x is passed in, and a reference to the returned certificate is passed
+ * back out - if an identical certificate is already interned, x is freed
+ * and the interned certificate is returned instead. Certificates carrying
+ * auxiliary trust information are never interned. If interning fails for
+ * any other reason, x is returned as is.
+ */
+X509 *
+X509_intern(X509 *x)
+{
+	struct x509_intern_shard *shard;
+	struct x509_intern_entry *entry, *dead = NULL;
+	unsigned char md[X509_CERT_HASH_LEN];
+	X509 *found = NULL;
+	uint64_t tag;
+
+	if (x == NULL)
+		return NULL;
+	if (x->aux != NULL)
+		return x;
+	if (!X509_digest(x, X509_CERT_HASH_EVP, md, NULL))
+		return x;
+
+	/* The digest is cryptographic, so any 64 bits are as good as any. */
+	memcpy(&tag, md, sizeof(tag));
+	shard = x509_intern_shard(tag);
+
+	if (pthread_mutex_lock(&shard->mutex) != 0)
+		return x;
+
+	if ((entry = x509_intern_shard_find(shard, tag, md)) != NULL) {
+		if (X509_up_ref(entry->x509))
+			found = entry->x509;
+		goto done;
+	}
+
+	if (shard->count >= shard->sweep_count) {
+		dead = x509_intern_shard_sweep(shard);
+		shard->sweep_count = shard->count * 2;
+		if (shard->sweep_count < X509_INTERN_MIN_SWEEP)
+			shard->sweep_count = X509_INTERN_MIN_SWEEP;
+	}
+
+	if (!x509_intern_shard_grow(shard))
+		goto done;
+	if ((entry = calloc(1, sizeof(*entry))) == NULL)
+		goto done;
+	if (!X509_up_ref(x)) {
+		free(entry);
+		goto done;
+	}
+	entry->tag = tag;
+	memcpy(entry->md, md, sizeof(entry->md));
+	entry->x509 = x;
+	entry->next = shard->buckets[x509_intern_bucket(shard->nbuckets, tag)];
+	shard->buckets[x509_intern_bucket(shard->nbuckets, tag)] = entry;
+	shard->count++;
+
+ done:
+	(void) pthread_mutex_unlock(&shard->mutex);
+
+	x509_intern_entries_free(dead);
+
+	if (found != NULL) {
+		X509_free(x);
+		return found;
+	}
+
+	return x;
+}
+LCRYPTO_ALIAS(X509_intern);
+
+/*
+ * Drop the table's references to all interned certificates. Certificates
+ * that are still referenced elsewhere remain valid, but are no longer shared
+ * with certificates interned subsequently.
+ */
+void
+x509_intern_flush(void)
+{
+	struct x509_intern_shard *shard;
+	struct x509_intern_entry *dead, *entry, *next;
+	size_t i, j;
+
+	for (i = 0; i < X509_INTERN_SHARDS; i++) {
+		shard = &x509_intern_shards[i];
+		if (pthread_mutex_lock(&shard->mutex) != 0)
+			continue;
+		dead = NULL;
+		for (j = 0; j < shard->nbuckets; j++) {
+			for (entry = shard->buckets[j]; entry != NULL;
+			    entry = next) {
+				next = entry->next;
+				entry->next = dead;
+				dead = entry;
+			}
+		}
+		free(shard->buckets);
+		shard->buckets = NULL;
+		shard->nbuckets = 0;
+		shard->count = 0;
+		shard->sweep_count = X509_INTERN_MIN_SWEEP;
+		(void) pthread_mutex_unlock(&shard->mutex);
+
+		x509_intern_entries_free(dead);
+	}
+}
+
+/*
+ * Report the number of certificates currently held by the table.
+ */
+size_t
+x509_intern_count(void)
+{
+	struct x509_intern_shard *shard;
+	size_t i, count = 0;
+
+	for (i = 0; i < X509_INTERN_SHARDS; i++) {
+		shard = &x509_intern_shards[i];
+		if (pthread_mutex_lock(&shard->mutex) != 0)
+			continue;
+		count += shard->count;
+		(void) pthread_mutex_unlock(&shard->mutex);
+	}
+
+	return count;
+}
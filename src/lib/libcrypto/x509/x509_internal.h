@@ -132,6 +132,15 @@ int x509_constraints_validate(GENERAL_NAME *constraint,
 int x509_constraints_check(struct x509_constraints_names *names,
     struct x509_constraints_names *permitted,
     struct x509_constraints_names *excluded, int *error);
+struct x509_constraints_compiled *x509_constraints_compile(
+    struct x509_constraints_names *permitted,
+    struct x509_constraints_names *excluded);
+size_t x509_constraints_compiled_count(
+    const struct x509_constraints_compiled *cc);
+int x509_constraints_get_compiled(X509 *cert,
+    const struct x509_constraints_compiled **out_cc, int *error);
+int x509_constraints_check_compiled(struct x509_constraints_names *names,
+    const struct x509_constraints_compiled *cc, int *error);
 int x509_constraints_chain(STACK_OF(X509) *chain, int *error,
     int *depth);
 int x509_vfy_check_security_level(X509_STORE_CTX *ctx);
@@ -29,69 +29,286 @@
  * validity of "child". It allows us to skip doing the public key math
  * when validating a certificate chain. It does not allow us to skip
  * any other steps of validation (times, names, key usage, etc.)
+ *
+ * The cache is split into X509_ISSUER_CACHE_SHARDS independently locked
+ * shards so that concurrent verifications rarely contend on the same
+ * mutex. Each shard is a chained hash table indexed by a truncated
+ * digest of the parent and child hashes - the full hashes are always
+ * compared before an entry is used. Entries live in a fixed size ring
+ * per shard and are replaced using the CLOCK algorithm, so that a cache
+ * hit only needs to set a reference bit rather than reorder a list.
  */
 
 #include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "x509_issuer_cache.h"
 
-static int
-x509_issuer_cmp(struct x509_issuer *x1, struct x509_issuer *x2)
-{
-	int pcmp;
-	if ((pcmp = memcmp(x1->parent_md, x2->parent_md, EVP_MAX_MD_SIZE)) != 0)
-		return pcmp;
-	return memcmp(x1->child_md, x2->child_md, EVP_MAX_MD_SIZE);
+struct x509_issuer_shard {
+	pthread_mutex_t mutex;
+	struct x509_issuer *entries;	/* Ring of max entries. */
+	struct x509_issuer **buckets;
+	size_t nbuckets;		/* Power of two. */
+	size_t count;
+	size_t max;
+	size_t hand;			/* CLOCK hand into entries. */
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+#define X509_ISSUER_SHARD_MAX(max) \
+	(((max) + X509_ISSUER_CACHE_SHARDS - 1) / X509_ISSUER_CACHE_SHARDS)
+
+#define X509_ISSUER_SHARD_INITIALIZER {					\
+	.mutex = PTHREAD_MUTEX_INITIALIZER,				\
+	.max = X509_ISSUER_SHARD_MAX(X509_ISSUER_CACHE_MAX),		\
 }
 
-static size_t x509_issuer_cache_count;
+static struct x509_issuer_shard x509_issuer_shards[X509_ISSUER_CACHE_SHARDS] = {
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+	X509_ISSUER_SHARD_INITIALIZER, X509_ISSUER_SHARD_INITIALIZER,
+};
+
 static size_t x509_issuer_cache_max = X509_ISSUER_CACHE_MAX;
-static RB_HEAD(x509_issuer_tree, x509_issuer) x509_issuer_cache =
-    RB_INITIALIZER(&x509_issuer_cache);
-static TAILQ_HEAD(lruqueue, x509_issuer) x509_issuer_lru =
-    TAILQ_HEAD_INITIALIZER(x509_issuer_lru);
-static pthread_mutex_t x509_issuer_tree_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-RB_PROTOTYPE(x509_issuer_tree, x509_issuer, entry, x509_issuer_cmp);
-RB_GENERATE(x509_issuer_tree, x509_issuer, entry, x509_issuer_cmp);
+/*
+ * The hashes are cryptographic digests, so any 64 bits of them are as
+ * good an index as any other. They are combined asymmetrically, since
+ * a self-signed certificate has the same parent and child hash and the
+ * same pair must not end up in different entries when swapped. The
+ * final mix spreads the result over both the shard and bucket bits.
+ */
+static uint64_t
+x509_issuer_tag(const unsigned char *parent_md, const unsigned char *child_md)
+{
+	uint64_t parent_tag, child_tag, tag;
+
+	memcpy(&parent_tag, parent_md, sizeof(parent_tag));
+	memcpy(&child_tag, child_md, sizeof(child_tag));
+
+	tag = parent_tag * 0x9e3779b97f4a7c15ULL + child_tag;
+	tag ^= tag >> 30;
+	tag *= 0xbf58476d1ce4e5b9ULL;
+	tag ^= tag >> 27;
+	tag *= 0x94d049bb133111ebULL;
+	tag ^= tag >> 31;
+
+	return tag;
+}
+
+static struct x509_issuer_shard *
+x509_issuer_shard(uint64_t tag)
+{
+	return &x509_issuer_shards[tag & (X509_ISSUER_CACHE_SHARDS - 1)];
+}
+
+static size_t
+x509_issuer_bucket(struct x509_issuer_shard *shard, uint64_t tag)
+{
+	return (tag / X509_ISSUER_CACHE_SHARDS) & (shard->nbuckets - 1);
+}
 
 /*
- * Set the maximum number of cached entries. On additions to the cache
- * the least recently used entries will be discarded so that the cache
- * stays under the maximum number of entries.  Setting a maximum of 0
- * disables the cache.
+ * Discard all entries in a shard. Must be called with the shard
+ * mutex held.
  */
-int
-x509_issuer_cache_set_max(size_t max)
+static void
+x509_issuer_shard_clear(struct x509_issuer_shard *shard)
 {
-	if (pthread_mutex_lock(&x509_issuer_tree_mutex) != 0)
+	free(shard->entries);
+	free(shard->buckets);
+	shard->entries = NULL;
+	shard->buckets = NULL;
+	shard->nbuckets = 0;
+	shard->count = 0;
+	shard->hand = 0;
+}
+
+/*
+ * Allocate the entry ring and hash buckets for a shard on first use.
+ * Must be called with the shard mutex held.
+ */
+static int
+x509_issuer_shard_init(struct x509_issuer_shard *shard)
+{
+	size_t nbuckets = 1;
+
+	if (shard->entries != NULL)
+		return 1;
+	if (shard->max == 0)
 		return 0;
-	x509_issuer_cache_max = max;
-	(void) pthread_mutex_unlock(&x509_issuer_tree_mutex);
+
+	while (nbuckets < shard->max)
+		nbuckets <<= 1;
+
+	if ((shard->entries = calloc(shard->max,
+	    sizeof(*shard->entries))) == NULL)
+		goto err;
+	if ((shard->buckets = calloc(nbuckets,
+	    sizeof(*shard->buckets))) == NULL)
+		goto err;
+	shard->nbuckets = nbuckets;
 
 	return 1;
+
+ err:
+	x509_issuer_shard_clear(shard);
+
+	return 0;
 }
 
 /*
- * Free the oldest entry in the issuer cache. Returns 1
- * if an entry was successfully freed, 0 otherwise. Must
- * be called with x509_issuer_tree_mutex held.
+ * Look up an entry in a shard. Must be called with the shard
+ * mutex held.
+ */
+static struct x509_issuer *
+x509_issuer_shard_find(struct x509_issuer_shard *shard, uint64_t tag,
+    const unsigned char *parent_md, const unsigned char *child_md)
+{
+	struct x509_issuer *issuer;
+
+	if (shard->entries == NULL)
+		return NULL;
+
+	issuer = shard->buckets[x509_issuer_bucket(shard, tag)];
+	for (; issuer != NULL; issuer = issuer->next) {
+		if (issuer->tag != tag)
+			continue;
+		if (memcmp(issuer->parent_md, parent_md, EVP_MAX_MD_SIZE) != 0)
+			continue;
+		if (memcmp(issuer->child_md, child_md, EVP_MAX_MD_SIZE) != 0)
+			continue;
+		return issuer;
+	}
+
+	return NULL;
+}
+
+/*
+ * Return an unused entry from the ring of a shard, evicting the first
+ * entry that the CLOCK hand finds without its reference bit set. Every
+ * referenced entry that the hand passes over gets a second chance. Must
+ * be called with the shard mutex held.
+ */
+static struct x509_issuer *
+x509_issuer_shard_evict(struct x509_issuer_shard *shard)
+{
+	struct x509_issuer *issuer, **prev;
+
+	if (shard->count < shard->max)
+		return &shard->entries[shard->count++];
+
+	for (;;) {
+		issuer = &shard->entries[shard->hand];
+		if (++shard->hand == shard->max)
+			shard->hand = 0;
+		if (!issuer->referenced)
+			break;
+		issuer->referenced = 0;
+	}
+
+	prev = &shard->buckets[x509_issuer_bucket(shard, issuer->tag)];
+	while (*prev != issuer)
+		prev = &(*prev)->next;
+	*prev = issuer->next;
+
+	shard->evictions++;
+
+	return issuer;
+}
+
+/*
+ * Change the size of the entry ring of a shard, keeping as many of the
+ * cached entries as fit. Entries with their reference bit set are kept
+ * in preference to the others. Must be called with the shard mutex held.
  */
 static void
-x509_issuer_cache_free_oldest(void)
+x509_issuer_shard_resize(struct x509_issuer_shard *shard, size_t max)
 {
-	struct x509_issuer *old;
+	struct x509_issuer *entries = NULL, *issuer;
+	struct x509_issuer **buckets = NULL;
+	size_t nbuckets = 1, count = 0, bucket, i, n;
+	int pass;
 
-	if (x509_issuer_cache_count == 0)
+	if (shard->entries == NULL || max == 0) {
+		x509_issuer_shard_clear(shard);
+		shard->max = max;
 		return;
-	old = TAILQ_LAST(&x509_issuer_lru, lruqueue);
-	TAILQ_REMOVE(&x509_issuer_lru, old, queue);
-	RB_REMOVE(x509_issuer_tree, &x509_issuer_cache, old);
-	free(old->parent_md);
-	free(old->child_md);
-	free(old);
-	x509_issuer_cache_count--;
+	}
+
+	while (nbuckets < max)
+		nbuckets <<= 1;
+
+	if ((entries = calloc(max, sizeof(*entries))) == NULL)
+		goto err;
+	if ((buckets = calloc(nbuckets, sizeof(*buckets))) == NULL)
+		goto err;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (n = 0; n < shard->count && count < max; n++) {
+			i = (shard->hand + n) % shard->count;
+			issuer = &shard->entries[i];
+			if (issuer->referenced != (pass == 0))
+				continue;
+			entries[count] = *issuer;
+			bucket = (issuer->tag / X509_ISSUER_CACHE_SHARDS) &
+			    (nbuckets - 1);
+			entries[count].next = buckets[bucket];
+			buckets[bucket] = &entries[count];
+			count++;
+		}
+	}
+
+	shard->evictions += shard->count - count;
+
+	free(shard->entries);
+	free(shard->buckets);
+	shard->entries = entries;
+	shard->buckets = buckets;
+	shard->nbuckets = nbuckets;
+	shard->count = count;
+	shard->max = max;
+	shard->hand = 0;
+
+	return;
+
+ err:
+	free(entries);
+	free(buckets);
+	x509_issuer_shard_clear(shard);
+	shard->max = max;
+}
+
+/*
+ * Set the maximum number of cached entries, which is rounded up to a
+ * multiple of the number of shards. Lowering the maximum evicts entries
+ * until each shard is within its new limit. Setting a maximum of 0
+ * disables the cache.
+ */
+int
+x509_issuer_cache_set_max(size_t max)
+{
+	struct x509_issuer_shard *shard;
+	size_t i;
+
+	for (i = 0; i < X509_ISSUER_CACHE_SHARDS; i++) {
+		shard = &x509_issuer_shards[i];
+		if (pthread_mutex_lock(&shard->mutex) != 0)
+			return 0;
+		x509_issuer_shard_resize(shard, X509_ISSUER_SHARD_MAX(max));
+		(void) pthread_mutex_unlock(&shard->mutex);
+	}
+	x509_issuer_cache_max = max;
+
+	return 1;
 }
 
 /*
@@ -100,11 +317,40 @@ x509_issuer_cache_free_oldest(void)
 void
 x509_issuer_cache_free(void)
 {
-	if (pthread_mutex_lock(&x509_issuer_tree_mutex) != 0)
-		return;
-	while (x509_issuer_cache_count > 0)
-		x509_issuer_cache_free_oldest();
-	(void) pthread_mutex_unlock(&x509_issuer_tree_mutex);
+	struct x509_issuer_shard *shard;
+	size_t i;
+
+	for (i = 0; i < X509_ISSUER_CACHE_SHARDS; i++) {
+		shard = &x509_issuer_shards[i];
+		if (pthread_mutex_lock(&shard->mutex) != 0)
+			continue;
+		x509_issuer_shard_clear(shard);
+		(void) pthread_mutex_unlock(&shard->mutex);
+	}
+}
+
+/*
+ * Report the number of cached entries along with the number of cache
+ * hits, misses and evictions since the process started.
+ */
+void
+x509_issuer_cache_stats(struct x509_issuer_cache_stats *stats)
+{
+	struct x509_issuer_shard *shard;
+	size_t i;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (i = 0; i < X509_ISSUER_CACHE_SHARDS; i++) {
+		shard = &x509_issuer_shards[i];
+		if (pthread_mutex_lock(&shard->mutex) != 0)
+			continue;
+		stats->entries += shard->count;
+		stats->hits += shard->hits;
+		stats->misses += shard->misses;
+		stats->evictions += shard->evictions;
+		(void) pthread_mutex_unlock(&shard->mutex);
+	}
 }
 
 /*
@@ -118,25 +364,27 @@ x509_issuer_cache_free(void)
 int
 x509_issuer_cache_find(unsigned char *parent_md, unsigned char *child_md)
 {
-	struct x509_issuer candidate, *found;
+	struct x509_issuer_shard *shard;
+	struct x509_issuer *found;
+	uint64_t tag;
 	int ret = -1;
 
-	memset(&candidate, 0, sizeof(candidate));
-	candidate.parent_md = parent_md;
-	candidate.child_md = child_md;
-
 	if (x509_issuer_cache_max == 0)
 		return -1;
 
-	if (pthread_mutex_lock(&x509_issuer_tree_mutex) != 0)
+	tag = x509_issuer_tag(parent_md, child_md);
+	shard = x509_issuer_shard(tag);
+
+	if (pthread_mutex_lock(&shard->mutex) != 0)
 		return -1;
-	if ((found = RB_FIND(x509_issuer_tree, &x509_issuer_cache,
-	    &candidate)) != NULL) {
-		TAILQ_REMOVE(&x509_issuer_lru, found, queue);
-		TAILQ_INSERT_HEAD(&x509_issuer_lru, found, queue);
+	if ((found = x509_issuer_shard_find(shard, tag, parent_md,
+	    child_md)) != NULL) {
+		found->referenced = 1;
 		ret = found->valid;
-	}
-	(void) pthread_mutex_unlock(&x509_issuer_tree_mutex);
+		shard->hits++;
+	} else
+		shard->misses++;
+	(void) pthread_mutex_unlock(&shard->mutex);
 
 	return ret;
 }
@@ -154,40 +402,37 @@ void
 x509_issuer_cache_add(unsigned char *parent_md, unsigned char *child_md,
     int valid)
 {
+	struct x509_issuer_shard *shard;
 	struct x509_issuer *new;
+	uint64_t tag;
+	size_t bucket;
 
 	if (x509_issuer_cache_max == 0)
 		return;
 	if (valid != 0 && valid != 1)
 		return;
 
-	if ((new = calloc(1, sizeof(struct x509_issuer))) == NULL)
+	tag = x509_issuer_tag(parent_md, child_md);
+	shard = x509_issuer_shard(tag);
+
+	if (pthread_mutex_lock(&shard->mutex) != 0)
 		return;
-	if ((new->parent_md = calloc(1, EVP_MAX_MD_SIZE)) == NULL)
-		goto err;
+	if (!x509_issuer_shard_init(shard))
+		goto done;
+	if (x509_issuer_shard_find(shard, tag, parent_md, child_md) != NULL)
+		goto done;
+
+	new = x509_issuer_shard_evict(shard);
+	new->tag = tag;
 	memcpy(new->parent_md, parent_md, EVP_MAX_MD_SIZE);
-	if ((new->child_md = calloc(1, EVP_MAX_MD_SIZE)) == NULL)
-		goto err;
 	memcpy(new->child_md, child_md, EVP_MAX_MD_SIZE);
-
 	new->valid = valid;
+	new->referenced = 0;
 
-	if (pthread_mutex_lock(&x509_issuer_tree_mutex) != 0)
-		goto err;
-	while (x509_issuer_cache_count >= x509_issuer_cache_max)
-		x509_issuer_cache_free_oldest();
-	if (RB_INSERT(x509_issuer_tree, &x509_issuer_cache, new) == NULL) {
-		TAILQ_INSERT_HEAD(&x509_issuer_lru, new, queue);
-		x509_issuer_cache_count++;
-		new = NULL;
-	}
-	(void) pthread_mutex_unlock(&x509_issuer_tree_mutex);
+	bucket = x509_issuer_bucket(shard, tag);
+	new->next = shard->buckets[bucket];
+	shard->buckets[bucket] = new;
 
- err:
-	if (new != NULL) {
-		free(new->parent_md);
-		free(new->child_md);
-	}
-	free(new);
-	return;
+ done:
+	(void) pthread_mutex_unlock(&shard->mutex);
 }
@@ -19,29 +19,37 @@
 #ifndef HEADER_X509_ISSUER_CACHE_H
 #define HEADER_X509_ISSUER_CACHE_H
 
-#include <sys/tree.h>
-#include <sys/queue.h>
+#include <stdint.h>
 
 #include <openssl/x509.h>
 
 __BEGIN_HIDDEN_DECLS
 
 struct x509_issuer {
-	RB_ENTRY(x509_issuer) entry;
-	TAILQ_ENTRY(x509_issuer) queue;	/* LRU of entries */
-	/* parent_md and child_md must point to EVP_MAX_MD_SIZE of memory */
-	unsigned char *parent_md;
-	unsigned char *child_md;
+	struct x509_issuer *next;	/* Hash bucket chain. */
+	uint64_t tag;			/* Truncated digest of both hashes. */
+	unsigned char parent_md[EVP_MAX_MD_SIZE];
+	unsigned char child_md[EVP_MAX_MD_SIZE];
 	int valid;			/* Result of signature validation. */
+	int referenced;			/* CLOCK reference bit. */
 };
 
-#define X509_ISSUER_CACHE_MAX 40000	/* Approx 7.5 MB, entries 200 bytes */
+struct x509_issuer_cache_stats {
+	size_t entries;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+#define X509_ISSUER_CACHE_MAX 40000	/* Approx 6.5 MB, entries 160 bytes */
+#define X509_ISSUER_CACHE_SHARDS 16	/* Must be a power of two. */
 
 int x509_issuer_cache_set_max(size_t max);
 int x509_issuer_cache_find(unsigned char *parent_md, unsigned char *child_md);
 void x509_issuer_cache_add(unsigned char *parent_md, unsigned char *child_md,
     int valid);
 void x509_issuer_cache_free(void);
+void x509_issuer_cache_stats(struct x509_issuer_cache_stats *stats);
 
 __END_HIDDEN_DECLS
 
@@ -175,6 +175,8 @@ struct x509_cinf_st {
 	ASN1_BIT_STRING *issuerUID;		/* [ 1 ] optional in v2 */
 	ASN1_BIT_STRING *subjectUID;		/* [ 2 ] optional in v2 */
 	STACK_OF(X509_EXTENSION) *extensions;	/* [ 3 ] optional in v3 */
+	ASN1_STRING *lazy_extensions;	/* undecoded [ 3 ], see d2i_X509_lazy */
+	int lazy_invalid;
 	ASN1_ENCODING enc;
 } /* X509_CINF */;
 
@@ -197,6 +199,7 @@ struct x509_st {
 	STACK_OF(DIST_POINT) *crldp;
 	STACK_OF(GENERAL_NAME) *altname;
 	NAME_CONSTRAINTS *nc;
+	struct x509_constraints_compiled *nc_compiled;	/* Cached from nc */
 #ifndef OPENSSL_NO_RFC3779
 	STACK_OF(IPAddressFamily) *rfc3779_addr;
 	ASIdentifiers *rfc3779_asid;
@@ -245,6 +248,8 @@ struct X509_crl_st {
 	ASN1_INTEGER *base_crl_number;
 	unsigned char hash[X509_CRL_HASH_LEN];
 	STACK_OF(GENERAL_NAMES) *issuers;
+	/* Lazily decoded revoked entries, see X509_CRL_new_indexed(). */
+	struct x509_crl_index *index;
 } /* X509_CRL */;
 
 struct pkcs8_priv_key_info_st {
@@ -298,10 +303,26 @@ struct X509_VERIFY_PARAM_st {
  * validation.  Once we have a certificate chain, the 'verify'
  * function is then called to actually check the cert chain.
  */
+struct x509_store_entry {
+	struct x509_store_entry *next;
+	unsigned long hash;		/* X509_NAME_hash() of obj's name */
+	X509_OBJECT *obj;
+};
+
 struct x509_store_st {
 	/* The following is a cache of trusted certs */
 	STACK_OF(X509_OBJECT) *objs;	/* Cache of all objects */
 
+	/*
+	 * Hash index of objs, keyed on the subject name for certificates
+	 * and the issuer name for CRLs. Entries with the same name are
+	 * kept in insertion order.
+	 */
+	struct x509_store_entry **buckets;
+	size_t nbuckets;
+	/* Set once objs was handed out and the index was dropped. */
+	int objs_exposed;
+
 	/* These are external lookup methods */
 	STACK_OF(X509_LOOKUP) *get_cert_methods;
 
@@ -314,6 +335,9 @@ struct x509_store_st {
 
 	CRYPTO_EX_DATA ex_data;
 	int references;
+
+	/* Cache of verified chains, see X509_STORE_set_verify_cache(). */
+	struct x509_verify_cache *verify_cache;
 } /* X509_STORE */;
 
 /* This is the functions plus an instance of the local variables. */
@@ -370,6 +394,29 @@ struct x509_store_ctx_st {
 } /* X509_STORE_CTX */;
 
 int x509_check_cert_time(X509_STORE_CTX *ctx, X509 *x, int quiet);
+X509_OBJECT *x509_store_object_by_subject(X509_STORE *store,
+    X509_LOOKUP_TYPE type, X509_NAME *name, unsigned long hash);
+
+int x509_revoked_set_reason(X509_REVOKED *rev);
+X509_CRL *x509_crl_new_indexed(uint8_t *data, size_t data_len);
+int x509_crl_index_lookup(X509_CRL *crl, const ASN1_INTEGER *serial,
+    X509_REVOKED **out_rev);
+int x509_crl_index_verify(X509_CRL *crl, EVP_PKEY *pkey);
+int x509_crl_index_i2d(X509_CRL *crl, unsigned char **out);
+int x509_crl_index_digest(const X509_CRL *crl, const EVP_MD *type,
+    unsigned char *md, unsigned int *len);
+X509_CRL *x509_crl_index_dup(X509_CRL *crl);
+int x509_crl_index_materialize(X509_CRL *crl);
+int x509_crl_index_restore_tbs(X509_CRL *crl);
+void x509_crl_index_free(struct x509_crl_index *index);
+int x509_crl_materialize(X509_CRL *crl);
+
+void x509_constraints_compiled_free(struct x509_constraints_compiled *cc);
+
+int x509_cinf_decode_extensions(X509_CINF *ci);
+
+void x509_intern_flush(void);
+size_t x509_intern_count(void);
 
 int name_cmp(const char *name, const char *cmp);
 
@@ -65,6 +65,7 @@
 #include <openssl/x509v3.h>
 
 #include "x509_local.h"
+#include "x509_verify_cache.h"
 
 static X509_LOOKUP *
 X509_LOOKUP_new(const X509_LOOKUP_METHOD *method)
@@ -135,6 +136,221 @@ x509_object_cmp(const X509_OBJECT * const *a, const X509_OBJECT * const *b)
 	return 0;
 }
 
+#define X509_STORE_MIN_BUCKETS	64
+
+static int x509_object_idx_cnt(STACK_OF(X509_OBJECT) *h, X509_LOOKUP_TYPE type,
+    X509_NAME *name, int *pnmatch);
+
+static X509_NAME *
+x509_object_name(const X509_OBJECT *obj)
+{
+	switch (obj->type) {
+	case X509_LU_X509:
+		return X509_get_subject_name(obj->data.x509);
+	case X509_LU_CRL:
+		return X509_CRL_get_issuer(obj->data.crl);
+	}
+	return NULL;
+}
+
+static struct x509_store_entry *
+x509_store_bucket(X509_STORE *store, unsigned long hash)
+{
+	if (store->nbuckets == 0)
+		return NULL;
+	return store->buckets[hash & (store->nbuckets - 1)];
+}
+
+static int
+x509_store_entry_match(const struct x509_store_entry *entry,
+    X509_LOOKUP_TYPE type, X509_NAME *name, unsigned long hash)
+{
+	if (entry->hash != hash || entry->obj->type != type)
+		return 0;
+	return X509_NAME_cmp(x509_object_name(entry->obj), name) == 0;
+}
+
+/* Append to the end of the hash chain so that insertion order is kept. */
+static void
+x509_store_bucket_append(struct x509_store_entry **buckets, size_t nbuckets,
+    struct x509_store_entry *entry)
+{
+	struct x509_store_entry **tail;
+
+	tail = &buckets[entry->hash & (nbuckets - 1)];
+	while (*tail != NULL)
+		tail = &(*tail)->next;
+	entry->next = NULL;
+	*tail = entry;
+}
+
+/* Keep the load factor of the index at or below one. */
+static int
+x509_store_index_grow(X509_STORE *store)
+{
+	struct x509_store_entry **buckets, *entry, *next;
+	size_t nbuckets, i;
+
+	if (store->nbuckets > (size_t)sk_X509_OBJECT_num(store->objs))
+		return 1;
+
+	if ((nbuckets = store->nbuckets * 2) == 0)
+		nbuckets = X509_STORE_MIN_BUCKETS;
+	if ((buckets = calloc(nbuckets, sizeof(*buckets))) == NULL)
+		return 0;
+
+	for (i = 0; i < store->nbuckets; i++) {
+		for (entry = store->buckets[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			x509_store_bucket_append(buckets, nbuckets, entry);
+		}
+	}
+
+	free(store->buckets);
+	store->buckets = buckets;
+	store->nbuckets = nbuckets;
+
+	return 1;
+}
+
+static int
+x509_store_index_add(X509_STORE *store, X509_OBJECT *obj, unsigned long hash)
+{
+	struct x509_store_entry *entry;
+
+	if (!x509_store_index_grow(store))
+		return 0;
+	if ((entry = calloc(1, sizeof(*entry))) == NULL)
+		return 0;
+	entry->hash = hash;
+	entry->obj = obj;
+
+	x509_store_bucket_append(store->buckets, store->nbuckets, entry);
+
+	return 1;
+}
+
+static void
+x509_store_index_free(X509_STORE *store)
+{
+	struct x509_store_entry *entry, *next;
+	size_t i;
+
+	for (i = 0; i < store->nbuckets; i++) {
+		for (entry = store->buckets[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			free(entry);
+		}
+	}
+	free(store->buckets);
+	store->buckets = NULL;
+	store->nbuckets = 0;
+}
+
+/*
+ * Iterate over the objects of the given type whose subject (or issuer for
+ * CRLs) is name. hash must be X509_NAME_hash(name). Once the object stack
+ * has been handed out by X509_STORE_get0_objects() the index is gone and
+ * the sorted stack is searched instead. Must be called with
+ * CRYPTO_LOCK_X509_STORE held.
+ */
+struct x509_store_iter {
+	X509_STORE *store;
+	X509_LOOKUP_TYPE type;
+	X509_NAME *name;
+	unsigned long hash;
+	struct x509_store_entry *entry;
+	int idx;
+	int end;
+};
+
+static X509_OBJECT *
+x509_store_iter_next(struct x509_store_iter *iter)
+{
+	struct x509_store_entry *entry;
+
+	if (iter->store->objs_exposed) {
+		if (iter->idx >= iter->end)
+			return NULL;
+		return sk_X509_OBJECT_value(iter->store->objs, iter->idx++);
+	}
+
+	while ((entry = iter->entry) != NULL) {
+		iter->entry = entry->next;
+		if (x509_store_entry_match(entry, iter->type, iter->name,
+		    iter->hash))
+			return entry->obj;
+	}
+
+	return NULL;
+}
+
+static X509_OBJECT *
+x509_store_iter_first(struct x509_store_iter *iter, X509_STORE *store,
+    X509_LOOKUP_TYPE type, X509_NAME *name, unsigned long hash)
+{
+	int nmatch = 0;
+
+	memset(iter, 0, sizeof(*iter));
+	iter->store = store;
+	iter->type = type;
+	iter->name = name;
+	iter->hash = hash;
+
+	if (store->objs_exposed) {
+		iter->idx = x509_object_idx_cnt(store->objs, type, name,
+		    &nmatch);
+		if (iter->idx < 0) {
+			iter->idx = 0;
+			nmatch = 0;
+		}
+		iter->end = iter->idx + nmatch;
+	} else
+		iter->entry = x509_store_bucket(store, hash);
+
+	return x509_store_iter_next(iter);
+}
+
+/*
+ * Return the first object of the given type whose subject (or issuer for
+ * CRLs) is name. hash must be X509_NAME_hash(name). Must be called with
+ * CRYPTO_LOCK_X509_STORE held.
+ */
+X509_OBJECT *
+x509_store_object_by_subject(X509_STORE *store, X509_LOOKUP_TYPE type,
+    X509_NAME *name, unsigned long hash)
+{
+	struct x509_store_iter iter;
+
+	return x509_store_iter_first(&iter, store, type, name, hash);
+}
+
+/*
+ * Return the object in the store that is identical to obj, if any. Must be
+ * called with CRYPTO_LOCK_X509_STORE held.
+ */
+static X509_OBJECT *
+x509_store_object_match(X509_STORE *store, X509_OBJECT *obj,
+    unsigned long hash)
+{
+	struct x509_store_iter iter;
+	X509_OBJECT *match;
+
+	match = x509_store_iter_first(&iter, store, obj->type,
+	    x509_object_name(obj), hash);
+	for (; match != NULL; match = x509_store_iter_next(&iter)) {
+		if (obj->type == X509_LU_X509) {
+			if (X509_cmp(match->data.x509, obj->data.x509) == 0)
+				return match;
+		} else if (obj->type == X509_LU_CRL) {
+			if (X509_CRL_match(match->data.crl, obj->data.crl) == 0)
+				return match;
+		}
+	}
+
+	return NULL;
+}
+
 X509_STORE *
 X509_STORE_new(void)
 {
@@ -229,10 +445,12 @@ X509_STORE_free(X509_STORE *store)
 		return;
 
 	sk_X509_LOOKUP_pop_free(store->get_cert_methods, X509_LOOKUP_free);
+	x509_store_index_free(store);
 	sk_X509_OBJECT_pop_free(store->objs, X509_OBJECT_free);
 
 	CRYPTO_free_ex_data(CRYPTO_EX_INDEX_X509_STORE, store, &store->ex_data);
 	X509_VERIFY_PARAM_free(store->param);
+	x509_verify_cache_free(store->verify_cache);
 	free(store);
 }
 LCRYPTO_ALIAS(X509_STORE_free);
@@ -297,6 +515,7 @@ X509_STORE_CTX_get_by_subject(X509_STORE_CTX *vs, X509_LOOKUP_TYPE type,
 	X509_STORE *ctx = vs->store;
 	X509_LOOKUP *lu;
 	X509_OBJECT stmp, *tmp;
+	unsigned long hash;
 	int i;
 
 	if (ctx == NULL)
@@ -304,8 +523,10 @@ X509_STORE_CTX_get_by_subject(X509_STORE_CTX *vs, X509_LOOKUP_TYPE type,
 
 	memset(&stmp, 0, sizeof(stmp));
 
+	hash = X509_NAME_hash(name);
+
 	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
-	tmp = X509_OBJECT_retrieve_by_subject(ctx->objs, type, name);
+	tmp = x509_store_object_by_subject(ctx, type, name, hash);
 	CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
 
 	if (tmp == NULL || type == X509_LU_CRL) {
@@ -333,11 +554,14 @@ LCRYPTO_ALIAS(X509_STORE_CTX_get_by_subject);
 static int
 X509_STORE_add_object(X509_STORE *store, X509_OBJECT *obj)
 {
+	unsigned long hash;
 	int ret = 0;
 
+	hash = X509_NAME_hash(x509_object_name(obj));
+
 	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
 
-	if (X509_OBJECT_retrieve_match(store->objs, obj) != NULL) {
+	if (x509_store_object_match(store, obj, hash) != NULL) {
 		/* Object is already present in the store. That's fine. */
 		ret = 1;
 		goto out;
@@ -347,6 +571,15 @@ X509_STORE_add_object(X509_STORE *store, X509_OBJECT *obj)
 		X509error(ERR_R_MALLOC_FAILURE);
 		goto out;
 	}
+	if (!store->objs_exposed && !x509_store_index_add(store, obj, hash)) {
+		(void)sk_X509_OBJECT_pop(store->objs);
+		X509error(ERR_R_MALLOC_FAILURE);
+		goto out;
+	}
+
+	/* Cached verification results may no longer hold. */
+	if (store->verify_cache != NULL)
+		x509_verify_cache_flush(store->verify_cache);
 
 	obj = NULL;
 	ret = 1;
@@ -510,22 +743,20 @@ LCRYPTO_ALIAS(X509_OBJECT_get0_X509_CRL);
 static STACK_OF(X509) *
 X509_get1_certs_from_cache(X509_STORE *store, X509_NAME *name)
 {
+	struct x509_store_iter iter;
+	X509_OBJECT *obj;
 	STACK_OF(X509) *sk = NULL;
 	X509 *x = NULL;
-	X509_OBJECT *obj;
-	int i, idx, cnt;
-
-	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
+	unsigned long hash;
 
-	idx = x509_object_idx_cnt(store->objs, X509_LU_X509, name, &cnt);
-	if (idx < 0)
-		goto err;
+	hash = X509_NAME_hash(name);
 
-	if ((sk = sk_X509_new_null()) == NULL)
-		goto err;
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
 
-	for (i = 0; i < cnt; i++, idx++) {
-		obj = sk_X509_OBJECT_value(store->objs, idx);
+	obj = x509_store_iter_first(&iter, store, X509_LU_X509, name, hash);
+	for (; obj != NULL; obj = x509_store_iter_next(&iter)) {
+		if (sk == NULL && (sk = sk_X509_new_null()) == NULL)
+			goto err;
 
 		x = obj->data.x509;
 		if (!X509_up_ref(x)) {
@@ -534,6 +765,7 @@ X509_get1_certs_from_cache(X509_STORE *store, X509_NAME *name)
 		}
 		if (!sk_X509_push(sk, x))
 			goto err;
+		x = NULL;
 	}
 
 	CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
@@ -575,10 +807,11 @@ STACK_OF(X509_CRL) *
 X509_STORE_CTX_get1_crls(X509_STORE_CTX *ctx, X509_NAME *name)
 {
 	X509_STORE *store = ctx->store;
+	struct x509_store_iter iter;
 	STACK_OF(X509_CRL) *sk = NULL;
 	X509_CRL *x = NULL;
 	X509_OBJECT *obj = NULL;
-	int i, idx, cnt;
+	unsigned long hash;
 
 	if (store == NULL)
 		return NULL;
@@ -591,16 +824,14 @@ X509_STORE_CTX_get1_crls(X509_STORE_CTX *ctx, X509_NAME *name)
 	X509_OBJECT_free(obj);
 	obj = NULL;
 
-	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
-	idx = x509_object_idx_cnt(store->objs, X509_LU_CRL, name, &cnt);
-	if (idx < 0)
-		goto err;
+	hash = X509_NAME_hash(name);
 
-	if ((sk = sk_X509_CRL_new_null()) == NULL)
-		goto err;
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
 
-	for (i = 0; i < cnt; i++, idx++) {
-		obj = sk_X509_OBJECT_value(store->objs, idx);
+	obj = x509_store_iter_first(&iter, store, X509_LU_CRL, name, hash);
+	for (; obj != NULL; obj = x509_store_iter_next(&iter)) {
+		if (sk == NULL && (sk = sk_X509_CRL_new_null()) == NULL)
+			goto err;
 
 		x = obj->data.crl;
 		if (!X509_CRL_up_ref(x)) {
@@ -609,6 +840,7 @@ X509_STORE_CTX_get1_crls(X509_STORE_CTX *ctx, X509_NAME *name)
 		}
 		if (!sk_X509_CRL_push(sk, x))
 			goto err;
+		x = NULL;
 	}
 
 	CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
@@ -665,10 +897,12 @@ LCRYPTO_ALIAS(X509_OBJECT_retrieve_match);
 int
 X509_STORE_CTX_get1_issuer(X509 **out_issuer, X509_STORE_CTX *ctx, X509 *x)
 {
+	struct x509_store_iter iter;
 	X509_NAME *xn;
-	X509_OBJECT *obj, *pobj;
+	X509_OBJECT *obj;
 	X509 *issuer = NULL;
-	int i, idx, ret;
+	unsigned long hash;
+	int ret;
 
 	*out_issuer = NULL;
 
@@ -702,30 +936,23 @@ X509_STORE_CTX_get1_issuer(X509 **out_issuer, X509_STORE_CTX *ctx, X509 *x)
 	if (ctx->store == NULL)
 		return 0;
 
-	/* Else find index of first cert accepted by 'check_issued' */
+	hash = X509_NAME_hash(xn);
+
+	/* Else find first cert accepted by 'check_issued' */
 	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
-	idx = X509_OBJECT_idx_by_subject(ctx->store->objs, X509_LU_X509, xn);
-	if (idx != -1) /* should be true as we've had at least one match */ {
-		/* Look through all matching certs for suitable issuer */
-		for (i = idx; i < sk_X509_OBJECT_num(ctx->store->objs); i++) {
-			pobj = sk_X509_OBJECT_value(ctx->store->objs, i);
-			/* See if we've run past the matches */
-			if (pobj->type != X509_LU_X509)
-				break;
-			if (X509_NAME_cmp(xn,
-			    X509_get_subject_name(pobj->data.x509)))
+	/* Look through all matching certs for suitable issuer */
+	obj = x509_store_iter_first(&iter, ctx->store, X509_LU_X509, xn, hash);
+	for (; obj != NULL; obj = x509_store_iter_next(&iter)) {
+		if (ctx->check_issued(ctx, x, obj->data.x509)) {
+			issuer = obj->data.x509;
+			/*
+			 * If times check, exit with match,
+			 * otherwise keep looking. Leave last
+			 * match in issuer so we return nearest
+			 * match if no certificate time is OK.
+			 */
+			if (x509_check_cert_time(ctx, issuer, -1))
 				break;
-			if (ctx->check_issued(ctx, x, pobj->data.x509)) {
-				issuer = pobj->data.x509;
-				/*
-				 * If times check, exit with match,
-				 * otherwise keep looking. Leave last
-				 * match in issuer so we return nearest
-				 * match if no certificate time is OK.
-				 */
-				if (x509_check_cert_time(ctx, issuer, -1))
-					break;
-			}
 		}
 	}
 	ret = 0;
@@ -745,6 +972,18 @@ LCRYPTO_ALIAS(X509_STORE_CTX_get1_issuer);
 STACK_OF(X509_OBJECT) *
 X509_STORE_get0_objects(X509_STORE *xs)
 {
+	/*
+	 * The caller may modify the stack behind our back, which would leave
+	 * dangling and missing entries in the index. Drop the index for good
+	 * and search the stack itself from now on.
+	 */
+	CRYPTO_w_lock(CRYPTO_LOCK_X509_STORE);
+	if (!xs->objs_exposed) {
+		x509_store_index_free(xs);
+		xs->objs_exposed = 1;
+	}
+	CRYPTO_w_unlock(CRYPTO_LOCK_X509_STORE);
+
 	return xs->objs;
 }
 LCRYPTO_ALIAS(X509_STORE_get0_objects);
@@ -817,6 +1056,29 @@ X509_STORE_set_flags(X509_STORE *ctx, unsigned long flags)
 }
 LCRYPTO_ALIAS(X509_STORE_set_flags);
 
+int
+X509_STORE_set_verify_cache(X509_STORE *store, size_t max_entries)
+{
+	if (max_entries == 0) {
+		x509_verify_cache_free(store->verify_cache);
+		store->verify_cache = NULL;
+		return 1;
+	}
+
+	if (store->verify_cache != NULL) {
+		x509_verify_cache_set_max(store->verify_cache, max_entries);
+		return 1;
+	}
+
+	if ((store->verify_cache = x509_verify_cache_new(max_entries)) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		return 0;
+	}
+
+	return 1;
+}
+LCRYPTO_ALIAS(X509_STORE_set_verify_cache);
+
 int
 X509_STORE_set_depth(X509_STORE *ctx, int depth)
 {
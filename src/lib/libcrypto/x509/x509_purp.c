@@ -566,6 +566,10 @@ x509v3_cache_extensions_internal(X509 *x)
 	if (!x509_extension_oids_are_unique(x))
 		x->ex_flags |= EXFLAG_INVALID;
 
+	/* Extensions of a lazily parsed certificate failed to decode. */
+	if (x->cert_info->lazy_invalid)
+		x->ex_flags |= EXFLAG_INVALID;
+
 	x->ex_flags |= EXFLAG_SET;
 }
 
@@ -573,6 +577,9 @@ int
 x509v3_cache_extensions(X509 *x)
 {
 	if ((x->ex_flags & EXFLAG_SET) == 0) {
+		/* This takes CRYPTO_LOCK_X509 itself, so must happen first. */
+		(void)x509_cinf_decode_extensions(x->cert_info);
+
 		CRYPTO_w_lock(CRYPTO_LOCK_X509);
 		x509v3_cache_extensions_internal(x);
 		CRYPTO_w_unlock(CRYPTO_LOCK_X509);
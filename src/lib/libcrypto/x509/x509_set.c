@@ -68,6 +68,7 @@
 const STACK_OF(X509_EXTENSION) *
 X509_get0_extensions(const X509 *x)
 {
+	(void)x509_cinf_decode_extensions(x->cert_info);
 	return x->cert_info->extensions;
 }
 LCRYPTO_ALIAS(X509_get0_extensions);
@@ -847,39 +847,23 @@ static int
 x509_verify_validate_constraints(X509 *cert,
     struct x509_verify_chain *current_chain, int *error)
 {
-	struct x509_constraints_names *excluded = NULL;
-	struct x509_constraints_names *permitted = NULL;
+	const struct x509_constraints_compiled *cc;
 	int err = X509_V_ERR_UNSPECIFIED;
 
 	if (current_chain == NULL)
 		return 1;
 
 	if (cert->nc != NULL) {
-		if ((permitted = x509_constraints_names_new(
-		    X509_VERIFY_MAX_CHAIN_CONSTRAINTS)) == NULL) {
-			err = X509_V_ERR_OUT_OF_MEM;
+		if (!x509_constraints_get_compiled(cert, &cc, &err))
 			goto err;
-		}
-		if ((excluded = x509_constraints_names_new(
-		    X509_VERIFY_MAX_CHAIN_CONSTRAINTS)) == NULL) {
-			err = X509_V_ERR_OUT_OF_MEM;
-			goto err;
-		}
-		if (!x509_constraints_extract_constraints(cert,
-		    permitted, excluded, &err))
-			goto err;
-		if (!x509_constraints_check(current_chain->names,
-		    permitted, excluded, &err))
+		if (!x509_constraints_check_compiled(current_chain->names,
+		    cc, &err))
 			goto err;
-		x509_constraints_names_free(excluded);
-		x509_constraints_names_free(permitted);
 	}
 
 	return 1;
  err:
 	*error = err;
-	x509_constraints_names_free(excluded);
-	x509_constraints_names_free(permitted);
 	return 0;
 }
 
@@ -0,0 +1,189 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Verify many certificates against the same store, spreading the work over
+ * a pool of worker threads. Each worker reuses a single X509_STORE_CTX for
+ * all the jobs it picks up. The issuer signature cache is process wide, so
+ * results obtained by one worker are available to all others. The RSA, DSA
+ * and ECDSA signature checks use the per-thread BN_CTX from
+ * bn_ctx_get_thread(), so each worker also reuses its bignum storage.
+ */
+
+#include <stdlib.h>
+
+#include <openssl/err.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+#include "crypto_internal.h"
+#include "x509_local.h"
+
+#define X509_VERIFY_BATCH_MAX_THREADS	256
+
+struct X509_VERIFY_JOB_st {
+	X509 *leaf;
+	STACK_OF(X509) *untrusted;
+	const X509_VERIFY_PARAM *param;
+	int result;
+	int error;
+};
+
+struct x509_verify_batch {
+	X509_STORE *store;
+	X509_VERIFY_JOB **jobs;
+	X509_STORE_CTX **ctxs;
+};
+
+static int
+x509_verify_batch_job(void *arg, size_t worker, size_t index)
+{
+	struct x509_verify_batch *batch = arg;
+	X509_VERIFY_JOB *job = batch->jobs[index];
+	X509_STORE_CTX *ctx;
+
+	/* Leave this and all remaining jobs marked as out of memory. */
+	if ((ctx = batch->ctxs[worker]) == NULL) {
+		if ((ctx = X509_STORE_CTX_new()) == NULL)
+			return 0;
+		batch->ctxs[worker] = ctx;
+	}
+
+	job->result = -1;
+	job->error = X509_V_ERR_UNSPECIFIED;
+
+	if (!X509_STORE_CTX_init(ctx, batch->store, job->leaf, job->untrusted))
+		return 1;
+	if (job->param != NULL &&
+	    !X509_VERIFY_PARAM_set1(X509_STORE_CTX_get0_param(ctx),
+	    job->param))
+		goto done;
+
+	job->result = X509_verify_cert(ctx);
+	job->error = X509_STORE_CTX_get_error(ctx);
+
+ done:
+	X509_STORE_CTX_cleanup(ctx);
+
+	return 1;
+}
+
+X509_VERIFY_JOB *
+X509_VERIFY_JOB_new(X509 *leaf, STACK_OF(X509) *untrusted,
+    const X509_VERIFY_PARAM *param)
+{
+	X509_VERIFY_JOB *job;
+
+	if ((job = calloc(1, sizeof(*job))) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		return NULL;
+	}
+
+	job->leaf = leaf;
+	job->untrusted = untrusted;
+	job->param = param;
+	job->result = -1;
+	job->error = X509_V_ERR_UNSPECIFIED;
+
+	return job;
+}
+LCRYPTO_ALIAS(X509_VERIFY_JOB_new);
+
+void
+X509_VERIFY_JOB_free(X509_VERIFY_JOB *job)
+{
+	free(job);
+}
+LCRYPTO_ALIAS(X509_VERIFY_JOB_free);
+
+int
+X509_VERIFY_JOB_get_result(const X509_VERIFY_JOB *job)
+{
+	return job->result;
+}
+LCRYPTO_ALIAS(X509_VERIFY_JOB_get_result);
+
+int
+X509_VERIFY_JOB_get_error(const X509_VERIFY_JOB *job)
+{
+	return job->error;
+}
+LCRYPTO_ALIAS(X509_VERIFY_JOB_get_error);
+
+int
+X509_STORE_verify_batch(X509_STORE *store, X509_VERIFY_JOB **jobs,
+    size_t num_jobs, int num_threads)
+{
+	struct x509_verify_batch batch = {
+		.store = store,
+		.jobs = jobs,
+	};
+	struct crypto_workers *workers = NULL;
+	size_t i, num_workers;
+	int ret = 0;
+
+	if (store == NULL || (jobs == NULL && num_jobs > 0)) {
+		X509error(ERR_R_PASSED_NULL_PARAMETER);
+		return 0;
+	}
+	for (i = 0; i < num_jobs; i++) {
+		if (jobs[i] == NULL) {
+			X509error(ERR_R_PASSED_NULL_PARAMETER);
+			return 0;
+		}
+	}
+
+	if (num_threads > X509_VERIFY_BATCH_MAX_THREADS)
+		num_threads = X509_VERIFY_BATCH_MAX_THREADS;
+	if (num_threads > 1 && (size_t)num_threads > num_jobs)
+		num_threads = num_jobs;
+
+	/* Without a pool, all jobs are processed by the calling thread. */
+	if (num_threads > 1)
+		workers = crypto_workers_new(num_threads);
+
+	for (i = 0; i < num_jobs; i++) {
+		jobs[i]->result = -1;
+		jobs[i]->error = X509_V_ERR_OUT_OF_MEM;
+	}
+
+	/* Each worker reuses a single X509_STORE_CTX for all of its jobs. */
+	num_workers = crypto_workers_count(workers);
+	if ((batch.ctxs = calloc(num_workers, sizeof(*batch.ctxs))) == NULL) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		goto err;
+	}
+
+	if (!crypto_workers_run(workers, num_jobs, x509_verify_batch_job,
+	    &batch)) {
+		X509error(ERR_R_MALLOC_FAILURE);
+		goto err;
+	}
+
+	ret = 1;
+
+ err:
+	if (batch.ctxs != NULL) {
+		for (i = 0; i < num_workers; i++)
+			X509_STORE_CTX_free(batch.ctxs[i]);
+	}
+	free(batch.ctxs);
+	crypto_workers_free(workers);
+
+	return ret;
+}
+LCRYPTO_ALIAS(X509_STORE_verify_batch);
@@ -0,0 +1,418 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* x509_verify_cache */
+
+/*
+ * The verify cache is a per X509_STORE cache of successfully verified
+ * certificate chains.
+ *
+ * Entries are keyed on a hash of the leaf certificate, the untrusted
+ * certificates supplied with it and the verification parameters, and
+ * hold the chain that was built together with the earliest time at
+ * which any certificate in it (or, when CRL checking is enabled, any
+ * CRL for an issuer in it) expires.
+ *
+ * Finding an entry allows X509_verify_cert() to skip chain building and
+ * validation entirely, so it must only be used when nothing other than
+ * the key inputs and the contents of the store can influence the result.
+ * Any change to the store flushes the cache.
+ */
+
+#include <sys/queue.h>
+#include <sys/tree.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/objects.h>
+#include <openssl/x509.h>
+
+#include "x509_internal.h"
+#include "x509_local.h"
+#include "x509_verify_cache.h"
+
+struct x509_verify_cache_entry {
+	RB_ENTRY(x509_verify_cache_entry) entry;
+	TAILQ_ENTRY(x509_verify_cache_entry) queue;	/* LRU of entries */
+	unsigned char key[X509_VERIFY_CACHE_KEY_LEN];
+	STACK_OF(X509) *chain;		/* Verified chain, leaf first. */
+	int num_untrusted;
+	time_t expires;			/* Entry is invalid after this. */
+	char *peername;			/* Host name that matched, if any. */
+};
+
+RB_HEAD(x509_verify_cache_tree, x509_verify_cache_entry);
+TAILQ_HEAD(x509_verify_cache_lru, x509_verify_cache_entry);
+
+struct x509_verify_cache {
+	struct x509_verify_cache_tree tree;
+	struct x509_verify_cache_lru lru;
+	size_t count;
+	size_t max;
+	uint64_t generation;		/* Incremented on every flush. */
+	pthread_mutex_t mutex;
+};
+
+static int
+x509_verify_cache_entry_cmp(struct x509_verify_cache_entry *e1,
+    struct x509_verify_cache_entry *e2)
+{
+	return memcmp(e1->key, e2->key, X509_VERIFY_CACHE_KEY_LEN);
+}
+
+RB_PROTOTYPE_STATIC(x509_verify_cache_tree, x509_verify_cache_entry, entry,
+    x509_verify_cache_entry_cmp);
+RB_GENERATE_STATIC(x509_verify_cache_tree, x509_verify_cache_entry, entry,
+    x509_verify_cache_entry_cmp);
+
+static void
+x509_verify_cache_entry_free(struct x509_verify_cache_entry *e)
+{
+	if (e == NULL)
+		return;
+	sk_X509_pop_free(e->chain, X509_free);
+	free(e->peername);
+	free(e);
+}
+
+struct x509_verify_cache *
+x509_verify_cache_new(size_t max)
+{
+	struct x509_verify_cache *cache;
+
+	if ((cache = calloc(1, sizeof(*cache))) == NULL)
+		return NULL;
+	if (pthread_mutex_init(&cache->mutex, NULL) != 0) {
+		free(cache);
+		return NULL;
+	}
+	RB_INIT(&cache->tree);
+	TAILQ_INIT(&cache->lru);
+	cache->max = max;
+
+	return cache;
+}
+
+/*
+ * Remove an entry from the cache. Must be called with the cache mutex held.
+ */
+static void
+x509_verify_cache_remove(struct x509_verify_cache *cache,
+    struct x509_verify_cache_entry *e)
+{
+	TAILQ_REMOVE(&cache->lru, e, queue);
+	RB_REMOVE(x509_verify_cache_tree, &cache->tree, e);
+	x509_verify_cache_entry_free(e);
+	cache->count--;
+}
+
+/*
+ * Discard least recently used entries until there are at most max left.
+ * Must be called with the cache mutex held.
+ */
+static void
+x509_verify_cache_trim(struct x509_verify_cache *cache, size_t max)
+{
+	while (cache->count > max)
+		x509_verify_cache_remove(cache,
+		    TAILQ_LAST(&cache->lru, x509_verify_cache_lru));
+}
+
+void
+x509_verify_cache_free(struct x509_verify_cache *cache)
+{
+	if (cache == NULL)
+		return;
+	x509_verify_cache_trim(cache, 0);
+	pthread_mutex_destroy(&cache->mutex);
+	free(cache);
+}
+
+void
+x509_verify_cache_set_max(struct x509_verify_cache *cache, size_t max)
+{
+	if (pthread_mutex_lock(&cache->mutex) != 0)
+		return;
+	cache->max = max;
+	x509_verify_cache_trim(cache, max);
+	(void) pthread_mutex_unlock(&cache->mutex);
+}
+
+/*
+ * Discard all entries. This is called whenever the contents of the store
+ * change, since any cached result may depend on what was in the store.
+ */
+void
+x509_verify_cache_flush(struct x509_verify_cache *cache)
+{
+	if (pthread_mutex_lock(&cache->mutex) != 0)
+		return;
+	x509_verify_cache_trim(cache, 0);
+	cache->generation++;
+	(void) pthread_mutex_unlock(&cache->mutex);
+}
+
+static void
+x509_verify_cache_key_u64(SHA512_CTX *sha, uint64_t val)
+{
+	SHA512_Update(sha, &val, sizeof(val));
+}
+
+static void
+x509_verify_cache_key_bytes(SHA512_CTX *sha, const void *data, size_t len)
+{
+	x509_verify_cache_key_u64(sha, len);
+	if (len > 0)
+		SHA512_Update(sha, data, len);
+}
+
+/*
+ * Compute the cache key for the verification described by ctx - this
+ * covers the leaf, the untrusted certificates and all of the verification
+ * parameters that may affect the result. Returns 0 if no key could be
+ * computed, in which case the verification must not be cached.
+ */
+int
+x509_verify_cache_key(X509_STORE_CTX *ctx, unsigned char *key)
+{
+	X509_VERIFY_PARAM *param = ctx->param;
+	ASN1_OBJECT *policy;
+	const char *host;
+	SHA512_CTX sha;
+	X509 *cert;
+	int i;
+
+	if (!SHA512_Init(&sha))
+		return 0;
+
+	if (!x509v3_cache_extensions(ctx->cert))
+		return 0;
+	SHA512_Update(&sha, ctx->cert->hash, X509_CERT_HASH_LEN);
+
+	x509_verify_cache_key_u64(&sha, sk_X509_num(ctx->untrusted));
+	for (i = 0; i < sk_X509_num(ctx->untrusted); i++) {
+		cert = sk_X509_value(ctx->untrusted, i);
+		if (!x509v3_cache_extensions(cert))
+			return 0;
+		SHA512_Update(&sha, cert->hash, X509_CERT_HASH_LEN);
+	}
+
+	x509_verify_cache_key_u64(&sha, param->flags);
+	x509_verify_cache_key_u64(&sha, param->purpose);
+	x509_verify_cache_key_u64(&sha, param->trust);
+	x509_verify_cache_key_u64(&sha, param->depth);
+	x509_verify_cache_key_u64(&sha, param->security_level);
+	x509_verify_cache_key_u64(&sha, param->hostflags);
+	if (param->flags & X509_V_FLAG_USE_CHECK_TIME)
+		x509_verify_cache_key_u64(&sha, param->check_time);
+
+	x509_verify_cache_key_u64(&sha, sk_ASN1_OBJECT_num(param->policies));
+	for (i = 0; i < sk_ASN1_OBJECT_num(param->policies); i++) {
+		policy = sk_ASN1_OBJECT_value(param->policies, i);
+		x509_verify_cache_key_bytes(&sha, OBJ_get0_data(policy),
+		    OBJ_length(policy));
+	}
+	x509_verify_cache_key_u64(&sha, sk_OPENSSL_STRING_num(param->hosts));
+	for (i = 0; i < sk_OPENSSL_STRING_num(param->hosts); i++) {
+		host = sk_OPENSSL_STRING_value(param->hosts, i);
+		x509_verify_cache_key_bytes(&sha, host, strlen(host));
+	}
+	x509_verify_cache_key_bytes(&sha, param->email, param->emaillen);
+	x509_verify_cache_key_bytes(&sha, param->ip, param->iplen);
+
+	return SHA512_Final(key, &sha);
+}
+
+static time_t
+x509_verify_cache_now(X509_STORE_CTX *ctx)
+{
+	if (ctx->param->flags & X509_V_FLAG_USE_CHECK_TIME)
+		return ctx->param->check_time;
+	return time(NULL);
+}
+
+/*
+ * Look up a previous successful verification with the given key. If one
+ * is found and has not expired, the chain is installed on ctx as though
+ * X509_verify_cert() had built it and 1 is returned. Otherwise 0 is
+ * returned, along with the cache generation that must be passed to
+ * x509_verify_cache_add() when adding the result of this verification.
+ */
+int
+x509_verify_cache_find(struct x509_verify_cache *cache,
+    const unsigned char *key, X509_STORE_CTX *ctx, uint64_t *generation)
+{
+	struct x509_verify_cache_entry candidate, *found;
+	STACK_OF(X509) *chain = NULL;
+	char *peername = NULL;
+	int num_untrusted = 0;
+	int ret = 0;
+
+	memcpy(candidate.key, key, X509_VERIFY_CACHE_KEY_LEN);
+
+	if (pthread_mutex_lock(&cache->mutex) != 0)
+		return 0;
+	*generation = cache->generation;
+	if ((found = RB_FIND(x509_verify_cache_tree, &cache->tree,
+	    &candidate)) == NULL)
+		goto done;
+	if ((ctx->param->flags & X509_V_FLAG_NO_CHECK_TIME) == 0 &&
+	    x509_verify_cache_now(ctx) > found->expires) {
+		x509_verify_cache_remove(cache, found);
+		goto done;
+	}
+	TAILQ_REMOVE(&cache->lru, found, queue);
+	TAILQ_INSERT_HEAD(&cache->lru, found, queue);
+	if ((chain = X509_chain_up_ref(found->chain)) == NULL)
+		goto done;
+	if (found->peername != NULL &&
+	    (peername = strdup(found->peername)) == NULL)
+		goto done;
+	num_untrusted = found->num_untrusted;
+	ret = 1;
+ done:
+	(void) pthread_mutex_unlock(&cache->mutex);
+
+	if (!ret)
+		goto err;
+
+	/* The cached leaf is identical, but hand back the caller's copy. */
+	if (!X509_up_ref(ctx->cert))
+		goto err;
+	X509_free(sk_X509_set(chain, 0, ctx->cert));
+
+	sk_X509_pop_free(ctx->chain, X509_free);
+	ctx->chain = chain;
+	ctx->num_untrusted = num_untrusted;
+	ctx->error = X509_V_OK;
+	ctx->error_depth = 0;
+	ctx->current_cert = ctx->cert;
+	if (ctx->param->hosts != NULL) {
+		free(ctx->param->peername);
+		ctx->param->peername = peername;
+		peername = NULL;
+	}
+	free(peername);
+
+	return 1;
+
+ err:
+	sk_X509_pop_free(chain, X509_free);
+	free(peername);
+
+	return 0;
+}
+
+/*
+ * Work out when a verified chain stops being valid. This is the earliest
+ * notAfter of the certificates and, if revocation is being checked, the
+ * earliest nextUpdate of the CRLs for their issuers.
+ */
+static int
+x509_verify_cache_expiry(X509_STORE_CTX *ctx, time_t *out_expires)
+{
+	STACK_OF(X509_CRL) *crls;
+	const ASN1_TIME *next_update;
+	X509_CRL *crl;
+	X509 *cert;
+	time_t expires, t;
+	int i, j;
+
+	expires = INT64_MAX;
+
+	for (i = 0; i < sk_X509_num(ctx->chain); i++) {
+		cert = sk_X509_value(ctx->chain, i);
+		if (!x509_verify_asn1_time_to_time_t(X509_get_notAfter(cert),
+		    1, &t))
+			return 0;
+		if (t < expires)
+			expires = t;
+
+		if ((ctx->param->flags & X509_V_FLAG_CRL_CHECK) == 0)
+			continue;
+		if ((ctx->param->flags & X509_V_FLAG_CRL_CHECK_ALL) == 0 &&
+		    i > 0)
+			continue;
+
+		crls = X509_STORE_CTX_get1_crls(ctx,
+		    X509_get_issuer_name(cert));
+		for (j = 0; j < sk_X509_CRL_num(crls); j++) {
+			crl = sk_X509_CRL_value(crls, j);
+			if ((next_update = X509_CRL_get0_nextUpdate(crl)) == NULL)
+				continue;
+			if (!x509_verify_asn1_time_to_time_t(next_update, 1,
+			    &t)) {
+				sk_X509_CRL_pop_free(crls, X509_CRL_free);
+				return 0;
+			}
+			if (t < expires)
+				expires = t;
+		}
+		sk_X509_CRL_pop_free(crls, X509_CRL_free);
+	}
+
+	*out_expires = expires;
+
+	return 1;
+}
+
+/*
+ * Add the result of a successful verification to the cache. The result
+ * is discarded if the cache has been flushed since the lookup that
+ * returned generation, since the store may have changed underneath it.
+ */
+void
+x509_verify_cache_add(struct x509_verify_cache *cache,
+    const unsigned char *key, uint64_t generation, X509_STORE_CTX *ctx)
+{
+	struct x509_verify_cache_entry *new, *old;
+
+	if (ctx->chain == NULL || ctx->error != X509_V_OK)
+		return;
+
+	if ((new = calloc(1, sizeof(*new))) == NULL)
+		return;
+	memcpy(new->key, key, X509_VERIFY_CACHE_KEY_LEN);
+	if (!x509_verify_cache_expiry(ctx, &new->expires))
+		goto err;
+	if ((new->chain = X509_chain_up_ref(ctx->chain)) == NULL)
+		goto err;
+	new->num_untrusted = ctx->num_untrusted;
+	if (ctx->param->peername != NULL &&
+	    (new->peername = strdup(ctx->param->peername)) == NULL)
+		goto err;
+
+	if (pthread_mutex_lock(&cache->mutex) != 0)
+		goto err;
+	if (cache->max > 0 && cache->generation == generation) {
+		if ((old = RB_FIND(x509_verify_cache_tree, &cache->tree,
+		    new)) != NULL)
+			x509_verify_cache_remove(cache, old);
+		x509_verify_cache_trim(cache, cache->max - 1);
+		RB_INSERT(x509_verify_cache_tree, &cache->tree, new);
+		TAILQ_INSERT_HEAD(&cache->lru, new, queue);
+		cache->count++;
+		new = NULL;
+	}
+	(void) pthread_mutex_unlock(&cache->mutex);
+
+ err:
+	x509_verify_cache_entry_free(new);
+}
@@ -0,0 +1,45 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/* x509_verify_cache */
+#ifndef HEADER_X509_VERIFY_CACHE_H
+#define HEADER_X509_VERIFY_CACHE_H
+
+#include <stdint.h>
+
+#include <openssl/sha.h>
+#include <openssl/x509.h>
+
+__BEGIN_HIDDEN_DECLS
+
+#define X509_VERIFY_CACHE_KEY_LEN	SHA512_DIGEST_LENGTH
+
+struct x509_verify_cache;
+
+struct x509_verify_cache *x509_verify_cache_new(size_t max);
+void x509_verify_cache_free(struct x509_verify_cache *cache);
+void x509_verify_cache_set_max(struct x509_verify_cache *cache, size_t max);
+void x509_verify_cache_flush(struct x509_verify_cache *cache);
+int x509_verify_cache_key(X509_STORE_CTX *ctx, unsigned char *key);
+int x509_verify_cache_find(struct x509_verify_cache *cache,
+    const unsigned char *key, X509_STORE_CTX *ctx, uint64_t *generation);
+void x509_verify_cache_add(struct x509_verify_cache *cache,
+    const unsigned char *key, uint64_t generation, X509_STORE_CTX *ctx);
+
+__END_HIDDEN_DECLS
+
+#endif
@@ -77,6 +77,7 @@
 #include "asn1_local.h"
 #include "x509_internal.h"
 #include "x509_local.h"
+#include "x509_verify_cache.h"
 
 /* CRL score values */
 
@@ -579,10 +580,43 @@ X509_verify_cert_legacy(X509_STORE_CTX *ctx)
 	return ok;
 }
 
+/*
+ * A verification result may only be taken from, or added to, the store's
+ * verify cache if it cannot have been influenced by anything other than
+ * the cache key and the contents of the store - in particular, callbacks
+ * may turn failures into successes.
+ */
+static int
+x509_vfy_verify_cache_usable(X509_STORE_CTX *ctx)
+{
+	if (ctx->store == NULL || ctx->store->verify_cache == NULL)
+		return 0;
+
+	/* Every hook on the context and the store must be the default. */
+	if (ctx->verify != internal_verify)
+		return 0;
+	if (ctx->verify_cb != null_callback)
+		return 0;
+	if (ctx->get_issuer != X509_STORE_CTX_get1_issuer)
+		return 0;
+	if (ctx->check_issued != check_issued)
+		return 0;
+	if (ctx->store->verify != NULL || ctx->store->verify_cb != NULL ||
+	    ctx->store->check_issued != NULL)
+		return 0;
+	if (ctx->trusted != NULL || ctx->crls != NULL || ctx->parent != NULL)
+		return 0;
+
+	return 1;
+}
+
 int
 X509_verify_cert(X509_STORE_CTX *ctx)
 {
 	struct x509_verify_ctx *vctx = NULL;
+	unsigned char cache_key[X509_VERIFY_CACHE_KEY_LEN];
+	uint64_t cache_generation = 0;
+	int use_cache = 0;
 	int chain_count = 0;
 
 	if (ctx->cert == NULL) {
@@ -637,6 +671,14 @@ X509_verify_cert(X509_STORE_CTX *ctx)
 	    (ctx->param->flags & X509_V_FLAG_NO_ALT_CHAINS))
 		return X509_verify_cert_legacy(ctx);
 
+	if (x509_vfy_verify_cache_usable(ctx) &&
+	    x509_verify_cache_key(ctx, cache_key)) {
+		if (x509_verify_cache_find(ctx->store->verify_cache, cache_key,
+		    ctx, &cache_generation))
+			return 1;
+		use_cache = 1;
+	}
+
 	/* Use the modern multi-chain verifier from x509_verify_cert */
 
 	if ((vctx = x509_verify_ctx_new_from_xsc(ctx)) != NULL) {
@@ -645,6 +687,10 @@ X509_verify_cert(X509_STORE_CTX *ctx)
 	}
 	x509_verify_ctx_free(vctx);
 
+	if (use_cache && chain_count > 0)
+		x509_verify_cache_add(ctx->store->verify_cache, cache_key,
+		    cache_generation, ctx);
+
 	/* if we succeed we have a chain in ctx->chain */
 	return chain_count > 0 && ctx->chain != NULL;
 }
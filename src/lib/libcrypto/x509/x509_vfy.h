@@ -306,6 +306,17 @@ int X509_STORE_set_purpose(X509_STORE *ctx, int purpose);
 int X509_STORE_set_trust(X509_STORE *ctx, int trust);
 int X509_STORE_set1_param(X509_STORE *ctx, X509_VERIFY_PARAM *pm);
 X509_VERIFY_PARAM *X509_STORE_get0_param(X509_STORE *ctx);
+int X509_STORE_set_verify_cache(X509_STORE *store, size_t max_entries);
+
+typedef struct X509_VERIFY_JOB_st X509_VERIFY_JOB;
+
+X509_VERIFY_JOB *X509_VERIFY_JOB_new(X509 *leaf, STACK_OF(X509) *untrusted,
+    const X509_VERIFY_PARAM *param);
+void X509_VERIFY_JOB_free(X509_VERIFY_JOB *job);
+int X509_VERIFY_JOB_get_result(const X509_VERIFY_JOB *job);
+int X509_VERIFY_JOB_get_error(const X509_VERIFY_JOB *job);
+int X509_STORE_verify_batch(X509_STORE *store, X509_VERIFY_JOB **jobs,
+    size_t num_jobs, int num_threads);
 
 typedef int (*X509_STORE_CTX_verify_cb)(int, X509_STORE_CTX *);
 
@@ -84,6 +84,8 @@ X509_CRL_set_version(X509_CRL *x, long version)
 	 */
 	if (version < 0 || version > 1)
 		return 0;
+	if (!x509_crl_materialize(x))
+		return 0;
 	if (x->crl->version == NULL) {
 		if ((x->crl->version = ASN1_INTEGER_new()) == NULL)
 			return 0;
@@ -97,6 +99,8 @@ X509_CRL_set_issuer_name(X509_CRL *x, X509_NAME *name)
 {
 	if (x == NULL || x->crl == NULL)
 		return 0;
+	if (!x509_crl_materialize(x))
+		return 0;
 	return X509_NAME_set(&x->crl->issuer, name);
 }
 LCRYPTO_ALIAS(X509_CRL_set_issuer_name);
@@ -108,6 +112,8 @@ X509_CRL_set_lastUpdate(X509_CRL *x, const ASN1_TIME *tm)
 
 	if (x == NULL)
 		return 0;
+	if (!x509_crl_materialize(x))
+		return 0;
 	in = x->crl->lastUpdate;
 	if (in != tm) {
 		in = ASN1_STRING_dup(tm);
@@ -134,6 +140,8 @@ X509_CRL_set_nextUpdate(X509_CRL *x, const ASN1_TIME *tm)
 
 	if (x == NULL)
 		return 0;
+	if (!x509_crl_materialize(x))
+		return 0;
 	in = x->crl->nextUpdate;
 	if (in != tm) {
 		in = ASN1_STRING_dup(tm);
@@ -159,6 +167,9 @@ X509_CRL_sort(X509_CRL *c)
 	X509_REVOKED *r;
 	int i;
 
+	if (!x509_crl_materialize(c))
+		return 0;
+
 	/* Sort the data so it will be written in serial number order */
 	sk_X509_REVOKED_sort(c->crl->revoked);
 	for (i = 0; i < sk_X509_REVOKED_num(c->crl->revoked); i++) {
@@ -232,6 +243,8 @@ LCRYPTO_ALIAS(X509_REVOKED_set_serialNumber);
 int
 i2d_re_X509_CRL_tbs(X509_CRL *crl, unsigned char **pp)
 {
+	if (!x509_crl_materialize(crl))
+		return -1;
 	crl->crl->enc.modified = 1;
 	return i2d_X509_CRL_INFO(crl->crl, pp);
 }
@@ -461,6 +461,8 @@ LCRYPTO_ALIAS(X509_REQ_sign_ctx);
 int
 X509_CRL_sign(X509_CRL *x, EVP_PKEY *pkey, const EVP_MD *md)
 {
+	if (!x509_crl_materialize(x))
+		return 0;
 	x->crl->enc.modified = 1;
 	return ASN1_item_sign(&X509_CRL_INFO_it, x->crl->sig_alg,
 	    x->sig_alg, x->signature, x->crl, pkey, md);
@@ -470,6 +472,8 @@ LCRYPTO_ALIAS(X509_CRL_sign);
 int
 X509_CRL_sign_ctx(X509_CRL *x, EVP_MD_CTX *ctx)
 {
+	if (!x509_crl_materialize(x))
+		return 0;
 	x->crl->enc.modified = 1;
 	return ASN1_item_sign_ctx(&X509_CRL_INFO_it,
 	    x->crl->sig_alg, x->sig_alg, x->signature, x->crl, ctx);
@@ -508,6 +512,8 @@ int
 X509_CRL_digest(const X509_CRL *data, const EVP_MD *type, unsigned char *md,
     unsigned int *len)
 {
+	if (data->index != NULL && !data->crl->enc.modified)
+		return x509_crl_index_digest(data, type, md, len);
 	return ASN1_item_digest(&X509_CRL_it, type, (void *)data, md, len);
 }
 LCRYPTO_ALIAS(X509_CRL_digest);
@@ -695,9 +695,13 @@ ssl_use_certificate_chain_bio(SSL_CTX *ctx, SSL *ssl, BIO *in)
 	if (!ssl_cert_set0_chain(ctx, ssl, NULL))
 		goto err;
 
-	/* Process any additional CA certificates. */
+	/*
+	 * Process any additional CA certificates. Intermediates are commonly
+	 * shared by many contexts, so keep a single copy of each.
+	 */
 	while ((ca = PEM_read_bio_X509(in, NULL, passwd_cb, passwd_arg)) !=
 	    NULL) {
+		ca = X509_intern(ca);
 		if (!ssl_cert_add0_chain_cert(ctx, ssl, ca)) {
 			X509_free(ca);
 			goto err;
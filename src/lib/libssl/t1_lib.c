@@ -151,8 +151,10 @@ tls1_clear(SSL *s)
 }
 
 struct supported_group {
+	uint16_t group_id;
 	int nid;
 	int bits;
+	int tls13_only;
 };
 
 /*
@@ -160,126 +162,192 @@ struct supported_group {
  * https://www.iana.org/assignments/tls-parameters/#tls-parameters-8
  */
 static const struct supported_group nid_list[] = {
-	[1] = {
+	{
+		.group_id = 1,
 		.nid = NID_sect163k1,
 		.bits = 80,
 	},
-	[2] = {
+	{
+		.group_id = 2,
 		.nid = NID_sect163r1,
 		.bits = 80,
 	},
-	[3] = {
+	{
+		.group_id = 3,
 		.nid = NID_sect163r2,
 		.bits = 80,
 	},
-	[4] = {
+	{
+		.group_id = 4,
 		.nid = NID_sect193r1,
 		.bits = 80,
 	},
-	[5] = {
+	{
+		.group_id = 5,
 		.nid = NID_sect193r2,
 		.bits = 80,
 	},
-	[6] = {
+	{
+		.group_id = 6,
 		.nid = NID_sect233k1,
 		.bits = 112,
 	},
-	[7] = {
+	{
+		.group_id = 7,
 		.nid = NID_sect233r1,
 		.bits = 112,
 	},
-	[8] = {
+	{
+		.group_id = 8,
 		.nid = NID_sect239k1,
 		.bits = 112,
 	},
-	[9] = {
+	{
+		.group_id = 9,
 		.nid = NID_sect283k1,
 		.bits = 128,
 	},
-	[10] = {
+	{
+		.group_id = 10,
 		.nid = NID_sect283r1,
 		.bits = 128,
 	},
-	[11] = {
+	{
+		.group_id = 11,
 		.nid = NID_sect409k1,
 		.bits = 192,
 	},
-	[12] = {
+	{
+		.group_id = 12,
 		.nid = NID_sect409r1,
 		.bits = 192,
 	},
-	[13] = {
+	{
+		.group_id = 13,
 		.nid = NID_sect571k1,
 		.bits = 256,
 	},
-	[14] = {
+	{
+		.group_id = 14,
 		.nid = NID_sect571r1,
 		.bits = 256,
 	},
-	[15] = {
+	{
+		.group_id = 15,
 		.nid = NID_secp160k1,
 		.bits = 80,
 	},
-	[16] = {
+	{
+		.group_id = 16,
 		.nid = NID_secp160r1,
 		.bits = 80,
 	},
-	[17] = {
+	{
+		.group_id = 17,
 		.nid = NID_secp160r2,
 		.bits = 80,
 	},
-	[18] = {
+	{
+		.group_id = 18,
 		.nid = NID_secp192k1,
 		.bits = 80,
 	},
-	[19] = {
+	{
+		.group_id = 19,
 		.nid = NID_X9_62_prime192v1,	/* aka secp192r1 */
 		.bits = 80,
 	},
-	[20] = {
+	{
+		.group_id = 20,
 		.nid = NID_secp224k1,
 		.bits = 112,
 	},
-	[21] = {
+	{
+		.group_id = 21,
 		.nid = NID_secp224r1,
 		.bits = 112,
 	},
-	[22] = {
+	{
+		.group_id = 22,
 		.nid = NID_secp256k1,
 		.bits = 128,
 	},
-	[23] = {
+	{
+		.group_id = 23,
 		.nid = NID_X9_62_prime256v1,	/* aka secp256r1 */
 		.bits = 128,
 	},
-	[24] = {
+	{
+		.group_id = 24,
 		.nid = NID_secp384r1,
 		.bits = 192,
 	},
-	[25] = {
+	{
+		.group_id = 25,
 		.nid = NID_secp521r1,
 		.bits = 256,
 	},
-	[26] = {
+	{
+		.group_id = 26,
 		.nid = NID_brainpoolP256r1,
 		.bits = 128,
 	},
-	[27] = {
+	{
+		.group_id = 27,
 		.nid = NID_brainpoolP384r1,
 		.bits = 192,
 	},
-	[28] = {
+	{
+		.group_id = 28,
 		.nid = NID_brainpoolP512r1,
 		.bits = 256,
 	},
-	[29] = {
+	{
+		.group_id = 29,
 		.nid = NID_X25519,
 		.bits = 128,
 	},
+	{
+		.group_id = 4588,
+		.nid = NID_X25519MLKEM768,
+		.bits = 128,
+		.tls13_only = 1,
+	},
 };
 
 #define NID_LIST_LEN (sizeof(nid_list) / sizeof(nid_list[0]))
 
+static const struct supported_group *
+tls1_supported_group_by_id(uint16_t group_id)
+{
+	size_t i;
+
+	for (i = 0; i < NID_LIST_LEN; i++) {
+		if (nid_list[i].group_id == group_id)
+			return &nid_list[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Hybrid key exchange groups only exist as TLSv1.3 key shares and cannot be
+ * used for TLSv1.2 ECDHE.
+ */
+static int
+tls1_group_id_usable(const SSL *ssl, uint16_t group_id)
+{
+	const struct supported_group *sg;
+
+	if ((sg = tls1_supported_group_by_id(group_id)) == NULL)
+		return 0;
+	if (sg->tls13_only &&
+	    ssl->s3->hs.negotiated_tls_version < TLS1_3_VERSION)
+		return 0;
+
+	return 1;
+}
+
 #if 0
 static const uint8_t ecformats_list[] = {
 	TLSEXT_ECPOINTFORMAT_uncompressed,
@@ -334,6 +402,7 @@ static const uint16_t ecgroups_client_default[] = {
 };
 
 static const uint16_t ecgroups_server_default[] = {
+	4588,			/* X25519MLKEM768 (4588) */
 	29,			/* X25519 (29) */
 	23,			/* secp256r1 (23) */
 	24,			/* secp384r1 (24) */
@@ -342,15 +411,12 @@ static const uint16_t ecgroups_server_default[] = {
 int
 tls1_ec_group_id2nid(uint16_t group_id, int *out_nid)
 {
-	int nid;
+	const struct supported_group *sg;
 
-	if (group_id >= NID_LIST_LEN)
+	if ((sg = tls1_supported_group_by_id(group_id)) == NULL)
 		return 0;
 
-	if ((nid = nid_list[group_id].nid) == 0)
-		return 0;
-
-	*out_nid = nid;
+	*out_nid = sg->nid;
 
 	return 1;
 }
@@ -358,15 +424,12 @@ tls1_ec_group_id2nid(uint16_t group_id, int *out_nid)
 int
 tls1_ec_group_id2bits(uint16_t group_id, int *out_bits)
 {
-	int bits;
+	const struct supported_group *sg;
 
-	if (group_id >= NID_LIST_LEN)
+	if ((sg = tls1_supported_group_by_id(group_id)) == NULL)
 		return 0;
 
-	if ((bits = nid_list[group_id].bits) == 0)
-		return 0;
-
-	*out_bits = bits;
+	*out_bits = sg->bits;
 
 	return 1;
 }
@@ -374,14 +437,14 @@ tls1_ec_group_id2bits(uint16_t group_id, int *out_bits)
 int
 tls1_ec_nid2group_id(int nid, uint16_t *out_group_id)
 {
-	uint16_t group_id;
+	size_t i;
 
 	if (nid == 0)
 		return 0;
 
-	for (group_id = 0; group_id < NID_LIST_LEN; group_id++) {
-		if (nid_list[group_id].nid == nid) {
-			*out_group_id = group_id;
+	for (i = 0; i < NID_LIST_LEN; i++) {
+		if (nid_list[i].nid == nid) {
+			*out_group_id = nid_list[i].group_id;
 			return 1;
 		}
 	}
@@ -485,6 +548,9 @@ tls1_count_shared_groups(const SSL *ssl, size_t *out_count)
 		if (!tls1_group_id_present(pref[i], supp, supplen))
 			continue;
 
+		if (!tls1_group_id_usable(ssl, pref[i]))
+			continue;
+
 		if (!ssl_security_shared_group(ssl, pref[i]))
 			continue;
 
@@ -511,6 +577,9 @@ tls1_group_by_index(const SSL *ssl, size_t n, int *out_nid,
 		if (!tls1_group_id_present(pref[i], supp, supplen))
 			continue;
 
+		if (!tls1_group_id_usable(ssl, pref[i]))
+			continue;
+
 		if (!ssl_security_fn(ssl, pref[i]))
 			continue;
 
@@ -616,6 +685,8 @@ tls1_check_group(SSL *s, uint16_t group_id)
 	tls1_get_group_list(s, 0, &groups, &groupslen);
 
 	for (i = 0; i < groupslen; i++) {
+		if (!tls1_group_id_usable(s, groups[i]))
+			continue;
 		if (!ssl_security_supported_group(s, groups[i]))
 			continue;
 		if (groups[i] == group_id)
@@ -16,11 +16,13 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <openssl/curve25519.h>
 #include <openssl/dh.h>
 #include <openssl/ec.h>
 #include <openssl/evp.h>
+#include <openssl/mlkem.h>
 
 #include "bytestring.h"
 #include "ssl_local.h"
@@ -40,6 +42,12 @@ struct tls_key_share {
 	uint8_t *x25519_public;
 	uint8_t *x25519_private;
 	uint8_t *x25519_peer_public;
+
+	uint8_t *mlkem_public;
+	uint8_t *mlkem_private;
+	uint8_t *mlkem_peer_public;
+	uint8_t *mlkem_ciphertext;
+	uint8_t *mlkem_shared_secret;
 };
 
 static struct tls_key_share *
@@ -96,6 +104,12 @@ tls_key_share_free(struct tls_key_share *ks)
 	freezero(ks->x25519_private, X25519_KEY_LENGTH);
 	freezero(ks->x25519_peer_public, X25519_KEY_LENGTH);
 
+	freezero(ks->mlkem_public, MLKEM768_PUBLIC_KEY_BYTES);
+	freezero(ks->mlkem_private, MLKEM768_PRIVATE_KEY_BYTES);
+	freezero(ks->mlkem_peer_public, MLKEM768_PUBLIC_KEY_BYTES);
+	freezero(ks->mlkem_ciphertext, MLKEM768_CIPHERTEXT_BYTES);
+	freezero(ks->mlkem_shared_secret, MLKEM_SHARED_SECRET_BYTES);
+
 	freezero(ks, sizeof(*ks));
 }
 
@@ -230,6 +244,61 @@ tls_key_share_generate_x25519(struct tls_key_share *ks)
 	return ret;
 }
 
+/*
+ * X25519MLKEM768 is a key encapsulation rather than a key agreement. The
+ * client generates an ML-KEM key pair, while the server has already
+ * received the client's encapsulation key and encapsulates to it.
+ */
+static int
+tls_key_share_generate_x25519_mlkem768(struct tls_key_share *ks)
+{
+	uint8_t *public = NULL, *private = NULL;
+	uint8_t *ciphertext = NULL, *secret = NULL;
+	int ret = 0;
+
+	if (ks->mlkem_public != NULL || ks->mlkem_ciphertext != NULL)
+		goto err;
+
+	if (!tls_key_share_generate_x25519(ks))
+		goto err;
+
+	if (ks->mlkem_peer_public != NULL) {
+		if ((ciphertext = calloc(1, MLKEM768_CIPHERTEXT_BYTES)) == NULL)
+			goto err;
+		if ((secret = calloc(1, MLKEM_SHARED_SECRET_BYTES)) == NULL)
+			goto err;
+		if (!MLKEM768_encap(ciphertext, secret, ks->mlkem_peer_public))
+			goto err;
+
+		ks->mlkem_ciphertext = ciphertext;
+		ks->mlkem_shared_secret = secret;
+		ciphertext = NULL;
+		secret = NULL;
+	} else {
+		if ((public = calloc(1, MLKEM768_PUBLIC_KEY_BYTES)) == NULL)
+			goto err;
+		if ((private = calloc(1, MLKEM768_PRIVATE_KEY_BYTES)) == NULL)
+			goto err;
+		if (!MLKEM768_generate_key(public, private))
+			goto err;
+
+		ks->mlkem_public = public;
+		ks->mlkem_private = private;
+		public = NULL;
+		private = NULL;
+	}
+
+	ret = 1;
+
+ err:
+	freezero(public, MLKEM768_PUBLIC_KEY_BYTES);
+	freezero(private, MLKEM768_PRIVATE_KEY_BYTES);
+	freezero(ciphertext, MLKEM768_CIPHERTEXT_BYTES);
+	freezero(secret, MLKEM_SHARED_SECRET_BYTES);
+
+	return ret;
+}
+
 int
 tls_key_share_generate(struct tls_key_share *ks)
 {
@@ -239,6 +308,9 @@ tls_key_share_generate(struct tls_key_share *ks)
 	if (ks->nid == NID_X25519)
 		return tls_key_share_generate_x25519(ks);
 
+	if (ks->nid == NID_X25519MLKEM768)
+		return tls_key_share_generate_x25519_mlkem768(ks);
+
 	return tls_key_share_generate_ecdhe_ecp(ks);
 }
 
@@ -287,6 +359,28 @@ tls_key_share_public_x25519(struct tls_key_share *ks, CBB *cbb)
 	return CBB_add_bytes(cbb, ks->x25519_public, X25519_KEY_LENGTH);
 }
 
+/*
+ * The ML-KEM component comes first, followed by the X25519 public value, as
+ * per draft-kwiatkowski-tls-ecdhe-mlkem.
+ */
+static int
+tls_key_share_public_x25519_mlkem768(struct tls_key_share *ks, CBB *cbb)
+{
+	if (ks->mlkem_ciphertext != NULL) {
+		if (!CBB_add_bytes(cbb, ks->mlkem_ciphertext,
+		    MLKEM768_CIPHERTEXT_BYTES))
+			return 0;
+	} else if (ks->mlkem_public != NULL) {
+		if (!CBB_add_bytes(cbb, ks->mlkem_public,
+		    MLKEM768_PUBLIC_KEY_BYTES))
+			return 0;
+	} else {
+		return 0;
+	}
+
+	return tls_key_share_public_x25519(ks, cbb);
+}
+
 int
 tls_key_share_public(struct tls_key_share *ks, CBB *cbb)
 {
@@ -296,6 +390,9 @@ tls_key_share_public(struct tls_key_share *ks, CBB *cbb)
 	if (ks->nid == NID_X25519)
 		return tls_key_share_public_x25519(ks, cbb);
 
+	if (ks->nid == NID_X25519MLKEM768)
+		return tls_key_share_public_x25519_mlkem768(ks, cbb);
+
 	return tls_key_share_public_ecdhe_ecp(ks, cbb);
 }
 
@@ -383,6 +480,53 @@ tls_key_share_peer_public_x25519(struct tls_key_share *ks, CBS *cbs,
 	return CBS_stow(cbs, &ks->x25519_peer_public, &out_len);
 }
 
+/*
+ * A client that has generated its key pair expects a ciphertext from the
+ * server, otherwise this is a server receiving the client's encapsulation
+ * key, which must pass the FIPS 203 encapsulation key check.
+ */
+static int
+tls_key_share_peer_public_x25519_mlkem768(struct tls_key_share *ks, CBS *cbs,
+    int *decode_error)
+{
+	uint8_t **out;
+	size_t mlkem_len, out_len;
+	CBS mlkem;
+
+	*decode_error = 0;
+
+	if (ks->mlkem_private != NULL) {
+		out = &ks->mlkem_ciphertext;
+		mlkem_len = MLKEM768_CIPHERTEXT_BYTES;
+	} else if (ks->mlkem_public == NULL) {
+		out = &ks->mlkem_peer_public;
+		mlkem_len = MLKEM768_PUBLIC_KEY_BYTES;
+	} else {
+		return 0;
+	}
+
+	if (*out != NULL)
+		return 0;
+
+	if (CBS_len(cbs) != mlkem_len + X25519_KEY_LENGTH) {
+		*decode_error = 1;
+		return 0;
+	}
+	if (!CBS_get_bytes(cbs, &mlkem, mlkem_len)) {
+		*decode_error = 1;
+		return 0;
+	}
+	if (out == &ks->mlkem_peer_public &&
+	    !MLKEM768_check_public_key(CBS_data(&mlkem))) {
+		*decode_error = 1;
+		return 0;
+	}
+	if (!CBS_stow(&mlkem, out, &out_len))
+		return 0;
+
+	return tls_key_share_peer_public_x25519(ks, cbs, decode_error);
+}
+
 int
 tls_key_share_peer_public(struct tls_key_share *ks, CBS *cbs, int *decode_error,
     int *invalid_key)
@@ -399,6 +543,10 @@ tls_key_share_peer_public(struct tls_key_share *ks, CBS *cbs, int *decode_error,
 	if (ks->nid == NID_X25519)
 		return tls_key_share_peer_public_x25519(ks, cbs, decode_error);
 
+	if (ks->nid == NID_X25519MLKEM768)
+		return tls_key_share_peer_public_x25519_mlkem768(ks, cbs,
+		    decode_error);
+
 	return tls_key_share_peer_public_ecdhe_ecp(ks, cbs);
 }
 
@@ -451,6 +599,52 @@ tls_key_share_derive_x25519(struct tls_key_share *ks,
 	return ret;
 }
 
+/*
+ * The shared secret is the ML-KEM shared secret followed by the X25519
+ * shared secret.
+ */
+static int
+tls_key_share_derive_x25519_mlkem768(struct tls_key_share *ks,
+    uint8_t **shared_key, size_t *shared_key_len)
+{
+	uint8_t *sk = NULL, *x25519_sk = NULL;
+	size_t sk_len, x25519_sk_len;
+	int ret = 0;
+
+	sk_len = MLKEM_SHARED_SECRET_BYTES + X25519_KEY_LENGTH;
+	if ((sk = calloc(1, sk_len)) == NULL)
+		goto err;
+
+	if (ks->mlkem_shared_secret != NULL) {
+		memcpy(sk, ks->mlkem_shared_secret, MLKEM_SHARED_SECRET_BYTES);
+	} else if (ks->mlkem_private != NULL &&
+	    ks->mlkem_ciphertext != NULL) {
+		if (!MLKEM768_decap(sk, ks->mlkem_ciphertext,
+		    MLKEM768_CIPHERTEXT_BYTES, ks->mlkem_private))
+			goto err;
+	} else {
+		goto err;
+	}
+
+	if (!tls_key_share_derive_x25519(ks, &x25519_sk, &x25519_sk_len))
+		goto err;
+	if (x25519_sk_len != X25519_KEY_LENGTH)
+		goto err;
+	memcpy(&sk[MLKEM_SHARED_SECRET_BYTES], x25519_sk, X25519_KEY_LENGTH);
+
+	*shared_key = sk;
+	*shared_key_len = sk_len;
+	sk = NULL;
+
+	ret = 1;
+
+ err:
+	freezero(sk, sk_len);
+	freezero(x25519_sk, X25519_KEY_LENGTH);
+
+	return ret;
+}
+
 int
 tls_key_share_derive(struct tls_key_share *ks, uint8_t **shared_key,
     size_t *shared_key_len)
@@ -468,6 +662,10 @@ tls_key_share_derive(struct tls_key_share *ks, uint8_t **shared_key,
 		return tls_key_share_derive_x25519(ks, shared_key,
 		    shared_key_len);
 
+	if (ks->nid == NID_X25519MLKEM768)
+		return tls_key_share_derive_x25519_mlkem768(ks, shared_key,
+		    shared_key_len);
+
 	return tls_key_share_derive_ecdhe_ecp(ks, shared_key,
 	    shared_key_len);
 }
@@ -613,6 +613,66 @@ tls_ssl_cert_verify_cb(X509_STORE_CTX *x509_ctx, void *arg)
 	return (0);
 }
 
+/*
+ * Add the CRLs from a PEM encoded buffer to the store. The CRLs are indexed
+ * rather than fully decoded, since a CRL may list a large number of revoked
+ * certificates and only a few of them are ever looked up.
+ */
+static int
+tls_configure_crls(struct tls *ctx, X509_STORE *store, BIO *bio)
+{
+	char *name = NULL, *header = NULL;
+	unsigned char *data = NULL;
+	long data_len;
+	X509_CRL *crl = NULL;
+	unsigned long err;
+	int rv = -1;
+
+	for (;;) {
+		if (!PEM_read_bio(bio, &name, &header, &data, &data_len)) {
+			err = ERR_peek_last_error();
+			if (ERR_GET_LIB(err) == ERR_LIB_PEM &&
+			    ERR_GET_REASON(err) == PEM_R_NO_START_LINE) {
+				ERR_clear_error();
+				break;
+			}
+			tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+			    "failed to parse crl");
+			goto err;
+		}
+		if (strcmp(name, PEM_STRING_X509_CRL) == 0) {
+			if ((crl = X509_CRL_new_indexed(data,
+			    data_len)) == NULL) {
+				tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+				    "failed to parse crl");
+				goto err;
+			}
+			if (!X509_STORE_add_crl(store, crl)) {
+				tls_set_error(ctx, TLS_ERROR_UNKNOWN,
+				    "failed to add crl");
+				goto err;
+			}
+			X509_CRL_free(crl);
+			crl = NULL;
+		}
+		free(name);
+		free(header);
+		free(data);
+		name = header = NULL;
+		data = NULL;
+	}
+
+	rv = 0;
+
+ err:
+	X509_CRL_free(crl);
+	free(name);
+	free(header);
+	free(data);
+
+	return (rv);
+}
+
 int
 tls_configure_ssl_verify(struct tls *ctx, SSL_CTX *ssl_ctx, int verify)
 {
@@ -621,12 +681,9 @@ tls_configure_ssl_verify(struct tls *ctx, SSL_CTX *ssl_ctx, int verify)
 	char *crl_mem = ctx->config->crl_mem;
 	size_t crl_len = ctx->config->crl_len;
 	char *ca_free = NULL;
-	STACK_OF(X509_INFO) *xis = NULL;
 	X509_STORE *store;
-	X509_INFO *xi;
 	BIO *bio = NULL;
 	int rv = -1;
-	int i;
 
 	SSL_CTX_set_verify(ssl_ctx, verify, NULL);
 	SSL_CTX_set_cert_verify_callback(ssl_ctx, tls_ssl_cert_verify_cb, ctx);
@@ -674,23 +731,9 @@ tls_configure_ssl_verify(struct tls *ctx, SSL_CTX *ssl_ctx, int verify)
 			    "failed to create buffer");
 			goto err;
 		}
-		if ((xis = PEM_X509_INFO_read_bio(bio, NULL, tls_password_cb,
-		    NULL)) == NULL) {
-			tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
-			    "failed to parse crl");
-			goto err;
-		}
 		store = SSL_CTX_get_cert_store(ssl_ctx);
-		for (i = 0; i < sk_X509_INFO_num(xis); i++) {
-			xi = sk_X509_INFO_value(xis, i);
-			if (xi->crl == NULL)
-				continue;
-			if (!X509_STORE_add_crl(store, xi->crl)) {
-				tls_set_error(ctx, TLS_ERROR_UNKNOWN,
-				    "failed to add crl");
-				goto err;
-			}
-		}
+		if (tls_configure_crls(ctx, store, bio) == -1)
+			goto err;
 		X509_STORE_set_flags(store,
 		    X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
 	}
@@ -699,7 +742,6 @@ tls_configure_ssl_verify(struct tls *ctx, SSL_CTX *ssl_ctx, int verify)
 	rv = 0;
 
  err:
-	sk_X509_INFO_pop_free(xis, X509_INFO_free);
 	BIO_free(bio);
 	free(ca_free);
 
@@ -91,6 +91,9 @@ typedef ssize_t (*tls_read_cb)(struct tls *_ctx, void *_buf, size_t _buflen,
     void *_cb_arg);
 typedef ssize_t (*tls_write_cb)(struct tls *_ctx, const void *_buf,
     size_t _buflen, void *_cb_arg);
+typedef int (*tls_ocsp_refresh_cb)(void *_cb_arg, const char *_url,
+    const uint8_t *_request, size_t _request_len, uint8_t **_response,
+    size_t *_response_len);
 
 int tls_init(void);
 
@@ -144,6 +147,8 @@ int tls_config_set_keypair_ocsp_file(struct tls_config *_config,
 int tls_config_set_keypair_ocsp_mem(struct tls_config *_config, const uint8_t *_cert,
     size_t _cert_len, const uint8_t *_key, size_t _key_len,
     const uint8_t *_staple, size_t staple_len);
+int tls_config_set_ocsp_refresh_cb(struct tls_config *_config,
+    tls_ocsp_refresh_cb _cb, void *_cb_arg);
 int tls_config_set_ocsp_staple_mem(struct tls_config *_config,
     const uint8_t *_staple, size_t _len);
 int tls_config_set_ocsp_staple_file(struct tls_config *_config,
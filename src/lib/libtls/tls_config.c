@@ -170,6 +170,8 @@ tls_config_free(struct tls_config *config)
 	if (refcount > 0)
 		return;
 
+	tls_ocsp_refresh_stop(config);
+
 	for (kp = config->keypair; kp != NULL; kp = nkp) {
 		nkp = kp->next;
 		tls_keypair_free(kp);
@@ -846,6 +848,16 @@ tls_config_use_fake_private_key(struct tls_config *config)
 	config->skip_private_key_check = 1;
 }
 
+int
+tls_config_set_ocsp_refresh_cb(struct tls_config *config,
+    tls_ocsp_refresh_cb cb, void *cb_arg)
+{
+	config->ocsp_refresh_cb = cb;
+	config->ocsp_refresh_cb_arg = cb_arg;
+
+	return (0);
+}
+
 int
 tls_config_set_ocsp_staple_file(struct tls_config *config, const char *staple_file)
 {
@@ -61,6 +61,10 @@ struct tls_keypair {
 	char *ocsp_staple;
 	size_t ocsp_staple_len;
 	char *pubkey_hash;
+
+	/* Protects the OCSP staple, which may be replaced while serving. */
+	pthread_mutex_t ocsp_mutex;
+	time_t ocsp_next_update;
 };
 
 #define TLS_MIN_SESSION_TIMEOUT (4)
@@ -83,6 +87,31 @@ typedef int (*tls_sign_cb)(void *_cb_arg, const char *_pubkey_hash,
     const uint8_t *_input, size_t _input_len, int _padding_type,
     uint8_t **_out_signature, size_t *_out_signature_len);
 
+#define TLS_OCSP_MAXAGE_SEC	(14*24*60*60)
+#define TLS_OCSP_JITTER_SEC	(60)
+
+struct tls_ocsp_refresh_keypair {
+	struct tls_keypair *keypair;
+	STACK_OF(X509) *chain;
+	time_t refresh_time;
+};
+
+struct tls_ocsp_refresh {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t thread;
+	pid_t pid;
+	int stop;
+	unsigned int passes;
+
+	/* Snapshot of the configuration, only used by the refresh thread. */
+	tls_ocsp_refresh_cb cb;
+	void *cb_arg;
+	X509_STORE *store;
+	struct tls_ocsp_refresh_keypair *keypairs;
+	size_t keypairs_len;
+};
+
 struct tls_config {
 	struct tls_error error;
 
@@ -119,6 +148,9 @@ struct tls_config {
 	int use_fake_private_key;
 	tls_sign_cb sign_cb;
 	void *sign_cb_arg;
+	tls_ocsp_refresh_cb ocsp_refresh_cb;
+	void *ocsp_refresh_cb_arg;
+	struct tls_ocsp_refresh *ocsp_refresh;
 };
 
 struct tls_conninfo {
@@ -227,6 +259,8 @@ int tls_keypair_set_ocsp_staple_file(struct tls_keypair *_keypair,
     struct tls_error *_error, const char *_ocsp_file);
 int tls_keypair_set_ocsp_staple_mem(struct tls_keypair *_keypair,
     struct tls_error *_error, const uint8_t *_staple, size_t _len);
+void tls_keypair_update_ocsp_staple(struct tls_keypair *_keypair,
+    char *_staple, size_t _len, time_t _next_update);
 int tls_keypair_load_cert(struct tls_keypair *_keypair,
     struct tls_error *_error, X509 **_cert);
 
@@ -291,6 +325,11 @@ int tls_ocsp_verify_cb(SSL *ssl, void *arg);
 int tls_ocsp_stapling_cb(SSL *ssl, void *arg);
 void tls_ocsp_free(struct tls_ocsp *ctx);
 struct tls_ocsp *tls_ocsp_setup_from_peer(struct tls *ctx);
+int tls_ocsp_asn1_parse_time(struct tls *_ctx, ASN1_GENERALIZEDTIME *_gt,
+    time_t *_gt_time);
+int tls_ocsp_refresh_init(struct tls *_ctx);
+int tls_ocsp_refresh_start(struct tls *_ctx);
+void tls_ocsp_refresh_stop(struct tls_config *_config);
 int tls_hex_string(const unsigned char *_in, size_t _inlen, char **_out,
     size_t *_outlen);
 int tls_cert_hash(X509 *_cert, char **_hash);
@@ -26,7 +26,16 @@
 struct tls_keypair *
 tls_keypair_new(void)
 {
-	return calloc(1, sizeof(struct tls_keypair));
+	struct tls_keypair *keypair;
+
+	if ((keypair = calloc(1, sizeof(*keypair))) == NULL)
+		return NULL;
+	if (pthread_mutex_init(&keypair->ocsp_mutex, NULL) != 0) {
+		free(keypair);
+		return NULL;
+	}
+
+	return keypair;
 }
 
 static int
@@ -100,20 +109,54 @@ tls_keypair_set_key_mem(struct tls_keypair *keypair, struct tls_error *error,
 	return tls_set_mem(&keypair->key_mem, &keypair->key_len, key, len);
 }
 
+/*
+ * Replace the OCSP staple, taking ownership of the given buffer. A non-zero
+ * next_update stops the staple from being sent once it has expired.
+ */
+void
+tls_keypair_update_ocsp_staple(struct tls_keypair *keypair, char *staple,
+    size_t len, time_t next_update)
+{
+	char *old_staple;
+
+	pthread_mutex_lock(&keypair->ocsp_mutex);
+	old_staple = keypair->ocsp_staple;
+	keypair->ocsp_staple = staple;
+	keypair->ocsp_staple_len = len;
+	keypair->ocsp_next_update = next_update;
+	pthread_mutex_unlock(&keypair->ocsp_mutex);
+
+	free(old_staple);
+}
+
 int
 tls_keypair_set_ocsp_staple_file(struct tls_keypair *keypair,
     struct tls_error *error, const char *ocsp_file)
 {
-	return tls_config_load_file(error, "ocsp", ocsp_file,
-	    &keypair->ocsp_staple, &keypair->ocsp_staple_len);
+	char *staple = NULL;
+	size_t len = 0;
+
+	if (tls_config_load_file(error, "ocsp", ocsp_file, &staple, &len) == -1)
+		return -1;
+
+	tls_keypair_update_ocsp_staple(keypair, staple, len, 0);
+
+	return 0;
 }
 
 int
 tls_keypair_set_ocsp_staple_mem(struct tls_keypair *keypair,
     struct tls_error *error, const uint8_t *staple, size_t len)
 {
-	return tls_set_mem(&keypair->ocsp_staple, &keypair->ocsp_staple_len,
-	    staple, len);
+	char *new_staple = NULL;
+	size_t new_len = 0;
+
+	if (tls_set_mem(&new_staple, &new_len, staple, len) == -1)
+		return -1;
+
+	tls_keypair_update_ocsp_staple(keypair, new_staple, new_len, 0);
+
+	return 0;
 }
 
 void
@@ -128,6 +171,8 @@ tls_keypair_free(struct tls_keypair *keypair)
 	free(keypair->ocsp_staple);
 	free(keypair->pubkey_hash);
 
+	pthread_mutex_destroy(&keypair->ocsp_mutex);
+
 	free(keypair);
 }
 
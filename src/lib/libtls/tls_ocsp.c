@@ -22,6 +22,7 @@
 #include <netinet/in.h>
 
 #include <string.h>
+#include <time.h>
 
 #include <openssl/err.h>
 #include <openssl/ocsp.h>
@@ -31,9 +32,6 @@
 #include <tls.h>
 #include "tls_internal.h"
 
-#define MAXAGE_SEC (14*24*60*60)
-#define JITTER_SEC (60)
-
 /*
  * State for request.
  */
@@ -57,7 +55,7 @@ tls_ocsp_free(struct tls_ocsp *ocsp)
 	free(ocsp);
 }
 
-static int
+int
 tls_ocsp_asn1_parse_time(struct tls *ctx, ASN1_GENERALIZEDTIME *gt, time_t *gt_time)
 {
 	struct tm tm;
@@ -260,8 +258,8 @@ tls_ocsp_verify_response(struct tls *ctx, OCSP_RESPONSE *resp)
 		goto err;
 	}
 
-	if (OCSP_check_validity(thisupd, nextupd, JITTER_SEC,
-	    MAXAGE_SEC) != 1) {
+	if (OCSP_check_validity(thisupd, nextupd, TLS_OCSP_JITTER_SEC,
+	    TLS_OCSP_MAXAGE_SEC) != 1) {
 		tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
 		    "ocsp verify failed: ocsp response not current");
 		goto err;
@@ -353,23 +351,39 @@ tls_ocsp_stapling_cb(SSL *ssl, void *arg)
 {
 	int ret = SSL_TLSEXT_ERR_ALERT_FATAL;
 	unsigned char *ocsp_staple = NULL;
+	size_t ocsp_staple_len = 0;
+	struct tls_keypair *keypair;
 	struct tls *ctx;
 
 	if ((ctx = SSL_get_app_data(ssl)) == NULL)
 		goto err;
 
-	if (ctx->keypair == NULL || ctx->keypair->ocsp_staple == NULL ||
-	    ctx->keypair->ocsp_staple_len == 0)
+	if ((keypair = ctx->keypair) == NULL)
 		return SSL_TLSEXT_ERR_NOACK;
 
-	if ((ocsp_staple = malloc(ctx->keypair->ocsp_staple_len)) == NULL)
-		goto err;
+	/*
+	 * The staple may be replaced by the refresh thread at any time,
+	 * so take a copy while holding the lock.
+	 */
+	pthread_mutex_lock(&keypair->ocsp_mutex);
+	if (keypair->ocsp_staple == NULL || keypair->ocsp_staple_len == 0 ||
+	    (keypair->ocsp_next_update != 0 &&
+	    time(NULL) > keypair->ocsp_next_update)) {
+		pthread_mutex_unlock(&keypair->ocsp_mutex);
+		return SSL_TLSEXT_ERR_NOACK;
+	}
+	if ((ocsp_staple = malloc(keypair->ocsp_staple_len)) != NULL) {
+		memcpy(ocsp_staple, keypair->ocsp_staple,
+		    keypair->ocsp_staple_len);
+		ocsp_staple_len = keypair->ocsp_staple_len;
+	}
+	pthread_mutex_unlock(&keypair->ocsp_mutex);
 
-	memcpy(ocsp_staple, ctx->keypair->ocsp_staple,
-	    ctx->keypair->ocsp_staple_len);
+	if (ocsp_staple == NULL)
+		goto err;
 
 	if (SSL_set_tlsext_status_ocsp_resp(ctx->ssl_conn, ocsp_staple,
-	    ctx->keypair->ocsp_staple_len) != 1)
+	    ocsp_staple_len) != 1)
 		goto err;
 
 	ret = SSL_TLSEXT_ERR_OK;
@@ -0,0 +1,519 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/ocsp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <tls.h>
+#include "tls_internal.h"
+
+/*
+ * Background refresh of server OCSP staples.
+ *
+ * A single thread per configuration walks the keypairs, fetches a new OCSP
+ * response via the application's refresh callback once half of the current
+ * response's validity period has passed, verifies it and then swaps it into
+ * the keypair. Handshakes only ever copy the already verified staple.
+ *
+ * The certificate chains and CA store are snapshotted when the server is
+ * configured, so that the thread never reads the configuration itself and
+ * the CA can still be loaded before a chroot. The thread is only started
+ * on the first accept, which allows a server to fork after configuring; a
+ * child process that inherits a refresh from its parent starts its own
+ * thread, since the parent's thread does not exist in the child.
+ */
+
+#define TLS_OCSP_REFRESH_MIN_SEC	(60)
+#define TLS_OCSP_REFRESH_MAX_SEC	(24*60*60)
+#define TLS_OCSP_REFRESH_RETRY_SEC	(5*60)
+
+static STACK_OF(X509) *
+tls_ocsp_refresh_load_chain(struct tls_keypair *keypair)
+{
+	STACK_OF(X509) *chain = NULL;
+	BIO *bio = NULL;
+	X509 *cert;
+
+	if (keypair->cert_mem == NULL || keypair->cert_len > INT_MAX)
+		goto err;
+	if ((bio = BIO_new_mem_buf(keypair->cert_mem,
+	    keypair->cert_len)) == NULL)
+		goto err;
+	if ((chain = sk_X509_new_null()) == NULL)
+		goto err;
+	while ((cert = PEM_read_bio_X509(bio, NULL, tls_password_cb,
+	    NULL)) != NULL) {
+		if (!sk_X509_push(chain, cert)) {
+			X509_free(cert);
+			goto err;
+		}
+	}
+	/* Reaching the end of the PEM data leaves an error behind. */
+	ERR_clear_error();
+
+	if (sk_X509_num(chain) < 1)
+		goto err;
+
+	BIO_free(bio);
+
+	return chain;
+
+ err:
+	sk_X509_pop_free(chain, X509_free);
+	BIO_free(bio);
+
+	return NULL;
+}
+
+static X509_STORE *
+tls_ocsp_refresh_store(struct tls *ctx)
+{
+	struct tls_config *config = ctx->config;
+	X509_STORE *store = NULL;
+	size_t ca_len = config->ca_len;
+	char *ca_mem = config->ca_mem;
+	char *ca_free = NULL;
+
+	if ((store = X509_STORE_new()) == NULL) {
+		tls_set_errorx(ctx, TLS_ERROR_OUT_OF_MEMORY, "out of memory");
+		goto err;
+	}
+
+	if (config->ca_mem == NULL && config->ca_path == NULL) {
+		if (tls_config_load_file(&ctx->error, "CA",
+		    tls_default_ca_cert_file(), &ca_mem, &ca_len) != 0)
+			goto err;
+		ca_free = ca_mem;
+	}
+
+	if (ca_mem != NULL) {
+		if (ca_len > INT_MAX) {
+			tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+			    "CA too long");
+			goto err;
+		}
+		if (X509_STORE_load_mem(store, ca_mem, ca_len) != 1) {
+			tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+			    "failed to load CA for OCSP refresh");
+			goto err;
+		}
+	} else if (X509_STORE_load_locations(store, NULL,
+	    config->ca_path) != 1) {
+		tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+		    "failed to set CA path for OCSP refresh");
+		goto err;
+	}
+
+	free(ca_free);
+
+	return store;
+
+ err:
+	X509_STORE_free(store);
+	free(ca_free);
+
+	return NULL;
+}
+
+/*
+ * Verify an OCSP response for the certificate identified by cid, returning
+ * its this update and next update times. The response must be signed by
+ * the certificate's issuer or by a responder that the issuer delegated to,
+ * with the chain verified against the configured CA - the intermediates
+ * from the keypair are only used to build that chain.
+ */
+static int
+tls_ocsp_refresh_verify(const uint8_t *response, size_t response_len,
+    STACK_OF(X509) *intermediates, X509_STORE *store, OCSP_CERTID *cid,
+    time_t *this_update, time_t *next_update)
+{
+	ASN1_GENERALIZEDTIME *revtime = NULL, *thisupd = NULL, *nextupd = NULL;
+	OCSP_RESPONSE *resp = NULL;
+	OCSP_BASICRESP *br = NULL;
+	int cert_status, crl_reason;
+	int rv = -1;
+
+	if (response_len > LONG_MAX)
+		goto err;
+	if ((resp = d2i_OCSP_RESPONSE(NULL, &response, response_len)) == NULL)
+		goto err;
+	if (OCSP_response_status(resp) != OCSP_RESPONSE_STATUS_SUCCESSFUL)
+		goto err;
+	if ((br = OCSP_response_get1_basic(resp)) == NULL)
+		goto err;
+	if (OCSP_basic_verify(br, intermediates, store,
+	    OCSP_NOEXPLICIT) != 1)
+		goto err;
+	if (OCSP_resp_find_status(br, cid, &cert_status, &crl_reason,
+	    &revtime, &thisupd, &nextupd) != 1)
+		goto err;
+
+	/* Like ocspcheck(8), refuse to staple anything but a good response. */
+	if (cert_status != V_OCSP_CERTSTATUS_GOOD)
+		goto err;
+
+	/* Refreshing is driven by next update, so it must be present. */
+	if (thisupd == NULL || nextupd == NULL)
+		goto err;
+	if (OCSP_check_validity(thisupd, nextupd, TLS_OCSP_JITTER_SEC,
+	    TLS_OCSP_MAXAGE_SEC) != 1)
+		goto err;
+	if (tls_ocsp_asn1_parse_time(NULL, thisupd, this_update) != 0)
+		goto err;
+	if (tls_ocsp_asn1_parse_time(NULL, nextupd, next_update) != 0)
+		goto err;
+	if (*this_update >= *next_update)
+		goto err;
+
+	rv = 0;
+
+ err:
+	OCSP_BASICRESP_free(br);
+	OCSP_RESPONSE_free(resp);
+
+	return rv;
+}
+
+static int
+tls_ocsp_refresh_keypair(struct tls_ocsp_refresh *refresh,
+    struct tls_ocsp_refresh_keypair *rkp, time_t now)
+{
+	STACK_OF(OPENSSL_STRING) *urls = NULL;
+	STACK_OF(X509) *intermediates = NULL;
+	OCSP_REQUEST *req = NULL;
+	OCSP_CERTID *cid = NULL, *req_cid = NULL;
+	unsigned char *req_der = NULL;
+	uint8_t *response = NULL;
+	size_t response_len = 0;
+	const char *url = NULL;
+	time_t this_update, next_update, next_refresh;
+	X509 *cert, *issuer;
+	int req_len;
+	int rv = -1;
+
+	rkp->refresh_time = now + TLS_OCSP_REFRESH_RETRY_SEC;
+
+	cert = sk_X509_value(rkp->chain, 0);
+	if ((issuer = X509_find_by_subject(rkp->chain,
+	    X509_get_issuer_name(cert))) == NULL)
+		goto err;
+
+	/* The leaf must never be able to vouch for itself. */
+	if ((intermediates = sk_X509_dup(rkp->chain)) == NULL)
+		goto err;
+	(void)sk_X509_shift(intermediates);
+
+	if ((cid = OCSP_cert_to_id(NULL, cert, issuer)) == NULL)
+		goto err;
+	if ((req_cid = OCSP_CERTID_dup(cid)) == NULL)
+		goto err;
+	if ((req = OCSP_REQUEST_new()) == NULL)
+		goto err;
+	if (OCSP_request_add0_id(req, req_cid) == NULL)
+		goto err;
+	req_cid = NULL;
+	if ((req_len = i2d_OCSP_REQUEST(req, &req_der)) <= 0)
+		goto err;
+
+	if ((urls = X509_get1_ocsp(cert)) != NULL &&
+	    sk_OPENSSL_STRING_num(urls) > 0)
+		url = sk_OPENSSL_STRING_value(urls, 0);
+
+	if (refresh->cb(refresh->cb_arg, url, req_der, req_len, &response,
+	    &response_len) != 0)
+		goto err;
+	if (response == NULL || response_len == 0)
+		goto err;
+
+	if (tls_ocsp_refresh_verify(response, response_len, intermediates,
+	    refresh->store, cid, &this_update, &next_update) != 0)
+		goto err;
+
+	tls_keypair_update_ocsp_staple(rkp->keypair, (char *)response,
+	    response_len, next_update);
+	response = NULL;
+
+	/* Refresh half way through the validity period of the response. */
+	next_refresh = this_update + (next_update - this_update) / 2;
+	if (next_refresh < now + TLS_OCSP_REFRESH_MIN_SEC)
+		next_refresh = now + TLS_OCSP_REFRESH_MIN_SEC;
+	if (next_refresh > now + TLS_OCSP_REFRESH_MAX_SEC)
+		next_refresh = now + TLS_OCSP_REFRESH_MAX_SEC;
+	rkp->refresh_time = next_refresh;
+
+	rv = 0;
+
+ err:
+	sk_X509_free(intermediates);
+	X509_email_free(urls);
+	OCSP_CERTID_free(cid);
+	OCSP_CERTID_free(req_cid);
+	OCSP_REQUEST_free(req);
+	free(req_der);
+	free(response);
+	ERR_clear_error();
+
+	return rv;
+}
+
+static void *
+tls_ocsp_refresh_thread(void *arg)
+{
+	struct tls_ocsp_refresh *refresh = arg;
+	struct tls_ocsp_refresh_keypair *rkp;
+	struct timespec ts;
+	time_t now, next;
+	size_t i;
+
+	pthread_mutex_lock(&refresh->mutex);
+	while (!refresh->stop) {
+		pthread_mutex_unlock(&refresh->mutex);
+
+		now = time(NULL);
+		next = now + TLS_OCSP_REFRESH_MAX_SEC;
+
+		for (i = 0; i < refresh->keypairs_len; i++) {
+			rkp = &refresh->keypairs[i];
+			if (rkp->refresh_time <= now)
+				(void)tls_ocsp_refresh_keypair(refresh, rkp,
+				    now);
+			if (rkp->refresh_time < next)
+				next = rkp->refresh_time;
+		}
+		ERR_clear_error();
+
+		ts.tv_sec = next;
+		ts.tv_nsec = 0;
+
+		pthread_mutex_lock(&refresh->mutex);
+		refresh->passes++;
+		while (!refresh->stop) {
+			if (pthread_cond_timedwait(&refresh->cond,
+			    &refresh->mutex, &ts) == ETIMEDOUT)
+				break;
+		}
+	}
+	pthread_mutex_unlock(&refresh->mutex);
+
+	ERR_remove_thread_state(NULL);
+
+	return NULL;
+}
+
+static void
+tls_ocsp_refresh_free(struct tls_ocsp_refresh *refresh)
+{
+	size_t i;
+
+	if (refresh == NULL)
+		return;
+
+	/*
+	 * A refresh inherited from a parent process may have been forked
+	 * with its mutex held by the parent's thread, so leave it alone.
+	 */
+	if (refresh->pid == 0 || refresh->pid == getpid()) {
+		pthread_cond_destroy(&refresh->cond);
+		pthread_mutex_destroy(&refresh->mutex);
+	}
+
+	for (i = 0; i < refresh->keypairs_len; i++)
+		sk_X509_pop_free(refresh->keypairs[i].chain, X509_free);
+	free(refresh->keypairs);
+	X509_STORE_free(refresh->store);
+
+	free(refresh);
+}
+
+/*
+ * Snapshot the certificate chains of the keypairs and the CA store for the
+ * refresh thread, unless there is no refresh callback or this has already
+ * been done for the configuration.
+ */
+int
+tls_ocsp_refresh_init(struct tls *ctx)
+{
+	struct tls_config *config = ctx->config;
+	struct tls_ocsp_refresh *refresh = NULL;
+	struct tls_ocsp_refresh_keypair *rkp;
+	struct tls_keypair *kp;
+	size_t n = 0;
+	int rv = -1;
+
+	if (config->ocsp_refresh_cb == NULL)
+		return (0);
+
+	pthread_mutex_lock(&config->mutex);
+
+	if (config->ocsp_refresh != NULL) {
+		rv = 0;
+		goto done;
+	}
+
+	if ((refresh = calloc(1, sizeof(*refresh))) == NULL) {
+		tls_set_errorx(ctx, TLS_ERROR_OUT_OF_MEMORY, "out of memory");
+		goto done;
+	}
+	if (pthread_mutex_init(&refresh->mutex, NULL) != 0) {
+		free(refresh);
+		refresh = NULL;
+		tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+		    "failed to initialise OCSP refresh mutex");
+		goto done;
+	}
+	if (pthread_cond_init(&refresh->cond, NULL) != 0) {
+		pthread_mutex_destroy(&refresh->mutex);
+		free(refresh);
+		refresh = NULL;
+		tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+		    "failed to initialise OCSP refresh condition");
+		goto done;
+	}
+	refresh->cb = config->ocsp_refresh_cb;
+	refresh->cb_arg = config->ocsp_refresh_cb_arg;
+
+	for (kp = config->keypair; kp != NULL; kp = kp->next)
+		n++;
+	if ((refresh->keypairs = calloc(n, sizeof(*rkp))) == NULL) {
+		tls_set_errorx(ctx, TLS_ERROR_OUT_OF_MEMORY, "out of memory");
+		goto done;
+	}
+	for (kp = config->keypair; kp != NULL; kp = kp->next) {
+		if (kp->cert_mem == NULL)
+			continue;
+		rkp = &refresh->keypairs[refresh->keypairs_len];
+		if ((rkp->chain = tls_ocsp_refresh_load_chain(kp)) == NULL) {
+			tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+			    "failed to load certificate for OCSP refresh");
+			goto done;
+		}
+		rkp->keypair = kp;
+		refresh->keypairs_len++;
+	}
+
+	if ((refresh->store = tls_ocsp_refresh_store(ctx)) == NULL)
+		goto done;
+
+	config->ocsp_refresh = refresh;
+	refresh = NULL;
+
+	rv = 0;
+
+ done:
+	pthread_mutex_unlock(&config->mutex);
+	tls_ocsp_refresh_free(refresh);
+
+	return (rv);
+}
+
+/*
+ * Start the refresh thread in the current process, unless it is already
+ * running here.
+ */
+int
+tls_ocsp_refresh_start(struct tls *ctx)
+{
+	struct tls_config *config = ctx->config;
+	struct tls_ocsp_refresh *refresh;
+	pid_t pid;
+	size_t i;
+	int rv = -1;
+
+	pthread_mutex_lock(&config->mutex);
+
+	if ((refresh = config->ocsp_refresh) == NULL) {
+		rv = 0;
+		goto done;
+	}
+	if ((pid = getpid()) == refresh->pid) {
+		rv = 0;
+		goto done;
+	}
+
+	if (refresh->pid != 0) {
+		/*
+		 * Forked from a process that ran the thread, which may have
+		 * held any of these locks at the time.
+		 */
+		if (pthread_mutex_init(&refresh->mutex, NULL) != 0 ||
+		    pthread_cond_init(&refresh->cond, NULL) != 0) {
+			tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+			    "failed to initialise OCSP refresh mutex");
+			goto done;
+		}
+		for (i = 0; i < refresh->keypairs_len; i++) {
+			if (pthread_mutex_init(
+			    &refresh->keypairs[i].keypair->ocsp_mutex,
+			    NULL) != 0) {
+				tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+				    "failed to initialise OCSP mutex");
+				goto done;
+			}
+		}
+		refresh->stop = 0;
+		refresh->passes = 0;
+	}
+
+	if (pthread_create(&refresh->thread, NULL, tls_ocsp_refresh_thread,
+	    refresh) != 0) {
+		tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
+		    "failed to start OCSP refresh thread");
+		goto done;
+	}
+	refresh->pid = pid;
+
+	rv = 0;
+
+ done:
+	pthread_mutex_unlock(&config->mutex);
+
+	return (rv);
+}
+
+/*
+ * Stop the refresh thread, waiting for any refresh in progress to complete.
+ */
+void
+tls_ocsp_refresh_stop(struct tls_config *config)
+{
+	struct tls_ocsp_refresh *refresh;
+
+	if ((refresh = config->ocsp_refresh) == NULL)
+		return;
+
+	if (refresh->pid == getpid()) {
+		pthread_mutex_lock(&refresh->mutex);
+		refresh->stop = 1;
+		pthread_cond_signal(&refresh->cond);
+		pthread_mutex_unlock(&refresh->mutex);
+
+		pthread_join(refresh->thread, NULL);
+	}
+
+	config->ocsp_refresh = NULL;
+	tls_ocsp_refresh_free(refresh);
+}
@@ -359,6 +359,8 @@ tls_configure_server(struct tls *ctx)
 		goto err;
 	if (tls_configure_server_sni(ctx) == -1)
 		goto err;
+	if (tls_ocsp_refresh_init(ctx) == -1)
+		goto err;
 
 	return (0);
 
@@ -377,6 +379,9 @@ tls_accept_common(struct tls *ctx)
 		goto err;
 	}
 
+	if (tls_ocsp_refresh_start(ctx) == -1)
+		goto err;
+
 	if ((conn_ctx = tls_server_conn(ctx)) == NULL) {
 		tls_set_errorx(ctx, TLS_ERROR_UNKNOWN,
 		    "connection context failure");
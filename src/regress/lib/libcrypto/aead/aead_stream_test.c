@@ -0,0 +1,581 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+
+#define TEST_SEGMENT_LEN	100
+
+struct aead_stream_test_aead {
+	const char *name;
+	const EVP_AEAD *(*aead)(void);
+};
+
+static const struct aead_stream_test_aead aead_stream_test_aeads[] = {
+	{ "AES-128-GCM", EVP_aead_aes_128_gcm },
+	{ "AES-256-GCM", EVP_aead_aes_256_gcm },
+	{ "ChaCha20-Poly1305", EVP_aead_chacha20_poly1305 },
+	{ "XChaCha20-Poly1305", EVP_aead_xchacha20_poly1305 },
+};
+
+#define N_AEAD_STREAM_TEST_AEADS \
+    (sizeof(aead_stream_test_aeads) / sizeof(aead_stream_test_aeads[0]))
+
+static const size_t aead_stream_test_lengths[] = {
+	0, 1, TEST_SEGMENT_LEN - 1, TEST_SEGMENT_LEN, TEST_SEGMENT_LEN + 1,
+	5 * TEST_SEGMENT_LEN, 17 * TEST_SEGMENT_LEN + 7,
+};
+
+#define N_AEAD_STREAM_TEST_LENGTHS \
+    (sizeof(aead_stream_test_lengths) / sizeof(aead_stream_test_lengths[0]))
+
+static void
+test_fill(uint8_t *buf, size_t len, uint32_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+static int
+test_is_zero(const uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		if (buf[i] != 0)
+			return 0;
+	}
+	return 1;
+}
+
+static size_t
+test_num_segments(size_t len)
+{
+	if (len == 0)
+		return 1;
+	return (len + TEST_SEGMENT_LEN - 1) / TEST_SEGMENT_LEN;
+}
+
+/*
+ * Seal a stream one segment at a time with EVP_AEAD_CTX_seal(), building the
+ * nonces by hand, as the reference for the EVP_AEAD_STREAM functions.
+ */
+static int
+aead_stream_reference_seal(const EVP_AEAD *aead, const uint8_t *key,
+    const uint8_t *prefix, size_t prefix_len, const uint8_t *in,
+    size_t in_len, uint8_t *out, size_t *out_len)
+{
+	EVP_AEAD_CTX *ctx;
+	uint8_t nonce[EVP_MAX_IV_LENGTH * 2];
+	size_t num_segments, segment, seg_len, len;
+	int ret = 0;
+
+	*out_len = 0;
+
+	if ((ctx = EVP_AEAD_CTX_new()) == NULL)
+		errx(1, "EVP_AEAD_CTX_new");
+	if (!EVP_AEAD_CTX_init(ctx, aead, key, EVP_AEAD_key_length(aead),
+	    EVP_AEAD_DEFAULT_TAG_LENGTH, NULL))
+		goto err;
+
+	num_segments = test_num_segments(in_len);
+	for (segment = 0; segment < num_segments; segment++) {
+		memcpy(nonce, prefix, prefix_len);
+		nonce[prefix_len] = segment >> 24;
+		nonce[prefix_len + 1] = segment >> 16;
+		nonce[prefix_len + 2] = segment >> 8;
+		nonce[prefix_len + 3] = segment;
+		nonce[prefix_len + 4] = segment == num_segments - 1;
+
+		seg_len = in_len - segment * TEST_SEGMENT_LEN;
+		if (seg_len > TEST_SEGMENT_LEN)
+			seg_len = TEST_SEGMENT_LEN;
+		if (!EVP_AEAD_CTX_seal(ctx, out + *out_len, &len,
+		    seg_len + EVP_AEAD_max_overhead(aead), nonce,
+		    EVP_AEAD_nonce_length(aead), in + segment * TEST_SEGMENT_LEN,
+		    seg_len, NULL, 0))
+			goto err;
+		*out_len += len;
+	}
+
+	ret = 1;
+
+ err:
+	EVP_AEAD_CTX_free(ctx);
+
+	return ret;
+}
+
+static int
+aead_stream_bio_seal(EVP_AEAD_STREAM *stream, int num_threads,
+    const uint8_t *in, size_t in_len, uint8_t **out, size_t *out_len)
+{
+	BIO *bio_mem = NULL, *bio_aead = NULL;
+	const uint8_t *p;
+	size_t chunk = 1;
+	long len;
+	int ret = 0, n;
+
+	if ((bio_mem = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	if ((bio_aead = BIO_new(BIO_f_aead_stream())) == NULL)
+		errx(1, "BIO_new");
+	if (!BIO_set_aead_stream(bio_aead, stream, 1, num_threads))
+		goto err;
+	BIO_push(bio_aead, bio_mem);
+
+	/* Write in chunks of varying size that do not line up with segments. */
+	while (in_len > 0) {
+		if (chunk > in_len)
+			chunk = in_len;
+		if ((n = BIO_write(bio_aead, in, chunk)) != (int)chunk)
+			goto err;
+		in += chunk;
+		in_len -= chunk;
+		chunk = chunk * 3 + 1;
+	}
+	if (BIO_flush(bio_aead) != 1)
+		goto err;
+
+	/* Writing after the final segment has been sealed must fail. */
+	if (BIO_write(bio_aead, "x", 1) > 0)
+		goto err;
+
+	if ((len = BIO_get_mem_data(bio_mem, &p)) < 0)
+		goto err;
+	if ((*out = malloc(len + 1)) == NULL)
+		errx(1, "malloc");
+	memcpy(*out, p, len);
+	*out_len = len;
+
+	ret = 1;
+
+ err:
+	BIO_free_all(bio_aead);
+
+	return ret;
+}
+
+static int
+aead_stream_bio_open(EVP_AEAD_STREAM *stream, int num_threads,
+    const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len,
+    size_t *read_len)
+{
+	BIO *bio_mem = NULL, *bio_aead = NULL;
+	size_t chunk = 1;
+	int ret = 0, n;
+
+	*read_len = 0;
+
+	if ((bio_mem = BIO_new_mem_buf(in, in_len)) == NULL)
+		errx(1, "BIO_new_mem_buf");
+	if ((bio_aead = BIO_new(BIO_f_aead_stream())) == NULL)
+		errx(1, "BIO_new");
+	if (!BIO_set_aead_stream(bio_aead, stream, 0, num_threads))
+		goto err;
+	BIO_push(bio_aead, bio_mem);
+
+	for (;;) {
+		if (chunk > out_len - *read_len)
+			chunk = out_len - *read_len;
+		if (chunk == 0)
+			chunk = 1;
+		if ((n = BIO_read(bio_aead, out + *read_len, chunk)) <= 0)
+			break;
+		*read_len += n;
+		chunk = chunk * 2 + 3;
+	}
+	if (n < 0 || BIO_get_cipher_status(bio_aead) != 1)
+		goto err;
+
+	ret = 1;
+
+ err:
+	BIO_free_all(bio_aead);
+
+	return ret;
+}
+
+static int
+aead_stream_test_aead(const struct aead_stream_test_aead *sa,
+    size_t in_len, int num_threads)
+{
+	const EVP_AEAD *aead = sa->aead();
+	EVP_AEAD_STREAM *stream = NULL;
+	uint8_t key[32], prefix[32];
+	uint8_t *in = NULL, *want = NULL, *got = NULL, *pt = NULL;
+	uint8_t *bio_ct = NULL;
+	size_t prefix_len, overhead, ct_len, want_len, got_len, pt_len;
+	size_t bio_ct_len, seg_ct_len, num_segments;
+	int failed = 1;
+
+	prefix_len = EVP_AEAD_STREAM_nonce_prefix_length(aead);
+	if (prefix_len == 0 || prefix_len > sizeof(prefix)) {
+		fprintf(stderr, "FAIL: %s: nonce prefix length %zu\n",
+		    sa->name, prefix_len);
+		return 1;
+	}
+
+	test_fill(key, sizeof(key), 1);
+	test_fill(prefix, sizeof(prefix), 2);
+
+	if ((stream = EVP_AEAD_STREAM_new(aead, key, EVP_AEAD_key_length(aead),
+	    prefix, prefix_len, TEST_SEGMENT_LEN)) == NULL) {
+		fprintf(stderr, "FAIL: %s: EVP_AEAD_STREAM_new\n", sa->name);
+		goto failed;
+	}
+	overhead = EVP_AEAD_STREAM_overhead(stream);
+	seg_ct_len = TEST_SEGMENT_LEN + overhead;
+	num_segments = test_num_segments(in_len);
+	ct_len = in_len + num_segments * overhead;
+
+	if ((in = malloc(in_len + 1)) == NULL)
+		errx(1, "malloc");
+	if ((want = malloc(ct_len)) == NULL)
+		errx(1, "malloc");
+	if ((got = malloc(ct_len)) == NULL)
+		errx(1, "malloc");
+	if ((pt = malloc(in_len + 1)) == NULL)
+		errx(1, "malloc");
+	test_fill(in, in_len, in_len);
+
+	if (!aead_stream_reference_seal(aead, key, prefix, prefix_len, in,
+	    in_len, want, &want_len) || want_len != ct_len) {
+		fprintf(stderr, "FAIL: %s: reference seal\n", sa->name);
+		goto failed;
+	}
+
+	if (!EVP_AEAD_STREAM_seal_segments(stream, got, &got_len, ct_len, 0, 1,
+	    in, in_len, num_threads)) {
+		fprintf(stderr, "FAIL: %s: seal %zu bytes with %d threads\n",
+		    sa->name, in_len, num_threads);
+		goto failed;
+	}
+	if (got_len != want_len || memcmp(got, want, want_len) != 0) {
+		fprintf(stderr, "FAIL: %s: seal %zu bytes with %d threads "
+		    "differs from reference\n", sa->name, in_len, num_threads);
+		goto failed;
+	}
+
+	if (!EVP_AEAD_STREAM_open_segments(stream, pt, &pt_len, in_len, 0, 1,
+	    got, got_len, num_threads)) {
+		fprintf(stderr, "FAIL: %s: open %zu bytes with %d threads\n",
+		    sa->name, in_len, num_threads);
+		goto failed;
+	}
+	if (pt_len != in_len || memcmp(pt, in, in_len) != 0) {
+		fprintf(stderr, "FAIL: %s: open %zu bytes with %d threads "
+		    "differs from input\n", sa->name, in_len, num_threads);
+		goto failed;
+	}
+
+	/* A stream that lacks its final segment must not open. */
+	if (EVP_AEAD_STREAM_open_segments(stream, pt, &pt_len, in_len, 0, 0,
+	    got, got_len, num_threads)) {
+		fprintf(stderr, "FAIL: %s: opened final segment as non-final\n",
+		    sa->name);
+		goto failed;
+	}
+	if (num_segments > 1) {
+		if (EVP_AEAD_STREAM_open_segments(stream, pt, &pt_len, in_len,
+		    0, 1, got, (num_segments - 1) * seg_ct_len, num_threads)) {
+			fprintf(stderr, "FAIL: %s: opened truncated stream\n",
+			    sa->name);
+			goto failed;
+		}
+	}
+	if (num_segments > 2) {
+		/* Neither must a stream with segments swapped. */
+		memcpy(got, want + seg_ct_len, seg_ct_len);
+		memcpy(got + seg_ct_len, want, seg_ct_len);
+		if (EVP_AEAD_STREAM_open_segments(stream, pt, &pt_len, in_len,
+		    0, 1, got, got_len, num_threads)) {
+			fprintf(stderr, "FAIL: %s: opened reordered stream\n",
+			    sa->name);
+			goto failed;
+		}
+		memcpy(got, want, got_len);
+	}
+
+	/* Nor a stream with a modified segment, and no output remains. */
+	got[got_len - 1] ^= 1;
+	if (EVP_AEAD_STREAM_open_segments(stream, pt, &pt_len, in_len, 0, 1,
+	    got, got_len, num_threads) || pt_len != 0 ||
+	    !test_is_zero(pt, in_len)) {
+		fprintf(stderr, "FAIL: %s: opened modified stream\n", sa->name);
+		goto failed;
+	}
+	got[got_len - 1] ^= 1;
+
+	/* Segments continue to open individually. */
+	if (!EVP_AEAD_STREAM_open_segment(stream, pt, &pt_len, in_len + 1,
+	    num_segments - 1, 1, got + (num_segments - 1) * seg_ct_len,
+	    got_len - (num_segments - 1) * seg_ct_len) ||
+	    pt_len != in_len - (num_segments - 1) * TEST_SEGMENT_LEN) {
+		fprintf(stderr, "FAIL: %s: open final segment\n", sa->name);
+		goto failed;
+	}
+
+	if (!aead_stream_bio_seal(stream, num_threads, in, in_len, &bio_ct,
+	    &bio_ct_len)) {
+		fprintf(stderr, "FAIL: %s: BIO seal %zu bytes with %d threads\n",
+		    sa->name, in_len, num_threads);
+		goto failed;
+	}
+	if (bio_ct_len != want_len || memcmp(bio_ct, want, want_len) != 0) {
+		fprintf(stderr, "FAIL: %s: BIO seal %zu bytes with %d threads "
+		    "differs from reference\n", sa->name, in_len, num_threads);
+		goto failed;
+	}
+
+	memset(pt, 0, in_len + 1);
+	if (!aead_stream_bio_open(stream, num_threads, want, want_len, pt,
+	    in_len + 1, &pt_len)) {
+		fprintf(stderr, "FAIL: %s: BIO open %zu bytes with %d threads\n",
+		    sa->name, in_len, num_threads);
+		goto failed;
+	}
+	if (pt_len != in_len || memcmp(pt, in, in_len) != 0) {
+		fprintf(stderr, "FAIL: %s: BIO open %zu bytes with %d threads "
+		    "differs from input\n", sa->name, in_len, num_threads);
+		goto failed;
+	}
+
+	/* Dropping the final segment must be detected when reading. */
+	if (aead_stream_bio_open(stream, num_threads, want,
+	    (num_segments - 1) * seg_ct_len, pt, in_len + 1, &pt_len)) {
+		fprintf(stderr, "FAIL: %s: BIO opened truncated stream\n",
+		    sa->name);
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_AEAD_STREAM_free(stream);
+	free(in);
+	free(want);
+	free(got);
+	free(pt);
+	free(bio_ct);
+
+	return failed;
+}
+
+static int
+aead_stream_test_errors(void)
+{
+	const EVP_AEAD *aead = EVP_aead_aes_128_gcm();
+	EVP_AEAD_STREAM *stream = NULL;
+	uint8_t key[16] = { 0 }, prefix[7] = { 0 };
+	uint8_t buf[4 * (TEST_SEGMENT_LEN + 16)], out[sizeof(buf)];
+	size_t out_len;
+	int failed = 1;
+
+	if (EVP_AEAD_STREAM_new(aead, key, sizeof(key), prefix,
+	    sizeof(prefix) - 1, TEST_SEGMENT_LEN) != NULL) {
+		fprintf(stderr, "FAIL: accepted short nonce prefix\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_new(aead, key, sizeof(key), prefix,
+	    sizeof(prefix), 0) != NULL) {
+		fprintf(stderr, "FAIL: accepted zero segment length\n");
+		goto failed;
+	}
+	if ((stream = EVP_AEAD_STREAM_new(aead, key, sizeof(key), prefix,
+	    sizeof(prefix), TEST_SEGMENT_LEN)) == NULL) {
+		fprintf(stderr, "FAIL: EVP_AEAD_STREAM_new\n");
+		goto failed;
+	}
+	memset(buf, 0, sizeof(buf));
+
+	if (EVP_AEAD_STREAM_seal_segment(stream, out, &out_len, sizeof(out),
+	    0, 0, buf, TEST_SEGMENT_LEN - 1)) {
+		fprintf(stderr, "FAIL: sealed short non-final segment\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_seal_segments(stream, out, &out_len, sizeof(out),
+	    0, 0, buf, TEST_SEGMENT_LEN + 1, 1)) {
+		fprintf(stderr, "FAIL: sealed partial non-final segments\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_seal_segments(stream, out, &out_len, sizeof(out),
+	    UINT32_MAX, 1, buf, 2 * TEST_SEGMENT_LEN, 1)) {
+		fprintf(stderr, "FAIL: sealed beyond last segment number\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_seal_segments(stream, buf + 1, &out_len,
+	    sizeof(buf) - 1, 0, 1, buf, TEST_SEGMENT_LEN, 1)) {
+		fprintf(stderr, "FAIL: sealed into overlapping output\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_seal_segments(stream, out, &out_len,
+	    TEST_SEGMENT_LEN + 15, 0, 1, buf, TEST_SEGMENT_LEN, 1)) {
+		fprintf(stderr, "FAIL: sealed into short output\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_open_segments(stream, out, &out_len, sizeof(out),
+	    0, 1, buf, 0, 1)) {
+		fprintf(stderr, "FAIL: opened empty stream\n");
+		goto failed;
+	}
+	if (EVP_AEAD_STREAM_open_segments(stream, out, &out_len, sizeof(out),
+	    0, 1, buf, TEST_SEGMENT_LEN + 16 + 15, 1)) {
+		fprintf(stderr, "FAIL: opened stream with short final segment\n");
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_AEAD_STREAM_free(stream);
+
+	return failed;
+}
+
+static int
+aead_stream_test(void)
+{
+	static const int threads[] = { 1, 3, 8 };
+	size_t i, j, k;
+	int failed = 0;
+
+	for (i = 0; i < N_AEAD_STREAM_TEST_AEADS; i++) {
+		for (j = 0; j < N_AEAD_STREAM_TEST_LENGTHS; j++) {
+			for (k = 0; k < sizeof(threads) / sizeof(threads[0]);
+			    k++)
+				failed |= aead_stream_test_aead(
+				    &aead_stream_test_aeads[i],
+				    aead_stream_test_lengths[j], threads[k]);
+		}
+	}
+	failed |= aead_stream_test_errors();
+
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+aead_stream_benchmark_run(const char *label, const EVP_AEAD *aead,
+    size_t segment_len, size_t len, int num_threads, int seconds)
+{
+	struct timespec start, end, duration;
+	EVP_AEAD_STREAM *stream;
+	uint8_t key[32], prefix[32];
+	uint8_t *in, *out;
+	size_t out_len, max_out_len;
+	double secs;
+	uint64_t i;
+
+	test_fill(key, sizeof(key), 0);
+	test_fill(prefix, sizeof(prefix), 0);
+	if ((stream = EVP_AEAD_STREAM_new(aead, key, EVP_AEAD_key_length(aead),
+	    prefix, EVP_AEAD_STREAM_nonce_prefix_length(aead),
+	    segment_len)) == NULL)
+		errx(1, "EVP_AEAD_STREAM_new failed");
+
+	max_out_len = len + (len / segment_len + 1) *
+	    EVP_AEAD_STREAM_overhead(stream);
+	if ((in = calloc(1, len)) == NULL)
+		errx(1, "calloc");
+	if ((out = malloc(max_out_len)) == NULL)
+		errx(1, "malloc");
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s (%zu byte segments, %d threads) "
+	    "for %ds: ", label, segment_len, num_threads, seconds);
+	while (!benchmark_stop) {
+		if (!EVP_AEAD_STREAM_seal_segments(stream, out, &out_len,
+		    max_out_len, 0, 1, in, len, num_threads))
+			errx(1, "EVP_AEAD_STREAM_seal_segments failed");
+		i++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu runs in %f seconds (%.2f MB/s)\n",
+	    (unsigned long long)i, secs, i * len / secs / 1000000.0);
+
+	EVP_AEAD_STREAM_free(stream);
+	free(in);
+	free(out);
+}
+
+static void
+aead_stream_benchmark(void)
+{
+	long ncpu;
+	int threads;
+
+	if ((ncpu = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+		ncpu = 1;
+	threads = ncpu > 16 ? 16 : ncpu;
+
+	aead_stream_benchmark_run("AES-128-GCM", EVP_aead_aes_128_gcm(),
+	    65536, 64 * 1024 * 1024, 1, 3);
+	aead_stream_benchmark_run("AES-128-GCM", EVP_aead_aes_128_gcm(),
+	    65536, 64 * 1024 * 1024, threads, 3);
+	aead_stream_benchmark_run("ChaCha20-Poly1305",
+	    EVP_aead_chacha20_poly1305(), 65536, 64 * 1024 * 1024, 1, 3);
+	aead_stream_benchmark_run("ChaCha20-Poly1305",
+	    EVP_aead_chacha20_poly1305(), 65536, 64 * 1024 * 1024, threads, 3);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= aead_stream_test();
+
+	if (benchmark && !failed)
+		aead_stream_benchmark();
+
+	return failed;
+}
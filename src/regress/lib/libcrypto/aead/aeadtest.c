@@ -106,6 +106,14 @@ aead_from_name(const EVP_AEAD **aead, const EVP_CIPHER **cipher,
 	} else if (strcmp(name, "aes-256-gcm") == 0) {
 		*aead = EVP_aead_aes_256_gcm();
 		*cipher = EVP_aes_256_gcm();
+	} else if (strcmp(name, "aes-128-gcm-siv") == 0) {
+		*aead = EVP_aead_aes_128_gcm_siv();
+	} else if (strcmp(name, "aes-256-gcm-siv") == 0) {
+		*aead = EVP_aead_aes_256_gcm_siv();
+	} else if (strcmp(name, "aes-128-ccm") == 0) {
+		*aead = EVP_aead_aes_128_ccm();
+	} else if (strcmp(name, "aes-256-ccm") == 0) {
+		*aead = EVP_aead_aes_256_ccm();
 	} else if (strcmp(name, "chacha20-poly1305") == 0) {
 		*aead = EVP_aead_chacha20_poly1305();
 		*cipher = EVP_chacha20_poly1305();
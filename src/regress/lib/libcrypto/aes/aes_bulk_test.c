@@ -0,0 +1,421 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/aes.h>
+#include <openssl/evp.h>
+
+#define TEST_BLOCKS	67
+
+static void
+test_fill(uint8_t *buf, size_t len, uint32_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+static void
+xts_mul_alpha(uint8_t tweak[AES_BLOCK_SIZE])
+{
+	uint8_t carry = 0, c;
+	size_t i;
+
+	for (i = 0; i < AES_BLOCK_SIZE; i++) {
+		c = tweak[i] >> 7;
+		tweak[i] = tweak[i] << 1 | carry;
+		carry = c;
+	}
+	if (carry)
+		tweak[0] ^= 0x87;
+}
+
+static void
+xts_block(const uint8_t *in, uint8_t *out, const AES_KEY *key,
+    const uint8_t tweak[AES_BLOCK_SIZE], int enc)
+{
+	uint8_t buf[AES_BLOCK_SIZE];
+	size_t i;
+
+	for (i = 0; i < AES_BLOCK_SIZE; i++)
+		buf[i] = in[i] ^ tweak[i];
+	if (enc)
+		AES_encrypt(buf, buf, key);
+	else
+		AES_decrypt(buf, buf, key);
+	for (i = 0; i < AES_BLOCK_SIZE; i++)
+		out[i] = buf[i] ^ tweak[i];
+}
+
+/*
+ * Straightforward XTS implementation as per IEEE 1619, including ciphertext
+ * stealing, used as the reference for the EVP implementation.
+ */
+static void
+xts_reference(const uint8_t *in, uint8_t *out, size_t len,
+    const uint8_t *key, int key_bits, const uint8_t iv[AES_BLOCK_SIZE],
+    int enc)
+{
+	uint8_t tweak[AES_BLOCK_SIZE], tweak1[AES_BLOCK_SIZE];
+	uint8_t buf[AES_BLOCK_SIZE];
+	AES_KEY key1, key2;
+	size_t blocks, tail, i;
+
+	if (enc)
+		AES_set_encrypt_key(key, key_bits, &key1);
+	else
+		AES_set_decrypt_key(key, key_bits, &key1);
+	AES_set_encrypt_key(key + key_bits / 8, key_bits, &key2);
+	AES_encrypt(iv, tweak, &key2);
+
+	blocks = len / AES_BLOCK_SIZE;
+	tail = len % AES_BLOCK_SIZE;
+	if (tail != 0 && !enc)
+		blocks--;
+
+	for (i = 0; i < blocks; i++) {
+		xts_block(in, out, &key1, tweak, enc);
+		xts_mul_alpha(tweak);
+		in += AES_BLOCK_SIZE;
+		out += AES_BLOCK_SIZE;
+	}
+	if (tail == 0)
+		return;
+
+	if (enc) {
+		memcpy(buf, out - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+		memcpy(out, buf, tail);
+		memcpy(buf, in, tail);
+		xts_block(buf, out - AES_BLOCK_SIZE, &key1, tweak, 1);
+	} else {
+		memcpy(tweak1, tweak, sizeof(tweak1));
+		xts_mul_alpha(tweak1);
+		xts_block(in, buf, &key1, tweak1, 0);
+		memcpy(out + AES_BLOCK_SIZE, buf, tail);
+		memcpy(buf, in + AES_BLOCK_SIZE, tail);
+		xts_block(buf, out, &key1, tweak, 0);
+	}
+}
+
+/* IEEE 1619 test vector 15 - a 17 byte data unit. */
+static const uint8_t xts_kat_key[32] = {
+	0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8,
+	0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+	0xbf, 0xbe, 0xbd, 0xbc, 0xbb, 0xba, 0xb9, 0xb8,
+	0xb7, 0xb6, 0xb5, 0xb4, 0xb3, 0xb2, 0xb1, 0xb0,
+};
+static const uint8_t xts_kat_iv[16] = {
+	0x9a, 0x78, 0x56, 0x34, 0x12,
+};
+static const uint8_t xts_kat_pt[17] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10,
+};
+static const uint8_t xts_kat_ct[17] = {
+	0x6c, 0x16, 0x25, 0xdb, 0x46, 0x71, 0x52, 0x2d,
+	0x3d, 0x75, 0x99, 0x60, 0x1d, 0xe7, 0xca, 0x09,
+	0xed,
+};
+
+static int
+aes_xts_cipher(const EVP_CIPHER *cipher, const uint8_t *key,
+    const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len, int enc)
+{
+	EVP_CIPHER_CTX *ctx;
+	int out_len;
+	int ret = 0;
+
+	if ((ctx = EVP_CIPHER_CTX_new()) == NULL)
+		errx(1, "EVP_CIPHER_CTX_new failed");
+	if (!EVP_CipherInit_ex(ctx, cipher, NULL, key, iv, enc))
+		goto err;
+	if (!EVP_CipherUpdate(ctx, out, &out_len, in, len))
+		goto err;
+
+	ret = 1;
+
+ err:
+	EVP_CIPHER_CTX_free(ctx);
+
+	return ret;
+}
+
+static int
+aes_xts_kat_test(void)
+{
+	uint8_t out[sizeof(xts_kat_pt)];
+	int failed = 1;
+
+	if (!aes_xts_cipher(EVP_aes_128_xts(), xts_kat_key, xts_kat_iv,
+	    xts_kat_pt, out, sizeof(xts_kat_pt), 1))
+		errx(1, "AES-128-XTS encryption failed");
+	if (memcmp(out, xts_kat_ct, sizeof(xts_kat_ct)) != 0) {
+		fprintf(stderr, "FAIL: AES-128-XTS encryption differs\n");
+		goto failed;
+	}
+	if (!aes_xts_cipher(EVP_aes_128_xts(), xts_kat_key, xts_kat_iv,
+	    out, out, sizeof(out), 0))
+		errx(1, "AES-128-XTS decryption failed");
+	if (memcmp(out, xts_kat_pt, sizeof(xts_kat_pt)) != 0) {
+		fprintf(stderr, "FAIL: AES-128-XTS decryption differs\n");
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+/*
+ * Compare XTS encryption and decryption with the reference implementation,
+ * for every length from one block up to TEST_BLOCKS blocks, in place and
+ * out of place.
+ */
+static int
+aes_xts_cipher_test(const char *name, const EVP_CIPHER *cipher, int key_bits)
+{
+	uint8_t in[TEST_BLOCKS * AES_BLOCK_SIZE];
+	uint8_t out[TEST_BLOCKS * AES_BLOCK_SIZE];
+	uint8_t want[TEST_BLOCKS * AES_BLOCK_SIZE];
+	uint8_t key[64], iv[AES_BLOCK_SIZE];
+	size_t len;
+	int enc;
+	int failed = 1;
+
+	for (len = AES_BLOCK_SIZE; len <= sizeof(in); len++) {
+		for (enc = 1; enc >= 0; enc--) {
+			test_fill(key, sizeof(key), len);
+			test_fill(iv, sizeof(iv), len + 1);
+			test_fill(in, sizeof(in), len + 2);
+
+			xts_reference(in, want, len, key, key_bits, iv, enc);
+
+			memset(out, 0, sizeof(out));
+			if (!aes_xts_cipher(cipher, key, iv, in, out, len,
+			    enc))
+				errx(1, "%s cipher failed", name);
+			if (memcmp(out, want, len) != 0) {
+				fprintf(stderr, "FAIL: %s %s of %zu bytes "
+				    "differs\n", name,
+				    enc ? "encryption" : "decryption", len);
+				goto failed;
+			}
+
+			if (!aes_xts_cipher(cipher, key, iv, in, in, len, enc))
+				errx(1, "%s cipher failed", name);
+			if (memcmp(in, want, len) != 0) {
+				fprintf(stderr, "FAIL: %s in place %s of %zu "
+				    "bytes differs\n", name,
+				    enc ? "encryption" : "decryption", len);
+				goto failed;
+			}
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+/*
+ * Compare CBC decryption of all blocks at once with decryption split over
+ * two updates and with the single block implementation.
+ */
+static int
+aes_cbc_decrypt_test(const char *name, const EVP_CIPHER *cipher,
+    int key_bits)
+{
+	uint8_t in[TEST_BLOCKS * AES_BLOCK_SIZE];
+	uint8_t out[TEST_BLOCKS * AES_BLOCK_SIZE];
+	uint8_t want[TEST_BLOCKS * AES_BLOCK_SIZE];
+	uint8_t key[32], iv[AES_BLOCK_SIZE], chain[AES_BLOCK_SIZE];
+	EVP_CIPHER_CTX *ctx = NULL;
+	AES_KEY aes_key;
+	size_t i, j, n, split;
+	int out_len;
+	int failed = 1;
+
+	if ((ctx = EVP_CIPHER_CTX_new()) == NULL)
+		errx(1, "EVP_CIPHER_CTX_new failed");
+
+	for (n = 1; n <= TEST_BLOCKS; n++) {
+		test_fill(key, sizeof(key), n);
+		test_fill(iv, sizeof(iv), n + 1);
+		test_fill(in, sizeof(in), n + 2);
+
+		AES_set_decrypt_key(key, key_bits, &aes_key);
+		memcpy(chain, iv, sizeof(chain));
+		for (i = 0; i < n; i++) {
+			AES_decrypt(&in[i * AES_BLOCK_SIZE],
+			    &want[i * AES_BLOCK_SIZE], &aes_key);
+			for (j = 0; j < AES_BLOCK_SIZE; j++)
+				want[i * AES_BLOCK_SIZE + j] ^= chain[j];
+			memcpy(chain, &in[i * AES_BLOCK_SIZE], sizeof(chain));
+		}
+
+		if (!EVP_DecryptInit_ex(ctx, cipher, NULL, key, iv))
+			errx(1, "EVP_DecryptInit_ex failed");
+		EVP_CIPHER_CTX_set_padding(ctx, 0);
+		memset(out, 0, sizeof(out));
+		if (!EVP_DecryptUpdate(ctx, out, &out_len, in,
+		    n * AES_BLOCK_SIZE))
+			errx(1, "EVP_DecryptUpdate failed");
+		if (memcmp(out, want, n * AES_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: %s decryption of %zu blocks "
+			    "differs\n", name, n);
+			goto failed;
+		}
+
+		/* Split in two, in place, to check IV chaining. */
+		split = (n / 2) * AES_BLOCK_SIZE;
+		if (!EVP_DecryptInit_ex(ctx, cipher, NULL, key, iv))
+			errx(1, "EVP_DecryptInit_ex failed");
+		EVP_CIPHER_CTX_set_padding(ctx, 0);
+		if (!EVP_DecryptUpdate(ctx, in, &out_len, in, split))
+			errx(1, "EVP_DecryptUpdate failed");
+		if (!EVP_DecryptUpdate(ctx, &in[split], &out_len, &in[split],
+		    n * AES_BLOCK_SIZE - split))
+			errx(1, "EVP_DecryptUpdate failed");
+		if (memcmp(in, want, n * AES_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: %s in place decryption of %zu "
+			    "blocks differs\n", name, n);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_CIPHER_CTX_free(ctx);
+
+	return failed;
+}
+
+static int
+aes_bulk_test(void)
+{
+	int failed = 0;
+
+	failed |= aes_xts_kat_test();
+	failed |= aes_xts_cipher_test("AES-128-XTS", EVP_aes_128_xts(), 128);
+	failed |= aes_xts_cipher_test("AES-256-XTS", EVP_aes_256_xts(), 256);
+	failed |= aes_cbc_decrypt_test("AES-128-CBC", EVP_aes_128_cbc(), 128);
+	failed |= aes_cbc_decrypt_test("AES-192-CBC", EVP_aes_192_cbc(), 192);
+	failed |= aes_cbc_decrypt_test("AES-256-CBC", EVP_aes_256_cbc(), 256);
+
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+aes_benchmark_run(const char *label, const EVP_CIPHER *cipher, int enc,
+    size_t len, int seconds)
+{
+	struct timespec start, end, duration;
+	uint8_t buf[16384], key[64], iv[AES_BLOCK_SIZE];
+	EVP_CIPHER_CTX *ctx;
+	double secs;
+	uint64_t i;
+	int out_len;
+
+	if ((ctx = EVP_CIPHER_CTX_new()) == NULL)
+		errx(1, "EVP_CIPHER_CTX_new failed");
+
+	test_fill(key, sizeof(key), 0);
+	memset(iv, 0, sizeof(iv));
+	test_fill(buf, sizeof(buf), 0);
+	if (!EVP_CipherInit_ex(ctx, cipher, NULL, key, iv, enc))
+		errx(1, "EVP_CipherInit_ex failed");
+	EVP_CIPHER_CTX_set_padding(ctx, 0);
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s (%zu bytes) for %ds: ", label, len,
+	    seconds);
+	while (!benchmark_stop) {
+		if (!EVP_CipherUpdate(ctx, buf, &out_len, buf, len))
+			errx(1, "EVP_CipherUpdate failed");
+		i++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu runs in %f seconds (%.2f MB/s)\n",
+	    (unsigned long long)i, secs, i * len / secs / 1000000.0);
+
+	EVP_CIPHER_CTX_free(ctx);
+}
+
+static void
+aes_benchmark(void)
+{
+	aes_benchmark_run("AES-256-XTS encrypt", EVP_aes_256_xts(), 1,
+	    512, 3);
+	aes_benchmark_run("AES-256-XTS encrypt", EVP_aes_256_xts(), 1,
+	    16384, 3);
+	aes_benchmark_run("AES-256-XTS decrypt", EVP_aes_256_xts(), 0,
+	    16384, 3);
+	aes_benchmark_run("AES-128-CBC decrypt", EVP_aes_128_cbc(), 0,
+	    16384, 3);
+	aes_benchmark_run("AES-256-CBC decrypt", EVP_aes_256_cbc(), 0,
+	    16384, 3);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= aes_bulk_test();
+
+	if (benchmark && !failed)
+		aes_benchmark();
+
+	return failed;
+}
@@ -23,6 +23,7 @@
 #include <openssl/bn.h>
 #include <openssl/err.h>
 
+#include "bn_fixed.h"
 #include "bn_local.h"
 
 #define N_MOD_EXP_TESTS		100
@@ -709,6 +710,60 @@ test_bn_mod_exp_aliasing(void)
 	return failed;
 }
 
+static int
+test_bn_fixed_mod_exp(void)
+{
+	BIGNUM *a, *p, *m, *want, *got;
+	BN_MONT_CTX *mctx;
+	BN_CTX *ctx;
+	int i;
+	int failed = 0;
+
+	if ((ctx = BN_CTX_new()) == NULL)
+		errx(1, "BN_CTX_new");
+	if ((mctx = BN_MONT_CTX_new()) == NULL)
+		errx(1, "BN_MONT_CTX_new");
+
+	BN_CTX_start(ctx);
+
+	if ((a = BN_CTX_get(ctx)) == NULL)
+		errx(1, "a = BN_CTX_get()");
+	if ((p = BN_CTX_get(ctx)) == NULL)
+		errx(1, "p = BN_CTX_get()");
+	if ((m = BN_CTX_get(ctx)) == NULL)
+		errx(1, "m = BN_CTX_get()");
+	if ((want = BN_CTX_get(ctx)) == NULL)
+		errx(1, "want = BN_CTX_get()");
+	if ((got = BN_CTX_get(ctx)) == NULL)
+		errx(1, "got = BN_CTX_get()");
+
+	for (i = 0; i < N_MOD_EXP_TESTS && !failed; i++) {
+		if (!generate_test_triple(1, a, p, m, ctx))
+			errx(1, "generate_test_triple");
+		if (!BN_MONT_CTX_set(mctx, m, ctx))
+			errx(1, "BN_MONT_CTX_set");
+		if (!bn_fixed_mont_supported(mctx, a))
+			continue;
+
+		if (!BN_mod_exp_simple(want, a, p, m, ctx))
+			errx(1, "BN_mod_exp_simple");
+		if (!bn_fixed_mod_exp_mont(got, a, p, mctx))
+			errx(1, "bn_fixed_mod_exp_mont");
+
+		if (BN_cmp(want, got) != 0) {
+			dump_results(a, p, NULL, NULL, m, want, got,
+			    "bn_fixed_mod_exp_mont");
+			failed |= 1;
+		}
+	}
+
+	BN_CTX_end(ctx);
+	BN_CTX_free(ctx);
+	BN_MONT_CTX_free(mctx);
+
+	return failed;
+}
+
 int
 main(void)
 {
@@ -719,6 +774,7 @@ main(void)
 	failed |= test_bn_mod_exp2();
 	failed |= test_bn_mod_exp2_mont_crash();
 	failed |= test_bn_mod_exp_aliasing();
+	failed |= test_bn_fixed_mod_exp();
 
 	return failed;
 }
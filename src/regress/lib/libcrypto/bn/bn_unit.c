@@ -24,6 +24,8 @@
 
 #include <openssl/bn.h>
 
+#include "bn_local.h"
+
 static int
 test_bn_print_wrapper(char *a, size_t size, const char *descr,
     int (*to_bn)(BIGNUM **, const char *))
@@ -291,6 +293,74 @@ test_bn_dup_consttime_is_sticky(void)
 	return failed;
 }
 
+static int
+test_bn_ctx_get_thread(void)
+{
+	BN_CTX *ctx, *ctx2 = NULL, *thread_ctx;
+	BIGNUM *a, *b;
+	int failed = 1;
+
+	if ((ctx = bn_ctx_get_thread()) == NULL)
+		errx(1, "%s: bn_ctx_get_thread", __func__);
+	if ((ctx2 = bn_ctx_get_thread()) != ctx) {
+		fprintf(stderr, "FAIL: %s: nested context differs\n", __func__);
+		goto failure;
+	}
+
+	BN_CTX_start(ctx);
+	if ((a = BN_CTX_get(ctx)) == NULL)
+		errx(1, "%s: BN_CTX_get", __func__);
+	if (!BN_set_word(a, 42))
+		errx(1, "%s: BN_set_word", __func__);
+
+	/* A nested user gets a fresh frame. */
+	BN_CTX_start(ctx2);
+	if ((b = BN_CTX_get(ctx2)) == NULL)
+		errx(1, "%s: BN_CTX_get", __func__);
+	if (b == a || !BN_is_zero(b)) {
+		fprintf(stderr, "FAIL: %s: nested frame reused BIGNUM\n",
+		    __func__);
+		goto failure;
+	}
+	BN_CTX_end(ctx2);
+	BN_CTX_free(ctx2);
+	ctx2 = NULL;
+
+	if (!BN_is_word(a, 42)) {
+		fprintf(stderr, "FAIL: %s: outer BIGNUM clobbered\n", __func__);
+		goto failure;
+	}
+
+	/* Release the context with an unbalanced frame. */
+	thread_ctx = ctx;
+	BN_CTX_start(ctx);
+	BN_CTX_free(ctx);
+
+	if ((ctx = bn_ctx_get_thread()) != thread_ctx) {
+		fprintf(stderr, "FAIL: %s: context not reused\n", __func__);
+		goto failure;
+	}
+	BN_CTX_start(ctx);
+	if ((a = BN_CTX_get(ctx)) == NULL) {
+		fprintf(stderr, "FAIL: %s: context not reset on release\n",
+		    __func__);
+		goto failure;
+	}
+	if (!BN_is_zero(a)) {
+		fprintf(stderr, "FAIL: %s: BIGNUM not cleared\n", __func__);
+		goto failure;
+	}
+	BN_CTX_end(ctx);
+
+	failed = 0;
+
+ failure:
+	BN_CTX_free(ctx2);
+	BN_CTX_free(ctx);
+
+	return failed;
+}
+
 int
 main(void)
 {
@@ -302,6 +372,7 @@ main(void)
 	failed |= test_bn_copy_copies_flags();
 	failed |= test_bn_copy_consttime_is_sticky();
 	failed |= test_bn_dup_consttime_is_sticky();
+	failed |= test_bn_ctx_get_thread();
 
 	return failed;
 }
@@ -0,0 +1,316 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/camellia.h>
+#include <openssl/evp.h>
+
+#include "camellia_internal.h"
+
+#define TEST_BLOCKS	67
+
+/* Test vectors from RFC 3713, appendix A. */
+static const uint8_t test_key[32] = {
+	0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+	0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+struct camellia_test {
+	int bits;
+	uint8_t ciphertext[CAMELLIA_BLOCK_SIZE];
+};
+
+static const struct camellia_test camellia_tests[] = {
+	{
+		.bits = 128,
+		.ciphertext = {
+			0x67, 0x67, 0x31, 0x38, 0x54, 0x96, 0x69, 0x73,
+			0x08, 0x57, 0x06, 0x56, 0x48, 0xea, 0xbe, 0x43,
+		},
+	},
+	{
+		.bits = 192,
+		.ciphertext = {
+			0xb4, 0x99, 0x34, 0x01, 0xb3, 0xe9, 0x96, 0xf8,
+			0x4e, 0xe5, 0xce, 0xe7, 0xd7, 0x9b, 0x09, 0xb9,
+		},
+	},
+	{
+		.bits = 256,
+		.ciphertext = {
+			0x9a, 0xcc, 0x23, 0x7d, 0xff, 0x16, 0xd7, 0x6c,
+			0x20, 0xef, 0x7c, 0x91, 0x9e, 0x3a, 0x75, 0x09,
+		},
+	},
+};
+
+#define N_CAMELLIA_TESTS (sizeof(camellia_tests) / sizeof(camellia_tests[0]))
+
+static void
+test_fill(uint8_t *buf, size_t len, uint32_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+/*
+ * Encrypt and decrypt every block count up to TEST_BLOCKS with the
+ * multi-block functions, comparing against the single block functions.
+ * The first block is the RFC 3713 plaintext.
+ */
+static int
+camellia_blocks_test(const struct camellia_test *ct)
+{
+	uint8_t in[TEST_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint8_t out[TEST_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint8_t want[TEST_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	CAMELLIA_KEY key;
+	size_t i, n;
+	int failed = 1;
+
+	if (Camellia_set_key(test_key, ct->bits, &key) != 0)
+		errx(1, "Camellia_set_key failed");
+
+	for (n = 0; n <= TEST_BLOCKS; n++) {
+		test_fill(in, sizeof(in), n);
+		memcpy(in, test_key, CAMELLIA_BLOCK_SIZE);
+		for (i = 0; i < n; i++)
+			Camellia_encrypt(&in[i * CAMELLIA_BLOCK_SIZE],
+			    &want[i * CAMELLIA_BLOCK_SIZE], &key);
+		if (n > 0 && memcmp(want, ct->ciphertext,
+		    CAMELLIA_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d encryption "
+			    "differs from test vector\n", ct->bits);
+			goto failed;
+		}
+
+		memset(out, 0, sizeof(out));
+		camellia_encrypt_blocks(in, out, n, key.u.rd_key,
+		    key.grand_rounds);
+		if (memcmp(out, want, n * CAMELLIA_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d "
+			    "camellia_encrypt_blocks with %zu blocks "
+			    "differs\n", ct->bits, n);
+			goto failed;
+		}
+
+		camellia_encrypt_blocks_generic(in, out, n, key.u.rd_key,
+		    key.grand_rounds);
+		if (memcmp(out, want, n * CAMELLIA_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d "
+			    "camellia_encrypt_blocks_generic with %zu blocks "
+			    "differs\n", ct->bits, n);
+			goto failed;
+		}
+
+		memcpy(out, in, sizeof(out));
+		camellia_ecb_encrypt_blocks(out, out, n, &key,
+		    CAMELLIA_ENCRYPT);
+		if (memcmp(out, want, n * CAMELLIA_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d in place "
+			    "encryption with %zu blocks differs\n",
+			    ct->bits, n);
+			goto failed;
+		}
+
+		camellia_ecb_encrypt_blocks(out, out, n, &key,
+		    CAMELLIA_DECRYPT);
+		if (memcmp(out, in, n * CAMELLIA_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d in place "
+			    "decryption with %zu blocks differs\n",
+			    ct->bits, n);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+/*
+ * Compare CBC decryption and CTR mode against a block at a time.
+ */
+static int
+camellia_modes_test(const struct camellia_test *ct)
+{
+	uint8_t in[TEST_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint8_t out[TEST_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint8_t want[TEST_BLOCKS * CAMELLIA_BLOCK_SIZE];
+	uint8_t iv[CAMELLIA_BLOCK_SIZE], iv2[CAMELLIA_BLOCK_SIZE];
+	uint8_t ecount[CAMELLIA_BLOCK_SIZE], ecount2[CAMELLIA_BLOCK_SIZE];
+	unsigned int num, num2;
+	CAMELLIA_KEY key;
+	size_t i, n;
+	int failed = 1;
+
+	if (Camellia_set_key(test_key, ct->bits, &key) != 0)
+		errx(1, "Camellia_set_key failed");
+
+	for (n = 1; n <= TEST_BLOCKS; n += 3) {
+		test_fill(in, sizeof(in), n);
+
+		memset(iv, 0x5a, sizeof(iv));
+		memset(iv2, 0x5a, sizeof(iv2));
+		for (i = 0; i < n; i++)
+			Camellia_cbc_encrypt(&in[i * CAMELLIA_BLOCK_SIZE],
+			    &want[i * CAMELLIA_BLOCK_SIZE], CAMELLIA_BLOCK_SIZE,
+			    &key, iv, CAMELLIA_DECRYPT);
+		memcpy(out, in, sizeof(out));
+		Camellia_cbc_encrypt(out, out, n * CAMELLIA_BLOCK_SIZE, &key,
+		    iv2, CAMELLIA_DECRYPT);
+		if (memcmp(out, want, n * CAMELLIA_BLOCK_SIZE) != 0 ||
+		    memcmp(iv, iv2, sizeof(iv)) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d CBC decryption "
+			    "with %zu blocks differs\n", ct->bits, n);
+			goto failed;
+		}
+
+		/* Force a counter wrap within the first few blocks. */
+		memset(iv, 0xff, sizeof(iv));
+		memset(iv2, 0xff, sizeof(iv2));
+		iv[0] = iv2[0] = 0x5a;
+		num = num2 = 0;
+		for (i = 0; i < n * CAMELLIA_BLOCK_SIZE; i += 5)
+			Camellia_ctr128_encrypt(&in[i], &want[i],
+			    n * CAMELLIA_BLOCK_SIZE - i < 5 ?
+			    n * CAMELLIA_BLOCK_SIZE - i : 5, &key, iv, ecount,
+			    &num);
+		Camellia_ctr128_encrypt(in, out, n * CAMELLIA_BLOCK_SIZE,
+		    &key, iv2, ecount2, &num2);
+		if (memcmp(out, want, n * CAMELLIA_BLOCK_SIZE) != 0 ||
+		    memcmp(iv, iv2, sizeof(iv)) != 0) {
+			fprintf(stderr, "FAIL: Camellia-%d CTR mode with %zu "
+			    "blocks differs\n", ct->bits, n);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static int
+camellia_test(void)
+{
+	size_t i;
+	int failed = 0;
+
+	for (i = 0; i < N_CAMELLIA_TESTS; i++) {
+		failed |= camellia_blocks_test(&camellia_tests[i]);
+		failed |= camellia_modes_test(&camellia_tests[i]);
+	}
+
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+camellia_benchmark_run(const char *label, const EVP_CIPHER *cipher,
+    int seconds)
+{
+	struct timespec start, end, duration;
+	uint8_t buf[16384], iv[CAMELLIA_BLOCK_SIZE];
+	EVP_CIPHER_CTX *ctx;
+	double secs;
+	uint64_t i;
+	int out_len;
+
+	if ((ctx = EVP_CIPHER_CTX_new()) == NULL)
+		errx(1, "EVP_CIPHER_CTX_new failed");
+
+	memset(iv, 0, sizeof(iv));
+	test_fill(buf, sizeof(buf), 0);
+	if (!EVP_DecryptInit_ex(ctx, cipher, NULL, test_key, iv))
+		errx(1, "EVP_DecryptInit_ex failed");
+	EVP_CIPHER_CTX_set_padding(ctx, 0);
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s for %ds: ", label, seconds);
+	while (!benchmark_stop) {
+		if (!EVP_DecryptUpdate(ctx, buf, &out_len, buf, sizeof(buf)))
+			errx(1, "EVP_DecryptUpdate failed");
+		i++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu runs in %f seconds (%.2f MB/s)\n",
+	    (unsigned long long)i, secs, i * sizeof(buf) / secs / 1000000.0);
+
+	EVP_CIPHER_CTX_free(ctx);
+}
+
+static void
+camellia_benchmark(void)
+{
+	camellia_benchmark_run("Camellia-128-ECB decrypt",
+	    EVP_camellia_128_ecb(), 3);
+	camellia_benchmark_run("Camellia-128-CBC decrypt",
+	    EVP_camellia_128_cbc(), 3);
+	camellia_benchmark_run("Camellia-256-CBC decrypt",
+	    EVP_camellia_256_cbc(), 3);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= camellia_test();
+
+	if (benchmark && !failed)
+		camellia_benchmark();
+
+	return failed;
+}
@@ -0,0 +1,331 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/objects.h>
+
+/*
+ * Groups created from a built-in curve use a shared, precomputed table of
+ * multiples of the generator for g * m + p * n. Check the result against a
+ * copy of the group that has no table, since its generator was set by hand,
+ * and against the sum of two separate constant time multiplications.
+ */
+
+#define N_RANDOM_SCALARS	4
+#define N_THREADS		4
+
+static EC_GROUP *
+ec_group_without_table(const EC_GROUP *group, BN_CTX *ctx)
+{
+	EC_GROUP *plain;
+	BIGNUM *p, *a, *b, *order, *cofactor;
+
+	BN_CTX_start(ctx);
+
+	if ((p = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((a = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((b = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((order = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((cofactor = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+
+	if (!EC_GROUP_get_curve(group, p, a, b, ctx))
+		errx(1, "EC_GROUP_get_curve");
+	if ((plain = EC_GROUP_new_curve_GFp(p, a, b, ctx)) == NULL)
+		errx(1, "EC_GROUP_new_curve_GFp");
+	if (!EC_GROUP_get_order(group, order, ctx))
+		errx(1, "EC_GROUP_get_order");
+	if (!EC_GROUP_get_cofactor(group, cofactor, ctx))
+		errx(1, "EC_GROUP_get_cofactor");
+	if (!EC_GROUP_set_generator(plain, EC_GROUP_get0_generator(group),
+	    order, cofactor))
+		errx(1, "EC_GROUP_set_generator");
+
+	BN_CTX_end(ctx);
+
+	return plain;
+}
+
+static EC_POINT *
+ec_point_copy_to(const EC_GROUP *group, const EC_GROUP *from,
+    const EC_POINT *point, BN_CTX *ctx)
+{
+	EC_POINT *copy;
+	BIGNUM *x, *y;
+
+	if ((copy = EC_POINT_new(group)) == NULL)
+		errx(1, "EC_POINT_new");
+
+	if (EC_POINT_is_at_infinity(from, point)) {
+		if (!EC_POINT_set_to_infinity(group, copy))
+			errx(1, "EC_POINT_set_to_infinity");
+		return copy;
+	}
+
+	BN_CTX_start(ctx);
+
+	if ((x = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((y = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+
+	if (!EC_POINT_get_affine_coordinates(from, point, x, y, ctx))
+		errx(1, "EC_POINT_get_affine_coordinates");
+	if (!EC_POINT_set_affine_coordinates(group, copy, x, y, ctx))
+		errx(1, "EC_POINT_set_affine_coordinates");
+
+	BN_CTX_end(ctx);
+
+	return copy;
+}
+
+static int
+ec_mult_compare(const char *curve, const char *descr, const EC_GROUP *group,
+    const EC_GROUP *plain, const BIGNUM *m, const EC_POINT *point,
+    const BIGNUM *n, BN_CTX *ctx)
+{
+	EC_POINT *table_r = NULL, *plain_r = NULL, *plain_point = NULL;
+	EC_POINT *gm = NULL, *pn = NULL, *sum_r = NULL, *r = NULL;
+	int failed = 1;
+
+	if ((table_r = EC_POINT_new(group)) == NULL)
+		errx(1, "EC_POINT_new");
+	if (!EC_POINT_mul(group, table_r, m, point, n, ctx)) {
+		fprintf(stderr, "FAIL: %s %s: EC_POINT_mul\n", curve, descr);
+		goto err;
+	}
+
+	plain_point = ec_point_copy_to(plain, group, point, ctx);
+	if ((plain_r = EC_POINT_new(plain)) == NULL)
+		errx(1, "EC_POINT_new");
+	if (!EC_POINT_mul(plain, plain_r, m, plain_point, n, ctx)) {
+		fprintf(stderr, "FAIL: %s %s: EC_POINT_mul without table\n",
+		    curve, descr);
+		goto err;
+	}
+	r = ec_point_copy_to(group, plain, plain_r, ctx);
+	if (EC_POINT_cmp(group, table_r, r, ctx) != 0) {
+		fprintf(stderr, "FAIL: %s %s: result differs from group "
+		    "without table\n", curve, descr);
+		goto err;
+	}
+
+	if ((gm = EC_POINT_new(group)) == NULL)
+		errx(1, "EC_POINT_new");
+	if ((pn = EC_POINT_new(group)) == NULL)
+		errx(1, "EC_POINT_new");
+	if ((sum_r = EC_POINT_new(group)) == NULL)
+		errx(1, "EC_POINT_new");
+	if (!EC_POINT_mul(group, gm, m, NULL, NULL, ctx))
+		errx(1, "EC_POINT_mul");
+	if (!EC_POINT_mul(group, pn, NULL, point, n, ctx))
+		errx(1, "EC_POINT_mul");
+	if (!EC_POINT_add(group, sum_r, gm, pn, ctx))
+		errx(1, "EC_POINT_add");
+	if (EC_POINT_cmp(group, table_r, sum_r, ctx) != 0) {
+		fprintf(stderr, "FAIL: %s %s: result differs from single "
+		    "multiplications\n", curve, descr);
+		goto err;
+	}
+
+	failed = 0;
+
+ err:
+	EC_POINT_free(table_r);
+	EC_POINT_free(plain_r);
+	EC_POINT_free(plain_point);
+	EC_POINT_free(gm);
+	EC_POINT_free(pn);
+	EC_POINT_free(sum_r);
+	EC_POINT_free(r);
+
+	return failed;
+}
+
+static int
+ec_mult_curve(const EC_builtin_curve *curve, BN_CTX *ctx)
+{
+	EC_GROUP *group, *plain;
+	EC_POINT *point;
+	BIGNUM *order, *k, *m, *n;
+	const char *name;
+	int i;
+	int failed = 0;
+
+	if ((name = OBJ_nid2sn(curve->nid)) == NULL)
+		name = "unknown curve";
+
+	if ((group = EC_GROUP_new_by_curve_name(curve->nid)) == NULL)
+		errx(1, "EC_GROUP_new_by_curve_name(%s)", name);
+	plain = ec_group_without_table(group, ctx);
+
+	BN_CTX_start(ctx);
+
+	if ((order = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((k = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((m = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+	if ((n = BN_CTX_get(ctx)) == NULL)
+		errx(1, "BN_CTX_get");
+
+	if (!EC_GROUP_get_order(group, order, ctx))
+		errx(1, "EC_GROUP_get_order");
+
+	if ((point = EC_POINT_new(group)) == NULL)
+		errx(1, "EC_POINT_new");
+
+	for (i = 0; i < N_RANDOM_SCALARS; i++) {
+		if (!BN_rand_range(k, order))
+			errx(1, "BN_rand_range");
+		if (!BN_rand_range(m, order))
+			errx(1, "BN_rand_range");
+		if (!BN_rand_range(n, order))
+			errx(1, "BN_rand_range");
+		if (!EC_POINT_mul(group, point, k, NULL, NULL, ctx))
+			errx(1, "EC_POINT_mul");
+		failed |= ec_mult_compare(name, "random scalars", group,
+		    plain, m, point, n, ctx);
+	}
+
+	/* Scalars at the edges of the table's windows. */
+	BN_zero(m);
+	failed |= ec_mult_compare(name, "zero m", group, plain, m, point, n,
+	    ctx);
+	if (!BN_one(m))
+		errx(1, "BN_one");
+	failed |= ec_mult_compare(name, "one m", group, plain, m, point, n,
+	    ctx);
+	if (!BN_sub(m, order, BN_value_one()))
+		errx(1, "BN_sub");
+	failed |= ec_mult_compare(name, "order - 1 m", group, plain, m, point,
+	    n, ctx);
+	if (!BN_set_word(m, 127))
+		errx(1, "BN_set_word");
+	failed |= ec_mult_compare(name, "m = 127", group, plain, m, point, n,
+	    ctx);
+	BN_zero(n);
+	failed |= ec_mult_compare(name, "zero n", group, plain, m, point, n,
+	    ctx);
+
+	/* With the generator as point, g * m + g * (order - m) is infinity. */
+	if (!BN_rand_range(m, order))
+		errx(1, "BN_rand_range");
+	if (!BN_sub(n, order, m))
+		errx(1, "BN_sub");
+	failed |= ec_mult_compare(name, "sum to infinity", group, plain, m,
+	    EC_GROUP_get0_generator(group), n, ctx);
+
+	BN_CTX_end(ctx);
+
+	EC_POINT_free(point);
+	EC_GROUP_free(plain);
+	EC_GROUP_free(group);
+
+	return failed;
+}
+
+static int
+ec_mult_builtin_curves(void)
+{
+	EC_builtin_curve *all_curves = NULL;
+	BN_CTX *ctx;
+	size_t curve_id, ncurves;
+	int failed = 0;
+
+	if ((ctx = BN_CTX_new()) == NULL)
+		errx(1, "BN_CTX_new");
+
+	ncurves = EC_get_builtin_curves(NULL, 0);
+	if ((all_curves = calloc(ncurves, sizeof(*all_curves))) == NULL)
+		err(1, "calloc builtin curves");
+	EC_get_builtin_curves(all_curves, ncurves);
+
+	for (curve_id = 0; curve_id < ncurves; curve_id++)
+		failed |= ec_mult_curve(&all_curves[curve_id], ctx);
+
+	free(all_curves);
+	BN_CTX_free(ctx);
+
+	return failed;
+}
+
+/*
+ * Several threads using a curve for the first time race to build its table.
+ */
+
+static void *
+ec_mult_thread(void *arg)
+{
+	EC_builtin_curve curve = { .nid = NID_secp384r1 };
+	BN_CTX *ctx;
+	int *failed = arg;
+
+	if ((ctx = BN_CTX_new()) == NULL)
+		errx(1, "BN_CTX_new");
+	*failed = ec_mult_curve(&curve, ctx);
+	BN_CTX_free(ctx);
+
+	ERR_remove_thread_state(NULL);
+
+	return NULL;
+}
+
+static int
+ec_mult_threads(void)
+{
+	pthread_t threads[N_THREADS];
+	int thread_failed[N_THREADS];
+	int i;
+	int failed = 0;
+
+	for (i = 0; i < N_THREADS; i++) {
+		if (pthread_create(&threads[i], NULL, ec_mult_thread,
+		    &thread_failed[i]) != 0)
+			errx(1, "pthread_create");
+	}
+	for (i = 0; i < N_THREADS; i++) {
+		if (pthread_join(threads[i], NULL) != 0)
+			errx(1, "pthread_join");
+		failed |= thread_failed[i];
+	}
+
+	return failed;
+}
+
+int
+main(void)
+{
+	int failed = 0;
+
+	failed |= ec_mult_threads();
+	failed |= ec_mult_builtin_curves();
+
+	return failed;
+}
@@ -18,6 +18,7 @@
 #include <err.h>
 #include <string.h>
 
+#include <openssl/curve25519.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/pem.h>
@@ -447,6 +448,87 @@ ecx_ed25519_sign_test(void)
 	return failed;
 }
 
+/*
+ * Keys generated through EVP sign with a cached expanded key - ensure that
+ * this produces the same signature as signing from the seed.
+ */
+static int
+ecx_ed25519_keygen_sign_test(void)
+{
+	EVP_PKEY_CTX *pkey_ctx = NULL;
+	EVP_MD_CTX *md_ctx = NULL;
+	EVP_PKEY *pkey = NULL;
+	uint8_t priv_key[ED25519_PRIVATE_KEY_LENGTH];
+	uint8_t pub_key[ED25519_PUBLIC_KEY_LENGTH];
+	uint8_t signature[ED25519_SIGNATURE_LENGTH];
+	uint8_t want[ED25519_SIGNATURE_LENGTH];
+	size_t priv_key_len, pub_key_len, signature_len;
+	int failed = 1;
+
+	if ((pkey_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, NULL)) == NULL)
+		errx(1, "failed to create ED25519 context");
+	if (EVP_PKEY_keygen_init(pkey_ctx) <= 0) {
+		fprintf(stderr, "FAIL: failed to init keygen for ED25519\n");
+		goto failure;
+	}
+	if (EVP_PKEY_keygen(pkey_ctx, &pkey) <= 0) {
+		fprintf(stderr, "FAIL: failed to generate ED25519 key\n");
+		goto failure;
+	}
+
+	priv_key_len = sizeof(priv_key);
+	if (!EVP_PKEY_get_raw_private_key(pkey, priv_key, &priv_key_len)) {
+		fprintf(stderr, "FAIL: failed to get raw private key\n");
+		goto failure;
+	}
+	pub_key_len = sizeof(pub_key);
+	if (!EVP_PKEY_get_raw_public_key(pkey, pub_key, &pub_key_len)) {
+		fprintf(stderr, "FAIL: failed to get raw public key\n");
+		goto failure;
+	}
+
+	if ((md_ctx = EVP_MD_CTX_new()) == NULL)
+		errx(1, "failed to create MD_CTX");
+	if (!EVP_DigestSignInit(md_ctx, NULL, NULL, NULL, pkey)) {
+		fprintf(stderr, "FAIL: failed to init digest sign\n");
+		goto failure;
+	}
+	signature_len = sizeof(signature);
+	if (!EVP_DigestSign(md_ctx, signature, &signature_len, message_1,
+	    sizeof(message_1))) {
+		fprintf(stderr, "FAIL: failed to digest sign\n");
+		goto failure;
+	}
+
+	if (!ED25519_sign(want, message_1, sizeof(message_1), pub_key,
+	    priv_key)) {
+		fprintf(stderr, "FAIL: ED25519_sign failed\n");
+		goto failure;
+	}
+	if (signature_len != sizeof(want) ||
+	    memcmp(signature, want, sizeof(want)) != 0) {
+		fprintf(stderr, "FAIL: Ed25519 signatures differ\n");
+		fprintf(stderr, "Got:\n");
+		hexdump(signature, signature_len);
+		fprintf(stderr, "Want:\n");
+		hexdump(want, sizeof(want));
+		goto failure;
+	}
+	if (!ED25519_verify(message_1, sizeof(message_1), signature, pub_key)) {
+		fprintf(stderr, "FAIL: Ed25519 verify failed\n");
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	EVP_MD_CTX_free(md_ctx);
+	EVP_PKEY_CTX_free(pkey_ctx);
+	EVP_PKEY_free(pkey);
+
+	return failed;
+}
+
 static int
 ecx_ed25519_verify_test(void)
 {
@@ -821,6 +903,7 @@ main(int argc, char **argv)
 	failed |= ecx_ed25519_raw_key_test();
 	failed |= ecx_ed25519_keygen_test();
 	failed |= ecx_ed25519_sign_test();
+	failed |= ecx_ed25519_keygen_sign_test();
 	failed |= ecx_ed25519_verify_test();
 
 	failed |= ecx_x25519_keygen_test();
@@ -134,6 +134,96 @@ static struct test_st {
 
 static char *pt(unsigned char *md, unsigned int len);
 
+static int
+hmac_key_test(void)
+{
+	const EVP_MD *mds[] = {
+		EVP_sha1(), EVP_sha256(), EVP_sha512(), EVP_sha3_256(),
+		EVP_sha3_224(),
+	};
+	unsigned char key[200], msg[300];
+	unsigned char want[EVP_MAX_MD_SIZE], got[EVP_MAX_MD_SIZE];
+	unsigned int want_len, got_len;
+	HMAC_KEY *hkey = NULL;
+	size_t i, key_len, msg_len;
+	int err = 0;
+
+	for (i = 0; i < sizeof(key); i++)
+		key[i] = i;
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = 0xff - i;
+
+	if ((hkey = HMAC_KEY_new(EVP_sha1(), NULL, 0)) != NULL) {
+		printf("HMAC_KEY_new() succeeded with NULL key (test 7)\n");
+		err++;
+	}
+	HMAC_KEY_free(hkey);
+
+	for (i = 0; i < sizeof(mds) / sizeof(mds[0]); i++) {
+		for (key_len = 0; key_len <= sizeof(key); key_len += 50) {
+			if ((hkey = HMAC_KEY_new(mds[i], key, key_len)) == NULL) {
+				printf("HMAC_KEY_new() failed (test 7)\n");
+				err++;
+				continue;
+			}
+			if (HMAC_KEY_get_md(hkey) != mds[i]) {
+				printf("HMAC_KEY_get_md() mismatch (test 7)\n");
+				err++;
+			}
+			for (msg_len = 0; msg_len <= sizeof(msg);
+			    msg_len += 75) {
+				if (HMAC(mds[i], key, key_len, msg, msg_len,
+				    want, &want_len) == NULL) {
+					printf("HMAC() failed (test 7)\n");
+					err++;
+					continue;
+				}
+				if (HMAC_with_key(hkey, msg, msg_len, got,
+				    &got_len) == NULL) {
+					printf("HMAC_with_key() failed "
+					    "(test 7)\n");
+					err++;
+					continue;
+				}
+				if (got_len != want_len ||
+				    memcmp(got, want, want_len) != 0) {
+					printf("HMAC_with_key() mismatch for "
+					    "%s, key length %zu, message "
+					    "length %zu (test 7)\n",
+					    EVP_MD_name(mds[i]), key_len,
+					    msg_len);
+					err++;
+				}
+				if (!HMAC_verify_with_key(hkey, msg, msg_len,
+				    want, want_len)) {
+					printf("HMAC_verify_with_key() failed "
+					    "(test 7)\n");
+					err++;
+				}
+				want[want_len - 1] ^= 1;
+				if (HMAC_verify_with_key(hkey, msg, msg_len,
+				    want, want_len)) {
+					printf("HMAC_verify_with_key() "
+					    "accepted a bad MAC (test 7)\n");
+					err++;
+				}
+				if (HMAC_verify_with_key(hkey, msg, msg_len,
+				    got, want_len - 1)) {
+					printf("HMAC_verify_with_key() "
+					    "accepted a short MAC (test 7)\n");
+					err++;
+				}
+			}
+			HMAC_KEY_free(hkey);
+		}
+	}
+
+	if (err == 0)
+		printf("test 7 ok\n");
+
+	return err;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -315,6 +405,8 @@ main(int argc, char *argv[])
 		printf("test 6 ok\n");
 	}
 end:
+	err += hmac_key_test();
+
 	HMAC_CTX_free(ctx);
 	HMAC_CTX_free(ctx2);
 	exit(err);
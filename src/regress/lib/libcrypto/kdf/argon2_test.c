@@ -0,0 +1,433 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+#include "kdf_internal.h"
+
+/* Test vector from RFC 9106, section 5.3. */
+static const uint8_t argon2id_pass[32] = {
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+	0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+};
+static const uint8_t argon2id_salt[16] = {
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+	0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
+};
+static const uint8_t argon2id_secret[8] = {
+	0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03,
+};
+static const uint8_t argon2id_ad[12] = {
+	0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04,
+	0x04, 0x04, 0x04, 0x04,
+};
+static const uint8_t argon2id_tag[32] = {
+	0x0d, 0x64, 0x0d, 0xf5, 0x8d, 0x78, 0x76, 0x6c,
+	0x08, 0xc0, 0x37, 0xa3, 0x4a, 0x8b, 0x53, 0xc9,
+	0xd0, 0x1e, 0xf0, 0x45, 0x2d, 0x75, 0xb6, 0x5e,
+	0xb5, 0x25, 0x20, 0xe9, 0x6b, 0x01, 0xe6, 0x59,
+};
+
+static EVP_PKEY_CTX *
+argon2id_ctx_new(uint32_t iter, uint32_t memcost, uint32_t lanes,
+    uint32_t threads)
+{
+	EVP_PKEY_CTX *pctx;
+
+	if ((pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ARGON2ID, NULL)) == NULL)
+		errx(1, "EVP_PKEY_CTX_new_id");
+	if (EVP_PKEY_derive_init(pctx) <= 0)
+		errx(1, "EVP_PKEY_derive_init");
+	if (EVP_PKEY_CTX_set_argon2_iter(pctx, iter) <= 0)
+		errx(1, "EVP_PKEY_CTX_set_argon2_iter");
+	if (EVP_PKEY_CTX_set_argon2_memcost(pctx, memcost) <= 0)
+		errx(1, "EVP_PKEY_CTX_set_argon2_memcost");
+	if (EVP_PKEY_CTX_set_argon2_lanes(pctx, lanes) <= 0)
+		errx(1, "EVP_PKEY_CTX_set_argon2_lanes");
+	if (EVP_PKEY_CTX_set_argon2_threads(pctx, threads) <= 0)
+		errx(1, "EVP_PKEY_CTX_set_argon2_threads");
+
+	return pctx;
+}
+
+static int
+argon2id_rfc9106_test(uint32_t threads)
+{
+	EVP_PKEY_CTX *pctx, *dctx = NULL;
+	uint8_t out[sizeof(argon2id_tag)];
+	size_t out_len;
+	int i;
+	int failed = 1;
+
+	pctx = argon2id_ctx_new(3, 32, 4, threads);
+
+	if (EVP_PKEY_CTX_set1_pbe_pass(pctx, argon2id_pass,
+	    sizeof(argon2id_pass)) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_pbe_pass");
+	if (EVP_PKEY_CTX_set1_argon2_salt(pctx, argon2id_salt,
+	    sizeof(argon2id_salt)) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_argon2_salt");
+	if (EVP_PKEY_CTX_set1_argon2_secret(pctx, argon2id_secret,
+	    sizeof(argon2id_secret)) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_argon2_secret");
+	if (EVP_PKEY_CTX_set1_argon2_ad(pctx, argon2id_ad,
+	    sizeof(argon2id_ad)) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_argon2_ad");
+
+	/* Derive twice, to exercise reuse of the memory arena. */
+	for (i = 0; i < 2; i++) {
+		memset(out, 0, sizeof(out));
+		out_len = sizeof(out);
+		if (EVP_PKEY_derive(pctx, out, &out_len) <= 0) {
+			fprintf(stderr, "FAIL: Argon2id derive with %u threads "
+			    "failed\n", threads);
+			goto failed;
+		}
+		if (memcmp(out, argon2id_tag, sizeof(argon2id_tag)) != 0) {
+			fprintf(stderr, "FAIL: Argon2id with %u threads, "
+			    "derive %d mismatch\n", threads, i);
+			goto failed;
+		}
+	}
+
+	/* A copy derives the same tag once the original is gone. */
+	if ((dctx = EVP_PKEY_CTX_dup(pctx)) == NULL) {
+		fprintf(stderr, "FAIL: Argon2id with %u threads, "
+		    "EVP_PKEY_CTX_dup failed\n", threads);
+		goto failed;
+	}
+	EVP_PKEY_CTX_free(pctx);
+	pctx = NULL;
+
+	memset(out, 0, sizeof(out));
+	out_len = sizeof(out);
+	if (EVP_PKEY_derive(dctx, out, &out_len) <= 0) {
+		fprintf(stderr, "FAIL: Argon2id derive with %u threads from "
+		    "copy failed\n", threads);
+		goto failed;
+	}
+	if (memcmp(out, argon2id_tag, sizeof(argon2id_tag)) != 0) {
+		fprintf(stderr, "FAIL: Argon2id with %u threads, derive from "
+		    "copy mismatch\n", threads);
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_PKEY_CTX_free(pctx);
+	EVP_PKEY_CTX_free(dctx);
+
+	return failed;
+}
+
+static int
+argon2id_ctrl_str_test(void)
+{
+	EVP_PKEY_CTX *pctx;
+	uint8_t out[sizeof(argon2id_tag)];
+	size_t out_len;
+	int failed = 1;
+
+	if ((pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ARGON2ID, NULL)) == NULL)
+		errx(1, "EVP_PKEY_CTX_new_id");
+	if (EVP_PKEY_derive_init(pctx) <= 0)
+		errx(1, "EVP_PKEY_derive_init");
+
+	if (EVP_PKEY_CTX_ctrl_str(pctx, "hexpass", "0101010101010101"
+	    "010101010101010101010101010101010101010101010101") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "hexsalt",
+	    "02020202020202020202020202020202") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "hexsecret",
+	    "0303030303030303") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "hexad",
+	    "040404040404040404040404") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "iter", "3") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "memcost", "32") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "lanes", "4") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "threads", "2") <= 0) {
+		fprintf(stderr, "FAIL: Argon2id EVP_PKEY_CTX_ctrl_str\n");
+		goto failed;
+	}
+	if (EVP_PKEY_CTX_ctrl_str(pctx, "lanes", "0") > 0) {
+		fprintf(stderr, "FAIL: Argon2id accepted zero lanes\n");
+		goto failed;
+	}
+
+	out_len = sizeof(out);
+	if (EVP_PKEY_derive(pctx, out, &out_len) <= 0) {
+		fprintf(stderr, "FAIL: Argon2id derive failed\n");
+		goto failed;
+	}
+	if (memcmp(out, argon2id_tag, sizeof(argon2id_tag)) != 0) {
+		fprintf(stderr, "FAIL: Argon2id with string controls "
+		    "mismatch\n");
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_PKEY_CTX_free(pctx);
+
+	return failed;
+}
+
+static int
+argon2id_derive(uint32_t iter, uint32_t memcost, uint32_t lanes,
+    uint32_t threads, size_t out_len, uint8_t *out)
+{
+	EVP_PKEY_CTX *pctx;
+	int ret;
+
+	pctx = argon2id_ctx_new(iter, memcost, lanes, threads);
+	if (EVP_PKEY_CTX_set1_pbe_pass(pctx, "password", 8) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_pbe_pass");
+	if (EVP_PKEY_CTX_set1_argon2_salt(pctx, "somesaltsomesalt", 16) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_argon2_salt");
+
+	ret = EVP_PKEY_derive(pctx, out, &out_len);
+
+	EVP_PKEY_CTX_free(pctx);
+
+	return ret;
+}
+
+/*
+ * The output must not depend on the number of threads used to fill the lanes.
+ */
+static int
+argon2id_threads_test(void)
+{
+	static const uint32_t threads[] = { 2, 3, 5, 8 };
+	uint8_t want[100], got[100];
+	size_t i;
+	int failed = 1;
+
+	if (argon2id_derive(2, 5 * 8 * 13, 5, 1, sizeof(want), want) <= 0) {
+		fprintf(stderr, "FAIL: Argon2id derive failed\n");
+		goto failed;
+	}
+	for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+		if (argon2id_derive(2, 5 * 8 * 13, 5, threads[i], sizeof(got),
+		    got) <= 0) {
+			fprintf(stderr, "FAIL: Argon2id derive failed\n");
+			goto failed;
+		}
+		if (memcmp(got, want, sizeof(want)) != 0) {
+			fprintf(stderr, "FAIL: Argon2id with %u threads "
+			    "differs from single thread\n", threads[i]);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static int
+argon2id_params_test(void)
+{
+	EVP_PKEY_CTX *pctx;
+	uint8_t out[32];
+	size_t out_len;
+	int failed = 1;
+
+	/* Without an output buffer, the recommended length is reported. */
+	pctx = argon2id_ctx_new(1, 8 * 4, 4, 1);
+	if (EVP_PKEY_CTX_set1_pbe_pass(pctx, "password", 8) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_pbe_pass");
+	if (EVP_PKEY_CTX_set1_argon2_salt(pctx, "somesaltsomesalt", 16) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_argon2_salt");
+	out_len = 0;
+	if (EVP_PKEY_derive(pctx, NULL, &out_len) <= 0 || out_len != 32) {
+		fprintf(stderr, "FAIL: Argon2id reported output length %zu, "
+		    "want 32\n", out_len);
+		EVP_PKEY_CTX_free(pctx);
+		goto failed;
+	}
+	if (EVP_PKEY_CTX_set_argon2_memcost(pctx, 8 * 4 - 1) <= 0)
+		errx(1, "EVP_PKEY_CTX_set_argon2_memcost");
+	if (EVP_PKEY_derive(pctx, NULL, &out_len) > 0) {
+		fprintf(stderr, "FAIL: Argon2id reported output length for "
+		    "too little memory\n");
+		EVP_PKEY_CTX_free(pctx);
+		goto failed;
+	}
+	EVP_PKEY_CTX_free(pctx);
+
+	/* At least 8 blocks per lane, and 4 bytes of output are required. */
+	if (argon2id_derive(1, 8 * 4 - 1, 4, 1, sizeof(out), out) > 0) {
+		fprintf(stderr, "FAIL: Argon2id accepted too little memory\n");
+		goto failed;
+	}
+	if (argon2id_derive(1, 8 * 4, 4, 1, 3, out) > 0) {
+		fprintf(stderr, "FAIL: Argon2id accepted 3 byte output\n");
+		goto failed;
+	}
+	if (argon2id_derive(1, 8 * 4, 4, 1, 4, out) <= 0) {
+		fprintf(stderr, "FAIL: Argon2id rejected minimum "
+		    "parameters\n");
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	ERR_clear_error();
+
+	return failed;
+}
+
+static void
+argon2_block_fill(uint64_t *block, uint64_t seed)
+{
+	int i;
+
+	for (i = 0; i < ARGON2_BLOCK_WORDS; i++) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		block[i] = seed;
+	}
+}
+
+static int
+argon2_fill_block_test(void)
+{
+	uint64_t prev[ARGON2_BLOCK_WORDS], ref[ARGON2_BLOCK_WORDS];
+	uint64_t want[ARGON2_BLOCK_WORDS], got[ARGON2_BLOCK_WORDS];
+	int i, with_xor;
+	int failed = 1;
+
+	for (i = 0; i < 64; i++) {
+		for (with_xor = 0; with_xor <= 1; with_xor++) {
+			argon2_block_fill(prev, i * 3);
+			argon2_block_fill(ref, i * 3 + 1);
+			argon2_block_fill(want, i * 3 + 2);
+			memcpy(got, want, sizeof(got));
+
+			argon2_fill_block_generic(prev, ref, want, with_xor);
+			argon2_fill_block(prev, ref, got, with_xor);
+			if (memcmp(got, want, sizeof(got)) != 0) {
+				fprintf(stderr, "FAIL: test %d - "
+				    "argon2_fill_block() with_xor %d differs "
+				    "from generic implementation\n", i,
+				    with_xor);
+				goto failed;
+			}
+
+			/* The reference block may also be the output. */
+			memcpy(got, ref, sizeof(got));
+			argon2_fill_block(prev, got, got, with_xor);
+			argon2_fill_block_generic(prev, ref, ref, with_xor);
+			if (memcmp(got, ref, sizeof(got)) != 0) {
+				fprintf(stderr, "FAIL: test %d - "
+				    "argon2_fill_block() in place differs "
+				    "from generic implementation\n", i);
+				goto failed;
+			}
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static void
+argon2id_benchmark_run(uint32_t iter, uint32_t memcost, uint32_t lanes,
+    uint32_t threads)
+{
+	struct timespec start, end, duration;
+	EVP_PKEY_CTX *pctx;
+	uint8_t out[32];
+	size_t out_len;
+	double secs;
+	int i, n = 10;
+
+	pctx = argon2id_ctx_new(iter, memcost, lanes, threads);
+	if (EVP_PKEY_CTX_set1_pbe_pass(pctx, "password", 8) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_pbe_pass");
+	if (EVP_PKEY_CTX_set1_argon2_salt(pctx, "somesaltsomesalt", 16) <= 0)
+		errx(1, "EVP_PKEY_CTX_set1_argon2_salt");
+
+	fprintf(stderr, "Benchmarking Argon2id t=%u m=%u KiB p=%u with %u "
+	    "threads: ", iter, memcost, lanes, threads);
+
+	/* The first derivation allocates the memory arena. */
+	out_len = sizeof(out);
+	if (EVP_PKEY_derive(pctx, out, &out_len) <= 0)
+		errx(1, "EVP_PKEY_derive");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < n; i++) {
+		out_len = sizeof(out);
+		if (EVP_PKEY_derive(pctx, out, &out_len) <= 0)
+			errx(1, "EVP_PKEY_derive");
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%.1f ms per derivation\n", secs * 1000.0 / n);
+
+	EVP_PKEY_CTX_free(pctx);
+}
+
+static void
+argon2id_benchmark(void)
+{
+	argon2id_benchmark_run(1, 64 * 1024, 4, 1);
+	argon2id_benchmark_run(1, 64 * 1024, 4, 4);
+	argon2id_benchmark_run(3, 64 * 1024, 4, 1);
+	argon2id_benchmark_run(3, 64 * 1024, 4, 4);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= argon2_fill_block_test();
+	failed |= argon2id_rfc9106_test(1);
+	failed |= argon2id_rfc9106_test(4);
+	failed |= argon2id_ctrl_str_test();
+	failed |= argon2id_threads_test();
+	failed |= argon2id_params_test();
+
+	if (benchmark && !failed)
+		argon2id_benchmark();
+
+	return failed;
+}
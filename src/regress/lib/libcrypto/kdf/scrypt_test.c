@@ -0,0 +1,392 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+#include "kdf_internal.h"
+
+struct scrypt_test {
+	const char *pass;
+	const char *salt;
+	uint64_t N;
+	uint64_t r;
+	uint64_t p;
+	const uint8_t out[64];
+};
+
+/* Test vectors from RFC 7914, section 12. */
+static const struct scrypt_test scrypt_tests[] = {
+	{
+		.pass = "",
+		.salt = "",
+		.N = 16,
+		.r = 1,
+		.p = 1,
+		.out = {
+			0x77, 0xd6, 0x57, 0x62, 0x38, 0x65, 0x7b, 0x20,
+			0x3b, 0x19, 0xca, 0x42, 0xc1, 0x8a, 0x04, 0x97,
+			0xf1, 0x6b, 0x48, 0x44, 0xe3, 0x07, 0x4a, 0xe8,
+			0xdf, 0xdf, 0xfa, 0x3f, 0xed, 0xe2, 0x14, 0x42,
+			0xfc, 0xd0, 0x06, 0x9d, 0xed, 0x09, 0x48, 0xf8,
+			0x32, 0x6a, 0x75, 0x3a, 0x0f, 0xc8, 0x1f, 0x17,
+			0xe8, 0xd3, 0xe0, 0xfb, 0x2e, 0x0d, 0x36, 0x28,
+			0xcf, 0x35, 0xe2, 0x0c, 0x38, 0xd1, 0x89, 0x06,
+		},
+	},
+	{
+		.pass = "password",
+		.salt = "NaCl",
+		.N = 1024,
+		.r = 8,
+		.p = 16,
+		.out = {
+			0xfd, 0xba, 0xbe, 0x1c, 0x9d, 0x34, 0x72, 0x00,
+			0x78, 0x56, 0xe7, 0x19, 0x0d, 0x01, 0xe9, 0xfe,
+			0x7c, 0x6a, 0xd7, 0xcb, 0xc8, 0x23, 0x78, 0x30,
+			0xe7, 0x73, 0x76, 0x63, 0x4b, 0x37, 0x31, 0x62,
+			0x2e, 0xaf, 0x30, 0xd9, 0x2e, 0x22, 0xa3, 0x88,
+			0x6f, 0xf1, 0x09, 0x27, 0x9d, 0x98, 0x30, 0xda,
+			0xc7, 0x27, 0xaf, 0xb9, 0x4a, 0x83, 0xee, 0x6d,
+			0x83, 0x60, 0xcb, 0xdf, 0xa2, 0xcc, 0x06, 0x40,
+		},
+	},
+	{
+		.pass = "pleaseletmein",
+		.salt = "SodiumChloride",
+		.N = 16384,
+		.r = 8,
+		.p = 1,
+		.out = {
+			0x70, 0x23, 0xbd, 0xcb, 0x3a, 0xfd, 0x73, 0x48,
+			0x46, 0x1c, 0x06, 0xcd, 0x81, 0xfd, 0x38, 0xeb,
+			0xfd, 0xa8, 0xfb, 0xba, 0x90, 0x4f, 0x8e, 0x3e,
+			0xa9, 0xb5, 0x43, 0xf6, 0x54, 0x5d, 0xa1, 0xf2,
+			0xd5, 0x43, 0x29, 0x55, 0x61, 0x3f, 0x0f, 0xcf,
+			0x62, 0xd4, 0x97, 0x05, 0x24, 0x2a, 0x9a, 0xf9,
+			0xe6, 0x1e, 0x85, 0xdc, 0x0d, 0x65, 0x1e, 0x40,
+			0xdf, 0xcf, 0x01, 0x7b, 0x45, 0x57, 0x58, 0x87,
+		},
+	},
+};
+
+#define N_SCRYPT_TESTS (sizeof(scrypt_tests) / sizeof(scrypt_tests[0]))
+
+static int
+scrypt_pbe_test(const struct scrypt_test *st, size_t i)
+{
+	uint8_t out[64];
+	int failed = 1;
+
+	if (!EVP_PBE_scrypt(st->pass, strlen(st->pass),
+	    (const unsigned char *)st->salt, strlen(st->salt), st->N, st->r,
+	    st->p, 64 * 1024 * 1024, out, sizeof(out))) {
+		fprintf(stderr, "FAIL: test %zu - EVP_PBE_scrypt failed\n", i);
+		goto failed;
+	}
+	if (memcmp(out, st->out, sizeof(out)) != 0) {
+		fprintf(stderr, "FAIL: test %zu - EVP_PBE_scrypt mismatch\n",
+		    i);
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static int
+scrypt_pkey_test(const struct scrypt_test *st, size_t i)
+{
+	EVP_PKEY_CTX *pctx, *dctx = NULL;
+	uint8_t out[64];
+	size_t out_len;
+	int j;
+	int failed = 1;
+
+	if ((pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_SCRYPT, NULL)) == NULL)
+		errx(1, "EVP_PKEY_CTX_new_id");
+	if (EVP_PKEY_derive_init(pctx) <= 0)
+		errx(1, "EVP_PKEY_derive_init");
+
+	if (EVP_PKEY_CTX_set1_pbe_pass(pctx, st->pass,
+	    strlen(st->pass)) <= 0) {
+		fprintf(stderr, "FAIL: test %zu - "
+		    "EVP_PKEY_CTX_set1_pbe_pass\n", i);
+		goto failed;
+	}
+	if (EVP_PKEY_CTX_set1_scrypt_salt(pctx, st->salt,
+	    strlen(st->salt)) <= 0) {
+		fprintf(stderr, "FAIL: test %zu - "
+		    "EVP_PKEY_CTX_set1_scrypt_salt\n", i);
+		goto failed;
+	}
+	if (EVP_PKEY_CTX_set_scrypt_N(pctx, st->N) <= 0 ||
+	    EVP_PKEY_CTX_set_scrypt_r(pctx, st->r) <= 0 ||
+	    EVP_PKEY_CTX_set_scrypt_p(pctx, st->p) <= 0) {
+		fprintf(stderr, "FAIL: test %zu - setting scrypt parameters\n",
+		    i);
+		goto failed;
+	}
+
+	/* Derive twice, to exercise reuse of the memory arena. */
+	for (j = 0; j < 2; j++) {
+		memset(out, 0, sizeof(out));
+		out_len = sizeof(out);
+		if (EVP_PKEY_derive(pctx, out, &out_len) <= 0) {
+			fprintf(stderr, "FAIL: test %zu - EVP_PKEY_derive "
+			    "failed\n", i);
+			goto failed;
+		}
+		if (memcmp(out, st->out, sizeof(out)) != 0) {
+			fprintf(stderr, "FAIL: test %zu - EVP_PKEY_derive "
+			    "%d mismatch\n", i, j);
+			goto failed;
+		}
+	}
+
+	/* A copy derives the same key once the original is gone. */
+	if ((dctx = EVP_PKEY_CTX_dup(pctx)) == NULL) {
+		fprintf(stderr, "FAIL: test %zu - EVP_PKEY_CTX_dup\n", i);
+		goto failed;
+	}
+	EVP_PKEY_CTX_free(pctx);
+	pctx = NULL;
+
+	memset(out, 0, sizeof(out));
+	out_len = sizeof(out);
+	if (EVP_PKEY_derive(dctx, out, &out_len) <= 0) {
+		fprintf(stderr, "FAIL: test %zu - EVP_PKEY_derive with copy "
+		    "failed\n", i);
+		goto failed;
+	}
+	if (memcmp(out, st->out, sizeof(out)) != 0) {
+		fprintf(stderr, "FAIL: test %zu - EVP_PKEY_derive with copy "
+		    "mismatch\n", i);
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_PKEY_CTX_free(pctx);
+	EVP_PKEY_CTX_free(dctx);
+
+	return failed;
+}
+
+static int
+scrypt_ctrl_str_test(void)
+{
+	const struct scrypt_test *st = &scrypt_tests[1];
+	EVP_PKEY_CTX *pctx;
+	uint8_t out[64];
+	size_t out_len;
+	int failed = 1;
+
+	if ((pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_SCRYPT, NULL)) == NULL)
+		errx(1, "EVP_PKEY_CTX_new_id");
+	if (EVP_PKEY_derive_init(pctx) <= 0)
+		errx(1, "EVP_PKEY_derive_init");
+
+	if (EVP_PKEY_CTX_ctrl_str(pctx, "pass", st->pass) <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "hexsalt", "4e61436c") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "N", "1024") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "r", "8") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "p", "16") <= 0 ||
+	    EVP_PKEY_CTX_ctrl_str(pctx, "maxmem_bytes", "16777216") <= 0) {
+		fprintf(stderr, "FAIL: scrypt EVP_PKEY_CTX_ctrl_str\n");
+		goto failed;
+	}
+	if (EVP_PKEY_CTX_ctrl_str(pctx, "N", "1000") > 0) {
+		fprintf(stderr, "FAIL: scrypt accepted N that is not a power "
+		    "of two\n");
+		goto failed;
+	}
+
+	out_len = sizeof(out);
+	if (EVP_PKEY_derive(pctx, out, &out_len) <= 0) {
+		fprintf(stderr, "FAIL: scrypt derive failed\n");
+		goto failed;
+	}
+	if (memcmp(out, st->out, sizeof(out)) != 0) {
+		fprintf(stderr, "FAIL: scrypt with string controls mismatch\n");
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_PKEY_CTX_free(pctx);
+	ERR_clear_error();
+
+	return failed;
+}
+
+static int
+scrypt_params_test(void)
+{
+	int failed = 1;
+
+	/* 128 * r * (N + 2) + 128 * r * p bytes are needed. */
+	if (!EVP_PBE_scrypt(NULL, 0, NULL, 0, 1024, 8, 16, 0, NULL, 0)) {
+		fprintf(stderr, "FAIL: scrypt rejected default memory limit\n");
+		goto failed;
+	}
+	if (EVP_PBE_scrypt(NULL, 0, NULL, 0, 1024, 8, 16,
+	    128 * 8 * (1024 + 2 + 16) - 1, NULL, 0)) {
+		fprintf(stderr, "FAIL: scrypt exceeded memory limit\n");
+		goto failed;
+	}
+	if (EVP_PBE_scrypt(NULL, 0, NULL, 0, 65536, 1, 1, 0, NULL, 0)) {
+		fprintf(stderr, "FAIL: scrypt accepted N >= 2^(16 * r)\n");
+		goto failed;
+	}
+	if (EVP_PBE_scrypt(NULL, 0, NULL, 0, 1024, 1 << 15, 1 << 15, 0,
+	    NULL, 0)) {
+		fprintf(stderr, "FAIL: scrypt accepted p * r >= 2^30\n");
+		goto failed;
+	}
+
+	failed = 0;
+
+ failed:
+	ERR_clear_error();
+
+	return failed;
+}
+
+static int
+scrypt_romix_test(void)
+{
+	uint8_t want[4 * 128], got[4 * 128];
+	uint32_t *v, *xy;
+	size_t r, i;
+	int failed = 1;
+
+	if ((v = calloc(4 * 32 * 64, sizeof(*v))) == NULL)
+		err(1, NULL);
+	if ((xy = calloc(4 * 64, sizeof(*xy))) == NULL)
+		err(1, NULL);
+
+	for (r = 1; r <= 4; r++) {
+		for (i = 0; i < 128 * r; i++)
+			want[i] = i * 7 + r;
+		memcpy(got, want, 128 * r);
+
+		scrypt_romix_generic(want, r, 64, v, xy);
+		scrypt_romix(got, r, 64, v, xy);
+		if (memcmp(got, want, 128 * r) != 0) {
+			fprintf(stderr, "FAIL: scrypt_romix() with r = %zu "
+			    "differs from generic implementation\n", r);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	free(v);
+	free(xy);
+
+	return failed;
+}
+
+static void
+scrypt_benchmark_run(uint64_t N, uint64_t r, uint64_t p)
+{
+	struct timespec start, end, duration;
+	EVP_PKEY_CTX *pctx;
+	uint8_t out[32];
+	size_t out_len;
+	double secs;
+	int i, n = 10;
+
+	if ((pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_SCRYPT, NULL)) == NULL)
+		errx(1, "EVP_PKEY_CTX_new_id");
+	if (EVP_PKEY_derive_init(pctx) <= 0)
+		errx(1, "EVP_PKEY_derive_init");
+	if (EVP_PKEY_CTX_set1_pbe_pass(pctx, "password", 8) <= 0 ||
+	    EVP_PKEY_CTX_set1_scrypt_salt(pctx, "NaCl", 4) <= 0 ||
+	    EVP_PKEY_CTX_set_scrypt_N(pctx, N) <= 0 ||
+	    EVP_PKEY_CTX_set_scrypt_r(pctx, r) <= 0 ||
+	    EVP_PKEY_CTX_set_scrypt_p(pctx, p) <= 0)
+		errx(1, "setting scrypt parameters");
+
+	fprintf(stderr, "Benchmarking scrypt N=%llu r=%llu p=%llu: ",
+	    (unsigned long long)N, (unsigned long long)r,
+	    (unsigned long long)p);
+
+	/* The first derivation allocates the memory arena. */
+	out_len = sizeof(out);
+	if (EVP_PKEY_derive(pctx, out, &out_len) <= 0)
+		errx(1, "EVP_PKEY_derive");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < n; i++) {
+		out_len = sizeof(out);
+		if (EVP_PKEY_derive(pctx, out, &out_len) <= 0)
+			errx(1, "EVP_PKEY_derive");
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%.1f ms per derivation\n", secs * 1000.0 / n);
+
+	EVP_PKEY_CTX_free(pctx);
+}
+
+static void
+scrypt_benchmark(void)
+{
+	scrypt_benchmark_run(16384, 8, 1);
+	scrypt_benchmark_run(65536, 8, 1);
+}
+
+int
+main(int argc, char **argv)
+{
+	size_t i;
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= scrypt_romix_test();
+	for (i = 0; i < N_SCRYPT_TESTS; i++) {
+		failed |= scrypt_pbe_test(&scrypt_tests[i], i);
+		failed |= scrypt_pkey_test(&scrypt_tests[i], i);
+	}
+	failed |= scrypt_ctrl_str_test();
+	failed |= scrypt_params_test();
+
+	if (benchmark && !failed)
+		scrypt_benchmark();
+
+	return failed;
+}
@@ -0,0 +1,346 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/mlkem.h>
+#include <openssl/sha.h>
+
+#include "mlkem_internal.h"
+#include "sha3_internal.h"
+
+/*
+ * Known answer values for d = 00..1f, z = 20..3f and m = 40..5f, computed
+ * with an independent implementation written from FIPS 203. The keys and
+ * ciphertext are compared via their SHA-256 digests.
+ */
+static const uint8_t kat_ek_sha256[32] = {
+	0x0b, 0x79, 0x34, 0xc8, 0x31, 0x25, 0xc7, 0x88,
+	0x99, 0x5e, 0x2b, 0xa6, 0xbd, 0x76, 0x1e, 0x33,
+	0x04, 0x6b, 0x3e, 0x40, 0x57, 0x1b, 0xe5, 0x3e,
+	0x02, 0x33, 0x09, 0xa2, 0x9f, 0x39, 0x8c, 0xc9,
+};
+
+static const uint8_t kat_dk_sha256[32] = {
+	0xda, 0xc2, 0x68, 0xbd, 0xe6, 0xa8, 0xdd, 0x23,
+	0x8e, 0x98, 0x87, 0x11, 0x7d, 0x6b, 0x66, 0x4e,
+	0x7a, 0x7a, 0x93, 0x50, 0xad, 0x6b, 0x7c, 0x08,
+	0xa9, 0x48, 0xe5, 0x04, 0x80, 0x95, 0x72, 0xa5,
+};
+
+static const uint8_t kat_ct_sha256[32] = {
+	0xdb, 0xf4, 0xe9, 0xaa, 0x48, 0xb0, 0x78, 0xad,
+	0x46, 0xec, 0x1c, 0x9c, 0x47, 0xbd, 0xa8, 0xc2,
+	0xd2, 0xfe, 0xc9, 0xd0, 0xe7, 0xa2, 0x1b, 0xd4,
+	0x8d, 0x22, 0x38, 0xa2, 0xab, 0xed, 0xb8, 0x56,
+};
+
+static const uint8_t kat_shared_secret[32] = {
+	0x9c, 0xdd, 0xd0, 0x89, 0xff, 0xe7, 0x0e, 0x39,
+	0x96, 0xe7, 0x6f, 0x7c, 0x8d, 0x06, 0x74, 0x6d,
+	0xf3, 0x4d, 0x07, 0xe8, 0x65, 0x7b, 0xc0, 0xfc,
+	0xf2, 0xbb, 0x0e, 0x1c, 0x30, 0x84, 0xae, 0xa1,
+};
+
+static const uint8_t kat_reject_secret[32] = {
+	0xdc, 0xfc, 0x80, 0xc6, 0xdb, 0x46, 0xff, 0x70,
+	0x28, 0xe3, 0xa4, 0x39, 0x86, 0x51, 0xc0, 0x63,
+	0xae, 0x7a, 0x42, 0xc1, 0x07, 0xa6, 0xdc, 0x8c,
+	0xb0, 0x71, 0x41, 0x86, 0x16, 0x98, 0xab, 0x92,
+};
+
+/*
+ * Accumulated vectors from the C2SP CCTV project (c2sp.org/CCTV/ML-KEM):
+ * the SHAKE-128 digest of the results of n key generations,
+ * encapsulations and decapsulations of random ciphertexts, with all inputs
+ * read from a single SHAKE-128 stream.
+ */
+static const uint8_t accumulated_100[32] = {
+	0x11, 0x14, 0xb1, 0xb6, 0x69, 0x9e, 0xd1, 0x91,
+	0x73, 0x4f, 0xa3, 0x39, 0x37, 0x6a, 0xfa, 0x7e,
+	0x28, 0x5c, 0x9e, 0x6a, 0xcf, 0x6f, 0xf0, 0x17,
+	0x7d, 0x34, 0x66, 0x96, 0xce, 0x56, 0x44, 0x15,
+};
+
+static void
+hexdump(const uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 1; i <= len; i++)
+		fprintf(stderr, " 0x%02x,%s", buf[i - 1], (i % 8) ? "" : "\n");
+
+	fprintf(stderr, "\n");
+}
+
+static int
+check_digest(const char *name, const uint8_t *buf, size_t len,
+    const uint8_t want[SHA256_DIGEST_LENGTH])
+{
+	uint8_t got[SHA256_DIGEST_LENGTH];
+
+	SHA256(buf, len, got);
+	if (memcmp(got, want, sizeof(got)) != 0) {
+		fprintf(stderr, "FAIL: %s digest mismatch, got:\n", name);
+		hexdump(got, sizeof(got));
+		return 0;
+	}
+
+	return 1;
+}
+
+static int
+mlkem768_kat_test(void)
+{
+	uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES];
+	uint8_t private_key[MLKEM768_PRIVATE_KEY_BYTES];
+	uint8_t ciphertext[MLKEM768_CIPHERTEXT_BYTES];
+	uint8_t secret[MLKEM_SHARED_SECRET_BYTES];
+	uint8_t seed[MLKEM_SEED_BYTES];
+	uint8_t entropy[MLKEM_ENTROPY_BYTES];
+	size_t i;
+	int failed = 1;
+
+	for (i = 0; i < sizeof(seed); i++)
+		seed[i] = i;
+	for (i = 0; i < sizeof(entropy); i++)
+		entropy[i] = sizeof(seed) + i;
+
+	if (!mlkem768_generate_key_external_entropy(public_key, private_key,
+	    seed)) {
+		fprintf(stderr, "FAIL: key generation failed\n");
+		goto failure;
+	}
+	if (!check_digest("public key", public_key, sizeof(public_key),
+	    kat_ek_sha256))
+		goto failure;
+	if (!check_digest("private key", private_key, sizeof(private_key),
+	    kat_dk_sha256))
+		goto failure;
+
+	if (!mlkem768_encap_external_entropy(ciphertext, secret, public_key,
+	    entropy)) {
+		fprintf(stderr, "FAIL: encapsulation failed\n");
+		goto failure;
+	}
+	if (!check_digest("ciphertext", ciphertext, sizeof(ciphertext),
+	    kat_ct_sha256))
+		goto failure;
+	if (memcmp(secret, kat_shared_secret, sizeof(secret)) != 0) {
+		fprintf(stderr, "FAIL: encapsulated secret mismatch, got:\n");
+		hexdump(secret, sizeof(secret));
+		goto failure;
+	}
+
+	if (!MLKEM768_decap(secret, ciphertext, sizeof(ciphertext),
+	    private_key)) {
+		fprintf(stderr, "FAIL: decapsulation failed\n");
+		goto failure;
+	}
+	if (memcmp(secret, kat_shared_secret, sizeof(secret)) != 0) {
+		fprintf(stderr, "FAIL: decapsulated secret mismatch, got:\n");
+		hexdump(secret, sizeof(secret));
+		goto failure;
+	}
+
+	/* A modified ciphertext must yield the implicit rejection secret. */
+	ciphertext[0] ^= 1;
+	if (!MLKEM768_decap(secret, ciphertext, sizeof(ciphertext),
+	    private_key)) {
+		fprintf(stderr, "FAIL: decapsulation of bad ciphertext failed\n");
+		goto failure;
+	}
+	if (memcmp(secret, kat_reject_secret, sizeof(secret)) != 0) {
+		fprintf(stderr, "FAIL: implicit rejection secret mismatch, "
+		    "got:\n");
+		hexdump(secret, sizeof(secret));
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static int
+mlkem768_round_trip_test(void)
+{
+	uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES];
+	uint8_t private_key[MLKEM768_PRIVATE_KEY_BYTES];
+	uint8_t ciphertext[MLKEM768_CIPHERTEXT_BYTES];
+	uint8_t secret1[MLKEM_SHARED_SECRET_BYTES];
+	uint8_t secret2[MLKEM_SHARED_SECRET_BYTES];
+	int i;
+	int failed = 1;
+
+	for (i = 0; i < 100; i++) {
+		if (!MLKEM768_generate_key(public_key, private_key)) {
+			fprintf(stderr, "FAIL: key generation failed\n");
+			goto failure;
+		}
+		if (!MLKEM768_encap(ciphertext, secret1, public_key)) {
+			fprintf(stderr, "FAIL: encapsulation failed\n");
+			goto failure;
+		}
+		if (!MLKEM768_decap(secret2, ciphertext, sizeof(ciphertext),
+		    private_key)) {
+			fprintf(stderr, "FAIL: decapsulation failed\n");
+			goto failure;
+		}
+		if (memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+			fprintf(stderr, "FAIL: shared secrets differ\n");
+			goto failure;
+		}
+	}
+
+	if (MLKEM768_decap(secret2, ciphertext, sizeof(ciphertext) - 1,
+	    private_key)) {
+		fprintf(stderr, "FAIL: decapsulated short ciphertext\n");
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static int
+mlkem768_invalid_public_key_test(void)
+{
+	uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES];
+	uint8_t private_key[MLKEM768_PRIVATE_KEY_BYTES];
+	uint8_t ciphertext[MLKEM768_CIPHERTEXT_BYTES];
+	uint8_t secret[MLKEM_SHARED_SECRET_BYTES];
+	int failed = 1;
+
+	if (!MLKEM768_generate_key(public_key, private_key)) {
+		fprintf(stderr, "FAIL: key generation failed\n");
+		goto failure;
+	}
+
+	if (!MLKEM768_check_public_key(public_key)) {
+		fprintf(stderr, "FAIL: valid public key failed check\n");
+		goto failure;
+	}
+
+	/* Set the first coefficient to 4095, which is not reduced mod q. */
+	public_key[0] = 0xff;
+	public_key[1] |= 0x0f;
+
+	if (MLKEM768_check_public_key(public_key)) {
+		fprintf(stderr, "FAIL: invalid public key passed check\n");
+		goto failure;
+	}
+	if (MLKEM768_encap(ciphertext, secret, public_key)) {
+		fprintf(stderr, "FAIL: encapsulated to invalid public key\n");
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static int
+mlkem768_accumulated_test(int n, const uint8_t want[32])
+{
+	uint8_t public_key[MLKEM768_PUBLIC_KEY_BYTES];
+	uint8_t private_key[MLKEM768_PRIVATE_KEY_BYTES];
+	uint8_t ciphertext[MLKEM768_CIPHERTEXT_BYTES];
+	uint8_t secret1[MLKEM_SHARED_SECRET_BYTES];
+	uint8_t secret2[MLKEM_SHARED_SECRET_BYTES];
+	uint8_t seed[MLKEM_SEED_BYTES];
+	uint8_t entropy[MLKEM_ENTROPY_BYTES];
+	uint8_t got[32];
+	sha3_ctx in, out;
+	int i;
+	int failed = 1;
+
+	shake128_init(&in);
+	shake_xof(&in);
+	shake128_init(&out);
+
+	for (i = 0; i < n; i++) {
+		shake_out(&in, seed, sizeof(seed));
+		if (!mlkem768_generate_key_external_entropy(public_key,
+		    private_key, seed)) {
+			fprintf(stderr, "FAIL: key generation failed\n");
+			goto failure;
+		}
+		shake_update(&out, public_key, sizeof(public_key));
+
+		shake_out(&in, entropy, sizeof(entropy));
+		if (!mlkem768_encap_external_entropy(ciphertext, secret1,
+		    public_key, entropy)) {
+			fprintf(stderr, "FAIL: encapsulation failed\n");
+			goto failure;
+		}
+		shake_update(&out, ciphertext, sizeof(ciphertext));
+		shake_update(&out, secret1, sizeof(secret1));
+
+		if (!MLKEM768_decap(secret2, ciphertext, sizeof(ciphertext),
+		    private_key)) {
+			fprintf(stderr, "FAIL: decapsulation failed\n");
+			goto failure;
+		}
+		if (memcmp(secret1, secret2, sizeof(secret1)) != 0) {
+			fprintf(stderr, "FAIL: shared secrets differ\n");
+			goto failure;
+		}
+
+		shake_out(&in, ciphertext, sizeof(ciphertext));
+		if (!MLKEM768_decap(secret2, ciphertext, sizeof(ciphertext),
+		    private_key)) {
+			fprintf(stderr, "FAIL: decapsulation failed\n");
+			goto failure;
+		}
+		shake_update(&out, secret2, sizeof(secret2));
+	}
+
+	shake_xof(&out);
+	shake_out(&out, got, sizeof(got));
+	if (memcmp(got, want, sizeof(got)) != 0) {
+		fprintf(stderr, "FAIL: %d accumulated vectors, got:\n", n);
+		hexdump(got, sizeof(got));
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	int failed = 0;
+
+	failed |= mlkem768_kat_test();
+	failed |= mlkem768_accumulated_test(100, accumulated_100);
+	failed |= mlkem768_round_trip_test();
+	failed |= mlkem768_invalid_public_key_test();
+
+	return failed;
+}
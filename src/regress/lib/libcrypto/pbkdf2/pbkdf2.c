@@ -49,15 +49,20 @@
  */
 
 
+#include <err.h>
+#include <errno.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <errno.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <openssl/opensslconf.h>
 #include <openssl/evp.h>
 #include <openssl/err.h>
 #include <openssl/conf.h>
+#include <openssl/hmac.h>
 
 typedef struct {
 	const char *pass;
@@ -182,11 +187,224 @@ test_p5_pbkdf2(unsigned int n, const char *digestname, const testdata *test,
 	free(out);
 }
 
+/*
+ * Compare a long, multi-block output against PBKDF2 computed directly from
+ * HMAC, so that every output block and block index is checked.
+ */
+static void
+test_p5_pbkdf2_blocks(const char *digestname, int iter)
+{
+	const EVP_MD *digest;
+	unsigned char salt[20], out[2048], expected[2048];
+	unsigned char u[EVP_MAX_MD_SIZE], ubuf[sizeof(salt) + 4];
+	unsigned int i, ulen;
+	int j, k, mdlen, keylen, off;
+
+	digest = EVP_get_digestbyname(digestname);
+	if (digest == NULL) {
+		fprintf(stderr, "unknown digest %s\n", digestname);
+		exit(5);
+	}
+	mdlen = EVP_MD_size(digest);
+
+	memset(salt, 0x5a, sizeof(salt));
+
+	for (keylen = 1; keylen <= (int)sizeof(out); keylen += 53) {
+		for (i = 1, off = 0; off < keylen; i++, off += mdlen) {
+			memcpy(ubuf, salt, sizeof(salt));
+			ubuf[sizeof(salt) + 0] = (i >> 24) & 0xff;
+			ubuf[sizeof(salt) + 1] = (i >> 16) & 0xff;
+			ubuf[sizeof(salt) + 2] = (i >> 8) & 0xff;
+			ubuf[sizeof(salt) + 3] = i & 0xff;
+			if (HMAC(digest, "password", 8, ubuf, sizeof(ubuf), u,
+			    &ulen) == NULL) {
+				fprintf(stderr, "HMAC(%s) failed\n", digestname);
+				exit(3);
+			}
+			memcpy(&expected[off], u, mdlen);
+			for (j = 1; j < iter; j++) {
+				if (HMAC(digest, "password", 8, u, mdlen, u,
+				    &ulen) == NULL) {
+					fprintf(stderr, "HMAC(%s) failed\n",
+					    digestname);
+					exit(3);
+				}
+				for (k = 0; k < mdlen; k++)
+					expected[off + k] ^= u[k];
+			}
+		}
+
+		if (!PKCS5_PBKDF2_HMAC("password", 8, salt, sizeof(salt),
+		    iter, digest, keylen, out)) {
+			fprintf(stderr, "PKCS5_PBKDF2_HMAC(%s) failure for "
+			    "keylen %d\n", digestname, keylen);
+			exit(3);
+		}
+		if (memcmp(expected, out, keylen) != 0) {
+			fprintf(stderr, "Wrong result for PKCS5_PBKDF2_HMAC(%s) "
+			    "keylen %d iter %d\n", digestname, keylen, iter);
+			hexdump(stderr, "expected: ", expected, keylen);
+			hexdump(stderr, "result:   ", out, keylen);
+			exit(2);
+		}
+	}
+}
+
+#define MULTI_PASSWORDS	37
+
+/*
+ * Derive keys for a batch of passwords, each with its own salt, and compare
+ * them against PBKDF2 for each password on its own.
+ */
+static void
+test_p5_pbkdf2_multi(const char *digestname, int iter, int keylen)
+{
+	const EVP_MD *digest;
+	char pass[MULTI_PASSWORDS][32];
+	unsigned char salt[MULTI_PASSWORDS][16];
+	unsigned char out[MULTI_PASSWORDS][256], expected[256];
+	const char *passp[MULTI_PASSWORDS];
+	const unsigned char *saltp[MULTI_PASSWORDS];
+	unsigned char *outp[MULTI_PASSWORDS];
+	int passlen[MULTI_PASSWORDS], saltlen[MULTI_PASSWORDS];
+	size_t i, n;
+
+	digest = EVP_get_digestbyname(digestname);
+	if (digest == NULL) {
+		fprintf(stderr, "unknown digest %s\n", digestname);
+		exit(5);
+	}
+
+	for (i = 0; i < MULTI_PASSWORDS; i++) {
+		snprintf(pass[i], sizeof(pass[i]), "password %zu", i * 7919);
+		memset(salt[i], 0x20 + i, sizeof(salt[i]));
+		passp[i] = pass[i];
+		passlen[i] = (i % 3 == 0) ? -1 : strlen(pass[i]);
+		saltp[i] = salt[i];
+		saltlen[i] = i % sizeof(salt[i]);
+		outp[i] = out[i];
+	}
+
+	for (n = 1; n <= MULTI_PASSWORDS; n += 6) {
+		memset(out, 0, sizeof(out));
+		if (!PKCS5_PBKDF2_HMAC_multi(passp, passlen, saltp, saltlen,
+		    iter, digest, keylen, outp, n)) {
+			fprintf(stderr, "PKCS5_PBKDF2_HMAC_multi(%s) failure "
+			    "for %zu passwords\n", digestname, n);
+			exit(3);
+		}
+		for (i = 0; i < n; i++) {
+			if (!PKCS5_PBKDF2_HMAC(passp[i], passlen[i], saltp[i],
+			    saltlen[i], iter, digest, keylen, expected)) {
+				fprintf(stderr, "PKCS5_PBKDF2_HMAC(%s) failure\n",
+				    digestname);
+				exit(3);
+			}
+			if (memcmp(expected, out[i], keylen) != 0) {
+				fprintf(stderr, "Wrong result for "
+				    "PKCS5_PBKDF2_HMAC_multi(%s) password %zu "
+				    "of %zu, keylen %d iter %d\n", digestname,
+				    i, n, keylen, iter);
+				hexdump(stderr, "expected: ", expected, keylen);
+				hexdump(stderr, "result:   ", out[i], keylen);
+				exit(2);
+			}
+		}
+	}
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+/*
+ * Report the number of PBKDF2 derivations per second on a single core, for
+ * passwords derived one at a time or in batches of MULTI_PASSWORDS.
+ */
+static void
+pbkdf2_benchmark_run(const char *digestname, int batch, int seconds)
+{
+	struct timespec start, end, duration;
+	const EVP_MD *digest;
+	unsigned char salt[16], out[MULTI_PASSWORDS][EVP_MAX_MD_SIZE];
+	const char *passp[MULTI_PASSWORDS];
+	const unsigned char *saltp[MULTI_PASSWORDS];
+	unsigned char *outp[MULTI_PASSWORDS];
+	int passlen[MULTI_PASSWORDS], saltlen[MULTI_PASSWORDS];
+	int iter = 10000, keylen;
+	double secs;
+	uint64_t count;
+	size_t i;
+
+	if ((digest = EVP_get_digestbyname(digestname)) == NULL)
+		errx(1, "unknown digest %s", digestname);
+	keylen = EVP_MD_size(digest);
+
+	memset(salt, 0x5a, sizeof(salt));
+	for (i = 0; i < MULTI_PASSWORDS; i++) {
+		passp[i] = "password";
+		passlen[i] = 8;
+		saltp[i] = salt;
+		saltlen[i] = sizeof(salt);
+		outp[i] = out[i];
+	}
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	count = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking PBKDF2-HMAC-%s%s for %ds: ", digestname,
+	    batch ? " batch" : "", seconds);
+	while (!benchmark_stop) {
+		if (batch) {
+			if (!PKCS5_PBKDF2_HMAC_multi(passp, passlen, saltp,
+			    saltlen, iter, digest, keylen, outp,
+			    MULTI_PASSWORDS))
+				errx(1, "PKCS5_PBKDF2_HMAC_multi failed");
+			count += MULTI_PASSWORDS;
+		} else {
+			if (!PKCS5_PBKDF2_HMAC(passp[0], passlen[0], saltp[0],
+			    saltlen[0], iter, digest, keylen, outp[0]))
+				errx(1, "PKCS5_PBKDF2_HMAC failed");
+			count++;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu derivations of %d iterations in %f seconds "
+	    "(%.1f hashes/s per core)\n", (unsigned long long)count, iter,
+	    secs, count / secs);
+}
+
+static void
+pbkdf2_benchmark(void)
+{
+	pbkdf2_benchmark_run("sha1", 0, 3);
+	pbkdf2_benchmark_run("sha1", 1, 3);
+	pbkdf2_benchmark_run("sha256", 0, 3);
+	pbkdf2_benchmark_run("sha256", 1, 3);
+	pbkdf2_benchmark_run("sha512", 0, 3);
+	pbkdf2_benchmark_run("sha512", 1, 3);
+}
+
 int
 main(int argc,char **argv)
 {
 	unsigned int n;
 	const testdata *test = test_cases;
+	int benchmark = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
 
 	OpenSSL_add_all_digests();
 
@@ -196,6 +414,23 @@ main(int argc,char **argv)
 		test_p5_pbkdf2(n, "sha512", test, sha512_results[n]);
 	}
 
+	test_p5_pbkdf2_blocks("sha1", 1);
+	test_p5_pbkdf2_blocks("sha1", 3);
+	test_p5_pbkdf2_blocks("sha256", 1);
+	test_p5_pbkdf2_blocks("sha256", 3);
+	test_p5_pbkdf2_blocks("sha512", 3);
+
+	test_p5_pbkdf2_multi("sha1", 1, 20);
+	test_p5_pbkdf2_multi("sha1", 3, 45);
+	test_p5_pbkdf2_multi("sha256", 3, 1);
+	test_p5_pbkdf2_multi("sha256", 3, 100);
+	test_p5_pbkdf2_multi("sha384", 3, 48);
+	test_p5_pbkdf2_multi("sha512", 3, 64);
+	test_p5_pbkdf2_multi("sha512", 5, 200);
+
+	if (benchmark)
+		pbkdf2_benchmark();
+
 	EVP_cleanup();
 	CRYPTO_cleanup_all_ex_data();
 	ERR_remove_thread_state(NULL);
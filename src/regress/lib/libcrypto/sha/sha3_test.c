@@ -0,0 +1,252 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <endian.h>
+#include <err.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sha3_internal.h"
+
+/* Keccak-f[1600] applied to the all zero state. */
+static const uint64_t keccakf_zero_out[25] = {
+	0xf1258f7940e1dde7, 0x84d5ccf933c0478a, 0xd598261ea65aa9ee,
+	0xbd1547306f80494d, 0x8b284e056253d057, 0xff97a42d7f8e6fd4,
+	0x90fee5a0a44647c4, 0x8c5bda0cd6192e76, 0xad30a6f71b19059c,
+	0x30935ab7d08ffc64, 0xeb5aa93f2317d635, 0xa9a6e6260d712103,
+	0x81a57c16dbcf555f, 0x43b831cd0347c826, 0x01f22f1a11a5569f,
+	0x05e5635a21d9ae61, 0x64befef28cc970f2, 0x613670957bc46611,
+	0xb87c5a554fd00ecb, 0x8c3ee88a1ccf32c8, 0x940c7922ae3a2614,
+	0x1841f924a2c509e4, 0x16f53526e70465c2, 0x75f644e97f30a13b,
+	0xeaf1ff7b5ceca249,
+};
+
+static void
+keccakf_state_fill(uint64_t st[25], uint64_t seed)
+{
+	int i;
+
+	for (i = 0; i < 25; i++) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		st[i] = seed;
+	}
+}
+
+static int
+keccakf_test(void)
+{
+	uint64_t st[25], want[4][25], got[4][25];
+	uint64_t *stp[4];
+	int i, j;
+	int failed = 1;
+
+	memset(st, 0, sizeof(st));
+	sha3_keccakf(st);
+	for (i = 0; i < 25; i++)
+		st[i] = le64toh(st[i]);
+	if (memcmp(st, keccakf_zero_out, sizeof(st)) != 0) {
+		fprintf(stderr, "FAIL: Keccak-f[1600] of zero state mismatch\n");
+		goto failed;
+	}
+
+	for (i = 0; i < 64; i++) {
+		for (j = 0; j < 4; j++) {
+			keccakf_state_fill(want[j], i * 4 + j);
+			memcpy(got[j], want[j], sizeof(got[j]));
+			stp[j] = got[j];
+		}
+
+		memcpy(st, want[0], sizeof(st));
+		sha3_keccakf_generic(st);
+		sha3_keccakf(want[0]);
+		if (memcmp(st, want[0], sizeof(st)) != 0) {
+			fprintf(stderr, "FAIL: test %d - sha3_keccakf() "
+			    "differs from generic implementation\n", i);
+			goto failed;
+		}
+		for (j = 1; j < 4; j++)
+			sha3_keccakf(want[j]);
+
+		sha3_keccakf_x4(stp);
+		for (j = 0; j < 4; j++) {
+			if (memcmp(got[j], want[j], sizeof(got[j])) != 0) {
+				fprintf(stderr, "FAIL: test %d - "
+				    "sha3_keccakf_x4() state %d mismatch\n",
+				    i, j);
+				goto failed;
+			}
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static int
+shake_x4_test_len(int bits, size_t out_len, size_t chunk)
+{
+	sha3_ctx ctxs[4], *ctx[4];
+	sha3_ctx want_ctx;
+	uint8_t in[4][300];
+	uint8_t got[4][1024], want[1024];
+	uint8_t *out[4];
+	size_t len, n;
+	int i;
+	int failed = 1;
+
+	if (out_len > sizeof(want))
+		errx(1, "output length too large");
+
+	for (i = 0; i < 4; i++) {
+		memset(in[i], 'a' + i, sizeof(in[i]));
+		ctx[i] = &ctxs[i];
+		if (bits == 128)
+			shake128_init(ctx[i]);
+		else
+			shake256_init(ctx[i]);
+		shake_update(ctx[i], in[i], 97 * i + 1);
+	}
+	shake_xof_x4(ctx);
+
+	for (len = 0; len < out_len; len += n) {
+		if ((n = out_len - len) > chunk)
+			n = chunk;
+		for (i = 0; i < 4; i++)
+			out[i] = &got[i][len];
+		shake_out_x4(ctx, out, n);
+	}
+
+	for (i = 0; i < 4; i++) {
+		if (bits == 128)
+			shake128_init(&want_ctx);
+		else
+			shake256_init(&want_ctx);
+		shake_update(&want_ctx, in[i], 97 * i + 1);
+		shake_xof(&want_ctx);
+		shake_out(&want_ctx, want, out_len);
+
+		if (memcmp(got[i], want, out_len) != 0) {
+			fprintf(stderr, "FAIL: SHAKE%d x4 with %zu bytes in "
+			    "%zu byte chunks, context %d mismatch\n", bits,
+			    out_len, chunk, i);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static int
+shake_x4_test(void)
+{
+	static const size_t lens[] = { 1, 32, 136, 168, 169, 504, 1024 };
+	static const size_t chunks[] = { 1, 7, 136, 168, 1024 };
+	size_t i, j;
+	int failed = 0;
+
+	for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+		for (j = 0; j < sizeof(chunks) / sizeof(chunks[0]); j++) {
+			failed |= shake_x4_test_len(128, lens[i], chunks[j]);
+			failed |= shake_x4_test_len(256, lens[i], chunks[j]);
+		}
+	}
+
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+keccakf_benchmark_run(const char *label, int parallel, int seconds)
+{
+	struct timespec start, end, duration;
+	uint64_t st[4][25], *stp[4];
+	double secs;
+	uint64_t i;
+	int j;
+
+	for (j = 0; j < 4; j++) {
+		keccakf_state_fill(st[j], j);
+		stp[j] = st[j];
+	}
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s for %ds: ", label, seconds);
+	while (!benchmark_stop) {
+		if (parallel) {
+			sha3_keccakf_x4(stp);
+			i += 4;
+		} else {
+			sha3_keccakf(st[0]);
+			i++;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu permutations in %f seconds (%.2f MB/s)\n",
+	    (unsigned long long)i, secs, i * 200 / secs / 1000000.0);
+}
+
+static void
+keccakf_benchmark(void)
+{
+	keccakf_benchmark_run("Keccak-f[1600]", 0, 3);
+	keccakf_benchmark_run("Keccak-f[1600] x4", 1, 3);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= keccakf_test();
+	failed |= shake_x4_test();
+
+	if (benchmark && !failed)
+		keccakf_benchmark();
+
+	return failed;
+}
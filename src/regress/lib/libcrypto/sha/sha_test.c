@@ -15,11 +15,18 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
-#include <openssl/evp.h>
-#include <openssl/sha.h>
+#include <sys/time.h>
 
+#include <err.h>
+#include <signal.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
 
 struct sha_test {
 	const int algorithm;
@@ -924,13 +931,211 @@ sha_repetition_test(void)
 	return failed;
 }
 
+typedef void (*sha_multi_hash_func)(const unsigned char *const *,
+    const size_t *, unsigned char *const *, size_t);
+
+#define SHA_MULTI_MAX_MESSAGES	40
+
+static int
+sha_multi_hash_from_algorithm(int algorithm, sha_multi_hash_func *out_func)
+{
+	switch (algorithm) {
+	case NID_sha1:
+		*out_func = SHA1_multi_hash;
+		return 1;
+	case NID_sha256:
+		*out_func = SHA256_multi_hash;
+		return 1;
+	}
+
+	fprintf(stderr, "FAIL: no multi-hash for algorithm (%d)\n", algorithm);
+
+	return 0;
+}
+
+static int
+sha_multi_test_algorithm(int algorithm)
+{
+	static uint8_t buf[SHA_MULTI_MAX_MESSAGES][1024];
+	uint8_t out[SHA_MULTI_MAX_MESSAGES][EVP_MAX_MD_SIZE];
+	uint8_t want[EVP_MAX_MD_SIZE];
+	const unsigned char *in[SHA_MULTI_MAX_MESSAGES];
+	unsigned char *md[SHA_MULTI_MAX_MESSAGES];
+	size_t in_len[SHA_MULTI_MAX_MESSAGES];
+	sha_multi_hash_func multi_func;
+	sha_hash_func sha_func;
+	const char *label;
+	size_t i, j, n, out_len;
+
+	if (!sha_hash_from_algorithm(algorithm, &label, &sha_func, NULL,
+	    &out_len))
+		return 1;
+	if (!sha_multi_hash_from_algorithm(algorithm, &multi_func))
+		return 1;
+
+	arc4random_buf(buf, sizeof(buf));
+
+	for (i = 0; i < 200; i++) {
+		n = arc4random_uniform(SHA_MULTI_MAX_MESSAGES + 1);
+
+		/*
+		 * Mix short messages, which only require padding blocks, with
+		 * long messages of varying block counts and alignment.
+		 */
+		for (j = 0; j < n; j++) {
+			in[j] = &buf[j][arc4random_uniform(8)];
+			if (i % 2 == 0)
+				in_len[j] = arc4random_uniform(130);
+			else
+				in_len[j] = arc4random_uniform(1016);
+			md[j] = out[j];
+		}
+
+		multi_func(in, in_len, md, n);
+
+		for (j = 0; j < n; j++) {
+			sha_func(in[j], in_len[j], want);
+			if (memcmp(want, out[j], out_len) != 0) {
+				fprintf(stderr, "FAIL (%s:%zu): multi-hash "
+				    "mismatch for message %zu of %zu "
+				    "(%zu bytes)\n", label, i, j, n, in_len[j]);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static int
+sha_multi_test(void)
+{
+	int failed = 0;
+
+	failed |= sha_multi_test_algorithm(NID_sha1);
+	failed |= sha_multi_test_algorithm(NID_sha256);
+
+	return failed;
+}
+
+struct sha_benchmark {
+	const int algorithm;
+	const size_t in_len;
+	const size_t messages;
+};
+
+static const struct sha_benchmark sha_benchmarks[] = {
+	{ NID_sha1, 64, 1 },
+	{ NID_sha1, 1024, 1 },
+	{ NID_sha1, 16384, 1 },
+	{ NID_sha1, 64, 16 },
+	{ NID_sha1, 1024, 16 },
+	{ NID_sha256, 64, 1 },
+	{ NID_sha256, 1024, 1 },
+	{ NID_sha256, 16384, 1 },
+	{ NID_sha256, 64, 16 },
+	{ NID_sha256, 1024, 16 },
+	{ NID_sha512, 64, 1 },
+	{ NID_sha512, 1024, 1 },
+	{ NID_sha512, 16384, 1 },
+	{ NID_sha3_256, 64, 1 },
+	{ NID_sha3_256, 1024, 1 },
+	{ NID_sha3_256, 16384, 1 },
+};
+
+#define N_SHA_BENCHMARKS (sizeof(sha_benchmarks) / sizeof(sha_benchmarks[0]))
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+sha_benchmark_run(const struct sha_benchmark *sb, int seconds)
+{
+	struct timespec start, end, duration;
+	static uint8_t buf[16][16384];
+	static uint8_t out[16][EVP_MAX_MD_SIZE];
+	const unsigned char *in[16];
+	unsigned char *md[16];
+	size_t in_len[16];
+	sha_multi_hash_func multi_func = NULL;
+	const EVP_MD *md_type;
+	const char *label;
+	double secs;
+	uint64_t i;
+	size_t j;
+
+	if (!sha_hash_from_algorithm(sb->algorithm, &label, NULL, &md_type,
+	    NULL))
+		errx(1, "unknown algorithm");
+	if (sb->in_len > sizeof(buf[0]))
+		errx(1, "benchmark length too large");
+	if (sb->messages > 16)
+		errx(1, "benchmark message count too large");
+	if (sb->messages > 1 &&
+	    !sha_multi_hash_from_algorithm(sb->algorithm, &multi_func))
+		errx(1, "unknown multi-hash algorithm");
+
+	arc4random_buf(buf, sizeof(buf));
+
+	for (j = 0; j < sb->messages; j++) {
+		in[j] = buf[j];
+		in_len[j] = sb->in_len;
+		md[j] = out[j];
+	}
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s (%zu x %zu bytes) for %ds: ", label,
+	    sb->messages, sb->in_len, seconds);
+	while (!benchmark_stop) {
+		if (multi_func != NULL) {
+			multi_func(in, in_len, md, sb->messages);
+		} else if (!EVP_Digest(buf[0], sb->in_len, out[0], NULL,
+		    md_type, NULL))
+			errx(1, "EVP_Digest failed");
+		i += sb->messages;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu messages in %f seconds (%.2f MB/s)\n",
+	    (unsigned long long)i, secs, i * sb->in_len / secs / 1000000.0);
+}
+
+static void
+sha_benchmark(void)
+{
+	size_t i;
+
+	for (i = 0; i < N_SHA_BENCHMARKS; i++)
+		sha_benchmark_run(&sha_benchmarks[i], 3);
+}
+
 int
 main(int argc, char **argv)
 {
-	int failed = 0;
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
 
 	failed |= sha_test();
 	failed |= sha_repetition_test();
+	failed |= sha_multi_test();
+
+	if (benchmark && !failed)
+		sha_benchmark();
 
 	return failed;
 }
@@ -0,0 +1,259 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+#include <openssl/sm4.h>
+
+#include "sm4_internal.h"
+
+#define TEST_BLOCKS	67
+
+static const uint8_t test_key[SM4_BLOCK_SIZE] = {
+	0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+	0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+};
+
+static void
+test_fill(uint8_t *buf, size_t len, uint32_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+/*
+ * Compare the multi-block encryption with the single block implementation,
+ * for every block count up to TEST_BLOCKS, in place and out of place.
+ */
+static int
+sm4_blocks_test(void)
+{
+	uint8_t in[TEST_BLOCKS * SM4_BLOCK_SIZE];
+	uint8_t out[TEST_BLOCKS * SM4_BLOCK_SIZE];
+	uint8_t want[TEST_BLOCKS * SM4_BLOCK_SIZE];
+	SM4_KEY key;
+	size_t i, n;
+	int failed = 1;
+
+	if (!SM4_set_key(test_key, &key))
+		errx(1, "SM4_set_key failed");
+
+	for (n = 0; n <= TEST_BLOCKS; n++) {
+		test_fill(in, sizeof(in), n);
+		for (i = 0; i < n; i++)
+			SM4_encrypt(&in[i * SM4_BLOCK_SIZE],
+			    &want[i * SM4_BLOCK_SIZE], &key);
+
+		memset(out, 0, sizeof(out));
+		sm4_encrypt_blocks(in, out, n, &key);
+		if (memcmp(out, want, n * SM4_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: sm4_encrypt_blocks with %zu "
+			    "blocks differs\n", n);
+			goto failed;
+		}
+
+		sm4_encrypt_blocks_generic(in, out, n, &key);
+		if (memcmp(out, want, n * SM4_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: sm4_encrypt_blocks_generic "
+			    "with %zu blocks differs\n", n);
+			goto failed;
+		}
+
+		sm4_ecb_encrypt_blocks(in, in, n, &key, 1);
+		if (memcmp(in, want, n * SM4_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: in place encryption with %zu "
+			    "blocks differs\n", n);
+			goto failed;
+		}
+
+		sm4_ecb_encrypt_blocks(in, in, n, &key, 0);
+		test_fill(out, sizeof(out), n);
+		if (memcmp(in, out, n * SM4_BLOCK_SIZE) != 0) {
+			fprintf(stderr, "FAIL: in place decryption with %zu "
+			    "blocks differs\n", n);
+			goto failed;
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	return failed;
+}
+
+static int
+sm4_evp_cipher_test(const char *name, const EVP_CIPHER *cipher)
+{
+	uint8_t in[TEST_BLOCKS * SM4_BLOCK_SIZE];
+	uint8_t out[TEST_BLOCKS * SM4_BLOCK_SIZE];
+	uint8_t want[TEST_BLOCKS * SM4_BLOCK_SIZE];
+	uint8_t iv[SM4_BLOCK_SIZE];
+	EVP_CIPHER_CTX *ctx = NULL;
+	size_t i, n;
+	int enc, out_len;
+	int failed = 1;
+
+	if ((ctx = EVP_CIPHER_CTX_new()) == NULL)
+		errx(1, "EVP_CIPHER_CTX_new failed");
+
+	/* Force a counter wrap within the first few blocks. */
+	memset(iv, 0xff, sizeof(iv));
+	iv[0] = 0x5a;
+
+	for (n = 1; n <= TEST_BLOCKS; n += 6) {
+		for (enc = 1; enc >= 0; enc--) {
+			test_fill(in, sizeof(in), n);
+
+			/* One block at a time as the reference result. */
+			if (!EVP_CipherInit_ex(ctx, cipher, NULL, test_key,
+			    iv, enc))
+				errx(1, "EVP_CipherInit_ex failed");
+			EVP_CIPHER_CTX_set_padding(ctx, 0);
+			for (i = 0; i < n; i++) {
+				if (!EVP_CipherUpdate(ctx,
+				    &want[i * SM4_BLOCK_SIZE], &out_len,
+				    &in[i * SM4_BLOCK_SIZE], SM4_BLOCK_SIZE))
+					errx(1, "EVP_CipherUpdate failed");
+			}
+
+			/* All blocks at once, in place. */
+			if (!EVP_CipherInit_ex(ctx, cipher, NULL, test_key,
+			    iv, enc))
+				errx(1, "EVP_CipherInit_ex failed");
+			EVP_CIPHER_CTX_set_padding(ctx, 0);
+			memcpy(out, in, n * SM4_BLOCK_SIZE);
+			if (!EVP_CipherUpdate(ctx, out, &out_len, out,
+			    n * SM4_BLOCK_SIZE))
+				errx(1, "EVP_CipherUpdate failed");
+
+			if (memcmp(out, want, n * SM4_BLOCK_SIZE) != 0) {
+				fprintf(stderr, "FAIL: %s %s with %zu blocks "
+				    "differs\n", name,
+				    enc ? "encryption" : "decryption", n);
+				goto failed;
+			}
+		}
+	}
+
+	failed = 0;
+
+ failed:
+	EVP_CIPHER_CTX_free(ctx);
+
+	return failed;
+}
+
+static int
+sm4_evp_test(void)
+{
+	int failed = 0;
+
+	failed |= sm4_evp_cipher_test("SM4-ECB", EVP_sm4_ecb());
+	failed |= sm4_evp_cipher_test("SM4-CBC", EVP_sm4_cbc());
+	failed |= sm4_evp_cipher_test("SM4-CTR", EVP_sm4_ctr());
+
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+sm4_benchmark_run(const char *label, const EVP_CIPHER *cipher, int seconds)
+{
+	struct timespec start, end, duration;
+	uint8_t buf[16384], iv[SM4_BLOCK_SIZE];
+	EVP_CIPHER_CTX *ctx;
+	double secs;
+	uint64_t i;
+	int out_len;
+
+	if ((ctx = EVP_CIPHER_CTX_new()) == NULL)
+		errx(1, "EVP_CIPHER_CTX_new failed");
+
+	memset(iv, 0, sizeof(iv));
+	test_fill(buf, sizeof(buf), 0);
+	if (!EVP_DecryptInit_ex(ctx, cipher, NULL, test_key, iv))
+		errx(1, "EVP_DecryptInit_ex failed");
+	EVP_CIPHER_CTX_set_padding(ctx, 0);
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s for %ds: ", label, seconds);
+	while (!benchmark_stop) {
+		if (!EVP_DecryptUpdate(ctx, buf, &out_len, buf, sizeof(buf)))
+			errx(1, "EVP_DecryptUpdate failed");
+		i++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	secs = duration.tv_sec + duration.tv_nsec / 1000000000.0;
+	fprintf(stderr, "%llu runs in %f seconds (%.2f MB/s)\n",
+	    (unsigned long long)i, secs, i * sizeof(buf) / secs / 1000000.0);
+
+	EVP_CIPHER_CTX_free(ctx);
+}
+
+static void
+sm4_benchmark(void)
+{
+	sm4_benchmark_run("SM4-ECB decrypt", EVP_sm4_ecb(), 3);
+	sm4_benchmark_run("SM4-CBC decrypt", EVP_sm4_cbc(), 3);
+	sm4_benchmark_run("SM4-CTR", EVP_sm4_ctr(), 3);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= sm4_blocks_test();
+	failed |= sm4_evp_test();
+
+	if (benchmark && !failed)
+		sm4_benchmark();
+
+	return failed;
+}
@@ -703,14 +703,25 @@ func cipherAes(algorithm string, size int) (*C.EVP_CIPHER, error) {
 	return nil, fmt.Errorf("invalid key size: %d", size)
 }
 
-var aesAeads = map[int]*C.EVP_AEAD{
+var aesCcmAeads = map[int]*C.EVP_AEAD{
+	128: C.EVP_aead_aes_128_ccm(),
+	192: nil,
+	256: C.EVP_aead_aes_256_ccm(),
+}
+
+var aesGcmAeads = map[int]*C.EVP_AEAD{
 	128: C.EVP_aead_aes_128_gcm(),
 	192: nil,
 	256: C.EVP_aead_aes_256_gcm(),
 }
 
-func aeadAes(size int) (*C.EVP_AEAD, error) {
-	aead, ok := aesAeads[size]
+var aesAeads = map[string]map[int]*C.EVP_AEAD{
+	"AES-CCM": aesCcmAeads,
+	"AES-GCM": aesGcmAeads,
+}
+
+func aeadAes(algorithm string, size int) (*C.EVP_AEAD, error) {
+	aead, ok := aesAeads[algorithm][size]
 	if ok {
 		return aead, nil
 	}
@@ -1019,9 +1030,10 @@ func (wtg *wycheproofTestGroupAesAead) run(algorithm string, variant testVariant
 		fmt.Printf("INFO: Skipping tests with %s\n", err)
 		return true
 	}
+	// The AES-CCM AEADs only support 96 bit nonces.
 	var aead *C.EVP_AEAD
-	if algorithm == "AES-GCM" {
-		aead, err = aeadAes(wtg.KeySize)
+	if algorithm == "AES-GCM" || (algorithm == "AES-CCM" && wtg.IVSize == 96) {
+		aead, err = aeadAes(algorithm, wtg.KeySize)
 		if err != nil {
 			log.Fatalf("%s", err)
 		}
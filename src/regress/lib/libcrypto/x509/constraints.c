@@ -563,6 +563,198 @@ test_constraints1(void)
 	return failure;
 }
 
+struct compiled_test_name {
+	int type;
+	const char *name;
+};
+
+static const struct compiled_test_name compiled_constraints[] = {
+	{ GEN_DNS, "" },
+	{ GEN_DNS, "openbsd.org" },
+	{ GEN_DNS, ".openbsd.org" },
+	{ GEN_DNS, "www.openbsd.org" },
+	{ GEN_DNS, "EXAMPLE.net" },
+	{ GEN_EMAIL, "openbsd.org" },
+	{ GEN_EMAIL, ".openbsd.org" },
+	{ GEN_EMAIL, "beck@openbsd.org" },
+	{ GEN_EMAIL, "@example.com" },
+	{ GEN_URI, ".openbsd.org" },
+	{ GEN_URI, "www.openbsd.org" },
+	{ GEN_URI, "" },
+	{ GEN_IPADD, "10.0.0.0/255.0.0.0" },
+	{ GEN_IPADD, "192.168.1.0/255.255.255.0" },
+	{ GEN_IPADD, "192.168.1.128/255.255.255.128" },
+	{ GEN_IPADD, "2001:db8::/ffff:ffff::" },
+};
+
+#define N_COMPILED_CONSTRAINTS \
+    (sizeof(compiled_constraints) / sizeof(compiled_constraints[0]))
+
+static const struct compiled_test_name compiled_names[] = {
+	{ GEN_DNS, "www.openbsd.org" },
+	{ GEN_DNS, "openbsd.org" },
+	{ GEN_DNS, "xopenbsd.org" },
+	{ GEN_DNS, "WWW.OpenBSD.org" },
+	{ GEN_DNS, "www.example.net" },
+	{ GEN_DNS, "freebsd.org" },
+	{ GEN_EMAIL, "beck@openbsd.org" },
+	{ GEN_EMAIL, "beck@www.openbsd.org" },
+	{ GEN_EMAIL, "tb@OpenBSD.org" },
+	{ GEN_EMAIL, "jsing@example.com" },
+	{ GEN_URI, "www.openbsd.org" },
+	{ GEN_URI, "openbsd.org" },
+	{ GEN_URI, "ftp.openbsd.org" },
+	{ GEN_URI, "www.openbsd.org.example.com" },
+	{ GEN_IPADD, "10.1.2.3" },
+	{ GEN_IPADD, "192.168.1.1" },
+	{ GEN_IPADD, "192.168.1.200" },
+	{ GEN_IPADD, "192.168.2.1" },
+	{ GEN_IPADD, "2001:db8::1" },
+	{ GEN_IPADD, "2001:db9::1" },
+};
+
+#define N_COMPILED_NAMES \
+    (sizeof(compiled_names) / sizeof(compiled_names[0]))
+
+static struct x509_constraints_name *
+compiled_test_constraint(const struct compiled_test_name *tc)
+{
+	struct x509_constraints_name *constraint = NULL;
+	GENERAL_NAME *gn;
+	int error;
+
+	if ((gn = GENERAL_NAME_new()) == NULL)
+		errx(1, "GENERAL_NAME_new");
+	gn->type = tc->type;
+	if (tc->type == GEN_IPADD) {
+		if ((gn->d.iPAddress = a2i_IPADDRESS_NC(tc->name)) == NULL)
+			errx(1, "a2i_IPADDRESS_NC");
+	} else {
+		if ((gn->d.ia5 = ASN1_IA5STRING_new()) == NULL)
+			errx(1, "ASN1_IA5STRING_new");
+		if (!ASN1_STRING_set(gn->d.ia5, tc->name, strlen(tc->name)))
+			errx(1, "ASN1_STRING_set");
+	}
+	if (!x509_constraints_validate(gn, &constraint, &error))
+		errx(1, "x509_constraints_validate %s", tc->name);
+	GENERAL_NAME_free(gn);
+
+	return constraint;
+}
+
+static struct x509_constraints_names *
+compiled_test_names(const struct compiled_test_name *tn)
+{
+	struct x509_constraints_names *names;
+	struct x509_constraints_name *name;
+	ASN1_OCTET_STRING *ip;
+	CBS cbs;
+
+	if ((names = x509_constraints_names_new(16)) == NULL)
+		errx(1, "x509_constraints_names_new");
+	if ((name = calloc(1, sizeof(*name))) == NULL)
+		errx(1, "calloc");
+	switch (tn->type) {
+	case GEN_EMAIL:
+		CBS_init(&cbs, tn->name, strlen(tn->name));
+		if (!x509_constraints_parse_mailbox(&cbs, name))
+			errx(1, "x509_constraints_parse_mailbox %s", tn->name);
+		break;
+	case GEN_IPADD:
+		if ((ip = a2i_IPADDRESS(tn->name)) == NULL)
+			errx(1, "a2i_IPADDRESS");
+		name->af = ip->length == 4 ? AF_INET : AF_INET6;
+		memcpy(name->address, ip->data, ip->length);
+		name->type = GEN_IPADD;
+		ASN1_OCTET_STRING_free(ip);
+		break;
+	default:
+		if ((name->name = strdup(tn->name)) == NULL)
+			errx(1, "strdup");
+		name->type = tn->type;
+		break;
+	}
+	if (!x509_constraints_names_add(names, name))
+		errx(1, "x509_constraints_names_add");
+
+	return names;
+}
+
+/*
+ * Check that compiled constraints give the same results as checking the
+ * names against each constraint in turn.
+ */
+static int
+test_compiled_constraints(void)
+{
+	struct x509_constraints_names *permitted, *excluded, *names;
+	struct x509_constraints_compiled *cc;
+	size_t i, j, k;
+	int excl, want, got, want_error, got_error;
+	int failure = 0;
+
+	for (i = 0; i < N_COMPILED_CONSTRAINTS; i++) {
+		for (j = i; j < N_COMPILED_CONSTRAINTS; j++) {
+			for (excl = 0; excl < 2; excl++) {
+				if ((permitted = x509_constraints_names_new(
+				    16)) == NULL)
+					errx(1, "x509_constraints_names_new");
+				if ((excluded = x509_constraints_names_new(
+				    16)) == NULL)
+					errx(1, "x509_constraints_names_new");
+				if (!x509_constraints_names_add(excl ?
+				    excluded : permitted,
+				    compiled_test_constraint(
+				    &compiled_constraints[i])))
+					errx(1, "x509_constraints_names_add");
+				if (j != i && !x509_constraints_names_add(
+				    excl ? excluded : permitted,
+				    compiled_test_constraint(
+				    &compiled_constraints[j])))
+					errx(1, "x509_constraints_names_add");
+
+				for (k = 0; k < N_COMPILED_NAMES; k++) {
+					names = compiled_test_names(
+					    &compiled_names[k]);
+					want_error = got_error = 0;
+					want = x509_constraints_check(names,
+					    permitted, excluded, &want_error);
+					if ((cc = x509_constraints_compile(
+					    x509_constraints_names_dup(
+					    permitted),
+					    x509_constraints_names_dup(
+					    excluded))) == NULL)
+						errx(1, "x509_constraints_"
+						    "compile");
+					got = x509_constraints_check_compiled(
+					    names, cc, &got_error);
+					if (want != got ||
+					    want_error != got_error) {
+						FAIL("%s '%s' and '%s': name "
+						    "'%s' got %d (%d), want "
+						    "%d (%d)\n",
+						    excl ? "excluded" :
+						    "permitted",
+						    compiled_constraints[i].name,
+						    compiled_constraints[j].name,
+						    compiled_names[k].name,
+						    got, got_error, want,
+						    want_error);
+						failure = 1;
+					}
+					x509_constraints_compiled_free(cc);
+					x509_constraints_names_free(names);
+				}
+
+				x509_constraints_names_free(permitted);
+				x509_constraints_names_free(excluded);
+			}
+		}
+	}
+
+	return failure;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -579,6 +771,7 @@ main(int argc, char **argv)
 	failed |= test_invalid_uri();
 	failed |= test_valid_uri();
 	failed |= test_constraints1();
+	failed |= test_compiled_constraints();
 
 	return (failed);
 }
@@ -0,0 +1,737 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <openssl/asn1.h>
+#include <openssl/bio.h>
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/objects.h>
+#include <openssl/pem.h>
+#include <openssl/pkcs7.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#define N_REVOKED	5000
+#define N_THREADS	4
+
+static EVP_PKEY *
+generate_key(void)
+{
+	EVP_PKEY_CTX *pctx;
+	EVP_PKEY *pkey = NULL;
+
+	if ((pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL)) == NULL)
+		errx(1, "EVP_PKEY_CTX_new_id");
+	if (EVP_PKEY_keygen_init(pctx) <= 0)
+		errx(1, "EVP_PKEY_keygen_init");
+	if (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx,
+	    NID_X9_62_prime256v1) <= 0)
+		errx(1, "EVP_PKEY_CTX_set_ec_paramgen_curve_nid");
+	if (EVP_PKEY_keygen(pctx, &pkey) <= 0)
+		errx(1, "EVP_PKEY_keygen");
+	EVP_PKEY_CTX_free(pctx);
+
+	return pkey;
+}
+
+/* Serial numbers are multiples of three, with a few negative ones. */
+static long
+revoked_serial(int i)
+{
+	if (i % 1000 == 7)
+		return -3 * i;
+	return 3 * i;
+}
+
+static int
+revoked_reason(int i)
+{
+	if (i % 11 == 0)
+		return -1;
+	if (i == 42)
+		return CRL_REASON_REMOVE_FROM_CRL;
+	return i % 7;
+}
+
+static void
+create_crl(EVP_PKEY *pkey, unsigned char **out_der, int *out_der_len)
+{
+	X509_CRL *crl;
+	X509_NAME *name;
+	X509_REVOKED *rev;
+	ASN1_INTEGER *serial;
+	ASN1_ENUMERATED *reason;
+	ASN1_TIME *t;
+	int i;
+
+	if ((crl = X509_CRL_new()) == NULL)
+		errx(1, "X509_CRL_new");
+	if (!X509_CRL_set_version(crl, 1))
+		errx(1, "X509_CRL_set_version");
+	if ((name = X509_NAME_new()) == NULL)
+		errx(1, "X509_NAME_new");
+	if (!X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+	    (const unsigned char *)"CRL Index Test CA", -1, -1, 0))
+		errx(1, "X509_NAME_add_entry_by_txt");
+	if (!X509_CRL_set_issuer_name(crl, name))
+		errx(1, "X509_CRL_set_issuer_name");
+	X509_NAME_free(name);
+	if ((t = ASN1_TIME_set(NULL, 1700000000)) == NULL)
+		errx(1, "ASN1_TIME_set");
+	if (!X509_CRL_set1_lastUpdate(crl, t))
+		errx(1, "X509_CRL_set1_lastUpdate");
+	if (!X509_CRL_set1_nextUpdate(crl, t))
+		errx(1, "X509_CRL_set1_nextUpdate");
+
+	for (i = 0; i < N_REVOKED; i++) {
+		if ((rev = X509_REVOKED_new()) == NULL)
+			errx(1, "X509_REVOKED_new");
+		if ((serial = ASN1_INTEGER_new()) == NULL)
+			errx(1, "ASN1_INTEGER_new");
+		if (!ASN1_INTEGER_set(serial, revoked_serial(i)))
+			errx(1, "ASN1_INTEGER_set");
+		if (!X509_REVOKED_set_serialNumber(rev, serial))
+			errx(1, "X509_REVOKED_set_serialNumber");
+		ASN1_INTEGER_free(serial);
+		if (!X509_REVOKED_set_revocationDate(rev, t))
+			errx(1, "X509_REVOKED_set_revocationDate");
+		if (revoked_reason(i) != -1) {
+			if ((reason = ASN1_ENUMERATED_new()) == NULL)
+				errx(1, "ASN1_ENUMERATED_new");
+			if (!ASN1_ENUMERATED_set(reason, revoked_reason(i)))
+				errx(1, "ASN1_ENUMERATED_set");
+			if (!X509_REVOKED_add1_ext_i2d(rev, NID_crl_reason,
+			    reason, 0, 0))
+				errx(1, "X509_REVOKED_add1_ext_i2d");
+			ASN1_ENUMERATED_free(reason);
+		}
+		if (!X509_CRL_add0_revoked(crl, rev))
+			errx(1, "X509_CRL_add0_revoked");
+	}
+	ASN1_TIME_free(t);
+
+	if (!X509_CRL_sort(crl))
+		errx(1, "X509_CRL_sort");
+	if (!X509_CRL_sign(crl, pkey, EVP_sha256()))
+		errx(1, "X509_CRL_sign");
+
+	*out_der = NULL;
+	if ((*out_der_len = i2d_X509_CRL(crl, out_der)) <= 0)
+		errx(1, "i2d_X509_CRL");
+
+	X509_CRL_free(crl);
+}
+
+static int
+check_lookups(X509_CRL *full, X509_CRL *indexed)
+{
+	X509_REVOKED *full_rev, *indexed_rev;
+	ASN1_INTEGER *serial;
+	long s;
+	int full_ret, indexed_ret;
+	int failed = 0;
+
+	if ((serial = ASN1_INTEGER_new()) == NULL)
+		errx(1, "ASN1_INTEGER_new");
+
+	for (s = -3 * N_REVOKED; s < 3 * N_REVOKED + 3; s++) {
+		if (!ASN1_INTEGER_set(serial, s))
+			errx(1, "ASN1_INTEGER_set");
+
+		full_rev = indexed_rev = NULL;
+		full_ret = X509_CRL_get0_by_serial(full, &full_rev, serial);
+		indexed_ret = X509_CRL_get0_by_serial(indexed, &indexed_rev,
+		    serial);
+		if (full_ret != indexed_ret) {
+			fprintf(stderr, "FAIL: serial %ld: got %d, want %d\n",
+			    s, indexed_ret, full_ret);
+			failed = 1;
+			continue;
+		}
+		if (full_ret == 0)
+			continue;
+		if (ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(
+		    indexed_rev), serial) != 0) {
+			fprintf(stderr, "FAIL: serial %ld: wrong entry\n", s);
+			failed = 1;
+		}
+		if (ASN1_TIME_compare(X509_REVOKED_get0_revocationDate(
+		    full_rev), X509_REVOKED_get0_revocationDate(
+		    indexed_rev)) != 0) {
+			fprintf(stderr, "FAIL: serial %ld: wrong date\n", s);
+			failed = 1;
+		}
+		if (X509_REVOKED_get_ext_count(full_rev) !=
+		    X509_REVOKED_get_ext_count(indexed_rev)) {
+			fprintf(stderr, "FAIL: serial %ld: wrong extensions\n",
+			    s);
+			failed = 1;
+		}
+	}
+
+	/* The entry with reason removeFromCRL. */
+	if (!ASN1_INTEGER_set(serial, revoked_serial(42)))
+		errx(1, "ASN1_INTEGER_set");
+	if (X509_CRL_get0_by_serial(indexed, NULL, serial) != 2) {
+		fprintf(stderr, "FAIL: removeFromCRL entry not found\n");
+		failed = 1;
+	}
+
+	ASN1_INTEGER_free(serial);
+
+	return failed;
+}
+
+static int
+check_encoding(X509_CRL *full, X509_CRL *indexed, EVP_PKEY *pkey,
+    const unsigned char *der, int der_len)
+{
+	unsigned char full_md[EVP_MAX_MD_SIZE], indexed_md[EVP_MAX_MD_SIZE];
+	unsigned int full_md_len, indexed_md_len;
+	unsigned char *out = NULL;
+	X509_CRL *dup = NULL;
+	int out_len;
+	int failed = 1;
+
+	if (X509_CRL_verify(indexed, pkey) != 1) {
+		fprintf(stderr, "FAIL: X509_CRL_verify\n");
+		goto err;
+	}
+	if ((out_len = i2d_X509_CRL(indexed, &out)) != der_len ||
+	    memcmp(out, der, der_len) != 0) {
+		fprintf(stderr, "FAIL: i2d_X509_CRL differs\n");
+		goto err;
+	}
+
+	if (!X509_CRL_digest(full, EVP_sha256(), full_md, &full_md_len))
+		errx(1, "X509_CRL_digest");
+	if (!X509_CRL_digest(indexed, EVP_sha256(), indexed_md,
+	    &indexed_md_len))
+		errx(1, "X509_CRL_digest");
+	if (full_md_len != indexed_md_len ||
+	    memcmp(full_md, indexed_md, full_md_len) != 0) {
+		fprintf(stderr, "FAIL: X509_CRL_digest differs\n");
+		goto err;
+	}
+	if (X509_CRL_match(full, indexed) != 0) {
+		fprintf(stderr, "FAIL: X509_CRL_match\n");
+		goto err;
+	}
+	if (X509_NAME_cmp(X509_CRL_get_issuer(full),
+	    X509_CRL_get_issuer(indexed)) != 0) {
+		fprintf(stderr, "FAIL: issuer differs\n");
+		goto err;
+	}
+
+	if ((dup = X509_CRL_dup(indexed)) == NULL)
+		errx(1, "X509_CRL_dup");
+	if (X509_CRL_match(dup, indexed) != 0) {
+		fprintf(stderr, "FAIL: X509_CRL_dup\n");
+		goto err;
+	}
+	if (check_lookups(full, dup))
+		goto err;
+
+	failed = 0;
+
+ err:
+	X509_CRL_free(dup);
+	free(out);
+
+	return failed;
+}
+
+/*
+ * A change to a revoked entry must be caught by the signature check, even
+ * though the entry is not decoded.
+ */
+static int
+check_tampered(EVP_PKEY *pkey, const unsigned char *der, int der_len)
+{
+	/* The serial number 7500, changed to 7501 below. */
+	const unsigned char serial[] = { 0x02, 0x02, 0x1d, 0x4c };
+	unsigned char *tampered;
+	X509_CRL *crl;
+	size_t i;
+	int failed = 0;
+
+	if ((tampered = malloc(der_len)) == NULL)
+		err(1, NULL);
+	memcpy(tampered, der, der_len);
+	for (i = 0; i + sizeof(serial) <= (size_t)der_len; i++) {
+		if (memcmp(&tampered[i], serial, sizeof(serial)) == 0)
+			break;
+	}
+	if (i + sizeof(serial) > (size_t)der_len)
+		errx(1, "serial number not found");
+	tampered[i + 3] ^= 0x01;
+
+	if ((crl = X509_CRL_new_indexed(tampered, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+	if (X509_CRL_verify(crl, pkey) == 1) {
+		fprintf(stderr, "FAIL: tampered CRL verified\n");
+		failed = 1;
+	}
+	ERR_clear_error();
+
+	X509_CRL_free(crl);
+	free(tampered);
+
+	return failed;
+}
+
+/*
+ * i2d_X509_CRL_bio() and structures containing a CRL use the ASN.1 encoder
+ * rather than i2d_X509_CRL(). They must still write all revoked entries.
+ */
+static int
+check_bio(X509_CRL *full, EVP_PKEY *pkey, const unsigned char *der,
+    int der_len)
+{
+	STACK_OF(X509_CRL) *crls;
+	X509_CRL *crl = NULL, *decoded = NULL;
+	PKCS7 *p7 = NULL, *p7_decoded = NULL;
+	BIO *bio;
+	unsigned char *out = NULL;
+	const unsigned char *p;
+	char *data;
+	long data_len;
+	int out_len;
+	int failed = 1;
+
+	if ((bio = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	if ((crl = X509_CRL_new_indexed(der, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+
+	if (!i2d_X509_CRL_bio(bio, crl))
+		errx(1, "i2d_X509_CRL_bio");
+	data_len = BIO_get_mem_data(bio, &data);
+	if (data_len != der_len || memcmp(data, der, der_len) != 0) {
+		fprintf(stderr, "FAIL: i2d_X509_CRL_bio differs\n");
+		goto err;
+	}
+	if ((decoded = d2i_X509_CRL_bio(bio, NULL)) == NULL)
+		errx(1, "d2i_X509_CRL_bio");
+	if (X509_CRL_verify(decoded, pkey) != 1) {
+		fprintf(stderr, "FAIL: bio: X509_CRL_verify\n");
+		goto err;
+	}
+	if (sk_X509_REVOKED_num(X509_CRL_get_REVOKED(decoded)) != N_REVOKED) {
+		fprintf(stderr, "FAIL: bio: got %d entries, want %d\n",
+		    sk_X509_REVOKED_num(X509_CRL_get_REVOKED(decoded)),
+		    N_REVOKED);
+		goto err;
+	}
+	if (check_lookups(full, decoded))
+		goto err;
+	if (check_lookups(full, crl))
+		goto err;
+	X509_CRL_free(decoded);
+	decoded = NULL;
+
+	if ((p7 = PKCS7_new()) == NULL)
+		errx(1, "PKCS7_new");
+	if (!PKCS7_set_type(p7, NID_pkcs7_signed))
+		errx(1, "PKCS7_set_type");
+	if (!PKCS7_content_new(p7, NID_pkcs7_data))
+		errx(1, "PKCS7_content_new");
+	if (!PKCS7_add_crl(p7, crl))
+		errx(1, "PKCS7_add_crl");
+	if ((out_len = i2d_PKCS7(p7, &out)) <= 0)
+		errx(1, "i2d_PKCS7");
+	p = out;
+	if ((p7_decoded = d2i_PKCS7(NULL, &p, out_len)) == NULL)
+		errx(1, "d2i_PKCS7");
+	crls = p7_decoded->d.sign->crl;
+	if (sk_X509_CRL_num(crls) != 1) {
+		fprintf(stderr, "FAIL: PKCS7: got %d CRLs\n",
+		    sk_X509_CRL_num(crls));
+		goto err;
+	}
+	if (X509_CRL_verify(sk_X509_CRL_value(crls, 0), pkey) != 1) {
+		fprintf(stderr, "FAIL: PKCS7: X509_CRL_verify\n");
+		goto err;
+	}
+	if (check_lookups(full, sk_X509_CRL_value(crls, 0)))
+		goto err;
+
+	failed = 0;
+
+ err:
+	BIO_free(bio);
+	PKCS7_free(p7);
+	PKCS7_free(p7_decoded);
+	X509_CRL_free(crl);
+	X509_CRL_free(decoded);
+	free(out);
+
+	return failed;
+}
+
+/*
+ * Lookups from other threads race with decoding all entries of the CRL.
+ */
+
+struct lookup_thread {
+	pthread_t thread;
+	X509_CRL *full;
+	X509_CRL *crl;
+	int failed;
+};
+
+static void *
+lookup_thread(void *arg)
+{
+	struct lookup_thread *lt = arg;
+
+	lt->failed = check_lookups(lt->full, lt->crl);
+
+	ERR_remove_thread_state(NULL);
+
+	return NULL;
+}
+
+static int
+check_threads(X509_CRL *full, const unsigned char *der, int der_len)
+{
+	struct lookup_thread threads[N_THREADS];
+	X509_CRL *crl;
+	int i;
+	int failed = 0;
+
+	if ((crl = X509_CRL_new_indexed(der, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+
+	for (i = 0; i < N_THREADS; i++) {
+		threads[i].full = full;
+		threads[i].crl = crl;
+		threads[i].failed = 1;
+		if (pthread_create(&threads[i].thread, NULL, lookup_thread,
+		    &threads[i]) != 0)
+			errx(1, "pthread_create");
+	}
+	if (sk_X509_REVOKED_num(X509_CRL_get_REVOKED(crl)) != N_REVOKED) {
+		fprintf(stderr, "FAIL: threads: X509_CRL_get_REVOKED\n");
+		failed = 1;
+	}
+	for (i = 0; i < N_THREADS; i++) {
+		if (pthread_join(threads[i].thread, NULL) != 0)
+			errx(1, "pthread_join");
+		failed |= threads[i].failed;
+	}
+
+	X509_CRL_free(crl);
+
+	return failed;
+}
+
+/*
+ * Getting the revoked stack or modifying the CRL decodes all of its entries.
+ * Entries returned by earlier lookups must stay valid, and the entries must
+ * be part of the CRL when it is encoded and signed again.
+ */
+static int
+check_materialize(X509_CRL *full, EVP_PKEY *pkey, const unsigned char *der,
+    int der_len)
+{
+	STACK_OF(X509_REVOKED) *full_revoked, *revoked;
+	X509_REVOKED *rev, *looked_up = NULL;
+	ASN1_INTEGER *serial;
+	X509_CRL *crl = NULL, *decoded = NULL;
+	unsigned char *out = NULL;
+	const unsigned char *p;
+	int i, out_len;
+	int failed = 1;
+
+	if ((serial = ASN1_INTEGER_new()) == NULL)
+		errx(1, "ASN1_INTEGER_new");
+
+	if ((crl = X509_CRL_new_indexed(der, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+	if (!ASN1_INTEGER_set(serial, revoked_serial(100)))
+		errx(1, "ASN1_INTEGER_set");
+	if (X509_CRL_get0_by_serial(crl, &looked_up, serial) != 1) {
+		fprintf(stderr, "FAIL: materialize: lookup\n");
+		goto err;
+	}
+
+	full_revoked = X509_CRL_get_REVOKED(full);
+	if ((revoked = X509_CRL_get_REVOKED(crl)) == NULL) {
+		fprintf(stderr, "FAIL: materialize: X509_CRL_get_REVOKED\n");
+		goto err;
+	}
+	if (sk_X509_REVOKED_num(revoked) != N_REVOKED ||
+	    sk_X509_REVOKED_num(full_revoked) != N_REVOKED) {
+		fprintf(stderr, "FAIL: materialize: got %d entries, want %d\n",
+		    sk_X509_REVOKED_num(revoked), N_REVOKED);
+		goto err;
+	}
+	for (i = 0; i < N_REVOKED; i++) {
+		rev = sk_X509_REVOKED_value(revoked, i);
+		if (ASN1_INTEGER_cmp(X509_REVOKED_get0_serialNumber(rev),
+		    X509_REVOKED_get0_serialNumber(
+		    sk_X509_REVOKED_value(full_revoked, i))) != 0) {
+			fprintf(stderr, "FAIL: materialize: entry %d\n", i);
+			goto err;
+		}
+	}
+	if (sk_X509_REVOKED_find(revoked, looked_up) < 0 ||
+	    sk_X509_REVOKED_value(revoked,
+	    sk_X509_REVOKED_find(revoked, looked_up)) != looked_up) {
+		fprintf(stderr, "FAIL: materialize: looked up entry lost\n");
+		goto err;
+	}
+	if (check_lookups(full, crl))
+		goto err;
+
+	/* The original encoding is still used until the CRL is modified. */
+	if (X509_CRL_verify(crl, pkey) != 1) {
+		fprintf(stderr, "FAIL: materialize: X509_CRL_verify\n");
+		goto err;
+	}
+	if ((out_len = i2d_X509_CRL(crl, &out)) != der_len ||
+	    memcmp(out, der, der_len) != 0) {
+		fprintf(stderr, "FAIL: materialize: i2d_X509_CRL differs\n");
+		goto err;
+	}
+	free(out);
+	out = NULL;
+	X509_CRL_free(crl);
+
+	/* Add an entry to a fresh indexed CRL and sign it again. */
+	if ((crl = X509_CRL_new_indexed(der, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+	if ((rev = X509_REVOKED_new()) == NULL)
+		errx(1, "X509_REVOKED_new");
+	if (!ASN1_INTEGER_set(serial, 1))
+		errx(1, "ASN1_INTEGER_set");
+	if (!X509_REVOKED_set_serialNumber(rev, serial))
+		errx(1, "X509_REVOKED_set_serialNumber");
+	if (!X509_REVOKED_set_revocationDate(rev,
+	    (ASN1_TIME *)X509_CRL_get0_lastUpdate(crl)))
+		errx(1, "X509_REVOKED_set_revocationDate");
+	if (!X509_CRL_add0_revoked(crl, rev))
+		errx(1, "X509_CRL_add0_revoked");
+	if (!X509_CRL_sort(crl))
+		errx(1, "X509_CRL_sort");
+	if (!X509_CRL_sign(crl, pkey, EVP_sha256()))
+		errx(1, "X509_CRL_sign");
+	if ((out_len = i2d_X509_CRL(crl, &out)) <= 0)
+		errx(1, "i2d_X509_CRL");
+
+	p = out;
+	if ((decoded = d2i_X509_CRL(NULL, &p, out_len)) == NULL)
+		errx(1, "d2i_X509_CRL");
+	if (sk_X509_REVOKED_num(X509_CRL_get_REVOKED(decoded)) !=
+	    N_REVOKED + 1) {
+		fprintf(stderr, "FAIL: materialize: added entry, got %d "
+		    "entries, want %d\n",
+		    sk_X509_REVOKED_num(X509_CRL_get_REVOKED(decoded)),
+		    N_REVOKED + 1);
+		goto err;
+	}
+	if (X509_CRL_verify(decoded, pkey) != 1) {
+		fprintf(stderr, "FAIL: materialize: re-signed CRL\n");
+		goto err;
+	}
+	if (X509_CRL_get0_by_serial(decoded, NULL, serial) != 1) {
+		fprintf(stderr, "FAIL: materialize: added entry not found\n");
+		goto err;
+	}
+	X509_CRL_free(decoded);
+	decoded = NULL;
+	free(out);
+	out = NULL;
+	X509_CRL_free(crl);
+
+	/* Change another field and sign it again. */
+	if ((crl = X509_CRL_new_indexed(der, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+	if (!X509_CRL_set1_nextUpdate(crl, X509_CRL_get0_lastUpdate(crl)))
+		errx(1, "X509_CRL_set1_nextUpdate");
+	if (!X509_CRL_sign(crl, pkey, EVP_sha256()))
+		errx(1, "X509_CRL_sign");
+	if ((out_len = i2d_X509_CRL(crl, &out)) <= 0)
+		errx(1, "i2d_X509_CRL");
+	p = out;
+	if ((decoded = d2i_X509_CRL(NULL, &p, out_len)) == NULL)
+		errx(1, "d2i_X509_CRL");
+	if (check_lookups(full, decoded))
+		goto err;
+
+	failed = 0;
+
+ err:
+	ASN1_INTEGER_free(serial);
+	X509_CRL_free(crl);
+	X509_CRL_free(decoded);
+	free(out);
+
+	return failed;
+}
+
+static void
+write_crl_file(char *filename, X509_CRL *full, const unsigned char *der,
+    int der_len, int pem)
+{
+	FILE *fp;
+	int fd;
+
+	if ((fd = mkstemp(filename)) == -1)
+		err(1, "mkstemp");
+	if ((fp = fdopen(fd, "w")) == NULL)
+		err(1, "fdopen");
+	if (pem) {
+		fprintf(fp, "Some text before the CRL\n");
+		if (!PEM_write_X509_CRL(fp, full))
+			errx(1, "PEM_write_X509_CRL");
+	} else if (fwrite(der, 1, der_len, fp) != (size_t)der_len)
+		err(1, "fwrite");
+	if (fclose(fp) != 0)
+		err(1, "fclose");
+}
+
+static int
+check_load(X509_CRL *full, const unsigned char *der, int der_len, int pem)
+{
+	char filename[] = "/tmp/crl_index.XXXXXXXXXX";
+	X509_CRL *crl = NULL;
+	int failed = 1;
+
+	write_crl_file(filename, full, der, der_len, pem);
+
+	if ((crl = X509_CRL_load_indexed(filename)) == NULL) {
+		fprintf(stderr, "FAIL: X509_CRL_load_indexed (%s)\n",
+		    pem ? "PEM" : "DER");
+		goto err;
+	}
+	if (check_lookups(full, crl))
+		goto err;
+	if (X509_CRL_match(full, crl) != 0) {
+		fprintf(stderr, "FAIL: X509_CRL_match (%s)\n",
+		    pem ? "PEM" : "DER");
+		goto err;
+	}
+
+	failed = 0;
+
+ err:
+	X509_CRL_free(crl);
+	unlink(filename);
+
+	return failed;
+}
+
+/*
+ * CRLs loaded into a store from a file are indexed.
+ */
+static int
+check_store(X509_CRL *full, const unsigned char *der, int der_len, int pem)
+{
+	char filename[] = "/tmp/crl_index.XXXXXXXXXX";
+	STACK_OF(X509_OBJECT) *objs = NULL;
+	X509_STORE *store;
+	X509_LOOKUP *lookup;
+	X509_CRL *crl;
+	int failed = 1;
+
+	write_crl_file(filename, full, der, der_len, pem);
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	if ((lookup = X509_STORE_add_lookup(store, X509_LOOKUP_file())) == NULL)
+		errx(1, "X509_STORE_add_lookup");
+	if (X509_load_crl_file(lookup, filename,
+	    pem ? X509_FILETYPE_PEM : X509_FILETYPE_ASN1) != 1) {
+		fprintf(stderr, "FAIL: X509_load_crl_file (%s)\n",
+		    pem ? "PEM" : "DER");
+		goto err;
+	}
+
+	if ((objs = X509_STORE_get1_objects(store)) == NULL)
+		errx(1, "X509_STORE_get1_objects");
+	if (sk_X509_OBJECT_num(objs) != 1 ||
+	    (crl = X509_OBJECT_get0_X509_CRL(sk_X509_OBJECT_value(objs,
+	    0))) == NULL) {
+		fprintf(stderr, "FAIL: no CRL in store (%s)\n",
+		    pem ? "PEM" : "DER");
+		goto err;
+	}
+	if (check_lookups(full, crl))
+		goto err;
+	if (X509_CRL_match(full, crl) != 0) {
+		fprintf(stderr, "FAIL: X509_CRL_match in store (%s)\n",
+		    pem ? "PEM" : "DER");
+		goto err;
+	}
+
+	failed = 0;
+
+ err:
+	sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+	X509_STORE_free(store);
+	unlink(filename);
+
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	EVP_PKEY *pkey;
+	X509_CRL *full, *indexed;
+	unsigned char *der;
+	const unsigned char *p;
+	int der_len;
+	int failed = 0;
+
+	pkey = generate_key();
+	create_crl(pkey, &der, &der_len);
+
+	p = der;
+	if ((full = d2i_X509_CRL(NULL, &p, der_len)) == NULL)
+		errx(1, "d2i_X509_CRL");
+	if ((indexed = X509_CRL_new_indexed(der, der_len)) == NULL)
+		errx(1, "X509_CRL_new_indexed");
+
+	failed |= check_lookups(full, indexed);
+	failed |= check_encoding(full, indexed, pkey, der, der_len);
+	failed |= check_tampered(pkey, der, der_len);
+	failed |= check_bio(full, pkey, der, der_len);
+	failed |= check_load(full, der, der_len, 0);
+	failed |= check_load(full, der, der_len, 1);
+	failed |= check_store(full, der, der_len, 0);
+	failed |= check_store(full, der, der_len, 1);
+	failed |= check_materialize(full, pkey, der, der_len);
+	failed |= check_threads(full, der, der_len);
+
+	X509_CRL_free(full);
+	X509_CRL_free(indexed);
+	EVP_PKEY_free(pkey);
+	free(der);
+
+	return failed;
+}
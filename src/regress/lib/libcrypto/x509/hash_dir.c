@@ -0,0 +1,278 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <err.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+static char dir[] = "/tmp/hash_dir.XXXXXXXXXX";
+static char target_dir[] = "/tmp/hash_dir_target.XXXXXXXXXX";
+static time_t dir_mtime;
+
+static STACK_OF(X509) *
+certs_from_file(const char *filename)
+{
+	STACK_OF(X509) *xs;
+	BIO *bio;
+	X509 *x;
+
+	if ((xs = sk_X509_new_null()) == NULL)
+		errx(1, "sk_X509_new_null");
+	if ((bio = BIO_new_file(filename, "r")) == NULL) {
+		ERR_print_errors_fp(stderr);
+		errx(1, "failed to create bio");
+	}
+	while ((x = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+		if (!sk_X509_push(xs, x))
+			errx(1, "failed to push X509");
+	}
+	ERR_clear_error();
+	BIO_free(bio);
+
+	return xs;
+}
+
+/*
+ * Write a file into the directory and make sure that its modification time
+ * changes, regardless of the resolution of the file system timestamps.
+ */
+static void
+write_path(const char *path, X509 *x)
+{
+	FILE *fp;
+
+	if ((fp = fopen(path, "w")) == NULL)
+		err(1, "fopen %s", path);
+	if (x != NULL) {
+		if (!PEM_write_X509(fp, x))
+			errx(1, "PEM_write_X509");
+	} else
+		fprintf(fp, "garbage\n");
+	if (fclose(fp) != 0)
+		err(1, "fclose");
+}
+
+static void
+set_mtime(const char *path, time_t mtime)
+{
+	struct timeval tv[2];
+
+	memset(tv, 0, sizeof(tv));
+	tv[0].tv_sec = tv[1].tv_sec = mtime;
+	if (utimes(path, tv) == -1)
+		err(1, "utimes %s", path);
+}
+
+static void
+write_file(const char *name, X509 *x)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	write_path(path, x);
+
+	dir_mtime += 10;
+	set_mtime(dir, dir_mtime);
+}
+
+/*
+ * Rewrite a file in place, which changes its own modification time but
+ * not that of the directory.
+ */
+static void
+rewrite_file(const char *name, X509 *x)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	write_path(path, x);
+	set_mtime(path, dir_mtime + 5);
+	set_mtime(dir, dir_mtime);
+}
+
+static void
+remove_file(const char *name)
+{
+	char path[PATH_MAX];
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	unlink(path);
+}
+
+static int
+lookup(X509_STORE *store, X509 *x, int want)
+{
+	X509_STORE_CTX *ctx;
+	X509_OBJECT *obj;
+	int failed = 0;
+
+	if ((ctx = X509_STORE_CTX_new()) == NULL)
+		errx(1, "X509_STORE_CTX_new");
+	if (!X509_STORE_CTX_init(ctx, store, NULL, NULL))
+		errx(1, "X509_STORE_CTX_init");
+
+	obj = X509_STORE_CTX_get_obj_by_subject(ctx, X509_LU_X509,
+	    X509_get_subject_name(x));
+	if ((obj != NULL) != want) {
+		fprintf(stderr, "FAIL: lookup %s, want %s\n",
+		    obj != NULL ? "found" : "not found",
+		    want ? "found" : "not found");
+		failed = 1;
+	} else if (obj != NULL &&
+	    X509_cmp(X509_OBJECT_get0_X509(obj), x) != 0) {
+		fprintf(stderr, "FAIL: lookup found the wrong certificate\n");
+		failed = 1;
+	}
+
+	X509_OBJECT_free(obj);
+	X509_STORE_CTX_free(ctx);
+
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	STACK_OF(X509) *xs, *xs2, *xs3;
+	X509_STORE *store;
+	X509_LOOKUP *lu;
+	X509 *x0, *x1, *x2, *x3;
+	char path[PATH_MAX], target[PATH_MAX], name[32];
+	int failed = 0;
+
+	if (argc != 2)
+		errx(1, "usage: %s <certs_path>", argv[0]);
+
+	snprintf(path, sizeof(path), "%s/2a/bundle.pem", argv[1]);
+	xs = certs_from_file(path);
+	if (sk_X509_num(xs) < 2)
+		errx(1, "not enough certificates in %s", path);
+	x0 = sk_X509_value(xs, 0);
+	x1 = sk_X509_value(xs, 1);
+
+	snprintf(path, sizeof(path), "%s/2a/roots.pem", argv[1]);
+	xs2 = certs_from_file(path);
+	if (sk_X509_num(xs2) < 1)
+		errx(1, "not enough certificates in %s", path);
+	x2 = sk_X509_value(xs2, 0);
+
+	snprintf(path, sizeof(path), "%s/4a/roots.pem", argv[1]);
+	xs3 = certs_from_file(path);
+	if (sk_X509_num(xs3) < 2)
+		errx(1, "not enough certificates in %s", path);
+	x3 = sk_X509_value(xs3, 1);
+
+	if (mkdtemp(dir) == NULL)
+		err(1, "mkdtemp");
+	if (mkdtemp(target_dir) == NULL)
+		err(1, "mkdtemp");
+	dir_mtime = time(NULL);
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	if ((lu = X509_STORE_add_lookup(store, X509_LOOKUP_hash_dir())) == NULL)
+		errx(1, "X509_STORE_add_lookup");
+	if (!X509_LOOKUP_add_dir(lu, dir, X509_FILETYPE_PEM))
+		errx(1, "X509_LOOKUP_add_dir");
+
+	/* Nothing in the directory yet. */
+	failed |= lookup(store, x0, 0);
+	failed |= lookup(store, x1, 0);
+
+	/* A new file is found once the directory has changed. */
+	snprintf(name, sizeof(name), "%08lx.0",
+	    X509_NAME_hash(X509_get_subject_name(x0)));
+	write_file(name, x0);
+	failed |= lookup(store, x0, 1);
+	failed |= lookup(store, x1, 0);
+
+	/* Loaded certificates stay in the store. */
+	remove_file(name);
+	failed |= lookup(store, x0, 1);
+
+	/* A file with garbage in it is skipped, as is a gap in suffixes. */
+	snprintf(name, sizeof(name), "%08lx.0",
+	    X509_NAME_hash(X509_get_subject_name(x1)));
+	write_file(name, NULL);
+	snprintf(name, sizeof(name), "%08lx.2",
+	    X509_NAME_hash(X509_get_subject_name(x1)));
+	write_file(name, x1);
+	failed |= lookup(store, x1, 0);
+	snprintf(name, sizeof(name), "%08lx.1",
+	    X509_NAME_hash(X509_get_subject_name(x1)));
+	write_file(name, x1);
+	failed |= lookup(store, x1, 1);
+
+	/*
+	 * A file that could not be loaded is loaded again once it has been
+	 * rewritten, even though the directory itself has not changed.
+	 */
+	snprintf(name, sizeof(name), "%08lx.0",
+	    X509_NAME_hash(X509_get_subject_name(x2)));
+	write_file(name, NULL);
+	failed |= lookup(store, x2, 0);
+	rewrite_file(name, x2);
+	failed |= lookup(store, x2, 1);
+	remove_file(name);
+
+	/* The same goes for a symbolic link whose target is replaced. */
+	snprintf(target, sizeof(target), "%s/cert.pem", target_dir);
+	write_path(target, NULL);
+	snprintf(name, sizeof(name), "%08lx.0",
+	    X509_NAME_hash(X509_get_subject_name(x3)));
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if (symlink(target, path) == -1)
+		err(1, "symlink %s", path);
+	failed |= lookup(store, x3, 0);
+	snprintf(path, sizeof(path), "%s/new.pem", target_dir);
+	write_path(path, x3);
+	if (rename(path, target) == -1)
+		err(1, "rename %s", path);
+	failed |= lookup(store, x3, 1);
+	remove_file(name);
+	unlink(target);
+	rmdir(target_dir);
+
+	snprintf(name, sizeof(name), "%08lx.0",
+	    X509_NAME_hash(X509_get_subject_name(x1)));
+	remove_file(name);
+	snprintf(name, sizeof(name), "%08lx.1",
+	    X509_NAME_hash(X509_get_subject_name(x1)));
+	remove_file(name);
+	snprintf(name, sizeof(name), "%08lx.2",
+	    X509_NAME_hash(X509_get_subject_name(x1)));
+	remove_file(name);
+	rmdir(dir);
+
+	X509_STORE_free(store);
+	sk_X509_pop_free(xs, X509_free);
+	sk_X509_pop_free(xs2, X509_free);
+	sk_X509_pop_free(xs3, X509_free);
+
+	return failed;
+}
@@ -0,0 +1,330 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/evp.h>
+
+#include "x509_issuer_cache.h"
+
+static void
+issuer_cache_md(unsigned char *md, unsigned char id)
+{
+	memset(md, 0, EVP_MAX_MD_SIZE);
+	md[0] = id;
+	md[EVP_MAX_MD_SIZE - 1] = id;
+}
+
+/* Mirrors x509_issuer_tag() so that a test can fill a single shard. */
+static uint64_t
+issuer_cache_tag(const unsigned char *parent_md, const unsigned char *child_md)
+{
+	uint64_t parent_tag, child_tag, tag;
+
+	memcpy(&parent_tag, parent_md, sizeof(parent_tag));
+	memcpy(&child_tag, child_md, sizeof(child_tag));
+
+	tag = parent_tag * 0x9e3779b97f4a7c15ULL + child_tag;
+	tag ^= tag >> 30;
+	tag *= 0xbf58476d1ce4e5b9ULL;
+	tag ^= tag >> 27;
+	tag *= 0x94d049bb133111ebULL;
+	tag ^= tag >> 31;
+
+	return tag;
+}
+
+/* Make a child hash for id that lands in shard 0 together with parent. */
+static void
+issuer_cache_md_shard0(const unsigned char *parent, unsigned char *md,
+    unsigned char id)
+{
+	uint32_t n;
+
+	issuer_cache_md(md, id);
+	for (n = 0; n < UINT32_MAX; n++) {
+		memcpy(&md[1], &n, sizeof(n));
+		if ((issuer_cache_tag(parent, md) &
+		    (X509_ISSUER_CACHE_SHARDS - 1)) == 0)
+			return;
+	}
+
+	errx(1, "no hash in shard 0 for %d", id);
+}
+
+static int
+issuer_cache_find_test(void)
+{
+	struct x509_issuer_cache_stats before, after;
+	unsigned char parent[EVP_MAX_MD_SIZE], child[EVP_MAX_MD_SIZE];
+	unsigned char other[EVP_MAX_MD_SIZE];
+	int failed = 1;
+
+	if (!x509_issuer_cache_set_max(X509_ISSUER_CACHE_MAX))
+		errx(1, "x509_issuer_cache_set_max");
+
+	issuer_cache_md(parent, 1);
+	issuer_cache_md(child, 2);
+	issuer_cache_md(other, 3);
+
+	x509_issuer_cache_stats(&before);
+
+	if (x509_issuer_cache_find(parent, child) != -1) {
+		fprintf(stderr, "FAIL: %s: found entry in empty cache\n",
+		    __func__);
+		goto failure;
+	}
+
+	x509_issuer_cache_add(parent, child, 1);
+	x509_issuer_cache_add(child, parent, 0);
+
+	if (x509_issuer_cache_find(parent, child) != 1) {
+		fprintf(stderr, "FAIL: %s: want valid entry\n", __func__);
+		goto failure;
+	}
+	if (x509_issuer_cache_find(child, parent) != 0) {
+		fprintf(stderr, "FAIL: %s: want invalid entry\n", __func__);
+		goto failure;
+	}
+
+	/* Self-signed certificates have the same parent and child hash. */
+	x509_issuer_cache_add(parent, parent, 1);
+	if (x509_issuer_cache_find(parent, parent) != 1) {
+		fprintf(stderr, "FAIL: %s: want self-signed entry\n", __func__);
+		goto failure;
+	}
+
+	/* Existing entries are not replaced. */
+	x509_issuer_cache_add(parent, child, 0);
+	if (x509_issuer_cache_find(parent, child) != 1) {
+		fprintf(stderr, "FAIL: %s: entry was replaced\n", __func__);
+		goto failure;
+	}
+
+	/* Same truncated digest, different full digest. */
+	other[0] = child[0];
+	if (x509_issuer_cache_find(parent, other) != -1) {
+		fprintf(stderr, "FAIL: %s: matched on truncated digest\n",
+		    __func__);
+		goto failure;
+	}
+
+	/* Invalid results are not cached. */
+	x509_issuer_cache_add(parent, other, 2);
+	if (x509_issuer_cache_find(parent, other) != -1) {
+		fprintf(stderr, "FAIL: %s: cached bogus result\n", __func__);
+		goto failure;
+	}
+
+	x509_issuer_cache_stats(&after);
+
+	if (after.entries != before.entries + 3) {
+		fprintf(stderr, "FAIL: %s: got %zu entries, want %zu\n",
+		    __func__, after.entries, before.entries + 3);
+		goto failure;
+	}
+	if (after.hits - before.hits != 4) {
+		fprintf(stderr, "FAIL: %s: got %llu hits, want 4\n", __func__,
+		    (unsigned long long)(after.hits - before.hits));
+		goto failure;
+	}
+	if (after.misses - before.misses != 3) {
+		fprintf(stderr, "FAIL: %s: got %llu misses, want 3\n", __func__,
+		    (unsigned long long)(after.misses - before.misses));
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static int
+issuer_cache_clock_test(void)
+{
+	struct x509_issuer_cache_stats before, stats;
+	unsigned char parent[EVP_MAX_MD_SIZE], child[EVP_MAX_MD_SIZE];
+	unsigned char id;
+	int want;
+	int failed = 1;
+
+	/* Start empty, with four entries per shard. */
+	if (!x509_issuer_cache_set_max(0))
+		errx(1, "x509_issuer_cache_set_max");
+	if (!x509_issuer_cache_set_max(4 * X509_ISSUER_CACHE_SHARDS))
+		errx(1, "x509_issuer_cache_set_max");
+	x509_issuer_cache_stats(&before);
+
+	issuer_cache_md(parent, 0);
+	for (id = 1; id <= 4; id++) {
+		issuer_cache_md_shard0(parent, child, id);
+		x509_issuer_cache_add(parent, child, 1);
+	}
+
+	/* Give the first entry a second chance. */
+	issuer_cache_md_shard0(parent, child, 1);
+	if (x509_issuer_cache_find(parent, child) != 1) {
+		fprintf(stderr, "FAIL: %s: entry 1 missing\n", __func__);
+		goto failure;
+	}
+
+	issuer_cache_md_shard0(parent, child, 5);
+	x509_issuer_cache_add(parent, child, 1);
+
+	x509_issuer_cache_stats(&stats);
+	if (stats.entries != 4 || stats.evictions - before.evictions != 1) {
+		fprintf(stderr, "FAIL: %s: got %zu entries and %llu "
+		    "evictions, want 4 and 1\n", __func__, stats.entries,
+		    (unsigned long long)(stats.evictions - before.evictions));
+		goto failure;
+	}
+
+	for (id = 1; id <= 5; id++) {
+		issuer_cache_md_shard0(parent, child, id);
+		want = id == 2 ? -1 : 1;
+		if (x509_issuer_cache_find(parent, child) != want) {
+			fprintf(stderr, "FAIL: %s: entry %d %s\n", __func__,
+			    id, id == 2 ? "not evicted" : "missing");
+			goto failure;
+		}
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static int
+issuer_cache_resize_test(void)
+{
+	struct x509_issuer_cache_stats stats;
+	unsigned char parent[EVP_MAX_MD_SIZE], child[EVP_MAX_MD_SIZE];
+	unsigned char id;
+	int want;
+	int failed = 1;
+
+	if (!x509_issuer_cache_set_max(0))
+		errx(1, "x509_issuer_cache_set_max");
+	if (!x509_issuer_cache_set_max(4 * X509_ISSUER_CACHE_SHARDS))
+		errx(1, "x509_issuer_cache_set_max");
+
+	issuer_cache_md(parent, 0);
+	for (id = 1; id <= 4; id++) {
+		issuer_cache_md_shard0(parent, child, id);
+		x509_issuer_cache_add(parent, child, 1);
+	}
+
+	/* Referenced entries survive shrinking, the others are evicted. */
+	for (id = 2; id <= 4; id += 2) {
+		issuer_cache_md_shard0(parent, child, id);
+		if (x509_issuer_cache_find(parent, child) != 1) {
+			fprintf(stderr, "FAIL: %s: entry %d missing\n",
+			    __func__, id);
+			goto failure;
+		}
+	}
+
+	if (!x509_issuer_cache_set_max(2 * X509_ISSUER_CACHE_SHARDS))
+		errx(1, "x509_issuer_cache_set_max");
+
+	x509_issuer_cache_stats(&stats);
+	if (stats.entries != 2) {
+		fprintf(stderr, "FAIL: %s: got %zu entries after shrinking\n",
+		    __func__, stats.entries);
+		goto failure;
+	}
+
+	/* Growing keeps everything. */
+	if (!x509_issuer_cache_set_max(8 * X509_ISSUER_CACHE_SHARDS))
+		errx(1, "x509_issuer_cache_set_max");
+
+	for (id = 1; id <= 4; id++) {
+		issuer_cache_md_shard0(parent, child, id);
+		want = id % 2 == 0 ? 1 : -1;
+		if (x509_issuer_cache_find(parent, child) != want) {
+			fprintf(stderr, "FAIL: %s: entry %d %s\n", __func__,
+			    id, want == 1 ? "missing" : "not evicted");
+			goto failure;
+		}
+	}
+
+	x509_issuer_cache_stats(&stats);
+	if (stats.entries != 2) {
+		fprintf(stderr, "FAIL: %s: got %zu entries after growing\n",
+		    __func__, stats.entries);
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static int
+issuer_cache_disable_test(void)
+{
+	struct x509_issuer_cache_stats stats;
+	unsigned char parent[EVP_MAX_MD_SIZE], child[EVP_MAX_MD_SIZE];
+	int failed = 1;
+
+	issuer_cache_md(parent, 1);
+	issuer_cache_md(child, 2);
+
+	if (!x509_issuer_cache_set_max(0))
+		errx(1, "x509_issuer_cache_set_max");
+
+	x509_issuer_cache_add(parent, child, 1);
+	if (x509_issuer_cache_find(parent, child) != -1) {
+		fprintf(stderr, "FAIL: %s: disabled cache found entry\n",
+		    __func__);
+		goto failure;
+	}
+
+	x509_issuer_cache_stats(&stats);
+	if (stats.entries != 0) {
+		fprintf(stderr, "FAIL: %s: disabled cache has %zu entries\n",
+		    __func__, stats.entries);
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+int
+main(void)
+{
+	int failed = 0;
+
+	failed |= issuer_cache_find_test();
+	failed |= issuer_cache_clock_test();
+	failed |= issuer_cache_resize_test();
+	failed |= issuer_cache_disable_test();
+
+	x509_issuer_cache_free();
+
+	return failed;
+}
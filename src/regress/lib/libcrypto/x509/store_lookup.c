@@ -0,0 +1,353 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+#include "x509_local.h"
+
+static const char *test_ids[] = {
+	"1a", "2a", "2b", "2c", "3a", "3b", "3c", "3d", "3e", "4a", "4b",
+	"4c", "4d", "4e", "4f", "4g", "4h", "5a", "5b", "5c", "5d", "5e",
+	"5f", "5g", "5h", "5i", "6a", "6b", "7a", "7b", "8a", "9a", "10a",
+	"10b", "11a", "11b", "12a", "13a",
+};
+
+#define N_TEST_IDS (sizeof(test_ids) / sizeof(test_ids[0]))
+
+static void
+certs_from_file(STACK_OF(X509) *xs, const char *filename)
+{
+	STACK_OF(X509_INFO) *xis = NULL;
+	BIO *bio;
+	X509 *x;
+	int i;
+
+	if ((bio = BIO_new_file(filename, "r")) == NULL) {
+		ERR_print_errors_fp(stderr);
+		errx(1, "failed to create bio");
+	}
+	if ((xis = PEM_X509_INFO_read_bio(bio, NULL, NULL, NULL)) == NULL)
+		errx(1, "failed to read PEM");
+
+	for (i = 0; i < sk_X509_INFO_num(xis); i++) {
+		if ((x = sk_X509_INFO_value(xis, i)->x509) == NULL)
+			continue;
+		if (!X509_up_ref(x))
+			errx(1, "failed to up ref X509");
+		if (!sk_X509_push(xs, x))
+			errx(1, "failed to push X509");
+	}
+
+	sk_X509_INFO_pop_free(xis, X509_INFO_free);
+	BIO_free(bio);
+}
+
+/* Return the number of distinct certificates in xs[0..n) with subject. */
+static int
+count_by_subject(STACK_OF(X509) *xs, int n, X509_NAME *subject, X509 **first)
+{
+	X509 *x, *y;
+	int i, j;
+	int count = 0;
+
+	*first = NULL;
+
+	for (i = 0; i < n; i++) {
+		x = sk_X509_value(xs, i);
+		if (X509_NAME_cmp(X509_get_subject_name(x), subject) != 0)
+			continue;
+		for (j = 0; j < i; j++) {
+			y = sk_X509_value(xs, j);
+			if (X509_cmp(x, y) == 0)
+				break;
+		}
+		if (j < i)
+			continue;
+		if (*first == NULL)
+			*first = x;
+		count++;
+	}
+
+	return count;
+}
+
+static int
+store_lookup_test(const char *certs_path)
+{
+	STACK_OF(X509_OBJECT) *objs = NULL;
+	STACK_OF(X509) *all = NULL, *found = NULL;
+	X509_STORE_CTX *xsc = NULL;
+	X509_STORE *store = NULL;
+	X509_NAME *subject;
+	X509 *x, *first;
+	char *filename;
+	size_t i;
+	int distinct, j, k, want;
+	int failed = 1;
+
+	if ((all = sk_X509_new_null()) == NULL)
+		errx(1, "sk_X509_new_null");
+	for (i = 0; i < N_TEST_IDS; i++) {
+		if (asprintf(&filename, "%s/%s/roots.pem", certs_path,
+		    test_ids[i]) == -1)
+			errx(1, "asprintf");
+		certs_from_file(all, filename);
+		free(filename);
+		if (asprintf(&filename, "%s/%s/bundle.pem", certs_path,
+		    test_ids[i]) == -1)
+			errx(1, "asprintf");
+		certs_from_file(all, filename);
+		free(filename);
+	}
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+
+	/* Adding a certificate that is already present must succeed. */
+	for (k = 0; k < 2; k++) {
+		for (j = 0; j < sk_X509_num(all); j++) {
+			if (!X509_STORE_add_cert(store, sk_X509_value(all, j))) {
+				fprintf(stderr, "FAIL: X509_STORE_add_cert\n");
+				goto failure;
+			}
+		}
+	}
+
+	distinct = 0;
+	for (j = 0; j < sk_X509_num(all); j++) {
+		x = sk_X509_value(all, j);
+		for (k = 0; k < j; k++) {
+			if (X509_cmp(x, sk_X509_value(all, k)) == 0)
+				break;
+		}
+		if (k == j)
+			distinct++;
+	}
+	/* Use a copy, so that the store keeps its index. */
+	if ((objs = X509_STORE_get1_objects(store)) == NULL)
+		errx(1, "X509_STORE_get1_objects");
+	if (sk_X509_OBJECT_num(objs) != distinct) {
+		fprintf(stderr, "FAIL: store has %d objects, want %d\n",
+		    sk_X509_OBJECT_num(objs), distinct);
+		goto failure;
+	}
+
+	if ((xsc = X509_STORE_CTX_new()) == NULL)
+		errx(1, "X509_STORE_CTX_new");
+	if (!X509_STORE_CTX_init(xsc, store, NULL, NULL))
+		errx(1, "X509_STORE_CTX_init");
+
+	for (j = 0; j < sk_X509_num(all); j++) {
+		subject = X509_get_subject_name(sk_X509_value(all, j));
+		want = count_by_subject(all, sk_X509_num(all), subject, &first);
+
+		if ((found = X509_STORE_CTX_get1_certs(xsc, subject)) == NULL) {
+			fprintf(stderr, "FAIL: cert %d not found\n", j);
+			goto failure;
+		}
+		if (sk_X509_num(found) != want) {
+			fprintf(stderr, "FAIL: cert %d: got %d matches, "
+			    "want %d\n", j, sk_X509_num(found), want);
+			goto failure;
+		}
+		/* Certificates with the same subject keep insertion order. */
+		if (X509_cmp(sk_X509_value(found, 0), first) != 0) {
+			fprintf(stderr, "FAIL: cert %d: wrong first match\n", j);
+			goto failure;
+		}
+		for (k = 0; k < sk_X509_num(found); k++) {
+			x = sk_X509_value(found, k);
+			if (X509_NAME_cmp(X509_get_subject_name(x),
+			    subject) != 0) {
+				fprintf(stderr, "FAIL: cert %d: subject "
+				    "mismatch\n", j);
+				goto failure;
+			}
+		}
+		sk_X509_pop_free(found, X509_free);
+		found = NULL;
+	}
+
+	failed = 0;
+
+ failure:
+	sk_X509_OBJECT_pop_free(objs, X509_OBJECT_free);
+	sk_X509_pop_free(found, X509_free);
+	sk_X509_pop_free(all, X509_free);
+	X509_STORE_CTX_free(xsc);
+	X509_STORE_free(store);
+
+	return failed;
+}
+
+/* Return 1 if x is among the store's certificates with its subject. */
+static int
+store_has_cert(X509_STORE_CTX *xsc, X509 *x)
+{
+	STACK_OF(X509) *found;
+	int i, ret = 0;
+
+	if ((found = X509_STORE_CTX_get1_certs(xsc,
+	    X509_get_subject_name(x))) == NULL)
+		return 0;
+	for (i = 0; i < sk_X509_num(found); i++) {
+		if (X509_cmp(sk_X509_value(found, i), x) == 0)
+			ret = 1;
+	}
+	sk_X509_pop_free(found, X509_free);
+
+	return ret;
+}
+
+/*
+ * Changes made through the stack returned by X509_STORE_get0_objects()
+ * must be seen by later lookups, and must not leave anything behind that
+ * refers to removed objects.
+ */
+static int
+store_get0_objects_test(const char *certs_path)
+{
+	STACK_OF(X509_OBJECT) *objs;
+	STACK_OF(X509) *roots = NULL, *others = NULL;
+	X509_STORE_CTX *xsc = NULL;
+	X509_STORE *store = NULL;
+	X509_OBJECT *obj;
+	X509 *removed, *pushed, *issuer = NULL;
+	char *filename;
+	int i;
+	int failed = 1;
+
+	if ((roots = sk_X509_new_null()) == NULL)
+		errx(1, "sk_X509_new_null");
+	if ((others = sk_X509_new_null()) == NULL)
+		errx(1, "sk_X509_new_null");
+	if (asprintf(&filename, "%s/1a/roots.pem", certs_path) == -1)
+		errx(1, "asprintf");
+	certs_from_file(roots, filename);
+	free(filename);
+	if (asprintf(&filename, "%s/2a/roots.pem", certs_path) == -1)
+		errx(1, "asprintf");
+	certs_from_file(others, filename);
+	free(filename);
+	if (sk_X509_num(roots) < 1 || sk_X509_num(others) < 1)
+		errx(1, "not enough certificates");
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	for (i = 0; i < sk_X509_num(roots); i++) {
+		if (!X509_STORE_add_cert(store, sk_X509_value(roots, i)))
+			errx(1, "X509_STORE_add_cert");
+	}
+
+	if ((xsc = X509_STORE_CTX_new()) == NULL)
+		errx(1, "X509_STORE_CTX_new");
+	if (!X509_STORE_CTX_init(xsc, store, NULL, NULL))
+		errx(1, "X509_STORE_CTX_init");
+
+	removed = sk_X509_value(roots, 0);
+	pushed = sk_X509_value(others, 0);
+	if (!store_has_cert(xsc, removed)) {
+		fprintf(stderr, "FAIL: %s: certificate not found\n", __func__);
+		goto failure;
+	}
+
+	/* Remove and free the first root, push one the store did not have. */
+	objs = X509_STORE_get0_objects(store);
+	for (i = 0; i < sk_X509_OBJECT_num(objs); i++) {
+		obj = sk_X509_OBJECT_value(objs, i);
+		if (X509_cmp(X509_OBJECT_get0_X509(obj), removed) == 0)
+			break;
+	}
+	if (i == sk_X509_OBJECT_num(objs))
+		errx(1, "root missing from objects");
+	X509_OBJECT_free(sk_X509_OBJECT_delete(objs, i));
+
+	if ((obj = X509_OBJECT_new()) == NULL)
+		errx(1, "X509_OBJECT_new");
+	if (!X509_up_ref(pushed))
+		errx(1, "X509_up_ref");
+	obj->type = X509_LU_X509;
+	obj->data.x509 = pushed;
+	if (!sk_X509_OBJECT_push(objs, obj))
+		errx(1, "sk_X509_OBJECT_push");
+
+	if (store_has_cert(xsc, removed)) {
+		fprintf(stderr, "FAIL: %s: removed certificate found\n",
+		    __func__);
+		goto failure;
+	}
+	if (!store_has_cert(xsc, pushed)) {
+		fprintf(stderr, "FAIL: %s: pushed certificate not found\n",
+		    __func__);
+		goto failure;
+	}
+	if (X509_STORE_CTX_get1_issuer(&issuer, xsc, pushed) != 1 ||
+	    X509_cmp(issuer, pushed) != 0) {
+		fprintf(stderr, "FAIL: %s: pushed certificate not an issuer\n",
+		    __func__);
+		goto failure;
+	}
+
+	/* Adding still detects duplicates and finds new certificates. */
+	if (!X509_STORE_add_cert(store, pushed) ||
+	    !X509_STORE_add_cert(store, removed))
+		errx(1, "X509_STORE_add_cert");
+	if (sk_X509_OBJECT_num(objs) != sk_X509_num(roots) + 1) {
+		fprintf(stderr, "FAIL: %s: got %d objects, want %d\n",
+		    __func__, sk_X509_OBJECT_num(objs), sk_X509_num(roots) + 1);
+		goto failure;
+	}
+	if (!store_has_cert(xsc, removed)) {
+		fprintf(stderr, "FAIL: %s: re-added certificate not found\n",
+		    __func__);
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	X509_free(issuer);
+	sk_X509_pop_free(roots, X509_free);
+	sk_X509_pop_free(others, X509_free);
+	X509_STORE_CTX_free(xsc);
+	X509_STORE_free(store);
+
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	int failed = 0;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <certs_path>\n", argv[0]);
+		exit(1);
+	}
+
+	failed |= store_lookup_test(argv[1]);
+	failed |= store_get0_objects_test(argv[1]);
+
+	return failed;
+}
@@ -0,0 +1,220 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <glob.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+#define N_JOBS	64
+
+static STACK_OF(X509) *
+certs_from_file(const char *filename)
+{
+	STACK_OF(X509) *xs;
+	BIO *bio;
+	X509 *x;
+
+	if ((xs = sk_X509_new_null()) == NULL)
+		errx(1, "failed to create X509 stack");
+	if ((bio = BIO_new_file(filename, "r")) == NULL)
+		errx(1, "failed to open %s", filename);
+	while ((x = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+		if (!sk_X509_push(xs, x))
+			errx(1, "failed to push X509");
+	}
+	ERR_clear_error();
+	BIO_free(bio);
+
+	return xs;
+}
+
+static void
+verify_one(X509_STORE *store, X509 *leaf, STACK_OF(X509) *untrusted,
+    const X509_VERIFY_PARAM *param, int *result, int *error)
+{
+	X509_STORE_CTX *xsc;
+
+	if ((xsc = X509_STORE_CTX_new()) == NULL)
+		errx(1, "X509_STORE_CTX_new");
+	if (!X509_STORE_CTX_init(xsc, store, leaf, untrusted))
+		errx(1, "X509_STORE_CTX_init");
+	if (param != NULL &&
+	    !X509_VERIFY_PARAM_set1(X509_STORE_CTX_get0_param(xsc), param))
+		errx(1, "X509_VERIFY_PARAM_set1");
+	*result = X509_verify_cert(xsc);
+	*error = X509_STORE_CTX_get_error(xsc);
+	X509_STORE_CTX_free(xsc);
+}
+
+static int
+verify_batch_dir(const char *roots_file, int num_threads)
+{
+	char bundle_file[PATH_MAX], dir[PATH_MAX];
+	X509_VERIFY_JOB *jobs[N_JOBS];
+	int want_result[N_JOBS], want_error[N_JOBS];
+	STACK_OF(X509) *roots, *bundle;
+	X509_VERIFY_PARAM *param;
+	X509_STORE *store;
+	X509 *leaf;
+	int i;
+	int failed = 1;
+
+	if (strlcpy(dir, roots_file, sizeof(dir)) >= sizeof(dir))
+		errx(1, "path too long");
+	if (snprintf(bundle_file, sizeof(bundle_file), "%s/bundle.pem",
+	    dirname(dir)) >= (int)sizeof(bundle_file))
+		errx(1, "path too long");
+
+	roots = certs_from_file(roots_file);
+	bundle = certs_from_file(bundle_file);
+	if ((leaf = sk_X509_shift(bundle)) == NULL)
+		errx(1, "no leaf in %s", bundle_file);
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	for (i = 0; i < sk_X509_num(roots); i++) {
+		if (!X509_STORE_add_cert(store, sk_X509_value(roots, i)))
+			errx(1, "X509_STORE_add_cert");
+	}
+
+	/* Every other job verifies at a time before any of the certs. */
+	if ((param = X509_VERIFY_PARAM_new()) == NULL)
+		errx(1, "X509_VERIFY_PARAM_new");
+	X509_VERIFY_PARAM_set_time(param, 1);
+
+	for (i = 0; i < N_JOBS; i++) {
+		STACK_OF(X509) *untrusted = (i % 4 == 3) ? NULL : bundle;
+		const X509_VERIFY_PARAM *job_param = (i % 2 == 1) ? param :
+		    NULL;
+
+		if ((jobs[i] = X509_VERIFY_JOB_new(leaf, untrusted,
+		    job_param)) == NULL)
+			errx(1, "X509_VERIFY_JOB_new");
+		verify_one(store, leaf, untrusted, job_param, &want_result[i],
+		    &want_error[i]);
+	}
+
+	if (!X509_STORE_verify_batch(store, jobs, N_JOBS, num_threads)) {
+		fprintf(stderr, "FAIL: %s with %d threads: batch failed\n",
+		    roots_file, num_threads);
+		goto failure;
+	}
+	for (i = 0; i < N_JOBS; i++) {
+		int result = X509_VERIFY_JOB_get_result(jobs[i]);
+		int error = X509_VERIFY_JOB_get_error(jobs[i]);
+
+		if (result != want_result[i] || error != want_error[i]) {
+			fprintf(stderr, "FAIL: %s with %d threads: job %d got "
+			    "%d/%d, want %d/%d\n", roots_file, num_threads, i,
+			    result, error, want_result[i], want_error[i]);
+			goto failure;
+		}
+	}
+
+	failed = 0;
+
+ failure:
+	for (i = 0; i < N_JOBS; i++)
+		X509_VERIFY_JOB_free(jobs[i]);
+	X509_VERIFY_PARAM_free(param);
+	X509_STORE_free(store);
+	X509_free(leaf);
+	sk_X509_pop_free(roots, X509_free);
+	sk_X509_pop_free(bundle, X509_free);
+
+	return failed;
+}
+
+static int
+verify_batch_empty(void)
+{
+	X509_VERIFY_JOB *jobs[1] = { NULL };
+	X509_STORE *store;
+	int failed = 0;
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	if (!X509_STORE_verify_batch(store, NULL, 0, 4)) {
+		fprintf(stderr, "FAIL: empty batch failed\n");
+		failed = 1;
+	}
+	if (X509_STORE_verify_batch(NULL, NULL, 0, 4)) {
+		fprintf(stderr, "FAIL: batch without store succeeded\n");
+		failed = 1;
+	}
+	if (X509_STORE_verify_batch(store, jobs, 1, 4)) {
+		fprintf(stderr, "FAIL: batch with NULL job succeeded\n");
+		failed = 1;
+	}
+
+	if ((jobs[0] = X509_VERIFY_JOB_new(NULL, NULL, NULL)) == NULL)
+		errx(1, "X509_VERIFY_JOB_new");
+	if (X509_VERIFY_JOB_get_result(jobs[0]) != -1 ||
+	    X509_VERIFY_JOB_get_error(jobs[0]) != X509_V_ERR_UNSPECIFIED) {
+		fprintf(stderr, "FAIL: new job is not marked unprocessed\n");
+		failed = 1;
+	}
+	X509_VERIFY_JOB_free(jobs[0]);
+	X509_VERIFY_JOB_free(NULL);
+	ERR_clear_error();
+	X509_STORE_free(store);
+
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	char pattern[PATH_MAX];
+	const int num_threads[] = { 0, 1, 3, 8 };
+	glob_t g;
+	size_t i, j;
+	int failed = 0;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: verify_batch certs_path\n");
+		exit(1);
+	}
+
+	if (snprintf(pattern, sizeof(pattern), "%s/*/roots.pem",
+	    argv[1]) >= (int)sizeof(pattern))
+		errx(1, "certs path too long");
+	memset(&g, 0, sizeof(g));
+	if (glob(pattern, 0, NULL, &g) != 0)
+		errx(1, "no certificates found in %s", argv[1]);
+
+	for (i = 0; i < g.gl_pathc; i++) {
+		for (j = 0; j < sizeof(num_threads) / sizeof(num_threads[0]);
+		    j++)
+			failed |= verify_batch_dir(g.gl_pathv[i],
+			    num_threads[j]);
+	}
+	globfree(&g);
+
+	failed |= verify_batch_empty();
+
+	return failed;
+}
@@ -0,0 +1,252 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+static STACK_OF(X509) *
+certs_from_file(const char *filename)
+{
+	STACK_OF(X509_INFO) *xis = NULL;
+	STACK_OF(X509) *xs;
+	BIO *bio;
+	X509 *x;
+	int i;
+
+	if ((xs = sk_X509_new_null()) == NULL)
+		errx(1, "failed to create X509 stack");
+	if ((bio = BIO_new_file(filename, "r")) == NULL) {
+		ERR_print_errors_fp(stderr);
+		errx(1, "failed to create bio");
+	}
+	if ((xis = PEM_X509_INFO_read_bio(bio, NULL, NULL, NULL)) == NULL)
+		errx(1, "failed to read PEM");
+
+	for (i = 0; i < sk_X509_INFO_num(xis); i++) {
+		if ((x = sk_X509_INFO_value(xis, i)->x509) == NULL)
+			continue;
+		if (!X509_up_ref(x))
+			errx(1, "failed to up ref X509");
+		if (!sk_X509_push(xs, x))
+			errx(1, "failed to push X509");
+	}
+
+	sk_X509_INFO_pop_free(xis, X509_INFO_free);
+	BIO_free(bio);
+
+	return xs;
+}
+
+static int
+verify_with_store(X509_STORE *store, X509 *leaf, STACK_OF(X509) *untrusted,
+    int depth, STACK_OF(X509) **out_chain)
+{
+	X509_STORE_CTX *xsc;
+	int ret;
+
+	if ((xsc = X509_STORE_CTX_new()) == NULL)
+		errx(1, "X509_STORE_CTX_new");
+	if (!X509_STORE_CTX_init(xsc, store, leaf, untrusted))
+		errx(1, "X509_STORE_CTX_init");
+	if (depth >= 0)
+		X509_STORE_CTX_set_depth(xsc, depth);
+
+	ret = X509_verify_cert(xsc);
+	if (ret == 1 && out_chain != NULL)
+		*out_chain = X509_STORE_CTX_get1_chain(xsc);
+	if (ret == 1 && X509_STORE_CTX_get_error(xsc) != X509_V_OK)
+		ret = 0;
+
+	X509_STORE_CTX_free(xsc);
+
+	return ret;
+}
+
+static int verify_cb_calls;
+
+static int
+verify_cb(int ok, X509_STORE_CTX *xsc)
+{
+	verify_cb_calls++;
+
+	return ok;
+}
+
+static int
+chains_equal(STACK_OF(X509) *a, STACK_OF(X509) *b)
+{
+	int i;
+
+	if (sk_X509_num(a) != sk_X509_num(b))
+		return 0;
+	for (i = 0; i < sk_X509_num(a); i++) {
+		if (X509_cmp(sk_X509_value(a, i), sk_X509_value(b, i)) != 0)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int
+verify_cache_test(const char *certs_path, const char *id)
+{
+	STACK_OF(X509) *roots = NULL, *bundle = NULL, *empty = NULL;
+	STACK_OF(X509) *chain1 = NULL, *chain2 = NULL;
+	char *roots_file, *bundle_file;
+	X509_STORE *store = NULL;
+	X509 *leaf = NULL;
+	int i;
+	int failed = 1;
+
+	if (asprintf(&roots_file, "%s/%s/roots.pem", certs_path, id) == -1)
+		errx(1, "asprintf");
+	if (asprintf(&bundle_file, "%s/%s/bundle.pem", certs_path, id) == -1)
+		errx(1, "asprintf");
+
+	roots = certs_from_file(roots_file);
+	bundle = certs_from_file(bundle_file);
+	if ((leaf = sk_X509_shift(bundle)) == NULL)
+		errx(1, "not enough certs in bundle");
+	if ((empty = sk_X509_new_null()) == NULL)
+		errx(1, "sk_X509_new_null");
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	for (i = 0; i < sk_X509_num(roots); i++) {
+		if (!X509_STORE_add_cert(store, sk_X509_value(roots, i)))
+			errx(1, "X509_STORE_add_cert");
+	}
+	if (!X509_STORE_set_verify_cache(store, 4))
+		errx(1, "X509_STORE_set_verify_cache");
+
+	if (!verify_with_store(store, leaf, bundle, -1, &chain1)) {
+		fprintf(stderr, "FAIL: %s: first verification failed\n", id);
+		goto failure;
+	}
+	if (!verify_with_store(store, leaf, bundle, -1, &chain2)) {
+		fprintf(stderr, "FAIL: %s: cached verification failed\n", id);
+		goto failure;
+	}
+	if (!chains_equal(chain1, chain2)) {
+		fprintf(stderr, "FAIL: %s: cached chain differs\n", id);
+		goto failure;
+	}
+	if (sk_X509_value(chain2, 0) != leaf) {
+		fprintf(stderr, "FAIL: %s: cached chain has wrong leaf\n", id);
+		goto failure;
+	}
+
+	/*
+	 * Chains with intermediates must not be found in the cache when the
+	 * depth or untrusted certificates change.
+	 */
+	if (sk_X509_num(chain1) > 2) {
+		if (verify_with_store(store, leaf, bundle, 1, NULL)) {
+			fprintf(stderr, "FAIL: %s: verified with depth 1\n",
+			    id);
+			goto failure;
+		}
+		if (verify_with_store(store, leaf, empty, -1, NULL)) {
+			fprintf(stderr, "FAIL: %s: verified without "
+			    "intermediates\n", id);
+			goto failure;
+		}
+	}
+
+	/* Hooks set after a result was cached must still be called. */
+	verify_cb_calls = 0;
+	X509_STORE_set_verify_cb(store, verify_cb);
+	if (!verify_with_store(store, leaf, bundle, -1, NULL)) {
+		fprintf(stderr, "FAIL: %s: verification with callback "
+		    "failed\n", id);
+		goto failure;
+	}
+	if (verify_cb_calls == 0) {
+		fprintf(stderr, "FAIL: %s: callback not called\n", id);
+		goto failure;
+	}
+	X509_STORE_set_verify_cb(store, NULL);
+
+	/* Adding to the store flushes the cache. */
+	if (!X509_STORE_add_cert(store, leaf))
+		errx(1, "X509_STORE_add_cert");
+	if (!verify_with_store(store, leaf, bundle, -1, NULL)) {
+		fprintf(stderr, "FAIL: %s: verification after flush failed\n",
+		    id);
+		goto failure;
+	}
+
+	/* Disabling the cache must not affect verification. */
+	if (!X509_STORE_set_verify_cache(store, 0))
+		errx(1, "X509_STORE_set_verify_cache");
+	if (!verify_with_store(store, leaf, bundle, -1, NULL)) {
+		fprintf(stderr, "FAIL: %s: uncached verification failed\n", id);
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	sk_X509_pop_free(roots, X509_free);
+	sk_X509_pop_free(bundle, X509_free);
+	sk_X509_pop_free(chain1, X509_free);
+	sk_X509_pop_free(chain2, X509_free);
+	sk_X509_free(empty);
+	X509_STORE_free(store);
+	X509_free(leaf);
+	free(roots_file);
+	free(bundle_file);
+
+	return failed;
+}
+
+static const char *verify_cache_ids[] = {
+	"1a",
+	"2a",
+	"2c",
+	"3a",
+	"3e",
+	"4a",
+	"4b",
+};
+
+#define N_VERIFY_CACHE_IDS \
+    (sizeof(verify_cache_ids) / sizeof(*verify_cache_ids))
+
+int
+main(int argc, char **argv)
+{
+	int failed = 0;
+	size_t i;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <certs_path>\n", argv[0]);
+		exit(1);
+	}
+
+	for (i = 0; i < N_VERIFY_CACHE_IDS; i++)
+		failed |= verify_cache_test(argv[1], verify_cache_ids[i]);
+
+	return failed;
+}
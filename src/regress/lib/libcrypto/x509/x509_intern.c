@@ -0,0 +1,319 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <err.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/err.h>
+#include <openssl/objects.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+#include "x509_local.h"
+
+#define N_SWEEP_CERTS	4096
+
+static char bundle_path[PATH_MAX];
+
+/* Parse a fresh copy of the n-th certificate of the bundle. */
+static X509 *
+bundle_cert(int n)
+{
+	BIO *bio;
+	X509 *x = NULL;
+	int i;
+
+	if ((bio = BIO_new_file(bundle_path, "r")) == NULL)
+		errx(1, "failed to open %s", bundle_path);
+	for (i = 0; i <= n; i++) {
+		X509_free(x);
+		if ((x = PEM_read_bio_X509(bio, NULL, NULL, NULL)) == NULL)
+			errx(1, "failed to read certificate %d", n);
+	}
+	BIO_free(bio);
+
+	return x;
+}
+
+static int
+test_intern_identical(void)
+{
+	X509 *a, *b, *c;
+	int failed = 1;
+
+	x509_intern_flush();
+
+	a = X509_intern(bundle_cert(0));
+	b = X509_intern(bundle_cert(0));
+	c = X509_intern(bundle_cert(1));
+
+	if (a != b) {
+		fprintf(stderr, "FAIL: %s: identical certificates not "
+		    "shared\n", __func__);
+		goto failure;
+	}
+	if (a == c) {
+		fprintf(stderr, "FAIL: %s: different certificates shared\n",
+		    __func__);
+		goto failure;
+	}
+	if (x509_intern_count() != 2) {
+		fprintf(stderr, "FAIL: %s: want 2 interned certificates, "
+		    "got %zu\n", __func__, x509_intern_count());
+		goto failure;
+	}
+
+	/* Interning an interned certificate is a no-op. */
+	if (!X509_up_ref(a))
+		errx(1, "X509_up_ref");
+	if (X509_intern(a) != a) {
+		fprintf(stderr, "FAIL: %s: re-interning changed certificate\n",
+		    __func__);
+		goto failure;
+	}
+	X509_free(a);
+
+	failed = 0;
+
+ failure:
+	X509_free(a);
+	X509_free(b);
+	X509_free(c);
+
+	return failed;
+}
+
+static int
+test_intern_aux(void)
+{
+	ASN1_OBJECT *obj;
+	X509 *a, *b = NULL;
+	int failed = 1;
+
+	x509_intern_flush();
+
+	a = X509_intern(bundle_cert(0));
+
+	b = bundle_cert(0);
+	if ((obj = OBJ_nid2obj(NID_server_auth)) == NULL)
+		errx(1, "OBJ_nid2obj");
+	if (!X509_add1_trust_object(b, obj))
+		errx(1, "X509_add1_trust_object");
+
+	if ((b = X509_intern(b)) == a) {
+		fprintf(stderr, "FAIL: %s: certificate with trust settings "
+		    "was interned\n", __func__);
+		goto failure;
+	}
+	if (x509_intern_count() != 1) {
+		fprintf(stderr, "FAIL: %s: want 1 interned certificate, "
+		    "got %zu\n", __func__, x509_intern_count());
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	X509_free(a);
+	X509_free(b);
+
+	return failed;
+}
+
+/* Find the certificate in store that is identical to x. */
+static X509 *
+store_cert(X509_STORE *store, X509 *x)
+{
+	STACK_OF(X509_OBJECT) *objs;
+	X509 *cert;
+	int i;
+
+	objs = X509_STORE_get0_objects(store);
+	for (i = 0; i < sk_X509_OBJECT_num(objs); i++) {
+		cert = X509_OBJECT_get0_X509(sk_X509_OBJECT_value(objs, i));
+		if (cert != NULL && X509_cmp(cert, x) == 0)
+			return cert;
+	}
+
+	return NULL;
+}
+
+static X509_STORE *
+store_load_bundle(void)
+{
+	X509_STORE *store;
+	X509_LOOKUP *lookup;
+
+	if ((store = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	if ((lookup = X509_STORE_add_lookup(store, X509_LOOKUP_file())) == NULL)
+		errx(1, "X509_STORE_add_lookup");
+	if (X509_LOOKUP_load_file(lookup, bundle_path, X509_FILETYPE_PEM) != 1)
+		errx(1, "X509_LOOKUP_load_file");
+
+	return store;
+}
+
+static int
+test_intern_store(void)
+{
+	X509_STORE *store_a = NULL, *store_b = NULL, *store_c = NULL;
+	X509 *a, *x, *x_a, *x_b, *x_c;
+	int failed = 1;
+
+	x509_intern_flush();
+
+	if ((store_a = X509_STORE_new()) == NULL)
+		errx(1, "X509_STORE_new");
+	store_b = store_load_bundle();
+	store_c = store_load_bundle();
+
+	/* Stores loading the same file share their certificates. */
+	x = bundle_cert(1);
+	x_b = store_cert(store_b, x);
+	x_c = store_cert(store_c, x);
+	if (x_b == NULL || x_b != x_c) {
+		fprintf(stderr, "FAIL: %s: stores do not share certificate\n",
+		    __func__);
+		goto failure;
+	}
+
+	/* A certificate added by the caller is retained as is. */
+	a = bundle_cert(1);
+	if (!X509_STORE_add_cert(store_a, a))
+		errx(1, "X509_STORE_add_cert");
+	x_a = store_cert(store_a, x);
+	X509_free(a);
+	if (x_a != a) {
+		fprintf(stderr, "FAIL: %s: store did not retain certificate\n",
+		    __func__);
+		goto failure;
+	}
+
+	/* So auxiliary settings made later stay out of other stores. */
+	if (!X509_alias_set1(x_a, (const unsigned char *)"a", -1))
+		errx(1, "X509_alias_set1");
+	if (X509_alias_get0(x_b, NULL) != NULL) {
+		fprintf(stderr, "FAIL: %s: alias leaked into other store\n",
+		    __func__);
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	X509_free(x);
+	X509_STORE_free(store_a);
+	X509_STORE_free(store_b);
+	X509_STORE_free(store_c);
+
+	return failed;
+}
+
+static int
+test_intern_sweep(void)
+{
+	ASN1_INTEGER *serial;
+	X509 *base, *x, *kept = NULL;
+	size_t count;
+	int i;
+	int failed = 1;
+
+	x509_intern_flush();
+
+	base = bundle_cert(0);
+	if ((serial = ASN1_INTEGER_new()) == NULL)
+		errx(1, "ASN1_INTEGER_new");
+
+	/*
+	 * Intern many distinct certificates that are released straight away.
+	 * The table must not grow without bound.
+	 */
+	for (i = 0; i < N_SWEEP_CERTS; i++) {
+		if ((x = X509_dup(base)) == NULL)
+			errx(1, "X509_dup");
+		if (!ASN1_INTEGER_set(serial, i + 1))
+			errx(1, "ASN1_INTEGER_set");
+		if (!X509_set_serialNumber(x, serial))
+			errx(1, "X509_set_serialNumber");
+		x = X509_intern(x);
+		if (i == 0)
+			kept = x;
+		else
+			X509_free(x);
+	}
+
+	if ((count = x509_intern_count()) >= N_SWEEP_CERTS / 2) {
+		fprintf(stderr, "FAIL: %s: %zu unused certificates retained\n",
+		    __func__, count);
+		goto failure;
+	}
+
+	/* A certificate that is still in use remains shared. */
+	if ((x = X509_dup(kept)) == NULL)
+		errx(1, "X509_dup");
+	if ((x = X509_intern(x)) != kept) {
+		fprintf(stderr, "FAIL: %s: in use certificate was swept\n",
+		    __func__);
+		X509_free(x);
+		goto failure;
+	}
+	X509_free(x);
+
+	x509_intern_flush();
+	if (x509_intern_count() != 0) {
+		fprintf(stderr, "FAIL: %s: flush left %zu certificates\n",
+		    __func__, x509_intern_count());
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	ASN1_INTEGER_free(serial);
+	X509_free(base);
+	X509_free(kept);
+
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	int failed = 0;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: x509_intern certs_path\n");
+		exit(1);
+	}
+	if (snprintf(bundle_path, sizeof(bundle_path), "%s/2a/bundle.pem",
+	    argv[1]) >= (int)sizeof(bundle_path))
+		errx(1, "certs path too long");
+
+	failed |= test_intern_identical();
+	failed |= test_intern_aux();
+	failed |= test_intern_store();
+	failed |= test_intern_sweep();
+
+	x509_intern_flush();
+
+	return failed;
+}
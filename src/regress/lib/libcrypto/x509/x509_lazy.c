@@ -0,0 +1,513 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/time.h>
+
+#include <err.h>
+#include <glob.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+struct cert_der {
+	unsigned char *data;
+	int len;
+};
+
+static struct cert_der *certs;
+static size_t n_certs;
+
+static void
+certs_load_file(const char *filename)
+{
+	struct cert_der *new_certs;
+	unsigned char *data;
+	BIO *bio;
+	X509 *x;
+	int len;
+
+	if ((bio = BIO_new_file(filename, "r")) == NULL)
+		errx(1, "failed to open %s", filename);
+	while ((x = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL) {
+		data = NULL;
+		if ((len = i2d_X509(x, &data)) <= 0)
+			errx(1, "i2d_X509");
+		if ((new_certs = reallocarray(certs, n_certs + 1,
+		    sizeof(*certs))) == NULL)
+			err(1, NULL);
+		certs = new_certs;
+		certs[n_certs].data = data;
+		certs[n_certs].len = len;
+		n_certs++;
+		X509_free(x);
+	}
+	ERR_clear_error();
+	BIO_free(bio);
+}
+
+static void
+certs_load(const char *certs_path)
+{
+	char pattern[PATH_MAX];
+	glob_t g;
+	size_t i;
+	int ret;
+
+	ret = snprintf(pattern, sizeof(pattern), "%s/*/*.pem", certs_path);
+	if (ret < 0 || (size_t)ret >= sizeof(pattern))
+		errx(1, "certs path too long");
+
+	memset(&g, 0, sizeof(g));
+	if (glob(pattern, 0, NULL, &g) != 0)
+		errx(1, "no certificates found in %s", certs_path);
+	for (i = 0; i < g.gl_pathc; i++)
+		certs_load_file(g.gl_pathv[i]);
+	globfree(&g);
+
+	if (n_certs == 0)
+		errx(1, "no certificates found in %s", certs_path);
+}
+
+static void
+certs_free(void)
+{
+	size_t i;
+
+	for (i = 0; i < n_certs; i++)
+		free(certs[i].data);
+	free(certs);
+}
+
+static X509 *
+cert_decode(const struct cert_der *cd, int lazy)
+{
+	const unsigned char *p = cd->data;
+	X509 *x;
+
+	if (lazy)
+		x = d2i_X509_lazy(NULL, &p, cd->len);
+	else
+		x = d2i_X509(NULL, &p, cd->len);
+	if (x == NULL)
+		return NULL;
+	if (p != cd->data + cd->len)
+		errx(1, "certificate not fully consumed");
+
+	return x;
+}
+
+static int
+x509_to_der(X509 *x, int re_tbs, unsigned char **out_der, int *out_len)
+{
+	*out_der = NULL;
+	if (re_tbs)
+		*out_len = i2d_re_X509_tbs(x, out_der);
+	else
+		*out_len = i2d_X509(x, out_der);
+
+	return *out_len > 0;
+}
+
+static int
+x509_print_compare(X509 *a, X509 *b)
+{
+	BIO *bio_a = NULL, *bio_b = NULL;
+	char *data_a, *data_b;
+	long len_a, len_b;
+	int ret = 0;
+
+	if ((bio_a = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	if ((bio_b = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	if (!X509_print(bio_a, a) || !X509_print(bio_b, b))
+		goto err;
+
+	len_a = BIO_get_mem_data(bio_a, &data_a);
+	len_b = BIO_get_mem_data(bio_b, &data_b);
+	if (len_a != len_b || memcmp(data_a, data_b, len_a) != 0)
+		goto err;
+
+	ret = 1;
+
+ err:
+	BIO_free(bio_a);
+	BIO_free(bio_b);
+
+	return ret;
+}
+
+static int
+x509_extensions_compare(X509 *a, X509 *b)
+{
+	unsigned char *der_a = NULL, *der_b = NULL;
+	int len_a, len_b;
+	int i;
+	int ret = 0;
+
+	if (X509_get_ext_count(a) != X509_get_ext_count(b))
+		goto err;
+	for (i = 0; i < X509_get_ext_count(a); i++) {
+		der_a = der_b = NULL;
+		len_a = i2d_X509_EXTENSION(X509_get_ext(a, i), &der_a);
+		len_b = i2d_X509_EXTENSION(X509_get_ext(b, i), &der_b);
+		if (len_a <= 0 || len_a != len_b ||
+		    memcmp(der_a, der_b, len_a) != 0)
+			goto err;
+		free(der_a);
+		free(der_b);
+	}
+	der_a = der_b = NULL;
+
+	ret = 1;
+
+ err:
+	free(der_a);
+	free(der_b);
+
+	return ret;
+}
+
+static int
+test_lazy_equivalence(void)
+{
+	unsigned char *der_a = NULL, *der_b = NULL;
+	int len_a, len_b;
+	X509 *eager = NULL, *lazy = NULL, *dup = NULL;
+	size_t i;
+	int failed = 1;
+
+	for (i = 0; i < n_certs; i++) {
+		if ((eager = cert_decode(&certs[i], 0)) == NULL)
+			errx(1, "d2i_X509");
+		if ((lazy = cert_decode(&certs[i], 1)) == NULL) {
+			fprintf(stderr, "FAIL: cert %zu: d2i_X509_lazy\n", i);
+			goto failure;
+		}
+
+		/* An unmodified certificate encodes to its original DER. */
+		if (!x509_to_der(lazy, 0, &der_a, &len_a) ||
+		    len_a != certs[i].len ||
+		    memcmp(der_a, certs[i].data, len_a) != 0) {
+			fprintf(stderr, "FAIL: cert %zu: i2d_X509 mismatch\n",
+			    i);
+			goto failure;
+		}
+		free(der_a);
+		der_a = NULL;
+
+		/* Re-encoding the TBS must decode the pending extensions. */
+		if (!x509_to_der(eager, 1, &der_a, &len_a) ||
+		    !x509_to_der(lazy, 1, &der_b, &len_b) ||
+		    len_a != len_b || memcmp(der_a, der_b, len_a) != 0) {
+			fprintf(stderr, "FAIL: cert %zu: i2d_re_X509_tbs "
+			    "mismatch\n", i);
+			goto failure;
+		}
+		free(der_a);
+		free(der_b);
+		der_a = der_b = NULL;
+		X509_free(lazy);
+
+		if ((lazy = cert_decode(&certs[i], 1)) == NULL)
+			errx(1, "d2i_X509_lazy");
+
+		if (X509_check_purpose(eager, -1, 0) !=
+		    X509_check_purpose(lazy, -1, 0) ||
+		    X509_get_extension_flags(eager) !=
+		    X509_get_extension_flags(lazy)) {
+			fprintf(stderr, "FAIL: cert %zu: extension flags "
+			    "mismatch\n", i);
+			goto failure;
+		}
+		if (!x509_extensions_compare(eager, lazy)) {
+			fprintf(stderr, "FAIL: cert %zu: extensions mismatch\n",
+			    i);
+			goto failure;
+		}
+		if (!x509_print_compare(eager, lazy)) {
+			fprintf(stderr, "FAIL: cert %zu: X509_print mismatch\n",
+			    i);
+			goto failure;
+		}
+		X509_free(lazy);
+
+		/* Duplicating a lazily parsed certificate. */
+		if ((lazy = cert_decode(&certs[i], 1)) == NULL)
+			errx(1, "d2i_X509_lazy");
+		if ((dup = X509_dup(lazy)) == NULL)
+			errx(1, "X509_dup");
+		if (!x509_extensions_compare(eager, dup)) {
+			fprintf(stderr, "FAIL: cert %zu: X509_dup extensions "
+			    "mismatch\n", i);
+			goto failure;
+		}
+
+		X509_free(eager);
+		X509_free(lazy);
+		X509_free(dup);
+		eager = lazy = dup = NULL;
+	}
+
+	failed = 0;
+
+ failure:
+	free(der_a);
+	free(der_b);
+	X509_free(eager);
+	X509_free(lazy);
+	X509_free(dup);
+
+	return failed;
+}
+
+/* OID 2.5.29.19 (basicConstraints). */
+static const unsigned char basic_constraints_oid[] = {
+	0x06, 0x03, 0x55, 0x1d, 0x13,
+};
+
+static int
+test_lazy_malformed(void)
+{
+	struct cert_der cd = { 0 };
+	unsigned char *der = NULL;
+	int len;
+	X509 *x = NULL;
+	size_t i;
+	int j;
+	int failed = 1;
+
+	/*
+	 * Turn the basicConstraints OID into an OCTET STRING - the outer
+	 * structure remains valid, but the extension no longer decodes.
+	 */
+	for (i = 0; i < n_certs && cd.data == NULL; i++) {
+		for (j = 0; j + (int)sizeof(basic_constraints_oid) <=
+		    certs[i].len; j++) {
+			if (memcmp(&certs[i].data[j], basic_constraints_oid,
+			    sizeof(basic_constraints_oid)) != 0)
+				continue;
+			if ((cd.data = malloc(certs[i].len)) == NULL)
+				err(1, NULL);
+			memcpy(cd.data, certs[i].data, certs[i].len);
+			cd.data[j] = V_ASN1_OCTET_STRING;
+			cd.len = certs[i].len;
+			break;
+		}
+	}
+	if (cd.data == NULL)
+		errx(1, "no certificate with basicConstraints found");
+
+	if ((x = cert_decode(&cd, 0)) != NULL) {
+		fprintf(stderr, "FAIL: d2i_X509 succeeded on malformed "
+		    "extensions\n");
+		goto failure;
+	}
+	ERR_clear_error();
+
+	if ((x = cert_decode(&cd, 1)) == NULL) {
+		fprintf(stderr, "FAIL: d2i_X509_lazy failed\n");
+		goto failure;
+	}
+	if (X509_get_ext_count(x) != 0) {
+		fprintf(stderr, "FAIL: malformed extensions are visible\n");
+		goto failure;
+	}
+	if ((X509_get_extension_flags(x) & EXFLAG_INVALID) == 0) {
+		fprintf(stderr, "FAIL: malformed extensions not flagged "
+		    "invalid\n");
+		goto failure;
+	}
+	if (X509_add1_ext_i2d(x, NID_netscape_comment, NULL, 0,
+	    X509V3_ADD_DEFAULT) != 0) {
+		fprintf(stderr, "FAIL: added extension to malformed "
+		    "extensions\n");
+		goto failure;
+	}
+
+	/* The original encoding is retained, a new one can't be made. */
+	if (!x509_to_der(x, 0, &der, &len) || len != cd.len ||
+	    memcmp(der, cd.data, len) != 0) {
+		fprintf(stderr, "FAIL: i2d_X509 mismatch\n");
+		goto failure;
+	}
+	free(der);
+	der = NULL;
+	if (x509_to_der(x, 1, &der, &len)) {
+		fprintf(stderr, "FAIL: i2d_re_X509_tbs succeeded\n");
+		goto failure;
+	}
+	ERR_clear_error();
+
+	failed = 0;
+
+ failure:
+	free(cd.data);
+	free(der);
+	X509_free(x);
+
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static void
+benchmark_d2i_X509(void)
+{
+	size_t i;
+
+	for (i = 0; i < n_certs; i++)
+		X509_free(cert_decode(&certs[i], 0));
+}
+
+static void
+benchmark_d2i_X509_lazy(void)
+{
+	size_t i;
+
+	for (i = 0; i < n_certs; i++)
+		X509_free(cert_decode(&certs[i], 1));
+}
+
+static void
+benchmark_d2i_X509_purpose(void)
+{
+	X509 *x;
+	size_t i;
+
+	for (i = 0; i < n_certs; i++) {
+		x = cert_decode(&certs[i], 0);
+		X509_check_purpose(x, -1, 0);
+		X509_free(x);
+	}
+}
+
+static void
+benchmark_d2i_X509_lazy_purpose(void)
+{
+	X509 *x;
+	size_t i;
+
+	for (i = 0; i < n_certs; i++) {
+		x = cert_decode(&certs[i], 1);
+		X509_check_purpose(x, -1, 0);
+		X509_free(x);
+	}
+}
+
+struct benchmark {
+	const char *desc;
+	void (*func)(void);
+};
+
+static const struct benchmark benchmarks[] = {
+	{
+		.desc = "d2i_X509()",
+		.func = benchmark_d2i_X509,
+	},
+	{
+		.desc = "d2i_X509_lazy()",
+		.func = benchmark_d2i_X509_lazy,
+	},
+	{
+		.desc = "d2i_X509() + X509_check_purpose()",
+		.func = benchmark_d2i_X509_purpose,
+	},
+	{
+		.desc = "d2i_X509_lazy() + X509_check_purpose()",
+		.func = benchmark_d2i_X509_lazy_purpose,
+	},
+};
+
+#define N_BENCHMARKS (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static void
+benchmark_run(const struct benchmark *bm, int seconds)
+{
+	struct timespec start, end, duration;
+	int i;
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	fprintf(stderr, "Benchmarking %s for %ds: ", bm->desc, seconds);
+	while (!benchmark_stop) {
+		bm->func();
+		i++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	timespecsub(&end, &start, &duration);
+	fprintf(stderr, "%zu certificates in %f seconds\n", i * n_certs,
+	    duration.tv_sec + duration.tv_nsec / 1000000000.0);
+}
+
+static void
+benchmark_x509_lazy(void)
+{
+	size_t i;
+
+	for (i = 0; i < N_BENCHMARKS; i++)
+		benchmark_run(&benchmarks[i], 5);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 3 && strcmp(argv[1], "--benchmark") == 0) {
+		benchmark = 1;
+		argc--;
+		argv++;
+	}
+	if (argc != 2) {
+		fprintf(stderr, "usage: x509_lazy [--benchmark] certs_path\n");
+		exit(1);
+	}
+
+	certs_load(argv[1]);
+
+	failed |= test_lazy_equivalence();
+	failed |= test_lazy_malformed();
+
+	if (benchmark && !failed)
+		benchmark_x509_lazy();
+
+	certs_free();
+
+	return failed;
+}
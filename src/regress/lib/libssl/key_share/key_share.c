@@ -0,0 +1,405 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <err.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/curve25519.h>
+#include <openssl/mlkem.h>
+
+#include "bytestring.h"
+#include "ssl_local.h"
+#include "tls_internal.h"
+
+struct key_share_test {
+	const char *desc;
+	uint16_t group_id;
+	size_t client_public_len;
+	size_t server_public_len;
+	size_t shared_key_len;
+};
+
+static const struct key_share_test key_share_tests[] = {
+	{
+		.desc = "X25519",
+		.group_id = 29,
+		.client_public_len = X25519_KEY_LENGTH,
+		.server_public_len = X25519_KEY_LENGTH,
+		.shared_key_len = X25519_KEY_LENGTH,
+	},
+	{
+		.desc = "secp256r1",
+		.group_id = 23,
+		.client_public_len = 65,
+		.server_public_len = 65,
+		.shared_key_len = 32,
+	},
+	{
+		.desc = "X25519MLKEM768",
+		.group_id = 4588,
+		.client_public_len = MLKEM768_PUBLIC_KEY_BYTES +
+		    X25519_KEY_LENGTH,
+		.server_public_len = MLKEM768_CIPHERTEXT_BYTES +
+		    X25519_KEY_LENGTH,
+		.shared_key_len = MLKEM_SHARED_SECRET_BYTES + X25519_KEY_LENGTH,
+	},
+};
+
+#define N_KEY_SHARE_TESTS \
+    (sizeof(key_share_tests) / sizeof(key_share_tests[0]))
+
+static int
+key_share_public(struct tls_key_share *ks, uint8_t **out, size_t *out_len)
+{
+	CBB cbb;
+	int ret = 0;
+
+	if (!CBB_init(&cbb, 0))
+		goto err;
+	if (!tls_key_share_public(ks, &cbb))
+		goto err;
+	if (!CBB_finish(&cbb, out, out_len))
+		goto err;
+
+	ret = 1;
+
+ err:
+	CBB_cleanup(&cbb);
+
+	return ret;
+}
+
+/*
+ * Run a key exchange in the order used by TLSv1.3: the client generates its
+ * share, the server processes it and generates its own, then the client
+ * processes the server share.
+ */
+static int
+key_share_exchange(const struct key_share_test *kst, int check)
+{
+	struct tls_key_share *client = NULL, *server = NULL;
+	uint8_t *client_public = NULL, *server_public = NULL;
+	uint8_t *client_key = NULL, *server_key = NULL;
+	size_t client_public_len = 0, server_public_len = 0;
+	size_t client_key_len = 0, server_key_len = 0;
+	int decode_error;
+	CBS cbs;
+	int failed = 1;
+
+	if ((client = tls_key_share_new(kst->group_id)) == NULL)
+		errx(1, "%s: client tls_key_share_new", kst->desc);
+	if ((server = tls_key_share_new(kst->group_id)) == NULL)
+		errx(1, "%s: server tls_key_share_new", kst->desc);
+
+	if (!tls_key_share_generate(client)) {
+		fprintf(stderr, "FAIL: %s: client generate\n", kst->desc);
+		goto failure;
+	}
+	if (!key_share_public(client, &client_public, &client_public_len)) {
+		fprintf(stderr, "FAIL: %s: client public\n", kst->desc);
+		goto failure;
+	}
+
+	CBS_init(&cbs, client_public, client_public_len);
+	if (!tls_key_share_peer_public(server, &cbs, &decode_error, NULL)) {
+		fprintf(stderr, "FAIL: %s: server peer public\n", kst->desc);
+		goto failure;
+	}
+	if (!tls_key_share_generate(server)) {
+		fprintf(stderr, "FAIL: %s: server generate\n", kst->desc);
+		goto failure;
+	}
+	if (!key_share_public(server, &server_public, &server_public_len)) {
+		fprintf(stderr, "FAIL: %s: server public\n", kst->desc);
+		goto failure;
+	}
+	if (!tls_key_share_derive(server, &server_key, &server_key_len)) {
+		fprintf(stderr, "FAIL: %s: server derive\n", kst->desc);
+		goto failure;
+	}
+
+	CBS_init(&cbs, server_public, server_public_len);
+	if (!tls_key_share_peer_public(client, &cbs, &decode_error, NULL)) {
+		fprintf(stderr, "FAIL: %s: client peer public\n", kst->desc);
+		goto failure;
+	}
+	if (!tls_key_share_derive(client, &client_key, &client_key_len)) {
+		fprintf(stderr, "FAIL: %s: client derive\n", kst->desc);
+		goto failure;
+	}
+
+	if (check) {
+		if (client_public_len != kst->client_public_len) {
+			fprintf(stderr, "FAIL: %s: client public length %zu, "
+			    "want %zu\n", kst->desc, client_public_len,
+			    kst->client_public_len);
+			goto failure;
+		}
+		if (server_public_len != kst->server_public_len) {
+			fprintf(stderr, "FAIL: %s: server public length %zu, "
+			    "want %zu\n", kst->desc, server_public_len,
+			    kst->server_public_len);
+			goto failure;
+		}
+		if (client_key_len != kst->shared_key_len ||
+		    server_key_len != kst->shared_key_len) {
+			fprintf(stderr, "FAIL: %s: shared key lengths %zu and "
+			    "%zu, want %zu\n", kst->desc, client_key_len,
+			    server_key_len, kst->shared_key_len);
+			goto failure;
+		}
+		if (memcmp(client_key, server_key, client_key_len) != 0) {
+			fprintf(stderr, "FAIL: %s: shared keys differ\n",
+			    kst->desc);
+			goto failure;
+		}
+	}
+
+	failed = 0;
+
+ failure:
+	tls_key_share_free(client);
+	tls_key_share_free(server);
+	free(client_public);
+	free(server_public);
+	freezero(client_key, client_key_len);
+	freezero(server_key, server_key_len);
+
+	return failed;
+}
+
+static int
+key_share_truncated_test(const struct key_share_test *kst)
+{
+	struct tls_key_share *client = NULL, *server = NULL;
+	uint8_t *client_public = NULL;
+	size_t client_public_len = 0;
+	int decode_error;
+	CBS cbs;
+	int failed = 1;
+
+	if ((client = tls_key_share_new(kst->group_id)) == NULL)
+		errx(1, "%s: client tls_key_share_new", kst->desc);
+	if ((server = tls_key_share_new(kst->group_id)) == NULL)
+		errx(1, "%s: server tls_key_share_new", kst->desc);
+
+	if (!tls_key_share_generate(client))
+		goto failure;
+	if (!key_share_public(client, &client_public, &client_public_len))
+		goto failure;
+
+	CBS_init(&cbs, client_public, client_public_len - 1);
+	if (tls_key_share_peer_public(server, &cbs, &decode_error, NULL)) {
+		fprintf(stderr, "FAIL: %s: accepted truncated key share\n",
+		    kst->desc);
+		goto failure;
+	}
+	if (!decode_error) {
+		fprintf(stderr, "FAIL: %s: truncated key share is not a "
+		    "decode error\n", kst->desc);
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	tls_key_share_free(client);
+	tls_key_share_free(server);
+	free(client_public);
+
+	return failed;
+}
+
+/*
+ * A client encapsulation key with a coefficient that is not reduced modulo q
+ * fails the FIPS 203 encapsulation key check and is a decode error.
+ */
+static int
+key_share_invalid_mlkem_test(void)
+{
+	struct tls_key_share *client = NULL, *server = NULL;
+	uint8_t *client_public = NULL;
+	size_t client_public_len = 0;
+	int decode_error;
+	CBS cbs;
+	int failed = 1;
+
+	if ((client = tls_key_share_new(4588)) == NULL)
+		errx(1, "X25519MLKEM768: client tls_key_share_new");
+	if ((server = tls_key_share_new(4588)) == NULL)
+		errx(1, "X25519MLKEM768: server tls_key_share_new");
+
+	if (!tls_key_share_generate(client))
+		goto failure;
+	if (!key_share_public(client, &client_public, &client_public_len))
+		goto failure;
+
+	/* Set the first coefficient to 4095. */
+	client_public[0] = 0xff;
+	client_public[1] |= 0x0f;
+
+	CBS_init(&cbs, client_public, client_public_len);
+	if (tls_key_share_peer_public(server, &cbs, &decode_error, NULL)) {
+		fprintf(stderr, "FAIL: X25519MLKEM768: accepted invalid "
+		    "encapsulation key\n");
+		goto failure;
+	}
+	if (!decode_error) {
+		fprintf(stderr, "FAIL: X25519MLKEM768: invalid encapsulation "
+		    "key is not a decode error\n");
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	tls_key_share_free(client);
+	tls_key_share_free(server);
+	free(client_public);
+
+	return failed;
+}
+
+static int
+key_share_tests_run(void)
+{
+	size_t i;
+	int failed = 0;
+
+	for (i = 0; i < N_KEY_SHARE_TESTS; i++) {
+		failed |= key_share_exchange(&key_share_tests[i], 1);
+		if (key_share_tests[i].group_id != 23)
+			failed |= key_share_truncated_test(&key_share_tests[i]);
+	}
+	failed |= key_share_invalid_mlkem_test();
+
+	return failed;
+}
+
+static int
+key_share_nid_test(void)
+{
+	uint16_t group_id;
+	int nid;
+	int failed = 1;
+
+	if (!tls1_ec_group_id2nid(4588, &nid) || nid != NID_X25519MLKEM768) {
+		fprintf(stderr, "FAIL: group 4588 does not map to "
+		    "X25519MLKEM768\n");
+		goto failure;
+	}
+	if (!tls1_ec_nid2group_id(NID_X25519MLKEM768, &group_id) ||
+	    group_id != 4588) {
+		fprintf(stderr, "FAIL: X25519MLKEM768 does not map to "
+		    "group 4588\n");
+		goto failure;
+	}
+
+	failed = 0;
+
+ failure:
+	return failed;
+}
+
+static volatile sig_atomic_t benchmark_stop;
+
+static void
+benchmark_sig_alarm(int sig)
+{
+	benchmark_stop = 1;
+}
+
+static uint64_t
+benchmark_run(const struct key_share_test *kst, int seconds)
+{
+	struct timespec start, end, duration;
+	struct rusage rusage;
+	uint64_t ops;
+	int i;
+
+	signal(SIGALRM, benchmark_sig_alarm);
+
+	benchmark_stop = 0;
+	i = 0;
+	alarm(seconds);
+
+	if (getrusage(RUSAGE_SELF, &rusage) == -1)
+		err(1, "getrusage failed");
+	TIMEVAL_TO_TIMESPEC(&rusage.ru_utime, &start);
+
+	fprintf(stderr, "Benchmarking %s key exchange for %ds: ", kst->desc,
+	    seconds);
+	while (!benchmark_stop) {
+		if (key_share_exchange(kst, 0))
+			errx(1, "%s key exchange failed", kst->desc);
+		i++;
+	}
+	if (getrusage(RUSAGE_SELF, &rusage) == -1)
+		err(1, "getrusage failed");
+	TIMEVAL_TO_TIMESPEC(&rusage.ru_utime, &end);
+
+	timespecsub(&end, &start, &duration);
+	ops = (uint64_t)i * 1000000000 /
+	    (duration.tv_sec * 1000000000 + duration.tv_nsec);
+	fprintf(stderr, "%d iterations in %f seconds - %llu op/s\n", i,
+	    duration.tv_sec + duration.tv_nsec / 1000000000.0,
+	    (unsigned long long)ops);
+
+	return ops;
+}
+
+/*
+ * Compare the full client and server key share cost of the hybrid group
+ * against plain X25519.
+ */
+static void
+benchmark_key_share(void)
+{
+	uint64_t x25519, hybrid;
+
+	x25519 = benchmark_run(&key_share_tests[0], 5);
+	hybrid = benchmark_run(&key_share_tests[2], 5);
+
+	if (hybrid > 0)
+		fprintf(stderr, "X25519MLKEM768 costs %.2fx X25519\n",
+		    (double)x25519 / hybrid);
+}
+
+int
+main(int argc, char **argv)
+{
+	int benchmark = 0, failed = 0;
+
+	if (argc == 2 && strcmp(argv[1], "--benchmark") == 0)
+		benchmark = 1;
+
+	failed |= key_share_nid_test();
+	failed |= key_share_tests_run();
+
+	if (benchmark && !failed)
+		benchmark_key_share();
+
+	return failed;
+}
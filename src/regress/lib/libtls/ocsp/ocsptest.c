@@ -0,0 +1,507 @@
+/*	$OpenBSD$ */
+/*
+ * Copyright (c) 2026 The OpenBSD Project
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include <err.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/ocsp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <tls.h>
+
+#include "tls_internal.h"
+
+#define OCSP_URL	"http://ocsp.example.com/"
+#define VALIDITY	(4 * 60 * 60)
+
+struct responder {
+	X509 *signer;
+	EVP_PKEY *signer_key;
+	int calls;
+	char *url;
+	time_t next_update;
+};
+
+static EVP_PKEY *
+key_new(void)
+{
+	EVP_PKEY *pkey;
+	EC_KEY *ec;
+
+	if ((ec = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1)) == NULL)
+		errx(1, "EC_KEY_new_by_curve_name");
+	if (!EC_KEY_generate_key(ec))
+		errx(1, "EC_KEY_generate_key");
+	if ((pkey = EVP_PKEY_new()) == NULL)
+		errx(1, "EVP_PKEY_new");
+	if (!EVP_PKEY_assign_EC_KEY(pkey, ec))
+		errx(1, "EVP_PKEY_assign_EC_KEY");
+
+	return pkey;
+}
+
+static void
+cert_add_ext(X509 *cert, X509 *issuer, int nid, const char *value)
+{
+	X509_EXTENSION *ext;
+	X509V3_CTX ctx;
+
+	X509V3_set_ctx(&ctx, issuer, cert, NULL, NULL, 0);
+	if ((ext = X509V3_EXT_conf_nid(NULL, &ctx, nid, value)) == NULL)
+		errx(1, "X509V3_EXT_conf_nid %d", nid);
+	if (!X509_add_ext(cert, ext, -1))
+		errx(1, "X509_add_ext");
+	X509_EXTENSION_free(ext);
+}
+
+static X509 *
+cert_new(const char *cn, EVP_PKEY *pkey, X509 *issuer, EVP_PKEY *issuer_key,
+    long serial)
+{
+	X509_NAME *name;
+	X509 *cert;
+
+	if ((cert = X509_new()) == NULL)
+		errx(1, "X509_new");
+	if (!X509_set_version(cert, 2))
+		errx(1, "X509_set_version");
+	if (!ASN1_INTEGER_set(X509_get_serialNumber(cert), serial))
+		errx(1, "ASN1_INTEGER_set");
+	if (X509_gmtime_adj(X509_get_notBefore(cert), -60 * 60) == NULL)
+		errx(1, "X509_gmtime_adj");
+	if (X509_gmtime_adj(X509_get_notAfter(cert), 24 * 60 * 60) == NULL)
+		errx(1, "X509_gmtime_adj");
+
+	if ((name = X509_NAME_new()) == NULL)
+		errx(1, "X509_NAME_new");
+	if (!X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+	    (const unsigned char *)cn, -1, -1, 0))
+		errx(1, "X509_NAME_add_entry_by_txt");
+	if (!X509_set_subject_name(cert, name))
+		errx(1, "X509_set_subject_name");
+	X509_NAME_free(name);
+
+	if (issuer == NULL) {
+		issuer = cert;
+		issuer_key = pkey;
+	}
+	if (!X509_set_issuer_name(cert, X509_get_subject_name(issuer)))
+		errx(1, "X509_set_issuer_name");
+	if (!X509_set_pubkey(cert, pkey))
+		errx(1, "X509_set_pubkey");
+
+	if (issuer == cert) {
+		cert_add_ext(cert, issuer, NID_basic_constraints,
+		    "critical,CA:TRUE");
+	} else {
+		cert_add_ext(cert, issuer, NID_subject_alt_name,
+		    "DNS:localhost");
+		cert_add_ext(cert, issuer, NID_info_access,
+		    "OCSP;URI:" OCSP_URL);
+	}
+
+	if (!X509_sign(cert, issuer_key, EVP_sha256()))
+		errx(1, "X509_sign");
+
+	return cert;
+}
+
+static void
+pem_append(BIO *bio, X509 *cert, EVP_PKEY *pkey)
+{
+	if (cert != NULL && !PEM_write_bio_X509(bio, cert))
+		errx(1, "PEM_write_bio_X509");
+	if (pkey != NULL && !PEM_write_bio_PrivateKey(bio, pkey, NULL, NULL,
+	    0, NULL, NULL))
+		errx(1, "PEM_write_bio_PrivateKey");
+}
+
+/*
+ * Stand-in for an OCSP responder, answering every request with a good
+ * status signed by the configured signer.
+ */
+static int
+responder_cb(void *arg, const char *url, const uint8_t *request,
+    size_t request_len, uint8_t **response, size_t *response_len)
+{
+	struct responder *responder = arg;
+	ASN1_GENERALIZEDTIME *thisupd = NULL, *nextupd = NULL;
+	OCSP_REQUEST *req = NULL;
+	OCSP_BASICRESP *br = NULL;
+	OCSP_RESPONSE *resp = NULL;
+	OCSP_CERTID *cid;
+	unsigned char *der = NULL;
+	time_t now;
+	int der_len;
+	int ret = -1;
+
+	responder->calls++;
+	free(responder->url);
+	responder->url = (url != NULL) ? strdup(url) : NULL;
+
+	now = time(NULL);
+	responder->next_update = now + VALIDITY;
+
+	if ((req = d2i_OCSP_REQUEST(NULL, &request, request_len)) == NULL)
+		goto err;
+	if (OCSP_request_onereq_count(req) != 1)
+		goto err;
+	cid = OCSP_onereq_get0_id(OCSP_request_onereq_get0(req, 0));
+
+	if ((thisupd = ASN1_GENERALIZEDTIME_set(NULL, now)) == NULL)
+		goto err;
+	if ((nextupd = ASN1_GENERALIZEDTIME_set(NULL,
+	    responder->next_update)) == NULL)
+		goto err;
+	if ((br = OCSP_BASICRESP_new()) == NULL)
+		goto err;
+	if (OCSP_basic_add1_status(br, cid, V_OCSP_CERTSTATUS_GOOD, 0, NULL,
+	    thisupd, nextupd) == NULL)
+		goto err;
+	if (!OCSP_basic_sign(br, responder->signer, responder->signer_key,
+	    EVP_sha256(), NULL, 0))
+		goto err;
+	if ((resp = OCSP_response_create(OCSP_RESPONSE_STATUS_SUCCESSFUL,
+	    br)) == NULL)
+		goto err;
+	if ((der_len = i2d_OCSP_RESPONSE(resp, &der)) <= 0)
+		goto err;
+
+	*response = der;
+	*response_len = der_len;
+	der = NULL;
+
+	ret = 0;
+
+ err:
+	ASN1_GENERALIZEDTIME_free(thisupd);
+	ASN1_GENERALIZEDTIME_free(nextupd);
+	OCSP_REQUEST_free(req);
+	OCSP_BASICRESP_free(br);
+	OCSP_RESPONSE_free(resp);
+	free(der);
+
+	return ret;
+}
+
+/*
+ * Wait for the refresh thread to have completed at least one pass over the
+ * keypairs.
+ */
+static int
+wait_for_refresh(struct tls_config *config)
+{
+	struct tls_ocsp_refresh *refresh = config->ocsp_refresh;
+	struct timespec ts = { 0, 10 * 1000 * 1000 };
+	unsigned int passes;
+	int i;
+
+	if (refresh == NULL)
+		return 0;
+
+	for (i = 0; i < 500; i++) {
+		pthread_mutex_lock(&refresh->mutex);
+		passes = refresh->passes;
+		pthread_mutex_unlock(&refresh->mutex);
+		if (passes != 0)
+			return 1;
+		nanosleep(&ts, NULL);
+	}
+
+	return 0;
+}
+
+static int
+do_handshake(struct tls *client, struct tls *server_cctx)
+{
+	int i, client_done, server_done;
+	int rv;
+
+	i = client_done = server_done = 0;
+	do {
+		if (client_done == 0) {
+			if ((rv = tls_handshake(client)) == 0)
+				client_done = 1;
+			else if (rv != TLS_WANT_POLLIN &&
+			    rv != TLS_WANT_POLLOUT)
+				return -1;
+		}
+		if (server_done == 0) {
+			if ((rv = tls_handshake(server_cctx)) == 0)
+				server_done = 1;
+			else if (rv != TLS_WANT_POLLIN &&
+			    rv != TLS_WANT_POLLOUT)
+				return -1;
+		}
+	} while (i++ < 100 && (client_done == 0 || server_done == 0));
+
+	if (client_done == 0 || server_done == 0)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Accept a connection, which starts the refresh thread in this process,
+ * wait for the refresh and check the staple received by a client.
+ */
+static int
+ocsp_refresh_connect(const char *desc, struct tls *server,
+    struct tls_config *server_cfg, struct tls_config *client_cfg,
+    struct responder *responder, int want_calls, int want_staple)
+{
+	struct tls *client = NULL, *server_cctx = NULL;
+	int sv[2] = { -1, -1 };
+	int failed = 1;
+
+	if ((client = tls_client()) == NULL)
+		errx(1, "failed to create client");
+	if (tls_configure(client, client_cfg) == -1)
+		errx(1, "failed to configure client: %s", tls_error(client));
+
+	if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, PF_UNSPEC,
+	    sv) == -1)
+		err(1, "failed to create socketpair");
+	if (tls_accept_socket(server, &server_cctx, sv[0]) == -1)
+		errx(1, "failed to accept: %s", tls_error(server));
+	if (tls_connect_socket(client, sv[1], "localhost") == -1)
+		errx(1, "failed to connect: %s", tls_error(client));
+
+	if (!wait_for_refresh(server_cfg)) {
+		fprintf(stderr, "FAIL: %s: OCSP refresh did not happen\n",
+		    desc);
+		goto failure;
+	}
+	if (responder->calls != want_calls) {
+		fprintf(stderr, "FAIL: %s: got %d OCSP requests, want %d\n",
+		    desc, responder->calls, want_calls);
+		goto failure;
+	}
+	if (responder->url == NULL || strcmp(responder->url, OCSP_URL) != 0) {
+		fprintf(stderr, "FAIL: %s: got OCSP URL '%s', want '%s'\n",
+		    desc, responder->url != NULL ? responder->url : "(null)",
+		    OCSP_URL);
+		goto failure;
+	}
+
+	if (do_handshake(client, server_cctx) == -1) {
+		fprintf(stderr, "FAIL: %s: handshake failed: %s / %s\n", desc,
+		    tls_error(client), tls_error(server_cctx));
+		goto failure;
+	}
+
+	if (!want_staple) {
+		if (tls_peer_ocsp_response_status(client) != -1) {
+			fprintf(stderr, "FAIL: %s: unexpected OCSP staple\n",
+			    desc);
+			goto failure;
+		}
+		goto done;
+	}
+
+	if (tls_peer_ocsp_response_status(client) !=
+	    TLS_OCSP_RESPONSE_SUCCESSFUL) {
+		fprintf(stderr, "FAIL: %s: no OCSP staple received\n", desc);
+		goto failure;
+	}
+	if (tls_peer_ocsp_cert_status(client) != TLS_OCSP_CERT_GOOD) {
+		fprintf(stderr, "FAIL: %s: got OCSP cert status %d, want %d\n",
+		    desc, tls_peer_ocsp_cert_status(client),
+		    TLS_OCSP_CERT_GOOD);
+		goto failure;
+	}
+	if (tls_peer_ocsp_next_update(client) != responder->next_update) {
+		fprintf(stderr, "FAIL: %s: got next update %lld, want %lld\n",
+		    desc, (long long)tls_peer_ocsp_next_update(client),
+		    (long long)responder->next_update);
+		goto failure;
+	}
+
+ done:
+	failed = 0;
+
+ failure:
+	tls_free(server_cctx);
+	tls_free(client);
+	if (sv[0] != -1)
+		close(sv[0]);
+	if (sv[1] != -1)
+		close(sv[1]);
+
+	return failed;
+}
+
+/*
+ * If signer is NULL, the responses are signed by the leaf certificate
+ * itself, which must not be accepted.
+ */
+static int
+ocsp_refresh_test(const char *desc, X509 *ca, EVP_PKEY *ca_key,
+    X509 *signer, EVP_PKEY *signer_key, int want_staple, int forked)
+{
+	struct tls_config *client_cfg = NULL, *server_cfg = NULL;
+	struct tls *server = NULL;
+	struct responder responder;
+	EVP_PKEY *leaf_key = NULL;
+	X509 *leaf = NULL;
+	BIO *chain_bio = NULL, *key_bio = NULL, *ca_bio = NULL;
+	char *chain_pem, *key_pem, *ca_pem;
+	long chain_len, key_len, ca_len;
+	pid_t pid;
+	int status;
+	int failed = 1;
+
+	leaf_key = key_new();
+	leaf = cert_new("localhost", leaf_key, ca, ca_key, 2);
+
+	memset(&responder, 0, sizeof(responder));
+	responder.signer = signer;
+	responder.signer_key = signer_key;
+	if (signer == NULL) {
+		responder.signer = leaf;
+		responder.signer_key = leaf_key;
+	}
+
+	if ((chain_bio = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	if ((key_bio = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	if ((ca_bio = BIO_new(BIO_s_mem())) == NULL)
+		errx(1, "BIO_new");
+	pem_append(chain_bio, leaf, NULL);
+	pem_append(chain_bio, ca, NULL);
+	pem_append(key_bio, NULL, leaf_key);
+	pem_append(ca_bio, ca, NULL);
+	chain_len = BIO_get_mem_data(chain_bio, &chain_pem);
+	key_len = BIO_get_mem_data(key_bio, &key_pem);
+	ca_len = BIO_get_mem_data(ca_bio, &ca_pem);
+
+	if ((server_cfg = tls_config_new()) == NULL)
+		errx(1, "failed to create server config");
+	if (tls_config_set_keypair_mem(server_cfg, chain_pem, chain_len,
+	    key_pem, key_len) == -1)
+		errx(1, "failed to set keypair: %s",
+		    tls_config_error(server_cfg));
+	if (tls_config_set_ca_mem(server_cfg, ca_pem, ca_len) == -1)
+		errx(1, "failed to set ca: %s", tls_config_error(server_cfg));
+	if (tls_config_set_ocsp_refresh_cb(server_cfg, responder_cb,
+	    &responder) == -1)
+		errx(1, "failed to set refresh callback: %s",
+		    tls_config_error(server_cfg));
+
+	if ((client_cfg = tls_config_new()) == NULL)
+		errx(1, "failed to create client config");
+	if (tls_config_set_ca_mem(client_cfg, ca_pem, ca_len) == -1)
+		errx(1, "failed to set ca: %s", tls_config_error(client_cfg));
+
+	if ((server = tls_server()) == NULL)
+		errx(1, "failed to create server");
+	if (tls_configure(server, server_cfg) == -1)
+		errx(1, "failed to configure server: %s", tls_error(server));
+
+	/* The refresh thread must not run before the first accept. */
+	if (server_cfg->ocsp_refresh == NULL ||
+	    server_cfg->ocsp_refresh->pid != 0 || responder.calls != 0) {
+		fprintf(stderr, "FAIL: %s: OCSP refresh started when "
+		    "configuring\n", desc);
+		goto failure;
+	}
+
+	if (ocsp_refresh_connect(desc, server, server_cfg, client_cfg,
+	    &responder, 1, want_staple) != 0)
+		goto failure;
+
+	if (forked) {
+		/*
+		 * The child inherits the refresh but not the parent's
+		 * thread, so it needs to start its own. That thread keeps
+		 * the schedule, so the staple is not fetched again.
+		 */
+		if ((pid = fork()) == -1)
+			err(1, "fork");
+		if (pid == 0) {
+			failed = ocsp_refresh_connect(desc, server, server_cfg,
+			    client_cfg, &responder, 1, want_staple);
+			tls_free(server);
+			tls_config_free(client_cfg);
+			tls_config_free(server_cfg);
+			_exit(failed);
+		}
+		if (waitpid(pid, &status, 0) == -1)
+			err(1, "waitpid");
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "FAIL: %s: child failed\n", desc);
+			goto failure;
+		}
+	}
+
+	failed = 0;
+
+ failure:
+	tls_free(server);
+	tls_config_free(client_cfg);
+	tls_config_free(server_cfg);
+	BIO_free(chain_bio);
+	BIO_free(key_bio);
+	BIO_free(ca_bio);
+	X509_free(leaf);
+	EVP_PKEY_free(leaf_key);
+	free(responder.url);
+
+	return failed;
+}
+
+int
+main(int argc, char **argv)
+{
+	EVP_PKEY *ca_key, *other_key;
+	X509 *ca, *other;
+	int failed = 0;
+
+	ca_key = key_new();
+	ca = cert_new("OCSP Test CA", ca_key, NULL, NULL, 1);
+	other_key = key_new();
+	other = cert_new("OCSP Other CA", other_key, NULL, NULL, 1);
+
+	failed |= ocsp_refresh_test("issuer signed", ca, ca_key, ca, ca_key,
+	    1, 0);
+	failed |= ocsp_refresh_test("untrusted signer", ca, ca_key, other,
+	    other_key, 0, 0);
+	failed |= ocsp_refresh_test("leaf signed", ca, ca_key, NULL, NULL,
+	    0, 0);
+	failed |= ocsp_refresh_test("after fork", ca, ca_key, ca, ca_key,
+	    1, 1);
+
+	X509_free(ca);
+	X509_free(other);
+	EVP_PKEY_free(ca_key);
+	EVP_PKEY_free(other_key);
+
+	return failed;
+}
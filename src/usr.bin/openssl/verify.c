@@ -71,12 +71,15 @@
 static int cb(int ok, X509_STORE_CTX *ctx);
 static int check(X509_STORE *ctx, char *file, STACK_OF(X509) *uchain,
     STACK_OF(X509) *tchain, STACK_OF(X509_CRL) *crls);
+static int check_batch(X509_STORE *ctx, char **files, STACK_OF(X509) *uchain,
+    STACK_OF(X509_CRL) *crls);
 static int vflags = 0;
 
 static struct {
 	char *CAfile;
 	char *CApath;
 	char *crlfile;
+	int jobs;
 	char *trustfile;
 	char *untfile;
 	int verbose;
@@ -121,6 +124,13 @@ static const struct option verify_options[] = {
 		.type = OPTION_ARG,
 		.opt.arg = &cfg.crlfile,
 	},
+	{
+		.name = "jobs",
+		.argname = "num",
+		.desc = "Verify certificates using num threads",
+		.type = OPTION_ARG_INT,
+		.opt.value = &cfg.jobs,
+	},
 	{
 		.name = "trusted",
 		.argname = "file",
@@ -240,9 +250,9 @@ verify_usage(void)
 	    "    [-CRLfile file] [-crl_check] [-crl_check_all]\n"
 	    "    [-explicit_policy] [-extended_crl]\n"
 	    "    [-ignore_critical] [-inhibit_any] [-inhibit_map]\n"
-	    "    [-issuer_checks] [-policy_check] [-purpose purpose]\n"
-	    "    [-trusted file] [-untrusted file] [-verbose]\n"
-	    "    [-x509_strict] [certificates]\n\n");
+	    "    [-issuer_checks] [-jobs num] [-policy_check]\n"
+	    "    [-purpose purpose] [-trusted file] [-untrusted file]\n"
+	    "    [-verbose] [-x509_strict] [certificates]\n\n");
 
 	options_usage(verify_options);
 
@@ -283,6 +293,11 @@ verify_main(int argc, char **argv)
 	if (argsused < argc)
 		cert_files = &argv[argsused];
 
+	if (cfg.jobs > 0 && cfg.trustfile != NULL) {
+		BIO_printf(bio_err, "-trusted cannot be used with -jobs\n");
+		goto end;
+	}
+
 	cert_ctx = X509_STORE_new();
 	if (cert_ctx == NULL)
 		goto end;
@@ -340,7 +355,10 @@ verify_main(int argc, char **argv)
 			goto end;
 	}
 	ret = 0;
-	if (cert_files == NULL) {
+	if (cfg.jobs > 0) {
+		if (1 != check_batch(cert_ctx, cert_files, untrusted, crls))
+			ret = -1;
+	} else if (cert_files == NULL) {
 		if (1 != check(cert_ctx, NULL, untrusted, trusted, crls))
 			ret = -1;
 	} else {
@@ -407,6 +425,98 @@ check(X509_STORE *ctx, char *file, STACK_OF(X509) *uchain,
 	return (ret);
 }
 
+/*
+ * Load all certificates up front and verify them concurrently using
+ * cfg.jobs threads. The results are printed in the order given.
+ */
+static int
+check_batch(X509_STORE *ctx, char **files, STACK_OF(X509) *uchain,
+    STACK_OF(X509_CRL) *crls)
+{
+	X509_VERIFY_JOB **jobs = NULL;
+	X509 **leafs = NULL;
+	char **job_files = NULL;
+	const char *certfile;
+	size_t i, num_files = 1, num_jobs = 0;
+	int j, verify_err;
+	int ret = 0;
+
+	if (files != NULL) {
+		for (num_files = 0; files[num_files] != NULL; num_files++)
+			continue;
+	}
+
+	if ((jobs = calloc(num_files, sizeof(*jobs))) == NULL)
+		goto end;
+	if ((leafs = calloc(num_files, sizeof(*leafs))) == NULL)
+		goto end;
+	if ((job_files = calloc(num_files, sizeof(*job_files))) == NULL)
+		goto end;
+
+	/* Jobs share the store, so CRLs go there rather than in a context. */
+	for (j = 0; j < sk_X509_CRL_num(crls); j++) {
+		if (!X509_STORE_add_crl(ctx, sk_X509_CRL_value(crls, j)))
+			goto end;
+	}
+	X509_STORE_set_flags(ctx, vflags);
+
+	ret = 1;
+
+	for (i = 0; i < num_files; i++) {
+		X509 *x;
+		char *file = (files == NULL) ? NULL : files[i];
+
+		x = load_cert(bio_err, file, FORMAT_PEM, NULL,
+		    "certificate file");
+		if (x == NULL) {
+			ERR_print_errors(bio_err);
+			ret = 0;
+			continue;
+		}
+		if ((jobs[num_jobs] = X509_VERIFY_JOB_new(x, uchain,
+		    NULL)) == NULL) {
+			X509_free(x);
+			ret = 0;
+			goto end;
+		}
+		leafs[num_jobs] = x;
+		job_files[num_jobs] = file;
+		num_jobs++;
+	}
+
+	if (!X509_STORE_verify_batch(ctx, jobs, num_jobs, cfg.jobs)) {
+		ret = 0;
+		goto end;
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		certfile = (job_files[i] == NULL) ? "stdin" : job_files[i];
+		verify_err = X509_VERIFY_JOB_get_error(jobs[i]);
+		if (X509_VERIFY_JOB_get_result(jobs[i]) > 0 &&
+		    verify_err == X509_V_OK) {
+			fprintf(stdout, "%s: OK\n", certfile);
+		} else {
+			fprintf(stdout, "%s: verification failed: %d (%s)\n",
+			    certfile, verify_err,
+			    X509_verify_cert_error_string(verify_err));
+			ret = 0;
+		}
+	}
+
+ end:
+	if (ret == 0)
+		ERR_print_errors(bio_err);
+	for (i = 0; i < num_jobs; i++) {
+		X509_VERIFY_JOB_free(jobs[i]);
+		X509_free(leafs[i]);
+	}
+	free(jobs);
+	free(leafs);
+	free(job_files);
+
+	return (ret);
+}
+
 static int
 cb(int ok, X509_STORE_CTX *ctx)
 {
@@ -414,6 +524,8 @@ cb(int ok, X509_STORE_CTX *ctx)
 	X509 *current_cert = X509_STORE_CTX_get_current_cert(ctx);
 
 	if (!ok) {
+		/* With -jobs, keep the output of concurrent callbacks apart. */
+		flockfile(stdout);
 		if (current_cert) {
 			X509_NAME_print_ex_fp(stdout,
 			    X509_get_subject_name(current_cert),
@@ -447,6 +559,7 @@ cb(int ok, X509_STORE_CTX *ctx)
 			ok = 1;
 
 		}
+		funlockfile(stdout);
 
 		return ok;
 